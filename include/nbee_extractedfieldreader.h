@@ -117,6 +117,34 @@ public:
 	*/
 	virtual _nbExtractedFieldsDescriptor* GetField(int Index)=0;
 
+	/*!
+		\brief Returns the handle of the field specified by name.
+
+		The handle can be passed to GetField(int) in order to access the field without having to
+		look up its name for every packet; handles do not change for the whole life of this object,
+		hence they can be computed once, after the filter has been compiled.
+
+		\param FieldName: Field name in the format 'protoname.fieldname'.
+
+		\return The handle (i.e., the position in the extraction list) of the field, nbFAILURE if the
+		FieldName does not correspond to any extracted field.
+	*/
+	virtual int GetFieldHandle(string FieldName)=0;
+
+	/*!
+		\brief Selects how the extracted fields are decoded.
+
+		By default (eager decoding) all the descriptors are filled as soon as a packet is accepted,
+		so that the _nbExtractedFieldsDescriptorVector returned by GetFields() can be kept and read
+		directly for each packet.
+		With lazy decoding, each descriptor is decoded only when it is requested through GetField()
+		(or all of them through GetFields() and IsComplete()); this saves the decoding of the
+		fields that are not consulted, but it requires the descriptors to be requested for each packet.
+
+		\param Lazy: 'true' to enable lazy decoding, 'false' to restore eager decoding.
+	*/
+	virtual void SetLazyDecoding(bool Lazy)=0;
+
 	/*!
 		\brief Returns a pointer to the _nbExtractedFieldsDescriptorVector that contains all the fields extracted.
 
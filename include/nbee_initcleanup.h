@@ -95,6 +95,8 @@ typedef struct _nbVersion
 	\param NetPDLFileLocation: string that points to the file containing the NetPDL description.
 	This parameter can be NULL: in this case, the internal NetPDL description embedded in this
 	engine will be used. However this description may not be up to date.
+	The file can also be a binary image of the NetPDL description created by nbProtoDBImageSave()
+	(e.g. with the 'protodbimage' tool), which is mapped in memory instead of being parsed.
 
 	\param Flags: type of the NetPDL protocol database we want to load. It can be 'nbPROTODB_FULL',
 	(default) in case the NetPDL database we want to load is a complete database including visualization 
@@ -40,6 +40,16 @@
 */
 
 
+/*!
+	\brief Handle to the definition of a field in the NetPDL description.
+
+	It is returned by nbNetPDLUtils::GetNetPDLFieldHandle() and it can be used to format the field
+	several times without locating its definition each time. It is valid until the nbNetPDLUtils
+	instance that returned it is deallocated.
+*/
+typedef struct _nbNetPDLFieldHandle *nbNetPDLFieldHandle;
+
+
 /*!
 	\brief This class defines some methods that can be of general use for NetPDL-based tools.
 
@@ -207,6 +217,69 @@ public:
 	virtual int GetFastPrintingFunctionCode(const char *ProtoName, const char *FieldName, int *FastPrintingFunctionCode)= 0;
 
 
+/*!
+	\brief Locates the definition of a field in the NetPDL description and returns a handle to it.
+
+	The handle can be used in the proper FormatNetPDLField() in order to format the field, which is
+	faster than locating the field by name each time (e.g. when the same field has to be formatted
+	for each packet).
+
+	\param ProtoName Name of the protocol the field belongs to.
+
+	\param FieldName Name of the requested field.
+
+	\param FieldHandle When the function returns, this variable will contain the handle to the field,
+	or NULL in case the field is the special 'allfields' field (which does not need to be formatted).
+
+	\return This function returns nbSUCCESS if the field has been found, nbWARNING in case the field
+	is the 'allfields' one, and nbFAILURE in case of errors (e.g. the protocol or the field do not exist).
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+	virtual int GetNetPDLFieldHandle(const char *ProtoName, const char *FieldName, nbNetPDLFieldHandle *FieldHandle)= 0;
+
+
+/*!
+	\brief It formats the value of a field according to the NetPDL description.
+
+	This method is equivalent to the FormatNetPDLField() that accepts the name of the protocol and the
+	name of the field, but the definition of the field has already been located through the
+	GetNetPDLFieldHandle() method. In case the field is associated to a fast printing function, that
+	function is used.
+
+	\param FieldHandle: handle of the field, as returned by GetNetPDLFieldHandle().
+
+	\param FieldDumpPtr: a pointer to the buffer that contains the dump (in the pcap format)
+	of the current field (i.e. the field value in binary hex dump format).
+
+	\param FieldSize: keeps the length (in bytes) of the decoded field.
+
+	\param FormattedField: user-allocated buffer that will keep the result of the transformation.
+	This buffer will be always '\\0' terminated.
+
+	\param FormattedFieldSize: size of the previous user-allocated buffer.
+
+	\return nbSUCCESS if the field has been formatted (therefore the 'FormattedField' is valid), nbFAILURE
+	otherwise. In case of error, the error message can be retrieved by the GetLastError() method.
+
+	\warning This method has the same limitations of the other FormatNetPDLField() methods.
+*/
+	virtual int FormatNetPDLField(nbNetPDLFieldHandle FieldHandle, const unsigned char *FieldDumpPtr,
+		unsigned int FieldSize, char *FormattedField, int FormattedFieldSize)= 0;
+
+
+/*!
+	\brief Returns the definition of a field in the NetPDL description.
+
+	This allows to inspect the field (e.g. its type or its visualization template) without scanning
+	the NetPDL protocol database.
+
+	\param FieldHandle Handle returned by GetNetPDLFieldHandle(); it cannot be NULL.
+
+	\return A pointer to the NetPDL element of the field, which belongs to the NetPDL protocol database.
+*/
+	virtual struct _nbNetPDLElementFieldBase *GetNetPDLFieldElement(nbNetPDLFieldHandle FieldHandle)= 0;
+
+
 /*!
 	\brief It gets a formatted value of a given field and it returns its hexadecimal counterpart.
 
@@ -132,7 +132,37 @@ enum nbPacketDecoderFlags
 		The user is allowed to dump the entire PSML file on disk (through the use of
 		nbPSMLReader::SaveDocumentAs()) only when this flag is turned on.
 	*/
-	nbDECODER_KEEPALLPSML= 32
+	nbDECODER_KEEPALLPSML= 32,
+
+	/*!
+		\brief The fragments kept by nbDECODER_KEEPALLPDML and nbDECODER_KEEPALLPSML are stored in memory.
+		
+		Instead of writing the XML fragment of each packet in a temporary file, the NetBee Packet Decoder
+		keeps a compact binary record of the packet in a memory area, and generates the XML fragment only
+		when it is requested (e.g. by nbPDMLReader::GetPacketXML() or nbPDMLReader::SaveDocumentAs()).
+		Hence, packets returned by nbPDMLReader::GetPacket() and nbPSMLReader::GetPacket() do not need
+		to be parsed again.
+
+		The memory area has a maximum size (256MB for each document); when it is full, the oldest packets
+		are discarded as if they were removed with the RemovePacket() method.
+	*/
+	nbDECODER_KEEPALL_INMEMORY= 64,
+
+	/*!
+		\brief The string attributes of the fields of the current packet are generated only when they are needed.
+		
+		The NetBee Packet Decoder stores only the position, the size and the mask of each decoded field,
+		while the 'value', 'showvalue', 'showmap' and 'showdtl' attributes of the field are left NULL.
+		These attributes are generated the first time the field is returned by
+		nbPDMLReader::GetPDMLField(), or when the field is passed to nbPDMLReader::FormatPDMLField();
+		the whole packet is formatted when its PDML fragment is requested or stored.
+
+		This is useful when the user needs only a few fields of each packet. Please note that
+		the packet buffer given to the decoder must be still valid when the fields are formatted,
+		and that the run-time variables referred by the visualization primitives are evaluated when
+		the field is formatted, not when it is decoded.
+	*/
+	nbDECODER_DEFERFIELDFORMAT= 128
 };
 
 
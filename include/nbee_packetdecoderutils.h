@@ -431,11 +431,9 @@ public:
 		\param TimestampSec: current timestamp (seconds, in UNIX time). Entries whose
 		(Timestamp + Lifetime) is less than this value are deleted from the table.
 
-		\param AggressiveScan: if 'true', it implement a method that is faster to purge old
-		data, but it does not guarantee to purge everything is needed. If 'false', it scans
-		the entire table instead.
-		In order to maximize performances, you can use the AggressiveScan most of the times, and
-		sometimes call the this function with this flag turned off.
+		\param AggressiveScan: kept for compatibility, and currently ignored. Entries are kept
+		sorted by expiration time, hence each call touches only the entries whose lifetime has
+		elapsed since the previous call, and this method can be called for each packet.
 	*/
 	virtual void DoGarbageCollection(int TimestampSec, int AggressiveScan)= 0;
 
@@ -178,9 +178,80 @@ public:
 		For instance, if the filter is satisfied but the packet does not contain the fields
 		that have to be extracted, this function still returns nbSUCCESS, but the returned
 		field list does not contain any valid value.
+
+		\note The extracted fields are not copied out of the NetVM: the nbExtractedFieldsReader refers
+		directly to the info partition of the NetVM exchange buffer (which, in case of lazy decoding, is
+		decoded only when it is accessed). Hence, the content of the reader is valid only until the next
+		call to ProcessPacket(), ProcessBatch() or ReleaseInfoPartition().
 	*/
 	virtual int ProcessPacket(const unsigned char *PktData, int PktLen)=0;
 
+	/*!
+		\brief Returns the info partition (i.e., the raw extracted fields) of the last packet processed by ProcessPacket().
+
+		The returned buffer is owned by the NetVM and it is not copied: it is a borrowed view that remains
+		valid until the next call to ProcessPacket(), ProcessBatch() or ReleaseInfoPartition().
+		Applications that need to keep it longer must copy it.
+
+		\param InfoLen		on return, it contains the length of the info partition.
+
+		\return A pointer to the info partition, or NULL if the last packet has not been accepted
+		(or the partition has already been released).
+	*/
+	virtual const unsigned char *GetInfoPartition(int *InfoLen)=0;
+
+	/*!
+		\brief Releases the info partition of the last packet processed by ProcessPacket().
+
+		After this call neither the pointer returned by GetInfoPartition() nor the nbExtractedFieldsReader
+		can be used to access the fields of that packet anymore.
+	*/
+	virtual void ReleaseInfoPartition()=0;
+
+	/*!
+		\brief Processes a batch of packets.
+
+		This method is equivalent to calling ProcessPacket() on each packet of the batch, but the
+		cost of pushing packets into the NetVM is paid once for the whole batch. It should be preferred
+		when packets are already available in groups (e.g., from a capture buffer).
+
+		\param PktData		array of 'NumPkts' pointers to the packet buffers.
+		\param PktLen		array of 'NumPkts' packet lengths.
+		\param NumPkts		number of packets in the batch.
+
+		\param Results		caller-allocated array of 'NumPkts' elements that, on return, contains
+		the verdict of each packet (nbSUCCESS if the packet has been accepted by the filter,
+		nbFAILURE otherwise).
+
+		\param InfoData		caller-allocated buffer of 'NumPkts * InfoSize' bytes that, on return,
+		contains the info partition (i.e., the extracted fields) of each accepted packet, one slot
+		every 'InfoSize' bytes. It can be NULL if extracted fields are not needed.
+
+		\param InfoSize		size of each slot of the 'InfoData' buffer.
+
+		\return The number of packets accepted by the filter, or nbFAILURE in case of errors.
+		In the latter case, the error message can be retrieved through GetLastError().
+
+		\note The nbExtractedFieldsReader is not updated by this method; call LoadBatchResult()
+		to parse the extracted fields of a given packet of the batch.
+	*/
+	virtual int ProcessBatch(const unsigned char **PktData, const int *PktLen, int NumPkts, int *Results, unsigned char *InfoData= NULL, int InfoSize= 0)=0;
+
+	/*!
+		\brief Loads the extracted fields of a packet of the last batch into the nbExtractedFieldsReader.
+
+		After this call, the nbExtractedFieldsReader returned by GetExtractedFieldsReader() refers to
+		the given packet, exactly as if it was processed by ProcessPacket().
+		The buffers passed to the last ProcessBatch() must still be valid.
+
+		\param Index		position of the packet within the last batch.
+
+		\return nbSUCCESS if the packet has been accepted and its fields have been loaded,
+		nbFAILURE if the packet has been rejected, if the index is out of range, or if the last
+		batch did not collect the info partitions.
+	*/
+	virtual int LoadBatchResult(int Index)=0;
+
 	/*!
 		\brief Gets the list of error/warning messages generated during the initialization or compilation phases
 
@@ -312,6 +383,224 @@ public:
 		\return pointer to the nvmRuntimeEnvironment structure if it's initialized, NULL otherwise
 	*/
 	virtual struct _nvmRuntimeEnvironment *GetNetVMRuntimeEnvironment(void)=0;
+
+	/*!
+		\brief Replaces the running filter with a new one, without stopping the engine.
+
+		The new filter is compiled (with the link layer and the optimization flag of the last call
+		to Compile()) and its runtime environment is created while the current one is still in place;
+		then the two are swapped, and the next packet is processed by the new filter. No packet is
+		lost, and in case of failure the current filter keeps running untouched.
+
+		If InitNetVM() has not been called yet, the filter is simply compiled for it.
+
+		\param NetPFLFilterString	Filter string in the NetPFL language.
+
+		\return nbSUCCESS if the new filter is running, nbFAILURE otherwise.
+		In the latter case, the error message can be retrieved through GetLastError().
+
+		\note The previous runtime environment is destroyed at the next call to ProcessPacket(),
+		ProcessBatch() or ReleaseInfoPartition(), so the info partition of the last packet (and the
+		previous nbExtractedFieldsReader) can still be used until then. GetExtractedFieldsReader()
+		must be called again, since the new filter has its own reader.
+	*/
+	virtual int SwapFilter(const char *NetPFLFilterString)=0;
+
+	/*!
+		\brief Adds a filter to the filter set run by the engine.
+
+		The members of the filter set are compiled into a single program (see nbNetPFLCompiler::CompileFilterSet()),
+		which accepts a packet if at least one of them matches; the program is replaced as in SwapFilter().
+		The first call replaces the filter compiled with Compile() or SwapFilter(), if any.
+		Members must not extract fields, since the info partition holds the match bitmap of the set.
+
+		\param NetPFLFilterString	Filter string in the NetPFL language.
+		\param FilterID			On return, it contains the ID of the new member.
+
+		\return nbSUCCESS if the new filter set is running, nbFAILURE otherwise (the current one keeps running).
+	*/
+	virtual int AddFilter(const char *NetPFLFilterString, int *FilterID)=0;
+
+	/*!
+		\brief Removes a filter from the filter set run by the engine.
+
+		This does not require any compilation: packets matched only by the removed member are
+		discarded from the next packet on, and the member is dropped from the program at the next AddFilter().
+
+		\param FilterID			ID returned by AddFilter().
+
+		\return nbSUCCESS if no error occurred, nbFAILURE if the filter is not a member of the set.
+	*/
+	virtual int RemoveFilter(int FilterID)=0;
+
+	/*!
+		\brief Tells whether a member of the filter set matches the last packet processed by ProcessPacket().
+
+		\param FilterID			ID returned by AddFilter().
+
+		\return nbSUCCESS if the member matches the packet, nbFAILURE if it does not, if the packet has
+		been rejected, if its info partition has been released, or if the filter is not a member of the set.
+	*/
+	virtual int IsFilterMatched(int FilterID)=0;
+};
+
+
+/*!
+	\brief Prototype of the function that receives the packets accepted by a nbParallelPacketEngine.
+
+	This function is invoked by the worker threads, hence it must be thread-safe. Within the same worker,
+	packets are delivered in the same order they were submitted; packets belonging to the same flow are
+	always processed by the same worker.
+
+	\param WorkerID		ID of the worker that processed the packet (from 0 to NumWorkers - 1).
+	\param PktData			Pointer to the packet buffer (valid only during the callback).
+	\param PktLen			Length of the packet.
+	\param FieldReader		The nbExtractedFieldsReader of the worker, set on the fields of this packet
+	(valid only during the callback); NULL if the filter does not extract any field.
+	\param UserData		The user data passed to nbParallelPacketEngine::InitNetVM().
+*/
+typedef void (nbPacketEngineResultCallback)(int WorkerID, const unsigned char *PktData, int PktLen, nbExtractedFieldsReader *FieldReader, void *UserData);
+
+
+/*!
+	\brief This class allows filtering and extracting selected fields from network packets on multiple cores.
+
+	The NetPFL filter is compiled (and assembled into NetIL bytecode) only once, then a set of workers is
+	created. Each worker owns an independent NetVM runtime environment (with its own exchange buffers,
+	data memory and coprocessor instances) and runs on its own thread.
+
+	Packets submitted through ProcessPacket() are copied into the queue of the worker selected by hashing
+	the flow (IP addresses, protocol and ports), so that the packets of the same flow are always processed
+	in order. Packets accepted by the filter are delivered to the callback registered with InitNetVM().
+
+	The nbParallelPacketEngine class must be allocated using the nbAllocateParallelPacketEngine() function
+	because is an abstract class. The de-allocation is done through the nbDeallocateParallelPacketEngine() function.
+*/
+class DLL_EXPORT nbParallelPacketEngine
+{
+
+public:
+
+	/*!
+		\brief	Object constructor
+	*/
+	nbParallelPacketEngine() {};
+
+	/*!
+		\brief	Object destructor
+	*/
+	virtual ~nbParallelPacketEngine(void) {};
+
+	/*!
+		\brief Compiles a NetPFL filter; the result is shared among all the workers.
+
+		\param NetPFLFilterString	Filter string in the NetPFL language.
+		\param LinkLayer			Link layer type of the packets we want to filter (e.g., Ethernet).
+		\param Opt					Flag that turns the frontend optimizations on.
+
+		\return nbSUCCESS if the filter has been compiled successfully, nbFAILURE otherwise.
+	*/
+	virtual int Compile(const char* NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt = true)=0;
+
+	/*!
+		\brief Binds a worker to the given CPU.
+
+		It must be called before InitNetVM(); by default workers are not bound to any CPU.
+
+		\param WorkerID		ID of the worker (from 0 to NumWorkers - 1).
+		\param CPU			Index of the CPU the worker has to run on.
+
+		\return nbSUCCESS if no error occurred, nbFAILURE otherwise.
+	*/
+	virtual int SetWorkerAffinity(int WorkerID, int CPU)=0;
+
+	/*!
+		\brief	Creates the runtime environment of each worker and starts the worker threads.
+
+		It must be called after the Compile method and before the Process one.
+
+		\param ResultCallback	Function invoked (by the worker threads) for each packet accepted by the filter.
+		\param UserData			Opaque pointer passed back to 'ResultCallback'.
+
+		\return nbSUCCESS if in the initialization no error occurred, nbFAILURE otherwise.
+	*/
+	virtual int InitNetVM(nbPacketEngineResultCallback *ResultCallback, void *UserData)=0;
+
+	/*!
+		\brief Submits a packet to the worker responsible for its flow.
+
+		The packet is copied, so the buffer can be reused as soon as this method returns.
+
+		\param PktData		Pointer to the buffer containing the packet.
+		\param PktLen		Length of the packet.
+
+		\return nbSUCCESS if the packet has been queued, nbFAILURE if the queue of the worker is full
+		(the packet is dropped and accounted in the statistics of the worker) or in case of errors.
+	*/
+	virtual int ProcessPacket(const unsigned char *PktData, int PktLen)=0;
+
+	/*!
+		\brief Replaces the running filter with a new one, while the workers keep processing packets.
+
+		The new filter is compiled (with the link layer and the optimization flag of the last call to Compile())
+		and a runtime environment is created for each worker, then each worker switches to it as soon as it
+		completes the packets it is processing: packets already in progress are completed by the previous filter,
+		all the others are processed by the new one, and no packet is dropped. The method returns when
+		all the workers have switched; in case of failure, the current filter keeps running untouched.
+
+		It must not be called concurrently with Compile(), InitNetVM() or another SwapFilter().
+
+		\param NetPFLFilterString	Filter string in the NetPFL language.
+
+		\return nbSUCCESS if the new filter is running, nbFAILURE otherwise.
+	*/
+	virtual int SwapFilter(const char *NetPFLFilterString)=0;
+
+	/*!
+		\brief Waits until all the packets submitted so far have been processed by the workers.
+
+		\return nbSUCCESS if no error occurred, nbFAILURE otherwise.
+	*/
+	virtual int Flush()=0;
+
+	/*!
+		\brief Returns the number of workers of this engine.
+	*/
+	virtual int GetNumWorkers()=0;
+
+	/*!
+		\brief Returns the statistics of the given worker.
+
+		\param WorkerID		ID of the worker (from 0 to NumWorkers - 1).
+		\param NumProcessed	Number of packets processed by the worker.
+		\param NumAccepted	Number of packets accepted by the filter.
+		\param NumDropped	Number of packets dropped because the queue of the worker was full.
+
+		\return nbSUCCESS if no error occurred, nbFAILURE otherwise.
+	*/
+	virtual int GetWorkerStats(int WorkerID, uint64_t *NumProcessed, uint64_t *NumAccepted, uint64_t *NumDropped)=0;
+
+	/*!
+		\brief Gets the compiled code of the filter (NETIL code)
+
+		\return a pointer to the compiled code if it exists, NULL otherwise
+	*/
+	virtual char* GetCompiledCode()=0;
+
+	/*!
+		\brief Gets the list of error/warning messages generated during the compilation phase
+
+		\return a list of _nbNetPFLCompilerMessages structures
+	*/
+	virtual _nbNetPFLCompilerMessages *GetCompMessageList(void)=0;
+
+	/*!
+		\brief Returns a string keeping the last error message that occurred within the current instance of the class
+
+		\return A buffer that keeps the last error message.
+		This buffer will always be NULL terminated.
+	*/
+	virtual char *GetLastError()=0;
 };
 
 
@@ -338,6 +627,56 @@ DLL_EXPORT nbPacketEngine *nbAllocatePacketEngine(bool UseJit, char *ErrBuf, int
 DLL_EXPORT void nbDeallocatePacketEngine(nbPacketEngine *PacketEngine);
 
 
+/*!
+	\brief Returns a pointer to a real object that has the same interface of the nbParallelPacketEngine abstract class, or NULL in case of error.
+
+	\param NumWorkers		Number of workers (i.e., threads and NetVM runtime environments) to be created.
+	\param UseJit			Sets the NetVM for using jitted (native) code.
+	\param ErrBuf: user-allocated buffer (of length 'ErrBufSize') that will eventually
+	keep an error message (if one).
+
+	\param ErrBufSize: the length of the buffer that keeps the error message.
+
+	\return A nbParallelPacketEngine object if no errors occurred, NULL otherwise.
+	In case of failure, the error message is returned into the ErrBuf buffer.
+*/
+DLL_EXPORT nbParallelPacketEngine *nbAllocateParallelPacketEngine(int NumWorkers, bool UseJit, char *ErrBuf, int ErrBufSize);
+
+
+/*!
+	\brief  De-allocates the nbParallelPacketEngine object
+
+	\param	ParallelPacketEngine Pointer to the object that has to be deallocated.
+*/
+DLL_EXPORT void nbDeallocateParallelPacketEngine(nbParallelPacketEngine *ParallelPacketEngine);
+
+
+/*!
+	\brief Enables (or disables) the cache of compiled filters shared by all the packet engines of the process.
+
+	When the cache is enabled, the Compile() method of the packet engines looks for the filter in the cache
+	first; in case of hit, the NetPFL compiler and the NetIL assembler are not invoked at all.
+	Filters are identified by the filter string, the link layer, the optimization flag and the fingerprint
+	of the NetPDL database, hence a cached filter is never used with a different database.
+	Please note that no debug files (e.g. the dump of the NetIL code) are generated when a cached filter is used.
+
+	This function must not be called while other threads are compiling filters.
+
+	\param MaxEntries Number of filters kept in memory (the least recently used ones are discarded first);
+	'0' means that filters are not kept in memory.
+	\param CacheDir Directory (which must exist) in which filters are saved, so that they can be reused by
+	other processes; NULL means that filters are not saved on disk. The cache is disabled if 'MaxEntries'
+	is '0' and 'CacheDir' is NULL.
+	\param ErrBuf: user-allocated buffer (of length 'ErrBufSize') that will eventually
+	keep an error message (if one).
+	\param ErrBufSize: the length of the buffer that keeps the error message.
+
+	\return nbSUCCESS if the cache has been configured, nbFAILURE otherwise.
+	In case of failure, the error message is returned into the ErrBuf buffer.
+*/
+DLL_EXPORT int nbSetCompileCache(unsigned int MaxEntries, const char *CacheDir, char *ErrBuf, int ErrBufSize);
+
+
 /*!
 	\}
 */
@@ -307,6 +307,7 @@ typedef struct _nbPDMLField
 	struct _nbPDMLField *PreviousField;		//!< Pointer to the field that precedes the current one (if any).
 	struct _nbPDMLField *NextField;			//!< Pointer to the field that follows the current one (if any).
 	struct _nbPDMLField *FirstChild;		//!< Pointer to the first child field contained in the packet.
+	unsigned long Ordinal;					//!< Ordinal number of the field within the packet; reserved to the NetPDL engine, which uses it to index the fields.
 } _nbPDMLField;
 
 
@@ -569,6 +570,27 @@ public:
 	*/
 	virtual int GetPDMLField(unsigned long PacketNumber, char *ProtoName, char *FieldName, _nbPDMLField *FirstField, _nbPDMLField **ExtractedField) = 0;
 
+	/*!
+		\brief It generates the string attributes of a PDML field that have not been formatted yet.
+
+		This function is needed only when the nbPacketDecoder has been created with the
+		nbDECODER_DEFERFIELDFORMAT flag: in this case, the 'value', 'showvalue', 'showmap' and
+		'showdtl' members of the fields of the current packet are NULL until the field is formatted.
+		Fields returned by GetPDMLField() are already formatted; this function is needed for the
+		fields reached by walking the structures returned by GetCurrentPacket().
+
+		Fields that have already been formatted (and fields that do not belong to the current
+		packet) are left untouched.
+
+		\param PDMLField: pointer to the field that has to be formatted.
+
+		\return nbSUCCESS if everything is fine, nbFAILURE if some error occurred.
+		In case of error, the error message can be retrieved by the GetLastError() method.
+
+		\warning The returned strings are valid until a new packet is decoded.
+	*/
+	virtual int FormatPDMLField(_nbPDMLField *PDMLField) = 0;
+
 	/*! 
 		\brief Return a string keeping the last error message that occurred within the current instance of the class
 
@@ -234,6 +234,23 @@ typedef enum
 } nvmRuntimeOptions;
 
 
+//! Matchers that can be used by the string-matching coprocessor
+typedef enum
+{
+	nvmSTRINGMATCH_AUTO = 0,		//!< Vectorised matcher for groups of a few patterns, Aho-Corasick for the others (default)
+	nvmSTRINGMATCH_AHOCORASICK,		//!< Aho-Corasick automaton for all the groups
+	nvmSTRINGMATCH_SIMD				//!< Vectorised matcher for all the groups, whatever their size
+} nvmStringMatchEngine;
+
+
+//! Matchers that can be used by the regular expression coprocessor
+typedef enum
+{
+	nvmREGEXP_AUTO = 0,				//!< Patterns scanned at once by a lazy DFA, confirmed by pcre when they match (default)
+	nvmREGEXP_PCRE					//!< Every pattern tried by pcre on its own
+} nvmRegExpEngine;
+
+
 //! Contains some general information on a given compiler backend
 typedef struct _nvmBackendDescriptor
 {
@@ -444,6 +461,23 @@ DLL_EXPORT nvmByteCode *nvmAssembleNetILFromFile(char *FileName, char *ErrBuf);
 */
 DLL_EXPORT nvmByteCode *nvmLoadBytecodeImage(char *FileName, char *ErrBuf);
 
+/*!
+  \brief  Loads a bytecode image from a memory buffer (e.g. one returned by nvmGetBytecodeImage()).
+  \param  Image	Pointer to the buffer containing the bytecode image; it is copied, hence it can be released after this call.
+  \param  ImageSize	Size of the buffer.
+  \param  ErrBuf	error buffer
+  \return A pointer to bytecode or NULL 
+*/
+DLL_EXPORT nvmByteCode *nvmLoadBytecodeImageFromBuffer(const void *Image, uint32_t ImageSize, char *ErrBuf);
+
+/*!
+  \brief  Returns the contiguous image of a bytecode object, i.e. the same content that nvmSaveBinaryFile() would write.
+  \param  bytecode	Pointer to the bytecode object.
+  \param  ImageSize	Pointer to a variable that will keep the size of the image.
+  \return A pointer to the image, which belongs to the bytecode object and is valid until nvmDestroyBytecode() is called.
+*/
+DLL_EXPORT const void *nvmGetBytecodeImage(nvmByteCode *bytecode, uint32_t *ImageSize);
+
 /*!
   \brief  Save a bytecode image into a file.
   \param  bytecode	Pointer to the bytecode image
@@ -475,6 +509,24 @@ DLL_EXPORT nvmRuntimeEnvironment *nvmCreateRTEnv(nvmNetVM *netVMApp, uint32_t fl
 */
 DLL_EXPORT void nvmDestroyRTEnv(nvmRuntimeEnvironment *RTObj);
 
+/*!
+  \brief	Selects the matcher used by the string-matching coprocessor.
+
+  The setting applies to the coprocessors that are initialized afterwards; both matchers
+  return the same matches. Available on the generic (x86/x64) runtime only.
+  \param	Engine	matcher to be used, according to the values in \ref nvmStringMatchEngine.
+*/
+DLL_EXPORT void nvmSetStringMatchEngine(nvmStringMatchEngine Engine);
+
+/*!
+  \brief	Selects the matcher used by the regular expression coprocessor.
+
+  The setting applies to the coprocessors that are initialized afterwards; both matchers
+  return the same results. Available on the generic (x86/x64) runtime only.
+  \param	Engine	matcher to be used, according to the values in \ref nvmRegExpEngine.
+*/
+DLL_EXPORT void nvmSetRegExpEngine(nvmRegExpEngine Engine);
+
 /*!
   \brief	Create an Application Input Interface (Push mode)  
 
@@ -552,6 +604,25 @@ DLL_EXPORT int32_t nvmWriteAppInterface(nvmAppInterface *AppInterface, uint8_t *
 DLL_EXPORT int32_t nvmWriteAppInterfaceTS(nvmAppInterface *AppInterface, uint8_t *pkt, uint32_t PktLen, nvmTStamp *tstamp, void *userData, char * ErrBuf);
 
 
+/*!
+  \brief	Send a batch of packets into NetVM through an application interface
+
+			The result is the same of calling nvmWriteAppInterfaceTS() on each packet, in order; packets
+			are processed through a single exchange buffer, and the exchange buffer management and the
+			lookup of the connected handler are done once for the whole batch (unless the profiling
+			counters are enabled, which are updated per packet).
+  \param	AppInterface	Application Interface object (must have input direction)
+  \param	Pkts			array of 'NumPkts' pointers to packets
+  \param	PktLens			array of 'NumPkts' packet sizes
+  \param	TStamps			array of 'NumPkts' time stamps (one for each packet), or NULL if packets have no time stamp (i.e., it is zero, as in nvmWriteAppInterface())
+  \param	NumPkts			number of packets in the batch
+  \param	UserData		array of 'NumPkts' user data to be passed to the callback function (one for each packet), or NULL
+  \param	ErrBuf			error buffer
+  \return	nvmSUCCESS or nvmFAILURE
+*/
+DLL_EXPORT int32_t nvmWriteAppInterfaceBatch(nvmAppInterface *AppInterface, uint8_t **Pkts, uint32_t *PktLens, nvmTStamp *TStamps, uint32_t NumPkts, void **UserData, char * ErrBuf);
+
+
 
 /*!
   \brief	Start the NetVM application 
@@ -575,6 +646,22 @@ DLL_EXPORT int32_t nvmNetStart(
 	char *ErrBuf);
 
 
+/*!
+  \brief	Enables the on-disk cache of the native code generated by the JIT
+
+			When the cache is enabled, nvmNetStart() looks for the native code of each PE handler in the
+			given folder before compiling it; entries are keyed by the bytecode of the handler, the backend,
+			the JIT flags, the optimization level and the configuration of the PE (memories, coprocessors
+			and ports). Entries that cannot be verified or relocated are ignored and overwritten.
+			The cache is disabled by default.
+  \param	RTObj			pointer to Runtime Environment object
+  \param	Dir				folder containing the cache (it must exist), or NULL to disable the cache
+  \param	ErrBuf			error buffer
+  \return	nvmSUCCESS or nvmFAILURE 
+*/
+DLL_EXPORT int32_t nvmSetJitCacheDir(nvmRuntimeEnvironment *RTObj, const char *Dir, char *ErrBuf);
+
+
 /*!
 	\brief	Receive packets from an application interface 
 	\param	AppInterface	nvmAppInterface object must have dir=in	
@@ -712,6 +799,15 @@ DLL_EXPORT int32_t nvmCompileApplication(
  */
 DLL_EXPORT char *nvmGetTargetCode(nvmRuntimeEnvironment *RTObj);
 
+
+/*!
+ * \brief   Computes the hash of a buffer, using the same function used by the NetIL hash instructions
+ * \param 	data pointer to the buffer to be hashed
+ * \param 	len length of the buffer
+ * \return	the 32-bit hash of the buffer
+ */
+DLL_EXPORT uint32_t nvmHash(uint8_t *data, uint8_t len);
+
 /*
  \}
 */
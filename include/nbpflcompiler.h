@@ -41,6 +41,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 using namespace std;
 
 
@@ -67,6 +68,9 @@ class ErrorRecorder;	//forward declaration
 #define nbNETPFLCOMPILER_MAX_PROTO_INSTANCES 5 //!< Maximum number of occurrences of a single protocol handled in the info-partition
 #define nbNETPFLCOMPILER_MAX_FIELD_INSTANCES 5 //!< Maximum number of occurrences of the same field handled in the info-partition
 
+#define nbNETPFLCOMPILER_MAX_FILTERSET_SIZE 4096	//!< Maximum number of filters that can be compiled together with nbNetPFLCompiler::CompileFilterSet()
+#define nbNETPFLCOMPILER_FILTERSET_BITMAP_SIZE(NumFilters) ((((NumFilters) + 31) / 32) * 4)	//!< Number of bytes of the info-partition holding the match bitmap of a filter set
+
 
 
 
@@ -145,8 +149,12 @@ private:
 	*/
 	void NetPDLCleanup(void);
 
-	// TODO [OM] I think this method is not useful
-	int IsInitialized(void);
+	/*!
+		\brief Copies the NetIL code generated by the Front End into GenCode and dumps it (if requested)
+		\param NetILCode String that will point to the generated NetIL code
+		\return nbSUCCESS if no error occurred, nbFAILURE otherwise
+	*/
+	int ExportNetILCode(char **NetILCode);
 
 
 	unsigned int m_debugLevel;
@@ -188,6 +196,13 @@ public:
 		return m_errbuf;
 	}
 
+	/*!
+		\brief Tells whether NetPDLInit() has already been called successfully
+
+		\return nbSUCCESS if the compiler has been initialized, nbFAILURE otherwise
+	*/
+	int IsInitialized(void);
+
 
 	/*!
 		\brief Initializes the NetPFL Compiler
@@ -235,6 +250,25 @@ public:
 	*/
 
 	int CompileFilter(const char *NetPFLFilterString, char **NetILCode, bool optimizationCycles=true);
+
+	/*!
+		\brief Compiles a set of NetPFL filters into a single NetIL program
+
+		The automata of the filters are merged, so that each header is parsed once whatever the
+		number of filters. A packet is returned if at least one filter matches it; the first
+		nbNETPFLCOMPILER_FILTERSET_BITMAP_SIZE() bytes of its info-partition hold the match bitmap,
+		as an array of 32-bit words in host byte order: bit (i % 32) of word (i / 32) is set if
+		the i-th filter matches the packet. Overlapping filters (e.g. 'ip' and 'tcp') have all their
+		bits set on the packets they share.
+
+		The filters cannot be empty and cannot have actions other than 'returnpacket'.
+
+		\param NetPFLFilterStrings	Filter strings, in the NetPFL language
+		\param NetILCode			String holding the generated NetIL code
+		\param optimizationCycles	Flag to set the optimizations
+		\return nbSUCCESS if no error occurred, nbFAILURE otherwise
+	*/
+	int CompileFilterSet(const vector<string> &NetPFLFilterStrings, char **NetILCode, bool optimizationCycles=true);
 	
 	/*!
 		\brief Create the final state automaton for a NetPFL filter
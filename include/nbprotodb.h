@@ -34,6 +34,15 @@
 #include "nbprotodb_defs.h"
 
 
+// Please remember that the same #define are present in the "Globals.h" header
+// So, please be careful to keep them aligned
+#ifndef nbSUCCESS
+	#define nbSUCCESS 0		//!< Return code for 'success'
+	#define nbFAILURE -1	//!< Return code for 'failure'
+	#define nbWARNING -2	//!< Return code for 'warning' (we can go on, but something wrong occurred)
+#endif
+
+
 
 
 /*!
@@ -47,6 +56,8 @@
 	create an internal representation of the file itself
 	- nbProtoDBXMLCleanup(): clean all the internal structures allocated at the 
 	previous step.
+	- nbProtoDBImageSave(): save the internal representation to a binary image,
+	which can be loaded with nbProtoDBImageLoad() without parsing the XML file again.
 
 	The biggest advantage of this library is that it creates a more user-friendly 
 	representation of the NetPDL database, structured as a set of 'C' structures.
@@ -56,12 +67,6 @@
 	refer to the documentation of the struct _nbNetPDLDatabase.
 */
 
-// Planned:
-//- nbProtoDBXMLSave(): save the internal representation to a binary file,
-//	which provides a more compact way to store the NetPDL database. This binary file 
-//	is still portable across different platforms.
-
-
 
 
 /*!
@@ -141,6 +146,9 @@ DLL_EXPORT struct _nbNetPDLDatabase *nbProtoDBXMLLoad(const char *FileName, int
 /*!
 	\brief Deallocates all the structures contained in the NetPDLDatabase (in memory).
 
+	This function releases the database whether it has been loaded with nbProtoDBXMLLoad()
+	or with nbProtoDBImageLoad().
+
 	\note Although some other functions may exists in other libraries, the user must be careful
 	in order to invoke the cleanup function which belongs to the same library of the function
 	user to create the database in memory.
@@ -148,20 +156,60 @@ DLL_EXPORT struct _nbNetPDLDatabase *nbProtoDBXMLLoad(const char *FileName, int
 DLL_EXPORT void nbProtoDBXMLCleanup();
 
 
-/*
-	\brief Saves the current NetPDL database on a file, for faster access.
-	This function is used in order to save the NetPDL data to an intermediate representation
-	which does not require XML to be parsed. This helps speeding up the initial NetPDL 
-	processing time.
+/*!
+	\brief Saves the current NetPDL database in a binary image, for faster access.
+
+	The image contains the database already organized, hence loading it with nbProtoDBImageLoad()
+	does not require the XML file to be parsed again. Pointers are prelinked at a preferred address
+	and a relocation table is appended, so that the image can be mapped in memory and shared
+	among processes.
+
+	The image keeps the fingerprint of the NetPDL file (_nbNetPDLDatabase::Fingerprint), so that
+	data derived from the database (e.g. compiled filters) can be checked against it.
 
 	\param FileName: name of the binary file that will contain the NetPDL description.
-	This file is platform-independent, hence it can be moved from a mathine to another.
+	The image is specific of the platform that created it (pointer size and byte order).
 	\param ErrBuf: user-allocated buffer that will contain the error message (if any).
 	\param ErrBufSize: size of the previous buffer.
-	
+
 	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
 	In the latter case, the error message is stored in the ErrBuf variable.
+
+	\note The database must have been loaded with nbProtoDBXMLLoad(). The save fails if the database
+	refers to memory that does not belong to it (e.g. a string allocated outside the protodb heap).
+*/
+DLL_EXPORT int nbProtoDBImageSave(const char *FileName, char *ErrBuf, int ErrBufSize);
+
+
+/*!
+	\brief Maps in memory a binary image of the NetPDL database created by nbProtoDBImageSave().
+
+	The image is mapped copy-on-write: pages are shared among all the processes that map the same
+	image, unless the image cannot be mapped at its preferred address (in which case pointers are
+	relocated) or a page is modified (e.g. by nbRegisterPacketDecoderCallHandle()).
+
+	\param FileName: name of the binary image.
+	\param Flags: Type of the NetPDL protocol database we want to load; it must be the same
+	the image has been created with.
+	\param ErrBuf: user-allocated buffer that will contain the error message (if any).
+	\param ErrBufSize: size of the previous buffer.
+
+	\return The _nbNetPDLDatabase structure, or NULL if something fails.
+	In the latter case, the error message is stored in the ErrBuf variable.
+
+	\note The database must be released with nbProtoDBXMLCleanup().
+*/
+DLL_EXPORT struct _nbNetPDLDatabase *nbProtoDBImageLoad(const char *FileName, int Flags, char *ErrBuf, int ErrBufSize);
+
+
+/*!
+	\brief Checks whether a file contains a binary image of the NetPDL database.
+
+	\param FileName: name of the file.
+
+	\return nbSUCCESS if the file is an image created by nbProtoDBImageSave(), nbFAILURE otherwise
+	(e.g. it is a NetPDL XML file).
 */
-//DLL_EXPORT int nbProtoDBXMLSave(const char *FileName, char *ErrBuf, int ErrBufSize);
+DLL_EXPORT int nbProtoDBIsImage(const char *FileName);
 
 
@@ -669,6 +669,10 @@ enum nbProtoDBFlags
 		//! Pointer to the first expression of the NetPDL file; expressions are linked to each other through a list of pointers.
 		//! This allow to scan (outside the NetPDLDatabase module) all the expressions and to do some processing on them.
 		struct _nbNetPDLExprBase* ExpressionList;
+
+		//! Hash of the content of the NetPDL file this database has been loaded from; it changes whenever
+		//! the file changes, hence it can be used to validate data derived from the database (e.g. compiled filters).
+		uint64_t Fingerprint;
 	};
 
 
@@ -1899,7 +1903,9 @@ enum nbProtoDBFlags
 	some processing on it.																					\
 	This member is filled only in 'root' expressions, i.e. the first element of a complex expression.		\
 	*/																											\
-	struct _nbNetPDLExprBase *NextExpression;
+	struct _nbNetPDLExprBase *NextExpression;																	\
+	/*! \brief Reserved to the NetPDL engine, which keeps here the compiled code of 'root' expressions. */		\
+	void *CompiledCode;
 #else
 	/*!
 	\brief This structure defines the first part of the structure associated to any operand.
@@ -1924,7 +1930,9 @@ enum nbProtoDBFlags
 	some processing on it.																					\
 	This member is filled only in 'root' expressions, i.e. the first element of a complex expression.		\
 	*/																											\
-	struct _nbNetPDLExprBase *NextExpression;
+	struct _nbNetPDLExprBase *NextExpression;																	\
+	/*! \brief Reserved to the NetPDL engine, which keeps here the compiled code of 'root' expressions. */		\
+	void *CompiledCode;
 #endif
 
 
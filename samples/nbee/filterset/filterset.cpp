@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following condition
+ * is met:
+ *
+ * Neither the name of the Politecnico di Torino nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pcap.h>
+#include <nbee.h>
+
+
+
+#define DEFAULT_CAPTUREFILENAME "samplecapturedump.acp"
+#define MAX_FILTERS 32
+
+
+typedef struct _ConfigParams
+{
+	const char*	NetPDLFileName;
+	const char*	CaptureFileName;
+	bool		UseJit;
+	const char*	Filters[MAX_FILTERS];
+	int		NumFilters;
+} ConfigParams_t;
+
+
+// Global variable for configuration
+ConfigParams_t ConfigParams;
+
+
+
+void Usage()
+{
+char string[]= \
+	"\nUsage:\n"	\
+	"  filterset [options] [filter1] [filter2] ...\n\n"	\
+	"Options:\n                                                                     \n"	\
+	" -netpdl filename                                                              \n"	\
+	"        Name of the file containing the NetPDL description. In case it is      \n"	\
+	"        omitted, the NetPDL description embedded within the NetBee library will\n"	\
+	"        be used.                                                               \n"	\
+	" -r filename                                                                   \n"	\
+	"        Name of the file containing the packet dump that has to be opened      \n"	\
+	"        (default: samplecapturedump.acp).                                      \n"	\
+	" -jit                                                                          \n"	\
+	"        Make NetVM to use the native code on the current platform instead of   \n"	\
+	"        NetIL code; by default the NetIL code is used (for safety reasons).    \n"	\
+	" [filter1] [filter2] ...                                                       \n" \
+	"        Members of the filter set, in the NetPFL language (default: 'ip' and   \n" \
+	"        'tcp'). Members may overlap: each packet lists all the members that    \n" \
+	"        match it.                                                              \n" \
+	" -h: prints this help message.\n\n"												\
+	"Description\n"																		\
+	"=============================================================================\n"	\
+	"This program runs a set of filters with a single pass over each packet, and\n"	\
+	"prints the members of the set matched by each accepted packet.\n\n";
+
+	fprintf(stderr, "%s", string);
+}
+
+
+int ParseCommandLine(int argc, char *argv[])
+{
+int CurrentItem;
+
+	CurrentItem= 1;
+
+	// Default values
+	ConfigParams.UseJit= 0;
+	ConfigParams.CaptureFileName= DEFAULT_CAPTUREFILENAME;
+	ConfigParams.NumFilters= 0;
+	// End defaults
+
+
+	while (CurrentItem < argc)
+	{
+		if (strcmp(argv[CurrentItem], "-netpdl") == 0)
+		{
+			ConfigParams.NetPDLFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-r") == 0)
+		{
+			ConfigParams.CaptureFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-jit") == 0)
+		{
+			ConfigParams.UseJit= 1;
+			CurrentItem+= 1;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-h") == 0)
+		{
+			Usage();
+			return nbFAILURE;
+		}
+
+		if (argv[CurrentItem][0] == '-')
+		{
+			printf("\n\tError: parameter '%s' is not valid.\n", argv[CurrentItem]);
+			return nbFAILURE;
+		}
+
+		// Current parameter is a member of the filter set, which does not have any switch (e.g. '-something') in front
+		if (ConfigParams.NumFilters == MAX_FILTERS)
+		{
+			printf("\n\tError: no more than %d filters are allowed.\n", MAX_FILTERS);
+			return nbFAILURE;
+		}
+
+		ConfigParams.Filters[ConfigParams.NumFilters++]= argv[CurrentItem++];
+	}
+
+	// The default members overlap, since each TCP packet is an IP packet as well
+	if (ConfigParams.NumFilters == 0)
+	{
+		ConfigParams.Filters[ConfigParams.NumFilters++]= "ip";
+		ConfigParams.Filters[ConfigParams.NumFilters++]= "tcp";
+	}
+
+	return nbSUCCESS;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+char ErrBuf[PCAP_ERRBUF_SIZE + 1] = "";
+
+// Pcap related structures
+pcap_t *PcapHandle = NULL;
+
+nbPacketEngine *PacketEngine;
+int FilterIDs[MAX_FILTERS];
+int MatchCounters[MAX_FILTERS];
+int PacketCounter;
+int AcceptedPkts;
+int i;
+
+	if (ParseCommandLine(argc, argv) == nbFAILURE)
+		return nbFAILURE;
+
+	fprintf(stderr, "\nLoading NetPDL protocol database...\n");
+
+	if (ConfigParams.NetPDLFileName)
+	{
+		if (nbInitialize(ConfigParams.NetPDLFileName, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			fprintf(stderr, "Trying to use the NetPDL database embedded in the NetBee library instead.\n");
+		}
+	}
+
+	// In case the NetBee library has not been initialized
+	// initialize right now with the embedded NetPDL protocol database instead
+	if (nbIsInitialized() == nbFAILURE)
+	{
+		if (nbInitialize(NULL, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			return nbFAILURE;
+		}
+	}
+
+	fprintf(stderr, "NetPDL Protocol database loaded.\n\n");
+
+	PacketEngine= nbAllocatePacketEngine(ConfigParams.UseJit, ErrBuf, sizeof(ErrBuf));
+	if (PacketEngine == NULL)
+	{
+		fprintf(stderr, "Error retrieving the PacketEngine: %s", ErrBuf);
+		return nbFAILURE;
+	}
+
+	// Each member recompiles the whole set, so that the headers are parsed once for all the members
+	for (i= 0; i < ConfigParams.NumFilters; i++)
+	{
+		fprintf(stderr, "Adding filter \'%s\' to the filter set...\n", ConfigParams.Filters[i]);
+
+		if (PacketEngine->AddFilter(ConfigParams.Filters[i], &FilterIDs[i]) == nbFAILURE)
+		{
+			fprintf(stderr, "Error adding the filter '%s': %s", ConfigParams.Filters[i], PacketEngine->GetLastError());
+			return nbFAILURE;
+		}
+
+		MatchCounters[i]= 0;
+	}
+
+	if (PacketEngine->InitNetVM(nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE)== nbFAILURE)
+	{
+		fprintf(stderr, "Error initializing the netVM : %s", PacketEngine->GetLastError());
+		return nbFAILURE;
+	}
+
+	if ((PcapHandle= pcap_open_offline(ConfigParams.CaptureFileName, ErrBuf)) == NULL)
+	{
+		fprintf(stderr, "Cannot open the capture source file: %s\n", ErrBuf);
+		return nbFAILURE;
+	}
+
+	fprintf(stderr, "\nReading network packets from file: %s \n\n", ConfigParams.CaptureFileName);
+	fprintf(stderr, "===============================================================================\n");
+
+	// Initialize packet counters
+	PacketCounter= 0;
+	AcceptedPkts= 0;
+
+	while (1)
+	{
+	struct pcap_pkthdr *PktHeader;
+	const unsigned char *PktData;
+	int RetVal;
+
+		RetVal= pcap_next_ex(PcapHandle, &PktHeader, &PktData);
+
+		if (RetVal == -2)
+			break;		// capture file ended
+
+		if (RetVal < 0)
+		{
+			fprintf(stderr, "Cannot read packet: %s\n", pcap_geterr(PcapHandle));
+			return nbFAILURE;
+		}
+
+		PacketCounter++;
+
+		if (PacketEngine->ProcessPacket(PktData, PktHeader->len) == nbFAILURE)
+			continue;
+
+		AcceptedPkts++;
+
+		printf("Packet %d matches:", PacketCounter);
+
+		// A packet can match several members, e.g. both 'ip' and 'tcp'
+		for (i= 0; i < ConfigParams.NumFilters; i++)
+		{
+			if (PacketEngine->IsFilterMatched(FilterIDs[i]) == nbSUCCESS)
+			{
+				MatchCounters[i]++;
+				printf(" '%s'", ConfigParams.Filters[i]);
+			}
+		}
+
+		printf("\n");
+	}
+
+	fprintf(stderr, "\n\nThe filter set accepted %d out of %d packets\n", AcceptedPkts, PacketCounter);
+
+	for (i= 0; i < ConfigParams.NumFilters; i++)
+		fprintf(stderr, "\tfilter '%s' matched %d packets\n", ConfigParams.Filters[i], MatchCounters[i]);
+
+	if (PcapHandle)
+		pcap_close(PcapHandle);
+
+	nbDeallocatePacketEngine(PacketEngine);
+	nbCleanup();
+
+	return nbSUCCESS;
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following condition
+ * is met:
+ *
+ * Neither the name of the Politecnico di Torino nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pcap.h>
+#include <nbee.h>
+
+
+
+#define DEFAULT_CAPTUREFILENAME "samplecapturedump.acp"
+#define DEFAULT_FILTER "ip extractfields(ip.src,ip.dst)"
+#define DEFAULT_NUMWORKERS 2
+#define MAX_WORKERS 64
+
+
+typedef struct _ConfigParams
+{
+	const char*	NetPDLFileName;
+	const char*	CaptureFileName;
+	bool		UseJit;
+	int		NumWorkers;
+	const char*	Filter;
+	const char*	SwapFilter;
+} ConfigParams_t;
+
+
+// Global variable for configuration
+ConfigParams_t ConfigParams;
+
+// Packets (and fields) delivered to the callback; each worker updates only its own counters
+int AcceptedPkts[MAX_WORKERS];
+int ExtractedFields[MAX_WORKERS];
+
+
+
+void Usage()
+{
+char string[]= \
+	"\nUsage:\n"	\
+	"  parallelengine [options] [filter]\n\n"	\
+	"Options:\n                                                                     \n"	\
+	" -netpdl filename                                                              \n"	\
+	"        Name of the file containing the NetPDL description. In case it is      \n"	\
+	"        omitted, the NetPDL description embedded within the NetBee library will\n"	\
+	"        be used.                                                               \n"	\
+	" -r filename                                                                   \n"	\
+	"        Name of the file containing the packet dump that has to be opened      \n"	\
+	"        (default: samplecapturedump.acp).                                      \n"	\
+	" -jit                                                                          \n"	\
+	"        Make NetVM to use the native code on the current platform instead of   \n"	\
+	"        NetIL code; by default the NetIL code is used (for safety reasons).    \n"	\
+	" -workers number                                                               \n"	\
+	"        Number of workers of the engine (default: 2).                          \n"	\
+	" -swap filter                                                                  \n"	\
+	"        Filter that replaces the first one (through SwapFilter()) once the     \n"	\
+	"        capture has been processed; the capture is then processed again.      \n"	\
+	" [filter]                                                                      \n" \
+	"        Filter in the NetPFL language                                          \n" \
+	"        (default: 'ip extractfields(ip.src,ip.dst)').                          \n" \
+	" -h: prints this help message.\n\n"												\
+	"Description\n"																		\
+	"=============================================================================\n"	\
+	"This program creates a parallel packet engine, compiles the filter, runs the\n"	\
+	"packets of the capture through the workers and destroys the engine, printing\n"	\
+	"the statistics of each worker. It is useful also to check the whole life of\n"	\
+	"the engine with a memory debugger (e.g. valgrind).\n\n";
+
+	fprintf(stderr, "%s", string);
+}
+
+
+int ParseCommandLine(int argc, char *argv[])
+{
+int CurrentItem;
+
+	CurrentItem= 1;
+
+	// Default values
+	ConfigParams.UseJit= 0;
+	ConfigParams.CaptureFileName= DEFAULT_CAPTUREFILENAME;
+	ConfigParams.NumWorkers= DEFAULT_NUMWORKERS;
+	ConfigParams.Filter= DEFAULT_FILTER;
+	// End defaults
+
+
+	while (CurrentItem < argc)
+	{
+		if (strcmp(argv[CurrentItem], "-netpdl") == 0)
+		{
+			ConfigParams.NetPDLFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-r") == 0)
+		{
+			ConfigParams.CaptureFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-jit") == 0)
+		{
+			ConfigParams.UseJit= 1;
+			CurrentItem+= 1;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-workers") == 0)
+		{
+			ConfigParams.NumWorkers= atoi(argv[CurrentItem+1]);
+			CurrentItem+= 2;
+
+			if ((ConfigParams.NumWorkers < 1) || (ConfigParams.NumWorkers > MAX_WORKERS))
+			{
+				printf("\n\tError: the number of workers must be between 1 and %d.\n", MAX_WORKERS);
+				return nbFAILURE;
+			}
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-swap") == 0)
+		{
+			ConfigParams.SwapFilter= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-h") == 0)
+		{
+			Usage();
+			return nbFAILURE;
+		}
+
+		if (argv[CurrentItem][0] == '-')
+		{
+			printf("\n\tError: parameter '%s' is not valid.\n", argv[CurrentItem]);
+			return nbFAILURE;
+		}
+
+		// Current parameter is the filter, which does not have any switch (e.g. '-something') in front
+		ConfigParams.Filter= argv[CurrentItem];
+		CurrentItem++;
+	}
+
+	return nbSUCCESS;
+}
+
+
+// Invoked by the worker threads
+void ResultCallback(int WorkerID, const unsigned char *PktData, int PktLen, nbExtractedFieldsReader *FieldReader, void *UserData)
+{
+_nbExtractedFieldsDescriptorVector *DescriptorVector;
+int i;
+
+	AcceptedPkts[WorkerID]++;
+
+	if (FieldReader == NULL)
+		return;
+
+	DescriptorVector= FieldReader->GetFields();
+
+	for (i= 0; i < DescriptorVector->NumEntries; i++)
+	{
+		if (FieldReader->IsValid(&DescriptorVector->FieldDescriptor[i]) == nbSUCCESS)
+			ExtractedFields[WorkerID]++;
+	}
+}
+
+
+// Submits all the packets of the capture file to the engine
+int ProcessCaptureFile(nbParallelPacketEngine *ParallelEngine, int *PacketCounter)
+{
+char ErrBuf[PCAP_ERRBUF_SIZE + 1] = "";
+pcap_t *PcapHandle;
+
+	if ((PcapHandle= pcap_open_offline(ConfigParams.CaptureFileName, ErrBuf)) == NULL)
+	{
+		fprintf(stderr, "Cannot open the capture source file: %s\n", ErrBuf);
+		return nbFAILURE;
+	}
+
+	fprintf(stderr, "Reading network packets from file: %s \n", ConfigParams.CaptureFileName);
+
+	while (1)
+	{
+	struct pcap_pkthdr *PktHeader;
+	const unsigned char *PktData;
+	int RetVal;
+
+		RetVal= pcap_next_ex(PcapHandle, &PktHeader, &PktData);
+
+		if (RetVal == -2)
+			break;		// capture file ended
+
+		if (RetVal < 0)
+		{
+			fprintf(stderr, "Cannot read packet: %s\n", pcap_geterr(PcapHandle));
+			pcap_close(PcapHandle);
+			return nbFAILURE;
+		}
+
+		(*PacketCounter)++;
+
+		// Packets dropped because the queue is full are accounted in the statistics of the worker
+		ParallelEngine->ProcessPacket(PktData, PktHeader->caplen);
+	}
+
+	pcap_close(PcapHandle);
+
+	// The counters are read only after the workers have processed all the packets
+	return ParallelEngine->Flush();
+}
+
+
+
+int main(int argc, char* argv[])
+{
+char ErrBuf[PCAP_ERRBUF_SIZE + 1] = "";
+nbParallelPacketEngine *ParallelEngine;
+int PacketCounter;
+int i;
+
+	if (ParseCommandLine(argc, argv) == nbFAILURE)
+		return nbFAILURE;
+
+	fprintf(stderr, "\nLoading NetPDL protocol database...\n");
+
+	if (ConfigParams.NetPDLFileName)
+	{
+		if (nbInitialize(ConfigParams.NetPDLFileName, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			fprintf(stderr, "Trying to use the NetPDL database embedded in the NetBee library instead.\n");
+		}
+	}
+
+	// In case the NetBee library has not been initialized
+	// initialize right now with the embedded NetPDL protocol database instead
+	if (nbIsInitialized() == nbFAILURE)
+	{
+		if (nbInitialize(NULL, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			return nbFAILURE;
+		}
+	}
+
+	fprintf(stderr, "NetPDL Protocol database loaded.\n\n");
+
+	ParallelEngine= nbAllocateParallelPacketEngine(ConfigParams.NumWorkers, ConfigParams.UseJit, ErrBuf, sizeof(ErrBuf));
+	if (ParallelEngine == NULL)
+	{
+		fprintf(stderr, "Error retrieving the ParallelPacketEngine: %s", ErrBuf);
+		return nbFAILURE;
+	}
+
+	fprintf(stderr, "Compiling filter \'%s\'...\n", ConfigParams.Filter);
+
+	if (ParallelEngine->Compile(ConfigParams.Filter, nbNETPDL_LINK_LAYER_ETHERNET) == nbFAILURE)
+	{
+		fprintf(stderr, "Error compiling the filter '%s': %s", ConfigParams.Filter, ParallelEngine->GetLastError());
+		nbDeallocateParallelPacketEngine(ParallelEngine);
+		return nbFAILURE;
+	}
+
+	if (ParallelEngine->InitNetVM(ResultCallback, NULL) == nbFAILURE)
+	{
+		fprintf(stderr, "Error initializing the netVM : %s", ParallelEngine->GetLastError());
+		nbDeallocateParallelPacketEngine(ParallelEngine);
+		return nbFAILURE;
+	}
+
+	PacketCounter= 0;
+
+	if (ProcessCaptureFile(ParallelEngine, &PacketCounter) == nbFAILURE)
+	{
+		nbDeallocateParallelPacketEngine(ParallelEngine);
+		return nbFAILURE;
+	}
+
+	if (ConfigParams.SwapFilter)
+	{
+		fprintf(stderr, "Swapping to filter \'%s\'...\n", ConfigParams.SwapFilter);
+
+		if (ParallelEngine->SwapFilter(ConfigParams.SwapFilter) == nbFAILURE)
+		{
+			fprintf(stderr, "Error swapping to the filter '%s': %s", ConfigParams.SwapFilter, ParallelEngine->GetLastError());
+			nbDeallocateParallelPacketEngine(ParallelEngine);
+			return nbFAILURE;
+		}
+
+		if (ProcessCaptureFile(ParallelEngine, &PacketCounter) == nbFAILURE)
+		{
+			nbDeallocateParallelPacketEngine(ParallelEngine);
+			return nbFAILURE;
+		}
+	}
+
+	fprintf(stderr, "\n%d packets submitted to %d workers\n", PacketCounter, ParallelEngine->GetNumWorkers());
+
+	for (i= 0; i < ParallelEngine->GetNumWorkers(); i++)
+	{
+	uint64_t NumProcessed, NumAccepted, NumDropped;
+
+		ParallelEngine->GetWorkerStats(i, &NumProcessed, &NumAccepted, &NumDropped);
+
+		fprintf(stderr, "\tworker %d: %llu processed, %llu accepted, %llu dropped, %d fields extracted\n", i,
+			(unsigned long long) NumProcessed, (unsigned long long) NumAccepted, (unsigned long long) NumDropped,
+			ExtractedFields[i]);
+	}
+
+	nbDeallocateParallelPacketEngine(ParallelEngine);
+	nbCleanup();
+
+	return nbSUCCESS;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following condition 
+ * is met:
+ * 
+ * Neither the name of the Politecnico di Torino nor the names of its 
+ * contributors may be used to endorse or promote products derived from 
+ * this software without specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+// For loading and saving the protocol database, we have to include this file
+#include <nbprotodb.h>
+
+#define DEFAULT_NETPDL_DATABASE "./netpdl.xml"
+#define DEFAULT_IMAGE_FILE "./netpdl.img"
+
+const char *NetPDLFileName= DEFAULT_NETPDL_DATABASE;
+const char *ImageFileName= DEFAULT_IMAGE_FILE;
+int ProtoDBFlags= nbPROTODB_FULL;
+
+
+void Usage()
+{
+char string[]= \
+	"\nUsage:\n"	\
+	"  protodbimage [-m] [NetPDLFile] [ImageFile]\n\n"	\
+	"Options:\n"	\
+	" NetPDLFile: name (and *path*) of the file containing the NetPDL\n"				\
+	"     description (default: " DEFAULT_NETPDL_DATABASE ").\n"						\
+	" ImageFile: name (and *path*) of the binary image that has to be created\n"		\
+	"     (default: " DEFAULT_IMAGE_FILE ").\n"											\
+	" -m: creates the image of the minimal database (protocol format and\n"			\
+	"     encapsulation only).\n"														\
+	" -h: prints this help message.\n\n"												\
+	"Description\n"																		\
+	"============================================================================\n"	\
+	"This program parses a NetPDL protocol database and saves it in a binary\n"		\
+	"  image, which can be used instead of the XML file (e.g. in nbInitialize())\n"	\
+	"  and is mapped in memory without being parsed again.\n"							\
+	"The image is loaded back in order to check it, and the time needed for\n"			\
+	"  loading the XML file and the image is printed.\n"								\
+	"Please note that the image must be created again whenever the NetPDL\n"			\
+	"  file changes, and that it can be used only on the same platform.\n";
+
+	printf("%s", string);
+}
+
+
+
+int ParseCommandLine(int argc, char *argv[])
+{
+int CurrentItem;
+int NFiles= 0;
+
+	CurrentItem= 1;
+
+	while (CurrentItem < argc)
+	{
+		if (strcmp(argv[CurrentItem], "-h") == 0)
+		{
+			Usage();
+			return 0;
+		}
+
+		if (strcmp(argv[CurrentItem], "-m") == 0)
+		{
+			ProtoDBFlags= nbPROTODB_MINIMAL;
+			CurrentItem++;
+			continue;
+		}
+
+		// These should be the NetPDL file and the image
+		if ((argv[CurrentItem][0] != '-') && (NFiles < 2))
+		{
+			if (NFiles++ == 0)
+				NetPDLFileName= argv[CurrentItem];
+			else
+				ImageFileName= argv[CurrentItem];
+
+			CurrentItem++;
+			continue;
+		}
+
+		printf("Error: parameter '%s' is not valid.\n", argv[CurrentItem]);
+		return 0;
+	}
+
+	return 1;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+char ErrBuf[2048];
+struct _nbNetPDLDatabase *NetPDLProtoDB;
+unsigned long long Fingerprint;
+clock_t Start, XMLTime, ImageTime;
+
+	if (ParseCommandLine(argc, argv) == 0)
+		return 0;
+
+	printf("\n\nLoading NetPDL protocol database '%s'...\n", NetPDLFileName);
+
+	Start= clock();
+	NetPDLProtoDB= nbProtoDBXMLLoad(NetPDLFileName, ProtoDBFlags, ErrBuf, sizeof(ErrBuf));
+	XMLTime= clock() - Start;
+
+	if (NetPDLProtoDB == NULL)
+	{
+		printf("Error loading the NetPDL protocol Database: %s\n", ErrBuf);
+		return 0;
+	}
+
+	Fingerprint= NetPDLProtoDB->Fingerprint;
+
+	if (nbProtoDBImageSave(ImageFileName, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+	{
+		printf("Error saving the image of the NetPDL protocol Database: %s\n", ErrBuf);
+		nbProtoDBXMLCleanup();
+		return 0;
+	}
+
+	nbProtoDBXMLCleanup();
+
+	printf("Image '%s' created; checking it...\n", ImageFileName);
+
+	Start= clock();
+	NetPDLProtoDB= nbProtoDBImageLoad(ImageFileName, ProtoDBFlags, ErrBuf, sizeof(ErrBuf));
+	ImageTime= clock() - Start;
+
+	if (NetPDLProtoDB == NULL)
+	{
+		printf("Error loading the image of the NetPDL protocol Database: %s\n", ErrBuf);
+		return 0;
+	}
+
+	if (NetPDLProtoDB->Fingerprint != Fingerprint)
+	{
+		printf("Error: the image does not match the NetPDL protocol Database.\n");
+		nbProtoDBXMLCleanup();
+		return 0;
+	}
+
+	printf("  Creator: %s\n", NetPDLProtoDB->Creator);
+	printf("  Creation date: %s\n", NetPDLProtoDB->CreationDate);
+	printf("  NetPDL version: %u.%u\n", (unsigned int) NetPDLProtoDB->VersionMajor, (unsigned int) NetPDLProtoDB->VersionMinor);
+	printf("  Protocols: %u\n", (unsigned int) NetPDLProtoDB->ProtoListNItems);
+	printf("  Fingerprint: %08X%08X\n", (unsigned int) (Fingerprint >> 32), (unsigned int) Fingerprint);
+	printf("  Loading time: %.2f ms (XML file), %.2f ms (image)\n\n",
+		(double) XMLTime * 1000 / CLOCKS_PER_SEC, (double) ImageTime * 1000 / CLOCKS_PER_SEC);
+
+	nbProtoDBXMLCleanup();
+
+	return 1;
+}
@@ -145,6 +145,10 @@ int CNetPDLDecoder::Initialize()
 	if (m_PDMLMaker->Initialize(m_netPDLVariables) == nbFAILURE)
 		return nbFAILURE;
 
+	// The fields referred by the summary view may have to be formatted by the PDMLMaker
+	if (m_PSMLMaker)
+		m_PSMLMaker->SetPDMLMaker(m_PDMLMaker);
+
 	// Instantiates a new NetPDLProtoDecoder
 	m_protoDecoder= new CNetPDLProtoDecoder(m_netPDLVariables, m_exprHandler, m_PDMLMaker, m_PSMLMaker, m_errbuf, sizeof(m_errbuf));
 	if (m_protoDecoder == NULL)
@@ -13,6 +13,7 @@
 #include "netpdldecoderutils.h"
 #include "showplugin/native_showfunctions.h"		// For native printing functions
 #include "../misc/initialize.h"
+#include "../utils/hexdump.h"
 #include "../globals/globals.h"
 #include "../globals/debug.h"
 
@@ -60,30 +61,21 @@ CNetPDLDecoderUtils::~CNetPDLDecoderUtils()
 int CNetPDLDecoderUtils::FormatNetPDLField(const char *ProtoName, const char *FieldName, const unsigned char *FieldDumpPtr, 
 										   unsigned int FieldSize, char *FormattedField, int FormattedFieldSize)
 {
-	m_netPDLVariables->SetVariableRefBuffer(m_netPDLVariables->m_defaultVarList.PacketBuffer, (unsigned char *) FieldDumpPtr, 0, FieldSize);
+nbNetPDLFieldHandle FieldHandle;
+int RetVal;
 
-	for (unsigned int j= 0; j < NetPDLDatabase->ProtoListNItems; j++)
-	{
-		if (strcmp(NetPDLDatabase->ProtoList[j]->Name, ProtoName) == 0)
-		{
-		struct _nbNetPDLElementFieldBase *NetPDLElement;
+	RetVal= GetNetPDLFieldHandle(ProtoName, FieldName, &FieldHandle);
 
-			NetPDLElement= LookForNetPDLFieldDefinition(NetPDLDatabase->ProtoList[j]->FirstField, FieldName, j);
+	// The 'allfields' field does not need to be formatted
+	if (RetVal == nbWARNING)
+		return nbSUCCESS;
 
-			if (NetPDLElement)
-				return FormatPDMLElement(FormattedField, FormattedFieldSize, NetPDLElement, FieldSize, FieldDumpPtr);
-			else if(strcmp(FieldName,"allfields")==0)
-				return nbSUCCESS;
-			else
-			{
-				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The field named '%s' cannot be found in the current NetPDL description.", FieldName);
-				return nbFAILURE;
-			}
-		}
-	}
+	if (RetVal == nbFAILURE)
+		return nbFAILURE;
 
-	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The protocol named '%s' cannot be found in the current NetPDL description.", ProtoName);
-	return nbFAILURE;
+	m_netPDLVariables->SetVariableRefBuffer(m_netPDLVariables->m_defaultVarList.PacketBuffer, (unsigned char *) FieldDumpPtr, 0, FieldSize);
+
+	return FormatPDMLElement(FormattedField, FormattedFieldSize, FieldHandle->NetPDLElement, FieldSize, FieldDumpPtr);
 }
 
 
@@ -118,44 +110,74 @@ int CNetPDLDecoderUtils::FormatNetPDLField(const char *TemplateName, const unsig
 // Documented in the base class
 int CNetPDLDecoderUtils::GetFastPrintingFunctionCode(const char *ProtoName, const char *FieldName, int *FastPrintingFunctionCode)
 {
-	for (unsigned int j= 0; j < NetPDLDatabase->ProtoListNItems; j++)
-	{
-		if (strcmp(NetPDLDatabase->ProtoList[j]->Name, ProtoName) == 0)
-		{
-		struct _nbNetPDLElementFieldBase *NetPDLElement;
+nbNetPDLFieldHandle FieldHandle;
+int RetVal;
 
-			NetPDLElement= LookForNetPDLFieldDefinition(NetPDLDatabase->ProtoList[j]->FirstField, FieldName, j);
+	RetVal= GetNetPDLFieldHandle(ProtoName, FieldName, &FieldHandle);
 
-			if (NetPDLElement)
-			{
-			struct _nbNetPDLElementShowTemplate *ShowTemplate= NetPDLElement->ShowTemplateInfo;
-
-				if (ShowTemplate->ShowNativeFunction == 0)
-				{
-					// The requested field does not support fast printing
-					return nbWARNING;
-				}
-				else
-				{
-					*FastPrintingFunctionCode= (int) ShowTemplate->ShowNativeFunction;
-					return nbSUCCESS;
-				}
-			}
-			else if(strcmp(FieldName,"allfields")==0)
-				return nbSUCCESS;
-			else
-			{
-				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The field named '%s' cannot be found in the current NetPDL description.", FieldName);
-				return nbFAILURE;
-			}
-		}
+	if (RetVal == nbFAILURE)
+		return nbFAILURE;
+
+	// The requested field (or the 'allfields' one) does not support fast printing
+	if ((RetVal == nbWARNING) || (FieldHandle->FastPrintingFunctionCode == 0))
+		return nbWARNING;
+
+	*FastPrintingFunctionCode= FieldHandle->FastPrintingFunctionCode;
+	return nbSUCCESS;
+}
+
+
+// Documented in the base class
+int CNetPDLDecoderUtils::GetNetPDLFieldHandle(const char *ProtoName, const char *FieldName, nbNetPDLFieldHandle *FieldHandle)
+{
+int ProtoIndex;
+
+	*FieldHandle= NULL;
+
+	if (!m_fieldDictionary.IsInitialized())
+	{
+		if (m_fieldDictionary.Initialize(NetPDLDatabase, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+			return nbFAILURE;
 	}
 
-	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The protocol named '%s' cannot be found in the current NetPDL description.", ProtoName);
+	ProtoIndex= m_fieldDictionary.LookupProto(ProtoName);
+	if (ProtoIndex < 0)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The protocol named '%s' cannot be found in the current NetPDL description.", ProtoName);
+		return nbFAILURE;
+	}
+
+	*FieldHandle= m_fieldDictionary.LookupField(ProtoIndex, FieldName);
+	if (*FieldHandle)
+		return nbSUCCESS;
+
+	if (strcmp(FieldName, "allfields") == 0)
+		return nbWARNING;
+
+	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The field named '%s' cannot be found in the current NetPDL description.", FieldName);
 	return nbFAILURE;
 }
 
 
+// Documented in the base class
+int CNetPDLDecoderUtils::FormatNetPDLField(nbNetPDLFieldHandle FieldHandle, const unsigned char *FieldDumpPtr, unsigned int FieldSize, char *FormattedField, int FormattedFieldSize)
+{
+	if (FieldHandle->FastPrintingFunctionCode)
+		return FormatNetPDLField(FieldHandle->FastPrintingFunctionCode, FieldDumpPtr, FieldSize, FormattedField, FormattedFieldSize);
+
+	m_netPDLVariables->SetVariableRefBuffer(m_netPDLVariables->m_defaultVarList.PacketBuffer, (unsigned char *) FieldDumpPtr, 0, FieldSize);
+
+	return FormatPDMLElement(FormattedField, FormattedFieldSize, FieldHandle->NetPDLElement, FieldSize, FieldDumpPtr);
+}
+
+
+// Documented in the base class
+struct _nbNetPDLElementFieldBase *CNetPDLDecoderUtils::GetNetPDLFieldElement(nbNetPDLFieldHandle FieldHandle)
+{
+	return FieldHandle->NetPDLElement;
+}
+
+
 
 // Documented in the base class
 int CNetPDLDecoderUtils::FormatNetPDLField(int FastPrintingFunctionCode, const unsigned char *FieldDumpPtr, unsigned int FieldSize, char *FormattedField, int FormattedFieldSize)
@@ -193,147 +215,6 @@ unsigned long FormattedFieldLength;		//Required, but never actually used here
 }
 
 
-/*!
-	\brief Given a field name, it locates the definition within the NetPDL files.
-
-	This function is able to scan a given section of the NetPDL definition by means of a recursive method.
-	This function checks the node type and:
-	- if it is a standard field (e.g. a 'fixed'): it checks if the field name corresponds to the field we want;
-	if so, it returns the field, otherwise it moves to the next field
-	- if if is a 'null' field (e.g. 'looptype'), it moves to the next field
-	- it is is a 'container' field (e.g. a 'case'), it moves to the first field contained within the
-	block, and it calls itself (hence the recursive method).
-
-	This code is included within a 'while' loop, which ends when the protocol do not have any other fields
-	to be examined.
-
-	\param FirstElement: pointer to the first element of the NetPDL definition (e.g. the first field
-	in case we're starting from the beginning of the protocol). In case this method has been recursively called,
-	this parameter can be the first field of the block that we want to examine (e.g. the first field
-	contained within a 'case' block).
-
-	\param FieldName: ASCII string that contains the name of the field that we want to locate.
-	
-	\param CurrentProtoItem: an integer that keeps the position of the current protocol within the protocol list
-	(the NetPDLDatabase global variable).
-
-	\return A pointer to the definition of the NetPDL element if it has been found, NULL otherwise.
-*/
-struct _nbNetPDLElementFieldBase *CNetPDLDecoderUtils::LookForNetPDLFieldDefinition(struct _nbNetPDLElementBase *FirstElement, const char *FieldName, int CurrentProtoItem)
-{
-struct _nbNetPDLElementBase *CurrentField;
-
-	CurrentField= FirstElement;
-
-	while (CurrentField)
-	{
-		switch (CurrentField->Type)
-		{
-			case nbNETPDL_IDEL_FIELD:
-			{
-			struct _nbNetPDLElementFieldBase *FieldElement;
-
-				FieldElement= (struct _nbNetPDLElementFieldBase *) CurrentField;
-
-				if (strcmp(FieldElement->Name, FieldName) == 0)
-					return (struct _nbNetPDLElementFieldBase *) CurrentField;
-
-				// Let's give a look inside in case we've some bitfield inside
-				if (CurrentField->FirstChild != nbNETPDL_INVALID_ELEMENT)
-				{
-					FieldElement= LookForNetPDLFieldDefinition(nbNETPDL_GET_ELEMENT(NetPDLDatabase, CurrentField->FirstChild), FieldName, CurrentProtoItem);
-
-					// If we locate the correct element, please return it.
-					if (FieldElement)
-						return FieldElement;
-				}
-
-				break;
-			};
-
-			// This code indicates a nested block of fields
-			case nbNETPDL_IDEL_SWITCH:
-			case nbNETPDL_IDEL_CASE:
-			case nbNETPDL_IDEL_DEFAULT:
-			case nbNETPDL_IDEL_LOOP:
-			case nbNETPDL_IDEL_BLOCK:
-			{
-			struct _nbNetPDLElementFieldBase *FieldElement;
-
-				// Let's give a look inside
-				FieldElement= LookForNetPDLFieldDefinition(nbNETPDL_GET_ELEMENT(NetPDLDatabase, CurrentField->FirstChild), FieldName, CurrentProtoItem);
-
-				// If we locate the correct element, please return it.
-				if (FieldElement)
-					return FieldElement;
-
-				// Otherwise, we have to continue
-				break;
-			};
-
-			case nbNETPDL_IDEL_IF:
-			{
-			struct _nbNetPDLElementFieldBase *FieldElement;
-			struct _nbNetPDLElementIf *IfElement;
-
-				IfElement= (struct _nbNetPDLElementIf *) CurrentField;
-
-				// Let's give a look inside the 'true' branch
-				FieldElement= LookForNetPDLFieldDefinition(IfElement->FirstValidChildIfTrue, FieldName, CurrentProtoItem);
-
-				// If we locate the correct element, please return it.
-				if (FieldElement)
-					return FieldElement;
-
-				// Let's give a look inside the 'false' branch
-				FieldElement= LookForNetPDLFieldDefinition(IfElement->FirstValidChildIfFalse, FieldName, CurrentProtoItem);
-
-				// If we locate the correct element, please return it.
-				if (FieldElement)
-					return FieldElement;
-
-				// Otherwise, we have to continue
-				break;
-			};
-
-
-			// This is not a valid field; move to the next one
-			case nbNETPDL_IDEL_LOOPCTRL:
-			{
-				break;
-			};
-
-			// This points to a separate block field
-			case nbNETPDL_IDEL_INCLUDEBLK:
-			{
-			struct _nbNetPDLElementIncludeBlk *IncludeBlkElement;
-			struct _nbNetPDLElementFieldBase *FieldElement;
-
-				IncludeBlkElement= (struct _nbNetPDLElementIncludeBlk *) CurrentField;
-
-				// Let's give a look inside
-				FieldElement= LookForNetPDLFieldDefinition(nbNETPDL_GET_ELEMENT(NetPDLDatabase,
-									(IncludeBlkElement->IncludedBlock)->FirstChild), FieldName, CurrentProtoItem);
-
-				// If we locate the correct element, please return it.
-				if (FieldElement)
-					return FieldElement;
-
-				// Otherwise, we have to continue
-				break;
-			};
-		}			// end switch
-
-		
-		// Move to the next child
-		CurrentField= nbNETPDL_GET_ELEMENT(NetPDLDatabase, CurrentField->NextSibling);
-	}
-
-	return NULL;
-}
-
-
-
 /*!
 	\brief It creates a string that contains a field formatted with the proper NetPDL instructions.
 
@@ -393,28 +274,19 @@ struct _nbPDMLField *PDMLElement;
 // Documented in the base class
 int CNetPDLDecoderUtils::GetHexValueNetPDLField(const char *ProtoName, const char *FieldName, const char *FormattedField, unsigned char *FieldHexValue, unsigned int *FieldHexSize, bool BinaryEncoding)
 {
-	for (unsigned int j= 0; j < NetPDLDatabase->ProtoListNItems; j++)
-	{
-		if (strcmp(NetPDLDatabase->ProtoList[j]->Name, ProtoName) == 0)
-		{
-		struct _nbNetPDLElementFieldBase *NetPDLElement;
+nbNetPDLFieldHandle FieldHandle;
+int RetVal;
 
-			NetPDLElement= LookForNetPDLFieldDefinition(NetPDLDatabase->ProtoList[j]->FirstField, FieldName, j);
+	RetVal= GetNetPDLFieldHandle(ProtoName, FieldName, &FieldHandle);
 
-			if (NetPDLElement)
-			{
-				return (FormatBinDumpElement(FormattedField, NetPDLElement, (char *) FieldHexValue, FieldHexSize, BinaryEncoding));
-			}
-			else if(strcmp(FieldName,"allfields")==0)
-				return nbSUCCESS;
+	// The 'allfields' field does not have any value
+	if (RetVal == nbWARNING)
+		return nbSUCCESS;
 
-			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The field named '%s' cannot be found in the current NetPDL description.", FieldName);
-			return nbFAILURE;
-		}
-	}
+	if (RetVal == nbFAILURE)
+		return nbFAILURE;
 
-	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The protocol named '%s' cannot be found in the current NetPDL description.", ProtoName);
-	return nbFAILURE;
+	return (FormatBinDumpElement(FormattedField, FieldHandle->NetPDLElement, (char *) FieldHexValue, FieldHexSize, BinaryEncoding));
 }
 
 
@@ -509,25 +381,19 @@ struct _nbNetPDLElementFieldBase *FieldElement;
 
 		case nbNETPDL_ID_TEMPLATE_DIGIT_ASCII:
 		{
-			ResidueString= FormattedField;
-
-			while (*ResidueString)
-			{
-			char CurrentConversion[10];
-			char CurrentChar= ResidueString[0];
+		unsigned int FieldLength= (unsigned int) strlen(FormattedField);
 
-				// print the character in hexadecimal format
-				sprintf(CurrentConversion, "%02X", CurrentChar);
+			// Characters that do not fit in the buffer (with the terminator) are discarded
+			if (*BufferHexDumpSize == 0)
+				return nbSUCCESS;
+			if (FieldLength > (*BufferHexDumpSize - 1) / 2)
+				FieldLength= (*BufferHexDumpSize - 1) / 2;
 
-				// append current block converted to the whole conversion
-				strncat(BufferHexDump, CurrentConversion, *BufferHexDumpSize);
+			// print each character in hexadecimal format
+			HexDumpEncode((const unsigned char *) FormattedField, FieldLength, BufferHexDump);
+			BufferHexDump[FieldLength * 2]= 0;
 
-				// skip to next char
-				ResidueString += sizeof(char);
-			}
-			
-			// retrieve the length of the string
-			*BufferHexDumpSize = (int) strlen(BufferHexDump);
+			*BufferHexDumpSize= FieldLength * 2;
 
 			return nbSUCCESS;
 		}; break;
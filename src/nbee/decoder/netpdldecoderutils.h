@@ -11,6 +11,7 @@
 #include <nbee_netpdlutils.h>
 #include "netpdlexpression.h"
 #include "pdmlmaker.h"
+#include "netpdlfielddict.h"
 
 
 
@@ -47,12 +48,17 @@ public:
 
 	int GetFastPrintingFunctionCode(const char *ProtoName, const char *FieldName, int *FastPrintingFunctionCode);
 
+	int GetNetPDLFieldHandle(const char *ProtoName, const char *FieldName, nbNetPDLFieldHandle *FieldHandle);
+
+	int FormatNetPDLField(nbNetPDLFieldHandle FieldHandle, const unsigned char *FieldDumpPtr,
+		unsigned int FieldSize, char *FormattedField, int FormattedFieldSize);
+
+	struct _nbNetPDLElementFieldBase *GetNetPDLFieldElement(nbNetPDLFieldHandle FieldHandle);
+
 	int GetHexValueNetPDLField(const char *TemplateName, const char *FormattedField, 
 		unsigned char *FieldHexValue, unsigned int *FieldHexSize, bool BinaryEncoding);
 
 private:
-	struct _nbNetPDLElementFieldBase *LookForNetPDLFieldDefinition(struct _nbNetPDLElementBase *FirstElement, const char *FieldName, int CurrentProtoItem);
-
 	int FormatPDMLElement(char *FormattedField, int FormFieldSize, struct _nbNetPDLElementFieldBase *NetPDLElement,
 		int Len, const unsigned char *FieldBinHexDump);
 
@@ -67,5 +73,8 @@ private:
 
 	//! Pointer to the class that generates the detailed view.
 	CPDMLMaker *m_PDMLMaker;
+
+	//! Dictionary of the protocols and fields of the NetPDL database (built the first time a field is looked up).
+	CNetPDLFieldDictionary m_fieldDictionary;
 };
 
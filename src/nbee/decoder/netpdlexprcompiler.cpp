@@ -0,0 +1,572 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/*!
+	\file netpdlexprcompiler.cpp
+
+	This file contains the compiler that turns NetPDL expressions into the code executed by CNetPDLExpression.
+
+	Expressions are compiled once, when the NetPDL engine is initialized, so that their tree does not
+	have to be walked for each packet. Variables and lookup tables are referred by their IDs, and the
+	names of the fields are split in advance.
+	Expressions containing constructs that cannot be compiled (or whose evaluation is not well defined)
+	are not compiled at all: they are still evaluated by walking their tree.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <nbprotodb.h>
+#include <nbprotodb_defs.h>
+
+#include "netpdlexpression.h"
+#include "../globals/globals.h"
+
+
+//! State of the compiler
+struct _ExprCompiler
+{
+	struct _nbNetPDLExprInsn *Insns;		//!< Instructions generated so far
+	unsigned int NInsns;					//!< Number of instructions generated so far
+	unsigned int MaxInsns;					//!< Number of instructions that fit in 'Insns'
+	struct _nbNetPDLExprFieldSlot *Slots;	//!< Field slots created so far
+	unsigned int NSlots;					//!< Number of field slots created so far
+	unsigned int MaxSlots;					//!< Number of field slots that fit in 'Slots'
+	int Depth;								//!< Depth of the stack after the last instruction
+};
+
+
+static int CompileNumber(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *ExprNode);
+static int CompileString(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *ExprNode);
+static int CompileOperandNumber(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *OperandBase);
+static int CompileOperandBuffer(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *OperandBase);
+
+
+/*
+	Appends an instruction; 'StackDelta' is the change in the depth of the stack it causes.
+	It fails if the memory is over or the stack becomes too deep.
+*/
+static int Emit(struct _ExprCompiler *Compiler, nbNetPDLExprOpcodes_t Opcode, int Flags, unsigned int Arg, unsigned int Arg2, void *Ptr, int StackDelta)
+{
+struct _nbNetPDLExprInsn *Insn;
+
+	Compiler->Depth+= StackDelta;
+	if ((Compiler->Depth < 1) || (Compiler->Depth > NETPDL_EXPR_MAX_STACK))
+		return nbFAILURE;
+
+	if (Compiler->NInsns == Compiler->MaxInsns)
+	{
+	struct _nbNetPDLExprInsn *NewInsns;
+	unsigned int NewMax= (Compiler->MaxInsns == 0) ? 16 : Compiler->MaxInsns * 2;
+
+		NewInsns= (struct _nbNetPDLExprInsn *) realloc(Compiler->Insns, NewMax * sizeof(struct _nbNetPDLExprInsn));
+		if (NewInsns == NULL)
+			return nbFAILURE;
+
+		Compiler->Insns= NewInsns;
+		Compiler->MaxInsns= NewMax;
+	}
+
+	Insn= &Compiler->Insns[Compiler->NInsns++];
+	Insn->Opcode= Opcode;
+	Insn->Flags= Flags;
+	Insn->Arg= Arg;
+	Insn->Arg2= Arg2;
+	Insn->Ptr= Ptr;
+
+	return nbSUCCESS;
+}
+
+
+/*
+	Creates the slot for a field reference and returns its index in 'SlotIndex'.
+	Instructions refer to slots by index until the compilation ends, since the array can be moved.
+*/
+static int AddFieldSlot(struct _ExprCompiler *Compiler, struct _nbNetPDLExprFieldRef *Operand, int IsThis, unsigned int *SlotIndex)
+{
+struct _nbNetPDLExprFieldSlot *Slot;
+unsigned int NNames;
+char *Name;
+
+	if ((Operand == NULL) || (Operand->FieldName == NULL))
+		return nbFAILURE;
+
+	if (Compiler->NSlots == Compiler->MaxSlots)
+	{
+	struct _nbNetPDLExprFieldSlot *NewSlots;
+	unsigned int NewMax= (Compiler->MaxSlots == 0) ? 4 : Compiler->MaxSlots * 2;
+
+		NewSlots= (struct _nbNetPDLExprFieldSlot *) realloc(Compiler->Slots, NewMax * sizeof(struct _nbNetPDLExprFieldSlot));
+		if (NewSlots == NULL)
+			return nbFAILURE;
+
+		Compiler->Slots= NewSlots;
+		Compiler->MaxSlots= NewMax;
+	}
+
+	Slot= &Compiler->Slots[Compiler->NSlots];
+	memset(Slot, 0, sizeof(struct _nbNetPDLExprFieldSlot));
+	Slot->Operand= Operand;
+	Slot->IsThis= IsThis;
+
+	// The slot is counted right now, so that it is released in case of failure
+	Compiler->NSlots++;
+
+	Slot->Names= strdup(Operand->FieldName);
+	if (Slot->Names == NULL)
+		return nbFAILURE;
+
+	// The first name is the one of the field, the following ones are the subfields
+	NNames= 0;
+	for (Name= strtok(Slot->Names, NETPDL_COMMON_SYNTAX_SEP_FIELDS); Name != NULL; Name= strtok(NULL, NETPDL_COMMON_SYNTAX_SEP_FIELDS))
+	{
+		if (NNames > 0)
+		{
+		char **NewSubfields;
+		unsigned int *NewSubfieldsLen;
+
+			NewSubfields= (char **) realloc(Slot->Subfields, NNames * sizeof(char *));
+			if (NewSubfields == NULL)
+				return nbFAILURE;
+			Slot->Subfields= NewSubfields;
+
+			NewSubfieldsLen= (unsigned int *) realloc(Slot->SubfieldsLen, NNames * sizeof(unsigned int));
+			if (NewSubfieldsLen == NULL)
+				return nbFAILURE;
+			Slot->SubfieldsLen= NewSubfieldsLen;
+
+			Slot->Subfields[NNames - 1]= Name;
+			Slot->SubfieldsLen[NNames - 1]= (unsigned int) strlen(Name);
+			Slot->NSubfields= NNames;
+		}
+
+		NNames++;
+	}
+
+	if (NNames == 0)
+		return nbFAILURE;
+
+	*SlotIndex= Compiler->NSlots - 1;
+	return nbSUCCESS;
+}
+
+
+/*
+	Compiles the size and the starting offset of a buffer operand and returns the flags telling
+	which ones have been pushed on the stack.
+*/
+static int CompileOffsets(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *OffsetStartAt, struct _nbNetPDLExprBase *OffsetSize, int *Flags)
+{
+	*Flags= 0;
+
+	if (OffsetStartAt)
+	{
+		if (CompileNumber(Compiler, OffsetStartAt) != nbSUCCESS)
+			return nbFAILURE;
+		*Flags|= EXPRCODE_FLAG_STARTAT;
+	}
+
+	if (OffsetSize)
+	{
+		if (CompileNumber(Compiler, OffsetSize) != nbSUCCESS)
+			return nbFAILURE;
+		*Flags|= EXPRCODE_FLAG_SIZE;
+	}
+
+	return nbSUCCESS;
+}
+
+
+// Number of values that are popped for the starting offset and the size
+static int OffsetsCount(int Flags)
+{
+	return ((Flags & EXPRCODE_FLAG_STARTAT) ? 1 : 0) + ((Flags & EXPRCODE_FLAG_SIZE) ? 1 : 0);
+}
+
+
+// Same as CNetPDLExpression::EvaluateExprNumber()
+static int CompileNumber(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *ExprNode)
+{
+struct _nbNetPDLExpression* Expression;
+unsigned int JumpInsn;
+int OperandsAreNumbers;
+
+	// Results are printed by the tree walker only
+	if (ExprNode->PrintDebug)
+		return nbFAILURE;
+
+	if (ExprNode->Type != nbNETPDL_ID_EXPR_OPERAND_EXPR)
+		return CompileOperandNumber(Compiler, ExprNode);
+
+	Expression= (struct _nbNetPDLExpression*) ExprNode;
+
+	// 'not' and 'bitwnot' have the second operand only
+	if (Expression->Operand1 == NULL)
+	{
+		if ((Expression->Operator == NULL) || (Expression->Operand2 == NULL) ||
+			(Expression->Operand2->ReturnType != nbNETPDL_ID_EXPR_RETURNTYPE_NUMBER))
+			return nbFAILURE;
+
+		if (CompileOperandNumber(Compiler, Expression->Operand2) != nbSUCCESS)
+			return nbFAILURE;
+
+		switch (Expression->Operator->OperatorType)
+		{
+			case nbNETPDL_ID_EXPR_OPER_NOT: return Emit(Compiler, EXPRCODE_NOT, 0, 0, 0, NULL, 0);
+			case nbNETPDL_ID_EXPR_OPER_BITWNOT: return Emit(Compiler, EXPRCODE_BITWNOT, 0, 0, 0, NULL, 0);
+			default: return nbFAILURE;
+		}
+	}
+
+	// The value of a buffer cannot be returned as a number
+	if ((Expression->Operator == NULL) || (Expression->Operand2 == NULL))
+	{
+		if ((Expression->Operator != NULL) || (Expression->Operand1->ReturnType != nbNETPDL_ID_EXPR_RETURNTYPE_NUMBER))
+			return nbFAILURE;
+
+		return CompileOperandNumber(Compiler, Expression->Operand1);
+	}
+
+	OperandsAreNumbers= ((Expression->Operand1->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_NUMBER) &&
+		(Expression->Operand2->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_NUMBER));
+
+	switch (Expression->Operator->OperatorType)
+	{
+		case nbNETPDL_ID_EXPR_OPER_AND:
+		case nbNETPDL_ID_EXPR_OPER_OR:
+		{
+			if (!OperandsAreNumbers)
+				return nbFAILURE;
+
+			// The second operand is not evaluated if the first one is enough for the result
+			if (CompileOperandNumber(Compiler, Expression->Operand1) != nbSUCCESS)
+				return nbFAILURE;
+
+			JumpInsn= Compiler->NInsns;
+			if (Emit(Compiler, (Expression->Operator->OperatorType == nbNETPDL_ID_EXPR_OPER_AND) ? EXPRCODE_JUMPIFZERO : EXPRCODE_JUMPIFNOTZERO,
+				0, 0, 0, NULL, 0) != nbSUCCESS)
+				return nbFAILURE;
+
+			if (CompileOperandNumber(Compiler, Expression->Operand2) != nbSUCCESS)
+				return nbFAILURE;
+
+			if (Emit(Compiler, (Expression->Operator->OperatorType == nbNETPDL_ID_EXPR_OPER_AND) ? EXPRCODE_AND : EXPRCODE_OR,
+				0, 0, 0, NULL, -1) != nbSUCCESS)
+				return nbFAILURE;
+
+			Compiler->Insns[JumpInsn].Arg= Compiler->NInsns;
+			return nbSUCCESS;
+		}
+
+		case nbNETPDL_ID_EXPR_OPER_GREAT:
+		case nbNETPDL_ID_EXPR_OPER_LESS:
+		case nbNETPDL_ID_EXPR_OPER_EQUAL:
+		case nbNETPDL_ID_EXPR_OPER_NOTEQUAL:
+		{
+			// Buffers are compared with buffers
+			if ((Expression->Operand1->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_BUFFER) &&
+				(Expression->Operand2->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_BUFFER))
+			{
+			nbNetPDLExprOpcodes_t Opcode;
+
+				if (CompileOperandBuffer(Compiler, Expression->Operand1) != nbSUCCESS)
+					return nbFAILURE;
+				if (CompileOperandBuffer(Compiler, Expression->Operand2) != nbSUCCESS)
+					return nbFAILURE;
+
+				switch (Expression->Operator->OperatorType)
+				{
+					case nbNETPDL_ID_EXPR_OPER_GREAT: Opcode= EXPRCODE_GREATBUF; break;
+					case nbNETPDL_ID_EXPR_OPER_LESS: Opcode= EXPRCODE_LESSBUF; break;
+					case nbNETPDL_ID_EXPR_OPER_EQUAL: Opcode= EXPRCODE_EQUALBUF; break;
+					default: Opcode= EXPRCODE_NOTEQUALBUF; break;
+				}
+
+				return Emit(Compiler, Opcode, 0, 0, 0, NULL, -1);
+			}
+		}; break;
+
+		default:
+			break;
+	}
+
+	// All the other operators work on numbers
+	if (!OperandsAreNumbers)
+		return nbFAILURE;
+
+	if (CompileOperandNumber(Compiler, Expression->Operand1) != nbSUCCESS)
+		return nbFAILURE;
+	if (CompileOperandNumber(Compiler, Expression->Operand2) != nbSUCCESS)
+		return nbFAILURE;
+
+	switch (Expression->Operator->OperatorType)
+	{
+		case nbNETPDL_ID_EXPR_OPER_PLUS: return Emit(Compiler, EXPRCODE_ADD, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_MINUS: return Emit(Compiler, EXPRCODE_SUB, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_MUL: return Emit(Compiler, EXPRCODE_MUL, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_DIV: return Emit(Compiler, EXPRCODE_DIV, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_MOD: return Emit(Compiler, EXPRCODE_MOD, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_BITWAND: return Emit(Compiler, EXPRCODE_BITWAND, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_BITWOR: return Emit(Compiler, EXPRCODE_BITWOR, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_GREAT: return Emit(Compiler, EXPRCODE_GREAT, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_GREATEQUAL: return Emit(Compiler, EXPRCODE_GREATEQUAL, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_LESS: return Emit(Compiler, EXPRCODE_LESS, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_LESSEQUAL: return Emit(Compiler, EXPRCODE_LESSEQUAL, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_EQUAL: return Emit(Compiler, EXPRCODE_EQUAL, 0, 0, 0, NULL, -1);
+		case nbNETPDL_ID_EXPR_OPER_NOTEQUAL: return Emit(Compiler, EXPRCODE_NOTEQUAL, 0, 0, 0, NULL, -1);
+		default: return nbFAILURE;
+	}
+}
+
+
+// Same as CNetPDLExpression::EvaluateExprString()
+static int CompileString(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *ExprNode)
+{
+struct _nbNetPDLExpression* Expression;
+
+	if (ExprNode->PrintDebug)
+		return nbFAILURE;
+
+	if (ExprNode->Type != nbNETPDL_ID_EXPR_OPERAND_EXPR)
+		return CompileOperandBuffer(Compiler, ExprNode);
+
+	Expression= (struct _nbNetPDLExpression*) ExprNode;
+
+	// Operators that return buffers do not exist
+	if ((Expression->Operand1 == NULL) || (Expression->Operator != NULL))
+		return nbFAILURE;
+
+	return CompileOperandBuffer(Compiler, Expression->Operand1);
+}
+
+
+// Same as CNetPDLExpression::GetOperandNumber()
+static int CompileOperandNumber(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *OperandBase)
+{
+	if (OperandBase->PrintDebug)
+		return nbFAILURE;
+
+	switch (OperandBase->Type)
+	{
+		case nbNETPDL_ID_EXPR_OPERAND_NUMBER:
+			return Emit(Compiler, EXPRCODE_PUSHNUMBER, 0, ((struct _nbNetPDLExprNumber*) OperandBase)->Value, 0, NULL, 1);
+
+		case nbNETPDL_ID_EXPR_OPERAND_PROTOREF:
+			return Emit(Compiler, EXPRCODE_PUSHNUMBER, 0, ((struct _nbNetPDLExprProtoRef*) OperandBase)->Value, 0, NULL, 1);
+
+		case nbNETPDL_ID_EXPR_OPERAND_VARIABLE:
+			return Emit(Compiler, EXPRCODE_PUSHVARNUMBER, 0, (unsigned int) (long) ((struct _nbNetPDLExprVariable*) OperandBase)->CustomData, 0, NULL, 1);
+
+		case nbNETPDL_ID_EXPR_OPERAND_LOOKUPTABLE:
+		{
+		struct _nbNetPDLExprLookupTable* Operand= (struct _nbNetPDLExprLookupTable*) OperandBase;
+
+			return Emit(Compiler, EXPRCODE_PUSHTABLENUMBER, 0, (unsigned int) (long) Operand->TableCustomData,
+				(unsigned int) (long) Operand->FieldCustomData, NULL, 1);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_EXPR:
+			return CompileNumber(Compiler, OperandBase);
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_BUF2INT:
+		{
+			if (CompileOperandBuffer(Compiler, ((struct _nbNetPDLExprFunctionBuf2Int*) OperandBase)->StringExpression) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_BUF2INT, 0, 0, 0, NULL, 0);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_ASCII2INT:
+		{
+			if (CompileString(Compiler, ((struct _nbNetPDLExprFunctionAscii2Int*) OperandBase)->AsciiStringExpression) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_ASCII2INT, 0, 0, 0, NULL, 0);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_ISPRESENT:
+		{
+		unsigned int SlotIndex;
+
+			if (AddFieldSlot(Compiler, ((struct _nbNetPDLExprFunctionIsPresent*) OperandBase)->NetPDLField, 0, &SlotIndex) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_ISPRESENT, 0, SlotIndex, 0, NULL, 1);
+		}
+
+		// These functions are rarely used and they are rather expensive anyway
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_ISASN1TYPE:
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_HASSTRING:
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_CHECKLOOKUPTABLE:
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_UPDATELOOKUPTABLE:
+			return Emit(Compiler, EXPRCODE_OPERAND, 0, 0, 0, OperandBase, 1);
+
+		default:
+			return nbFAILURE;
+	}
+}
+
+
+// Same as CNetPDLExpression::GetOperandBuffer()
+static int CompileOperandBuffer(struct _ExprCompiler *Compiler, struct _nbNetPDLExprBase *OperandBase)
+{
+int Flags;
+
+	if (OperandBase->PrintDebug)
+		return nbFAILURE;
+
+	switch (OperandBase->Type)
+	{
+		case nbNETPDL_ID_EXPR_OPERAND_STRING:
+		{
+		struct _nbNetPDLExprString* Operand= (struct _nbNetPDLExprString*) OperandBase;
+
+			return Emit(Compiler, EXPRCODE_PUSHSTRING, 0, Operand->Size, 0, Operand->Value, 1);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_VARIABLE:
+		{
+		struct _nbNetPDLExprVariable* Operand= (struct _nbNetPDLExprVariable*) OperandBase;
+
+			if (CompileOffsets(Compiler, Operand->OffsetStartAt, Operand->OffsetSize, &Flags) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_PUSHVARBUFFER, Flags, (unsigned int) (long) Operand->CustomData, 0, NULL, 1 - OffsetsCount(Flags));
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_LOOKUPTABLE:
+		{
+		struct _nbNetPDLExprLookupTable* Operand= (struct _nbNetPDLExprLookupTable*) OperandBase;
+
+			if (CompileOffsets(Compiler, Operand->OffsetStartAt, Operand->OffsetSize, &Flags) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_PUSHTABLEBUFFER, Flags, (unsigned int) (long) Operand->TableCustomData,
+				(unsigned int) (long) Operand->FieldCustomData, NULL, 1 - OffsetsCount(Flags));
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_PROTOFIELD:
+		case nbNETPDL_ID_EXPR_OPERAND_PROTOFIELD_THIS:
+		{
+		struct _nbNetPDLExprFieldRef* Operand= (struct _nbNetPDLExprFieldRef*) OperandBase;
+		unsigned int SlotIndex;
+
+			if (AddFieldSlot(Compiler, Operand, (OperandBase->Type == nbNETPDL_ID_EXPR_OPERAND_PROTOFIELD_THIS), &SlotIndex) != nbSUCCESS)
+				return nbFAILURE;
+
+			// The field is located before its offsets are evaluated, as the tree walker does
+			if (Emit(Compiler, EXPRCODE_LOCATEFIELD, 0, SlotIndex, 0, NULL, 1) != nbSUCCESS)
+				return nbFAILURE;
+
+			if (CompileOffsets(Compiler, Operand->OffsetStartAt, Operand->OffsetSize, &Flags) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_LOADFIELD, Flags, SlotIndex, 0, NULL, -OffsetsCount(Flags));
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_EXPR:
+			return CompileString(Compiler, OperandBase);
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_INT2BUF:
+		{
+			if (CompileOperandNumber(Compiler, ((struct _nbNetPDLExprFunctionInt2Buf*) OperandBase)->NumericExpression) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_INT2BUF, 0, 0, 0, OperandBase, 0);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_CHANGEBYTEORDER:
+		{
+			if (CompileString(Compiler, ((struct _nbNetPDLExprFunctionChangeByteOrder*) OperandBase)->OriginalStringExpression) != nbSUCCESS)
+				return nbFAILURE;
+
+			return Emit(Compiler, EXPRCODE_CHANGEBYTEORDER, 0, 0, 0, OperandBase, 0);
+		}
+
+		case nbNETPDL_ID_EXPR_OPERAND_FUNCTION_EXTRACTSTRING:
+			return Emit(Compiler, EXPRCODE_OPERAND, EXPRCODE_FLAG_BUFFER, 0, 0, OperandBase, 1);
+
+		default:
+			return nbFAILURE;
+	}
+}
+
+
+/*!
+	\brief Compiles a 'root' expression.
+
+	The expression is compiled according to its return type, i.e. the code returns a number if the
+	expression is evaluated by EvaluateExprNumber(), or a buffer if it is evaluated by EvaluateExprString().
+	Variables and lookup tables must have already been resolved into their IDs.
+
+	\param ExprNode: the expression that has to be compiled.
+
+	\return The compiled code (to be released with FreeCompiledExpression()), or NULL if the expression
+	cannot be compiled; the latter is not an error, since the expression can still be evaluated by
+	walking its tree.
+*/
+struct _nbNetPDLExprCode *CNetPDLExpression::CompileExpression(struct _nbNetPDLExprBase *ExprNode)
+{
+struct _ExprCompiler Compiler;
+struct _nbNetPDLExprCode *Code;
+int RetVal;
+
+	Code= (struct _nbNetPDLExprCode *) malloc(sizeof(struct _nbNetPDLExprCode));
+	if (Code == NULL)
+		return NULL;
+
+	memset(&Compiler, 0, sizeof(Compiler));
+
+	if (ExprNode->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_BUFFER)
+		RetVal= CompileString(&Compiler, ExprNode);
+	else
+		RetVal= CompileNumber(&Compiler, ExprNode);
+
+	Code->Insns= Compiler.Insns;
+	Code->NInsns= Compiler.NInsns;
+	Code->ReturnsBuffer= (ExprNode->ReturnType == nbNETPDL_ID_EXPR_RETURNTYPE_BUFFER);
+	Code->Slots= Compiler.Slots;
+	Code->NSlots= Compiler.NSlots;
+
+	if ((RetVal != nbSUCCESS) || (Compiler.Depth != 1))
+	{
+		FreeCompiledExpression(Code);
+		return NULL;
+	}
+
+	// The slots do not move anymore
+	for (unsigned int i= 0; i < Code->NInsns; i++)
+	{
+		if ((Code->Insns[i].Opcode == EXPRCODE_LOCATEFIELD) || (Code->Insns[i].Opcode == EXPRCODE_LOADFIELD) ||
+			(Code->Insns[i].Opcode == EXPRCODE_ISPRESENT))
+			Code->Insns[i].Ptr= &Code->Slots[Code->Insns[i].Arg];
+	}
+
+	return Code;
+}
+
+
+/*!
+	\brief Releases the code of an expression compiled by CompileExpression().
+*/
+void CNetPDLExpression::FreeCompiledExpression(struct _nbNetPDLExprCode *Code)
+{
+	if (Code == NULL)
+		return;
+
+	for (unsigned int i= 0; i < Code->NSlots; i++)
+	{
+		free(Code->Slots[i].Names);
+		free(Code->Slots[i].Subfields);
+		free(Code->Slots[i].SubfieldsLen);
+	}
+
+	free(Code->Slots);
+	free(Code->Insns);
+	free(Code);
+}
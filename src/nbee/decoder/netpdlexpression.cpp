@@ -47,6 +47,7 @@ extern struct _nbNetPDLDatabase *NetPDLDatabase;
 CNetPDLExpression::CNetPDLExpression(CNetPDLVariables *NetPDLVars, char *Errbuf, int ErrbufSize)
 {
 	m_netPDLVariables= NetPDLVars;
+	m_PDMLMaker= NULL;
 
 	// Store internally the pointer to the error buffer. This buffer belongs to the class that creates this one.
 	m_errbuf= Errbuf;
@@ -60,6 +61,20 @@ CNetPDLExpression::~CNetPDLExpression()
 }
 
 
+/*!
+	\brief Sets the class that creates the PDML fragment of the packets.
+
+	When this class is set, field references are located through the index of the fields of
+	the current packet kept by the PDMLMaker, instead of scanning the PDML fragment.
+
+	\param PDMLMaker: the PDMLMaker that shares this expression handler (NULL if none).
+*/
+void CNetPDLExpression::SetPDMLMaker(CPDMLMaker *PDMLMaker)
+{
+	m_PDMLMaker= PDMLMaker;
+}
+
+
 /*!
 	\brief It evaluates a 'switch' and a 'showmap' node.
 
@@ -216,6 +231,22 @@ struct _nbNetPDLExpression* Expression;
 char *Mask;
 int RetVal;
 
+	// Root expressions are usually compiled when the NetPDL engine is initialized
+	if ((ExprNode->CompiledCode) && (((struct _nbNetPDLExprCode *) ExprNode->CompiledCode)->ReturnsBuffer))
+	{
+	struct _nbNetPDLExprValue Value;
+
+		RetVal= ExecuteCode((struct _nbNetPDLExprCode *) ExprNode->CompiledCode, PDMLStartField, &Value);
+
+		if (RetVal == nbSUCCESS)
+		{
+			*ResultString= Value.Buffer;
+			*ResultStringLen= Value.Size;
+		}
+
+		return RetVal;
+	}
+
 	// If this is not a complex expression, let's return the result right now
 	if (ExprNode->Type != nbNETPDL_ID_EXPR_OPERAND_EXPR)
 	{
@@ -305,6 +336,19 @@ unsigned int Value1BufferSize, Value2BufferSize;
 unsigned int Value1Number, Value2Number;
 int RetVal;
 
+	// Root expressions are usually compiled when the NetPDL engine is initialized
+	if ((ExprNode->CompiledCode) && !(((struct _nbNetPDLExprCode *) ExprNode->CompiledCode)->ReturnsBuffer))
+	{
+	struct _nbNetPDLExprValue Value;
+
+		RetVal= ExecuteCode((struct _nbNetPDLExprCode *) ExprNode->CompiledCode, PDMLStartField, &Value);
+
+		if (RetVal == nbSUCCESS)
+			*Result= Value.Number;
+
+		return RetVal;
+	}
+
 	// If this is not a complex expression, let's return the result right now
 	if (ExprNode->Type != nbNETPDL_ID_EXPR_OPERAND_EXPR)
 	{
@@ -494,6 +538,370 @@ success:
 }
 
 
+/*!
+	\brief Executes the code of a compiled expression.
+
+	\param Code: the code of the expression (see CompileExpression()).
+
+	\param PDMLStartField: pointer to a field within the current PDML fragment, which is
+	the starting point to evaluate the given expression.
+
+	\param Result: keeps the result of the expression (a number or a buffer, according to the expression).
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error, nbWARNING in case a field cannot
+	be found or the packet buffer appears to be truncated (as EvaluateExprNumber() does).
+*/
+int CNetPDLExpression::ExecuteCode(struct _nbNetPDLExprCode *Code, struct _nbPDMLField *PDMLStartField, struct _nbNetPDLExprValue *Result)
+{
+struct _nbNetPDLExprValue Stack[NETPDL_EXPR_MAX_STACK];
+struct _nbNetPDLExprValue *Top= Stack - 1;
+struct _nbNetPDLExprInsn *Insn= Code->Insns;
+struct _nbNetPDLExprInsn *End= Code->Insns + Code->NInsns;
+int RetVal;
+
+	// The compiler verified that the stack cannot overflow
+	while (Insn < End)
+	{
+		switch (Insn->Opcode)
+		{
+			case EXPRCODE_PUSHNUMBER:
+			{
+				Top++;
+				Top->Number= Insn->Arg;
+			}; break;
+
+			case EXPRCODE_PUSHSTRING:
+			{
+				Top++;
+				Top->Buffer= (unsigned char *) Insn->Ptr;
+				Top->Size= Insn->Arg;
+				Top->Mask= NULL;
+			}; break;
+
+			case EXPRCODE_PUSHVARNUMBER:
+			{
+				Top++;
+				m_netPDLVariables->GetVariableNumber(Insn->Arg, &Top->Number);
+			}; break;
+
+			case EXPRCODE_PUSHTABLENUMBER:
+			{
+				Top++;
+				m_netPDLVariables->GetTableDataNumber(Insn->Arg, Insn->Arg2, &Top->Number);
+			}; break;
+
+			case EXPRCODE_PUSHVARBUFFER:
+			case EXPRCODE_PUSHTABLEBUFFER:
+			{
+			unsigned int StartAt= 0, Size= 0;
+
+				if (Insn->Flags & EXPRCODE_FLAG_SIZE)
+					Size= (Top--)->Number;
+				if (Insn->Flags & EXPRCODE_FLAG_STARTAT)
+					StartAt= (Top--)->Number;
+
+				Top++;
+				if (Insn->Opcode == EXPRCODE_PUSHVARBUFFER)
+					RetVal= m_netPDLVariables->GetVariableBuffer(Insn->Arg, StartAt, Size, &Top->Buffer, &Top->Size);
+				else
+					RetVal= m_netPDLVariables->GetTableDataBuffer(Insn->Arg, Insn->Arg2, StartAt, Size, &Top->Buffer, &Top->Size);
+
+				if (RetVal != nbSUCCESS)
+					return RetVal;
+
+				// In case we're getting a string from a variable, the mask is NULL
+				Top->Mask= NULL;
+			}; break;
+
+			case EXPRCODE_LOCATEFIELD:
+			{
+				Top++;
+				RetVal= LocateFieldRef((struct _nbNetPDLExprFieldSlot *) Insn->Ptr, PDMLStartField, Top);
+
+				if (RetVal != nbSUCCESS)
+					return RetVal;
+			}; break;
+
+			case EXPRCODE_LOADFIELD:
+			{
+			unsigned int StartAt= 0, Size= 0;
+			unsigned int BufferSize;
+
+				if (Insn->Flags & EXPRCODE_FLAG_SIZE)
+					Size= (Top--)->Number;
+				if (Insn->Flags & EXPRCODE_FLAG_STARTAT)
+					StartAt= (Top--)->Number;
+
+				// The position of the field on top of the stack is replaced by its value
+				if ((Insn->Flags & EXPRCODE_FLAG_SIZE) == 0)
+					Size= Top->Size;
+
+				RetVal= m_netPDLVariables->GetVariableBuffer(m_netPDLVariables->m_defaultVarList.PacketBuffer,
+															Top->Number + StartAt, Size, &Top->Buffer, &BufferSize);
+
+				if (RetVal != nbSUCCESS)
+					return RetVal;
+
+				if (BufferSize != Size)
+				{
+					// The packet buffer appears to be truncated; the field size is larger than data contained in the packet buffer
+					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "The packet buffer appears to be truncated.");
+					return nbWARNING;
+				}
+
+				Top->Size= Size;
+
+				// If we have a masked field accessed by [], let's move the mask of this field onward
+				if ((StartAt) && (Top->Mask))
+					Top->Mask+= StartAt * 2;
+			}; break;
+
+			case EXPRCODE_ISPRESENT:
+			{
+			struct _nbNetPDLExprFieldSlot *Slot= (struct _nbNetPDLExprFieldSlot *) Insn->Ptr;
+			unsigned int FieldOffset, FieldSize;
+			char *FieldMask;
+
+				if (PDMLStartField == NULL)
+				{
+					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "We're trying to locate the value of a fieldref within a NULL PDML fragment");
+					return nbFAILURE;
+				}
+
+				RetVal= FindFieldRefValue(PDMLStartField, Slot->Operand->ProtoName, Slot->Operand->FieldName,
+															&FieldOffset, &FieldSize, &FieldMask, m_errbuf, m_errbufSize);
+
+				if ((RetVal != nbSUCCESS) && (RetVal != nbWARNING))
+					return nbFAILURE;
+
+				Top++;
+				Top->Number= (RetVal == nbSUCCESS);
+			}; break;
+
+			case EXPRCODE_OPERAND:
+			{
+				Top++;
+				Top->Buffer= NULL;
+				Top->Mask= NULL;
+
+				if (Insn->Flags & EXPRCODE_FLAG_BUFFER)
+					RetVal= GetOperandBuffer((struct _nbNetPDLExprBase *) Insn->Ptr, PDMLStartField, &Top->Buffer, &Top->Mask, &Top->Size);
+				else
+					RetVal= GetOperandNumber((struct _nbNetPDLExprBase *) Insn->Ptr, PDMLStartField, &Top->Number);
+
+				if (RetVal != nbSUCCESS)
+					return RetVal;
+			}; break;
+
+			case EXPRCODE_BUF2INT:
+			{
+			int Number, Mask;
+
+				Number= NetPDLHexDumpToLong(Top->Buffer, Top->Size, 1);
+
+				if (Top->Mask != NULL)
+				{
+					// Being an ascii buffer, its size is two times the buffer that contains the number
+					Mask= NetPDLAsciiStringToLong(Top->Mask, Top->Size * 2, 16);
+
+					// Rotate until the last bit is '0'
+					while ((Mask != 0) && ((Mask & 0x01) == 0))
+					{
+						Mask= Mask >> 1;
+						Number= Number >> 1;
+					}
+
+					Number= Number & Mask;
+				}
+
+				Top->Number= Number;
+			}; break;
+
+			case EXPRCODE_ASCII2INT:
+			{
+				Top->Number= NetPDLAsciiStringToLong((char*) Top->Buffer, Top->Size, 10);
+			}; break;
+
+			case EXPRCODE_INT2BUF:
+			{
+			struct _nbNetPDLExprFunctionInt2Buf* Operand= (struct _nbNetPDLExprFunctionInt2Buf*) Insn->Ptr;
+
+				NetPDLLongToHexDump(Top->Number, Operand->ResultSize, Operand->Result);
+
+				Top->Buffer= Operand->Result;
+				Top->Size= Operand->ResultSize;
+				Top->Mask= NULL;
+			}; break;
+
+			case EXPRCODE_CHANGEBYTEORDER:
+			{
+			struct _nbNetPDLExprFunctionChangeByteOrder* Operand= (struct _nbNetPDLExprFunctionChangeByteOrder*) Insn->Ptr;
+			unsigned int i;
+
+				if ((Top->Size != 1) && (Top->Size != 2) && (Top->Size != 4) && (Top->Size != 8))
+				{
+					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize,
+							"The changebyteorder() function cannot operate when string size is different from 1, 2, 4 or 8 (only if 64 bits are supported) bytes.");
+					return nbFAILURE;
+				}
+
+				for (i= 0; i < Top->Size; i++)
+					Operand->ResultBuffer[i]= Top->Buffer[Top->Size - 1 - i];
+
+				Top->Buffer= Operand->ResultBuffer;
+				Top->Mask= NULL;
+			}; break;
+
+			case EXPRCODE_JUMPIFZERO:
+			{
+				if (Top->Number == 0)
+				{
+					Insn= Code->Insns + Insn->Arg;
+					continue;
+				}
+			}; break;
+
+			case EXPRCODE_JUMPIFNOTZERO:
+			{
+				if (Top->Number != 0)
+				{
+					Insn= Code->Insns + Insn->Arg;
+					continue;
+				}
+			}; break;
+
+			case EXPRCODE_ADD: { Top--; Top->Number= (Top[0].Number + Top[1].Number); }; break;
+			case EXPRCODE_SUB: { Top--; Top->Number= (Top[0].Number - Top[1].Number); }; break;
+			case EXPRCODE_MUL: { Top--; Top->Number= (Top[0].Number * Top[1].Number); }; break;
+			case EXPRCODE_DIV: { Top--; Top->Number= (Top[0].Number / Top[1].Number); }; break;
+			case EXPRCODE_MOD: { Top--; Top->Number= (Top[0].Number % Top[1].Number); }; break;
+			case EXPRCODE_BITWAND: { Top--; Top->Number= (Top[0].Number & Top[1].Number); }; break;
+			case EXPRCODE_BITWOR: { Top--; Top->Number= (Top[0].Number | Top[1].Number); }; break;
+			case EXPRCODE_AND: { Top--; Top->Number= (Top[0].Number && Top[1].Number); }; break;
+			case EXPRCODE_OR: { Top--; Top->Number= (Top[0].Number || Top[1].Number); }; break;
+			case EXPRCODE_NOT: { Top->Number= !Top->Number; }; break;
+			case EXPRCODE_BITWNOT: { Top->Number= ~Top->Number; }; break;
+			case EXPRCODE_GREAT: { Top--; Top->Number= (Top[0].Number > Top[1].Number); }; break;
+			case EXPRCODE_GREATEQUAL: { Top--; Top->Number= (Top[0].Number >= Top[1].Number); }; break;
+			case EXPRCODE_LESS: { Top--; Top->Number= (Top[0].Number < Top[1].Number); }; break;
+			case EXPRCODE_LESSEQUAL: { Top--; Top->Number= (Top[0].Number <= Top[1].Number); }; break;
+			case EXPRCODE_EQUAL: { Top--; Top->Number= (Top[0].Number == Top[1].Number); }; break;
+			case EXPRCODE_NOTEQUAL: { Top--; Top->Number= (Top[0].Number != Top[1].Number); }; break;
+			case EXPRCODE_GREATBUF: { Top--; Top->Number= (memcmp(Top[0].Buffer, Top[1].Buffer, MIN(Top[0].Size, Top[1].Size)) > 0); }; break;
+			case EXPRCODE_LESSBUF: { Top--; Top->Number= (memcmp(Top[0].Buffer, Top[1].Buffer, MIN(Top[0].Size, Top[1].Size)) < 0); }; break;
+			case EXPRCODE_EQUALBUF: { Top--; Top->Number= (memcmp(Top[0].Buffer, Top[1].Buffer, MIN(Top[0].Size, Top[1].Size)) == 0); }; break;
+			case EXPRCODE_NOTEQUALBUF: { Top--; Top->Number= (memcmp(Top[0].Buffer, Top[1].Buffer, MIN(Top[0].Size, Top[1].Size)) != 0); }; break;
+
+			default:
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Internal error: invalid instruction in a compiled expression.");
+				return nbFAILURE;
+			}
+		}
+
+		Insn++;
+	}
+
+	*Result= *Top;
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Locates the field referred by a compiled expression.
+
+	\param Slot: the field reference, whose name has been split when the expression has been compiled.
+
+	\param PDMLStartField: starting field of the current PDML fragment.
+
+	\param Position: it will contain the offset of the field in the packet (in 'Number'),
+	its size and its mask.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error, nbWARNING if the field cannot be found.
+*/
+int CNetPDLExpression::LocateFieldRef(struct _nbNetPDLExprFieldSlot *Slot, struct _nbPDMLField *PDMLStartField, struct _nbNetPDLExprValue *Position)
+{
+struct _nbNetPDLExprFieldRef* Operand= Slot->Operand;
+int RetVal;
+
+	if (PDMLStartField == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "We're trying to locate the value of a fieldref within a NULL PDML fragment");
+		return nbFAILURE;
+	}
+
+	if (Slot->NSubfields == 0)
+	{
+		// Subfields are missing, let's return the single field value
+		if (Slot->IsThis)
+			RetVal= FindFieldRefValue(PDMLStartField, NULL, NULL,
+														&Position->Number, &Position->Size, &Position->Mask, m_errbuf, m_errbufSize);
+		else
+			RetVal= FindFieldRefValue(PDMLStartField, Operand->ProtoName, Operand->FieldName,
+														&Position->Number, &Position->Size, &Position->Mask, m_errbuf, m_errbufSize);
+	}
+	else
+	{
+	struct _nbPDMLField *PDMLField;
+	unsigned int i;
+
+		// Recognize PDML Element relevant to first field
+		if (Slot->IsThis)
+			RetVal= FindFieldRef(PDMLStartField, NULL, NULL, &PDMLField, m_errbuf, m_errbufSize);
+		else
+			RetVal= FindFieldRef(PDMLStartField, Operand->ProtoName, Slot->Names, &PDMLField, m_errbuf, m_errbufSize);
+
+		// Each subfield is looked for among the children of the previous one
+		for (i= 0; (RetVal == nbSUCCESS) && (i < Slot->NSubfields); i++)
+		{
+			for (PDMLField= PDMLField->FirstChild; PDMLField != NULL; PDMLField= PDMLField->NextField)
+			{
+				if (strncmp(Slot->Subfields[i], PDMLField->Name, Slot->SubfieldsLen[i]) == 0)
+					break;
+			}
+
+			if (PDMLField == NULL)
+				RetVal= nbWARNING;
+		}
+
+		if (RetVal == nbSUCCESS)
+			RetVal= CPDMLMaker::ScanForFieldRefValue(PDMLField, Operand->ProtoName, PDMLField->Name,
+														&Position->Number, &Position->Size, &Position->Mask, m_errbuf, m_errbufSize);
+	}
+
+	if (RetVal == nbWARNING)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, 
+			"The NetPDL protocol database contains a reference to a field that cannot be located in the PDML fragment: Protocol '%s', Field '%s'",
+			PDMLStartField->ParentProto->Name, Operand->FieldName);
+	}
+
+	return RetVal;
+}
+
+
+//! Locates a field reference (see CPDMLMaker::ScanForFieldRef()), using the index of the PDMLMaker if available.
+int CNetPDLExpression::FindFieldRef(struct _nbPDMLField *PDMLStartField, char *ProtoName, char *FieldName,
+								  struct _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize)
+{
+	if (m_PDMLMaker)
+		return m_PDMLMaker->FindFieldRef(PDMLStartField, ProtoName, FieldName, PDMLLocatedField, ErrBuf, ErrBufSize);
+
+	return CPDMLMaker::ScanForFieldRef(PDMLStartField, ProtoName, FieldName, PDMLLocatedField, ErrBuf, ErrBufSize);
+}
+
+
+//! Locates the value of a field reference (see CPDMLMaker::ScanForFieldRefValue()), using the index of the PDMLMaker if available.
+int CNetPDLExpression::FindFieldRefValue(struct _nbPDMLField *PDMLStartField, char *ProtoName, char *FieldName,
+								  unsigned int *FieldOffset, unsigned int *FieldSize, char **FieldMask, char *ErrBuf, int ErrBufSize)
+{
+	if (m_PDMLMaker)
+		return m_PDMLMaker->FindFieldRefValue(PDMLStartField, ProtoName, FieldName, FieldOffset, FieldSize, FieldMask, ErrBuf, ErrBufSize);
+
+	return CPDMLMaker::ScanForFieldRefValue(PDMLStartField, ProtoName, FieldName, FieldOffset, FieldSize, FieldMask, ErrBuf, ErrBufSize);
+}
+
+
 /*!
 	\brief Returns a numeric operand
 
@@ -776,7 +1184,7 @@ int RetVal;
 				return nbFAILURE;
 			}
 
-			RetVal= CPDMLMaker::ScanForFieldRefValue(PDMLStartField, Operand->NetPDLField->ProtoName, Operand->NetPDLField->FieldName,
+			RetVal= FindFieldRefValue(PDMLStartField, Operand->NetPDLField->ProtoName, Operand->NetPDLField->FieldName,
 														&FieldOffset, &BufferMaxSize, &BufferMask, m_errbuf, m_errbufSize);
 
 			if (RetVal == nbSUCCESS)
@@ -1041,7 +1449,7 @@ int RetVal;
 			if (CurrentField == NULL)
 			{
 				// Subfields are missing, let's return the single field value
-				RetVal= CPDMLMaker::ScanForFieldRefValue(PDMLStartField, Operand->ProtoName, Operand->FieldName,
+				RetVal= FindFieldRefValue(PDMLStartField, Operand->ProtoName, Operand->FieldName,
 															&FieldOffset, BufferMaxSize, BufferMask, m_errbuf, m_errbufSize);
 			}
 			else
@@ -1050,7 +1458,7 @@ int RetVal;
 			uint8_t SubfieldFound;
 
 				// Recognize PDML Element relevant to first field
-				RetVal= CPDMLMaker::ScanForFieldRef(PDMLStartField, Operand->ProtoName, FirstField, &TempPDMLElement, m_errbuf, m_errbufSize); 
+				RetVal= FindFieldRef(PDMLStartField, Operand->ProtoName, FirstField, &TempPDMLElement, m_errbuf, m_errbufSize); 
 
 				if (RetVal != nbSUCCESS)
 				{
@@ -1180,7 +1588,7 @@ int RetVal;
 			if (CurrentField == NULL)
 			{
 				// Subfields are missing, let's return the single field value
-				RetVal= CPDMLMaker::ScanForFieldRefValue(PDMLStartField, NULL, NULL,
+				RetVal= FindFieldRefValue(PDMLStartField, NULL, NULL,
 															&FieldOffset, BufferMaxSize, BufferMask, m_errbuf, m_errbufSize);
 			}
 			else
@@ -1189,7 +1597,7 @@ int RetVal;
 			uint8_t SubfieldFound;
 
 				// Recognize PDML Element relevant to first field
-				RetVal= CPDMLMaker::ScanForFieldRef(PDMLStartField, NULL, NULL, &TempPDMLElement, m_errbuf, m_errbufSize); 
+				RetVal= FindFieldRef(PDMLStartField, NULL, NULL, &TempPDMLElement, m_errbuf, m_errbufSize); 
 
 				if (RetVal != nbSUCCESS)
 				{
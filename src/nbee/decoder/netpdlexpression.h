@@ -20,6 +20,122 @@
 
 #define MATCHING_OFFSET_COUNT 30 /* For returning results from regex; this number should be a multiple of 3 */
 
+//! Maximum depth of the stack used by the compiled expressions; deeper expressions are not compiled
+#define NETPDL_EXPR_MAX_STACK 32
+
+
+/*!
+	\brief Instructions of the compiled NetPDL expressions.
+
+	Expressions are compiled into a sequence of instructions that work on a stack of values;
+	operands are pushed on the stack, operators pop their operands and push their result.
+*/
+typedef enum
+{
+	EXPRCODE_PUSHNUMBER,		//!< Pushes the number in Arg
+	EXPRCODE_PUSHSTRING,		//!< Pushes the string in Ptr, whose size is Arg
+	EXPRCODE_PUSHVARNUMBER,		//!< Pushes the numeric variable whose ID is Arg
+	EXPRCODE_PUSHVARBUFFER,		//!< Pops the size and the starting offset (if present, see Flags) and pushes the buffer variable whose ID is Arg
+	EXPRCODE_PUSHTABLENUMBER,	//!< Pushes the numeric member Arg2 of the lookup table Arg
+	EXPRCODE_PUSHTABLEBUFFER,	//!< Pops the size and the starting offset (if present, see Flags) and pushes the buffer member Arg2 of the lookup table Arg
+	EXPRCODE_LOCATEFIELD,		//!< Pushes the position of the field described by the field slot in Ptr
+	EXPRCODE_LOADFIELD,			//!< Pops the size and the starting offset (if present, see Flags) and the position of a field, and pushes its value
+	EXPRCODE_ISPRESENT,			//!< Pushes '1' if the field described by the field slot in Ptr is present, '0' otherwise
+	EXPRCODE_OPERAND,			//!< Pushes the value of the operand in Ptr, computed by walking its tree (used for the less common functions)
+	EXPRCODE_BUF2INT,			//!< Pops a buffer and pushes its numeric value (the mask of the buffer is taken into account)
+	EXPRCODE_ASCII2INT,			//!< Pops a buffer and pushes the number written in it
+	EXPRCODE_INT2BUF,			//!< Pops a number and pushes it as a buffer (the buffer belongs to the operand in Ptr)
+	EXPRCODE_CHANGEBYTEORDER,	//!< Pops a buffer and pushes it in the other byte order (the buffer belongs to the operand in Ptr)
+	EXPRCODE_JUMPIFZERO,		//!< Jumps to instruction Arg if the value on top of the stack is zero (the value is not popped)
+	EXPRCODE_JUMPIFNOTZERO,		//!< Jumps to instruction Arg if the value on top of the stack is not zero (the value is not popped)
+	EXPRCODE_ADD,				//!< Pops two numbers and pushes their sum
+	EXPRCODE_SUB,				//!< Pops two numbers and pushes their difference
+	EXPRCODE_MUL,				//!< Pops two numbers and pushes their product
+	EXPRCODE_DIV,				//!< Pops two numbers and pushes their quotient
+	EXPRCODE_MOD,				//!< Pops two numbers and pushes the remainder of their division
+	EXPRCODE_BITWAND,			//!< Pops two numbers and pushes their bitwise and
+	EXPRCODE_BITWOR,			//!< Pops two numbers and pushes their bitwise or
+	EXPRCODE_AND,				//!< Pops two numbers and pushes their logical and
+	EXPRCODE_OR,				//!< Pops two numbers and pushes their logical or
+	EXPRCODE_NOT,				//!< Pops a number and pushes its logical negation
+	EXPRCODE_BITWNOT,			//!< Pops a number and pushes its bitwise negation
+	EXPRCODE_GREAT,				//!< Pops two numbers and pushes '1' if the first is greater than the second
+	EXPRCODE_GREATEQUAL,		//!< Pops two numbers and pushes '1' if the first is greater than or equal to the second
+	EXPRCODE_LESS,				//!< Pops two numbers and pushes '1' if the first is less than the second
+	EXPRCODE_LESSEQUAL,			//!< Pops two numbers and pushes '1' if the first is less than or equal to the second
+	EXPRCODE_EQUAL,				//!< Pops two numbers and pushes '1' if they are equal
+	EXPRCODE_NOTEQUAL,			//!< Pops two numbers and pushes '1' if they are different
+	EXPRCODE_GREATBUF,			//!< Pops two buffers and pushes '1' if the first is greater than the second
+	EXPRCODE_LESSBUF,			//!< Pops two buffers and pushes '1' if the first is less than the second
+	EXPRCODE_EQUALBUF,			//!< Pops two buffers and pushes '1' if they are equal
+	EXPRCODE_NOTEQUALBUF		//!< Pops two buffers and pushes '1' if they are different
+} nbNetPDLExprOpcodes_t;
+
+
+//! Flags of the instructions that access buffers: the starting offset has been pushed on the stack
+#define EXPRCODE_FLAG_STARTAT	0x01
+//! Flags of the instructions that access buffers: the size has been pushed on the stack
+#define EXPRCODE_FLAG_SIZE		0x02
+//! Flag of the EXPRCODE_OPERAND instruction: the operand returns a buffer
+#define EXPRCODE_FLAG_BUFFER	0x04
+
+
+/*!
+	\brief Reference to a field, resolved when the expression is compiled.
+
+	The name of the field is split in advance into the name of the field and the names of its subfields.
+*/
+struct _nbNetPDLExprFieldSlot
+{
+	//! Operand this slot has been created from (the names below point into the operand)
+	struct _nbNetPDLExprFieldRef *Operand;
+	//! 'true' if the field is the one being decoded ('this')
+	int IsThis;
+	//! Names of the field and of its subfields, separated by '\0' (a private copy)
+	char *Names;
+	//! Names of the subfields of the field (pointers into 'Names')
+	char **Subfields;
+	//! Length of the names of the subfields
+	unsigned int *SubfieldsLen;
+	//! Number of subfields
+	unsigned int NSubfields;
+};
+
+
+//! Instruction of a compiled expression
+struct _nbNetPDLExprInsn
+{
+	nbNetPDLExprOpcodes_t Opcode;	//!< Instruction
+	int Flags;						//!< Flags of the instruction (EXPRCODE_FLAG_xxx)
+	unsigned int Arg;				//!< First argument (a constant, a variable or table ID, a jump target...)
+	unsigned int Arg2;				//!< Second argument (e.g. the member of a lookup table)
+	void *Ptr;						//!< Pointer argument (a string, a field slot, an operand)
+};
+
+
+//! Value on the stack of a compiled expression
+struct _nbNetPDLExprValue
+{
+	unsigned int Number;			//!< Numeric value (or offset of the field, for a position)
+	unsigned char *Buffer;			//!< Buffer value
+	unsigned int Size;				//!< Size of the buffer
+	char *Mask;						//!< Mask of the buffer (NULL if it does not have any)
+};
+
+
+//! Code of a compiled expression
+struct _nbNetPDLExprCode
+{
+	struct _nbNetPDLExprInsn *Insns;			//!< Instructions
+	unsigned int NInsns;						//!< Number of instructions
+	int ReturnsBuffer;							//!< 'true' if the expression returns a buffer
+	struct _nbNetPDLExprFieldSlot *Slots;		//!< Field references used by the expression
+	unsigned int NSlots;						//!< Number of field references
+};
+
+
+class CPDMLMaker;
+
 
 /*!
 	\brief This class manages NetPDL expressions
@@ -41,14 +157,29 @@ public:
 	int EvaluateAssignLookupTable(struct _nbNetPDLElementAssignLookupTable *LookupTable, struct _nbPDMLField *PDMLStartField);
 	int EvaluateLookupTable(struct _nbNetPDLElementUpdateLookupTable *LookupTableEntry, struct _nbPDMLField *PDMLStartField);
 
+	void SetPDMLMaker(CPDMLMaker *PDMLMaker);
+
+	// Compiling methods
+	static struct _nbNetPDLExprCode *CompileExpression(struct _nbNetPDLExprBase *ExprNode);
+	static void FreeCompiledExpression(struct _nbNetPDLExprCode *Code);
+
 private:
+	int ExecuteCode(struct _nbNetPDLExprCode *Code, struct _nbPDMLField *PDMLStartField, struct _nbNetPDLExprValue *Result);
+	int LocateFieldRef(struct _nbNetPDLExprFieldSlot *Slot, struct _nbPDMLField *PDMLStartField, struct _nbNetPDLExprValue *Position);
 	int GetOperandBuffer(struct _nbNetPDLExprBase *OperandBase, struct _nbPDMLField *PDMLStartField, 
 								  unsigned char **BufferValue, char **BufferMask, unsigned int *BufferMaxSize);
 	int GetOperandNumber(struct _nbNetPDLExprBase *OperandBase, struct _nbPDMLField *PDMLStartField, unsigned int *ResultValue);
+	int FindFieldRef(struct _nbPDMLField *PDMLStartField, char *ProtoName, char *FieldName,
+								  struct _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize);
+	int FindFieldRefValue(struct _nbPDMLField *PDMLStartField, char *ProtoName, char *FieldName,
+								  unsigned int *FieldOffset, unsigned int *FieldSize, char **FieldMask, char *ErrBuf, int ErrBufSize);
 
 	//! Pointer to the run-time variables managed by the NetPDL engine
 	CNetPDLVariables *m_netPDLVariables;
 
+	//! Pointer to the class that creates the PDML fragment of the current packet (if any); it keeps the index of the decoded fields
+	CPDMLMaker *m_PDMLMaker;
+
 	//! Pointer to the buffer that will keep the error message (if any); this buffer belongs to the class that creates this one.
 	char *m_errbuf;
 	//! Size of the buffer that will keep the error message (if any); this buffer belongs to the class that creates this one.
@@ -0,0 +1,344 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <nbee.h>
+#include <nbprotodb.h>
+#include <nbprotodb_defs.h>
+
+#include "netpdlfielddict.h"
+#include "../globals/globals.h"
+#include "../globals/debug.h"
+
+
+//! Hashes a name (FNV-1a).
+static inline unsigned int HashName(const char *Name)
+{
+unsigned int Hash= 2166136261U;
+
+	while (*Name)
+		Hash= (Hash ^ (unsigned char) *Name++) * 16777619U;
+
+	return Hash;
+}
+
+
+//! Hashes a field name together with the protocol it belongs to.
+static inline unsigned int HashFieldName(int ProtoIndex, const char *FieldName)
+{
+	return HashName(FieldName) ^ ((unsigned int) ProtoIndex * 0x9E3779B1U);
+}
+
+
+//! Returns the smallest power of two that is at least twice the given number of items (load factor below 50%).
+static unsigned int GetTableSize(unsigned int NItems)
+{
+unsigned int Size= NETPDLFIELDDICT_MIN_SLOTS;
+
+	while (Size < NItems * 2)
+		Size*= 2;
+
+	return Size;
+}
+
+
+CNetPDLFieldDictionary::CNetPDLFieldDictionary()
+{
+	m_netPDLDatabase= NULL;
+
+	m_protos= NULL;
+	m_protosSize= 0;
+
+	m_fields= NULL;
+	m_fieldsNItems= 0;
+	m_fieldsMaxItems= 0;
+
+	m_fieldSlots= NULL;
+	m_fieldSlotsSize= 0;
+}
+
+
+CNetPDLFieldDictionary::~CNetPDLFieldDictionary()
+{
+	free(m_protos);
+	free(m_fields);
+	free(m_fieldSlots);
+}
+
+
+/*!
+	\brief Builds the dictionary from the given NetPDL database.
+
+	\param NetPDLDatabase: the NetPDL database; the dictionary keeps pointers into it, hence it must not be
+	used after the database has been deallocated.
+
+	\param ErrBuf: buffer that will keep the error message (if any).
+
+	\param ErrBufSize: size of the previous buffer.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLFieldDictionary::Initialize(struct _nbNetPDLDatabase *NetPDLDatabase, char *ErrBuf, int ErrBufSize)
+{
+	if (NetPDLDatabase == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL database has not been loaded.");
+		return nbFAILURE;
+	}
+
+	// In case a previous attempt failed
+	free(m_protos);
+	free(m_fields);
+	free(m_fieldSlots);
+	m_protos= NULL;
+	m_fields= NULL;
+	m_fieldSlots= NULL;
+	m_fieldsNItems= 0;
+	m_fieldsMaxItems= 0;
+
+	m_netPDLDatabase= NetPDLDatabase;
+
+	m_protosSize= GetTableSize(NetPDLDatabase->ProtoListNItems);
+	m_protos= (struct _ProtoName *) calloc(m_protosSize, sizeof(struct _ProtoName));
+	if (m_protos == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the dictionary of the NetPDL fields.");
+		return nbFAILURE;
+	}
+
+	for (unsigned int i= 0; i < NetPDLDatabase->ProtoListNItems; i++)
+	{
+	const char *ProtoName= NetPDLDatabase->ProtoList[i]->Name;
+	unsigned int Hash;
+	unsigned int Slot;
+
+		Hash= HashName(ProtoName);
+
+		// In case of duplicated names, the first protocol wins
+		if (LookupProto(ProtoName) >= 0)
+			continue;
+
+		Slot= Hash & (m_protosSize - 1);
+		while (m_protos[Slot].Name)
+			Slot= (Slot + 1) & (m_protosSize - 1);
+
+		m_protos[Slot].Name= ProtoName;
+		m_protos[Slot].Hash= Hash;
+		m_protos[Slot].ProtoIndex= i;
+
+		if (AddFields(NetPDLDatabase->ProtoList[i]->FirstField, i, ErrBuf, ErrBufSize) == nbFAILURE)
+			return nbFAILURE;
+	}
+
+	return BuildFieldSlots(ErrBuf, ErrBufSize);
+}
+
+
+/*!
+	\brief Returns the position of the protocol with the given name in NetPDLDatabase->ProtoList, or -1 if it cannot be found.
+*/
+int CNetPDLFieldDictionary::LookupProto(const char *ProtoName)
+{
+unsigned int Hash;
+unsigned int Slot;
+
+	Hash= HashName(ProtoName);
+
+	Slot= Hash & (m_protosSize - 1);
+	while (m_protos[Slot].Name)
+	{
+		if ((m_protos[Slot].Hash == Hash) && (strcmp(m_protos[Slot].Name, ProtoName) == 0))
+			return m_protos[Slot].ProtoIndex;
+
+		Slot= (Slot + 1) & (m_protosSize - 1);
+	}
+
+	return -1;
+}
+
+
+/*!
+	\brief Returns the field with the given name within a protocol, or NULL if it cannot be found.
+
+	\param ProtoIndex: position of the protocol in NetPDLDatabase->ProtoList, as returned by LookupProto().
+
+	\param FieldName: name of the field.
+*/
+struct _nbNetPDLFieldHandle *CNetPDLFieldDictionary::LookupField(int ProtoIndex, const char *FieldName)
+{
+unsigned int Hash;
+unsigned int Slot;
+
+	Hash= HashFieldName(ProtoIndex, FieldName);
+
+	Slot= Hash & (m_fieldSlotsSize - 1);
+	while (m_fieldSlots[Slot])
+	{
+	struct _nbNetPDLFieldHandle *Field= &m_fields[m_fieldSlots[Slot] - 1];
+
+		if ((Field->Hash == Hash) && (Field->ProtoIndex == ProtoIndex) && (strcmp(Field->FieldName, FieldName) == 0))
+			return Field;
+
+		Slot= (Slot + 1) & (m_fieldSlotsSize - 1);
+	}
+
+	return NULL;
+}
+
+
+/*!
+	\brief Adds all the fields contained in a section of the NetPDL definition of a protocol.
+
+	The NetPDL elements are visited in the same order as CNetPDLDecoderUtils used to do when looking for
+	a field: fields (and their bitfields), the content of the 'container' elements, both the branches of the
+	'if' elements and the blocks that are included; other elements are skipped.
+
+	\param FirstElement: first element of the section (e.g. the first field of the protocol).
+
+	\param ProtoIndex: position of the protocol in NetPDLDatabase->ProtoList.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLFieldDictionary::AddFields(struct _nbNetPDLElementBase *FirstElement, int ProtoIndex, char *ErrBuf, int ErrBufSize)
+{
+struct _nbNetPDLElementBase *CurrentElement;
+int RetVal= nbSUCCESS;
+
+	CurrentElement= FirstElement;
+
+	while (CurrentElement)
+	{
+		switch (CurrentElement->Type)
+		{
+			case nbNETPDL_IDEL_FIELD:
+			{
+				RetVal= AddField((struct _nbNetPDLElementFieldBase *) CurrentElement, ProtoIndex, ErrBuf, ErrBufSize);
+
+				// Bitfields, if any
+				if ((RetVal == nbSUCCESS) && (CurrentElement->FirstChild != nbNETPDL_INVALID_ELEMENT))
+					RetVal= AddFields(nbNETPDL_GET_ELEMENT(m_netPDLDatabase, CurrentElement->FirstChild), ProtoIndex, ErrBuf, ErrBufSize);
+
+				break;
+			};
+
+			case nbNETPDL_IDEL_SWITCH:
+			case nbNETPDL_IDEL_CASE:
+			case nbNETPDL_IDEL_DEFAULT:
+			case nbNETPDL_IDEL_LOOP:
+			case nbNETPDL_IDEL_BLOCK:
+			{
+				RetVal= AddFields(nbNETPDL_GET_ELEMENT(m_netPDLDatabase, CurrentElement->FirstChild), ProtoIndex, ErrBuf, ErrBufSize);
+				break;
+			};
+
+			case nbNETPDL_IDEL_IF:
+			{
+			struct _nbNetPDLElementIf *IfElement= (struct _nbNetPDLElementIf *) CurrentElement;
+
+				RetVal= AddFields(IfElement->FirstValidChildIfTrue, ProtoIndex, ErrBuf, ErrBufSize);
+
+				if (RetVal == nbSUCCESS)
+					RetVal= AddFields(IfElement->FirstValidChildIfFalse, ProtoIndex, ErrBuf, ErrBufSize);
+
+				break;
+			};
+
+			case nbNETPDL_IDEL_INCLUDEBLK:
+			{
+			struct _nbNetPDLElementIncludeBlk *IncludeBlkElement= (struct _nbNetPDLElementIncludeBlk *) CurrentElement;
+
+				RetVal= AddFields(nbNETPDL_GET_ELEMENT(m_netPDLDatabase, (IncludeBlkElement->IncludedBlock)->FirstChild),
+							ProtoIndex, ErrBuf, ErrBufSize);
+				break;
+			};
+
+			// Other elements (e.g. 'loopctrl') do not contain fields
+			default:
+				break;
+		}
+
+		if (RetVal == nbFAILURE)
+			return nbFAILURE;
+
+		CurrentElement= nbNETPDL_GET_ELEMENT(m_netPDLDatabase, CurrentElement->NextSibling);
+	}
+
+	return nbSUCCESS;
+}
+
+
+//! Appends a field to the list of the fields of the dictionary.
+int CNetPDLFieldDictionary::AddField(struct _nbNetPDLElementFieldBase *FieldElement, int ProtoIndex, char *ErrBuf, int ErrBufSize)
+{
+struct _nbNetPDLFieldHandle *Field;
+
+	if (FieldElement->Name == NULL)
+		return nbSUCCESS;
+
+	if (m_fieldsNItems == m_fieldsMaxItems)
+	{
+	struct _nbNetPDLFieldHandle *NewFields;
+	unsigned int NewMaxItems= (m_fieldsMaxItems ? m_fieldsMaxItems * 2 : NETPDLFIELDDICT_MIN_SLOTS);
+
+		NewFields= (struct _nbNetPDLFieldHandle *) realloc(m_fields, NewMaxItems * sizeof(struct _nbNetPDLFieldHandle));
+		if (NewFields == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the dictionary of the NetPDL fields.");
+			return nbFAILURE;
+		}
+
+		m_fields= NewFields;
+		m_fieldsMaxItems= NewMaxItems;
+	}
+
+	Field= &m_fields[m_fieldsNItems++];
+
+	Field->FieldName= FieldElement->Name;
+	Field->Hash= HashFieldName(ProtoIndex, FieldElement->Name);
+	Field->ProtoIndex= ProtoIndex;
+	Field->NetPDLElement= FieldElement;
+
+	if (FieldElement->ShowTemplateInfo)
+		Field->FastPrintingFunctionCode= (int) FieldElement->ShowTemplateInfo->ShowNativeFunction;
+	else
+		Field->FastPrintingFunctionCode= 0;
+
+	return nbSUCCESS;
+}
+
+
+//! Builds the hash table of the fields, once all the fields have been added.
+int CNetPDLFieldDictionary::BuildFieldSlots(char *ErrBuf, int ErrBufSize)
+{
+	m_fieldSlotsSize= GetTableSize(m_fieldsNItems);
+	m_fieldSlots= (unsigned int *) calloc(m_fieldSlotsSize, sizeof(unsigned int));
+	if (m_fieldSlots == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the dictionary of the NetPDL fields.");
+		return nbFAILURE;
+	}
+
+	for (unsigned int i= 0; i < m_fieldsNItems; i++)
+	{
+	struct _nbNetPDLFieldHandle *Field= &m_fields[i];
+	unsigned int Slot;
+
+		// In case of duplicated names within the same protocol, the first field wins
+		if (LookupField(Field->ProtoIndex, Field->FieldName))
+			continue;
+
+		Slot= Field->Hash & (m_fieldSlotsSize - 1);
+		while (m_fieldSlots[Slot])
+			Slot= (Slot + 1) & (m_fieldSlotsSize - 1);
+
+		m_fieldSlots[Slot]= i + 1;
+	}
+
+	return nbSUCCESS;
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/*!
+	\file netpdlfielddict.h
+
+	This file defines the dictionary used by the NetPDL utilities to locate protocols and fields by name.
+*/
+
+
+#pragma once
+
+#include <nbee_netpdlutils.h>
+
+
+//! Minimum number of slots of the hash tables of the dictionary (must be a power of two)
+#define NETPDLFIELDDICT_MIN_SLOTS 64
+
+
+
+/*!
+	\brief Definition of a field in the NetPDL database, as returned by CNetPDLDecoderUtils::GetNetPDLFieldHandle().
+
+	It keeps everything that is needed to format the field, so that the NetPDL database does not need to be
+	scanned each time.
+*/
+struct _nbNetPDLFieldHandle
+{
+	const char *FieldName;								//!< Name of the field (it points into the NetPDL database)
+	unsigned int Hash;									//!< Hash of the (protocol, field name) pair
+	int ProtoIndex;										//!< Position of the protocol in NetPDLDatabase->ProtoList
+	struct _nbNetPDLElementFieldBase *NetPDLElement;	//!< Definition of the field in the NetPDL database
+	int FastPrintingFunctionCode;						//!< Native printing function of the field, or 0 if none
+};
+
+
+
+/*!
+	\brief Dictionary of the protocols and fields of the NetPDL database, organized by name.
+
+	The dictionary is built once, by walking the whole NetPDL database; then, protocols and fields are located
+	with a hash lookup instead of scanning the list of protocols and the definition of the protocol.
+
+	The dictionary returns what a linear scan would return: in case more protocols have the same name, the first
+	one is returned; in case more fields of the same protocol have the same name, the first one found with a
+	depth-first visit of the protocol (e.g. the 'true' branch of an 'if' before the 'false' one) is returned.
+*/
+class CNetPDLFieldDictionary
+{
+public:
+	CNetPDLFieldDictionary();
+	~CNetPDLFieldDictionary();
+
+	int Initialize(struct _nbNetPDLDatabase *NetPDLDatabase, char *ErrBuf, int ErrBufSize);
+
+	//! Returns 'true' if the dictionary has been built.
+	bool IsInitialized() { return (m_fieldSlots != NULL); }
+
+	int LookupProto(const char *ProtoName);
+	struct _nbNetPDLFieldHandle *LookupField(int ProtoIndex, const char *FieldName);
+
+private:
+	//! Entry of the hash table of the protocol names
+	struct _ProtoName
+	{
+		const char *Name;			//!< Name of the protocol (it points into the NetPDL database), or NULL if the slot is empty
+		unsigned int Hash;			//!< Hash of the name
+		int ProtoIndex;				//!< Position of the protocol in NetPDLDatabase->ProtoList
+	};
+
+	int AddFields(struct _nbNetPDLElementBase *FirstElement, int ProtoIndex, char *ErrBuf, int ErrBufSize);
+	int AddField(struct _nbNetPDLElementFieldBase *FieldElement, int ProtoIndex, char *ErrBuf, int ErrBufSize);
+	int BuildFieldSlots(char *ErrBuf, int ErrBufSize);
+
+	//! NetPDL database the dictionary refers to
+	struct _nbNetPDLDatabase *m_netPDLDatabase;
+
+	//! Hash table of the protocol names (open addressing)
+	struct _ProtoName *m_protos;
+	//! Number of slots of the hash table of the protocols (power of two)
+	unsigned int m_protosSize;
+
+	//! Fields, in the order they have been found in the NetPDL database
+	struct _nbNetPDLFieldHandle *m_fields;
+	//! Number of valid elements of m_fields
+	unsigned int m_fieldsNItems;
+	//! Number of allocated elements of m_fields
+	unsigned int m_fieldsMaxItems;
+
+	//! Hash table of the fields (open addressing); each slot keeps the position of the field in m_fields plus one, or zero if empty
+	unsigned int *m_fieldSlots;
+	//! Number of slots of the hash table of the fields (power of two)
+	unsigned int m_fieldSlotsSize;
+};
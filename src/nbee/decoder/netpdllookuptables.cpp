@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <memory.h>		// for memcpy()
 
 #include <nbprotodb_defs.h>
@@ -25,6 +26,43 @@
 //#define SERVICE_AGE 1
 
 
+//! Hashes the keys of an exact entry (FNV-1a).
+static inline unsigned int HashExactKey(const unsigned char *Key, int KeySize)
+{
+unsigned int Hash= 2166136261U;
+
+	for (int i= 0; i < KeySize; i++)
+		Hash= (Hash ^ Key[i]) * 16777619U;
+
+	return Hash;
+}
+
+
+//! Hashes the keys of a masked entry (FNV-1a); only the bits selected by the mask are taken into account.
+static inline unsigned int HashMaskedKey(const unsigned char *Key, const unsigned char *Mask, int KeySize)
+{
+unsigned int Hash= 2166136261U;
+
+	for (int i= 0; i < KeySize; i++)
+		Hash= (Hash ^ (Key[i] & Mask[i])) * 16777619U;
+
+	return Hash;
+}
+
+
+//! Returns 'true' if the two keys are equal in all the bits selected by the mask.
+static inline int MaskedKeyMatches(const unsigned char *Key, const unsigned char *EntryKey, const unsigned char *Mask, int KeySize)
+{
+	for (int i= 0; i < KeySize; i++)
+	{
+		if ((Key[i] & Mask[i]) != (EntryKey[i] & Mask[i]))
+			return 0;
+	}
+
+	return 1;
+}
+
+
 /*!
 	\brief Default constructor
 
@@ -41,7 +79,6 @@ CNetPDLLookupTables::CNetPDLLookupTables(char *ErrBuf, int ErrBufSize)
 	m_errbufSize= ErrBufSize;
 	
 	m_currNumTables= 0;
-	lookupExactCall = 0;
 }
 
 
@@ -51,6 +88,7 @@ extern struct _nbNetPDLDatabase *NetPDLDatabase;
 CNetPDLLookupTables::~CNetPDLLookupTables()
 {
 struct _TableEntry *CurrentEntry, *NextEntry;
+struct _MaskGroup *CurrentGroup, *NextGroup;
 int TableID;
 int i;
 
@@ -63,6 +101,18 @@ int i;
 
 		free(m_tableList[TableID].Name);
 
+		free(m_tableList[TableID].ExactIndex);
+		free(m_tableList[TableID].ExactIndexHash);
+
+		CurrentGroup= m_tableList[TableID].FirstMaskGroup;
+		while (CurrentGroup)
+		{
+			NextGroup= CurrentGroup->NextGroup;
+			free(CurrentGroup->Buckets);
+			free(CurrentGroup);
+			CurrentGroup= NextGroup;
+		}
+
 		for (i= 0; i< m_tableList[TableID].NumberOfKeys; i++)
 			free(m_tableList[TableID].KeyList[i].Name);
 
@@ -262,6 +312,14 @@ struct _nbNetPDLElementKeyData* TempKeyData;
 		return nbFAILURE;
 	}
 
+	// Let's create the hash index of the exact entries, with (at least) twice the slots of the preallocated entries
+	int ExactIndexSize= LOOKUPTABLE_MIN_EXACT_INDEX_SIZE;
+	while (ExactIndexSize < m_tableList[TableID].NumberOfExactEntries * 2)
+		ExactIndexSize= ExactIndexSize * 2;
+
+	if (ResizeExactIndex(TableID, ExactIndexSize) == nbFAILURE)
+		return nbFAILURE;
+
 	// Get the size of each exact entry in the lookup table...
 	TotalEntrySize= m_tableList[TableID].KeyList[0].KeyDataOffset + m_tableList[TableID].KeysEntrySize + m_tableList[TableID].DataEntrySize;
 
@@ -535,25 +593,33 @@ int i;
 	{
 		m_tableList[TableID].FirstMaskEntry->Timestamp= TimestampSec;
 		m_tableList[TableID].FirstMaskEntry->Lifetime= KeepTime;
+		m_tableList[TableID].FirstMaskEntry->GotHits= 0;
 
 		m_tableList[TableID].FirstMaskEntry->ValidityType= Validity;
 		m_tableList[TableID].FirstMaskEntry->KeepTime= KeepTime;
 		m_tableList[TableID].FirstMaskEntry->HitTime= HitTime;
 		m_tableList[TableID].FirstMaskEntry->NewHitTime= NewHitTime;
+
+		if (AddToMaskIndex(TableID, m_tableList[TableID].FirstMaskEntry) == nbFAILURE)
+			return nbFAILURE;
+
+		ScheduleEntryExpiration(TableID, m_tableList[TableID].FirstMaskEntry);
 	}
 	else
 	{
 		m_tableList[TableID].FirstExactEntry->Timestamp= TimestampSec;
 		m_tableList[TableID].FirstExactEntry->Lifetime= KeepTime;
+		m_tableList[TableID].FirstExactEntry->GotHits= 0;
 
 		m_tableList[TableID].FirstExactEntry->ValidityType= Validity;
 		m_tableList[TableID].FirstExactEntry->KeepTime= KeepTime;
 		m_tableList[TableID].FirstExactEntry->HitTime= HitTime;
 		m_tableList[TableID].FirstExactEntry->NewHitTime= NewHitTime;
-		
-		//We also add an element in the MapExactEntry of this Table
-		HashKey key(((char*) m_tableList[TableID].FirstExactEntry) + m_tableList[TableID].KeyList[0].KeyDataOffset, m_tableList[TableID].KeysEntrySize);
-		MapExact[TableID][key]= m_tableList[TableID].FirstExactEntry;
+
+		if (AddToExactIndex(TableID, m_tableList[TableID].FirstExactEntry) == nbFAILURE)
+			return nbFAILURE;
+
+		ScheduleEntryExpiration(TableID, m_tableList[TableID].FirstExactEntry);
 	}
 
 	
@@ -623,7 +689,7 @@ int i;
 int CNetPDLLookupTables::LookupForTableEntry(int TableID, struct _nbLookupTableKey KeyList[], int TimestampSec, int MatchExactEntries, int MatchMaskEntries, int GetFirstMatch)
 {
 int i;
-struct _TableEntry *CurrentEntry, *NextEntry;
+struct _TableEntry *CurrentEntry;
 
 	if (TableID >= m_currNumTables)
 	{
@@ -633,6 +699,11 @@ struct _TableEntry *CurrentEntry, *NextEntry;
 
 	if (GetFirstMatch)
 	{
+		// Let's purge the entries whose lifetime has elapsed; this costs nothing unless a new second has begun.
+		// This is not done when looking for the next match, since the previous matching entry must survive.
+		if (m_tableList[TableID].AllowDynamicEntries)
+			AdvanceTimerWheel(TableID, TimestampSec);
+
 		// Let's copy keys...
 		for (i= 0; i < m_tableList[TableID].NumberOfKeys; i++)
 		{
@@ -676,54 +747,15 @@ struct _TableEntry *CurrentEntry, *NextEntry;
 
 	if (MatchExactEntries)
 	{
-		// After MAX_CALL_BEFORE_GARBAGE we perform a garbage collection
-		lookupExactCall++;
-		if(lookupExactCall > MAX_CALL_BEFORE_GARBAGE)
-		{
-			lookupExactCall=0;
-			DoGarbageCollection(TimestampSec, 0);
-		}
-
+		// Exact entries have unique keys, so the hash index returns the only possible match
+		CurrentEntry= LookupExactIndex(TableID, (char*) m_tableList[TableID].KeyForCompare);
 
-		// Let's start a linear search in the 'exact' section of the table
-		if (GetFirstMatch)
-			CurrentEntry= m_tableList[TableID].FirstExactEntry;
-		else
-			CurrentEntry= m_tableList[TableID].MatchingEntry->NextEntry;
+		// If we have dynamic entries, we should check the validity of the entry found
+		if ((CurrentEntry) && (m_tableList[TableID].AllowDynamicEntries) &&
+			(CheckAndDeleteIfOldExactEntry(TableID, CurrentEntry, TimestampSec) == nbSUCCESS))
+			CurrentEntry= NULL;
 
-		
-		HashKey key((char*) m_tableList[TableID].KeyForCompare, m_tableList[TableID].KeysEntrySize);
-		std::map<HashKey, _TableEntry*>::iterator it;
-		
-		//This perform a O(n log n) search
-		it = MapExact[TableID].find(key);
-	
-		//No match For the entry
-		if(it == MapExact[TableID].end())
-		{
-			CurrentEntry = NULL;
-			return nbWARNING;
-		}
-		
-		//We get the pointer to the _TableEntry structure
-		CurrentEntry = it->second;
-
-		//If we have dynamic entry, we should check validity of entry found
-		if (m_tableList[TableID].AllowDynamicEntries)
-		{
-				if (CheckAndDeleteIfOldExactEntry(TableID, CurrentEntry, TimestampSec) == nbSUCCESS)
-				{
-					CurrentEntry = NULL;
-					return nbWARNING;
-				}
-				else
-				{
-					m_tableList[TableID].MatchingEntryIsExact= 1;
-					m_tableList[TableID].MatchingEntry= CurrentEntry;
-					return nbSUCCESS;
-				}
-		}
-		else
+		if (CurrentEntry)
 		{
 			m_tableList[TableID].MatchingEntryIsExact= 1;
 			m_tableList[TableID].MatchingEntry= CurrentEntry;
@@ -733,55 +765,19 @@ struct _TableEntry *CurrentEntry, *NextEntry;
 
 	if (MatchMaskEntries)
 	{
-		// Let's start a linear search in the 'masked' section of the table
+		// The masked index returns the entry that is closer to the top of the masked list, i.e. the one
+		// a linear scan would return. In case we are looking for the next match, only the entries that
+		// follow the previous match in the list are taken into account.
 		if (GetFirstMatch)
-			CurrentEntry= m_tableList[TableID].FirstMaskEntry;
+			CurrentEntry= LookupMaskIndex(TableID, (char*) m_tableList[TableID].KeyForCompare, UINT_MAX, TimestampSec);
 		else
-			CurrentEntry= m_tableList[TableID].MatchingEntry->NextEntry;
+			CurrentEntry= LookupMaskIndex(TableID, (char*) m_tableList[TableID].KeyForCompare, m_tableList[TableID].MatchingEntry->Sequence, TimestampSec);
 
-		while (CurrentEntry)
+		if (CurrentEntry)
 		{
-		int OffsetToCompare;
-		char* KeyValue;
-		char* EntryValue;
-		char* MaskValue;
-		int MatchFound= 1;
-
-			NextEntry= CurrentEntry->NextEntry;
-
-			if (CheckAndDeleteIfOldMaskEntry(TableID, CurrentEntry, TimestampSec) == nbSUCCESS)
-			{
-				// The current entry was too old and it has been deleted
-				CurrentEntry= NextEntry;
-				continue;
-			}
-
-			// Please note that we have to cast CurrentEntry into a char*, otherwise 'CurrentEntry + 1' 
-			// means "CurrentEntry + the size of one struct _TableEntry"
-			KeyValue= ((char*) m_tableList[TableID].KeyForCompare);
-			EntryValue= ((char *) CurrentEntry) + m_tableList[TableID].KeyList[0].KeyDataOffset;
-			MaskValue= ((char *) CurrentEntry) + m_tableList[TableID].KeyList[0].MaskOffset;
-
-			for (OffsetToCompare= 0; OffsetToCompare < m_tableList[TableID].KeysEntrySize; OffsetToCompare++)
-			{
-			char Mask;
-
-				Mask= *(MaskValue + OffsetToCompare);
-				if ((*(KeyValue + OffsetToCompare) & Mask)  != (*(EntryValue + OffsetToCompare) & Mask))
-				{
-					MatchFound= 0;
-					break;
-				}
-			}
-			
-			if (MatchFound)
-			{
-				m_tableList[TableID].MatchingEntryIsExact= 0;
-				m_tableList[TableID].MatchingEntry= CurrentEntry;
-				return nbSUCCESS;
-			}
-
-			CurrentEntry= CurrentEntry->NextEntry;
+			m_tableList[TableID].MatchingEntryIsExact= 0;
+			m_tableList[TableID].MatchingEntry= CurrentEntry;
+			return nbSUCCESS;
 		}
 	}
 
@@ -826,6 +822,8 @@ int RetVal;
 				m_tableList[TableID].MatchingEntry->GotHits= 1;
 				m_tableList[TableID].MatchingEntry->Lifetime= m_tableList[TableID].MatchingEntry->HitTime;
 			}
+
+			ScheduleEntryExpiration(TableID, m_tableList[TableID].MatchingEntry);
 			return nbSUCCESS;
 		}; break;
 
@@ -884,6 +882,11 @@ int RetVal;
 						((char*) m_tableList[TableID].MatchingEntry) + m_tableList[TableID].DataList[0].KeyDataOffset,
 						m_tableList[TableID].DataEntrySize);
 
+			if (AddToExactIndex(TableID, m_tableList[TableID].FirstExactEntry) == nbFAILURE)
+				return nbFAILURE;
+
+			ScheduleEntryExpiration(TableID, m_tableList[TableID].FirstExactEntry);
+
 			if (m_tableList[TableID].MatchingEntry->ValidityType == nbNETPDL_UPDATELOOKUPTABLE_VALIDITY_REPLACEONHIT)
 			{
 				// Delete masked item
@@ -900,6 +903,8 @@ int RetVal;
 
 				// Update timestamp of the masked entry
 				m_tableList[TableID].MatchingEntry->Timestamp= TimestampSec;
+
+				ScheduleEntryExpiration(TableID, m_tableList[TableID].MatchingEntry);
 				return nbSUCCESS;
 			}
 		}; break;
@@ -1048,15 +1053,23 @@ int IntegerSize;
 		return nbFAILURE;
 	}
 
+	// The matching entry may have been purged in the meanwhile (e.g. by a 'replaceonhit' update); in this case,
+	// it no longer belongs to the timer wheel, and it must not be scheduled again
 	if (DataID == m_tableList[TableID].TimestampFieldID)
 	{
 		m_tableList[TableID].MatchingEntry->Timestamp= DataValue;
+
+		if (m_tableList[TableID].MatchingEntry->WheelLink)
+			ScheduleEntryExpiration(TableID, m_tableList[TableID].MatchingEntry);
 		return nbSUCCESS;
 	}
 
 	if (DataID == m_tableList[TableID].LifetimeFieldID)
 	{
 		m_tableList[TableID].MatchingEntry->Lifetime= DataValue;
+
+		if (m_tableList[TableID].MatchingEntry->WheelLink)
+			ScheduleEntryExpiration(TableID, m_tableList[TableID].MatchingEntry);
 		return nbSUCCESS;
 	}
 
@@ -1176,6 +1189,8 @@ int RetVal;
 		m_tableList[TableID].MatchingEntry->Lifetime= 300;
 		m_tableList[TableID].MatchingEntry->Timestamp= TimestampSec;
 		m_tableList[TableID].MatchingEntry->ValidityType= nbNETPDL_UPDATELOOKUPTABLE_VALIDITY_KEEPMAXTIME;
+
+		ScheduleEntryExpiration(TableID, m_tableList[TableID].MatchingEntry);
 	
 #ifdef DEBUG_LOOKUPTABLE
 		PrintTableEntry(TableID, m_tableList[TableID].MatchingEntry, "Lookup table OBSOLETE");
@@ -1415,6 +1430,8 @@ struct _TableEntry *OldFirstTableEntry;
 	// In case the entry list was void, let's update also the 'LastEntry' member
 	if (OldFirstTableEntry == NULL)
 		m_tableList[TableID].LastMaskEntry= m_tableList[TableID].FirstMaskEntry;
+
+	SetMaskEntrySequence(TableID, m_tableList[TableID].FirstMaskEntry);
 }
 
 
@@ -1503,6 +1520,8 @@ struct _TableEntry *OldFirstTableEntry, *OldPreviousMatchingTableEntry, *OldNext
 	// In case the item that has been moved was the 'last member' of the list, let's update this value
 	if (MatchingEntry == m_tableList[TableID].LastMaskEntry)
 		m_tableList[TableID].LastMaskEntry= OldPreviousMatchingTableEntry;
+
+	SetMaskEntrySequence(TableID, MatchingEntry);
 }
 
 
@@ -1523,9 +1542,9 @@ struct _TableEntry *OldFirstVoidTableEntry;
 struct _TableEntry *OldPreviousMatchingTableEntry;
 struct _TableEntry *OldNextMatchingTableEntry;
 	
-	//We must also delete the corresponding entry in the MapExactEntry structure
-	HashKey key(((char*) MatchingEntry) + m_tableList[TableID].KeyList[0].KeyDataOffset, m_tableList[TableID].KeysEntrySize);
-	MapExact[TableID].erase(key);
+	// We must also delete the entry from the hash index and from the timer wheel
+	RemoveFromExactIndex(TableID, MatchingEntry);
+	UnscheduleEntryExpiration(TableID, MatchingEntry);
 
 	OldFirstVoidTableEntry= m_tableList[TableID].FirstVoidExactEntry;
 	OldPreviousMatchingTableEntry= MatchingEntry->PreviousEntry;
@@ -1570,7 +1589,11 @@ void CNetPDLLookupTables::PurgeExistingMaskEntry(int TableID, struct _TableEntry
 struct _TableEntry *OldFirstVoidTableEntry;
 struct _TableEntry *OldPreviousMatchingTableEntry;
 struct _TableEntry *OldNextMatchingTableEntry;
-	
+
+	// We must also delete the entry from the masked index and from the timer wheel
+	RemoveFromMaskIndex(TableID, MatchingEntry);
+	UnscheduleEntryExpiration(TableID, MatchingEntry);
+
 	OldFirstVoidTableEntry= m_tableList[TableID].FirstVoidMaskEntry;
 	OldPreviousMatchingTableEntry= MatchingEntry->PreviousEntry;
 	OldNextMatchingTableEntry= MatchingEntry->NextEntry;
@@ -1640,22 +1663,400 @@ int i;
 }
 
 
+/*!
+	\brief Rebuilds the hash index of the exact entries with the given number of slots.
+
+	\param TableID: ID of the table whose index has to be rebuilt.
+	\param NewSize: new number of slots; it must be a power of two, and bigger than the number of entries in the index.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLLookupTables::ResizeExactIndex(int TableID, int NewSize)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+struct _TableEntry **NewIndex;
+unsigned int *NewIndexHash;
+int i;
+
+	NewIndex= (struct _TableEntry **) calloc(NewSize, sizeof(struct _TableEntry *));
+	NewIndexHash= (unsigned int *) malloc(NewSize * sizeof(unsigned int));
+
+	if ((NewIndex == NULL) || (NewIndexHash == NULL))
+	{
+		free(NewIndex);
+		free(NewIndexHash);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Not enough memory for building internal structures.");
+		return nbFAILURE;
+	}
+
+	// Hashes are stored in the index, so we do not need to recompute them
+	for (i= 0; i < Table->ExactIndexSize; i++)
+	{
+	int Slot;
+
+		if (Table->ExactIndex[i] == NULL)
+			continue;
+
+		Slot= Table->ExactIndexHash[i] & (NewSize - 1);
+		while (NewIndex[Slot])
+			Slot= (Slot + 1) & (NewSize - 1);
+
+		NewIndex[Slot]= Table->ExactIndex[i];
+		NewIndexHash[Slot]= Table->ExactIndexHash[i];
+	}
+
+	free(Table->ExactIndex);
+	free(Table->ExactIndexHash);
+
+	Table->ExactIndex= NewIndex;
+	Table->ExactIndexHash= NewIndexHash;
+	Table->ExactIndexSize= NewSize;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Adds an exact entry (whose keys have already been set) to the hash index.
+
+	If the index already contains an entry with the same keys, the new entry replaces it in the index.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be indexed.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLLookupTables::AddToExactIndex(int TableID, struct _TableEntry *Entry)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+unsigned char *Key;
+unsigned int Hash;
+int Slot;
+
+	// Let's keep the load factor below 50%, so that probe sequences stay short
+	if ((Table->ExactIndexUsed + 1) * 2 > Table->ExactIndexSize)
+	{
+		if (ResizeExactIndex(TableID, Table->ExactIndexSize * 2) == nbFAILURE)
+			return nbFAILURE;
+	}
+
+	Key= ((unsigned char *) Entry) + Table->KeyList[0].KeyDataOffset;
+	Hash= HashExactKey(Key, Table->KeysEntrySize);
+
+	Slot= Hash & (Table->ExactIndexSize - 1);
+	while (Table->ExactIndex[Slot])
+	{
+		if ((Table->ExactIndexHash[Slot] == Hash) &&
+			(memcmp(((unsigned char *) Table->ExactIndex[Slot]) + Table->KeyList[0].KeyDataOffset, Key, Table->KeysEntrySize) == 0))
+		{
+			Table->ExactIndex[Slot]= Entry;
+			return nbSUCCESS;
+		}
+
+		Slot= (Slot + 1) & (Table->ExactIndexSize - 1);
+	}
+
+	Table->ExactIndex[Slot]= Entry;
+	Table->ExactIndexHash[Slot]= Hash;
+	Table->ExactIndexUsed++;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Looks for the exact entry that has the given keys.
+
+	\param TableID: ID of the table in which the entry has to be searched.
+	\param Key: buffer (whose size is KeysEntrySize) that contains the keys.
+
+	\return The matching entry, or NULL if none.
+*/
+struct CNetPDLLookupTables::_TableEntry *CNetPDLLookupTables::LookupExactIndex(int TableID, char *Key)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+unsigned int Hash;
+int Slot;
+
+	Hash= HashExactKey((unsigned char *) Key, Table->KeysEntrySize);
+
+	Slot= Hash & (Table->ExactIndexSize - 1);
+	while (Table->ExactIndex[Slot])
+	{
+		if ((Table->ExactIndexHash[Slot] == Hash) &&
+			(memcmp(((char *) Table->ExactIndex[Slot]) + Table->KeyList[0].KeyDataOffset, Key, Table->KeysEntrySize) == 0))
+			return Table->ExactIndex[Slot];
+
+		Slot= (Slot + 1) & (Table->ExactIndexSize - 1);
+	}
+
+	return NULL;
+}
+
+
+/*!
+	\brief Removes an exact entry from the hash index (if the entry is indexed).
+
+	Deletion uses backward shifting, so that the index never contains tombstones.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be removed from the index.
+*/
+void CNetPDLLookupTables::RemoveFromExactIndex(int TableID, struct _TableEntry *Entry)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+int IndexMask= Table->ExactIndexSize - 1;
+int Hole, Next;
+
+	Hole= HashExactKey(((unsigned char *) Entry) + Table->KeyList[0].KeyDataOffset, Table->KeysEntrySize) & IndexMask;
+	while (Table->ExactIndex[Hole] != Entry)
+	{
+		// The entry may have been replaced in the index by a newer entry with the same keys
+		if (Table->ExactIndex[Hole] == NULL)
+			return;
+
+		Hole= (Hole + 1) & IndexMask;
+	}
+
+	// Let's move back the entries that follow, as long as this does not move them before their home slot
+	Next= (Hole + 1) & IndexMask;
+	while (Table->ExactIndex[Next])
+	{
+	int Home;
+
+		Home= Table->ExactIndexHash[Next] & IndexMask;
+		if (((Next - Home) & IndexMask) >= ((Next - Hole) & IndexMask))
+		{
+			Table->ExactIndex[Hole]= Table->ExactIndex[Next];
+			Table->ExactIndexHash[Hole]= Table->ExactIndexHash[Next];
+			Hole= Next;
+		}
+
+		Next= (Next + 1) & IndexMask;
+	}
+
+	Table->ExactIndex[Hole]= NULL;
+	Table->ExactIndexUsed--;
+}
+
+
+/*!
+	\brief Adds a masked entry (whose keys and masks have already been set) to the group of entries with the same mask.
+
+	The group is created if this is the first entry with this mask.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be indexed.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLLookupTables::AddToMaskIndex(int TableID, struct _TableEntry *Entry)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+struct _MaskGroup *Group;
+unsigned char *Key, *Mask;
+int Bucket;
+
+	Key= ((unsigned char *) Entry) + Table->KeyList[0].KeyDataOffset;
+	Mask= ((unsigned char *) Entry) + Table->KeyList[0].MaskOffset;
+
+	for (Group= Table->FirstMaskGroup; Group; Group= Group->NextGroup)
+	{
+		if (memcmp(Group->Mask, Mask, Table->KeysEntrySize) == 0)
+			break;
+	}
+
+	if (Group == NULL)
+	{
+		Group= (struct _MaskGroup *) malloc(sizeof(struct _MaskGroup) + Table->KeysEntrySize);
+		if (Group == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Not enough memory for building internal structures.");
+			return nbFAILURE;
+		}
+
+		Group->Buckets= (struct _TableEntry **) calloc(LOOKUPTABLE_MASK_GROUP_BUCKETS, sizeof(struct _TableEntry *));
+		if (Group->Buckets == NULL)
+		{
+			free(Group);
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Not enough memory for building internal structures.");
+			return nbFAILURE;
+		}
+
+		Group->NumberOfBuckets= LOOKUPTABLE_MASK_GROUP_BUCKETS;
+		Group->NumberOfEntries= 0;
+		memcpy(Group->Mask, Mask, Table->KeysEntrySize);
+
+		Group->NextGroup= Table->FirstMaskGroup;
+		Table->FirstMaskGroup= Group;
+	}
+
+	// Let's double the number of buckets when chains become too long; if there is not enough memory, chains will simply be longer
+	if (Group->NumberOfEntries >= Group->NumberOfBuckets * 2)
+	{
+	struct _TableEntry **NewBuckets;
+
+		NewBuckets= (struct _TableEntry **) calloc(Group->NumberOfBuckets * 2, sizeof(struct _TableEntry *));
+		if (NewBuckets)
+		{
+			for (int i= 0; i < Group->NumberOfBuckets; i++)
+			{
+			struct _TableEntry *CurrentEntry, *NextEntry;
+
+				for (CurrentEntry= Group->Buckets[i]; CurrentEntry; CurrentEntry= NextEntry)
+				{
+					NextEntry= CurrentEntry->NextInBucket;
+
+					Bucket= HashMaskedKey(((unsigned char *) CurrentEntry) + Table->KeyList[0].KeyDataOffset, Group->Mask, Table->KeysEntrySize) & (Group->NumberOfBuckets * 2 - 1);
+					CurrentEntry->NextInBucket= NewBuckets[Bucket];
+					NewBuckets[Bucket]= CurrentEntry;
+				}
+			}
+
+			free(Group->Buckets);
+			Group->Buckets= NewBuckets;
+			Group->NumberOfBuckets= Group->NumberOfBuckets * 2;
+		}
+	}
+
+	Bucket= HashMaskedKey(Key, Group->Mask, Table->KeysEntrySize) & (Group->NumberOfBuckets - 1);
+	Entry->NextInBucket= Group->Buckets[Bucket];
+	Group->Buckets[Bucket]= Entry;
+	Entry->MaskGroup= Group;
+	Group->NumberOfEntries++;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Looks for the masked entry that matches the given keys (tuple space search).
+
+	Each group of entries sharing the same mask is probed once. Among all the matching entries, the
+	one closer to the top of the masked list (i.e. the one with the highest Sequence) is returned,
+	which is the same entry a linear scan of the list would return. Matching entries that turn out
+	to be too old are deleted.
+
+	\param TableID: ID of the table in which the entry has to be searched.
+	\param Key: buffer (whose size is KeysEntrySize) that contains the keys.
+	\param SequenceBound: only entries whose Sequence is lower than this value are taken into account
+	(this is used to get the matching entries that follow a previous match).
+	\param TimestampSec: current value of the timestamp.
+
+	\return The matching entry, or NULL if none.
+*/
+struct CNetPDLLookupTables::_TableEntry *CNetPDLLookupTables::LookupMaskIndex(int TableID, char *Key, unsigned int SequenceBound, int TimestampSec)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+struct _TableEntry *BestEntry= NULL;
+struct _MaskGroup *Group;
+
+	for (Group= Table->FirstMaskGroup; Group; Group= Group->NextGroup)
+	{
+	struct _TableEntry *CurrentEntry, *NextEntry;
+	int Bucket;
+
+		if (Group->NumberOfEntries == 0)
+			continue;
+
+		Bucket= HashMaskedKey((unsigned char *) Key, Group->Mask, Table->KeysEntrySize) & (Group->NumberOfBuckets - 1);
+
+		for (CurrentEntry= Group->Buckets[Bucket]; CurrentEntry; CurrentEntry= NextEntry)
+		{
+			// Let's save the next entry now, since the current one may be deleted
+			NextEntry= CurrentEntry->NextInBucket;
+
+			if (CurrentEntry->Sequence >= SequenceBound)
+				continue;
+
+			if ((BestEntry) && (CurrentEntry->Sequence < BestEntry->Sequence))
+				continue;
+
+			if (!MaskedKeyMatches((unsigned char *) Key, ((unsigned char *) CurrentEntry) + Table->KeyList[0].KeyDataOffset, Group->Mask, Table->KeysEntrySize))
+				continue;
+
+			if (CheckAndDeleteIfOldMaskEntry(TableID, CurrentEntry, TimestampSec) == nbSUCCESS)
+				// The current entry was too old and it has been deleted
+				continue;
+
+			BestEntry= CurrentEntry;
+		}
+	}
+
+	return BestEntry;
+}
+
+
+/*!
+	\brief Removes a masked entry from the group it belongs to.
+
+	Groups are not deleted when they become empty, since the same mask is likely to be used again
+	(e.g. by the next session of the same protocol); empty groups are skipped during lookups.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be removed from the index.
+*/
+void CNetPDLLookupTables::RemoveFromMaskIndex(int TableID, struct _TableEntry *Entry)
+{
+struct _TableInfo *Table= &m_tableList[TableID];
+struct _MaskGroup *Group= Entry->MaskGroup;
+struct _TableEntry **EntryPtr;
+int Bucket;
+
+	if (Group == NULL)
+		return;
+
+	Bucket= HashMaskedKey(((unsigned char *) Entry) + Table->KeyList[0].KeyDataOffset, Group->Mask, Table->KeysEntrySize) & (Group->NumberOfBuckets - 1);
+
+	for (EntryPtr= &(Group->Buckets[Bucket]); *EntryPtr; EntryPtr= &((*EntryPtr)->NextInBucket))
+	{
+		if (*EntryPtr == Entry)
+		{
+			*EntryPtr= Entry->NextInBucket;
+			Group->NumberOfEntries--;
+			break;
+		}
+	}
+
+	Entry->NextInBucket= NULL;
+	Entry->MaskGroup= NULL;
+}
+
+
+/*!
+	\brief Updates the Sequence of a masked entry that has just been moved on top of the masked list.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that is now on top of the list.
+*/
+void CNetPDLLookupTables::SetMaskEntrySequence(int TableID, struct _TableEntry *Entry)
+{
+	// In the (unlikely) case of wrap around, let's renumber all the entries according to their current position;
+	// the entry on top of the list (i.e. this one) gets the highest value.
+	if (m_tableList[TableID].LastMaskSequence == UINT_MAX - 1)
+	{
+	struct _TableEntry *CurrentEntry;
+
+		m_tableList[TableID].LastMaskSequence= 0;
+
+		for (CurrentEntry= m_tableList[TableID].LastMaskEntry; CurrentEntry; CurrentEntry= CurrentEntry->PreviousEntry)
+			CurrentEntry->Sequence= ++m_tableList[TableID].LastMaskSequence;
+
+		return;
+	}
+
+	Entry->Sequence= ++m_tableList[TableID].LastMaskSequence;
+}
+
+
 // Documented in base class
 void CNetPDLLookupTables::DoGarbageCollection(int TimestampSec, int AggressiveScan)
 {
-struct _TableEntry *CurrentEntry, *PreviousEntry;
 int TableID;
-//int Timestamp;
-//int Lifetime;
-int Result;
-
-	// This function is optimized in order not to consume too much time. This is the logic:
-	// - all the entries are scanned every 10 calls to this function
-	//   (variable Counter is used for that)
-	// - if we have the 'AggressiveScan' flag turned on, the scan ends when the first item that is still 'alive'
-	//   is encountered (entries are ordered in Last Accessed Came First order)
-	// - otherwise, all entries are scanned 
 
+	// Entries are kept in a timer wheel sorted by expiration time, hence only the entries whose lifetime
+	// has elapsed since the previous call are touched. The 'AggressiveScan' flag is no longer needed,
+	// since the wheel always purges everything that is expired.
 	for (TableID= 0; TableID < m_currNumTables; TableID++)
 	{
 		if (m_tableList[TableID].AllowDynamicEntries == 0)
@@ -1664,38 +2065,286 @@ int Result;
 		// Always clean the matching entry (if one)
 		m_tableList[TableID].MatchingEntry= NULL;
 
-		// Let's start a linear search in the 'exact' section
-		CurrentEntry= m_tableList[TableID].LastExactEntry;
+		AdvanceTimerWheel(TableID, TimestampSec);
+	}
+}
+
+
+/*!
+	\brief Returns the statistics related to the entries purged by the timer wheel of a table.
+
+	\param TableID: ID of the table. This value is returned back by the Create() method.
+	\param ExpiredLastTick: number of entries purged by the last tick (i.e. second) that has been processed.
+	\param MaxExpiredPerTick: maximum number of entries purged by a single tick.
+	\param TotalExpired: total number of entries purged by the timer wheel.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CNetPDLLookupTables::GetExpirationStats(int TableID, unsigned int *ExpiredLastTick, unsigned int *MaxExpiredPerTick, unsigned int *TotalExpired)
+{
+	if (TableID >= m_currNumTables)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Requested an invalid lookup table.");
+		return nbFAILURE;
+	}
+
+	*ExpiredLastTick= m_tableList[TableID].Wheel.ExpiredLastTick;
+	*MaxExpiredPerTick= m_tableList[TableID].Wheel.MaxExpiredPerTick;
+	*TotalExpired= m_tableList[TableID].Wheel.TotalExpired;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief (Re)schedules the expiration of an entry, according to its current timestamp, lifetime and validity.
+
+	This function must be called each time one of these members of the entry is modified.
 
-		while (CurrentEntry)
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be scheduled.
+*/
+void CNetPDLLookupTables::ScheduleEntryExpiration(int TableID, struct _TableEntry *Entry)
+{
+struct _TimerWheel *Wheel= &(m_tableList[TableID].Wheel);
+
+	UnscheduleEntryExpiration(TableID, Entry);
+
+	// The garbage collection never purges static tables and entries that must be kept forever
+	if ((m_tableList[TableID].AllowDynamicEntries == 0) || (Entry->ValidityType == nbNETPDL_UPDATELOOKUPTABLE_VALIDITY_KEEPFOREVER))
+		return;
+
+	// When the wheel is empty, there is nothing to process before the current timestamp, so we can
+	// move the wheel forward for free (otherwise the first tick would start from the UNIX epoch)
+	if ((Wheel->ScheduledEntries == 0) && (Entry->Timestamp > Wheel->NextTick))
+		Wheel->NextTick= Entry->Timestamp;
+
+	InsertInTimerWheel(TableID, Entry);
+}
+
+
+/*!
+	\brief Removes an entry from the timer wheel (if it has been scheduled).
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be removed.
+*/
+void CNetPDLLookupTables::UnscheduleEntryExpiration(int TableID, struct _TableEntry *Entry)
+{
+struct _TimerWheel *Wheel= &(m_tableList[TableID].Wheel);
+
+	if (Entry->WheelLink == NULL)
+		return;
+
+	*(Entry->WheelLink)= Entry->NextInWheel;
+	if (Entry->NextInWheel)
+		Entry->NextInWheel->WheelLink= Entry->WheelLink;
+
+	if (Entry->WheelLevel >= 0)
+		Wheel->NumberOfEntries[Entry->WheelLevel]--;
+
+	Wheel->ScheduledEntries--;
+
+	Entry->NextInWheel= NULL;
+	Entry->WheelLink= NULL;
+}
+
+
+/*!
+	\brief Inserts an entry in the slot of the timer wheel that corresponds to its expiration time.
+
+	Entries that expire within LOOKUPTABLE_WHEEL_SLOTS ticks are inserted in the first level; the other ones
+	are inserted in the level whose slots are large enough to reach the expiration time, and they will be moved
+	down when their slot becomes the current one.
+
+	\param TableID: ID of the table the entry belongs to.
+	\param Entry: entry that has to be inserted; it must not belong to the wheel.
+*/
+void CNetPDLLookupTables::InsertInTimerWheel(int TableID, struct _TableEntry *Entry)
+{
+struct _TimerWheel *Wheel= &(m_tableList[TableID].Wheel);
+struct _TableEntry **Slot;
+unsigned int Delta;
+int Expiration;
+int Level;
+
+	// The entry is old when (Timestamp + Lifetime) < TimestampSec, i.e. starting from the following second
+	Expiration= Entry->Timestamp + Entry->Lifetime + 1;
+
+	if (Expiration < Wheel->NextTick)
+	{
+		// The tick of this entry has already been processed, so let's purge it at the next call
+		Slot= &(Wheel->ExpiredEntries);
+		Level= -1;
+	}
+	else
+	{
+		Delta= (unsigned int) (Expiration - Wheel->NextTick);
+
+		for (Level= 0; Level < (LOOKUPTABLE_WHEEL_LEVELS - 1); Level++)
 		{
-			PreviousEntry= CurrentEntry->PreviousEntry;
+			if (Delta < (1U << ((Level + 1) * LOOKUPTABLE_WHEEL_SLOT_BITS)))
+				break;
+		}
 
-			Result= CheckAndDeleteIfOldExactEntry(TableID, CurrentEntry, TimestampSec);
+		// Entries that expire beyond the range of the wheel are parked in the farthest slot; they will be
+		// scheduled again when that slot is processed
+		if (Delta >= (1U << (LOOKUPTABLE_WHEEL_LEVELS * LOOKUPTABLE_WHEEL_SLOT_BITS)))
+			Expiration= Wheel->NextTick + (1 << (LOOKUPTABLE_WHEEL_LEVELS * LOOKUPTABLE_WHEEL_SLOT_BITS)) - 1;
+
+		Slot= &(Wheel->Slots[Level][(Expiration >> (Level * LOOKUPTABLE_WHEEL_SLOT_BITS)) & (LOOKUPTABLE_WHEEL_SLOTS - 1)]);
+		Wheel->NumberOfEntries[Level]++;
+	}
+
+	Entry->NextInWheel= *Slot;
+	if (*Slot)
+		(*Slot)->WheelLink= &(Entry->NextInWheel);
+
+	*Slot= Entry;
+	Entry->WheelLink= Slot;
+	Entry->WheelLevel= Level;
+
+	Wheel->ScheduledEntries++;
+}
+
+
+/*!
+	\brief Processes all the ticks of the timer wheel up to the given timestamp, purging the entries that are expired.
+
+	Ticks that have nothing to do (i.e. the lower levels of the wheel are empty) are skipped, so that the cost of
+	this function depends on the number of expired entries, and not on the size of the table or on the time elapsed.
+
+	\param TableID: ID of the table whose wheel has to be advanced.
+	\param TimestampSec: current value of the timestamp.
+*/
+void CNetPDLLookupTables::AdvanceTimerWheel(int TableID, int TimestampSec)
+{
+struct _TimerWheel *Wheel= &(m_tableList[TableID].Wheel);
+struct _TableEntry *CurrentEntry, *NextEntry;
+unsigned int Expired;
+int Granularity;
+int Level, Slot;
+int Tick;
+
+	if (Wheel->ExpiredEntries)
+		Wheel->TotalExpired+= PurgeTimerWheelList(TableID, &(Wheel->ExpiredEntries), TimestampSec);
 
-			if ((Result == nbWARNING) && (AggressiveScan))
-				// Let's jump to the masked scan loop
+	while (Wheel->NextTick <= TimestampSec)
+	{
+		// Let's look for the first level that has some entries; ticks that do not move entries
+		// from that level can be skipped, since nothing happens in the lower levels
+		for (Level= 0; Level < LOOKUPTABLE_WHEEL_LEVELS; Level++)
+		{
+			if (Wheel->NumberOfEntries[Level])
 				break;
-			
-			CurrentEntry= PreviousEntry;
 		}
 
-		// Let's start a linear search in the 'masked' section
-		CurrentEntry= m_tableList[TableID].LastMaskEntry;
+		if (Level == LOOKUPTABLE_WHEEL_LEVELS)
+		{
+			Wheel->NextTick= TimestampSec + 1;
+			return;
+		}
 
-		while (CurrentEntry)
+		if (Level > 0)
 		{
-			PreviousEntry= CurrentEntry->PreviousEntry;
+			Granularity= 1 << (Level * LOOKUPTABLE_WHEEL_SLOT_BITS);
+			Wheel->NextTick= (Wheel->NextTick + Granularity - 1) & ~(Granularity - 1);
 
-			Result= CheckAndDeleteIfOldMaskEntry(TableID, CurrentEntry, TimestampSec);
+			if (Wheel->NextTick > TimestampSec)
+			{
+				Wheel->NextTick= TimestampSec + 1;
+				return;
+			}
+		}
+
+		Tick= Wheel->NextTick;
 
-			if ((Result == nbWARNING) && (AggressiveScan))
-				// Let's jump over the masked scan loop
+		// Move down the entries of the upper levels whose slot starts with the current tick
+		for (Level= 1; Level < LOOKUPTABLE_WHEEL_LEVELS; Level++)
+		{
+			if (Tick & ((1 << (Level * LOOKUPTABLE_WHEEL_SLOT_BITS)) - 1))
 				break;
-				
-			CurrentEntry= PreviousEntry;
+
+			Slot= (Tick >> (Level * LOOKUPTABLE_WHEEL_SLOT_BITS)) & (LOOKUPTABLE_WHEEL_SLOTS - 1);
+
+			CurrentEntry= Wheel->Slots[Level][Slot];
+			while (CurrentEntry)
+			{
+				NextEntry= CurrentEntry->NextInWheel;
+				UnscheduleEntryExpiration(TableID, CurrentEntry);
+				InsertInTimerWheel(TableID, CurrentEntry);
+				CurrentEntry= NextEntry;
+			}
+		}
+
+		// Now, let's purge the entries that expire with the current tick
+		Slot= Tick & (LOOKUPTABLE_WHEEL_SLOTS - 1);
+		Expired= PurgeTimerWheelList(TableID, &(Wheel->Slots[0][Slot]), TimestampSec);
+
+		Wheel->ExpiredLastTick= Expired;
+		Wheel->TotalExpired+= Expired;
+
+		if (Expired)
+			Wheel->ExpiringTicks++;
+
+		if (Expired > Wheel->MaxExpiredPerTick)
+			Wheel->MaxExpiredPerTick= Expired;
+
+		Wheel->NextTick++;
+	}
+}
+
+
+/*!
+	\brief Purges the entries of a list of the timer wheel.
+
+	\param TableID: ID of the table the entries belong to.
+	\param List: pointer to the head of the list (i.e. a slot of the wheel); the list is empty on return.
+	\param TimestampSec: current value of the timestamp.
+
+	\return Number of entries that have been purged.
+*/
+unsigned int CNetPDLLookupTables::PurgeTimerWheelList(int TableID, struct _TableEntry **List, int TimestampSec)
+{
+struct _TableEntry *FirstEntry, *CurrentEntry;
+unsigned int Expired;
+int Result;
+
+	// Let's detach the list from the wheel, so that the entries that are still valid can be scheduled again
+	FirstEntry= *List;
+	*List= NULL;
+
+	if (FirstEntry)
+		FirstEntry->WheelLink= &FirstEntry;
+
+	Expired= 0;
+
+	while (FirstEntry)
+	{
+		CurrentEntry= FirstEntry;
+		UnscheduleEntryExpiration(TableID, CurrentEntry);
+
+		// Masked entries are the only ones that belong to a mask group
+		if (CurrentEntry->MaskGroup)
+			Result= CheckAndDeleteIfOldMaskEntry(TableID, CurrentEntry, TimestampSec);
+		else
+			Result= CheckAndDeleteIfOldExactEntry(TableID, CurrentEntry, TimestampSec);
+
+		if (Result == nbSUCCESS)
+		{
+			if (CurrentEntry == m_tableList[TableID].MatchingEntry)
+				m_tableList[TableID].MatchingEntry= NULL;
+
+			Expired++;
+		}
+		else
+		{
+			// This happens only if timestamps go backwards; the entry will be checked again later
+			InsertInTimerWheel(TableID, CurrentEntry);
 		}
 	}
+
+	return Expired;
 }
 
 
@@ -1956,6 +2605,9 @@ int i;
 	printf("Maximum number of masked entries used:\t%u\n", m_tableList[TableID].MaxNumberOfMaskEntries);
 	printf("Total number of new exact entries:\t%u\n", m_tableList[TableID].TotalNumberInsertionExact);
 	printf("Total number of new masked entries:\t%u\n", m_tableList[TableID].TotalNumberInsertionMask);
+	printf("Total number of expired entries:\t%u\n", m_tableList[TableID].Wheel.TotalExpired);
+	printf("Maximum number of entries expired in one second:\t%u\n", m_tableList[TableID].Wheel.MaxExpiredPerTick);
+	printf("Number of seconds that expired some entries:\t%u\n", m_tableList[TableID].Wheel.ExpiringTicks);
 	
 	printf("\n");
 	printf("Exact entries distribution\n");
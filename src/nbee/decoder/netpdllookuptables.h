@@ -17,7 +17,6 @@
 
 #include <nbee_packetdecoderutils.h>
 
-#include <map>
 #include <cstring>
 
 #ifdef WIN32
@@ -26,8 +25,16 @@
 
 //! Maximum number of lookup tables supported by this engine
 #define MAX_NUM_LOOKUP_TABLES 20
-//! Maximum lookups before we force a garbage collection
-#define MAX_CALL_BEFORE_GARBAGE 1000
+//! Number of levels of the timer wheel that expires the dynamic entries of each lookup table
+#define LOOKUPTABLE_WHEEL_LEVELS 4
+//! Number of bits of the timestamp that select a slot within each level of the timer wheel
+#define LOOKUPTABLE_WHEEL_SLOT_BITS 6
+//! Number of slots in each level of the timer wheel
+#define LOOKUPTABLE_WHEEL_SLOTS (1 << LOOKUPTABLE_WHEEL_SLOT_BITS)
+//! Minimum number of slots of the hash index of the exact entries (must be a power of two)
+#define LOOKUPTABLE_MIN_EXACT_INDEX_SIZE 64
+//! Initial number of buckets of each group of masked entries (must be a power of two)
+#define LOOKUPTABLE_MASK_GROUP_BUCKETS 16
 
 
  
@@ -39,30 +46,6 @@
 #define LOOKUPTABLE_PROFILER
 #endif
 
-/*!
-	\brief This class is used to populate the MapExact structure for O(n log n) lookup search
-	The first element must be the pointer to the Key filed in the _TableInfo structure
-	The second element must indicate the size of the first element
-*/
-class HashKey
-{
-public: 
-	char* Key;
-	size_t KeySize;
-	HashKey(char* _Key, size_t _KeySize): Key(_Key), KeySize(_KeySize){}
-    bool operator < (const HashKey & Key1) const
-    {
-	    return std::memcmp(Key, Key1.Key, KeySize < Key1.KeySize ? KeySize : Key1.KeySize) < 0;
-    }
-
-	bool operator== (const HashKey & Key1) const
-    {
-	    return std::memcmp(Key, Key1.Key, KeySize < Key1.KeySize ? KeySize : Key1.KeySize) == 0;
-    }
-
-
-};
-
 /*!
 	\brief This class is devoted to the management of the lookup tables (e.g. for storing TCP sessions).
 */
@@ -86,6 +69,8 @@ public:
 		nbNetPDLLookupTableKeyDataTypes_t KeyDataType;
 	};
 
+	struct _MaskGroup;
+
 	/*!
 		\brief Structure that contains all data related to a single entry in the lookup table.
 
@@ -123,11 +108,76 @@ public:
 		int HitTime;
 		//! Additional time of validity of the current entry (if refreshed): valid only for 'addonhit' entries
 		int NewHitTime;
+		//! Next entry in the same bucket of the masked entries index. Not used by exact entries.
+		struct _TableEntry *NextInBucket;
+		//! Group (i.e. set of entries sharing the same mask) this entry belongs to. Not used by exact entries.
+		struct _MaskGroup *MaskGroup;
+		//! Position of the entry in the masked list: entries closer to the top of the list have a bigger value.
+		//! It is used to return the same entry a linear scan of the list would return. Not used by exact entries.
+		unsigned int Sequence;
+		//! Next entry in the same slot of the timer wheel.
+		struct _TableEntry *NextInWheel;
+		//! Pointer to the pointer that references this entry in the timer wheel (NULL if the entry is not scheduled for expiration).
+		struct _TableEntry **WheelLink;
+		//! Level of the timer wheel that keeps this entry (valid only if WheelLink is not NULL); -1 if the entry was already expired when scheduled.
+		int WheelLevel;
 		//! Fake member; the space starting from here is used to store keys, data and mask (in this order).
 		//! By the way, this is never accessed through the code, but it's better to have it for debugging purposes
 		void* EntryValue;
 	};
 
+	/*!
+		\brief Structure that contains the masked entries that share the same mask (tuple space search).
+
+		Masked entries are grouped according to their mask; within each group, entries are hashed on
+		their masked keys, so that a lookup costs one hash probe per distinct mask instead of a scan
+		of the whole masked list.
+	*/
+	struct _MaskGroup
+	{
+		//! Pointer to the next group of the table.
+		struct _MaskGroup *NextGroup;
+		//! Array of buckets (each one is a list of entries linked through the NextInBucket member).
+		struct _TableEntry **Buckets;
+		//! Number of buckets (power of two).
+		int NumberOfBuckets;
+		//! Number of entries in this group.
+		int NumberOfEntries;
+		//! Fake member; the space starting from here keeps the mask (whose size is KeysEntrySize).
+		unsigned char Mask[1];
+	};
+
+	/*!
+		\brief Hierarchical timer wheel that keeps the dynamic entries of a table, sorted by expiration time.
+
+		Each tick corresponds to one second of the packet timestamp. The first level has a slot for each of the
+		next LOOKUPTABLE_WHEEL_SLOTS seconds; each slot of the upper levels covers LOOKUPTABLE_WHEEL_SLOTS times
+		the time covered by a slot of the previous level. Entries of the upper levels are moved down when their slot
+		becomes the current one, so that each tick purges only the entries whose lifetime has just elapsed.
+	*/
+	struct _TimerWheel
+	{
+		//! Lists of the entries scheduled in each slot of each level (linked through the NextInWheel member).
+		struct _TableEntry *Slots[LOOKUPTABLE_WHEEL_LEVELS][LOOKUPTABLE_WHEEL_SLOTS];
+		//! Number of entries scheduled in each level.
+		int NumberOfEntries[LOOKUPTABLE_WHEEL_LEVELS];
+		//! List of the entries that were already expired when they have been scheduled; they are purged by the next call to AdvanceTimerWheel().
+		struct _TableEntry *ExpiredEntries;
+		//! Total number of entries scheduled in the wheel.
+		int ScheduledEntries;
+		//! Next tick (i.e. timestamp, in seconds) that has to be processed.
+		int NextTick;
+
+		//! Number of entries expired by the last tick that has been processed.
+		unsigned int ExpiredLastTick;
+		//! Maximum number of entries expired by a single tick.
+		unsigned int MaxExpiredPerTick;
+		//! Total number of entries expired by the timer wheel.
+		unsigned int TotalExpired;
+		//! Number of ticks that expired at least one entry.
+		unsigned int ExpiringTicks;
+	};
+
 	//! Structure that contains the data related to a single lookup table.
 	struct _TableInfo
 	{
@@ -189,6 +239,23 @@ public:
 		//! Pointer to a buffer (whose size is KeysEntrySize) used to store (temporarily) the keys when we have to to a lookup.
 		void *KeyForCompare;
 
+		//! Open addressing hash index of the exact entries (with linear probing); empty slots are NULL.
+		struct _TableEntry **ExactIndex;
+		//! Hash of the key of the entry stored in each slot of ExactIndex.
+		unsigned int *ExactIndexHash;
+		//! Number of slots of ExactIndex (power of two).
+		int ExactIndexSize;
+		//! Number of used slots of ExactIndex.
+		int ExactIndexUsed;
+
+		//! List of the groups of masked entries (one for each distinct mask).
+		struct _MaskGroup *FirstMaskGroup;
+		//! Last value assigned to the Sequence member of a masked entry.
+		unsigned int LastMaskSequence;
+
+		//! Timer wheel used to expire the dynamic entries of the table.
+		struct _TimerWheel Wheel;
+
 		//! Structure that contains a pointer to the matching entry (after a lookup).
 		struct _TableEntry* MatchingEntry;
 		//! Flag that is 'true' if the matching entry is in the 'exact' entry list, or 'false' if it belongs to the 'masked' entry list.
@@ -266,6 +333,8 @@ public:
 	void DoGarbageCollection(int TimestampSec, int AggressiveScan);
 	char *GetLastError() { return m_errbuf; };
 
+	int GetExpirationStats(int TableID, unsigned int *ExpiredLastTick, unsigned int *MaxExpiredPerTick, unsigned int *TotalExpired);
+
 	int GetNumberOfEntries(int TableID);
 
 
@@ -282,6 +351,21 @@ private:
 	int CheckAndDeleteIfOldExactEntry(int TableID, struct _TableEntry *CurrentEntry, int TimestampSec);
 	int CheckAndDeleteIfOldMaskEntry(int TableID, struct _TableEntry *CurrentEntry, int TimestampSec);
 
+	int ResizeExactIndex(int TableID, int NewSize);
+	int AddToExactIndex(int TableID, struct _TableEntry *Entry);
+	struct _TableEntry *LookupExactIndex(int TableID, char *Key);
+	void RemoveFromExactIndex(int TableID, struct _TableEntry *Entry);
+	int AddToMaskIndex(int TableID, struct _TableEntry *Entry);
+	struct _TableEntry *LookupMaskIndex(int TableID, char *Key, unsigned int SequenceBound, int TimestampSec);
+	void RemoveFromMaskIndex(int TableID, struct _TableEntry *Entry);
+	void SetMaskEntrySequence(int TableID, struct _TableEntry *Entry);
+
+	void ScheduleEntryExpiration(int TableID, struct _TableEntry *Entry);
+	void UnscheduleEntryExpiration(int TableID, struct _TableEntry *Entry);
+	void InsertInTimerWheel(int TableID, struct _TableEntry *Entry);
+	void AdvanceTimerWheel(int TableID, int TimestampSec);
+	unsigned int PurgeTimerWheelList(int TableID, struct _TableEntry **List, int TimestampSec);
+
 #ifdef LOOKUPTABLE_PROFILER
 	void UpdateProfilerCounters(int TableID, int IsExact, int Value);
 	void PrintTableStats(int TableID);
@@ -292,8 +376,6 @@ private:
 	void PrintTableEntry(int TableID, struct _TableEntry *CurrentEntry, char* Message);
 #endif
 
-	int lookupExactCall;
-
 	//! List of tables (allocated statically at the beginning)
 	struct _TableInfo m_tableList[MAX_NUM_LOOKUP_TABLES];
 
@@ -304,13 +386,6 @@ private:
 	char *m_errbuf;
 	//! Size of the buffer that will keep the error message (if any); this buffer belongs to the class that creates this one.
 	int m_errbufSize;
-
-	/*! 
-		Array of binary tree map used to perfrom lookup over Exact entries
-		The key element must be a HashKey element.
-		The data element must be the pointer to the corresponding _TableEntry element
-	*/
-	std::map<HashKey, _TableEntry*> MapExact[MAX_NUM_LOOKUP_TABLES];
 };
 
 
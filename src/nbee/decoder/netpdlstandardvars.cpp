@@ -37,6 +37,7 @@ CNetPDLStandardVars::CNetPDLStandardVars(char* ErrBuf, int ErrBufSize)
 	m_errbufSize= ErrBufSize;
 
 	m_currNumVariables= 0;
+	m_currNumThisPacketVars= 0;
 
 	memset(&m_defaultVarList, 0, sizeof(m_defaultVarList));
 }
@@ -115,6 +116,13 @@ int CNetPDLStandardVars::CreateVariable(struct _nbNetPDLElementVariable* Variabl
 		memcpy(m_variableList[m_currNumVariables].ValueBuffer, m_variableList[m_currNumVariables].InitValueString, m_variableList[m_currNumVariables].InitValueStringSize);
 
 
+	// Keep trace of the variables that have to be reset for each packet
+	if (m_variableList[m_currNumVariables].Validity == nbNETPDL_VARIABLE_VALIDITY_THISPACKET)
+	{
+		m_thisPacketVarList[m_currNumThisPacketVars]= m_currNumVariables;
+		m_currNumThisPacketVars++;
+	}
+
 	// Increment the current number of variables
 	m_currNumVariables++;
 
@@ -256,32 +264,32 @@ int CNetPDLStandardVars::GetVariableBuffer(int VariableID, int StartAt, int Size
 // Documented in base class
 void CNetPDLStandardVars::DoGarbageCollection(int TimestampSec)
 {
-	for (int i= 0; i < m_currNumVariables; i++)
+	// Only the variables whose validity is 'this packet' have to be reset
+	for (int j= 0; j < m_currNumThisPacketVars; j++)
 	{
-		if (m_variableList[i].Validity == nbNETPDL_VARIABLE_VALIDITY_THISPACKET)
+	int i= m_thisPacketVarList[j];
+
+		switch (m_variableList[i].Type)
 		{
-			switch (m_variableList[i].Type)
+			case nbNETPDL_VARIABLE_TYPE_NUMBER:
+			case nbNETPDL_VARIABLE_TYPE_PROTOCOL:
+			{
+				m_variableList[i].ValueNumber= m_variableList[i].InitValueNumber;
+			}; break;
+
+			case nbNETPDL_VARIABLE_TYPE_BUFFER:
+			{
+				if (m_variableList[i].InitValueStringSize)
+					memcpy(m_variableList[i].ValueBuffer, m_variableList[i].InitValueString, m_variableList[i].InitValueStringSize);
+				else
+					memset(m_variableList[i].ValueBuffer, 0, m_variableList[i].SizeBuffer);
+			}; break;
+
+			case nbNETPDL_VARIABLE_TYPE_REFBUFFER:
 			{
-				case nbNETPDL_VARIABLE_TYPE_NUMBER:
-				case nbNETPDL_VARIABLE_TYPE_PROTOCOL:
-				{
-					m_variableList[i].ValueNumber= m_variableList[i].InitValueNumber;
-				}; break;
-
-				case nbNETPDL_VARIABLE_TYPE_BUFFER:
-				{
-					if (m_variableList[i].InitValueStringSize)
-						memcpy(m_variableList[i].ValueBuffer, m_variableList[i].InitValueString, m_variableList[i].InitValueStringSize);
-					else
-						memset(m_variableList[i].ValueBuffer, 0, m_variableList[i].SizeBuffer);
-				}; break;
-
-				case nbNETPDL_VARIABLE_TYPE_REFBUFFER:
-				{
-					m_variableList[i].ValueBuffer= NULL;
-					m_variableList[i].SizeBuffer= 0;
-				}; break;
-			}
+				m_variableList[i].ValueBuffer= NULL;
+				m_variableList[i].SizeBuffer= 0;
+			}; break;
 		}
 	}
 }
@@ -115,6 +115,12 @@ private:
 	//! Keeps the number of variables actually stored in m_variableList.
 	int m_currNumVariables;
 
+	//! IDs of the variables whose validity is 'this packet', i.e. the ones that have to be reset for each packet.
+	int m_thisPacketVarList[NETPDL_MAX_NVARS];
+
+	//! Keeps the number of variables actually stored in m_thisPacketVarList.
+	int m_currNumThisPacketVars;
+
 	//! Pointer to the buffer that will keep the error message (if any); this buffer belongs to the class that creates this one.
 	char* m_errbuf;
 
@@ -42,19 +42,9 @@ CNetPDLVariables::~CNetPDLVariables()
 */
 void CNetPDLVariables::DoGarbageCollection(int TimestampSec)
 {
-static int Counter;
-
 	CNetPDLStandardVars::DoGarbageCollection(TimestampSec);
 
-	// Do not do garbage collection for lookup tables each packet, in order to save precious resources
-	// So, the 'aggressive scan' is done every 10 packets, while the complete scan is done every 100 packets
-	if ((Counter % 10) == 0)
-	{
-		if ((Counter % 100) == 0)
-			CNetPDLLookupTables::DoGarbageCollection(TimestampSec, 0 /* Normal scan */);
-		else
-			CNetPDLLookupTables::DoGarbageCollection(TimestampSec, 1 /* Aggressive scan */);
-	}
-
-	Counter++;
+	// Lookup tables keep their entries in a timer wheel, so this is cheap unless some entries have just expired;
+	// hence, it can be done for each packet
+	CNetPDLLookupTables::DoGarbageCollection(TimestampSec, 0);
 }
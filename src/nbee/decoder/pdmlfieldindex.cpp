@@ -0,0 +1,409 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <nbee.h>
+
+#include "pdmlfieldindex.h"
+#include "../globals/globals.h"
+#include "../globals/debug.h"
+
+
+//! Hashes the name of a field (FNV-1a).
+static inline unsigned int HashFieldName(const char *FieldName)
+{
+unsigned int Hash= 2166136261U;
+
+	while (*FieldName)
+		Hash= (Hash ^ (unsigned char) *FieldName++) * 16777619U;
+
+	return Hash;
+}
+
+
+CPDMLFieldIndex::CPDMLFieldIndex()
+{
+	m_names= NULL;
+	m_namesSize= 0;
+	m_namesUsed= 0;
+
+	m_fieldsList= NULL;
+	m_maxNumFields= 0;
+	m_fieldName= NULL;
+	m_previousField= NULL;
+
+	m_generation= 0;
+}
+
+
+CPDMLFieldIndex::~CPDMLFieldIndex()
+{
+	if (m_names)
+	{
+		for (unsigned int i= 0; i < m_namesSize; i++)
+		{
+			if (m_names[i])
+			{
+				free(m_names[i]->Name);
+				free(m_names[i]);
+			}
+		}
+
+		free(m_names);
+	}
+
+	free(m_fieldName);
+	free(m_previousField);
+}
+
+
+/*!
+	\brief Initializes the index.
+
+	\param FieldsList: list of the fields managed by the CPDMLMaker; the ordinal number of each field
+	is its position in this list.
+
+	\param MaxNumFields: number of elements of the previous list.
+
+	\param ErrBuf: buffer that will keep the error message (if any).
+
+	\param ErrBufSize: size of the previous buffer.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CPDMLFieldIndex::Initialize(struct _nbPDMLField **FieldsList, unsigned long MaxNumFields, char *ErrBuf, int ErrBufSize)
+{
+	m_names= (struct _FieldName **) calloc(PDMLFIELDINDEX_MIN_NAMES, sizeof(struct _FieldName *));
+	if (m_names == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return nbFAILURE;
+	}
+
+	m_namesSize= PDMLFIELDINDEX_MIN_NAMES;
+	m_namesUsed= 0;
+
+	return UpdateFieldsList(FieldsList, MaxNumFields, ErrBuf, ErrBufSize);
+}
+
+
+/*!
+	\brief Updates the index when the list of the fields managed by the CPDMLMaker has been enlarged.
+
+	Fields already present in the list must keep their position.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CPDMLFieldIndex::UpdateFieldsList(struct _nbPDMLField **FieldsList, unsigned long MaxNumFields, char *ErrBuf, int ErrBufSize)
+{
+struct _FieldName **NewFieldName;
+long *NewPreviousField;
+
+	NewFieldName= (struct _FieldName **) realloc(m_fieldName, MaxNumFields * sizeof(struct _FieldName *));
+	if (NewFieldName == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return nbFAILURE;
+	}
+	m_fieldName= NewFieldName;
+
+	NewPreviousField= (long *) realloc(m_previousField, MaxNumFields * sizeof(long));
+	if (NewPreviousField == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return nbFAILURE;
+	}
+	m_previousField= NewPreviousField;
+
+	for (unsigned long i= m_maxNumFields; i < MaxNumFields; i++)
+	{
+		m_fieldName[i]= NULL;
+		m_previousField[i]= -1;
+	}
+
+	m_fieldsList= FieldsList;
+	m_maxNumFields= MaxNumFields;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Tells the index that a new packet is going to be decoded, hence all the fields of the previous one are forgotten.
+*/
+void CPDMLFieldIndex::PacketInitialize()
+{
+	m_generation++;
+}
+
+
+/*!
+	\brief Adds a field to the index; it must be called each time the name of the field is set.
+
+	\param PDMLField: the field, which must have been created by the CPDMLMaker (its ordinal number
+	must be valid).
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case of error.
+*/
+int CPDMLFieldIndex::AddField(struct _nbPDMLField *PDMLField, char *ErrBuf, int ErrBufSize)
+{
+struct _FieldName *Name;
+unsigned long Ordinal= PDMLField->Ordinal;
+unsigned int Hash;
+
+	// Fields which do not belong to the list we know (or without name) cannot be located through the index
+	if ((Ordinal >= m_maxNumFields) || (m_fieldsList[Ordinal] != PDMLField) || (PDMLField->Name == NULL))
+		return nbSUCCESS;
+
+	Hash= HashFieldName(PDMLField->Name);
+
+	Name= LookupName(PDMLField->Name, Hash);
+	if (Name == NULL)
+	{
+		Name= InsertName(PDMLField->Name, Hash, ErrBuf, ErrBufSize);
+		if (Name == NULL)
+			return nbFAILURE;
+	}
+
+	// The field may be updated more than once (e.g. after its subfields have been decoded)
+	if ((m_fieldName[Ordinal] == Name) && (Name->Generation == m_generation))
+		return nbSUCCESS;
+
+	RemoveField(Ordinal);
+
+	if (Name->Generation != m_generation)
+	{
+		Name->Generation= m_generation;
+		Name->LastField= -1;
+	}
+
+	// Instances are kept sorted from the most recent one; usually, this field is the most recent one
+	if (Name->LastField < (long) Ordinal)
+	{
+		m_previousField[Ordinal]= Name->LastField;
+		Name->LastField= Ordinal;
+	}
+	else
+	{
+	long Instance= Name->LastField;
+
+		while (m_previousField[Instance] > (long) Ordinal)
+			Instance= m_previousField[Instance];
+
+		m_previousField[Ordinal]= m_previousField[Instance];
+		m_previousField[Instance]= Ordinal;
+	}
+
+	m_fieldName[Ordinal]= Name;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Removes a field from the index; it must be called each time a field is (re)initialized.
+
+	\param Ordinal: ordinal number of the field.
+*/
+void CPDMLFieldIndex::RemoveField(unsigned long Ordinal)
+{
+struct _FieldName *Name;
+long Instance;
+
+	if (Ordinal >= m_maxNumFields)
+		return;
+
+	Name= m_fieldName[Ordinal];
+	m_fieldName[Ordinal]= NULL;
+
+	// The field may have been indexed while decoding a previous packet
+	if ((Name == NULL) || (Name->Generation != m_generation))
+		return;
+
+	if (Name->LastField == (long) Ordinal)
+	{
+		Name->LastField= m_previousField[Ordinal];
+		return;
+	}
+
+	for (Instance= Name->LastField; Instance >= 0; Instance= m_previousField[Instance])
+	{
+		if (m_previousField[Instance] == (long) Ordinal)
+		{
+			m_previousField[Instance]= m_previousField[Ordinal];
+			return;
+		}
+	}
+}
+
+
+/*!
+	\brief Returns the most recent field with the given name within a protocol of the current packet.
+
+	This corresponds to what CPDMLMaker::ScanForFieldRef() returns when it starts scanning from
+	the last field of the protocol.
+
+	\param PDMLProto: protocol the field belongs to.
+
+	\param FieldName: name of the field.
+
+	\param MaxOrdinal: fields with a larger ordinal are ignored, as if they had not been decoded yet.
+
+	\return The field, or NULL if it cannot be found.
+*/
+struct _nbPDMLField *CPDMLFieldIndex::FindLastField(struct _nbPDMLProto *PDMLProto, const char *FieldName, unsigned long MaxOrdinal)
+{
+struct _FieldName *Name;
+long Instance;
+
+	Name= LookupName(FieldName, HashFieldName(FieldName));
+
+	if ((Name == NULL) || (Name->Generation != m_generation))
+		return NULL;
+
+	for (Instance= Name->LastField; Instance >= 0; Instance= m_previousField[Instance])
+	{
+	struct _nbPDMLField *PDMLField= m_fieldsList[Instance];
+
+		if ((unsigned long) Instance > MaxOrdinal)
+			continue;
+
+		// Fields that have been discarded (and maybe reused) are still in the index
+		if ((PDMLField->ParentProto == PDMLProto) && (PDMLField->Name) &&
+			(strcmp(PDMLField->Name, FieldName) == 0) && IsLinked(PDMLField))
+			return PDMLField;
+	}
+
+	return NULL;
+}
+
+
+//! Returns 'true' if the field and all its parents are still linked in the PDML tree.
+bool CPDMLFieldIndex::IsLinked(struct _nbPDMLField *PDMLField)
+{
+	while (PDMLField)
+	{
+		if (PDMLField->PreviousField)
+		{
+			if (PDMLField->PreviousField->NextField != PDMLField)
+				return false;
+		}
+		else
+		{
+			if (PDMLField->ParentField)
+			{
+				if (PDMLField->ParentField->FirstChild != PDMLField)
+					return false;
+			}
+			else
+			{
+				if (PDMLField->ParentProto->FirstField != PDMLField)
+					return false;
+			}
+		}
+
+		PDMLField= PDMLField->ParentField;
+	}
+
+	return true;
+}
+
+
+struct CPDMLFieldIndex::_FieldName *CPDMLFieldIndex::LookupName(const char *FieldName, unsigned int Hash)
+{
+unsigned int Slot;
+
+	Slot= Hash & (m_namesSize - 1);
+	while (m_names[Slot])
+	{
+		if ((m_names[Slot]->Hash == Hash) && (strcmp(m_names[Slot]->Name, FieldName) == 0))
+			return m_names[Slot];
+
+		Slot= (Slot + 1) & (m_namesSize - 1);
+	}
+
+	return NULL;
+}
+
+
+struct CPDMLFieldIndex::_FieldName *CPDMLFieldIndex::InsertName(const char *FieldName, unsigned int Hash, char *ErrBuf, int ErrBufSize)
+{
+struct _FieldName *Name;
+unsigned int Slot;
+
+	// Keep the load factor of the table below 50%
+	if ((m_namesUsed + 1) * 2 > m_namesSize)
+	{
+		if (ResizeNames(ErrBuf, ErrBufSize) == nbFAILURE)
+			return NULL;
+	}
+
+	Name= (struct _FieldName *) malloc(sizeof(struct _FieldName));
+	if (Name == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return NULL;
+	}
+
+	Name->Name= strdup(FieldName);
+	if (Name->Name == NULL)
+	{
+		free(Name);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return NULL;
+	}
+
+	Name->Hash= Hash;
+	Name->Generation= 0;
+	Name->LastField= -1;
+
+	Slot= Hash & (m_namesSize - 1);
+	while (m_names[Slot])
+		Slot= (Slot + 1) & (m_namesSize - 1);
+
+	m_names[Slot]= Name;
+	m_namesUsed++;
+
+	return Name;
+}
+
+
+int CPDMLFieldIndex::ResizeNames(char *ErrBuf, int ErrBufSize)
+{
+struct _FieldName **NewNames;
+unsigned int NewSize= m_namesSize * 2;
+
+	NewNames= (struct _FieldName **) calloc(NewSize, sizeof(struct _FieldName *));
+	if (NewNames == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the index of the PDML fields.");
+		return nbFAILURE;
+	}
+
+	for (unsigned int i= 0; i < m_namesSize; i++)
+	{
+	unsigned int Slot;
+
+		if (m_names[i] == NULL)
+			continue;
+
+		Slot= m_names[i]->Hash & (NewSize - 1);
+		while (NewNames[Slot])
+			Slot= (Slot + 1) & (NewSize - 1);
+
+		NewNames[Slot]= m_names[i];
+	}
+
+	free(m_names);
+
+	m_names= NewNames;
+	m_namesSize= NewSize;
+
+	return nbSUCCESS;
+}
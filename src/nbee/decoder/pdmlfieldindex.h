@@ -0,0 +1,90 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/*!
+	\file pdmlfieldindex.h
+
+	This file defines the index used by the decoder to locate the fields of the current packet by name.
+*/
+
+
+#pragma once
+
+#include <nbee_pxmlreader.h>
+
+
+//! Initial number of slots of the hash table of the field names (must be a power of two)
+#define PDMLFIELDINDEX_MIN_NAMES 256
+
+
+
+/*!
+	\brief Index of the fields of the packet being decoded, organized by field name.
+
+	Each field name seen by the decoder gets an entry in a hash table; this entry keeps the most recent
+	field with that name in the current packet, and each field keeps the previous one with the same name.
+	This allows to locate a field reference (e.g. in expressions) with a hash lookup followed by a walk
+	on the instances of that field only, instead of scanning the whole PDML tree.
+
+	Fields are identified by their ordinal number within the packet (_nbPDMLField::Ordinal), i.e. their
+	position in the list of fields managed by the CPDMLMaker. Since fields are always appended to the PDML
+	tree, this is also the order in which they appear in the PDML fragment.
+
+	The index is not updated when fields are discarded; rather, each field that is returned is checked to
+	be still linked in the PDML tree with the requested name.
+*/
+class CPDMLFieldIndex
+{
+public:
+	CPDMLFieldIndex();
+	~CPDMLFieldIndex();
+
+	int Initialize(struct _nbPDMLField **FieldsList, unsigned long MaxNumFields, char *ErrBuf, int ErrBufSize);
+	int UpdateFieldsList(struct _nbPDMLField **FieldsList, unsigned long MaxNumFields, char *ErrBuf, int ErrBufSize);
+
+	void PacketInitialize();
+
+	int AddField(struct _nbPDMLField *PDMLField, char *ErrBuf, int ErrBufSize);
+	void RemoveField(unsigned long Ordinal);
+
+	struct _nbPDMLField *FindLastField(struct _nbPDMLProto *PDMLProto, const char *FieldName, unsigned long MaxOrdinal);
+
+private:
+	//! Entry of the hash table of the field names
+	struct _FieldName
+	{
+		char *Name;					//!< Name of the field
+		unsigned int Hash;			//!< Hash of the name
+		unsigned long Generation;	//!< Packet in which 'LastField' is valid
+		long LastField;				//!< Ordinal of the most recent field with this name, or -1 if none
+	};
+
+	struct _FieldName *LookupName(const char *FieldName, unsigned int Hash);
+	struct _FieldName *InsertName(const char *FieldName, unsigned int Hash, char *ErrBuf, int ErrBufSize);
+	int ResizeNames(char *ErrBuf, int ErrBufSize);
+	static bool IsLinked(struct _nbPDMLField *PDMLField);
+
+	//! Hash table of the field names (open addressing); NULL slots are empty
+	struct _FieldName **m_names;
+	//! Number of slots of the hash table (power of two)
+	unsigned int m_namesSize;
+	//! Number of names in the hash table
+	unsigned int m_namesUsed;
+
+	//! List of fields managed by the CPDMLMaker (indexed by ordinal)
+	struct _nbPDMLField **m_fieldsList;
+	//! Number of fields in m_fieldsList
+	unsigned long m_maxNumFields;
+	//! Name under which each field is indexed (NULL if it is not indexed)
+	struct _FieldName **m_fieldName;
+	//! Ordinal of the previous field with the same name (-1 if none)
+	long *m_previousField;
+
+	//! Incremented each time a new packet is decoded, so that the index does not need to be cleared
+	unsigned long m_generation;
+};
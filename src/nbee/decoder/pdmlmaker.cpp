@@ -17,6 +17,7 @@
 #include "showplugin/native_showfunctions.h"
 
 #include "../utils/netpdlutils.h"
+#include "../utils/hexdump.h"
 #include "../globals/utils.h"
 #include "../globals/debug.h"
 #include "../globals/globals.h"
@@ -70,10 +71,22 @@ CPDMLMaker::CPDMLMaker(CNetPDLExpression *ExprHandler, CPDMLReader *PDMLReader,
 	m_isVisExtRequired= NetPDLFlags & nbDECODER_GENERATEPDML_COMPLETE;
 	m_generateRawDump= NetPDLFlags & nbDECODER_GENERATEPDML_RAWDUMP;
 	m_keepAllPackets= NetPDLFlags & nbDECODER_KEEPALLPDML;
+	m_keepInMemory= NetPDLFlags & nbDECODER_KEEPALL_INMEMORY;
+	m_deferFieldFormat= NetPDLFlags & nbDECODER_DEFERFIELDFORMAT;
+	m_maxFieldOrdinal= ULONG_MAX;
+
+	m_packetRecord= NULL;
+	m_packetRecordSize= 0;
+
+	m_deferredFields= NULL;
+	m_maxNumDeferredFields= 0;
 
 	m_PDMLReader= PDMLReader;
 	m_exprHandler= ExprHandler;
 
+	// Field references in expressions can be located through the index of the fields kept by this class
+	m_exprHandler->SetPDMLMaker(this);
+
 	// Store internally the pointer to the error buffer. This buffer belongs to the class that creates this one.
 	m_errbuf= ErrBuf;
 	m_errbufSize= ErrBufSize;
@@ -98,7 +111,7 @@ unsigned int i;
 	// Initialize the parameters needed to dump everything to file (if needed)
 	if (m_keepAllPackets)
 	{
-		if (m_PDMLReader->InitializeParsForDump(PDML_CAPTURE, NULL) == nbFAILURE)
+		if (m_PDMLReader->InitializeParsForDump(PDML_CAPTURE, NULL, (m_keepInMemory != 0)) == nbFAILURE)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "%s", m_PDMLReader->GetLastError() );
 			return nbFAILURE;
@@ -154,6 +167,15 @@ unsigned int i;
 		}
 	}
 
+	if (m_fieldIndex.Initialize(m_fieldsList, m_maxNumFields, m_errbuf, m_errbufSize) == nbFAILURE)
+		return nbFAILURE;
+
+	if (m_deferFieldFormat)
+	{
+		if (UpdateDeferredFieldsList() == nbFAILURE)
+			return nbFAILURE;
+	}
+
 	return nbSUCCESS;
 }
 
@@ -177,6 +199,12 @@ unsigned int i;
 
 		delete[] m_fieldsList;
 	}
+
+	if (m_packetRecord)
+		delete[] m_packetRecord;
+
+	if (m_deferredFields)
+		delete[] m_deferredFields;
 }
 
 
@@ -196,6 +224,8 @@ void CPDMLMaker::PacketInitialize()
 	m_currNumFields= 0;
 	m_currNumProto= 0;
 	m_previousProto= NULL;
+
+	m_fieldIndex.PacketInitialize();
 }
 
 
@@ -324,6 +354,8 @@ int CPDMLMaker::HeaderElementUpdate(int HLen)
 	\brief This function must be called when the packet decoding is ended.
 
 	This method dumps the current element on file (if the user wants to keep all the elements).
+	If the elements are kept in memory, the element is stored as a binary record, and the PDML fragment
+	is generated only when it is requested.
 
 	\return nbSUCCESS if the function is successful, nbFAILURE if something goes wrong.
 	The error message is stored in the 'm_errbuf' internal variable.
@@ -331,7 +363,28 @@ int CPDMLMaker::HeaderElementUpdate(int HLen)
 int CPDMLMaker::PacketDecodingEnded()
 {
 	// Purge all the nodes that have previously been created
-	if (m_keepAllPackets)
+	// Stored packets must be complete, hence all the fields whose formatting has been deferred are formatted now
+	if ((m_keepAllPackets) && (m_deferFieldFormat))
+	{
+		if (FormatDeferredFields() == nbFAILURE)
+			return nbFAILURE;
+	}
+
+	if ((m_keepAllPackets) && (m_keepInMemory))
+	{
+	unsigned long RecordSize;
+
+		if (CPDMLReader::DumpPDMLRecord(&m_packetSummary, m_generateRawDump, &m_packetRecord, &m_packetRecordSize,
+			&RecordSize, m_errbuf, m_errbufSize) == nbFAILURE)
+			return nbFAILURE;
+
+		if (m_PDMLReader->StorePacket(m_packetRecord, RecordSize) == nbFAILURE)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "%s", m_PDMLReader->GetLastError() );
+			return nbFAILURE;
+		}
+	}
+	else if (m_keepAllPackets)
 	{
 		m_packetAsciiBuffer.ClearBuffer(true /* resizing permitted */);
 
@@ -432,6 +485,10 @@ _nbPDMLField *CPDMLMaker::PDMLElementInitialize(_nbPDMLField *PDMLParent)
 	// Initialize current element
 	memset(m_fieldsList[m_currNumFields], 0, sizeof (_nbPDMLField));
 
+	// The element may have been indexed with a different name, if it has been discarded and it is now reused
+	m_fieldsList[m_currNumFields]->Ordinal= m_currNumFields;
+	m_fieldIndex.RemoveField(m_currNumFields);
+
 	// Update links to the parent protocol and such
 	m_fieldsList[m_currNumFields]->ParentProto= m_protoList[m_currNumProto];
 
@@ -506,8 +563,18 @@ _nbPDMLField *CPDMLMaker::PDMLElementInitialize(_nbPDMLField *PDMLParent)
 	{
 		if (CPDMLReader::UpdateFieldsList(&m_maxNumFields, &m_fieldsList, m_errbuf, m_errbufSize) == nbFAILURE)
 			return NULL;
+
+		if (m_fieldIndex.UpdateFieldsList(m_fieldsList, m_maxNumFields, m_errbuf, m_errbufSize) == nbFAILURE)
+			return NULL;
+
+		if ((m_deferFieldFormat) && (UpdateDeferredFieldsList() == nbFAILURE))
+			return NULL;
 	}
 
+	// The slot may have been used by a field that has not been formatted, in the previous packet
+	if (m_deferFieldFormat)
+		m_deferredFields[m_currNumFields - 1].Pending= false;
+
 	return m_fieldsList[m_currNumFields - 1];
 }
 
@@ -583,8 +650,6 @@ void CPDMLMaker::PDMLElementDiscard(_nbPDMLField *PDMLElementToDelete)
 */
 int CPDMLMaker::PDMLElementUpdate(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Len, int Offset, const unsigned char *PacketFieldPtr)
 {
-char FieldValueString[NETPDL_MAX_PACKET * 6 + 1];	// We have to take into account that extended ascii are prented as &#xxx; ==> one bytes uses ascii 6 bytes
-char MaskedValueString[NETPDL_MAX_STRING * 2 + 1];
 int Size;
 int RetVal;
 
@@ -599,7 +664,13 @@ int RetVal;
 	PDMLElement->isField = true;
 
 	// Extracts common attribute
-	if (CPDMLReader::AppendItemString(NetPDLField->Name, &PDMLElement->Name, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
+	// When formatting is deferred, the strings of the NetPDL database are referenced instead of being copied
+	if (m_deferFieldFormat)
+		PDMLElement->Name= NetPDLField->Name;
+	else if (CPDMLReader::AppendItemString(NetPDLField->Name, &PDMLElement->Name, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
+		return nbFAILURE;
+
+	if (m_fieldIndex.AddField(PDMLElement, m_errbuf, m_errbufSize) == nbFAILURE)
 		return nbFAILURE;
 
 	// If we're the main block element, please return (we do not have to print any other attributes)
@@ -611,13 +682,19 @@ int RetVal;
 		// If the user does not want to create the visualization extension primitives, avoid the following code
 		if (m_isVisExtRequired)
 		{
-			if (CPDMLReader::AppendItemString(NetPDLField->LongName, &PDMLElement->LongName, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
+			if (m_deferFieldFormat)
+				PDMLElement->LongName= NetPDLField->LongName;
+			else if (CPDMLReader::AppendItemString(NetPDLField->LongName, &PDMLElement->LongName, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
 				return nbFAILURE;
 		}
 
 		return nbSUCCESS;
 	}
 
+	// The remaining attributes are generated by FormatDeferredField(), when (and if) they are needed
+	if (m_deferFieldFormat)
+		return PDMLElementDefer(PDMLElement, NetPDLField, Len, PacketFieldPtr);
+
 	if (NetPDLField->FieldType == nbNETPDL_ID_FIELD_BIT)
 	{
 	struct _nbNetPDLElementFieldBit *NetPDLBitField;
@@ -626,13 +703,70 @@ int RetVal;
 
 		if (CPDMLReader::AppendItemString(NetPDLBitField->BitMaskString, &PDMLElement->Mask, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
 			return nbFAILURE;
+	}
+
+	if (PDMLElementUpdateValue(PDMLElement, NetPDLField, Size, PacketFieldPtr) == nbFAILURE)
+		return nbFAILURE;
+
+	// If the visualization extensions are not required, we can return right now.
+	if (!m_isVisExtRequired)
+		return nbSUCCESS;
+
+	if (CPDMLReader::AppendItemString(NetPDLField->LongName, &PDMLElement->LongName, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
+		return nbFAILURE;
+
+	RetVal= PDMLElementUpdateShowExtension(PDMLElement, NetPDLField, Len, Size, Offset, PacketFieldPtr);
+
+	if (RetVal != nbSUCCESS)
+		return RetVal;
+
+#ifdef DEBUG_LOUD
+	// This piece of code prints every decoded field on screen as soon as it gets decoded
+	// This is extremely useful in case of debugging, when the library hungs. In this way,
+	// we can know which is the last field before the one that creates the problem.
+	CAsciiBuffer TempAsciiBuffer;
+
+	TempAsciiBuffer.Initialize();
+
+	DumpPDMLFields(PDMLElement, &TempAsciiBuffer, m_errbuf, m_errbufSize);
+	fprintf(stderr, "\t");
+	fprintf(stderr, TempAsciiBuffer.GetStartBufferPtr());
+#endif
+
+	return nbSUCCESS;
+}
+
+
+
+/*!
+	\brief Sets the 'value' attribute of a PDMLElement, i.e. the hex dump of the field.
+
+	\param PDMLElement: pointer to the PDML element that is being created.
+
+	\param NetPDLField: the original element in the NetPDL file that contains this description.
+
+	\param Size: amount of valid data of the field (it is shorter than the field length in case
+	the field is truncated).
 
+	\param PacketFieldPtr: a pointer to the packet buffer that contains the current data (in the pcap format).
+	This pointer refers to the beginning of the current field.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPDMLMaker::PDMLElementUpdateValue(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Size, const unsigned char *PacketFieldPtr)
+{
+char FieldValueString[NETPDL_MAX_PACKET * 6 + 1];	// We have to take into account that extended ascii are prented as &#xxx; ==> one bytes uses ascii 6 bytes
+char MaskedValueString[NETPDL_MAX_STRING * 2 + 1];
+
+	if (NetPDLField->FieldType == nbNETPDL_ID_FIELD_BIT)
+	{
 		// This code handles the case in which we have masked fields. For them, we have to insert the
 		// 'unmasked' value of the field, so that the PDML parsing is much simpler (we do not have
 		// to deal with the masked value, because we have, in clear, the exact value of the entire 
 		// field without masks)
 		nbNetPDLUtils::HexDumpBinToHexDumpAscii( (char *) PacketFieldPtr, Size, 
-					NetPDLBitField->IsInNetworkByteOrder, MaskedValueString, sizeof(MaskedValueString));
+					NetPDLField->IsInNetworkByteOrder, MaskedValueString, sizeof(MaskedValueString));
 
 		if (CPDMLReader::AppendItemString(MaskedValueString, &PDMLElement->Value, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
 			return nbFAILURE;
@@ -641,7 +775,6 @@ int RetVal;
 	{
 		// Copy the given field into 'HexValueAscii'. This is an hex number, since there are fields which cannot
 		// be translated into a decimal number (like IPv6 addresses)
-		// Note: variable 'ShowValueString' is recycled here
 		nbNetPDLUtils::HexDumpBinToHexDumpAscii( (char *) PacketFieldPtr, Size, 
 					NetPDLField->IsInNetworkByteOrder, FieldValueString, sizeof(FieldValueString));
 
@@ -649,30 +782,174 @@ int RetVal;
 			return nbFAILURE;
 	}
 
-	// If the visualization extensions are not required, we can return right now.
-	if (!m_isVisExtRequired)
+	return nbSUCCESS;
+}
+
+
+
+/*!
+	\brief Records what is needed to format a PDMLElement later on (see FormatDeferredField()).
+
+	This method is called by PDMLElementUpdate() when the nbDECODER_DEFERFIELDFORMAT flag is set.
+	The 'mask' and 'longname' attributes point directly to the strings of the NetPDL database,
+	while the other string attributes are left NULL.
+
+	\param PDMLElement: pointer to the PDML element that is being created; it must have been
+	returned by PDMLElementInitialize().
+
+	\param NetPDLField: the original element in the NetPDL file that contains this description.
+	It may be a temporary object, hence it is not referenced after this call.
+
+	\param Len: keeps the length (in bytes) of the decoded field.
+
+	\param PacketFieldPtr: a pointer to the packet buffer that contains the current data (in the pcap format).
+	This pointer refers to the beginning of the current field and it must be still valid when the field is formatted.
+
+	\return nbSUCCESS.
+*/
+int CPDMLMaker::PDMLElementDefer(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Len, const unsigned char *PacketFieldPtr)
+{
+struct _PDMLDeferredField *DeferredField;
+
+	DeferredField= &m_deferredFields[PDMLElement->Ordinal];
+
+	if (NetPDLField->FieldType == nbNETPDL_ID_FIELD_BIT)
+	{
+	struct _nbNetPDLElementFieldBit *NetPDLBitField;
+
+		NetPDLBitField= (struct _nbNetPDLElementFieldBit *) NetPDLField;
+
+		PDMLElement->Mask= NetPDLBitField->BitMaskString;
+		DeferredField->BitMask= NetPDLBitField->BitMask;
+	}
+	else
+		DeferredField->BitMask= 0;
+
+	if (m_isVisExtRequired)
+	{
+		PDMLElement->LongName= NetPDLField->LongName;
+		DeferredField->ShowTemplate= *(NetPDLField->ShowTemplateInfo);
+	}
+
+	DeferredField->Len= Len;
+	DeferredField->FieldPtr= PacketFieldPtr;
+	DeferredField->FieldType= NetPDLField->FieldType;
+	DeferredField->IsInNetworkByteOrder= NetPDLField->IsInNetworkByteOrder;
+	DeferredField->Pending= true;
+
+	return nbSUCCESS;
+}
+
+
+
+/*!
+	\brief Generates the string attributes of a PDMLElement whose formatting has been deferred.
+
+	The 'value' attribute and (if the visualization primitives are required) the 'showvalue',
+	'showmap' and 'showdtl' attributes are generated exactly as PDMLElementUpdate() does when
+	the nbDECODER_DEFERFIELDFORMAT flag is not set. In particular, the fields referenced while
+	formatting it are located among the ones that had been decoded up to PDMLElement, so that
+	later fields with the same name are ignored.
+
+	\param PDMLElement: pointer to the PDML element that has to be formatted. Elements that do not
+	belong to the current packet, or that have already been formatted, are left untouched.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPDMLMaker::FormatDeferredField(struct _nbPDMLField *PDMLElement)
+{
+struct _PDMLDeferredField *DeferredField;
+struct _nbNetPDLElementFieldBit NetPDLField;
+unsigned long PrevMaxFieldOrdinal;
+int RetVal;
+
+	if ((!m_deferFieldFormat) || (PDMLElement->Ordinal >= m_currNumFields) || (m_fieldsList[PDMLElement->Ordinal] != PDMLElement))
 		return nbSUCCESS;
 
-	if (CPDMLReader::AppendItemString(NetPDLField->LongName, &PDMLElement->LongName, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
-		return nbFAILURE;
+	DeferredField= &m_deferredFields[PDMLElement->Ordinal];
 
-	RetVal= PDMLElementUpdateShowExtension(PDMLElement, NetPDLField, Len, Size, Offset, PacketFieldPtr);
+	if (!DeferredField->Pending)
+		return nbSUCCESS;
 
-	if (RetVal != nbSUCCESS)
-		return RetVal;
+	DeferredField->Pending= false;
 
-#ifdef DEBUG_LOUD
-	// This piece of code prints every decoded field on screen as soon as it gets decoded
-	// This is extremely useful in case of debugging, when the library hungs. In this way,
-	// we can know which is the last field before the one that creates the problem.
-	CAsciiBuffer TempAsciiBuffer;
+	// Let's rebuild the portion of the NetPDL element that is used to format the field
+	memset(&NetPDLField, 0, sizeof(NetPDLField));
+	NetPDLField.Name= PDMLElement->Name;
+	NetPDLField.LongName= PDMLElement->LongName;
+	NetPDLField.FieldType= DeferredField->FieldType;
+	NetPDLField.IsInNetworkByteOrder= DeferredField->IsInNetworkByteOrder;
+	NetPDLField.ShowTemplateInfo= &DeferredField->ShowTemplate;
+	NetPDLField.BitMaskString= PDMLElement->Mask;
+	NetPDLField.BitMask= DeferredField->BitMask;
 
-	TempAsciiBuffer.Initialize();
+	// The fields decoded after PDMLElement did not exist when it would have been formatted
+	PrevMaxFieldOrdinal= m_maxFieldOrdinal;
+	m_maxFieldOrdinal= PDMLElement->Ordinal;
 
-	DumpPDMLFields(PDMLElement, &TempAsciiBuffer, m_errbuf, m_errbufSize);
-	fprintf(stderr, "\t");
-	fprintf(stderr, TempAsciiBuffer.GetStartBufferPtr());
-#endif
+	RetVal= PDMLElementUpdateValue(PDMLElement, (struct _nbNetPDLElementFieldBase *) &NetPDLField, PDMLElement->Size, DeferredField->FieldPtr);
+
+	if ((RetVal != nbFAILURE) && (m_isVisExtRequired))
+		RetVal= PDMLElementUpdateShowExtension(PDMLElement, (struct _nbNetPDLElementFieldBase *) &NetPDLField, DeferredField->Len,
+			PDMLElement->Size, PDMLElement->Position, DeferredField->FieldPtr);
+
+	m_maxFieldOrdinal= PrevMaxFieldOrdinal;
+
+	return RetVal;
+}
+
+
+/*!
+	\brief Generates the string attributes of all the fields of the current packet whose formatting has been deferred.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPDMLMaker::FormatDeferredFields()
+{
+unsigned long i;
+
+	if (!m_deferFieldFormat)
+		return nbSUCCESS;
+
+	for (i= 0; i < m_currNumFields; i++)
+	{
+		if ((m_deferredFields[i].Pending) && (FormatDeferredField(m_fieldsList[i]) == nbFAILURE))
+			return nbFAILURE;
+	}
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Resizes the array that keeps the data of the deferred fields, so that it has the same size of the fields list.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE in case or error.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPDMLMaker::UpdateDeferredFieldsList()
+{
+struct _PDMLDeferredField *NewDeferredFields;
+
+	NewDeferredFields= new struct _PDMLDeferredField [m_maxNumFields];
+	if (NewDeferredFields == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "Not enough memory to allocate the deferred fields list.");
+		return nbFAILURE;
+	}
+
+	memset(NewDeferredFields, 0, m_maxNumFields * sizeof(struct _PDMLDeferredField));
+
+	if (m_deferredFields)
+	{
+		memcpy(NewDeferredFields, m_deferredFields, m_maxNumDeferredFields * sizeof(struct _PDMLDeferredField));
+		delete[] m_deferredFields;
+	}
+
+	m_deferredFields= NewDeferredFields;
+	m_maxNumDeferredFields= m_maxNumFields;
 
 	return nbSUCCESS;
 }
@@ -1094,6 +1371,9 @@ int Size;
 	if (CPDMLReader::AppendItemString(NetPDLBlock->Name, &PDMLElement->Name, &m_tempFieldData, m_errbuf, m_errbufSize) == nbFAILURE)
 		return nbFAILURE;
 
+	if (m_fieldIndex.AddField(PDMLElement, m_errbuf, m_errbufSize) == nbFAILURE)
+		return nbFAILURE;
+
 	// If the user does not want to create the visualization extension primitives, avoid the following code
 	if (m_isVisExtRequired)
 	{
@@ -1209,7 +1489,6 @@ unsigned long UnmaskedValue;
 unsigned long SingleBit;
 unsigned long Result;
 int i;
-char FormatSpecifier[NETPDL_MAX_STRING];
 
 	if (DataLen > 4)
 	{
@@ -1247,11 +1526,8 @@ char FormatSpecifier[NETPDL_MAX_STRING];
 	}
 	BinResult[i]= 0;
 
-	// obtain the "%0[numberofdigit]x" string
-	ssnprintf(FormatSpecifier, sizeof(FormatSpecifier), "%%0%dX", DataLen * 2);
-
-	// Print the number in hexadecimal format
-	ssnprintf(HexResult, HexResultStringSize, FormatSpecifier, Result);
+	// Print the number in hexadecimal format, using two digits for each byte of the field
+	HexDumpFormatNumber(Result, DataLen * 2, HexResult);
 
 	return nbSUCCESS;
 }
@@ -1299,8 +1575,10 @@ char *ReturnString;
 
 				DtlItemInfo= (struct _nbNetPDLElementProtoField *) NetPDLDtlItem;
 
-				RetVal= CPDMLMaker::ScanForFieldRefAttrib(PDMLElement, NULL, PDMLElement->Name, DtlItemInfo->FieldShowDataType, 
-														&Attrib, m_errbuf, m_errbufSize);
+				// When formatting is deferred, the packet has already been decoded and a field with the same name may follow
+				// this one; hence, the field itself is selected
+				RetVal= CPDMLMaker::ScanForFieldRefAttrib(PDMLElement, NULL, m_deferFieldFormat ? NULL : PDMLElement->Name,
+														DtlItemInfo->FieldShowDataType, &Attrib, m_errbuf, m_errbufSize);
 
 				if (RetVal != nbSUCCESS)
 				{
@@ -1712,6 +1990,9 @@ int RetVal;
 
 	\param ErrBufSize: length of ErrBuf buffer.
 
+	\param MaxOrdinal: fields of the current packet with a larger ordinal are skipped, as if they had
+	not been decoded yet (see FormatDeferredField()).
+
 	\return nbSUCCESS if everything is fine, nbFAILURE in case or error.
 	In case of error, the error message can be retrieved by the GetLastError() method.
 	The value of the requested attribute is returned into the AttribValue parameter.<br>
@@ -1721,7 +2002,8 @@ int RetVal;
 
 	\note This function has been declared as 'static' because it is called also from other contexts.
 */
-int CPDMLMaker::ScanForFieldRef(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize)
+int CPDMLMaker::ScanForFieldRef(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize,
+								unsigned long MaxOrdinal)
 {
 // struct _nbPDMLField *Result;
 struct _nbPDMLField *PDMLLastField;
@@ -1775,7 +2057,8 @@ struct _nbPDMLField *PDMLLastField;
 		// Check if this field is the one we are looking for
 		// In case the field has not been completely decoded, PDMLLastField->Name can
 		// point to a NULL address; so we have to prevent this case
-		if ( (PDMLLastField->Name) && (strcmp(PDMLLastField->Name, FieldName) == 0) )
+		// Fields are appended to the tree, so the ones decoded later are met first in this backward scan
+		if ( (PDMLLastField->Name) && (PDMLLastField->Ordinal <= MaxOrdinal) && (strcmp(PDMLLastField->Name, FieldName) == 0) )
 		{
 			*PDMLLocatedField= PDMLLastField;
 			return nbSUCCESS;
@@ -1799,6 +2082,154 @@ struct _nbPDMLField *PDMLLastField;
 }
 
 
+/*!
+	\brief This function locates a field within the given PDML fragment, as ScanForFieldRefValue() does.
+
+	The difference is that this function is able to use the index of the fields of the packet
+	that is currently being decoded, instead of scanning the PDML fragment.
+
+	Parameters and return values are the same of ScanForFieldRefValue().
+*/
+int CPDMLMaker::FindFieldRefValue(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, unsigned int *FieldOffset,
+								  unsigned int *FieldSize, char **FieldMask, char *ErrBuf, int ErrBufSize)
+{
+struct _nbPDMLField *Result;
+int RetVal;
+
+	RetVal= FindFieldRef(PDMLField, ProtoName, FieldName, &Result, ErrBuf, ErrBufSize);
+
+	if (RetVal != nbSUCCESS)
+	{
+		*FieldOffset= 0;
+		*FieldSize= 0;
+		*FieldMask= NULL;
+		return RetVal;
+	}
+
+	*FieldOffset= Result->Position;
+	*FieldSize= Result->Size;
+	*FieldMask= Result->Mask;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief This function locates a field within the given PDML fragment, as ScanForFieldRef() does.
+
+	The difference is that this function is able to use the index of the fields of the packet
+	that is currently being decoded, instead of scanning the PDML fragment.
+	This is possible when the scan would start from the last field of the protocol, i.e. when
+	the field we are looking for belongs to another protocol, or when 'PDMLField' is part
+	of the most recent portion of the protocol (which happens while the protocol is being decoded).
+	Otherwise, this function falls back to ScanForFieldRef().
+	While a deferred field is being formatted, the fields decoded after it are ignored (see FormatDeferredField()).
+
+	Parameters and return values are the same of ScanForFieldRef().
+*/
+int CPDMLMaker::FindFieldRef(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize)
+{
+struct _nbPDMLProto *PDMLProto;
+
+	// The index can be used only with the fields of the packet we are decoding
+	if ((FieldName == NULL) || (PDMLField->ParentProto == NULL) || (PDMLField->ParentProto->PacketSummary != &m_packetSummary))
+		return ScanForFieldRef(PDMLField, ProtoName, FieldName, PDMLLocatedField, ErrBuf, ErrBufSize);
+
+	if ( (ProtoName != NULL) && (*ProtoName != 0) )
+	{
+		// We have to locate the correct protocol; the scan will start from its last field
+		PDMLProto= PDMLField->ParentProto;
+
+		while (PDMLProto)
+		{
+			if (strcmp(PDMLProto->Name, ProtoName) == 0)
+				break;
+
+			PDMLProto= PDMLProto->PreviousProto;
+		}
+
+		if (PDMLProto == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "We are not able to locate the requested protocol within the PDML fragment.");
+			*PDMLLocatedField= NULL;
+			return nbFAILURE;
+		}
+	}
+	else
+	{
+	struct _nbPDMLField *PDMLParentField;
+
+		// The scan starts from the last field at the level of PDMLField; this is the last field of the
+		// protocol only if none of the parents of PDMLField is followed by other fields (among the visible ones)
+		for (PDMLParentField= PDMLField->ParentField; PDMLParentField != NULL; PDMLParentField= PDMLParentField->ParentField)
+		{
+			if ((PDMLParentField->NextField) && (PDMLParentField->NextField->Ordinal <= m_maxFieldOrdinal))
+				return ScanForFieldRef(PDMLField, ProtoName, FieldName, PDMLLocatedField, ErrBuf, ErrBufSize, m_maxFieldOrdinal);
+		}
+
+		PDMLProto= PDMLField->ParentProto;
+	}
+
+	*PDMLLocatedField= m_fieldIndex.FindLastField(PDMLProto, FieldName, m_maxFieldOrdinal);
+
+	if (*PDMLLocatedField == NULL)
+		return nbWARNING;
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief This function returns an attribute of a field within the given PDML fragment, as ScanForFieldRefAttrib() does.
+
+	The difference is that this function formats the located field, if it belongs to the current
+	packet and its formatting has been deferred.
+
+	Parameters and return values are the same of ScanForFieldRefAttrib().
+*/
+int CPDMLMaker::FindFieldRefAttrib(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, int AttribCode,
+								  char **AttribValue, char *ErrBuf, int ErrBufSize)
+{
+struct _nbPDMLField *Result;
+char *Attribute;
+int RetVal;
+
+	RetVal= ScanForFieldRef(PDMLField, ProtoName, FieldName, &Result, ErrBuf, ErrBufSize);
+
+	if (RetVal != nbSUCCESS)
+	{
+		*AttribValue= NULL;
+		return RetVal;
+	}
+
+	if (FormatDeferredField(Result) == nbFAILURE)
+	{
+		if (ErrBuf != m_errbuf)
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "%s", m_errbuf);
+
+		*AttribValue= NULL;
+		return nbFAILURE;
+	}
+
+	Attribute= GetPDMLFieldAttribute(AttribCode, Result);
+
+	if ( (Attribute != NULL) && (*Attribute != 0) )
+	{
+		*AttribValue= Attribute;
+		return nbSUCCESS;
+	}
+	else
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, 
+			"The NetPDL protocol database contains a reference to an attribute that cannot be located in the PDML fragment: Protocol '%s', Field '%s'",
+			(ProtoName == NULL) ? PDMLField->ParentProto->LongName : ProtoName, FieldName);
+
+		*AttribValue= NULL;
+		return nbFAILURE;
+	}
+}
+
+
 
 /*!
 	\brief Scan the field list (starting from a given point) to locate the last item
@@ -9,11 +9,13 @@
 #pragma once
 
 #include <pcap.h>
+#include <limits.h>
 
 #include "netpdlvariables.h"
 #include "netpdlexpression.h"
 #include "showplugin/show_plugin.h"
 #include "pdmlreader.h"
+#include "pdmlfieldindex.h"
 #include "../utils/asciibuffer.h"
 
 
@@ -21,6 +23,26 @@
 #define PDML_MAX_TEMP_ELEMENTS 100
 
 
+//! Data needed to format a PDML field whose formatting has been deferred (see nbDECODER_DEFERFIELDFORMAT).
+struct _PDMLDeferredField
+{
+	//! 'true' if the string attributes of the field have not been generated yet.
+	int Pending;
+	//! Length of the field according to the NetPDL description (it can be larger than the captured data).
+	int Len;
+	//! Pointer to the beginning of the field in the packet buffer.
+	const unsigned char *FieldPtr;
+	//! Type of the NetPDL field (i.e. the 'FieldType' member of the NetPDL element).
+	nbNetPDLFieldNodeTypes_t FieldType;
+	//! 'true' if the field appears in network byte order in the packet dump.
+	int IsInNetworkByteOrder;
+	//! Mask of the field, if it is a bit field.
+	unsigned long BitMask;
+	//! Copy of the visualization template of the field; the NetPDL element may be a temporary object of the decoder.
+	struct _nbNetPDLElementShowTemplate ShowTemplate;
+};
+
+
 
 /*!
 	\brief It provides the interface to create a PDML file.
@@ -50,6 +72,8 @@ public:
 	// PDMLElement functions
 	int PDMLElementUpdate(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Len, int Offset, const unsigned char *PacketFieldPtr);
 	int PDMLElementUpdateShowExtension(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Len, int Size, int Offset, const unsigned char *PacketFieldPtr);
+	int FormatDeferredField(struct _nbPDMLField *PDMLElement);
+	int FormatDeferredFields();
 	int PDMLBlockElementUpdate(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementBlock *NetPDLBlock, int Len, int Offset);
 	struct _nbPDMLField *PDMLElementInitialize(struct _nbPDMLField *PDMLParent);
 	void PDMLElementDiscard(struct _nbPDMLField *PDMLElementToDelete);
@@ -72,8 +96,20 @@ public:
 		unsigned int *FieldOffset, unsigned int *FieldSize, char **FieldMask, char *ErrBuf, int ErrBufSize);
 
 	static int ScanForFieldRef(struct _nbPDMLField *PDMLField, char *ProtoName, 
+		char *FieldName, struct _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize,
+		unsigned long MaxOrdinal= ULONG_MAX);
+
+	// Same as the ones above, but they use the field index when the PDML fragment belongs to the current packet
+	int FindFieldRefValue(struct _nbPDMLField *PDMLField, char *ProtoName, char *FieldName, 
+		unsigned int *FieldOffset, unsigned int *FieldSize, char **FieldMask, char *ErrBuf, int ErrBufSize);
+
+	int FindFieldRef(struct _nbPDMLField *PDMLField, char *ProtoName, 
 		char *FieldName, struct _nbPDMLField **PDMLLocatedField, char *ErrBuf, int ErrBufSize);
 
+	// Same as ScanForFieldRefAttrib(), but it formats the located field if its formatting has been deferred
+	int FindFieldRefAttrib(struct _nbPDMLField *PMDLField, char *ProtoName, 
+		char *FieldName, int AttribCode, char **AttribValue, char *ErrBuf, int ErrBufSize);
+
 	// The error message is not needed here, because it is manages by the calling function
 	static char *GetPDMLFieldAttribute(int AttribCode, _nbPDMLField *PDMLField);
 	static char *GetPDMLProtoAttribute(int AttribCode, _nbPDMLProto *PDMLProto);
@@ -86,6 +122,11 @@ public:
 
 private:
 
+	// Deferred formatting
+	int PDMLElementUpdateValue(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Size, const unsigned char *PacketFieldPtr);
+	int PDMLElementDefer(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementFieldBase *NetPDLField, int Len, const unsigned char *PacketFieldPtr);
+	int UpdateDeferredFieldsList();
+
 	// Printing functions
 	int PrintFieldDetails(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementBase *ShowDetailsElement, char **ResultString);
 	int PrintMapTable(struct _nbPDMLField *PDMLElement, struct _nbNetPDLElementSwitch *MappingTableInfo);
@@ -130,6 +171,14 @@ private:
 	//! Keeps how many elements we have currently in the field structures
 	unsigned long m_currNumFields;
 
+	//! Index of the fields of the current packet, used to locate field references without scanning the PDML tree
+	CPDMLFieldIndex m_fieldIndex;
+
+	//! Data needed to format the fields whose formatting has been deferred (indexed by the 'Ordinal' of the field)
+	struct _PDMLDeferredField *m_deferredFields;
+	//! Current size of the array that keeps the data of the deferred fields
+	unsigned long m_maxNumDeferredFields;
+
 	//! Protocol and fields must be formatted through several char string; this variable is useful to avoid
 	//! to allocate a char * for each variable; we have a "shared memory pool" (this buffer), and who needs
 	//! it, can get space.
@@ -138,6 +187,12 @@ private:
 	//! Buffer that will contain the ascii dump of the packet; needed only if we want to store packets on file
 	CAsciiBuffer m_packetAsciiBuffer;
 
+	//! Buffer that will contain the binary record of the packet; needed only if we want to keep packets in memory
+	char *m_packetRecord;
+
+	//! Size of the buffer that will contain the binary record of the packet
+	unsigned long m_packetRecordSize;
+
 	//! Pointer to the same expression handler we have into the NetPDL decoder
 	CNetPDLExpression *m_exprHandler;
 
@@ -150,6 +205,16 @@ private:
 	//! Value that indicates if the user wants to keep all the packets stored or just the last one.
 	int m_keepAllPackets;
 
+	//! Value that indicates if the packets have to be kept in the in-memory spool (as binary records) instead of a temp file.
+	int m_keepInMemory;
+
+	//! Value that indicates if the string attributes of the fields have to be generated only when they are needed.
+	int m_deferFieldFormat;
+
+	//! Largest ordinal of the fields that can be located by FindFieldRef(); while a deferred field is formatted,
+	//! this hides the fields that have been decoded after it (ULONG_MAX otherwise).
+	unsigned long m_maxFieldOrdinal;
+
 	//! Pointer to a PDMLReader; needed to manage PDML files (storing data and such)
 	CPDMLReader *m_PDMLReader;
 
@@ -26,6 +26,13 @@
 extern struct _nbNetPDLDatabase *NetPDLDatabase;
 
 
+//! Number of bytes needed to store a string (if present) in a PDML binary record
+#define PDML_RECORD_STRING_SIZE(String) ((String) ? strlen(String) + 1 : 0)
+
+//! Returns the string stored at the given offset of a PDML binary record (offsets start from '1', '0' means NULL)
+#define PDML_RECORD_STRING(Strings, Offset) ((Offset) ? &(Strings)[(Offset) - 1] : NULL)
+
+
 //! Default constructor.
 CPDMLReader::CPDMLReader()
 {
@@ -248,6 +255,10 @@ int CPDMLReader::GetCurrentPacketXML(char* &PacketPtr, unsigned int &PacketLengt
 	{
 		m_asciiBuffer.ClearBuffer(true /* resizing permitted */);
 
+		// The fragment must be complete, even if the formatting of the fields has been deferred
+		if ( ((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->FormatDeferredFields() == nbFAILURE)
+			return nbFAILURE;
+
 		// If our source is the Decoding Engine, we can access to some internal structures of the PDMLMaker
 		if (CPDMLMaker::DumpPDMLPacket( &( ((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->m_packetSummary),
 			((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->m_isVisExtRequired,
@@ -282,6 +293,24 @@ int RetVal;
 	// Let's initialize it to NULL, just in case
 	*PDMLPacket= NULL;
 
+	// If packets are kept in the in-memory spool, the binary record is converted without any XML parsing
+	if (m_spoolBuffer)
+	{
+	char *Record;
+	unsigned long RecordSize;
+
+		RetVal= GetPacketRecord(PacketNumber, Record, RecordSize);
+		if ((RetVal == nbWARNING) || (RetVal == nbFAILURE))
+			return RetVal;
+
+		NumProtos= FormatPacketRecord(Record, RecordSize);
+
+		if (NumProtos != nbFAILURE)
+			*PDMLPacket= &m_packetSummary;
+
+		return NumProtos;
+	}
+
 	// If our source is the Decoding Engine, we can retrieve PDML packets from within the PDMLMaker
 	// (which is currently storing PDML fragments to disk)
 	RetVal= GetXMLPacketFromDump(PacketNumber, m_asciiBuffer.GetStartBufferPtr(), m_asciiBuffer.GetBufferTotSize(), AsciiBufferLen);
@@ -318,6 +347,33 @@ int CPDMLReader::GetPacketXML(unsigned long PacketNumber, char* &PacketPtr, unsi
 {
 int RetVal;
 
+	// Packets kept in the in-memory spool are converted in XML only now
+	if (m_spoolBuffer)
+	{
+	struct _nbPDMLPacket *PDMLPacket;
+
+		RetVal= GetPacket(PacketNumber, &PDMLPacket);
+		if ((RetVal == nbWARNING) || (RetVal == nbFAILURE))
+			return RetVal;
+
+		m_asciiBuffer.ClearBuffer(true /* resizing permitted */);
+
+		if (CPDMLMaker::DumpPDMLPacket(PDMLPacket,
+			((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->m_isVisExtRequired,
+			((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->m_generateRawDump,
+				&m_asciiBuffer, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+			return nbFAILURE;
+
+		PacketPtr= m_asciiBuffer.GetStartBufferPtr();
+		PacketLength= m_asciiBuffer.GetBufferCurrentSize();
+
+		// Remove the newline at the end of the fragment, as it happens when the fragment is read from the temp file
+		if (PacketLength > 0)
+			PacketPtr[--PacketLength]= 0;
+
+		return nbSUCCESS;
+	}
+
 	// Initialize a variable whose scope is limited to the current packet
 	m_currNumFields= 0;
 
@@ -833,6 +889,342 @@ DOMNode *DumpValue;
 }
 
 
+/*!
+	\brief It converts a PDML binary record (kept in the in-memory spool) into the _nbPDMLPacket structures.
+
+	No XML parsing is required: structures are filled in from the record, and their strings and
+	packet dump point directly to the record.
+
+	\param Record: pointer to the record, as created by DumpPDMLRecord(). It must be valid
+	as long as the returned structures are used.
+	\param RecordSize: size of the record.
+
+	\return The number of protocols contained in the packet, nbFAILURE if some error occurred.
+	The error message is stored in the m_errbuf internal buffer.
+*/
+int CPDMLReader::FormatPacketRecord(char *Record, unsigned long RecordSize)
+{
+struct _PDMLRecordHeader *Header;
+struct _PDMLRecordProto *RecordProtos;
+struct _PDMLRecordField *RecordFields;
+char *Strings;
+unsigned long i;
+
+	Header= (struct _PDMLRecordHeader *) Record;
+
+	if ((RecordSize < sizeof(struct _PDMLRecordHeader)) ||
+		((sizeof(struct _PDMLRecordHeader) + Header->NumProtos * sizeof(struct _PDMLRecordProto) +
+		Header->NumFields * sizeof(struct _PDMLRecordField) + Header->DumpSize) > RecordSize))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The PDML record in the spool is corrupted.");
+		return nbFAILURE;
+	}
+
+	// Check if the structures allocated previously are enough. If not, let's allocate new structures
+	while (Header->NumProtos >= m_maxNumProto)
+	{
+		if (UpdateProtoList(&m_maxNumProto, &m_protoList, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+			return nbFAILURE;
+	}
+	while (Header->NumFields >= m_maxNumFields)
+	{
+		if (UpdateFieldsList(&m_maxNumFields, &m_fieldsList, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+			return nbFAILURE;
+	}
+
+	RecordProtos= (struct _PDMLRecordProto *) &Header[1];
+	RecordFields= (struct _PDMLRecordField *) &RecordProtos[Header->NumProtos];
+	Strings= ((char *) &RecordFields[Header->NumFields]) + Header->DumpSize;
+
+	m_packetSummary.Number= Header->Number;
+	m_packetSummary.Length= Header->Length;
+	m_packetSummary.CapturedLength= Header->CapturedLength;
+	m_packetSummary.TimestampSec= Header->TimestampSec;
+	m_packetSummary.TimestampUSec= Header->TimestampUSec;
+
+	if (Header->DumpSize)
+		m_packetSummary.PacketDump= (unsigned char *) &RecordFields[Header->NumFields];
+	else
+		m_packetSummary.PacketDump= NULL;
+
+	for (i= 0; i < Header->NumProtos; i++)
+	{
+		memset(m_protoList[i], 0, sizeof(_nbPDMLProto));
+
+		m_protoList[i]->Name= PDML_RECORD_STRING(Strings, RecordProtos[i].Name);
+		m_protoList[i]->LongName= PDML_RECORD_STRING(Strings, RecordProtos[i].LongName);
+		m_protoList[i]->Position= RecordProtos[i].Position;
+		m_protoList[i]->Size= RecordProtos[i].Size;
+		m_protoList[i]->PacketSummary= &m_packetSummary;
+
+		if (RecordProtos[i].FirstField)
+			m_protoList[i]->FirstField= m_fieldsList[RecordProtos[i].FirstField - 1];
+
+		// Updates the protocol chain
+		if (i >= 1)
+		{
+			m_protoList[i - 1]->NextProto= m_protoList[i];
+			m_protoList[i]->PreviousProto= m_protoList[i - 1];
+		}
+	}
+
+	for (i= 0; i < Header->NumFields; i++)
+	{
+		memset(m_fieldsList[i], 0, sizeof(_nbPDMLField));
+
+		m_fieldsList[i]->Name= PDML_RECORD_STRING(Strings, RecordFields[i].Name);
+		m_fieldsList[i]->LongName= PDML_RECORD_STRING(Strings, RecordFields[i].LongName);
+		m_fieldsList[i]->ShowValue= PDML_RECORD_STRING(Strings, RecordFields[i].ShowValue);
+		m_fieldsList[i]->ShowDetails= PDML_RECORD_STRING(Strings, RecordFields[i].ShowDetails);
+		m_fieldsList[i]->ShowMap= PDML_RECORD_STRING(Strings, RecordFields[i].ShowMap);
+		m_fieldsList[i]->Value= PDML_RECORD_STRING(Strings, RecordFields[i].Value);
+		m_fieldsList[i]->Mask= PDML_RECORD_STRING(Strings, RecordFields[i].Mask);
+		m_fieldsList[i]->Position= RecordFields[i].Position;
+		m_fieldsList[i]->Size= RecordFields[i].Size;
+		m_fieldsList[i]->isField= (RecordFields[i].IsField != 0);
+
+		m_fieldsList[i]->ParentProto= m_protoList[RecordFields[i].ParentProto - 1];
+
+		if (RecordFields[i].ParentField)
+			m_fieldsList[i]->ParentField= m_fieldsList[RecordFields[i].ParentField - 1];
+		if (RecordFields[i].NextField)
+			m_fieldsList[i]->NextField= m_fieldsList[RecordFields[i].NextField - 1];
+		if (RecordFields[i].FirstChild)
+			m_fieldsList[i]->FirstChild= m_fieldsList[RecordFields[i].FirstChild - 1];
+	}
+
+	// A field always follows the one that precedes it, hence the backward links can be set only now
+	for (i= 0; i < Header->NumFields; i++)
+	{
+		if (m_fieldsList[i]->NextField)
+			m_fieldsList[i]->NextField->PreviousField= m_fieldsList[i];
+	}
+
+	m_currNumFields= Header->NumFields;
+
+	// Update the pointer to the first protocol
+	if (Header->NumProtos > 0)
+		m_packetSummary.FirstProto= m_protoList[0];
+	else
+		m_packetSummary.FirstProto= NULL;
+
+	return (int) Header->NumProtos;
+}
+
+
+/*!
+	\brief It converts a decoded packet into a binary record that can be kept in the in-memory spool.
+
+	The record (whose format is described in _PDMLRecordHeader) keeps everything that is needed
+	to rebuild the _nbPDMLPacket structures (through FormatPacketRecord()) and the PDML fragment of the packet.
+
+	\param PDMLPacket: the packet that has to be converted.
+	\param StoreRawDump: nonzero if the raw packet dump has to be kept in the record.
+	\param RecordBuffer: pointer to the buffer that will keep the record; it is reallocated if it is too small.
+	\param RecordBufferSize: pointer to the size of the previous buffer; it is updated if the buffer is reallocated.
+	\param RecordSize: upon return, it keeps the size of the record.
+
+	\param ErrBuf: user-allocated buffer (of length 'ErrBufSize') that will keep an error message (if one).
+	This buffer will always be NULL terminated.
+
+	\param ErrBufSize: size of the previous buffer.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE if something goes wrong.
+	The error message will be returned in the 'ErrBuf' buffer.
+
+	\note This function has been declared as 'static' because it is called by the CPDMLMaker.
+*/
+int CPDMLReader::DumpPDMLRecord(struct _nbPDMLPacket *PDMLPacket, int StoreRawDump, char **RecordBuffer, unsigned long *RecordBufferSize,
+								unsigned long *RecordSize, char *ErrBuf, int ErrBufSize)
+{
+struct _PDMLRecordHeader *Header;
+struct _PDMLRecordProto *RecordProtos;
+struct _PDMLRecordField *RecordFields;
+struct _nbPDMLProto *ProtoItem;
+unsigned long NumProtos, NumFields;
+unsigned long DumpSize, StringsSize;
+char *Strings;
+
+	// First pass: let's compute the size of the record
+	NumProtos= 0;
+	NumFields= 0;
+	StringsSize= 0;
+
+	for (ProtoItem= PDMLPacket->FirstProto; ProtoItem; ProtoItem= ProtoItem->NextProto)
+	{
+		NumProtos++;
+		StringsSize+= PDML_RECORD_STRING_SIZE(ProtoItem->Name) + PDML_RECORD_STRING_SIZE(ProtoItem->LongName);
+
+		CountPDMLRecordFields(ProtoItem->FirstField, &NumFields, &StringsSize);
+	}
+
+	DumpSize= 0;
+	if ((StoreRawDump) && (PDMLPacket->PacketDump))
+		DumpSize= PDMLPacket->CapturedLength;
+
+	*RecordSize= sizeof(struct _PDMLRecordHeader) + NumProtos * sizeof(struct _PDMLRecordProto) +
+		NumFields * sizeof(struct _PDMLRecordField) + DumpSize + StringsSize;
+
+	if (*RecordSize > *RecordBufferSize)
+	{
+		if (*RecordBuffer)
+			delete[] *RecordBuffer;
+
+		*RecordBuffer= new char [*RecordSize];
+		if (*RecordBuffer == NULL)
+		{
+			*RecordBufferSize= 0;
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to allocate the PDML record.");
+			return nbFAILURE;
+		}
+
+		*RecordBufferSize= *RecordSize;
+	}
+
+	Header= (struct _PDMLRecordHeader *) *RecordBuffer;
+	RecordProtos= (struct _PDMLRecordProto *) &Header[1];
+	RecordFields= (struct _PDMLRecordField *) &RecordProtos[NumProtos];
+	Strings= ((char *) &RecordFields[NumFields]) + DumpSize;
+
+	Header->Number= PDMLPacket->Number;
+	Header->Length= PDMLPacket->Length;
+	Header->CapturedLength= PDMLPacket->CapturedLength;
+	Header->TimestampSec= PDMLPacket->TimestampSec;
+	Header->TimestampUSec= PDMLPacket->TimestampUSec;
+	Header->NumProtos= NumProtos;
+	Header->NumFields= NumFields;
+	Header->DumpSize= DumpSize;
+
+	if (DumpSize)
+		memcpy(&RecordFields[NumFields], PDMLPacket->PacketDump, DumpSize);
+
+	// Second pass: let's dump protocols and fields (which are numbered in the same order they have in the PDML fragment)
+	NumProtos= 0;
+	NumFields= 0;
+	StringsSize= 0;
+
+	for (ProtoItem= PDMLPacket->FirstProto; ProtoItem; ProtoItem= ProtoItem->NextProto)
+	{
+		RecordProtos[NumProtos].Name= DumpPDMLRecordString(ProtoItem->Name, Strings, &StringsSize);
+		RecordProtos[NumProtos].LongName= DumpPDMLRecordString(ProtoItem->LongName, Strings, &StringsSize);
+		RecordProtos[NumProtos].Position= ProtoItem->Position;
+		RecordProtos[NumProtos].Size= ProtoItem->Size;
+		RecordProtos[NumProtos].FirstField= (ProtoItem->FirstField ? NumFields + 1 : 0);
+
+		NumProtos++;
+
+		DumpPDMLRecordFields(ProtoItem->FirstField, NumProtos, 0, RecordFields, &NumFields, Strings, &StringsSize);
+	}
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief It counts the fields (and the size of their strings) that have to be stored in a PDML binary record.
+
+	It scans the given field, its siblings and all their children.
+*/
+void CPDMLReader::CountPDMLRecordFields(struct _nbPDMLField *PDMLField, unsigned long *NumFields, unsigned long *StringsSize)
+{
+	while (PDMLField)
+	{
+		(*NumFields)++;
+
+		*StringsSize+= PDML_RECORD_STRING_SIZE(PDMLField->Name) + PDML_RECORD_STRING_SIZE(PDMLField->LongName) +
+			PDML_RECORD_STRING_SIZE(PDMLField->ShowValue) + PDML_RECORD_STRING_SIZE(PDMLField->ShowDetails) +
+			PDML_RECORD_STRING_SIZE(PDMLField->ShowMap) + PDML_RECORD_STRING_SIZE(PDMLField->Value) +
+			PDML_RECORD_STRING_SIZE(PDMLField->Mask);
+
+		CountPDMLRecordFields(PDMLField->FirstChild, NumFields, StringsSize);
+
+		PDMLField= PDMLField->NextField;
+	}
+}
+
+
+/*!
+	\brief It dumps a field, its siblings and all their children in a PDML binary record.
+
+	\param PDMLField: the first field that has to be dumped.
+	\param ParentProto: index of the protocol that contains the fields.
+	\param ParentField: index of the parent of the fields ('0' if they do not have a parent).
+	\param RecordFields: array of the fields in the record.
+	\param NumFields: number of fields already dumped in the record; it is updated by this function.
+	\param Strings: string section of the record.
+	\param StringsSize: number of bytes already used in the string section; it is updated by this function.
+*/
+void CPDMLReader::DumpPDMLRecordFields(struct _nbPDMLField *PDMLField, unsigned long ParentProto, unsigned long ParentField,
+								struct _PDMLRecordField *RecordFields, unsigned long *NumFields, char *Strings, unsigned long *StringsSize)
+{
+unsigned long FieldIndex;
+unsigned long PreviousIndex;
+
+	PreviousIndex= 0;
+
+	while (PDMLField)
+	{
+	struct _PDMLRecordField *RecordField;
+
+		// Indexes start from '1'
+		(*NumFields)++;
+		FieldIndex= *NumFields;
+		RecordField= &RecordFields[FieldIndex - 1];
+
+		RecordField->Name= DumpPDMLRecordString(PDMLField->Name, Strings, StringsSize);
+		RecordField->LongName= DumpPDMLRecordString(PDMLField->LongName, Strings, StringsSize);
+		RecordField->ShowValue= DumpPDMLRecordString(PDMLField->ShowValue, Strings, StringsSize);
+		RecordField->ShowDetails= DumpPDMLRecordString(PDMLField->ShowDetails, Strings, StringsSize);
+		RecordField->ShowMap= DumpPDMLRecordString(PDMLField->ShowMap, Strings, StringsSize);
+		RecordField->Value= DumpPDMLRecordString(PDMLField->Value, Strings, StringsSize);
+		RecordField->Mask= DumpPDMLRecordString(PDMLField->Mask, Strings, StringsSize);
+		RecordField->Position= PDMLField->Position;
+		RecordField->Size= PDMLField->Size;
+		RecordField->IsField= (PDMLField->isField ? 1 : 0);
+		RecordField->ParentProto= ParentProto;
+		RecordField->ParentField= ParentField;
+		RecordField->NextField= 0;
+		RecordField->FirstChild= 0;
+
+		if (PreviousIndex)
+			RecordFields[PreviousIndex - 1].NextField= FieldIndex;
+
+		// Children follow their parent in the record
+		if (PDMLField->FirstChild)
+		{
+			RecordField->FirstChild= FieldIndex + 1;
+			DumpPDMLRecordFields(PDMLField->FirstChild, ParentProto, FieldIndex, RecordFields, NumFields, Strings, StringsSize);
+		}
+
+		PreviousIndex= FieldIndex;
+		PDMLField= PDMLField->NextField;
+	}
+}
+
+
+/*!
+	\brief It copies a string in the string section of a PDML binary record.
+
+	\return The offset of the string in the string section (starting from '1'), or '0' if the string is NULL.
+*/
+unsigned long CPDMLReader::DumpPDMLRecordString(const char *String, char *Strings, unsigned long *StringsSize)
+{
+unsigned long Offset;
+unsigned long Length;
+
+	if (String == NULL)
+		return 0;
+
+	Offset= *StringsSize;
+	Length= (unsigned long) strlen(String) + 1;
+
+	memcpy(&Strings[Offset], String, Length);
+	*StringsSize+= Length;
+
+	return Offset + 1;
+}
+
+
 /*!
 	\brief It extracts a given attribute from the current element and stores it in the appropriate ascii buffer.
 
@@ -1083,6 +1475,7 @@ MemBufInputSource MemBuf( (const XMLByte *) Buffer, BytesToParse, "", false);
 int CPDMLReader::GetPDMLField(char *ProtoName, char *FieldName, struct _nbPDMLField *FirstField, struct _nbPDMLField **ExtractedField)
 {
 struct _nbPDMLPacket *PDMLPacket;
+int RetVal;
 
 	if (!m_NetPDLDecodingEngine)
 	{
@@ -1104,7 +1497,31 @@ struct _nbPDMLPacket *PDMLPacket;
 	}
 
 	// Let's jump to the common code
-	return GetPDMLFieldInternal(PDMLPacket, ProtoName, FieldName, FirstField, ExtractedField);
+	RetVal= GetPDMLFieldInternal(PDMLPacket, ProtoName, FieldName, FirstField, ExtractedField);
+
+	if (RetVal != nbSUCCESS)
+		return RetVal;
+
+	// The field may not have been formatted yet
+	return FormatPDMLField(*ExtractedField);
+}
+
+
+// Documented in the base class
+int CPDMLReader::FormatPDMLField(struct _nbPDMLField *PDMLField)
+{
+	// Fields that do not come from the Decoding Engine are always complete
+	if (!m_NetPDLDecodingEngine)
+		return nbSUCCESS;
+
+	if ( ((CNetPDLDecoder *)m_NetPDLDecodingEngine)->m_PDMLMaker->FormatDeferredField(PDMLField) == nbFAILURE)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "%s",
+			((CNetPDLDecoder *)m_NetPDLDecodingEngine)->GetLastError() );
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
 }
 
 
@@ -22,6 +22,60 @@ XERCES_CPP_NAMESPACE_USE
 
 
 
+/*!
+	\brief Header of the binary record that keeps a PDML packet in the in-memory spool.
+
+	The header is followed by the array of protocols (_PDMLRecordProto), the array of fields
+	(_PDMLRecordField, in the same order they have in the PDML fragment), the raw packet dump (if any)
+	and the strings referenced by protocols and fields.
+	Links among protocols and fields are stored as indexes in their arrays, and strings as offsets in the
+	string section; in both cases, values start from '1', while '0' means NULL.
+*/
+struct _PDMLRecordHeader
+{
+	unsigned long Number;				//!< Ordinal number of the packet.
+	unsigned long Length;				//!< Total length (off wire) of the packet.
+	unsigned long CapturedLength;		//!< Number of bytes captured from the packet.
+	unsigned long TimestampSec;			//!< Timestamp (seconds) of the packet.
+	unsigned long TimestampUSec;		//!< Timestamp (microseconds) of the packet.
+	unsigned long NumProtos;			//!< Number of protocols in the record.
+	unsigned long NumFields;			//!< Number of fields in the record.
+	unsigned long DumpSize;				//!< Size of the raw packet dump ('0' if the dump is not present).
+};
+
+
+//! Protocol stored in a PDML binary record.
+struct _PDMLRecordProto
+{
+	unsigned long Name;					//!< Offset of the name of the protocol.
+	unsigned long LongName;				//!< Offset of the long name of the protocol.
+	unsigned long Position;				//!< Position of the protocol in the packet dump.
+	unsigned long Size;					//!< Size of the protocol.
+	unsigned long FirstField;			//!< Index of the first field of the protocol.
+};
+
+
+//! Field stored in a PDML binary record.
+struct _PDMLRecordField
+{
+	unsigned long Name;					//!< Offset of the name of the field.
+	unsigned long LongName;				//!< Offset of the long name of the field.
+	unsigned long ShowValue;			//!< Offset of the 'showvalue' attribute.
+	unsigned long ShowDetails;			//!< Offset of the 'showdtl' attribute.
+	unsigned long ShowMap;				//!< Offset of the 'showmap' attribute.
+	unsigned long Value;				//!< Offset of the 'value' attribute.
+	unsigned long Mask;					//!< Offset of the 'mask' attribute.
+	unsigned long Position;				//!< Position of the field in the packet dump.
+	unsigned long Size;					//!< Size of the field.
+	unsigned long IsField;				//!< '1' if the element is a field, '0' if it is a block.
+	unsigned long ParentProto;			//!< Index of the protocol that contains the field.
+	unsigned long ParentField;			//!< Index of the parent field.
+	unsigned long NextField;			//!< Index of the field that follows the current one.
+	unsigned long FirstChild;			//!< Index of the first child field.
+};
+
+
+
 //! This class implements the nbReader abstract class.
 class CPDMLReader : public nbPDMLReader, public CPxMLReader
 {
@@ -41,6 +95,8 @@ public:
 	int GetPDMLField(char *ProtoName, char *FieldName, struct _nbPDMLField *FirstField, struct _nbPDMLField **ExtractedField);
 	int GetPDMLField(unsigned long PacketNumber, char *ProtoName, char *FieldName, struct _nbPDMLField *FirstField, struct _nbPDMLField **ExtractedField);
 
+	int FormatPDMLField(struct _nbPDMLField *PDMLField);
+
 	// Documented in the base class
 	int RemovePacket(unsigned long PacketNumber) { return CPxMLReader::RemovePacket(PacketNumber); }
 
@@ -59,6 +115,9 @@ public:
 	static int AppendItemString(const char *SourceString, char **AppendAt, CAsciiBuffer *TmpBuffer, char *ErrBuf, int ErrBufSize);
 	static int AppendItemLong(DOMNode *SourceNode, const char *TagToLookFor, unsigned long *AppendAt, char *ErrBuf, int ErrBufSize);
 
+	static int DumpPDMLRecord(struct _nbPDMLPacket *PDMLPacket, int StoreRawDump, char **RecordBuffer, unsigned long *RecordBufferSize,
+								unsigned long *RecordSize, char *ErrBuf, int ErrBufSize);
+
 private:
 
 	int FormatItem(DOMNodeList *ItemList, char *Buffer, int BufSize);
@@ -66,6 +125,12 @@ private:
 	int FormatFieldNodes(DOMNode *CurrentField, struct _nbPDMLProto *ParentProto, struct _nbPDMLField *ParentField);
 	int FormatPacketSummary(DOMDocument *PDMLDocument);
 	int FormatDumpItem(DOMDocument *PDMLDocument, CAsciiBuffer *TmpBuffer, char *ErrBuf, int ErrBufSize);
+	int FormatPacketRecord(char *Record, unsigned long RecordSize);
+
+	static void CountPDMLRecordFields(struct _nbPDMLField *PDMLField, unsigned long *NumFields, unsigned long *StringsSize);
+	static void DumpPDMLRecordFields(struct _nbPDMLField *PDMLField, unsigned long ParentProto, unsigned long ParentField,
+								struct _PDMLRecordField *RecordFields, unsigned long *NumFields, char *Strings, unsigned long *StringsSize);
+	static unsigned long DumpPDMLRecordString(const char *String, char *Strings, unsigned long *StringsSize);
 
 	DOMDocument* ParseMemBuf(char *Buffer, int BytesToParse);
 
@@ -53,9 +53,11 @@ CPSMLMaker::CPSMLMaker(CNetPDLExpression *ExprHandler, CPSMLReader *PSMLReader,
 {
 	m_isVisExtRequired= NetPDLFlags & nbDECODER_GENERATEPSML;
 	m_keepAllPackets= NetPDLFlags & nbDECODER_KEEPALLPSML;
+	m_keepInMemory= NetPDLFlags & nbDECODER_KEEPALL_INMEMORY;
 
 	m_PSMLReader= PSMLReader;
 	m_exprHandler= ExprHandler;
+	m_PDMLMaker= NULL;
 
 	// Store internally the pointer to the error buffer. This buffer belongs to the class that creates this one.
 	m_errbuf= ErrBuf;
@@ -63,6 +65,20 @@ CPSMLMaker::CPSMLMaker(CNetPDLExpression *ExprHandler, CPSMLReader *PSMLReader,
 }
 
 
+/*!
+	\brief Sets the class that creates the PDML fragment of the packets.
+
+	When this class is set, the fields referred by the summary are formatted by the PDMLMaker
+	in case their formatting has been deferred (see nbDECODER_DEFERFIELDFORMAT).
+
+	\param PDMLMaker: the PDMLMaker that decodes the packets summarized by this class (NULL if none).
+*/
+void CPSMLMaker::SetPDMLMaker(CPDMLMaker *PDMLMaker)
+{
+	m_PDMLMaker= PDMLMaker;
+}
+
+
 /*!
 	\brief Initializes the variables contained into this class.
 
@@ -122,7 +138,7 @@ unsigned int i;
 //		BytesToWrite= GetSummaryAscii(Buffer, sizeof(Buffer) );
 		GetSummaryAscii(Buffer, sizeof(Buffer) );
 
-		if (m_PSMLReader->InitializeParsForDump(PSML_ROOT, Buffer) == nbFAILURE)
+		if (m_PSMLReader->InitializeParsForDump(PSML_ROOT, Buffer, (m_keepInMemory != 0)) == nbFAILURE)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "%s", m_PSMLReader->GetLastError() );
 			return nbFAILURE;
@@ -300,8 +316,13 @@ struct _nbNetPDLElementBase *NetPDLIndexItem;
 
 				IndexItemInfo= (struct _nbNetPDLElementProtoField *) NetPDLIndexItem;
 
-				RetVal= CPDMLMaker::ScanForFieldRefAttrib(PDMLProtoItem->FirstField, NULL, 
-					IndexItemInfo->FieldName, IndexItemInfo->FieldShowDataType, &Attrib, m_errbuf, m_errbufSize);
+				// The PDMLMaker formats the field, in case its formatting has been deferred
+				if (m_PDMLMaker)
+					RetVal= m_PDMLMaker->FindFieldRefAttrib(PDMLProtoItem->FirstField, NULL, 
+						IndexItemInfo->FieldName, IndexItemInfo->FieldShowDataType, &Attrib, m_errbuf, m_errbufSize);
+				else
+					RetVal= CPDMLMaker::ScanForFieldRefAttrib(PDMLProtoItem->FirstField, NULL, 
+						IndexItemInfo->FieldName, IndexItemInfo->FieldShowDataType, &Attrib, m_errbuf, m_errbufSize);
 
 				// Handles the case in which the field has not been found
 				if (RetVal != nbSUCCESS)
@@ -562,8 +583,28 @@ int CPSMLMaker::PacketDecodingEnded()
 	unsigned int BytesToWrite;
 	char *BufferPtr;
 
-		BufferPtr= m_tempAsciiBuffer.GetStartBufferPtr();
-		BytesToWrite= GetCurrentPacketAscii(BufferPtr, m_tempAsciiBuffer.GetBufferTotSize() );
+		if (m_keepInMemory)
+		{
+			// Sections are kept as a sequence of '\0'-terminated strings; the PSML fragment is generated only when requested
+			m_tempAsciiBuffer.ClearBuffer(true /* resizing permitted */);
+
+			for (unsigned int i= 0; i < NetPDLDatabase->ShowSumStructureNItems; i++)
+			{
+				if (m_tempAsciiBuffer.Store(m_summaryItemsData[i]) == NULL)
+				{
+					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, m_errbufSize, "%s", m_tempAsciiBuffer.GetLastError() );
+					return nbFAILURE;
+				}
+			}
+
+			BufferPtr= m_tempAsciiBuffer.GetStartBufferPtr();
+			BytesToWrite= m_tempAsciiBuffer.GetBufferCurrentSize();
+		}
+		else
+		{
+			BufferPtr= m_tempAsciiBuffer.GetStartBufferPtr();
+			BytesToWrite= GetCurrentPacketAscii(BufferPtr, m_tempAsciiBuffer.GetBufferTotSize() );
+		}
 
 		if (m_PSMLReader->StorePacket(BufferPtr, BytesToWrite) == nbFAILURE)
 		{
@@ -40,6 +40,8 @@ public:
 	int GetSummaryAscii(char *Buffer, int BufferSize);
 	int GetCurrentPacketAscii(char *Buffer, int BufferSize);
 
+	void SetPDMLMaker(CPDMLMaker *PDMLMaker);
+
 
 	/*!
 		\brief Variable used to store the text contained general structure of the summary
@@ -76,12 +78,18 @@ private:
 	//! Pointer to the same expression handler we have into the NetPDL decoder
 	CNetPDLExpression *m_exprHandler;
 
+	//! Pointer to the PDMLMaker that generates the fields referred by the summary (NULL if none)
+	CPDMLMaker *m_PDMLMaker;
+
 	//! Value that indicates if the user wants to create also visualization extension within the PDML file.
 	int m_isVisExtRequired;
 
 	//! Value that indicates if the user wants to keep all the packets stored or just the last one.
 	int m_keepAllPackets;
 
+	//! Value that indicates if the packets have to be kept in the in-memory spool (as lists of sections) instead of a temp file.
+	int m_keepInMemory;
+
 	//! Pointer to a PSMLReader; needed to manage PSML files (storing data and such)
 	CPSMLReader *m_PSMLReader;
 
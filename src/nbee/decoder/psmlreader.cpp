@@ -289,6 +289,20 @@ int CPSMLReader::GetPacket(unsigned long PacketNumber, char **PacketPtr)
 unsigned int AsciiBufferLen;
 int RetVal;
 
+	// If packets are kept in the in-memory spool, the record is already a '\0' delimited list of sections
+	if (m_spoolBuffer)
+	{
+	char *Record;
+	unsigned long RecordSize;
+
+		RetVal= GetPacketRecord(PacketNumber, Record, RecordSize);
+		if ((RetVal == nbWARNING) || (RetVal == nbFAILURE))
+			return RetVal;
+
+		(*PacketPtr)= Record;
+		return (int) NetPDLDatabase->ShowSumStructureNItems;
+	}
+
 	RetVal= GetXMLPacketFromDump(PacketNumber, m_asciiBuffer.GetStartBufferPtr(), m_asciiBuffer.GetBufferTotSize(), AsciiBufferLen);
 	if ((RetVal == nbWARNING) || (RetVal == nbFAILURE))
 		return RetVal;
@@ -303,6 +317,48 @@ int CPSMLReader::GetPacketXML(unsigned long PacketNumber, char* &PacketPtr, unsi
 {
 int RetVal;
 
+	// Packets kept in the in-memory spool are converted in XML only now
+	if (m_spoolBuffer)
+	{
+	char *Record;
+	unsigned long RecordSize;
+
+		RetVal= GetPacketRecord(PacketNumber, Record, RecordSize);
+		if ((RetVal == nbWARNING) || (RetVal == nbFAILURE))
+			return RetVal;
+
+		m_asciiBuffer.ClearBuffer(true /* resizing permitted */);
+
+		// The fragment is returned without the newline at its end, as it happens when it is read from the temp file
+		if (m_asciiBuffer.AppendFormatted("<%s>\n", PSML_PACKET) == nbFAILURE)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "%s", m_asciiBuffer.GetLastError() );
+			return nbFAILURE;
+		}
+
+		for (unsigned int i= 0; i < NetPDLDatabase->ShowSumStructureNItems; i++)
+		{
+			if (m_asciiBuffer.AppendFormatted("<%s>%s</%s>\n", PSML_SECTION, Record, PSML_SECTION) == nbFAILURE)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "%s", m_asciiBuffer.GetLastError() );
+				return nbFAILURE;
+			}
+
+			Record+= strlen(Record) + 1;
+		}
+
+		if (m_asciiBuffer.AppendFormatted("</%s>", PSML_PACKET) == nbFAILURE)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "%s", m_asciiBuffer.GetLastError() );
+			return nbFAILURE;
+		}
+
+		PacketPtr= m_asciiBuffer.GetStartBufferPtr();
+		PacketLength= m_asciiBuffer.GetBufferCurrentSize();
+
+		return nbSUCCESS;
+	}
+
 	RetVal= GetXMLPacketFromDump(PacketNumber, m_asciiBuffer.GetStartBufferPtr(), m_asciiBuffer.GetBufferTotSize(), PacketLength);
 	PacketPtr= m_asciiBuffer.GetStartBufferPtr();
 
@@ -36,6 +36,11 @@ CPxMLReader::CPxMLReader()
 	m_sourceOnDiskFileHandle= NULL;
 	m_tempDumpFileHandle= NULL;
 
+	m_spoolBuffer= NULL;
+	m_spoolSize= 0;
+	m_recordBuffer= NULL;
+	m_recordBufferSize= 0;
+
 	m_packetList= NULL;
 
 	m_currNumPackets=0;
@@ -59,6 +64,11 @@ CPxMLReader::~CPxMLReader()
 	if (m_packetList)
 		delete[] m_packetList;
 
+	if (m_spoolBuffer)
+		delete[] m_spoolBuffer;
+	if (m_recordBuffer)
+		delete[] m_recordBuffer;
+
 	// Close handles to the temp files
 	if (m_tempDumpFileHandle)
 		// The temp files are automatically removed by the system
@@ -182,15 +192,35 @@ int CPxMLReader::CheckPacketListSize()
 	\param InitText: string that keeps any text that must be placed at the beginning of the file
 	(such as the summary index for the PSML file).
 
+	\param KeepInMemory: 'true' if packets have to be kept in the in-memory spool instead of the temp file.
+	In this case, the caller stores records in its own format, which are converted in XML by GetPacketXML().
+
 	\return nbSUCCESS function is successful, nbFAILURE if something goes wrong.
 	In case of error, the error message can be retrieved by the GetLastError() method.
 */
-int CPxMLReader::InitializeParsForDump(const char *RootXMLTag, const char *InitText)
+int CPxMLReader::InitializeParsForDump(const char *RootXMLTag, const char *InitText, bool KeepInMemory)
 {
 	strncpy(m_rootXMLTag, RootXMLTag, sizeof(m_rootXMLTag) );
 	if (InitText)
 		strncpy(m_initText, InitText, sizeof(m_initText) );
 
+	if (KeepInMemory)
+	{
+		m_spoolBuffer= new char [PXML_SPOOL_MIN_SIZE];
+		if (m_spoolBuffer == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+				"Not enough memory to allocate the spool that keeps PDML/PSML data.");
+
+			return nbFAILURE;
+		}
+
+		m_spoolSize= PXML_SPOOL_MIN_SIZE;
+		m_packetList[0]= 0;
+
+		return nbSUCCESS;
+	}
+
 	// Get temp file name
 	m_tempDumpFileHandle= tmpfile();
 	if (m_tempDumpFileHandle == 0)
@@ -269,6 +299,9 @@ unsigned int BytesToWrite;
 */
 int CPxMLReader::StorePacket(char *Buffer, unsigned int BytesToWrite)
 {
+	if (m_spoolBuffer)
+		return StoreInSpool(Buffer, BytesToWrite);
+
 	if ( fwrite(Buffer, sizeof (char), BytesToWrite, m_tempDumpFileHandle) != BytesToWrite)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
@@ -288,6 +321,174 @@ int CPxMLReader::StorePacket(char *Buffer, unsigned int BytesToWrite)
 }
 
 
+/*!
+	\brief It adds a new packet to the in-memory spool.
+
+	If the spool is full, it is enlarged; when it has already reached its maximum size,
+	the oldest packets are discarded.
+
+	\param Buffer: pointer to the record that keeps the packet.
+
+	\param BytesToWrite: the size of the record.
+
+	\return nbSUCCESS if the function is successful, nbFAILURE if something goes wrong.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPxMLReader::StoreInSpool(char *Buffer, unsigned int BytesToWrite)
+{
+	if (BytesToWrite > PXML_SPOOL_MAX_SIZE)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+			"The decoded packet is too big to be kept in the in-memory spool.");
+
+		return nbFAILURE;
+	}
+
+	// Offsets grow forever (modulo the size of an unsigned long); the spool keeps the data
+	// between the first and the last offset in the list
+	if ((m_packetList[m_currNumPackets] - m_packetList[0] + BytesToWrite) > m_spoolSize)
+	{
+		if (m_spoolSize < PXML_SPOOL_MAX_SIZE)
+		{
+			if (EnlargeSpool(BytesToWrite) == nbFAILURE)
+				return nbFAILURE;
+		}
+		else
+			DiscardOldestPackets(BytesToWrite);
+	}
+
+	WriteToSpool(m_packetList[m_currNumPackets], Buffer, BytesToWrite);
+
+	m_packetList[m_currNumPackets + 1]= m_packetList[m_currNumPackets] + BytesToWrite;
+	m_currNumPackets++;
+
+	// Check if the vector is enough; if not, let's allocate a new one, and let's hope it is enough
+	return CheckPacketListSize();
+}
+
+
+/*!
+	\brief It enlarges the in-memory spool (up to PXML_SPOOL_MAX_SIZE) so that it can keep 'BytesNeeded' more bytes.
+
+	Data is moved at the beginning of the new spool, hence the offsets in the packet list are rebased.
+	If the spool is still too small when it reaches its maximum size, the oldest packets are discarded.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE if something goes wrong.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPxMLReader::EnlargeSpool(unsigned long BytesNeeded)
+{
+unsigned long UsedBytes;
+unsigned long NewSize;
+unsigned long BaseOffset;
+char *NewSpool;
+
+	UsedBytes= m_packetList[m_currNumPackets] - m_packetList[0];
+
+	NewSize= m_spoolSize;
+	while ((NewSize < PXML_SPOOL_MAX_SIZE) && ((UsedBytes + BytesNeeded) > NewSize))
+		NewSize*= 2;
+
+	NewSpool= new char [NewSize];
+	if (NewSpool == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+			"Not enough memory to enlarge the spool that keeps PDML/PSML data.");
+
+		return nbFAILURE;
+	}
+
+	ReadFromSpool(m_packetList[0], NewSpool, UsedBytes);
+
+	BaseOffset= m_packetList[0];
+	for (unsigned long i= 0; i <= m_currNumPackets; i++)
+		m_packetList[i]-= BaseOffset;
+
+	delete[] m_spoolBuffer;
+	m_spoolBuffer= NewSpool;
+	m_spoolSize= NewSize;
+
+	if ((UsedBytes + BytesNeeded) > m_spoolSize)
+		DiscardOldestPackets(BytesNeeded);
+
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief It discards the oldest packets in the spool, until 'BytesNeeded' bytes are free.
+
+	At least 1/8 of the spool is freed each time, so that the packet list is shifted once for a batch of packets.
+	'BytesNeeded' must not be greater than the size of the spool.
+*/
+void CPxMLReader::DiscardOldestPackets(unsigned long BytesNeeded)
+{
+unsigned long MinFreeBytes;
+unsigned long FirstPacket;
+
+	MinFreeBytes= m_spoolSize / 8;
+	if (BytesNeeded > MinFreeBytes)
+		MinFreeBytes= BytesNeeded;
+
+	for (FirstPacket= 0; FirstPacket < m_currNumPackets; FirstPacket++)
+	{
+		if ((m_spoolSize - (m_packetList[m_currNumPackets] - m_packetList[FirstPacket])) >= MinFreeBytes)
+			break;
+	}
+
+	for (unsigned long i= FirstPacket; i <= m_currNumPackets; i++)
+		m_packetList[i - FirstPacket]= m_packetList[i];
+
+	m_currNumPackets-= FirstPacket;
+}
+
+
+/*!
+	\brief It copies 'Length' bytes from the spool, starting at 'Offset', taking care of the wrap around.
+*/
+void CPxMLReader::ReadFromSpool(unsigned long Offset, char *Buffer, unsigned long Length)
+{
+unsigned long StartIndex;
+unsigned long FirstChunk;
+
+	StartIndex= Offset & (m_spoolSize - 1);
+	FirstChunk= m_spoolSize - StartIndex;
+
+	if (Length <= FirstChunk)
+	{
+		memcpy(Buffer, &m_spoolBuffer[StartIndex], Length);
+	}
+	else
+	{
+		memcpy(Buffer, &m_spoolBuffer[StartIndex], FirstChunk);
+		memcpy(&Buffer[FirstChunk], m_spoolBuffer, Length - FirstChunk);
+	}
+}
+
+
+/*!
+	\brief It copies 'Length' bytes into the spool, starting at 'Offset', taking care of the wrap around.
+*/
+void CPxMLReader::WriteToSpool(unsigned long Offset, const char *Buffer, unsigned long Length)
+{
+unsigned long StartIndex;
+unsigned long FirstChunk;
+
+	StartIndex= Offset & (m_spoolSize - 1);
+	FirstChunk= m_spoolSize - StartIndex;
+
+	if (Length <= FirstChunk)
+	{
+		memcpy(&m_spoolBuffer[StartIndex], Buffer, Length);
+	}
+	else
+	{
+		memcpy(&m_spoolBuffer[StartIndex], Buffer, FirstChunk);
+		memcpy(m_spoolBuffer, &Buffer[FirstChunk], Length - FirstChunk);
+	}
+}
+
+
 
 //!Documented in the base class
 int CPxMLReader::RemovePacket(unsigned long PacketNumber)
@@ -382,6 +583,54 @@ FILE *SourceFileHandle;
 }
 
 
+/*!
+	\brief It returns the record that keeps the requested packet in the in-memory spool.
+
+	\param PacketNumber: the ordinal number of the packet (starting from '1') that has to
+	be returned.
+
+	\param Record: upon return, it points to a copy of the record, which is valid up to the next call.
+
+	\param RecordSize: upon return, it contains the size of the record.
+
+	\return nbSUCCESS if the function is successful, nbFAILURE if some error occurred,
+	nbWARNING if the user asked for a packet that is out of range.
+	In case of error, the error message can be retrieved by the GetLastError() method.
+*/
+int CPxMLReader::GetPacketRecord(unsigned long PacketNumber, char* &Record, unsigned long &RecordSize)
+{
+	// Check that the requested packet is not out of range (this is not a 'real' error)
+	if ((PacketNumber == 0) || (PacketNumber > m_currNumPackets))
+		return nbWARNING;
+
+	RecordSize= m_packetList[PacketNumber] - m_packetList[PacketNumber - 1];
+
+	if (RecordSize > m_recordBufferSize)
+	{
+		if (m_recordBuffer)
+			delete[] m_recordBuffer;
+
+		m_recordBuffer= new char [RecordSize];
+		if (m_recordBuffer == NULL)
+		{
+			m_recordBufferSize= 0;
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+				"Not enough memory to read a packet from the spool.");
+
+			return nbFAILURE;
+		}
+
+		m_recordBufferSize= RecordSize;
+	}
+
+	// The record is copied, since the spool can be overwritten by the packets that are decoded later
+	ReadFromSpool(m_packetList[PacketNumber - 1], m_recordBuffer, RecordSize);
+	Record= m_recordBuffer;
+
+	return nbSUCCESS;
+}
+
+
 
 // Documented in the base class
 int CPxMLReader::SaveDocumentAs(const char *Filename)
@@ -411,7 +660,7 @@ unsigned int BufferSize;
 		SourceFileHandle= m_sourceOnDiskFileHandle;
 
 	// In case the PacketDecoder has not been configured to keep all data, this pointer will be NULL
-	if (SourceFileHandle == NULL)
+	if ((SourceFileHandle == NULL) && (m_spoolBuffer == NULL))
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
 			"Cannot dump data on file when the Packet Decoder has not been configured to keep all packets.");
@@ -429,39 +678,64 @@ unsigned int BufferSize;
 		return nbFAILURE;
 	}
 
-	// Move pointer to the beginning of the file
-	fseek(SourceFileHandle, 0, SEEK_SET);
-
 	// Initialize the destination file
 	if (InitializeDumpFile(DestFileHandle) == nbFAILURE)
 		return nbFAILURE;
 
-	for (unsigned i= 0; i< m_currNumPackets; i++)
+	// Packets in the spool are kept in a binary format; the XML fragments are generated by the derived class
+	if (m_spoolBuffer)
 	{
-		// move pointer to the beginning of the file
-		fseek(SourceFileHandle, m_packetList[i], SEEK_SET);
+		for (unsigned i= 0; i< m_currNumPackets; i++)
+		{
+		char *PacketPtr;
+		unsigned int PacketLength;
 
-		BytesToWrite= (int) fread(BufferPtr, sizeof(char), m_packetList[i+1] - m_packetList[i], SourceFileHandle);
+			if (GetPacketXML(i + 1, PacketPtr, PacketLength) != nbSUCCESS)
+				return nbFAILURE;
 
-		if (BytesToWrite > BufferSize)
-		{
-			errorsnprintf(__FILE__, __FUNCTION__, __LINE__,  m_errbuf, sizeof(m_errbuf),
-				"The amount of memory needed dump the file on disk is not enough");
+			// The fragment is returned without the newline at its end
+			if ((fwrite(PacketPtr, sizeof (char), PacketLength, DestFileHandle) != PacketLength) ||
+				(fwrite("\n", sizeof (char), 1, DestFileHandle) != 1))
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+					"Error writing data in the destination file");
 
-			return nbFAILURE;
+				return nbFAILURE;
+			}
 		}
+	}
+	else
+	{
+		// Move pointer to the beginning of the file
+		fseek(SourceFileHandle, 0, SEEK_SET);
 
-		if ( fwrite(BufferPtr, sizeof (char), BytesToWrite, DestFileHandle) != BytesToWrite)
+		for (unsigned i= 0; i< m_currNumPackets; i++)
 		{
-			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
-				"Error writing data in the destination file");
+			// move pointer to the beginning of the file
+			fseek(SourceFileHandle, m_packetList[i], SEEK_SET);
 
-			return nbFAILURE;
+			BytesToWrite= (int) fread(BufferPtr, sizeof(char), m_packetList[i+1] - m_packetList[i], SourceFileHandle);
+
+			if (BytesToWrite > BufferSize)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__,  m_errbuf, sizeof(m_errbuf),
+					"The amount of memory needed dump the file on disk is not enough");
+
+				return nbFAILURE;
+			}
+
+			if ( fwrite(BufferPtr, sizeof (char), BytesToWrite, DestFileHandle) != BytesToWrite)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+					"Error writing data in the destination file");
+
+				return nbFAILURE;
+			}
 		}
-	}
 
-	// move pointer to the end of the file
-	fseek(SourceFileHandle, 0, SEEK_END);
+		// move pointer to the end of the file
+		fseek(SourceFileHandle, 0, SEEK_END);
+	}
 
 	// Terminate the destination file
 	BytesToWrite= ssnprintf(BufferPtr, BufferSize, "%s%s%s", "</", m_rootXMLTag, ">\n");
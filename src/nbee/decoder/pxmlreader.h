@@ -26,6 +26,12 @@ XERCES_CPP_NAMESPACE_USE
 //! By default, we are able to keep track of 10000 packet stored on disk, then we have to enlarge the buffer
 #define PXML_MINIMUM_LIST_SIZE 10000
 
+//! Initial size of the in-memory spool; it is doubled each time it is full, up to PXML_SPOOL_MAX_SIZE (it must be a power of two)
+#define PXML_SPOOL_MIN_SIZE (1024 * 1024)
+
+//! Maximum size of the in-memory spool (it must be a power of two); when it is full, the oldest packets are discarded
+#define PXML_SPOOL_MAX_SIZE (256 * 1024 * 1024)
+
 
 
 /*!
@@ -33,6 +39,12 @@ XERCES_CPP_NAMESPACE_USE
 
 	Basically, this class helps in some functions (like dumping the XML document on file)
 	that are common throughout both classes.
+
+	When the packets come from the decoder, they can be kept either in a temp file (as XML fragments)
+	or in an in-memory spool. In the latter case, the derived classes store a record in their own
+	binary format, and generate the XML fragment only when it is requested.
+	The spool is a ring whose size is bounded to PXML_SPOOL_MAX_SIZE: when it is full, the oldest
+	packets are discarded (as if RemovePacket() were called on the first packet).
 */
 class CPxMLReader
 {
@@ -44,9 +56,16 @@ public:
 	int InitializeDecoder(nbPacketDecoder *NetBeePacketDecoder);
 
 	// Functions used by CPDMLMaker and CPSMLMaker
-	int InitializeParsForDump(const char *RootXMLTag, const char *InitText);
+	int InitializeParsForDump(const char *RootXMLTag, const char *InitText, bool KeepInMemory);
 	int StorePacket(char *Buffer, unsigned int BytesToWrite);
 
+	/*!
+		\brief It returns the XML fragment of a packet; it is implemented by the derived classes.
+
+		It is used to create the XML document when the packets are kept in the in-memory spool.
+	*/
+	virtual int GetPacketXML(unsigned long PacketNumber, char* &PacketPtr, unsigned int &PacketLength)= 0;
+
 	//! Handle to the file that is used to store temporary data on file when we're getting packets from the decoder
 	FILE *m_tempDumpFileHandle;
 
@@ -57,6 +76,7 @@ protected:
 	int SaveDocumentAs(const char *Filename);
 	int RemovePacket(unsigned long PacketNumber);
 	int GetXMLPacketFromDump(unsigned long PacketNumber, char *Buffer, unsigned int BufferSize, unsigned int &ValidData);
+	int GetPacketRecord(unsigned long PacketNumber, char* &Record, unsigned long &RecordSize);
 
 protected:
 
@@ -78,12 +98,30 @@ protected:
 	//! Handle to the PxML file that we have to open; used only when we want to open a PxML file from disk
 	FILE *m_sourceOnDiskFileHandle;
 
+	//! Buffer of the in-memory spool; NULL if packets are not kept in memory (offsets in 'm_packetList' refer to this ring)
+	char *m_spoolBuffer;
+
 	//! Buffer that keeps the error message (if any)
 	char m_errbuf[2048];
 
 private:
 	int InitializeDumpFile(FILE *DumpFileHandle);
 
+	int StoreInSpool(char *Buffer, unsigned int BytesToWrite);
+	int EnlargeSpool(unsigned long BytesNeeded);
+	void DiscardOldestPackets(unsigned long BytesNeeded);
+	void ReadFromSpool(unsigned long Offset, char *Buffer, unsigned long Length);
+	void WriteToSpool(unsigned long Offset, const char *Buffer, unsigned long Length);
+
+	//! Current size of the in-memory spool
+	unsigned long m_spoolSize;
+
+	//! Buffer that keeps the last record returned by GetPacketRecord() (records may wrap around the end of the spool)
+	char *m_recordBuffer;
+
+	//! Size of 'm_recordBuffer'
+	unsigned long m_recordBufferSize;
+
 	//! Keeps the tag which will be used as 'root' XML tag in the resulting document
 	char m_rootXMLTag[NETPDL_MAX_STRING];
 
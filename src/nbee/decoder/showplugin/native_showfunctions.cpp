@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "native_showfunctions.h"
+#include "../../utils/hexdump.h"
 #include "../../globals/globals.h"
 #include "../../globals/debug.h"
 
@@ -15,46 +16,23 @@
 // it takes into account of the '\\0' at tne end of the string
 int NativePrintIPv4Address(const unsigned char *FieldPacketPtr, char *FormattedField, unsigned long FormattedFieldSize, unsigned long *FormattedFieldLength, char *ErrBuf, int ErrBufSize)
 {
-unsigned long FormattedDigitSize;
-unsigned long FormattedBufferOffset;
-unsigned long Value;
-int i;
+char FormattedAddress[HEXDUMP_IPV4_MAX_LEN];
+unsigned long FormattedAddressLength;
 
-	FormattedBufferOffset= 0;
+	// '+1' because we need to take into account also the '\0' at the end
+	FormattedAddressLength= HexDumpFormatIPv4(FieldPacketPtr, FormattedAddress) + 1;
 
-	for (i= 0; i < 4; i++)
+	if (FormattedAddressLength > FormattedFieldSize)
 	{
-		Value= (int) FieldPacketPtr[i];
-
-		if (Value < 10)
-			FormattedDigitSize= 1;
-		else if (Value < 100)
-				FormattedDigitSize= 2;
-		else
-				FormattedDigitSize= 3;
-
-		// '+1' is tue to the possible "dot" after each digit
-		if ((FormattedBufferOffset + FormattedDigitSize + 1) > FormattedFieldSize)
-		{
-			*FormattedFieldLength= 0;
-			FormattedField[0]= 0;
-			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Internal error: the buffer required to print field value is too small.");
-			return nbFAILURE;
-		}
-
-		uint2a(Value, &FormattedField[FormattedBufferOffset]);
-
-		FormattedBufferOffset+= FormattedDigitSize;
-
-		if (i != 3)
-			FormattedField[FormattedBufferOffset] = '.';
-		else
-			FormattedField[FormattedBufferOffset] = '\0';
-
-		FormattedBufferOffset++;
+		*FormattedFieldLength= 0;
+		FormattedField[0]= 0;
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Internal error: the buffer required to print field value is too small.");
+		return nbFAILURE;
 	}
 
-	*FormattedFieldLength= FormattedBufferOffset;
+	memcpy(FormattedField, FormattedAddress, FormattedAddressLength);
+
+	*FormattedFieldLength= FormattedAddressLength;
 	return nbSUCCESS;
 }
 
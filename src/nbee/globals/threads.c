@@ -0,0 +1,193 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE			// for pthread_setaffinity_np()
+#endif
+
+#include <stdlib.h>
+#include "threads.h"
+#include "utils.h"
+#include "debug.h"
+#include "globals.h"
+
+
+//! Parameters that have to be delivered to the thread function; needed because of the different prototypes on each platform.
+struct _ThreadStartParams
+{
+	nbThreadFunction_t *ThreadFunction;
+	void *Param;
+};
+
+
+#ifdef WIN32
+static DWORD WINAPI ThreadStart(LPVOID Params)
+#else
+static void *ThreadStart(void *Params)
+#endif
+{
+struct _ThreadStartParams StartParams= *((struct _ThreadStartParams *) Params);
+
+	free(Params);
+
+	StartParams.ThreadFunction(StartParams.Param);
+
+	return 0;
+}
+
+
+int nbThreadCreate(nbThread_t *Thread, nbThreadFunction_t *ThreadFunction, void *Param, char *ErrBuf, int ErrBufSize)
+{
+struct _ThreadStartParams *StartParams;
+
+	StartParams= (struct _ThreadStartParams *) malloc(sizeof(struct _ThreadStartParams));
+	if (StartParams == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory to start a new thread.");
+		return nbFAILURE;
+	}
+
+	StartParams->ThreadFunction= ThreadFunction;
+	StartParams->Param= Param;
+
+#ifdef WIN32
+	*Thread= CreateThread(NULL, 0, ThreadStart, StartParams, 0, NULL);
+	if (*Thread == NULL)
+#else
+	if (pthread_create(Thread, NULL, ThreadStart, StartParams) != 0)
+#endif
+	{
+		free(StartParams);
+		nbGetLastErrorEx(__FILE__, __FUNCTION__, __LINE__, "Cannot create a new thread", ErrBuf, ErrBufSize);
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
+}
+
+
+void nbThreadJoin(nbThread_t Thread)
+{
+#ifdef WIN32
+	WaitForSingleObject(Thread, INFINITE);
+	CloseHandle(Thread);
+#else
+	pthread_join(Thread, NULL);
+#endif
+}
+
+
+int nbThreadSetAffinity(int CPU)
+{
+#if defined(WIN32)
+	if (SetThreadAffinityMask(GetCurrentThread(), ((DWORD_PTR) 1) << CPU) == 0)
+		return nbFAILURE;
+
+	return nbSUCCESS;
+#elif defined(__linux__)
+cpu_set_t CPUSet;
+
+	CPU_ZERO(&CPUSet);
+	CPU_SET(CPU, &CPUSet);
+
+	if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &CPUSet) != 0)
+		return nbFAILURE;
+
+	return nbSUCCESS;
+#else
+	return nbFAILURE;
+#endif
+}
+
+
+void nbMutexInit(nbMutex_t *Mutex)
+{
+#ifdef WIN32
+	InitializeCriticalSection(Mutex);
+#else
+	pthread_mutex_init(Mutex, NULL);
+#endif
+}
+
+
+void nbMutexDestroy(nbMutex_t *Mutex)
+{
+#ifdef WIN32
+	DeleteCriticalSection(Mutex);
+#else
+	pthread_mutex_destroy(Mutex);
+#endif
+}
+
+
+void nbMutexLock(nbMutex_t *Mutex)
+{
+#ifdef WIN32
+	EnterCriticalSection(Mutex);
+#else
+	pthread_mutex_lock(Mutex);
+#endif
+}
+
+
+void nbMutexUnlock(nbMutex_t *Mutex)
+{
+#ifdef WIN32
+	LeaveCriticalSection(Mutex);
+#else
+	pthread_mutex_unlock(Mutex);
+#endif
+}
+
+
+void nbConditionInit(nbCondition_t *Condition)
+{
+#ifdef WIN32
+	InitializeConditionVariable(Condition);
+#else
+	pthread_cond_init(Condition, NULL);
+#endif
+}
+
+
+void nbConditionDestroy(nbCondition_t *Condition)
+{
+#ifndef WIN32
+	// Win32 condition variables do not need to be deleted
+	pthread_cond_destroy(Condition);
+#endif
+}
+
+
+void nbConditionWait(nbCondition_t *Condition, nbMutex_t *Mutex)
+{
+#ifdef WIN32
+	SleepConditionVariableCS(Condition, Mutex, INFINITE);
+#else
+	pthread_cond_wait(Condition, Mutex);
+#endif
+}
+
+
+void nbConditionSignal(nbCondition_t *Condition)
+{
+#ifdef WIN32
+	WakeConditionVariable(Condition);
+#else
+	pthread_cond_signal(Condition);
+#endif
+}
+
+
+void nbConditionBroadcast(nbCondition_t *Condition)
+{
+#ifdef WIN32
+	WakeAllConditionVariable(Condition);
+#else
+	pthread_cond_broadcast(Condition);
+#endif
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+// Allow including this file only once
+#pragma once
+
+
+/*!
+	\file threads.h
+
+	Minimal wrappers around the threading primitives of the operating system (Win32 threads
+	on Windows, POSIX threads elsewhere), so that the rest of the library does not have to
+	care about the platform it is running on.
+*/
+
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifdef WIN32
+typedef HANDLE nbThread_t;
+typedef CRITICAL_SECTION nbMutex_t;
+typedef CONDITION_VARIABLE nbCondition_t;
+#else
+typedef pthread_t nbThread_t;
+typedef pthread_mutex_t nbMutex_t;
+typedef pthread_cond_t nbCondition_t;
+#endif
+
+
+//! Prototype of the function executed by a thread created through nbThreadCreate().
+typedef void (nbThreadFunction_t)(void *Param);
+
+
+/*!
+	\brief Creates a new thread that executes 'ThreadFunction(Param)'.
+
+	\param Thread Pointer to the variable that will keep the handle of the new thread.
+	\param ThreadFunction Function executed by the new thread.
+	\param Param Parameter passed to 'ThreadFunction'.
+	\param ErrBuf User-allocated buffer that will keep the error message (if any).
+	\param ErrBufSize Size of the 'ErrBuf' buffer.
+
+	\return nbSUCCESS if the thread has been created, nbFAILURE otherwise.
+*/
+int nbThreadCreate(nbThread_t *Thread, nbThreadFunction_t *ThreadFunction, void *Param, char *ErrBuf, int ErrBufSize);
+
+//! Waits for the termination of the given thread and releases its resources.
+void nbThreadJoin(nbThread_t Thread);
+
+/*!
+	\brief Binds the calling thread to the given CPU.
+
+	\return nbSUCCESS if the thread has been bound, nbFAILURE if the operation failed or it is
+	not supported on this platform.
+*/
+int nbThreadSetAffinity(int CPU);
+
+void nbMutexInit(nbMutex_t *Mutex);
+void nbMutexDestroy(nbMutex_t *Mutex);
+void nbMutexLock(nbMutex_t *Mutex);
+void nbMutexUnlock(nbMutex_t *Mutex);
+
+void nbConditionInit(nbCondition_t *Condition);
+void nbConditionDestroy(nbCondition_t *Condition);
+
+//! Waits on the condition; the mutex must be held by the caller, and it is held again on return.
+void nbConditionWait(nbCondition_t *Condition, nbMutex_t *Mutex);
+void nbConditionSignal(nbCondition_t *Condition);
+void nbConditionBroadcast(nbCondition_t *Condition);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,6 +21,8 @@
 #include <nbee_packetengine.h>
 #include <nbee_extractedfieldreader.h>
 #include "../nbpacketengine/nbeepacketengine.h"
+#include "../nbpacketengine/nbeeparallelpacketengine.h"
+#include "../nbpacketengine/compilecache.h"
 
 #include "../globals/profiling.h"
 
@@ -278,7 +280,11 @@ int WinPcapMinor;
 
 	if (NetPDLFileLocation != NULL)
 	{
-		NetPDLDatabase= nbProtoDBXMLLoad(NetPDLFileLocation, Flags, ErrBuf, ErrBufSize);
+		// Binary images of the database do not need to be parsed
+		if (nbProtoDBIsImage(NetPDLFileLocation) == nbSUCCESS)
+			NetPDLDatabase= nbProtoDBImageLoad(NetPDLFileLocation, Flags, ErrBuf, ErrBufSize);
+		else
+			NetPDLDatabase= nbProtoDBXMLLoad(NetPDLFileLocation, Flags, ErrBuf, ErrBufSize);
 
 		if (NetPDLDatabase == NULL)
 			return nbFAILURE;
@@ -329,6 +335,7 @@ void nbCleanup()
 {
 	if (NetPDLDatabase)
 	{
+		CleanupNetPDLInternalStructures();
 		nbProtoDBXMLCleanup();
 		NetPDLDatabase= NULL;
 	}
@@ -355,6 +362,7 @@ int nbUpdateNetPDLDescription(const char *NetPDLFileLocation, char *ErrBuf, int
 {
 	if (NetPDLDatabase)
 	{
+		CleanupNetPDLInternalStructures();
 		nbProtoDBXMLCleanup();
 		NetPDLDatabase= NULL;
 	}
@@ -489,6 +497,41 @@ void nbDeallocatePacketEngine(nbPacketEngine *PacketEngine)
 }
 
 
+nbParallelPacketEngine *nbAllocateParallelPacketEngine(int NumWorkers, bool UseJit, char *ErrBuf, int ErrBufSize)
+{
+	if (NetPDLDatabase == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+			"The NetPDL database is not valid.");
+		return NULL;
+	}
+
+	if (NumWorkers <= 0)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+			"The number of workers must be greater than zero.");
+		return NULL;
+	}
+
+	nbeeParallelPacketEngine* ParallelPacketEngine= new nbeeParallelPacketEngine(NetPDLDatabase, NumWorkers, UseJit);
+
+	return (nbParallelPacketEngine*) ParallelPacketEngine;
+}
+
+
+void nbDeallocateParallelPacketEngine(nbParallelPacketEngine *ParallelPacketEngine)
+{
+	if (ParallelPacketEngine)
+		delete ParallelPacketEngine;
+}
+
+
+int nbSetCompileCache(unsigned int MaxEntries, const char *CacheDir, char *ErrBuf, int ErrBufSize)
+{
+	return nbeeCompileCacheSetup(MaxEntries, CacheDir, ErrBuf, ErrBufSize);
+}
+
+
 nbProfiler *nbAllocateProfiler(char *ErrBuf, int ErrBufSize)
 {
 	nbProfiler* Profiler= new CProfilingExecTime();
@@ -217,6 +217,11 @@ unsigned int ProtoIndex;
 		if (InitVariablesInExpression(Expression, NetPDLVariables, ErrBuf, ErrBufSize) == nbFAILURE)
 			return nbFAILURE;
 
+		// Compile the expression, unless another decoder did it already; expressions that cannot
+		// be compiled are left as they are and they will be evaluated by walking their tree
+		if (Expression->CompiledCode == NULL)
+			Expression->CompiledCode= CNetPDLExpression::CompileExpression(Expression);
+
 		Expression= Expression->NextExpression;
 	}
 
@@ -536,3 +541,25 @@ int RetVal;
 	return nbSUCCESS;
 }
 
+
+/*!
+	\brief Deletes the code of the expressions that has been compiled by InitializeNetPDLInternalStructures().
+
+	It must be called before the NetPDL database is deallocated.
+*/
+void CleanupNetPDLInternalStructures()
+{
+struct _nbNetPDLExprBase* Expression;
+
+	if (NetPDLDatabase == NULL)
+		return;
+
+	for (Expression= NetPDLDatabase->ExpressionList; Expression != NULL; Expression= Expression->NextExpression)
+	{
+		if (Expression->CompiledCode)
+		{
+			CNetPDLExpression::FreeCompiledExpression((struct _nbNetPDLExprCode *) Expression->CompiledCode);
+			Expression->CompiledCode= NULL;
+		}
+	}
+}
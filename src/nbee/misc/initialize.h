@@ -8,3 +8,4 @@
 
 int InitializeNetPDLPlugins(char *ErrBuf, int ErrBufSize);
 int InitializeNetPDLInternalStructures(CNetPDLExpression *ExprHandler, CNetPDLVariables *NetPDLVariables, char *ErrBuf, int ErrBufSize);
+void CleanupNetPDLInternalStructures();
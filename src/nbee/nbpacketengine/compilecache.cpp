@@ -0,0 +1,525 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#include "compilecache.h"
+#include "../globals/globals.h"
+#include "../globals/utils.h"
+#include "../globals/debug.h"
+#include "../globals/threads.h"
+#include <nbee_initcleanup.h>
+#include <stdio.h>
+#include <string.h>
+#include <list>
+#include <map>
+
+using namespace std;
+
+
+//! Signature of the files of the cache directory ('NBFC')
+#define COMPILECACHE_FILE_MAGIC 0x4346424E
+
+//! Version of the format of the files of the cache directory
+#define COMPILECACHE_FILE_VERSION 1
+
+
+//! Entry of the in-memory cache
+struct _CompileCacheEntry
+{
+	string Key;
+	nbeeCompiledFilter Filter;
+};
+
+typedef list<_CompileCacheEntry> _CompileCacheList;
+typedef map<string, _CompileCacheList::iterator> _CompileCacheIndex;
+
+
+static nbMutex_t CacheLock;
+static bool CacheLockInited= false;
+static bool CacheEnabled= false;
+static unsigned int CacheMaxEntries= 0;
+static string CacheDir;
+
+//! Entries, from the most to the least recently used
+static _CompileCacheList CacheList;
+static _CompileCacheIndex CacheIndex;
+
+
+
+void nbeeCompiledFilter::Set(const char *Code, nvmByteCode *Image, _nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector)
+{
+const void *ImageData;
+uint32_t ImageSize;
+
+	NetILCode= Code;
+
+	ImageData= nvmGetBytecodeImage(Image, &ImageSize);
+	Bytecode.assign((const unsigned char *) ImageData, (const unsigned char *) ImageData + ImageSize);
+
+	Fields.resize(ExtractedFieldsDescriptorVector->NumEntries);
+
+	for (int i= 0; i < ExtractedFieldsDescriptorVector->NumEntries; i++)
+	{
+	_nbExtractedFieldsDescriptor *Descriptor= &ExtractedFieldsDescriptorVector->FieldDescriptor[i];
+
+		Fields[i].DataFormatType= Descriptor->DataFormatType;
+		Fields[i].FieldType= Descriptor->FieldType;
+		Fields[i].Length= Descriptor->Length;
+		Fields[i].Position= Descriptor->Position;
+		Fields[i].Name= Descriptor->Name;
+		Fields[i].Proto= Descriptor->Proto;
+	}
+}
+
+
+_nbExtractedFieldsDescriptorVector *nbeeCompiledFilter::CreateFieldsDescriptors()
+{
+_nbExtractedFieldsDescriptorVector *Descriptors;
+
+	Descriptors= new _nbExtractedFieldsDescriptorVector((int) Fields.size());
+
+	for (unsigned int i= 0; i < Fields.size(); i++)
+	{
+	_nbExtractedFieldsDescriptor *Descriptor= &Descriptors->FieldDescriptor[i];
+	int Instances= 0;
+
+		Descriptor->DataFormatType= Fields[i].DataFormatType;
+		Descriptor->FieldType= Fields[i].FieldType;
+		Descriptor->Length= Fields[i].Length;
+		Descriptor->Position= Fields[i].Position;
+		Descriptor->Name= Fields[i].Name.c_str();
+		Descriptor->Proto= Fields[i].Proto.c_str();
+
+		// Same layout of the descriptors created by the compiler
+		switch (Fields[i].DataFormatType)
+		{
+			case nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO:
+				Instances= nbNETPFLCOMPILER_MAX_PROTO_INSTANCES;
+				break;
+
+			case nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD:
+				Instances= nbNETPFLCOMPILER_MAX_FIELD_INSTANCES;
+				break;
+
+			case nbNETPFLCOMPILER_DATAFORMAT_FIELDLIST:
+				Descriptor->DVct= new _nbExtractedFieldsDescriptorVector(nbNETPFLCOMPILER_MAX_ALLFIELDS);
+				break;
+
+			default:
+				break;
+		}
+
+		if (Instances > 0)
+		{
+			Descriptor->DVct= new _nbExtractedFieldsDescriptorVector(Instances);
+
+			for (int k= 0; k < Instances; k++)
+			{
+				Descriptor->DVct->FieldDescriptor[k].DataFormatType= Descriptor->DataFormatType;
+				Descriptor->DVct->FieldDescriptor[k].Name= Descriptor->Name;
+				Descriptor->DVct->FieldDescriptor[k].Proto= Descriptor->Proto;
+				Descriptor->DVct->FieldDescriptor[k].FieldType= Descriptor->FieldType;
+			}
+		}
+	}
+
+	return Descriptors;
+}
+
+
+bool nbeeCompiledFilter::HasAllFields()
+{
+	for (unsigned int i= 0; i < Fields.size(); i++)
+	{
+		if (Fields[i].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+			return true;
+	}
+
+	return false;
+}
+
+
+void nbeeCompiledFilter::Swap(nbeeCompiledFilter &Filter)
+{
+	NetILCode.swap(Filter.NetILCode);
+	Bytecode.swap(Filter.Bytecode);
+	Fields.swap(Filter.Fields);
+}
+
+
+void nbeeCompiledFilter::Clear()
+{
+	NetILCode.clear();
+	Bytecode.clear();
+	Fields.clear();
+}
+
+
+
+/*
+	The key contains everything the generated code depends on. The build date is part of it, since
+	a different build of the library may generate different code for the same filter.
+*/
+static string GetCacheKey(struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt)
+{
+char Prefix[256];
+
+	ssnprintf(Prefix, sizeof(Prefix), "NetPFL %d.%d.%d %s %s|%d|%d|%d|%08X%08X|%X|",
+		NETBEE_VERSION_MAJOR, NETBEE_VERSION_MINOR, NETBEE_VERSION_REVCODE, __DATE__, __TIME__,
+		(int) sizeof(void *), (int) LinkLayer, Opt ? 1 : 0,
+		(unsigned int) (NetPDLDatabase->Fingerprint >> 32), (unsigned int) NetPDLDatabase->Fingerprint,
+		NetPDLDatabase->Flags);
+
+	return string(Prefix) + NetPFLFilterString;
+}
+
+
+// Name of the file that keeps the entry in the cache directory (FNV-1a hash of the key)
+static string GetCacheFileName(const string &Key)
+{
+uint64_t Hash= 0xCBF29CE484222325ULL;
+char FileName[32];
+
+	for (unsigned int i= 0; i < Key.size(); i++)
+	{
+		Hash^= (unsigned char) Key[i];
+		Hash*= 0x100000001B3ULL;
+	}
+
+	ssnprintf(FileName, sizeof(FileName), "%08X%08X.nfc", (unsigned int) (Hash >> 32), (unsigned int) Hash);
+
+	return CacheDir + "/" + FileName;
+}
+
+
+static bool WriteBlock(FILE *File, const void *Data, uint32_t Size)
+{
+	if (fwrite(&Size, sizeof(Size), 1, File) != 1)
+		return false;
+
+	return (Size == 0) || (fwrite(Data, Size, 1, File) == 1);
+}
+
+
+static bool ReadUInt32(FILE *File, uint32_t *Value)
+{
+	return (fread(Value, sizeof(uint32_t), 1, File) == 1);
+}
+
+
+// Blocks cannot be larger than the data left in the file, so a corrupted file cannot make us allocate too much memory
+static bool ReadBlock(FILE *File, long FileSize, string &Data)
+{
+uint32_t Size;
+
+	if (!ReadUInt32(File, &Size) || ((long) Size > FileSize - ftell(File)))
+		return false;
+
+	Data.resize(Size);
+	return (Size == 0) || (fread(&Data[0], Size, 1, File) == 1);
+}
+
+
+static bool LoadCacheFile(const string &Key, nbeeCompiledFilter &Filter)
+{
+FILE *File;
+long FileSize;
+uint32_t Magic, Version, NumFields;
+string Data;
+bool Found= false;
+
+	File= fopen(GetCacheFileName(Key).c_str(), "rb");
+	if (File == NULL)
+		return false;
+
+	fseek(File, 0, SEEK_END);
+	FileSize= ftell(File);
+	fseek(File, 0, SEEK_SET);
+
+	if (!ReadUInt32(File, &Magic) || (Magic != COMPILECACHE_FILE_MAGIC) || !ReadUInt32(File, &Version) || (Version != COMPILECACHE_FILE_VERSION))
+		goto Exit;
+
+	// Different keys may have the same hash
+	if (!ReadBlock(File, FileSize, Data) || (Data != Key))
+		goto Exit;
+
+	if (!ReadBlock(File, FileSize, Filter.NetILCode))
+		goto Exit;
+
+	if (!ReadBlock(File, FileSize, Data))
+		goto Exit;
+	Filter.Bytecode.assign(Data.begin(), Data.end());
+
+	if (!ReadUInt32(File, &NumFields) || ((long) NumFields > FileSize - ftell(File)))
+		goto Exit;
+
+	Filter.Fields.resize(NumFields);
+	for (uint32_t i= 0; i < NumFields; i++)
+	{
+	uint32_t Values[4];
+
+		if (fread(Values, sizeof(Values), 1, File) != 1)
+			goto Exit;
+
+		Filter.Fields[i].DataFormatType= (nbExtractedFieldsDataFormat_t) Values[0];
+		Filter.Fields[i].FieldType= (nbExtractedFieldsFieldType_t) Values[1];
+		Filter.Fields[i].Length= (int) Values[2];
+		Filter.Fields[i].Position= Values[3];
+
+		if (!ReadBlock(File, FileSize, Filter.Fields[i].Name) || !ReadBlock(File, FileSize, Filter.Fields[i].Proto))
+			goto Exit;
+	}
+
+	Found= true;
+
+Exit:
+	fclose(File);
+
+	if (!Found)
+		Filter.Clear();
+
+	return Found;
+}
+
+
+// The file is written under a temporary name and then renamed, so that other processes never see it half written
+static void SaveCacheFile(const string &Key, const nbeeCompiledFilter &Filter)
+{
+string FileName= GetCacheFileName(Key);
+string TempFileName= FileName + ".tmp";
+FILE *File;
+uint32_t Header[2]= { COMPILECACHE_FILE_MAGIC, COMPILECACHE_FILE_VERSION };
+uint32_t NumFields= (uint32_t) Filter.Fields.size();
+bool Written;
+
+	File= fopen(TempFileName.c_str(), "wb");
+	if (File == NULL)
+		return;
+
+	Written= (fwrite(Header, sizeof(Header), 1, File) == 1) &&
+		WriteBlock(File, Key.data(), (uint32_t) Key.size()) &&
+		WriteBlock(File, Filter.NetILCode.data(), (uint32_t) Filter.NetILCode.size()) &&
+		WriteBlock(File, Filter.Bytecode.empty() ? NULL : &Filter.Bytecode[0], (uint32_t) Filter.Bytecode.size()) &&
+		(fwrite(&NumFields, sizeof(NumFields), 1, File) == 1);
+
+	for (uint32_t i= 0; Written && (i < NumFields); i++)
+	{
+	uint32_t Values[4];
+
+		Values[0]= (uint32_t) Filter.Fields[i].DataFormatType;
+		Values[1]= (uint32_t) Filter.Fields[i].FieldType;
+		Values[2]= (uint32_t) Filter.Fields[i].Length;
+		Values[3]= Filter.Fields[i].Position;
+
+		Written= (fwrite(Values, sizeof(Values), 1, File) == 1) &&
+			WriteBlock(File, Filter.Fields[i].Name.data(), (uint32_t) Filter.Fields[i].Name.size()) &&
+			WriteBlock(File, Filter.Fields[i].Proto.data(), (uint32_t) Filter.Fields[i].Proto.size());
+	}
+
+	if (fclose(File) != 0)
+		Written= false;
+
+#ifdef WIN32
+	// On Windows, rename() does not replace an existing file
+	if (Written)
+		remove(FileName.c_str());
+#endif
+
+	if (!Written || (rename(TempFileName.c_str(), FileName.c_str()) != 0))
+		remove(TempFileName.c_str());
+}
+
+
+// Adds an entry to the in-memory cache, removing the least recently used ones if needed. The lock must be held.
+static void InsertEntry(const string &Key, const nbeeCompiledFilter &Filter)
+{
+_CompileCacheIndex::iterator It;
+
+	if (CacheMaxEntries == 0)
+		return;
+
+	It= CacheIndex.find(Key);
+	if (It != CacheIndex.end())
+	{
+		CacheList.erase(It->second);
+		CacheIndex.erase(It);
+	}
+
+	CacheList.push_front(_CompileCacheEntry());
+	CacheList.front().Key= Key;
+	CacheList.front().Filter= Filter;
+	CacheIndex[Key]= CacheList.begin();
+
+	while (CacheList.size() > CacheMaxEntries)
+	{
+		CacheIndex.erase(CacheList.back().Key);
+		CacheList.pop_back();
+	}
+}
+
+
+
+int nbeeCompileCacheSetup(unsigned int MaxEntries, const char *Dir, char *ErrBuf, int ErrBufSize)
+{
+	if ((Dir != NULL) && (Dir[0] != '\0'))
+	{
+	string TestFileName= string(Dir) + "/.nbee-compile-cache";
+	FILE *File;
+
+		// Better to complain now than to silently lose all the entries later
+		File= fopen(TestFileName.c_str(), "wb");
+		if (File == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+				"The compile cache directory '%s' does not exist or is not writable.", Dir);
+			return nbFAILURE;
+		}
+		fclose(File);
+		remove(TestFileName.c_str());
+	}
+
+	if (!CacheLockInited)
+	{
+		nbMutexInit(&CacheLock);
+		CacheLockInited= true;
+	}
+
+	nbMutexLock(&CacheLock);
+
+	CacheMaxEntries= MaxEntries;
+	CacheDir= (Dir != NULL) ? Dir : "";
+	CacheEnabled= (CacheMaxEntries > 0) || !CacheDir.empty();
+
+	while (CacheList.size() > CacheMaxEntries)
+	{
+		CacheIndex.erase(CacheList.back().Key);
+		CacheList.pop_back();
+	}
+
+	nbMutexUnlock(&CacheLock);
+
+	return nbSUCCESS;
+}
+
+
+bool nbeeCompileCacheEnabled()
+{
+	return CacheEnabled;
+}
+
+
+bool nbeeCompileCacheLookup(struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	nbNetPDLLinkLayer_t LinkLayer, bool Opt, nbeeCompiledFilter &Filter)
+{
+string Key;
+_CompileCacheIndex::iterator It;
+bool Found= false;
+
+	// Without a fingerprint we cannot tell whether the database changed
+	if (!CacheEnabled || (NetPDLDatabase->Fingerprint == 0))
+		return false;
+
+	Key= GetCacheKey(NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt);
+
+	nbMutexLock(&CacheLock);
+
+	It= CacheIndex.find(Key);
+	if (It != CacheIndex.end())
+	{
+		// Move the entry in front of the list
+		CacheList.splice(CacheList.begin(), CacheList, It->second);
+		Filter= It->second->Filter;
+		Found= true;
+	}
+	else if (!CacheDir.empty() && LoadCacheFile(Key, Filter))
+	{
+		InsertEntry(Key, Filter);
+		Found= true;
+	}
+
+	nbMutexUnlock(&CacheLock);
+
+	return Found;
+}
+
+
+void nbeeCompileCacheStore(struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	nbNetPDLLinkLayer_t LinkLayer, bool Opt, const nbeeCompiledFilter &Filter)
+{
+string Key;
+
+	if (!CacheEnabled || (NetPDLDatabase->Fingerprint == 0))
+		return;
+
+	Key= GetCacheKey(NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt);
+
+	nbMutexLock(&CacheLock);
+
+	InsertEntry(Key, Filter);
+
+	if (!CacheDir.empty())
+		SaveCacheFile(Key, Filter);
+
+	nbMutexUnlock(&CacheLock);
+}
+
+
+int nbeeCompileProgram(nbNetPFLCompiler *Compiler, struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	const vector<string> *FilterSet, nbNetPDLLinkLayer_t LinkLayer, bool Opt, nbeeCompiledFilter &Program,
+	char *ErrBuf, int ErrBufSize)
+{
+char *NetILCode= NULL;
+char NetVMErrBuf[nvmERRBUF_SIZE];
+nvmByteCode *Bytecode;
+bool Cached;
+int RetVal;
+
+	Cached= nbeeCompileCacheLookup(NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, Program);
+
+	// A cached filter needs the compiler only for decoding 'allfields'
+	if (Cached && !Program.HasAllFields())
+		return nbSUCCESS;
+
+	if (Compiler->IsInitialized() != nbSUCCESS)
+	{
+		if (Compiler->NetPDLInit(LinkLayer) != nbSUCCESS)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, Compiler->GetLastError());
+			return nbFAILURE;
+		}
+	}
+
+	if (Cached)
+		return nbSUCCESS;
+
+	if (FilterSet)
+		RetVal= Compiler->CompileFilterSet(*FilterSet, &NetILCode, Opt);
+	else
+		RetVal= Compiler->CompileFilter(NetPFLFilterString, &NetILCode, Opt);
+
+	if (RetVal != nbSUCCESS)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, Compiler->GetLastError());
+		return nbFAILURE;
+	}
+
+	Bytecode= nvmAssembleNetILFromBuffer(NetILCode, NetVMErrBuf);
+	if (Bytecode == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, NetVMErrBuf);
+		return nbFAILURE;
+	}
+
+	// The descriptors are copied, so that the program does not refer to the compiler anymore
+	Program.Set(NetILCode, Bytecode, Compiler->GetExtractField());
+
+	nvmDestroyBytecode(Bytecode);
+	free(Bytecode);
+
+	nbeeCompileCacheStore(NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, Program);
+
+	return nbSUCCESS;
+}
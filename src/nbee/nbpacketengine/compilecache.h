@@ -0,0 +1,119 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#pragma once
+
+
+/*!
+	\file compilecache.h
+
+	Process-wide cache of compiled NetPFL filters, shared by all the packet engines.
+
+	Compiling a filter (NetPFL front-end, optimizations, NetIL generation and assembly) is by far
+	the most expensive step of the creation of a packet engine; applications that create many engines
+	on the same filter (e.g. one per interface or per thread) pay it only once when the cache is enabled.
+	Entries are kept in memory with a LRU policy and, optionally, in a directory on disk, so that they
+	survive across runs. Each entry is identified by the filter string, the link layer, the optimization
+	flag and the fingerprint of the NetPDL database, hence a modified database never returns stale code.
+*/
+
+
+#include <nbee.h>
+#include <nbnetvm.h>
+#include <string>
+#include <vector>
+
+
+//! Extracted field, as stored in a compiled filter
+struct nbeeCompiledField
+{
+	nbExtractedFieldsDataFormat_t DataFormatType;	//!< Type of field descriptor
+	nbExtractedFieldsFieldType_t FieldType;			//!< Field type
+	int Length;										//!< Field length (only for fixed fields)
+	uint32_t Position;								//!< Position of the field in the info partition
+	std::string Name;								//!< Protocol field name
+	std::string Proto;								//!< Protocol name
+};
+
+
+/*!
+	\brief Everything a packet engine needs for running a filter, without going through the compiler.
+
+	The object owns all its data; descriptors created by CreateFieldsDescriptors() refer to the
+	strings kept here, hence they must be released before the object is modified or destroyed.
+*/
+class nbeeCompiledFilter
+{
+public:
+	std::string NetILCode;					//!< NetIL code of the filter
+	std::vector<unsigned char> Bytecode;	//!< Bytecode image (see nvmGetBytecodeImage())
+	std::vector<nbeeCompiledField> Fields;	//!< Fields extracted by the filter
+
+	/*!
+		\brief Fills the object with the result of a compilation.
+
+		\param Code NetIL code generated by the compiler.
+		\param Image Bytecode assembled from the NetIL code.
+		\param ExtractedFieldsDescriptorVector Descriptors returned by the compiler.
+	*/
+	void Set(const char *Code, nvmByteCode *Image, _nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector);
+
+	/*!
+		\brief Creates the descriptors of the extracted fields, as nbNetPFLCompiler::GetExtractField() does.
+		The caller (usually a nbeeFieldReader) owns the returned vector.
+	*/
+	_nbExtractedFieldsDescriptorVector *CreateFieldsDescriptors();
+
+	//! Returns 'true' if the filter extracts 'allfields', which need the compiler for decoding the fields.
+	bool HasAllFields();
+
+	void Swap(nbeeCompiledFilter &Filter);
+	void Clear();
+};
+
+
+/*!
+	\brief Configures the cache (see nbSetCompileCache()).
+
+	\return nbSUCCESS or nbFAILURE; in case of failure, the error message is returned into the ErrBuf buffer.
+*/
+int nbeeCompileCacheSetup(unsigned int MaxEntries, const char *CacheDir, char *ErrBuf, int ErrBufSize);
+
+//! Returns 'true' if compiled filters are cached.
+bool nbeeCompileCacheEnabled();
+
+/*!
+	\brief Looks for a compiled filter, first in memory and then on disk.
+
+	\param Filter Object that receives a copy of the cached filter, in case of success.
+
+	\return 'true' if the filter has been found.
+*/
+bool nbeeCompileCacheLookup(struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	nbNetPDLLinkLayer_t LinkLayer, bool Opt, nbeeCompiledFilter &Filter);
+
+//! Adds a compiled filter to the cache (and to the cache directory, if any).
+void nbeeCompileCacheStore(struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	nbNetPDLLinkLayer_t LinkLayer, bool Opt, const nbeeCompiledFilter &Filter);
+
+/*!
+	\brief Compiles a filter into a self-contained nbeeCompiledFilter, going through the cache if it is enabled.
+
+	Nothing that belongs to the program currently run by a packet engine is modified, so this is used
+	for preparing the program that replaces it. The compiler is initialized on 'LinkLayer' if needed
+	(otherwise it must have been initialized on the same link layer) and it is left initialized, so that
+	the next compilation does not load the NetPDL database again.
+
+	\param NetPFLFilterString Filter to be compiled; in case of a filter set, it is used only as the key of the cache.
+	\param FilterSet Members of the filter set (see nbNetPFLCompiler::CompileFilterSet()), or NULL for a single filter.
+	\param Program Object that receives the compiled filter.
+
+	\return nbSUCCESS or nbFAILURE; in case of failure, the error message is returned into the ErrBuf buffer.
+*/
+int nbeeCompileProgram(nbNetPFLCompiler *Compiler, struct _nbNetPDLDatabase *NetPDLDatabase, const char *NetPFLFilterString,
+	const std::vector<std::string> *FilterSet, nbNetPDLLinkLayer_t LinkLayer, bool Opt, nbeeCompiledFilter &Program,
+	char *ErrBuf, int ErrBufSize);
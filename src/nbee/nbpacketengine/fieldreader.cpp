@@ -9,7 +9,8 @@
 
 
 nbeeFieldReader::nbeeFieldReader(_nbExtractedFieldsDescriptorVector* ndescriptorVct, unsigned char* dataInfo, nbNetPFLCompiler *compiler):
-FieldDescriptorsVector(ndescriptorVct), DataInfo(dataInfo), m_Compiler(compiler), FieldVector(FieldDescriptorsVector->NumEntries, 0)
+FieldDescriptorsVector(ndescriptorVct), DataInfo(dataInfo), m_Compiler(compiler), FieldVector(FieldDescriptorsVector->NumEntries, 0),
+LazyDecoding(false), Generation(1), FieldGeneration(FieldDescriptorsVector->NumEntries, 0)
 {
 string FieldName;
 
@@ -34,27 +35,76 @@ string FieldName;
 
 nbeeFieldReader::~nbeeFieldReader()
 {
+	// The vectors of the multi-instance fields and of 'allfields' belong to the descriptors as well
+	for (int i= 0; i < FieldDescriptorsVector->NumEntries; i++)
+		delete FieldDescriptorsVector->FieldDescriptor[i].DVct;
+
 	delete FieldDescriptorsVector;
 }
 
 
+void nbeeFieldReader::SetDataInfo(unsigned char *dataInfo)
+{
+	DataInfo= dataInfo;
+
+	// Invalidates all the descriptors at once; in the (unlikely) case of wrap around, we must restart from scratch
+	Generation++;
+	if (Generation == 0)
+	{
+		FieldGeneration.assign(FieldGeneration.size(), 0);
+		Generation= 1;
+	}
+
+	if ((LazyDecoding == false) && (DataInfo != NULL))
+		FillDescriptors();
+}
+
+
+void nbeeFieldReader::SetLazyDecoding(bool Lazy)
+{
+	LazyDecoding= Lazy;
+
+	// When going back to eager decoding, the descriptors of the current packet must be complete
+	if (LazyDecoding == false)
+		LoadDescriptors();
+}
+
+
+int nbeeFieldReader::GetFieldHandle(string FieldName)
+{
+_FieldNamesTable::iterator Iterator;
+
+	Iterator= FieldNamesTable.find(FieldName);
+
+	if (Iterator == FieldNamesTable.end())
+		return nbFAILURE;
+
+	return Iterator->second;
+}
+
+
 _nbExtractedFieldsDescriptor* nbeeFieldReader::GetField(string FieldName)
 {
 int Index;
 
-	Index= FieldNamesTable.count(FieldName);
+	Index= GetFieldHandle(FieldName);
 
-	if (Index == 1)
-		return &(FieldDescriptorsVector->FieldDescriptor[FieldNamesTable[FieldName]]);
+	if (Index == nbFAILURE)
+		return NULL;
 
-	return NULL;
+	LoadDescriptor(Index);
+
+	return &(FieldDescriptorsVector->FieldDescriptor[Index]);
 }
 
 
 _nbExtractedFieldsDescriptor* nbeeFieldReader::GetField(int Index)
 {
 	if ((Index >= 0) && (Index < FieldDescriptorsVector->NumEntries))
+	{
+		LoadDescriptor(Index);
 		return &(FieldDescriptorsVector->FieldDescriptor[Index]);
+	}
 
 	return NULL;
 }
@@ -62,131 +112,131 @@ _nbExtractedFieldsDescriptor* nbeeFieldReader::GetField(int Index)
 
 _nbExtractedFieldsDescriptorVector* nbeeFieldReader::GetFields()
 {
+	LoadDescriptors();
+
 	return FieldDescriptorsVector;
 }
 
 
 void nbeeFieldReader::FillDescriptors()
-{	
+{
 	for (int index=0; index < FieldDescriptorsVector->NumEntries; index++)
 	{
-		if (FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
-		{			
-			int n = *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-			
-			FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
-			FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
+		FillDescriptor(index);
+		FieldGeneration[index]= Generation;
+	}
+}
+
 
-			if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct != NULL))
+void nbeeFieldReader::FillDescriptor(int index)
+{
+	if (FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+	{			
+		int n = *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+		
+		FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
+		FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
+
+		if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct != NULL))
+		{
+			
+			for (int i=0; i < n; i++)
 			{
-				
-				for (int i=0; i < n; i++)
-				{
-					int id= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 2 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
+				int id= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 2 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
 
-					int res= m_Compiler->GetFieldInfo(FieldDescriptorsVector->FieldDescriptor[index].Proto, id, &FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i]);
-					if (res == nbSUCCESS)
+				int res= m_Compiler->GetFieldInfo(FieldDescriptorsVector->FieldDescriptor[index].Proto, id, &FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i]);
+				if (res == nbSUCCESS)
+				{
+					if (FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].FieldType == PDL_FIELD_TYPE_BIT)
 					{
-						if (FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].FieldType == PDL_FIELD_TYPE_BIT)
-						{
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].BitField_Value= *(uint16_t *) &(DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL]);
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
-						}
-						else
-						{
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
-						}
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].BitField_Value= *(uint16_t *) &(DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL]);
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
+					}
+					else
+					{
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE_ALL];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
 					}
 				}
 			}
 		}
-		else
-		{	
-			if (FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_FIXED)
+	}
+	else
+	{	
+		if (FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_FIXED)
+		{
+			if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) ||
+				(FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
 			{
-				if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) ||
-					(FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
+				int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+				FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
+				FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
+				if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
 				{
-					int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-					FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
-					FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
-					if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
+					for (int i=0; i < n; i++)
 					{
-						for (int i=0; i < n; i++)
-						{
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=false;
-							if (FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length>0)
-								FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
-						}
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=false;
+						if (FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length>0)
+							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid=true;
 					}
 				}
-				else
-				{
-					FieldDescriptorsVector->FieldDescriptor[index].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-					FieldDescriptorsVector->FieldDescriptor[index].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position+2];
-					FieldDescriptorsVector->FieldDescriptor[index].Valid=false;
-					if (FieldDescriptorsVector->FieldDescriptor[index].Length > 0)
-						FieldDescriptorsVector->FieldDescriptor[index].Valid=true;
-				}
 			}
+			else
+			{
+				FieldDescriptorsVector->FieldDescriptor[index].Offset=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+				FieldDescriptorsVector->FieldDescriptor[index].Length=*(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position+2];
+				FieldDescriptorsVector->FieldDescriptor[index].Valid=false;
+				if (FieldDescriptorsVector->FieldDescriptor[index].Length > 0)
+					FieldDescriptorsVector->FieldDescriptor[index].Valid=true;
+			}
+		}
 
-			else if(FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_BIT)
+		else if(FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_BIT)
+		{
+			if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) ||
+				(FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
 			{
-				if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) ||
-					(FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
+				int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+				FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
+				FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
+				if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
 				{
-					int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-					FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
-					FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
-					if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
+					for (int i=0; i < n; i++)
 					{
-						for (int i=0; i < n; i++)
-						{
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].BitField_Value= (*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE])-0x80000000;
-							if(((*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE]) & 0x80000000) == 0x80000000)
-								FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid= true;
-						}
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].BitField_Value= (*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE])-0x80000000;
+						if(((*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE]) & 0x80000000) == 0x80000000)
+							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid= true;
 					}
 				}
-				else
-				{	
-					FieldDescriptorsVector->FieldDescriptor[index].BitField_Value= (*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position])-0x80000000;
-					if (((*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position]) & 0x80000000) == 0x80000000)
-						FieldDescriptorsVector->FieldDescriptor[index].Valid=true;
-				}
 			}
+			else
+			{	
+				FieldDescriptorsVector->FieldDescriptor[index].BitField_Value= (*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position])-0x80000000;
+				if (((*(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position]) & 0x80000000) == 0x80000000)
+					FieldDescriptorsVector->FieldDescriptor[index].Valid=true;
+			}
+		}
 
-			else if(FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_VARLEN)
+		else if(FieldDescriptorsVector->FieldDescriptor[index].FieldType == PDL_FIELD_TYPE_VARLEN)
+		{
+			if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) || (FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
 			{
-				if ((FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIPROTO) || (FieldDescriptorsVector->FieldDescriptor[index].DataFormatType == nbNETPFLCOMPILER_DATAFORMAT_MULTIFIELD))
+				int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+				FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
+				FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
+				if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
 				{
-					int n = *(uint32_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-					FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
-					FieldDescriptorsVector->FieldDescriptor[index].DVct->NumEntries= n;
-					if ((n > 0) && (FieldDescriptorsVector->FieldDescriptor[index].DVct))
+					for (int i=0;i<n;i++)
 					{
-						for (int i=0;i<n;i++)
-						{
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
-							FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid= true;
-						}
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Offset= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 4 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Length= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 6 + i * nbNETPFLCOMPILER_INFO_FIELDS_SIZE];
+						FieldDescriptorsVector->FieldDescriptor[index].DVct->FieldDescriptor[i].Valid= true;
 					}
 				}
-				else
-				{
-					FieldDescriptorsVector->FieldDescriptor[index].Offset= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
-					FieldDescriptorsVector->FieldDescriptor[index].Length= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 2];
-					FieldDescriptorsVector->FieldDescriptor[index].Valid= false;
-					if (FieldDescriptorsVector->FieldDescriptor[index].Length > 0)
-						FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
-				}
 			}
-
 			else
 			{
 				FieldDescriptorsVector->FieldDescriptor[index].Offset= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
@@ -196,6 +246,15 @@ void nbeeFieldReader::FillDescriptors()
 					FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
 			}
 		}
+
+		else
+		{
+			FieldDescriptorsVector->FieldDescriptor[index].Offset= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position];
+			FieldDescriptorsVector->FieldDescriptor[index].Length= *(uint16_t *) &DataInfo[FieldDescriptorsVector->FieldDescriptor[index].Position + 2];
+			FieldDescriptorsVector->FieldDescriptor[index].Valid= false;
+			if (FieldDescriptorsVector->FieldDescriptor[index].Length > 0)
+				FieldDescriptorsVector->FieldDescriptor[index].Valid= true;
+		}
 	}
 }
 
@@ -217,6 +276,8 @@ int nbeeFieldReader::IsValid(_nbExtractedFieldsDescriptor *FieldDescriptor)
 
 int nbeeFieldReader::IsComplete()
 {
+	LoadDescriptors();
+
 	for (int i=0; i < FieldDescriptorsVector->NumEntries; i++)
 	{
 	 if (IsValid(&FieldDescriptorsVector->FieldDescriptor[i]) == nbFAILURE)
@@ -27,19 +27,51 @@ class nbeeFieldReader :public nbExtractedFieldsReader
 {
 
 friend class nbeePacketEngine;
+friend void ParallelEngineWorkerLoop(void *Param);
 
 private:
 	_nbExtractedFieldsDescriptorVector *FieldDescriptorsVector;
 	_FieldNamesTable FieldNamesTable;			//!< Keeps the mapping between protocol fields (in the form 'proto.name') and the internal index associated to that field.
 	_nbExtractedFieldsNameList ProtocolFieldNames;		//!< Keeps the list of extracted fields as strings, in the form 'proto.name'.
-	unsigned char * DataInfo;
+	unsigned char * DataInfo;		//!< Info partition of the current packet; it may be borrowed from the NetVM exchange buffer
 	nbNetPFLCompiler *m_Compiler;
 	vector<uint16_t> FieldVector;
 
+	bool LazyDecoding;				//!< 'true' if descriptors are decoded only when they are accessed
+	uint32_t Generation;			//!< Incremented every time the reader moves to a new info partition
+	vector<uint32_t> FieldGeneration;	//!< Value of 'Generation' when each descriptor was last decoded
+
+	void FillDescriptor(int index);
+
+	//! Decodes the given descriptor, if this has not been done yet for the current info partition
+	void LoadDescriptor(int index)
+	{
+		if ((FieldGeneration[index] != Generation) && (DataInfo != NULL))
+		{
+			FillDescriptor(index);
+			FieldGeneration[index]= Generation;
+		}
+	}
+
+	void LoadDescriptors()
+	{
+		for (int index=0; index < FieldDescriptorsVector->NumEntries; index++)
+			LoadDescriptor(index);
+	}
+
 protected:
 
 	void FillDescriptors();
 
+	/*!
+		\brief Selects the info partition of the current packet.
+
+		With eager decoding, all the descriptors are filled immediately; with lazy decoding, each descriptor
+		is decoded on its first access, hence the buffer must stay valid until the application is done
+		with this reader. A NULL pointer detaches the reader from the previous partition.
+	*/
+	void SetDataInfo(unsigned char *dataInfo);
+
 public:
 	/*!
 		\brief	Object constructor
@@ -60,6 +92,10 @@ public:
 
 	_nbExtractedFieldsDescriptor* GetField(int Index);
 
+	int GetFieldHandle(string FieldName);
+
+	void SetLazyDecoding(bool Lazy);
+
 	_nbExtractedFieldsDescriptorVector* GetFields();
 
 	_nbExtractedFieldsNameList GetFieldNames();
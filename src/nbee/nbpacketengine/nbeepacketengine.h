@@ -5,9 +5,13 @@
 /*****************************************************************************/
 
 
+#pragma once
+
+
 #include <nbee_packetengine.h>
 #include <nbee_extractedfieldreader.h>
 #include "../globals/debug.h"
+#include "compilecache.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -16,18 +20,79 @@
 #include <nbee.h>
 #include <nbnetvm.h>
 
+#include <vector>
+#include <string>
+
 
 #define DATAINFO_BUF_SIZE 2048
 
 
+class nbeeFieldReader;
+
+
 //! This structure is used for communicating with the NetVM Application callback function
 struct ExBufInfo
 {
 	int *Result;
-	unsigned char *DataInfo;
+	unsigned char *DataInfo;	//!< Buffer that receives a copy of the info partition (NULL if it does not have to be copied)
 	int *N;
+	uint32_t InfoSize;			//!< Size of the 'DataInfo' buffer
+	unsigned char *InfoView;	//!< Info partition of the exchange buffer of the last accepted packet (not copied; owned by NetVM)
+	uint32_t InfoViewLen;		//!< Length of the 'InfoView' partition
+	const uint32_t *MatchMask;	//!< Members of a filter set that are still active (NULL if the program is not a filter set)
+	uint32_t MatchMaskWords;	//!< Number of words of 'MatchMask'
+
+	ExBufInfo(int *m_Result, unsigned char* datainfo,int *n, uint32_t infosize= DATAINFO_BUF_SIZE):Result(m_Result), DataInfo(datainfo),N(n),InfoSize(infosize),InfoView(NULL),InfoViewLen(0),MatchMask(NULL),MatchMaskWords(0){}
+};
+
+
+//! Callback registered onto the output application interface of NetVM; it receives an ExBufInfo through the exchange buffer UserData
+int32_t ResultInfoCallback(nvmExchangeBuffer *xbuffer);
+
+
+/*!
+	\brief NetVM objects that run a program (i.e. a compiled filter).
+
+	They are created from scratch for each program, so that a new program can be made ready
+	while the previous one is still processing packets, and swapped in with a pointer copy.
+*/
+struct _nbeeEngineRuntime
+{
+	nvmNetVM			*NetVM;
+	nvmNetPE			*NetPE;
+	nvmSocket			*SocketIn;
+	nvmSocket			*SocketOut;
+	nvmRuntimeEnvironment *NetVMRTEnv;
+	nvmAppInterface		*InInterf;
+	nvmAppInterface		*OutInterf;
+	nvmByteCode			*Bytecode;		//!< Bytecode owned by the runtime (if any), released by nbeeDestroyEngineRuntime()
+};
+
+
+/*!
+	\brief Creates the NetVM, the PE, the sockets, the runtime environment and the application interfaces
+	that run the given bytecode, and starts them if 'CreationFlag' is nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE.
 
-	ExBufInfo(int *m_Result, unsigned char* datainfo,int *n):Result(m_Result), DataInfo(datainfo),N(n){}
+	The PE refers to the content of the bytecode, so it must not be destroyed while the runtime exists.
+	The bytecode is still owned by the caller, which can hand it over to the runtime by setting
+	'Runtime->Bytecode' after a successful creation. In case of failure the objects created so far are destroyed, and 'Runtime' is left empty.
+
+	\param NetVMErrBuf Buffer of nvmERRBUF_SIZE bytes that receives the error message, if any.
+
+	\return nbSUCCESS or nbFAILURE.
+*/
+int nbeeCreateEngineRuntime(_nbeeEngineRuntime *Runtime, nvmByteCode *Bytecode, nbNetVMCreationFlag_t CreationFlag, bool UseJit, char *NetVMErrBuf);
+
+//! Destroys the objects of a runtime created by nbeeCreateEngineRuntime() and the bytecode it owns (if any), and leaves it empty.
+void nbeeDestroyEngineRuntime(_nbeeEngineRuntime *Runtime);
+
+
+//! Member of the filter set run by a packet engine (see nbPacketEngine::AddFilter())
+struct _nbeeFilterSetMember
+{
+	int			ID;			//!< ID returned to the user
+	std::string	Filter;		//!< NetPFL filter
+	bool		Removed;	//!< 'true' if it has been removed, but it is still part of the running program
 };
 
 
@@ -47,26 +112,44 @@ private:
 
 	nbNetPFLCompiler	*m_Compiler;
 	char				*m_GeneratedCode;
+	nbeeCompiledFilter	m_CompiledFilter;		//!< Result of the last compilation, when the compile cache is enabled (the bytecode is not assembled again)
 	int					n_field;
 	ExBufInfo			*m_exbufinfo;
 
-	//!\todo THIS SHOULD BE ALLOCATED AT RUNTIME
-	unsigned char		m_Info[DATAINFO_BUF_SIZE];
 	int					m_Result;
-	nbExtractedFieldsReader	*m_fieldReader;
+	nbeeFieldReader		*m_fieldReader;
+
+	//Batch processing related structures
+	std::vector<ExBufInfo>	m_BatchExbufInfo;	//!< Per-packet callback data of the last batch
+	std::vector<void*>		m_BatchUserData;	//!< Per-packet user data passed to NetVM (points into m_BatchExbufInfo)
+	std::vector<uint32_t>	m_BatchPktLen;		//!< Per-packet lengths passed to NetVM
+	int					*m_BatchResults;		//!< Caller-owned verdicts of the last batch
+	unsigned char		*m_BatchInfo;			//!< Caller-owned info partitions of the last batch (may be NULL)
+	int					m_BatchInfoSize;		//!< Size of each info partition slot in m_BatchInfo
+	int					m_BatchNumPkts;			//!< Number of packets in the last batch
 
 	//NetVM related structures
 	char				netvmErrBuf[nvmERRBUF_SIZE];
-	nvmNetVM			*NetVM;
-	nvmNetPE			*NetPE;
-	nvmSocket			*SocketIn;
-	nvmSocket			*SocketOut;
-	nvmRuntimeEnvironment *NetVMRTEnv;
-	nvmAppInterface		*InInterf;
-	nvmAppInterface		*OutInterf;
+	_nbeeEngineRuntime	m_Runtime;				//!< Runtime of the program that is processing packets
 	nvmByteCode			*BytecodeHandle;
 	nbNetVMCreationFlag_t	m_creationFlag;
 
+	//Program swapping related structures
+	nbNetPDLLinkLayer_t	m_LinkLayer;			//!< Link layer of the last compiled filter
+	bool				m_Opt;					//!< Optimization flag of the last compiled filter
+	_nbeeEngineRuntime	m_RetiredRuntime;		//!< Runtime of the previous program, kept until its info partition can be referenced
+	nbeeFieldReader		*m_RetiredFieldReader;	//!< Field reader of the previous program
+	nbeeCompiledFilter	m_RetiredFilter;		//!< Previous program (the descriptors of its field reader refer to it)
+	std::vector<_nbeeFilterSetMember>	m_FilterSet;	//!< Members of the filter set, in the order they appear in the match bitmap
+	std::vector<uint32_t>	m_FilterSetMask;	//!< Bits of the match bitmap that belong to members that have not been removed
+	int					m_NextFilterID;			//!< ID of the next member added to the filter set
+
+	int LoadCompiledFilter(nbNetPDLLinkLayer_t LinkLayer, nbeeCompiledFilter &Filter);
+	int InstallProgram(nbeeCompiledFilter &Program);
+	int CompileFilterSet(std::vector<_nbeeFilterSetMember> &FilterSet);
+	void UpdateFilterSetMask();
+	void ReleaseRetiredRuntime();
+
 public:
 
 	/*!
@@ -91,6 +174,14 @@ public:
 
 	int ProcessPacket(const unsigned char *PktData, int PktLen);
 
+	int ProcessBatch(const unsigned char **PktData, const int *PktLen, int NumPkts, int *Results, unsigned char *InfoData= NULL, int InfoSize= 0);
+
+	int LoadBatchResult(int Index);
+
+	const unsigned char *GetInfoPartition(int *InfoLen);
+
+	void ReleaseInfoPartition();
+
 	_nbNetPFLCompilerMessages *GetCompMessageList(void);
 
 	char *GetLastError()
@@ -125,5 +216,13 @@ public:
 	void SetProtoGraphFilename(const char *DumpProtoGraphFilename= nbNETPFLCOMPILER_DEBUG_PROTOGRAH_DUMP_FILENAME);
 
 	nvmRuntimeEnvironment *GetNetVMRuntimeEnvironment(void);
+
+	int SwapFilter(const char *NetPFLFilterString);
+
+	int AddFilter(const char *NetPFLFilterString, int *FilterID);
+
+	int RemoveFilter(int FilterID);
+
+	int IsFilterMatched(int FilterID);
 };
 
@@ -0,0 +1,161 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+#pragma once
+
+
+#include "nbeepacketengine.h"
+#include "../globals/threads.h"
+
+
+//! Number of packets that can be queued to each worker of the parallel packet engine
+#define PARALLEL_ENGINE_QUEUE_SIZE 4096
+
+//! Maximum length of the flow key used to select the worker (IPv6 addresses, protocol and ports)
+#define PARALLEL_ENGINE_FLOWKEY_SIZE 40
+
+
+class nbeeParallelPacketEngine;
+
+
+//! Packet copied into the queue of a worker
+struct _ParallelEnginePacket
+{
+	unsigned char *PktData;		//!< Buffer keeping the packet (grown on demand, and reused)
+	int PktLen;					//!< Length of the packet
+	int BufferSize;				//!< Size of the 'PktData' buffer
+};
+
+
+//! Program run by a worker: its NetVM runtime and the reader of the fields it extracts
+struct _ParallelEngineProgram
+{
+	_nbeeEngineRuntime	Runtime;
+	nbeeFieldReader		*FieldReader;
+	int					NField;
+};
+
+
+/*!
+	\brief This structure keeps everything that is owned by a single worker of the parallel packet engine.
+
+	Each worker has its own NetVM, NetPE and runtime environment (hence its own exchange buffers,
+	data memory and coprocessor instances); only the NetIL bytecode is shared among workers.
+*/
+struct _ParallelEngineWorker
+{
+	nbeeParallelPacketEngine *Owner;	//!< Engine this worker belongs to
+	int					ID;				//!< ID of the worker (from 0 to NumWorkers - 1)
+	int					CPU;			//!< CPU the worker is bound to (-1 if not bound)
+
+	//NetVM related structures
+	char				NetVMErrBuf[nvmERRBUF_SIZE];
+	_ParallelEngineProgram	Program;		//!< Program that is processing packets (used only by the worker thread)
+	_ParallelEngineProgram	NextProgram;	//!< Program that replaces the current one, when SwapPending is 'true'
+	bool				SwapPending;		//!< 'true' until the worker switches to NextProgram
+
+	int					Result;
+	ExBufInfo			*ExbufInfo;
+
+	// Queue of the packets waiting to be processed (single producer, single consumer)
+	_ParallelEnginePacket	Queue[PARALLEL_ENGINE_QUEUE_SIZE];
+	unsigned int		Head;			//!< Next slot that will be written by the producer
+	unsigned int		Tail;			//!< Next slot that will be read by the worker
+	bool				Busy;			//!< 'true' while the worker is processing packets taken from the queue
+	bool				StopRequested;
+	nbMutex_t			QueueLock;
+	nbCondition_t		QueueNotEmpty;
+	nbCondition_t		QueueDrained;
+	nbThread_t			Thread;
+	bool				ThreadStarted;
+
+	// Statistics (protected by QueueLock)
+	uint64_t			NumProcessed;
+	uint64_t			NumAccepted;
+	uint64_t			NumDropped;
+};
+
+
+//! Class for filtering and extracting selected fields from network packets on multiple cores.
+class nbeeParallelPacketEngine: public nbParallelPacketEngine
+{
+friend void ParallelEngineWorkerLoop(void *Param);
+
+private:
+	struct _nbNetPDLDatabase *m_NetPDLDatabase;	//!< Netpdl structure for the compiler initialization
+	bool				m_UseJit;				//!< Jit Flag
+	char				m_errbuf[2048];			//!< Buffer that keeps the last error message (if any)
+
+	nbNetPFLCompiler	*m_Compiler;
+	char				*m_GeneratedCode;
+	nbeeCompiledFilter	m_CompiledFilter;		//!< Result of the last compilation, when the compile cache is enabled
+	nbNetPDLLinkLayer_t	m_LinkLayer;
+	bool				m_Opt;					//!< Optimization flag of the last compiled filter
+	bool				m_ExtractFields;		//!< 'true' if the filter extracts some fields
+
+	//! NetIL bytecode, assembled once and shared by all the workers
+	nvmByteCode			*m_BytecodeHandle;
+
+	int					m_NumWorkers;
+	_ParallelEngineWorker	**m_Workers;
+
+	nbPacketEngineResultCallback	*m_ResultCallback;
+	void				*m_CallbackUserData;
+
+	int CreateWorkerProgram(nvmByteCode *Bytecode, nbeeCompiledFilter &Filter, bool ExtractFields, _ParallelEngineProgram *Program, char *NetVMErrBuf);
+	void DestroyWorkerProgram(_ParallelEngineProgram *Program);
+	void StopWorkers();
+	void ReleaseBytecode();
+	uint32_t GetFlowHash(const unsigned char *PktData, int PktLen);
+
+public:
+
+	/*!
+		\brief	Object constructor
+
+		\param	NetPDLDatabase  pointer to the structure that contains the NetPDL Description
+		\param	NumWorkers		number of workers (threads) to be created
+		\param	UseJit			flag for setting the NetVM Engine.
+	*/
+	nbeeParallelPacketEngine(struct _nbNetPDLDatabase *NetPDLDatabase, int NumWorkers, bool UseJit);
+
+	/*!
+		\brief	Object destructor
+	*/
+	~nbeeParallelPacketEngine(void);
+
+	int Compile(const char* NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt);
+
+	int SetWorkerAffinity(int WorkerID, int CPU);
+
+	int InitNetVM(nbPacketEngineResultCallback *ResultCallback, void *UserData);
+
+	int ProcessPacket(const unsigned char *PktData, int PktLen);
+
+	int SwapFilter(const char *NetPFLFilterString);
+
+	int Flush();
+
+	int GetNumWorkers()
+	{
+		return m_NumWorkers;
+	}
+
+	int GetWorkerStats(int WorkerID, uint64_t *NumProcessed, uint64_t *NumAccepted, uint64_t *NumDropped);
+
+	char *GetCompiledCode()
+	{
+		return m_GeneratedCode;
+	}
+
+	_nbNetPFLCompilerMessages *GetCompMessageList(void);
+
+	char *GetLastError()
+	{
+		return m_errbuf;
+	}
+};
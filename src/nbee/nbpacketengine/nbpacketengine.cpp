@@ -6,14 +6,18 @@
 
 #include "nbeepacketengine.h"
 #include "nbeefieldreader.h"
+#include "../globals/utils.h"
 
 
 
 
 /*
  * The callback function registered onto the output interface of NetVM
- * sets to true the "packet accepted" flag and copies the entire info
- * partition in a private buffer of the packet-engine.
+ * sets to true the "packet accepted" flag and records where the info
+ * partition of the exchange buffer is, without copying it; the partition
+ * stays untouched until the next packet is pushed into the same runtime.
+ * The info partition is copied only when the caller provided a private
+ * buffer (i.e., in batch mode, where the same exchange buffer is reused).
  * The "packet accepted" flag is held by the ExBufInfo structure, which is passed
  * through the UserData member of the exchange buffer when the packet is pushed into NetVM.
  *
@@ -23,25 +27,144 @@
 int32_t ResultInfoCallback(nvmExchangeBuffer *xbuffer)
 {
 	ExBufInfo *exbufInfo= (ExBufInfo*)xbuffer->UserData;
+
+	// Packets matched only by members that have been removed from the filter set are discarded here
+	if (exbufInfo->MatchMask)
+	{
+	uint32_t NumWords= exbufInfo->MatchMaskWords;
+	uint32_t i;
+
+		if (NumWords > xbuffer->InfoLen / sizeof(uint32_t))
+			NumWords= xbuffer->InfoLen / sizeof(uint32_t);
+
+		for (i= 0; i < NumWords; i++)
+		{
+			if (((uint32_t *) xbuffer->InfoData)[i] & exbufInfo->MatchMask[i])
+				break;
+		}
+
+		if (i == NumWords)
+			return nbSUCCESS;
+	}
+
 	*(exbufInfo->Result)=nbSUCCESS;
-	memcpy(exbufInfo->DataInfo,xbuffer->InfoData,xbuffer->InfoLen);
+	exbufInfo->InfoView= xbuffer->InfoData;
+	exbufInfo->InfoViewLen= xbuffer->InfoLen;
+	if (exbufInfo->DataInfo)
+		memcpy(exbufInfo->DataInfo,xbuffer->InfoData,(xbuffer->InfoLen < exbufInfo->InfoSize) ? xbuffer->InfoLen : exbufInfo->InfoSize);
+	return nbSUCCESS;
+}
+
+
+int nbeeCreateEngineRuntime(_nbeeEngineRuntime *Runtime, nvmByteCode *Bytecode, nbNetVMCreationFlag_t CreationFlag, bool UseJit, char *NetVMErrBuf)
+{
+	memset(Runtime, 0, sizeof(_nbeeEngineRuntime));
+
+	Runtime->NetVM = nvmCreateVM(0, NetVMErrBuf);
+	if (Runtime->NetVM == NULL)
+		return nbFAILURE;
+
+	Runtime->NetPE = nvmCreatePE(Runtime->NetVM, Bytecode, NetVMErrBuf);
+	if (Runtime->NetPE == NULL)
+		goto Fail;
+
+	Runtime->SocketIn = nvmCreateSocket(Runtime->NetVM, NetVMErrBuf);
+	if (Runtime->SocketIn == NULL)
+		goto Fail;
+
+	Runtime->SocketOut = nvmCreateSocket(Runtime->NetVM, NetVMErrBuf);
+	if (Runtime->SocketOut == NULL)
+		goto Fail;
+
+	//connect the Input socket to the port 0 of the NetPE
+	if (nvmConnectSocket2PE(Runtime->NetVM, Runtime->SocketIn, Runtime->NetPE, 0, NetVMErrBuf) == nvmFAILURE)
+		goto Fail;
+
+	//connect the Output socket to the port 1 of the NetPE
+	if (nvmConnectSocket2PE(Runtime->NetVM, Runtime->SocketOut, Runtime->NetPE, 1, NetVMErrBuf) == nvmFAILURE)
+		goto Fail;
+
+	//create the NetVM Runtime environment
+	Runtime->NetVMRTEnv = nvmCreateRTEnv(Runtime->NetVM, CreationFlag, NetVMErrBuf);
+	if (Runtime->NetVMRTEnv == NULL)
+		goto Fail;
+
+	//create an input Application Interface (i.e. a control plane input interface where we can collect packets from)
+	Runtime->InInterf = nvmCreateAppInterfacePushIN(Runtime->NetVMRTEnv, NetVMErrBuf);
+	if (Runtime->InInterf == NULL)
+		goto Fail;
+
+	//create an output Application Interface (i.e. a control plane output interface where we can write packets on)
+	Runtime->OutInterf= nvmCreateAppInterfacePushOUT(Runtime->NetVMRTEnv, ResultInfoCallback, NetVMErrBuf);
+	if (Runtime->OutInterf == NULL)
+		goto Fail;
+
+	//bind the input interface to the input socket
+	if (nvmBindAppInterf2Socket(Runtime->InInterf, Runtime->SocketIn) != nvmSUCCESS)
+	{
+		ssnprintf(NetVMErrBuf, nvmERRBUF_SIZE, "Input Interface binding failed");
+		goto Fail;
+	}
+
+	//bind the output interface to the output socket
+	if (nvmBindAppInterf2Socket(Runtime->OutInterf, Runtime->SocketOut) != nvmSUCCESS)
+	{
+		ssnprintf(NetVMErrBuf, nvmERRBUF_SIZE, "Output Interface binding failed");
+		goto Fail;
+	}
+
+	if (CreationFlag == nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE)
+	{
+		if (nvmNetStart(Runtime->NetVM, Runtime->NetVMRTEnv, UseJit, nvmDO_NATIVE | nvmDO_BCHECK, 3, NetVMErrBuf) != nvmSUCCESS)
+			goto Fail;
+	}
+
 	return nbSUCCESS;
+
+Fail:
+	nbeeDestroyEngineRuntime(Runtime);
+	return nbFAILURE;
 }
 
+
+void nbeeDestroyEngineRuntime(_nbeeEngineRuntime *Runtime)
+{
+	if (Runtime->NetVM)
+		nvmDestroyVM(Runtime->NetVM);
+
+	if (Runtime->NetVMRTEnv)
+		nvmDestroyRTEnv(Runtime->NetVMRTEnv);
+
+	// The bytecode is released after the PE that refers to it
+	if (Runtime->Bytecode)
+	{
+		nvmDestroyBytecode(Runtime->Bytecode);
+		free(Runtime->Bytecode);
+	}
+
+	memset(Runtime, 0, sizeof(_nbeeEngineRuntime));
+}
+
+
 nbeePacketEngine::nbeePacketEngine(struct _nbNetPDLDatabase *NetPDLDatabase, bool UseJit):
 m_NetPDLDatabase(NetPDLDatabase), m_UseJit(UseJit)
 {
 	m_Compiler = nbAllocateNetPFLCompiler(m_NetPDLDatabase);
 	m_fieldReader=NULL;
 	netvmErrBuf[0] = '\0';
-	NetVM=NULL;
-	NetPE=NULL;
-	SocketIn=NULL;
-	SocketOut=NULL;
-	NetVMRTEnv=NULL;
+	memset(&m_Runtime, 0, sizeof(m_Runtime));
+	memset(&m_RetiredRuntime, 0, sizeof(m_RetiredRuntime));
+	m_RetiredFieldReader= NULL;
+	m_LinkLayer= nbNETPDL_LINK_LAYER_ETHERNET;
+	m_Opt= true;
+	m_NextFilterID= 0;
 	BytecodeHandle = NULL;
 	n_field=1;
-	m_exbufinfo= new ExBufInfo(&m_Result,m_Info,&n_field);
+	m_exbufinfo= new ExBufInfo(&m_Result,NULL,&n_field);
+	m_BatchResults= NULL;
+	m_BatchInfo= NULL;
+	m_BatchInfoSize= 0;
+	m_BatchNumPkts= 0;
 }
 
 
@@ -53,11 +176,8 @@ nbeePacketEngine::~nbeePacketEngine(void)
 		m_fieldReader= NULL;
 	}
 
-	if(NetVM)
-		nvmDestroyVM(NetVM);
-
-	if(NetVMRTEnv)
-		nvmDestroyRTEnv(NetVMRTEnv);
+	ReleaseRetiredRuntime();
+	nbeeDestroyEngineRuntime(&m_Runtime);
 
 	nbCleanup();
 }
@@ -66,174 +186,283 @@ int32_t nbeePacketEngine::InitNetVM(nbNetVMCreationFlag_t CreationFlag)
 {
 	m_creationFlag= CreationFlag;
 
-	if (NetVM)
-		nvmDestroyVM(NetVM);
+	ReleaseRetiredRuntime();
+	nbeeDestroyEngineRuntime(&m_Runtime);
 
-	if (NetVMRTEnv)
-		nvmDestroyRTEnv(NetVMRTEnv);
-
-	NetVM = nvmCreateVM(0, netvmErrBuf);
-	if(NetVM == NULL)
-	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-		return nbFAILURE;
-	}
+	if (m_CompiledFilter.Bytecode.empty())
+		BytecodeHandle = nvmAssembleNetILFromBuffer(m_GeneratedCode, netvmErrBuf);
+	else
+		BytecodeHandle = nvmLoadBytecodeImageFromBuffer(&m_CompiledFilter.Bytecode[0], (uint32_t) m_CompiledFilter.Bytecode.size(), netvmErrBuf);
 
-	BytecodeHandle = nvmAssembleNetILFromBuffer(m_GeneratedCode, netvmErrBuf);
 	if (BytecodeHandle == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
 		return nbFAILURE;
 	}
 
-	NetPE = nvmCreatePE(NetVM, BytecodeHandle, netvmErrBuf);
-	if (NetPE == NULL)
+	if (nbeeCreateEngineRuntime(&m_Runtime, BytecodeHandle, CreationFlag, m_UseJit, netvmErrBuf) == nbFAILURE)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+		nvmDestroyBytecode(BytecodeHandle);
+		free(BytecodeHandle);
+		BytecodeHandle= NULL;
 		return nbFAILURE;
 	}
 
-	free(BytecodeHandle);
+	m_Runtime.Bytecode= BytecodeHandle;
+
+	return nbSUCCESS;
+
+}
 
-	SocketIn = nvmCreateSocket(NetVM, netvmErrBuf);
-	if (SocketIn == NULL)
+
+int nbeePacketEngine::Compile(const char *NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt)
+{
+int RetVal;
+nbeeCompiledFilter CachedFilter;
+_nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector;
+
+	if (m_Compiler == NULL)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
 		return nbFAILURE;
 	}
 
-	SocketOut = nvmCreateSocket(NetVM, netvmErrBuf);
-	if (SocketOut == NULL)
+	// Programs swapped in later are compiled with the same options
+	m_LinkLayer= LinkLayer;
+	m_Opt= Opt;
+	m_FilterSet.clear();
+	UpdateFilterSetMask();
+
+	if (nbeeCompileCacheLookup(m_NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, CachedFilter))
+		return LoadCompiledFilter(LinkLayer, CachedFilter);
+
+	RetVal= m_Compiler->NetPDLInit(LinkLayer);
+
+	if (RetVal != nbSUCCESS)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
 		return nbFAILURE;
 	}
 
-	//connect the Input socket to the port 0 of the NetPE
-	if (nvmConnectSocket2PE(NetVM, SocketIn, NetPE, 0, netvmErrBuf) == nvmFAILURE)
+	m_GeneratedCode= NULL;
+
+	RetVal = m_Compiler->CompileFilter(NetPFLFilterString, &m_GeneratedCode, Opt);
+	if (RetVal != nbSUCCESS)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
 		return nbFAILURE;
 	}
 
-	//connect the Output socket to the port 1 of the NetPE
-	if (nvmConnectSocket2PE(NetVM, SocketOut, NetPE, 1, netvmErrBuf) == nvmFAILURE)
+	ExtractedFieldsDescriptorVector= m_Compiler->GetExtractField();
+
+	if (m_fieldReader)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-		return nbFAILURE;
+		delete m_fieldReader;
+		m_fieldReader=NULL;
 	}
 
-	//create the NetVM Runtime environment
+	m_CompiledFilter.Clear();
 
-	NetVMRTEnv = nvmCreateRTEnv(NetVM, CreationFlag, netvmErrBuf);
-	if (NetVMRTEnv == NULL)
+	if (nbeeCompileCacheEnabled())
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-		return nbFAILURE;
+	char NetVMErrBuf[nvmERRBUF_SIZE];
+	nvmByteCode *Bytecode;
+
+		// The code is assembled here, so that the cache keeps the bytecode; errors are reported later by InitNetVM()
+		Bytecode= nvmAssembleNetILFromBuffer(m_GeneratedCode, NetVMErrBuf);
+		if (Bytecode != NULL)
+		{
+			m_CompiledFilter.Set(m_GeneratedCode, Bytecode, ExtractedFieldsDescriptorVector);
+			nbeeCompileCacheStore(m_NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, m_CompiledFilter);
+
+			nvmDestroyBytecode(Bytecode);
+			free(Bytecode);
+		}
 	}
 
-	//create an input Application Interface (i.e. a control plane input interface where we can collect packets from)
-	InInterf = nvmCreateAppInterfacePushIN(NetVMRTEnv, netvmErrBuf);
-	if (InInterf == NULL)
+	if (ExtractedFieldsDescriptorVector->NumEntries > 0)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-		return nbFAILURE;
+		m_fieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, NULL, m_Compiler);
+
+		// Store the number of fields to extract (except allfields)
+		if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+			n_field= ExtractedFieldsDescriptorVector->NumEntries - 1;
+		else
+			n_field= ExtractedFieldsDescriptorVector->NumEntries;
 	}
 
-	//create an output Application Interface (i.e. a control plane output interface where we can write packets on)
-	OutInterf= nvmCreateAppInterfacePushOUT(NetVMRTEnv, ResultInfoCallback, netvmErrBuf);
-	if (OutInterf == NULL)
+	return RetVal;
+}
+
+
+/*
+ * A filter found in the compile cache does not need the compiler, except for decoding
+ * 'allfields', whose field names are known only when packets are processed.
+ */
+int nbeePacketEngine::LoadCompiledFilter(nbNetPDLLinkLayer_t LinkLayer, nbeeCompiledFilter &Filter)
+{
+_nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector;
+
+	if (Filter.HasAllFields() && (m_Compiler->IsInitialized() != nbSUCCESS))
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-		return nbFAILURE;
+		if (m_Compiler->NetPDLInit(LinkLayer) != nbSUCCESS)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
+			return nbFAILURE;
+		}
 	}
 
-	//bind the input interface to the input socket
-	if (nvmBindAppInterf2Socket(InInterf,SocketIn)!= nvmSUCCESS)
+	// The reader refers to the strings of the previous filter
+	if (m_fieldReader)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Input Interface binding failed");
-		return nbFAILURE;
+		delete m_fieldReader;
+		m_fieldReader= NULL;
 	}
-	//bind the output interface to the output socket
-	if (nvmBindAppInterf2Socket(OutInterf,SocketOut)!= nvmSUCCESS)
+
+	m_CompiledFilter.Swap(Filter);
+	m_GeneratedCode= (char *) m_CompiledFilter.NetILCode.c_str();
+
+	if (m_CompiledFilter.Fields.size() > 0)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Output Interface binding failed");
-		return nbFAILURE;
+		ExtractedFieldsDescriptorVector= m_CompiledFilter.CreateFieldsDescriptors();
+		m_fieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, NULL, m_Compiler);
+
+		// Store the number of fields to extract (except allfields)
+		if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+			n_field= ExtractedFieldsDescriptorVector->NumEntries - 1;
+		else
+			n_field= ExtractedFieldsDescriptorVector->NumEntries;
 	}
 
-	if (m_creationFlag == nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE)
+	return nbSUCCESS;
+}
+
+
+int nbeePacketEngine::ProcessPacket(const unsigned char *PktData, int PktLen)
+{
+	ReleaseRetiredRuntime();
+
+	m_Result=nbFAILURE;
+	m_exbufinfo->InfoView= NULL;
+	m_exbufinfo->InfoViewLen= 0;
+
+	nvmWriteAppInterface(m_Runtime.InInterf, (uint8_t*)PktData, (uint32_t)PktLen, m_exbufinfo , netvmErrBuf);
+
+	// The reader works directly on the info partition of the exchange buffer
+	if (m_fieldReader)
+		m_fieldReader->SetDataInfo((m_Result != nbFAILURE) ? m_exbufinfo->InfoView : NULL);
+
+	return m_Result;
+}
+
+
+const unsigned char *nbeePacketEngine::GetInfoPartition(int *InfoLen)
+{
+	if ((m_Result != nbSUCCESS) || (m_exbufinfo->InfoView == NULL))
 	{
-		if (nvmNetStart(NetVM, NetVMRTEnv, m_UseJit, nvmDO_NATIVE | nvmDO_BCHECK, 3, netvmErrBuf) != nvmSUCCESS)
-		{
-			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
-			return nbFAILURE;
-		}
+		*InfoLen= 0;
+		return NULL;
 	}
 
-	return nbSUCCESS;
+	*InfoLen= (int) m_exbufinfo->InfoViewLen;
+	return m_exbufinfo->InfoView;
+}
+
+
+void nbeePacketEngine::ReleaseInfoPartition()
+{
+	m_exbufinfo->InfoView= NULL;
+	m_exbufinfo->InfoViewLen= 0;
+
+	if (m_fieldReader)
+		m_fieldReader->SetDataInfo(NULL);
 
+	// Nobody can refer to the previous program anymore
+	ReleaseRetiredRuntime();
 }
 
 
-int nbeePacketEngine::Compile(const char *NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt)
+int nbeePacketEngine::ProcessBatch(const unsigned char **PktData, const int *PktLen, int NumPkts, int *Results, unsigned char *InfoData, int InfoSize)
 {
-int RetVal;
+int NumAccepted= 0;
 
-	if (m_Compiler == NULL)
+	if (NumPkts <= 0)
+		return 0;
+
+	ReleaseRetiredRuntime();
+
+	if ((InfoData != NULL) && (InfoSize <= 0))
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The size of the info partition slots must be greater than zero");
 		return nbFAILURE;
 	}
 
-	RetVal= m_Compiler->NetPDLInit(LinkLayer);
+	m_BatchExbufInfo.clear();
+	m_BatchExbufInfo.reserve(NumPkts);
+	m_BatchUserData.resize(NumPkts);
+	m_BatchPktLen.resize(NumPkts);
 
-	if (RetVal != nbSUCCESS)
+	for (int i= 0; i < NumPkts; i++)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
-		return nbFAILURE;
+		Results[i]= nbFAILURE;
+		m_BatchExbufInfo.push_back(ExBufInfo(&Results[i], (InfoData != NULL) ? &InfoData[i * InfoSize] : NULL, &n_field, (uint32_t) InfoSize));
+		m_BatchExbufInfo[i].MatchMask= m_exbufinfo->MatchMask;
+		m_BatchExbufInfo[i].MatchMaskWords= m_exbufinfo->MatchMaskWords;
+		m_BatchPktLen[i]= (uint32_t) PktLen[i];
 	}
 
-	m_GeneratedCode= NULL;
+	// Pointers are taken only now, since the vector cannot be reallocated anymore
+	for (int i= 0; i < NumPkts; i++)
+		m_BatchUserData[i]= &m_BatchExbufInfo[i];
 
-	RetVal = m_Compiler->CompileFilter(NetPFLFilterString, &m_GeneratedCode, Opt);
-	if (RetVal != nbSUCCESS)
+	if (nvmWriteAppInterfaceBatch(m_Runtime.InInterf, (uint8_t**) PktData, &m_BatchPktLen[0], NULL, (uint32_t) NumPkts, &m_BatchUserData[0], netvmErrBuf) != nvmSUCCESS)
 	{
-		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
 		return nbFAILURE;
 	}
 
-	if (m_Compiler->GetExtractField()->NumEntries > 0)
-	{
-		if (m_fieldReader)
-		{
-			delete m_fieldReader;
-			m_fieldReader=NULL;
-		}
+	// The exchange buffer has been reused, so the info partition of the last ProcessPacket() is gone
+	m_exbufinfo->InfoView= NULL;
+	m_exbufinfo->InfoViewLen= 0;
+	if (m_fieldReader)
+		m_fieldReader->SetDataInfo(NULL);
 
-	    _nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector= m_Compiler->GetExtractField();
-		m_fieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, m_Info, m_Compiler);
+	m_BatchResults= Results;
+	m_BatchInfo= InfoData;
+	m_BatchInfoSize= InfoSize;
+	m_BatchNumPkts= NumPkts;
 
-		// Store the number of fields to extract (except allfields)
-		if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
-			n_field= ExtractedFieldsDescriptorVector->NumEntries - 1;
-		else
-			n_field= ExtractedFieldsDescriptorVector->NumEntries;
+	for (int i= 0; i < NumPkts; i++)
+	{
+		if (Results[i] == nbSUCCESS)
+			NumAccepted++;
 	}
 
-	return RetVal;
+	return NumAccepted;
 }
 
 
-int nbeePacketEngine::ProcessPacket(const unsigned char *PktData, int PktLen)
+int nbeePacketEngine::LoadBatchResult(int Index)
 {
-	m_Result=nbFAILURE;
+	if ((m_fieldReader == NULL) || (m_BatchInfo == NULL))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The last batch did not collect any extracted field");
+		return nbFAILURE;
+	}
 
-	nvmWriteAppInterface(InInterf, (uint8_t*)PktData, (uint32_t)PktLen, m_exbufinfo , netvmErrBuf);
+	if ((Index < 0) || (Index >= m_BatchNumPkts))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Packet index %d is out of the last batch", Index);
+		return nbFAILURE;
+	}
 
-	if(m_fieldReader && m_Result!= nbFAILURE)
-		m_fieldReader->FillDescriptors();
+	if (m_BatchResults[Index] != nbSUCCESS)
+		return nbFAILURE;
 
-	return m_Result;
+	m_fieldReader->SetDataInfo(&m_BatchInfo[Index * m_BatchInfoSize]);
+
+	return nbSUCCESS;
 }
 
 
@@ -278,8 +507,8 @@ int nbeePacketEngine::GenerateBackendCode(int BackendId, bool Opt, bool Inline,
 		if (Inline)
 			NetVMFlags |= nvmDO_INLINE;
 
-		if (nvmCompileApplication(NetVM,
-					NetVMRTEnv,
+		if (nvmCompileApplication(m_Runtime.NetVM,
+					m_Runtime.NetVMRTEnv,
 					BackendId - 1,
 					NetVMFlags,
 					OptLevel,
@@ -305,7 +534,7 @@ int nbeePacketEngine::GenerateBackendCode(int BackendId, bool Opt, bool Inline,
 
 char *nbeePacketEngine::GetAssemblyCode()
 {
-	return nvmGetTargetCode(NetVMRTEnv);
+	return nvmGetTargetCode(m_Runtime.NetVMRTEnv);
 }
 
 
@@ -329,6 +558,10 @@ int RetVal;
 	}
 
 	m_GeneratedCode= NetILCode;
+	m_CompiledFilter.Clear();
+	m_LinkLayer= LinkLayer;
+	m_FilterSet.clear();
+	UpdateFilterSetMask();
 
 	if (m_fieldReader)
 	{	
@@ -336,7 +569,7 @@ int RetVal;
 		m_fieldReader= NULL;
 	}
 
-	m_fieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, m_Info, m_Compiler);
+	m_fieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, NULL, m_Compiler);
 
 	if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
 		n_field= ExtractedFieldsDescriptorVector->NumEntries - 1;
@@ -427,7 +660,248 @@ _nbNetPFLCompilerMessages *nbeePacketEngine::GetCompMessageList(void)
 
 nvmRuntimeEnvironment *nbeePacketEngine::GetNetVMRuntimeEnvironment(void)
 {
-  return NetVMRTEnv;
+  return m_Runtime.NetVMRTEnv;
 }
 
 
+void nbeePacketEngine::ReleaseRetiredRuntime()
+{
+	if (m_RetiredFieldReader)
+	{
+		delete m_RetiredFieldReader;
+		m_RetiredFieldReader= NULL;
+	}
+
+	nbeeDestroyEngineRuntime(&m_RetiredRuntime);
+	m_RetiredFilter.Clear();
+}
+
+
+/*
+ * The runtime of the new program is created while the current one is still in place, so that
+ * nothing changes in case of failure. Then the two are swapped: packets processed from now on
+ * run on the new program, while the previous one is retired, and it is destroyed only when the
+ * caller cannot refer to the info partition of its last packet anymore (i.e. at the next packet).
+ * If InitNetVM() has not been called yet, the program is simply stored for it.
+ */
+int nbeePacketEngine::InstallProgram(nbeeCompiledFilter &Program)
+{
+_nbeeEngineRuntime Runtime;
+nvmByteCode *Bytecode;
+nbeeFieldReader *FieldReader= NULL;
+_nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector;
+int NField= 1;
+
+	memset(&Runtime, 0, sizeof(Runtime));
+
+	if (m_Runtime.NetVM != NULL)
+	{
+		Bytecode= nvmLoadBytecodeImageFromBuffer(&Program.Bytecode[0], (uint32_t) Program.Bytecode.size(), netvmErrBuf);
+		if (Bytecode == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+			return nbFAILURE;
+		}
+
+		if (nbeeCreateEngineRuntime(&Runtime, Bytecode, m_creationFlag, m_UseJit, netvmErrBuf) == nbFAILURE)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), netvmErrBuf);
+			nvmDestroyBytecode(Bytecode);
+			free(Bytecode);
+			return nbFAILURE;
+		}
+
+		// As in InitNetVM(), the PE refers to the bytecode, which is released with the runtime
+		Runtime.Bytecode= Bytecode;
+	}
+
+	if (Program.Fields.size() > 0)
+	{
+		ExtractedFieldsDescriptorVector= Program.CreateFieldsDescriptors();
+		FieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, NULL, m_Compiler);
+
+		// Store the number of fields to extract (except allfields)
+		if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+			NField= ExtractedFieldsDescriptorVector->NumEntries - 1;
+		else
+			NField= ExtractedFieldsDescriptorVector->NumEntries;
+	}
+
+	ReleaseRetiredRuntime();
+
+	m_RetiredRuntime= m_Runtime;
+	m_RetiredFieldReader= m_fieldReader;
+	m_RetiredFilter.Swap(m_CompiledFilter);
+
+	m_Runtime= Runtime;
+	m_fieldReader= FieldReader;
+	n_field= NField;
+	m_CompiledFilter.Swap(Program);
+	m_GeneratedCode= (char *) m_CompiledFilter.NetILCode.c_str();
+
+	return nbSUCCESS;
+}
+
+
+int nbeePacketEngine::SwapFilter(const char *NetPFLFilterString)
+{
+nbeeCompiledFilter Program;
+
+	if (m_Compiler == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
+		return nbFAILURE;
+	}
+
+	if (nbeeCompileProgram(m_Compiler, m_NetPDLDatabase, NetPFLFilterString, NULL, m_LinkLayer, m_Opt, Program, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+		return nbFAILURE;
+
+	if (InstallProgram(Program) == nbFAILURE)
+		return nbFAILURE;
+
+	// The new program is not a filter set
+	m_FilterSet.clear();
+	UpdateFilterSetMask();
+
+	return nbSUCCESS;
+}
+
+
+/*
+ * The members are merged into a single automaton, hence adding one of them means compiling the
+ * whole set again; the NetPDL database is not loaded again, though, and sets that have already
+ * been compiled are taken from the compile cache. If the new program cannot be created, the
+ * current one keeps running with the current members.
+ */
+int nbeePacketEngine::CompileFilterSet(std::vector<_nbeeFilterSetMember> &FilterSet)
+{
+std::vector<std::string> Filters;
+std::string CacheKey("#filterset");
+nbeeCompiledFilter Program;
+
+	if (m_Compiler == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
+		return nbFAILURE;
+	}
+
+	if (FilterSet.size() > nbNETPFLCOMPILER_MAX_FILTERSET_SIZE)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "A filter set cannot have more than %d members", nbNETPFLCOMPILER_MAX_FILTERSET_SIZE);
+		return nbFAILURE;
+	}
+
+	// The key of the cache must not be mistaken for a single filter
+	for (unsigned int i= 0; i < FilterSet.size(); i++)
+	{
+		Filters.push_back(FilterSet[i].Filter);
+		CacheKey+= "\n" + FilterSet[i].Filter;
+	}
+
+	if (nbeeCompileProgram(m_Compiler, m_NetPDLDatabase, CacheKey.c_str(), &Filters, m_LinkLayer, m_Opt, Program, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+		return nbFAILURE;
+
+	if (InstallProgram(Program) == nbFAILURE)
+		return nbFAILURE;
+
+	m_FilterSet.swap(FilterSet);
+	UpdateFilterSetMask();
+
+	// The match bitmap of the last packet refers to the previous members
+	ReleaseInfoPartition();
+
+	return nbSUCCESS;
+}
+
+
+void nbeePacketEngine::UpdateFilterSetMask()
+{
+	m_FilterSetMask.assign((m_FilterSet.size() + 31) / 32, 0);
+
+	for (unsigned int i= 0; i < m_FilterSet.size(); i++)
+	{
+		if (!m_FilterSet[i].Removed)
+			m_FilterSetMask[i / 32]|= 1U << (i % 32);
+	}
+
+	m_exbufinfo->MatchMask= m_FilterSetMask.empty() ? NULL : &m_FilterSetMask[0];
+	m_exbufinfo->MatchMaskWords= (uint32_t) m_FilterSetMask.size();
+}
+
+
+int nbeePacketEngine::AddFilter(const char *NetPFLFilterString, int *FilterID)
+{
+std::vector<_nbeeFilterSetMember> FilterSet;
+_nbeeFilterSetMember Member;
+
+	// Removed members are dropped now, since the set has to be compiled again anyway
+	for (unsigned int i= 0; i < m_FilterSet.size(); i++)
+	{
+		if (!m_FilterSet[i].Removed)
+			FilterSet.push_back(m_FilterSet[i]);
+	}
+
+	Member.ID= m_NextFilterID;
+	Member.Filter= NetPFLFilterString;
+	Member.Removed= false;
+	FilterSet.push_back(Member);
+
+	if (CompileFilterSet(FilterSet) == nbFAILURE)
+		return nbFAILURE;
+
+	m_NextFilterID++;
+	*FilterID= Member.ID;
+
+	return nbSUCCESS;
+}
+
+
+/*
+ * The member is not removed from the program: its bit is cleared from the mask applied to the
+ * match bitmap, which is enough for discarding the packets matched only by it. Hence no code is
+ * compiled nor swapped; the member is dropped from the program at the next AddFilter().
+ */
+int nbeePacketEngine::RemoveFilter(int FilterID)
+{
+	for (unsigned int i= 0; i < m_FilterSet.size(); i++)
+	{
+		if ((m_FilterSet[i].ID == FilterID) && !m_FilterSet[i].Removed)
+		{
+			m_FilterSet[i].Removed= true;
+			UpdateFilterSetMask();
+			return nbSUCCESS;
+		}
+	}
+
+	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Filter %d is not a member of the filter set", FilterID);
+	return nbFAILURE;
+}
+
+
+int nbeePacketEngine::IsFilterMatched(int FilterID)
+{
+const uint32_t *Bitmap;
+unsigned int i;
+
+	for (i= 0; i < m_FilterSet.size(); i++)
+	{
+		if ((m_FilterSet[i].ID == FilterID) && !m_FilterSet[i].Removed)
+			break;
+	}
+
+	if (i == m_FilterSet.size())
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Filter %d is not a member of the filter set", FilterID);
+		return nbFAILURE;
+	}
+
+	if ((m_Result != nbSUCCESS) || (m_exbufinfo->InfoView == NULL) || (m_exbufinfo->InfoViewLen < (i / 32 + 1) * sizeof(uint32_t)))
+		return nbFAILURE;
+
+	Bitmap= (const uint32_t *) m_exbufinfo->InfoView;
+
+	if (Bitmap[i / 32] & (1U << (i % 32)))
+		return nbSUCCESS;
+
+	return nbFAILURE;
+}
@@ -0,0 +1,707 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+#include "nbeeparallelpacketengine.h"
+#include "nbeefieldreader.h"
+#include "../globals/globals.h"
+#include "../globals/utils.h"
+
+
+
+/*
+ * Main loop of each worker: it waits for packets in the queue, it pushes them into the
+ * private runtime environment of the worker, and it delivers the accepted ones to the user.
+ *
+ * Packets are taken out of the queue in groups: the lock is held only to read the
+ * boundaries of the queue, while packets are processed without holding it (the producer
+ * never touches the slots between Tail and Head).
+ *
+ * A new program handed over by SwapFilter() is picked up between two groups: the packets
+ * taken so far have been completed by the previous program, which is then destroyed by
+ * the worker itself, since nobody else uses it.
+ */
+void ParallelEngineWorkerLoop(void *Param)
+{
+_ParallelEngineWorker *Worker= (_ParallelEngineWorker *) Param;
+nbeeParallelPacketEngine *Engine= Worker->Owner;
+unsigned int Head, Tail;
+uint64_t NumProcessed, NumAccepted;
+
+	if (Worker->CPU >= 0)
+		nbThreadSetAffinity(Worker->CPU);
+
+	while (1)
+	{
+		nbMutexLock(&Worker->QueueLock);
+
+		while ((Worker->Head == Worker->Tail) && (Worker->StopRequested == false) && (Worker->SwapPending == false))
+		{
+			Worker->Busy= false;
+			nbConditionBroadcast(&Worker->QueueDrained);
+			nbConditionWait(&Worker->QueueNotEmpty, &Worker->QueueLock);
+		}
+
+		if (Worker->SwapPending)
+		{
+			nbMutexUnlock(&Worker->QueueLock);
+
+			Engine->DestroyWorkerProgram(&Worker->Program);
+			Worker->Program= Worker->NextProgram;
+
+			nbMutexLock(&Worker->QueueLock);
+			memset(&Worker->NextProgram, 0, sizeof(_ParallelEngineProgram));
+			Worker->SwapPending= false;
+			nbConditionBroadcast(&Worker->QueueDrained);
+			nbMutexUnlock(&Worker->QueueLock);
+			continue;
+		}
+
+		if (Worker->Head == Worker->Tail)
+		{
+			// Stop requested and nothing left to do
+			Worker->Busy= false;
+			nbConditionBroadcast(&Worker->QueueDrained);
+			nbMutexUnlock(&Worker->QueueLock);
+			return;
+		}
+
+		Worker->Busy= true;
+		Head= Worker->Head;
+		Tail= Worker->Tail;
+		nbMutexUnlock(&Worker->QueueLock);
+
+		NumProcessed= 0;
+		NumAccepted= 0;
+
+		for (; Tail != Head; Tail= (Tail + 1) % PARALLEL_ENGINE_QUEUE_SIZE)
+		{
+		_ParallelEnginePacket *Packet= &Worker->Queue[Tail];
+
+			Worker->Result= nbFAILURE;
+
+			nvmWriteAppInterface(Worker->Program.Runtime.InInterf, Packet->PktData, (uint32_t) Packet->PktLen, Worker->ExbufInfo, Worker->NetVMErrBuf);
+
+			NumProcessed++;
+
+			if (Worker->Result == nbFAILURE)
+				continue;
+
+			NumAccepted++;
+
+			// The reader works directly on the info partition of the exchange buffer
+			if (Worker->Program.FieldReader)
+				Worker->Program.FieldReader->SetDataInfo(Worker->ExbufInfo->InfoView);
+
+			if (Engine->m_ResultCallback)
+				Engine->m_ResultCallback(Worker->ID, Packet->PktData, Packet->PktLen, Worker->Program.FieldReader, Engine->m_CallbackUserData);
+		}
+
+		// Statistics are updated under the lock, since GetWorkerStats() reads them from another thread
+		nbMutexLock(&Worker->QueueLock);
+		Worker->Tail= Tail;
+		Worker->NumProcessed+= NumProcessed;
+		Worker->NumAccepted+= NumAccepted;
+		nbMutexUnlock(&Worker->QueueLock);
+	}
+}
+
+
+nbeeParallelPacketEngine::nbeeParallelPacketEngine(struct _nbNetPDLDatabase *NetPDLDatabase, int NumWorkers, bool UseJit):
+m_NetPDLDatabase(NetPDLDatabase), m_UseJit(UseJit)
+{
+	m_errbuf[0]= '\0';
+	m_Compiler= nbAllocateNetPFLCompiler(m_NetPDLDatabase);
+	m_GeneratedCode= NULL;
+	m_LinkLayer= nbNETPDL_LINK_LAYER_ETHERNET;
+	m_Opt= true;
+	m_ExtractFields= false;
+	m_BytecodeHandle= NULL;
+	m_ResultCallback= NULL;
+	m_CallbackUserData= NULL;
+
+	m_NumWorkers= NumWorkers;
+	m_Workers= new _ParallelEngineWorker*[m_NumWorkers];
+
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		// Workers are large (they keep the packet queue), so we allocate them on the heap
+		m_Workers[i]= new _ParallelEngineWorker;
+		memset(m_Workers[i], 0, sizeof(_ParallelEngineWorker));
+
+		m_Workers[i]->Owner= this;
+		m_Workers[i]->ID= i;
+		m_Workers[i]->CPU= -1;
+		m_Workers[i]->Program.NField= 1;
+		m_Workers[i]->ExbufInfo= new ExBufInfo(&m_Workers[i]->Result, NULL, &m_Workers[i]->Program.NField);
+
+		nbMutexInit(&m_Workers[i]->QueueLock);
+		nbConditionInit(&m_Workers[i]->QueueNotEmpty);
+		nbConditionInit(&m_Workers[i]->QueueDrained);
+	}
+}
+
+
+nbeeParallelPacketEngine::~nbeeParallelPacketEngine(void)
+{
+	StopWorkers();
+
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		DestroyWorkerProgram(&m_Workers[i]->Program);
+
+		for (int j= 0; j < PARALLEL_ENGINE_QUEUE_SIZE; j++)
+			FREE_PTR(m_Workers[i]->Queue[j].PktData);
+
+		delete m_Workers[i]->ExbufInfo;
+
+		nbConditionDestroy(&m_Workers[i]->QueueDrained);
+		nbConditionDestroy(&m_Workers[i]->QueueNotEmpty);
+		nbMutexDestroy(&m_Workers[i]->QueueLock);
+
+		delete m_Workers[i];
+	}
+
+	delete[] m_Workers;
+
+	// The bytecode must be released only after all the PEs that refer to it
+	if (m_BytecodeHandle)
+	{
+		nvmDestroyBytecode(m_BytecodeHandle);
+		free(m_BytecodeHandle);
+	}
+
+	if (m_Compiler)
+		nbDeallocateNetPFLCompiler(m_Compiler);
+}
+
+
+void nbeeParallelPacketEngine::StopWorkers()
+{
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		if (m_Workers[i]->ThreadStarted == false)
+			continue;
+
+		nbMutexLock(&m_Workers[i]->QueueLock);
+		m_Workers[i]->StopRequested= true;
+		nbConditionSignal(&m_Workers[i]->QueueNotEmpty);
+		nbMutexUnlock(&m_Workers[i]->QueueLock);
+
+		nbThreadJoin(m_Workers[i]->Thread);
+		m_Workers[i]->ThreadStarted= false;
+	}
+}
+
+
+void nbeeParallelPacketEngine::DestroyWorkerProgram(_ParallelEngineProgram *Program)
+{
+	if (Program->FieldReader)
+	{
+		delete Program->FieldReader;
+		Program->FieldReader= NULL;
+	}
+
+	nbeeDestroyEngineRuntime(&Program->Runtime);
+}
+
+
+int nbeeParallelPacketEngine::Compile(const char *NetPFLFilterString, nbNetPDLLinkLayer_t LinkLayer, bool Opt)
+{
+int RetVal;
+char NetVMErrBuf[nvmERRBUF_SIZE];
+nbeeCompiledFilter CachedFilter;
+_nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector;
+
+	if (m_Compiler == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
+		return nbFAILURE;
+	}
+
+	if (nbeeCompileCacheLookup(m_NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, CachedFilter))
+	{
+		// The compiler is needed only for decoding 'allfields'
+		if (CachedFilter.HasAllFields() && (m_Compiler->IsInitialized() != nbSUCCESS))
+		{
+			if (m_Compiler->NetPDLInit(LinkLayer) != nbSUCCESS)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
+				return nbFAILURE;
+			}
+		}
+
+		ReleaseBytecode();
+
+		m_CompiledFilter.Swap(CachedFilter);
+		m_GeneratedCode= (char *) m_CompiledFilter.NetILCode.c_str();
+		m_LinkLayer= LinkLayer;
+		m_Opt= Opt;
+		m_ExtractFields= (m_CompiledFilter.Fields.size() > 0);
+
+		m_BytecodeHandle= nvmLoadBytecodeImageFromBuffer(&m_CompiledFilter.Bytecode[0], (uint32_t) m_CompiledFilter.Bytecode.size(), NetVMErrBuf);
+		if (m_BytecodeHandle == NULL)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), NetVMErrBuf);
+			return nbFAILURE;
+		}
+
+		return nbSUCCESS;
+	}
+
+	RetVal= m_Compiler->NetPDLInit(LinkLayer);
+
+	if (RetVal != nbSUCCESS)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
+		return nbFAILURE;
+	}
+
+	m_GeneratedCode= NULL;
+	m_LinkLayer= LinkLayer;
+	m_Opt= Opt;
+
+	RetVal = m_Compiler->CompileFilter(NetPFLFilterString, &m_GeneratedCode, Opt);
+	if (RetVal != nbSUCCESS)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), m_Compiler->GetLastError());
+		return nbFAILURE;
+	}
+
+	// The descriptors belong to the compiler; they are copied in m_CompiledFilter, from which each worker
+	// creates its own ones in CreateWorkerProgram()
+	ExtractedFieldsDescriptorVector= m_Compiler->GetExtractField();
+
+	ReleaseBytecode();
+	m_CompiledFilter.Clear();
+
+	// The NetIL code is assembled only once; all the workers will create their PE from the same bytecode
+	m_BytecodeHandle= nvmAssembleNetILFromBuffer(m_GeneratedCode, NetVMErrBuf);
+	if (m_BytecodeHandle == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), NetVMErrBuf);
+		return nbFAILURE;
+	}
+
+	m_CompiledFilter.Set(m_GeneratedCode, m_BytecodeHandle, ExtractedFieldsDescriptorVector);
+	m_ExtractFields= (m_CompiledFilter.Fields.size() > 0);
+
+	if (nbeeCompileCacheEnabled())
+		nbeeCompileCacheStore(m_NetPDLDatabase, NetPFLFilterString, LinkLayer, Opt, m_CompiledFilter);
+
+	return RetVal;
+}
+
+
+void nbeeParallelPacketEngine::ReleaseBytecode()
+{
+	if (m_BytecodeHandle == NULL)
+		return;
+
+	// Workers created on the previous bytecode must be removed before releasing it
+	StopWorkers();
+	for (int i= 0; i < m_NumWorkers; i++)
+		DestroyWorkerProgram(&m_Workers[i]->Program);
+
+	nvmDestroyBytecode(m_BytecodeHandle);
+	free(m_BytecodeHandle);
+	m_BytecodeHandle= NULL;
+}
+
+
+int nbeeParallelPacketEngine::SetWorkerAffinity(int WorkerID, int CPU)
+{
+	if ((WorkerID < 0) || (WorkerID >= m_NumWorkers))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Worker %d does not exist", WorkerID);
+		return nbFAILURE;
+	}
+
+	if (m_Workers[WorkerID]->ThreadStarted)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The affinity must be set before starting the workers");
+		return nbFAILURE;
+	}
+
+	m_Workers[WorkerID]->CPU= CPU;
+	return nbSUCCESS;
+}
+
+
+/*
+ * The runtime environment of each worker is created from scratch on the same bytecode.
+ * This must be done sequentially, since the NetVM objects keep a reference to the last
+ * runtime state created for them; once created, the runtime environments are fully
+ * independent and can be used concurrently.
+ */
+int nbeeParallelPacketEngine::CreateWorkerProgram(nvmByteCode *Bytecode, nbeeCompiledFilter &Filter, bool ExtractFields, _ParallelEngineProgram *Program, char *NetVMErrBuf)
+{
+	Program->FieldReader= NULL;
+	Program->NField= 1;
+
+	if (nbeeCreateEngineRuntime(&Program->Runtime, Bytecode, nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE, m_UseJit, NetVMErrBuf) == nbFAILURE)
+		return nbFAILURE;
+
+	if (ExtractFields)
+	{
+	// Each worker needs its own descriptors, since they are filled at every accepted packet
+	_nbExtractedFieldsDescriptorVector *ExtractedFieldsDescriptorVector;
+
+		ExtractedFieldsDescriptorVector= Filter.CreateFieldsDescriptors();
+		Program->FieldReader= new nbeeFieldReader(ExtractedFieldsDescriptorVector, NULL, m_Compiler);
+
+		// Store the number of fields to extract (except allfields)
+		if (ExtractedFieldsDescriptorVector->FieldDescriptor[ExtractedFieldsDescriptorVector->NumEntries - 1].FieldType == PDL_FIELD_TYPE_ALLFIELDS)
+			Program->NField= ExtractedFieldsDescriptorVector->NumEntries - 1;
+		else
+			Program->NField= ExtractedFieldsDescriptorVector->NumEntries;
+	}
+
+	return nbSUCCESS;
+}
+
+
+int nbeeParallelPacketEngine::InitNetVM(nbPacketEngineResultCallback *ResultCallback, void *UserData)
+{
+	if (m_BytecodeHandle == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The filter must be compiled before initializing the NetVM");
+		return nbFAILURE;
+	}
+
+	StopWorkers();
+
+	m_ResultCallback= ResultCallback;
+	m_CallbackUserData= UserData;
+
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		DestroyWorkerProgram(&m_Workers[i]->Program);
+
+		m_Workers[i]->Head= 0;
+		m_Workers[i]->Tail= 0;
+		m_Workers[i]->Busy= false;
+		m_Workers[i]->StopRequested= false;
+		m_Workers[i]->SwapPending= false;
+		m_Workers[i]->NumProcessed= 0;
+		m_Workers[i]->NumAccepted= 0;
+		m_Workers[i]->NumDropped= 0;
+
+		if (CreateWorkerProgram(m_BytecodeHandle, m_CompiledFilter, m_ExtractFields, &m_Workers[i]->Program, m_Workers[i]->NetVMErrBuf) == nbFAILURE)
+		{
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+				"Cannot create the runtime environment of worker %d: %s", i, m_Workers[i]->NetVMErrBuf);
+			return nbFAILURE;
+		}
+	}
+
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		if (nbThreadCreate(&m_Workers[i]->Thread, ParallelEngineWorkerLoop, m_Workers[i], m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+		{
+			StopWorkers();
+			return nbFAILURE;
+		}
+
+		m_Workers[i]->ThreadStarted= true;
+	}
+
+	return nbSUCCESS;
+}
+
+
+/*
+ * The new program is created for all the workers while they keep processing packets with the
+ * current one, so that nothing changes in case of failure. Then it is handed over to each worker,
+ * which switches to it between two groups of packets (see ParallelEngineWorkerLoop()): no packet
+ * is dropped, packets already taken from the queue are completed by the previous program and the
+ * others are processed by the new one. The previous bytecode is released only when all the
+ * workers have switched, since their PEs refer to it.
+ */
+int nbeeParallelPacketEngine::SwapFilter(const char *NetPFLFilterString)
+{
+nbeeCompiledFilter Filter;
+nvmByteCode *Bytecode;
+char NetVMErrBuf[nvmERRBUF_SIZE];
+_ParallelEngineProgram *Programs;
+bool Running= false;
+int i;
+
+	if (m_Compiler == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "m_Compiler Allocation Failed");
+		return nbFAILURE;
+	}
+
+	if (m_BytecodeHandle == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "A filter must be compiled before swapping it");
+		return nbFAILURE;
+	}
+
+	if (nbeeCompileProgram(m_Compiler, m_NetPDLDatabase, NetPFLFilterString, NULL, m_LinkLayer, m_Opt, Filter, m_errbuf, sizeof(m_errbuf)) == nbFAILURE)
+		return nbFAILURE;
+
+	Bytecode= nvmLoadBytecodeImageFromBuffer(&Filter.Bytecode[0], (uint32_t) Filter.Bytecode.size(), NetVMErrBuf);
+	if (Bytecode == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), NetVMErrBuf);
+		return nbFAILURE;
+	}
+
+	for (i= 0; i < m_NumWorkers; i++)
+	{
+		if (m_Workers[i]->ThreadStarted)
+			Running= true;
+	}
+
+	// Workers that are not running get their program in InitNetVM()
+	if (Running)
+	{
+		Programs= new _ParallelEngineProgram[m_NumWorkers];
+		memset(Programs, 0, m_NumWorkers * sizeof(_ParallelEngineProgram));
+
+		for (i= 0; i < m_NumWorkers; i++)
+		{
+			if (CreateWorkerProgram(Bytecode, Filter, (Filter.Fields.size() > 0), &Programs[i], NetVMErrBuf) == nbFAILURE)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+					"Cannot create the runtime environment of worker %d: %s", i, NetVMErrBuf);
+
+				for (int j= 0; j < i; j++)
+					DestroyWorkerProgram(&Programs[j]);
+				delete[] Programs;
+
+				nvmDestroyBytecode(Bytecode);
+				free(Bytecode);
+				return nbFAILURE;
+			}
+		}
+
+		for (i= 0; i < m_NumWorkers; i++)
+		{
+			if (m_Workers[i]->ThreadStarted == false)
+			{
+				DestroyWorkerProgram(&m_Workers[i]->Program);
+				m_Workers[i]->Program= Programs[i];
+				continue;
+			}
+
+			nbMutexLock(&m_Workers[i]->QueueLock);
+			m_Workers[i]->NextProgram= Programs[i];
+			m_Workers[i]->SwapPending= true;
+			nbConditionSignal(&m_Workers[i]->QueueNotEmpty);
+			nbMutexUnlock(&m_Workers[i]->QueueLock);
+		}
+
+		// Wait until no worker uses the previous program anymore
+		for (i= 0; i < m_NumWorkers; i++)
+		{
+			nbMutexLock(&m_Workers[i]->QueueLock);
+			while (m_Workers[i]->SwapPending)
+				nbConditionWait(&m_Workers[i]->QueueDrained, &m_Workers[i]->QueueLock);
+			nbMutexUnlock(&m_Workers[i]->QueueLock);
+		}
+
+		delete[] Programs;
+	}
+	else
+	{
+		for (i= 0; i < m_NumWorkers; i++)
+			DestroyWorkerProgram(&m_Workers[i]->Program);
+	}
+
+	nvmDestroyBytecode(m_BytecodeHandle);
+	free(m_BytecodeHandle);
+	m_BytecodeHandle= Bytecode;
+
+	// The previous filter (whose strings were referred by the previous field readers) is released on return
+	m_CompiledFilter.Swap(Filter);
+	m_GeneratedCode= (char *) m_CompiledFilter.NetILCode.c_str();
+	m_ExtractFields= (m_CompiledFilter.Fields.size() > 0);
+
+	return nbSUCCESS;
+}
+
+
+/*
+ * The hash is computed on the IP addresses, the transport protocol and the transport ports,
+ * which are sorted so that both directions of a flow get the same value.
+ * Packets that are not IP over Ethernet are all delivered to the first worker.
+ */
+uint32_t nbeeParallelPacketEngine::GetFlowHash(const unsigned char *PktData, int PktLen)
+{
+uint8_t FlowKey[PARALLEL_ENGINE_FLOWKEY_SIZE];
+int KeyLen= 0;
+int Offset= 12;
+int AddrLen, AddrOffset, L4Offset;
+uint16_t EtherType;
+uint8_t L4Proto;
+
+	if ((m_LinkLayer != nbNETPDL_LINK_LAYER_ETHERNET) || (PktLen < 14))
+		return 0;
+
+	EtherType= (PktData[Offset] << 8) | PktData[Offset + 1];
+	Offset+= 2;
+
+	// Skip VLAN tags
+	while (((EtherType == 0x8100) || (EtherType == 0x88A8)) && (PktLen >= Offset + 4))
+	{
+		EtherType= (PktData[Offset + 2] << 8) | PktData[Offset + 3];
+		Offset+= 4;
+	}
+
+	if ((EtherType == 0x0800) && (PktLen >= Offset + 20))
+	{
+		AddrLen= 4;
+		AddrOffset= Offset + 12;
+		L4Proto= PktData[Offset + 9];
+		L4Offset= Offset + (PktData[Offset] & 0x0F) * 4;
+
+		// Non-first fragments do not carry the transport header; the first one (which has the 'more fragments'
+		// flag set) must not use it either, otherwise the fragments of a datagram may go to different workers
+		if ((((PktData[Offset + 6] & 0x3F) << 8) | PktData[Offset + 7]) != 0)
+			L4Offset= PktLen;
+	}
+	else if ((EtherType == 0x86DD) && (PktLen >= Offset + 40))
+	{
+		AddrLen= 16;
+		AddrOffset= Offset + 8;
+		L4Proto= PktData[Offset + 6];
+		L4Offset= Offset + 40;
+	}
+	else
+		return 0;
+
+	if (memcmp(&PktData[AddrOffset], &PktData[AddrOffset + AddrLen], AddrLen) <= 0)
+	{
+		memcpy(&FlowKey[0], &PktData[AddrOffset], AddrLen);
+		memcpy(&FlowKey[AddrLen], &PktData[AddrOffset + AddrLen], AddrLen);
+	}
+	else
+	{
+		memcpy(&FlowKey[0], &PktData[AddrOffset + AddrLen], AddrLen);
+		memcpy(&FlowKey[AddrLen], &PktData[AddrOffset], AddrLen);
+	}
+	KeyLen= 2 * AddrLen;
+
+	FlowKey[KeyLen++]= L4Proto;
+
+	// TCP, UDP and SCTP have the ports in the same position
+	if (((L4Proto == 6) || (L4Proto == 17) || (L4Proto == 132)) && (PktLen >= L4Offset + 4))
+	{
+		if (memcmp(&PktData[L4Offset], &PktData[L4Offset + 2], 2) <= 0)
+		{
+			memcpy(&FlowKey[KeyLen], &PktData[L4Offset], 2);
+			memcpy(&FlowKey[KeyLen + 2], &PktData[L4Offset + 2], 2);
+		}
+		else
+		{
+			memcpy(&FlowKey[KeyLen], &PktData[L4Offset + 2], 2);
+			memcpy(&FlowKey[KeyLen + 2], &PktData[L4Offset], 2);
+		}
+		KeyLen+= 4;
+	}
+
+	return nvmHash(FlowKey, (uint8_t) KeyLen);
+}
+
+
+int nbeeParallelPacketEngine::ProcessPacket(const unsigned char *PktData, int PktLen)
+{
+_ParallelEngineWorker *Worker;
+_ParallelEnginePacket *Packet;
+unsigned int Head, NextHead;
+bool WasEmpty;
+
+	Worker= m_Workers[GetFlowHash(PktData, PktLen) % m_NumWorkers];
+
+	if (Worker->ThreadStarted == false)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "The workers have not been started");
+		return nbFAILURE;
+	}
+
+	nbMutexLock(&Worker->QueueLock);
+	Head= Worker->Head;
+	NextHead= (Head + 1) % PARALLEL_ENGINE_QUEUE_SIZE;
+
+	if (NextHead == Worker->Tail)
+	{
+		Worker->NumDropped++;
+		nbMutexUnlock(&Worker->QueueLock);
+		return nbFAILURE;
+	}
+	nbMutexUnlock(&Worker->QueueLock);
+
+	// The slot is not visible to the worker until Head is updated, so it can be filled without holding the lock
+	Packet= &Worker->Queue[Head];
+
+	if (Packet->BufferSize < PktLen)
+	{
+		FREE_PTR(Packet->PktData);
+		Packet->PktData= (unsigned char *) malloc(PktLen);
+		if (Packet->PktData == NULL)
+		{
+			Packet->BufferSize= 0;
+			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), ERROR_ALLOC_FAILED);
+			return nbFAILURE;
+		}
+		Packet->BufferSize= PktLen;
+	}
+
+	memcpy(Packet->PktData, PktData, PktLen);
+	Packet->PktLen= PktLen;
+
+	nbMutexLock(&Worker->QueueLock);
+	WasEmpty= (Worker->Head == Worker->Tail);
+	Worker->Head= NextHead;
+	if (WasEmpty)
+		nbConditionSignal(&Worker->QueueNotEmpty);
+	nbMutexUnlock(&Worker->QueueLock);
+
+	return nbSUCCESS;
+}
+
+
+int nbeeParallelPacketEngine::Flush()
+{
+	for (int i= 0; i < m_NumWorkers; i++)
+	{
+		if (m_Workers[i]->ThreadStarted == false)
+			continue;
+
+		nbMutexLock(&m_Workers[i]->QueueLock);
+		while ((m_Workers[i]->Head != m_Workers[i]->Tail) || (m_Workers[i]->Busy))
+			nbConditionWait(&m_Workers[i]->QueueDrained, &m_Workers[i]->QueueLock);
+		nbMutexUnlock(&m_Workers[i]->QueueLock);
+	}
+
+	return nbSUCCESS;
+}
+
+
+int nbeeParallelPacketEngine::GetWorkerStats(int WorkerID, uint64_t *NumProcessed, uint64_t *NumAccepted, uint64_t *NumDropped)
+{
+	if ((WorkerID < 0) || (WorkerID >= m_NumWorkers))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Worker %d does not exist", WorkerID);
+		return nbFAILURE;
+	}
+
+	nbMutexLock(&m_Workers[WorkerID]->QueueLock);
+	*NumProcessed= m_Workers[WorkerID]->NumProcessed;
+	*NumAccepted= m_Workers[WorkerID]->NumAccepted;
+	*NumDropped= m_Workers[WorkerID]->NumDropped;
+	nbMutexUnlock(&m_Workers[WorkerID]->QueueLock);
+
+	return nbSUCCESS;
+}
+
+
+_nbNetPFLCompilerMessages *nbeeParallelPacketEngine::GetCompMessageList(void)
+{
+	return m_Compiler->GetCompMessageList();
+}
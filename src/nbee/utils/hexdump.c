@@ -0,0 +1,285 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdlib.h>
+#include "hexdump.h"
+#include "../globals/globals.h"
+
+#if defined(HEXDUMP_USE_AVX2)
+#include <immintrin.h>
+#elif defined(HEXDUMP_USE_SSE2)
+#include <emmintrin.h>
+#endif
+
+
+//! Hex digits, as printed in the PDML
+static const char HexDigits[]= "0123456789ABCDEF";
+
+
+//! Value of each character as an hex digit, or -1 if the character is not an hex digit.
+static const signed char HexValues[256]=
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+
+#ifdef HEXDUMP_USE_SSE2
+
+//! Converts each nibble (0 - 15) of a vector into the corresponding hex digit.
+static __m128i NibblesToHexDigits(__m128i Nibbles)
+{
+__m128i Letters;
+
+	// Nibbles above 9 are moved from ':' onward to 'A' onward
+	Letters= _mm_and_si128(_mm_cmpgt_epi8(Nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+
+	return _mm_add_epi8(_mm_add_epi8(Nibbles, _mm_set1_epi8('0')), Letters);
+}
+
+
+/*
+	Converts 16 hex digits into 8 bytes; it returns 0 (and the content of the 'HexDumpBin' buffer
+	is not meaningful) if some character is not an hex digit.
+*/
+static int DecodeBlockSSE2(const char *HexDumpAscii, unsigned char *HexDumpBin)
+{
+__m128i Chars, Digits, Letters, IsDigit, IsLetter, Values, Bytes;
+
+	Chars= _mm_loadu_si128((const __m128i *) HexDumpAscii);
+
+	// '0' - '9' become 0 - 9, 'A' - 'F' and 'a' - 'f' become 0 - 5; other characters become larger values (as unsigned)
+	Digits= _mm_sub_epi8(Chars, _mm_set1_epi8('0'));
+	Letters= _mm_sub_epi8(_mm_or_si128(Chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+	IsDigit= _mm_cmpeq_epi8(_mm_subs_epu8(Digits, _mm_set1_epi8(9)), _mm_setzero_si128());
+	IsLetter= _mm_cmpeq_epi8(_mm_subs_epu8(Letters, _mm_set1_epi8(5)), _mm_setzero_si128());
+
+	if (_mm_movemask_epi8(_mm_or_si128(IsDigit, IsLetter)) != 0xFFFF)
+		return 0;
+
+	Values= _mm_or_si128(_mm_and_si128(IsDigit, Digits), _mm_and_si128(IsLetter, _mm_add_epi8(Letters, _mm_set1_epi8(10))));
+
+	// Each 16-bit word keeps the high nibble in its first byte and the low nibble in the second one
+	Bytes= _mm_or_si128(_mm_slli_epi16(_mm_and_si128(Values, _mm_set1_epi16(0x00FF)), 4), _mm_srli_epi16(Values, 8));
+
+	_mm_storel_epi64((__m128i *) HexDumpBin, _mm_packus_epi16(Bytes, Bytes));
+
+	return 1;
+}
+
+#endif
+
+
+/*!
+	\brief Converts a binary hex dump into the corresponding hex digits (e.g. 0xAD 0x81 becomes "AD81").
+
+	\param HexDumpBin: buffer that contains the binary dump.
+
+	\param HexDumpBinSize: number of bytes to be converted.
+
+	\param HexDumpAscii: buffer that will contain the hex digits; it must be at least
+	(2 * HexDumpBinSize) bytes long. The result is not terminated.
+*/
+void HexDumpEncode(const unsigned char *HexDumpBin, unsigned int HexDumpBinSize, char *HexDumpAscii)
+{
+unsigned int i= 0;
+
+#ifdef HEXDUMP_USE_AVX2
+	for ( ; i + 32 <= HexDumpBinSize; i+= 32)
+	{
+	__m256i Bytes, High, Low, Mask, First, Second;
+
+		Bytes= _mm256_loadu_si256((const __m256i *) &HexDumpBin[i]);
+		Mask= _mm256_set1_epi8(0x0F);
+
+		High= _mm256_and_si256(_mm256_srli_epi16(Bytes, 4), Mask);
+		Low= _mm256_and_si256(Bytes, Mask);
+
+		High= _mm256_add_epi8(_mm256_add_epi8(High, _mm256_set1_epi8('0')),
+				_mm256_and_si256(_mm256_cmpgt_epi8(High, _mm256_set1_epi8(9)), _mm256_set1_epi8('A' - '9' - 1)));
+		Low= _mm256_add_epi8(_mm256_add_epi8(Low, _mm256_set1_epi8('0')),
+				_mm256_and_si256(_mm256_cmpgt_epi8(Low, _mm256_set1_epi8(9)), _mm256_set1_epi8('A' - '9' - 1)));
+
+		// Interleaving works within each 128-bit lane, so the lanes have to be put back in order
+		First= _mm256_unpacklo_epi8(High, Low);
+		Second= _mm256_unpackhi_epi8(High, Low);
+
+		_mm256_storeu_si256((__m256i *) &HexDumpAscii[i * 2], _mm256_permute2x128_si256(First, Second, 0x20));
+		_mm256_storeu_si256((__m256i *) &HexDumpAscii[i * 2 + 32], _mm256_permute2x128_si256(First, Second, 0x31));
+	}
+#endif
+
+#ifdef HEXDUMP_USE_SSE2
+	for ( ; i + 16 <= HexDumpBinSize; i+= 16)
+	{
+	__m128i Bytes, High, Low;
+
+		Bytes= _mm_loadu_si128((const __m128i *) &HexDumpBin[i]);
+
+		High= NibblesToHexDigits(_mm_and_si128(_mm_srli_epi16(Bytes, 4), _mm_set1_epi8(0x0F)));
+		Low= NibblesToHexDigits(_mm_and_si128(Bytes, _mm_set1_epi8(0x0F)));
+
+		_mm_storeu_si128((__m128i *) &HexDumpAscii[i * 2], _mm_unpacklo_epi8(High, Low));
+		_mm_storeu_si128((__m128i *) &HexDumpAscii[i * 2 + 16], _mm_unpackhi_epi8(High, Low));
+	}
+#endif
+
+	for ( ; i < HexDumpBinSize; i++)
+	{
+		HexDumpAscii[i * 2]= HexDigits[HexDumpBin[i] >> 4];
+		HexDumpAscii[i * 2 + 1]= HexDigits[HexDumpBin[i] & 0x0F];
+	}
+}
+
+
+/*!
+	\brief Same as HexDumpEncode(), but the bytes are converted starting from the last one.
+
+	It is used for fields that are not in network byte order; these fields are short, hence
+	this function does not use any vector instruction.
+*/
+void HexDumpEncodeReversed(const unsigned char *HexDumpBin, unsigned int HexDumpBinSize, char *HexDumpAscii)
+{
+unsigned int i;
+
+	for (i= 0; i < HexDumpBinSize; i++)
+	{
+	unsigned char Byte= HexDumpBin[HexDumpBinSize - i - 1];
+
+		HexDumpAscii[i * 2]= HexDigits[Byte >> 4];
+		HexDumpAscii[i * 2 + 1]= HexDigits[Byte & 0x0F];
+	}
+}
+
+
+/*!
+	\brief Converts a string of hex digits (either upper or lower case) into the corresponding binary dump.
+
+	The conversion can be done in place (i.e. 'HexDumpBin' can be equal to 'HexDumpAscii').
+
+	\param HexDumpAscii: string that contains the hex digits; it must contain at least (2 * HexDumpBinSize)
+	characters (the terminator, if any, is not checked).
+
+	\param HexDumpBinSize: number of bytes to be obtained.
+
+	\param HexDumpBin: buffer that will contain the binary dump.
+
+	\return nbSUCCESS if everything is fine, nbFAILURE if some character is not an hex digit.
+	In this case the invalid digits are converted as zero, and the other ones are converted anyway.
+*/
+int HexDumpDecode(const char *HexDumpAscii, unsigned int HexDumpBinSize, unsigned char *HexDumpBin)
+{
+unsigned int i= 0;
+int RetVal= nbSUCCESS;
+
+#ifdef HEXDUMP_USE_SSE2
+	// Each block writes 8 bytes after having read the 16 characters that overlap them, hence it works in place as well
+	for ( ; i + 8 <= HexDumpBinSize; i+= 8)
+	{
+		if (DecodeBlockSSE2(&HexDumpAscii[i * 2], &HexDumpBin[i]) == 0)
+			break;
+	}
+#endif
+
+	// Remaining bytes, or the block containing the first invalid character
+	for ( ; i < HexDumpBinSize; i++)
+	{
+	int High= HexValues[(unsigned char) HexDumpAscii[i * 2]];
+	int Low= HexValues[(unsigned char) HexDumpAscii[i * 2 + 1]];
+
+		if ((High < 0) || (Low < 0))
+		{
+			RetVal= nbFAILURE;
+
+			if (High < 0)
+				High= 0;
+			if (Low < 0)
+				Low= 0;
+		}
+
+		HexDumpBin[i]= (unsigned char) ((High << 4) | Low);
+	}
+
+	return RetVal;
+}
+
+
+/*!
+	\brief Prints a number in hex, using exactly the given number of digits (e.g. 0x3F with 4 digits becomes "003F").
+
+	\param Value: the number; its digits beyond the requested ones are discarded.
+
+	\param NDigits: number of digits to be printed.
+
+	\param HexDumpAscii: buffer that will contain the result; it must be at least (NDigits + 1) bytes long.
+	The result is '\\0' terminated.
+*/
+void HexDumpFormatNumber(unsigned long Value, unsigned int NDigits, char *HexDumpAscii)
+{
+	HexDumpAscii[NDigits]= 0;
+
+	while (NDigits > 0)
+	{
+		HexDumpAscii[--NDigits]= HexDigits[Value & 0x0F];
+		Value= Value >> 4;
+	}
+}
+
+
+/*!
+	\brief Prints an IPv4 address in dotted decimal form (e.g. "10.11.12.13").
+
+	\param Address: the four bytes of the address, in network byte order.
+
+	\param FormattedAddress: buffer that will contain the result; it must be at least
+	HEXDUMP_IPV4_MAX_LEN bytes long. The result is '\\0' terminated.
+
+	\return The number of characters of the result, without the terminator.
+*/
+unsigned int HexDumpFormatIPv4(const unsigned char *Address, char *FormattedAddress)
+{
+char *Ptr= FormattedAddress;
+int i;
+
+	for (i= 0; i < 4; i++)
+	{
+	unsigned int Value= Address[i];
+
+		if (Value >= 100)
+		{
+			*Ptr++= (char) ('0' + Value / 100);
+			*Ptr++= (char) ('0' + (Value / 10) % 10);
+		}
+		else if (Value >= 10)
+			*Ptr++= (char) ('0' + Value / 10);
+
+		*Ptr++= (char) ('0' + Value % 10);
+		*Ptr++= '.';
+	}
+
+	// The last dot is replaced by the terminator
+	Ptr[-1]= 0;
+
+	return (unsigned int) (Ptr - FormattedAddress - 1);
+}
+
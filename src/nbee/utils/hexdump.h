@@ -0,0 +1,49 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/*!
+	\file hexdump.h
+
+	This file defines the kernels used to convert packet data into hex (and decimal) text and back.
+
+	These conversions are done for each field of each packet when the PDML is generated, hence they
+	use the SSE2 or AVX2 instructions when the compiler targets them; a scalar version is used on the
+	other platforms, or when HEXDUMP_NO_SIMD is defined.
+*/
+
+
+#pragma once		/* Do not include this file more than once */
+
+
+#if !defined(HEXDUMP_NO_SIMD) && defined(__AVX2__)
+	#define HEXDUMP_USE_AVX2
+#endif
+
+#if !defined(HEXDUMP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+	#define HEXDUMP_USE_SSE2
+#endif
+
+
+//! Maximum length of an IPv4 address in dotted decimal form, including the terminator
+#define HEXDUMP_IPV4_MAX_LEN 16
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+void HexDumpEncode(const unsigned char *HexDumpBin, unsigned int HexDumpBinSize, char *HexDumpAscii);
+void HexDumpEncodeReversed(const unsigned char *HexDumpBin, unsigned int HexDumpBinSize, char *HexDumpAscii);
+int HexDumpDecode(const char *HexDumpAscii, unsigned int HexDumpBinSize, unsigned char *HexDumpBin);
+void HexDumpFormatNumber(unsigned long Value, unsigned int NDigits, char *HexDumpAscii);
+unsigned int HexDumpFormatIPv4(const unsigned char *Address, char *FormattedAddress);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "hexdump.h"
 #include "../globals/debug.h"
 #include "../globals/globals.h"
 
@@ -179,25 +181,30 @@ int NetPDLHexDumpToLong(unsigned char *HexDumpPtr, int ResultSize, int HexDumpIs
 */
 int ConvertHexDumpAsciiToHexDumpBin(char *HexDumpAscii, unsigned char *HexDumpBin, int HexDumpBinSize)
 {
-int DumpIndex= 0;
+int AsciiLength;
+int DumpSize;
+int DecodedSize;
 
-	while ( (HexDumpAscii[DumpIndex*2] != 0) && (DumpIndex < HexDumpBinSize) )
-	{
-	char Low, High;
+	AsciiLength= (int) strlen(HexDumpAscii);
 
-		High= ConvertHexCharToDec(HexDumpAscii[DumpIndex*2]) << 4;
-		Low= ConvertHexCharToDec(HexDumpAscii[DumpIndex*2 + 1]);
+	// A trailing digit is considered the high nibble of the last byte
+	DumpSize= (AsciiLength + 1) / 2;
 
-		HexDumpBin[DumpIndex]= High + Low;
+	DecodedSize= AsciiLength / 2;
+	if (DecodedSize > HexDumpBinSize)
+		DecodedSize= HexDumpBinSize;
 
-		DumpIndex++;
-	}
+	if (HexDumpDecode(HexDumpAscii, DecodedSize, HexDumpBin) == nbFAILURE)
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, NULL, 0, "An Hex number is out of range");
 
 	// Check if the return buffer is big enough
-	if (HexDumpAscii[DumpIndex*2] != 0)
+	if (DumpSize > HexDumpBinSize)
 		return nbFAILURE;
-	else
-		return DumpIndex;
+
+	if (AsciiLength % 2)
+		HexDumpBin[DumpSize - 1]= ConvertHexCharToDec(HexDumpAscii[AsciiLength - 1]) << 4;
+
+	return DumpSize;
 }
 
 
@@ -229,42 +236,18 @@ int DumpIndex= 0;
 */
 int ConvertHexDumpBinToHexDumpAscii(char *HexDumpBin, int HexDumpBinSize, int HexDumpIsInNetworkByteOrder, char *HexDumpAscii, int HexDumpAsciiSize)
 {
-int DumpIndex;
-
-	// Check if the return buffer is big enough
-	if (HexDumpBinSize >= (HexDumpAsciiSize*2))
+	// Check if the return buffer is big enough (including the terminator)
+	if ((HexDumpBinSize * 2) >= HexDumpAsciiSize)
 		return nbFAILURE;
 
-	for (DumpIndex= 0; DumpIndex < HexDumpBinSize; DumpIndex++)
-	{
-	char Low, High;
-
-		if (HexDumpIsInNetworkByteOrder)
-		{
-			High= (HexDumpBin[DumpIndex] >> 4) & '\x0F'; // There may be problems due to the sign, so I have to mask the first nibble
-			Low= HexDumpBin[DumpIndex] & '\x0F';
-		}
-		else
-		{
-			High= (HexDumpBin[HexDumpBinSize - DumpIndex - 1] >> 4) & '\x0F'; // There may be problems due to the sign, so I have to mask the first nibble
-			Low= HexDumpBin[HexDumpBinSize - DumpIndex - 1] & '\x0F';
-		}
-
-
-		if (High > 9)
-			HexDumpAscii[DumpIndex*2]= 'A' + (High - 10);
-		else
-			HexDumpAscii[DumpIndex*2]= '0' + High;
-
-		if (Low > 9)
-			HexDumpAscii[DumpIndex*2+1]= 'A' + (Low - 10);
-		else
-			HexDumpAscii[DumpIndex*2+1]= '0' + Low;
-	}
+	if (HexDumpIsInNetworkByteOrder)
+		HexDumpEncode((unsigned char *) HexDumpBin, HexDumpBinSize, HexDumpAscii);
+	else
+		HexDumpEncodeReversed((unsigned char *) HexDumpBin, HexDumpBinSize, HexDumpAscii);
 
-	HexDumpAscii[DumpIndex*2]= 0;
+	HexDumpAscii[HexDumpBinSize * 2]= 0;
 
-	return (DumpIndex * 2);
+	return (HexDumpBinSize * 2);
 }
 
 
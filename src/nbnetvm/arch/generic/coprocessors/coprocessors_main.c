@@ -48,7 +48,10 @@ nvmCoprocessorStateMapEntry nvm_copro_map[] = {
 	  tables. Since you cannot instantiate multiple coprocessors at the same
 	  time, this was the trick used.
 	  
-	Obviously, we should reduce the coprocessors to one only, sooner or later...
+	All of them are now thin interfaces on top of the same table engine
+	(lookup_table.c), which supports multiple tables and batched lookups;
+	they are kept as separate coprocessors only because existing NetIL
+	programs refer to them by name.
 */
 	{"lookup", nvmCoproLookupCreate},
 	{"lookupnew", nvmCoproLookupNewCreate},
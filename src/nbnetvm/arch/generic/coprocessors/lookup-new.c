@@ -12,12 +12,9 @@
 #include "../../../../nbee/globals/debug.h"
 #include "../../../../nbee/globals/profiling-functions.h"
 #include "../../../coprocessor.h"
+#include "lookup_table.h"
 
-#ifdef WIN32
-#define STATIC_INLINE __forceinline
-#else
-#define STATIC_INLINE static inline
-#endif
+/* This coprocessor is a compatibility interface on top of the table engine in lookup_table.c */
 
 /* Coprocessor operations */
 enum {
@@ -27,7 +24,7 @@ enum {
 };
 
 #define MAX_HASH_DATA_SIZE 5
-#define HASH_TABLE_ENTRIES 0x10000
+#define LOOKUP_INITIAL_ENTRIES 0x10000
 
 
 // #define LOOKUP_COPRO_DEBUG
@@ -39,137 +36,13 @@ enum {
 #define ludebug(...)
 #endif
 
-typedef struct hash_table_data_s {
-	uint32_t data[MAX_HASH_DATA_SIZE];
-	uint32_t val0, val1;
-	struct hash_table_data_s *next;
-} hash_table_data;
-
 
 typedef struct {
 	uint32_t *hash_data;
-	int data_used;
-	hash_table_data *table[HASH_TABLE_ENTRIES];
-	uint32_t counters[HASH_TABLE_ENTRIES];
+	nvmLookupTable *table;
 } lookup_data;
 
 
-
-STATIC_INLINE void lookup_new_print_data(uint8_t *data, uint32_t len, const char* endl)
-{
-	uint32_t i;
-	for (i = 0; i < len; i++)
-	{
-		ludebug("%u ", data[i]);
-	}
-	ludebug("%s", endl);
-}
-
-
-
-STATIC_INLINE hash_table_data *lookup_new_data_new (uint32_t data[MAX_HASH_DATA_SIZE], int used, uint32_t val0, uint32_t val1) {
-	hash_table_data *out;
-
-	out = (hash_table_data *) malloc (sizeof (hash_table_data));
-	if (!out) {
-		exit (2);
-	} else {
-		memcpy (out -> data, data, used * sizeof (uint32_t));
-		out -> val0 = val0;
-		out -> val1 = val1;
-		out -> next = NULL;
-	}
-
-	return (out);
-}
-
-
-STATIC_INLINE hash_table_data *lookup_new_list_get (hash_table_data *head, uint32_t data[MAX_HASH_DATA_SIZE], int used) {
-	hash_table_data *cur;
-
-	for (cur = head; cur; cur = cur -> next) {
-		if (memcmp (cur -> data, data, used * sizeof (uint32_t)) == 0)
-			break;
-	}
-
-	return (cur);
-}
-
-
-STATIC_INLINE hash_table_data *lookup_new_list_append (hash_table_data *head, hash_table_data *element) {
-	hash_table_data *cur;
-
-	if (!head) {
-		head = element;
-	} else {
-		for (cur = head; cur -> next; cur = cur -> next)
-			;
-		cur -> next = element;
-	}
-
-	return (head);
-}
-
-
-/*
-	HASH Function code (C) by Paul Hsieh
-	http://www.azillionmonkeys.com/qed/hash.html
-*/
-
-#if !defined (get16bits)
-#define get16bits(d) ((((const uint8_t *)(d))[1] << 8)\
-                      +((const uint8_t *)(d))[0])
-#endif
-
-STATIC_INLINE uint32_t lookup_new_hsieh_hash (uint8_t *data, uint8_t len) {
-	uint32_t hash = len, tmp = 0;
-	int rem = 0;
-
-    NETVM_ASSERT(len > 0 && data != NULL, "wrong arguments");
-
-    ludebug("Hashing ");
-    lookup_new_print_data(data, len, "\n");
-
-
-    rem = len & 3;
-    len >>= 2;
-
-    /* Main loop */
-    for (;len > 0; len--) {
-        hash  += get16bits (data);
-        tmp    = (get16bits (data+2) << 11) ^ hash;
-        hash   = (hash << 16) ^ tmp;
-        data  += 2*sizeof (uint16_t);
-        hash  += hash >> 11;
-    }
-
-    /* Handle end cases */
-    switch (rem) {
-        case 3: hash += get16bits (data);
-                hash ^= hash << 16;
-                hash ^= data[sizeof (uint16_t)] << 18;
-                hash += hash >> 11;
-                break;
-        case 2: hash += get16bits (data);
-                hash ^= hash << 11;
-                hash += hash >> 17;
-                break;
-        case 1: hash += *data;
-                hash ^= hash << 10;
-                hash += hash >> 1;
-    }
-
-    /* Force "avalanching" of final 127 bits */
-    hash ^= hash << 3;
-    hash += hash >> 5;
-    hash ^= hash << 2;
-    hash += hash >> 15;
-    hash ^= hash << 10;
-
-    ludebug("result: %u\n", hash);
-    return hash;
-}
-
 static void lookup_new_reset_regs(nvmCoprocessorState *c)
 {
 	memset(c->registers, 0, c->n_regs * sizeof(uint32_t));
@@ -177,51 +50,35 @@ static void lookup_new_reset_regs(nvmCoprocessorState *c)
 
 
 
-static  void lookup_new_insert (nvmCoprocessorState *c) {
-	uint32_t hash;
-	hash_table_data **ptr, *entry;
+static  int32_t lookup_new_insert (nvmCoprocessorState *c) {
+	uint8_t *entry;
+	uint32_t *value;
 	lookup_data *ldata = c->data;
 
-	hash = lookup_new_hsieh_hash ((uint8_t *) c->registers, ldata -> data_used * 4);
-	ludebug ("Hash: %u\n", hash);
-	hash %= HASH_TABLE_ENTRIES;
-	ludebug ("Hashed data to %u\n", hash);
-	ludebug("insert data_used: %u ", ldata->data_used);
-	entry = lookup_new_list_get ((ldata -> table)[hash], ldata -> hash_data, ldata -> data_used);
-	if (entry) {
-		/* An entry in the list for the given data already exists, just update it */
-		ludebug ("Entry in list already exists, updating\n");
-
-		entry -> val0 = c->registers[5];
-		entry -> val1 = c->registers[6];
-	} else {
-		/* Create a new entry in the list */
-		ludebug ("Creating new entry in list\n");
-
-		ptr = &((ldata -> table)[hash]);
-		entry = lookup_new_data_new (ldata -> hash_data, ldata -> data_used, c->registers[5], c->registers[6]);
-		*ptr = lookup_new_list_append (*ptr, entry);
-		(ldata -> table)[hash] = *ptr;
-		(ldata -> counters)[hash]++;
-		ludebug ("Num entries for hash %u: %u\n", hash, (ldata -> counters)[hash]);
+	entry = nvmLookupTableInsert (ldata -> table, (uint8_t *) ldata -> hash_data, NULL);
+	if (entry == NULL) {
+		printf ("Lookup coprocessor: the new entry cannot be inserted\n");
+		return (nvmFAILURE);
 	}
 
+	value = nvmLookupTableValue (ldata -> table, entry);
+	value[0] = c->registers[5];
+	value[1] = c->registers[6];
+	ludebug ("Num entries: %u\n", ldata -> table -> n_entries);
+	return (nvmSUCCESS);
 }
 
 
 static int lookup_new_lookup (nvmCoprocessorState *c){
-	uint32_t hash;
-	hash_table_data *entry;
+	uint8_t *entry;
+	uint32_t *value;
 	lookup_data *ldata = c->data;
 
-	hash = lookup_new_hsieh_hash ((uint8_t *) c->registers, ldata -> data_used * 4);
-	hash %= HASH_TABLE_ENTRIES;
-
-
-	entry = lookup_new_list_get ((ldata -> table)[hash], ldata -> hash_data, ldata -> data_used);
+	entry = nvmLookupTableLookup (ldata -> table, (uint8_t *) ldata -> hash_data);
 	if (entry) {
-		c->registers[5] = entry -> val0;
-		c->registers[6] = entry -> val1;
+		value = nvmLookupTableValue (ldata -> table, entry);
+		c->registers[5] = value[0];
+		c->registers[6] = value[1];
 #ifndef _EXP_COPROCESSOR_MODEL
 		c->registers[7] = 1;
 #endif
@@ -259,15 +116,11 @@ static void lookup_new_print_copro_state(nvmCoprocessorState *c)
 
 int32_t nvmLookupNewCoproInit (nvmCoprocessorState *c, void *useless) {
 	lookup_data *ldata = c->data;
-	uint32_t i;
 
 	ludebug ("Lookup coprocessor initialising\n");
 
-	for (i = 0; i < HASH_TABLE_ENTRIES; i++) {
-		(ldata -> table)[i] = NULL;
-	}
+	nvmLookupTableClear (ldata -> table);
 
-//	ldata->data_used = c->registers[0];
 	return (nvmSUCCESS);
 }
 
@@ -275,6 +128,7 @@ int32_t nvmLookupNewCoproInit (nvmCoprocessorState *c, void *useless) {
 
 static int32_t nvmLookupNewCoproInvoke (nvmCoprocessorState *c, uint32_t operation)
 {
+	int32_t RetVal = nvmSUCCESS;
 
 #ifdef RTE_PROFILE_COUNTERS
 	c->ProfCounter_tot->TicksStart= nbProfilerGetTime();
@@ -291,7 +145,7 @@ static int32_t nvmLookupNewCoproInvoke (nvmCoprocessorState *c, uint32_t operati
 		case LOOKUP_OP_INSERT:
 			ludebug ("Lookup coprocessor - Insert op\n");
 
-			lookup_new_insert(c);
+			RetVal = lookup_new_insert(c);
 			break;
 		case LOOKUP_OP_LOOKUP:
 			/* Retrieve the value assigned to hashed data. */
@@ -314,7 +168,7 @@ static int32_t nvmLookupNewCoproInvoke (nvmCoprocessorState *c, uint32_t operati
 		c->ProfCounter[operation]->NumPkts++;
 #endif
 
-	return (nvmSUCCESS);
+	return (RetVal);
 }
 
 
@@ -352,6 +206,7 @@ int32_t nvmCoproLookupNewCreate(nvmCoprocessorState *lookup)
 	};
 
 	uint32_t num_regs = 8;
+	lookup_data *ldata;
 
 #ifdef RTE_PROFILE_COUNTERS
 	uint32_t i;
@@ -378,14 +233,20 @@ int32_t nvmCoproLookupNewCreate(nvmCoprocessorState *lookup)
 	lookup->OpFunctions[LOOKUP_OP_LOOKUP] = lookup_new_lookup;
 #endif
 
-	lookup->data =calloc(1, sizeof(lookup_data));
-	if(lookup->data == NULL)
+	ldata =calloc(1, sizeof(lookup_data));
+	lookup->data = ldata;
+	if(ldata == NULL)
 	{
 		printf("Error in allocating lookup->data\n");
 		return nvmFAILURE;
 	}
-	((lookup_data*)lookup->data)->hash_data = lookup->registers;
-	((lookup_data*)lookup->data)->data_used = 5; //
+	ldata->hash_data = lookup->registers;
+	ldata->table = nvmLookupTableCreate(MAX_HASH_DATA_SIZE * sizeof(uint32_t), 2, LOOKUP_INITIAL_ENTRIES);
+	if(ldata->table == NULL)
+	{
+		printf("Error in allocating the lookup table\n");
+		return nvmFAILURE;
+	}
 
 	lookup->xbuf = NULL;
 #ifdef RTE_PROFILE_COUNTERS
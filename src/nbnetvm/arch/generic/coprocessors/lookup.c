@@ -11,7 +11,11 @@
 
 /* This lookup coprocessor has two registers:
    - R0, R/W: Used to provide/retrieve data.
-   - R1, W: Set to a non-zero value if, when reading data, data is valid. */
+   - R1, W: Set to a non-zero value if, when reading data, data is valid.
+
+   It is a compatibility interface on top of the table engine in lookup_table.c: the key
+   is loaded incrementally (up to MAX_HASH_DATA_SIZE words), and the number of words
+   that have been loaded is part of the key. */
 
 #include <stdlib.h>
 #include <string.h>
@@ -26,6 +30,7 @@
 #include <helpers.h>
 #include "../../../coprocessor.h"
 #include "../../../../nbee/globals/profiling-functions.h"
+#include "lookup_table.h"
 
 
 /* Coprocessor operations */
@@ -38,7 +43,7 @@ enum {
 };
 
 #define MAX_HASH_DATA_SIZE 16
-#define HASH_TABLE_ENTRIES 50000
+#define LOOKUP_INITIAL_ENTRIES 50000
 
 
 // #define LOOKUP_COPRO_DEBUG
@@ -50,132 +55,25 @@ enum {
 #define ludebug(...)
 #endif
 
-typedef struct hash_table_data_s {
-	uint32_t data[MAX_HASH_DATA_SIZE];
-	uint32_t value;
-	struct hash_table_data_s *next;
-} hash_table_data;
-
 
 typedef struct {
-	uint32_t hash_data[MAX_HASH_DATA_SIZE];
+	uint32_t hash_data[MAX_HASH_DATA_SIZE + 1];	//!< Key: number of words used, followed by the words (unused ones are zero)
 	int data_used;
-	hash_table_data *table[HASH_TABLE_ENTRIES];
+	nvmLookupTable *table;
 } lookup_data;
 
 
-static hash_table_data *data_new (uint32_t data[MAX_HASH_DATA_SIZE], int used, uint32_t value) {
-	hash_table_data *out;
-
-	out = (hash_table_data *) malloc (sizeof (hash_table_data));
-	if (!out) {
-		exit (2);
-	} else {
-		memcpy (out -> data, data, used * sizeof (uint32_t));
-		out -> value = value;
-		out -> next = NULL;
-	}
-
-	return (out);
-}
-
-
-static hash_table_data *list_get (hash_table_data *head, uint32_t data[MAX_HASH_DATA_SIZE], int used) {
-	hash_table_data *cur;
-
-	for (cur = head; cur; cur = cur -> next) {
-		if (memcmp (cur -> data, data, used * sizeof (uint32_t)) == 0)
-			break;
-	}
-
-	return (cur);
-}
-
-
-static hash_table_data *list_append (hash_table_data *head, hash_table_data *element) {
-	hash_table_data *cur;
-
-	if (!head) {
-		head = element;
-	} else {
-		for (cur = head; cur -> next; cur = cur -> next)
-			;
-		cur -> next = element;
-	}
-
-	return (head);
-}
-
-
-/*
-	HASH Function code (C) by Paul Hsieh
-	http://www.azillionmonkeys.com/qed/hash.html
-*/
-
-#if !defined (get16bits)
-#define get16bits(d) ((((const uint8_t *)(d))[1] << 8)\
-                      +((const uint8_t *)(d))[0])
-#endif
-
-static uint32_t hsieh_hash (uint8_t *data, uint8_t len)
+static void reset_key (lookup_data *ldata)
 {
-uint32_t hash = len, tmp = 0;
-int rem = 0;
-
-	if (len <= 0 || data == NULL)
-		return 0;
-
-	rem = len & 3;
-	len >>= 2;
-
-	/* Main loop */
-	for (;len > 0; len--)
-	{
-		hash  += get16bits (data);
-		tmp    = (get16bits (data+2) << 11) ^ hash;
-		hash   = (hash << 16) ^ tmp;
-		data  += 2*sizeof (uint16_t);
-		hash  += hash >> 11;
-	}
-
-
-	/* Handle end cases */
-	switch (rem)
-	{
-	case 3: hash += get16bits (data);
-			hash ^= hash << 16;
-			hash ^= data[sizeof (uint16_t)] << 18;
-			hash += hash >> 11;
-			break;
-	case 2: hash += get16bits (data);
-			hash ^= hash << 11;
-			hash += hash >> 17;
-			break;
-	case 1: hash += *data;
-			hash ^= hash << 10;
-			hash += hash >> 1;
-	}
-
-	/* Force "avalanching" of final 127 bits */
-	hash ^= hash << 3;
-	hash += hash >> 5;
-	hash ^= hash << 2;
-	hash += hash >> 15;
-	hash ^= hash << 10;
-
-	return hash;
+	memset (ldata -> hash_data, 0, sizeof (ldata -> hash_data));
+	ldata -> data_used = 0;
 }
 
 
 static void init (lookup_data *ldata)
 {
-int i;
-
-	ldata -> data_used = 0;
-	for (i = 0; i < HASH_TABLE_ENTRIES; i++)
-	{
-		(ldata -> table)[i] = NULL;
-	}
+	reset_key (ldata);
+	nvmLookupTableClear (ldata -> table);
 
 	return;
 }
@@ -183,62 +81,51 @@ int i;
 
 static void add_data (lookup_data *ldata, uint32_t data)
 {
-	(ldata -> hash_data)[ldata -> data_used] = data;
+	if (ldata -> data_used >= MAX_HASH_DATA_SIZE)
+	{
+		printf ("Lookup coprocessor: key longer than %d words\n", MAX_HASH_DATA_SIZE);
+		return;
+	}
+
 	(ldata -> data_used)++;
+	(ldata -> hash_data)[0] = ldata -> data_used;
+	(ldata -> hash_data)[ldata -> data_used] = data;
 
 	return;
 }
 
 
-static void add_value (lookup_data *ldata, uint32_t value)
+static int32_t add_value (lookup_data *ldata, uint32_t value)
 {
-uint32_t hash;
-hash_table_data **ptr, *entry;
-
-	hash = hsieh_hash ((uint8_t *) &(ldata -> hash_data), ldata -> data_used * 4);
-	hash %= HASH_TABLE_ENTRIES;
-	ludebug ("Hashed data to %u\n", hash);
+uint8_t *entry;
 
-	entry = list_get ((ldata -> table)[hash], ldata -> hash_data, ldata -> data_used);
-	if (entry)
+	entry = nvmLookupTableInsert (ldata -> table, (uint8_t *) ldata -> hash_data, NULL);
+	if (entry == NULL)
 	{
-		/* An entry in the list for the given data already exists, just update it */
-		ludebug ("Entry in list already exists, updating\n");
-
-		entry -> value = value;
+		printf ("Lookup coprocessor: the new entry cannot be inserted\n");
+		return (nvmFAILURE);
 	}
-	else
-	{
-		/* Create a new entry in the list */
-		ludebug ("Creating new entry in list\n");
 
-		ptr = &((ldata -> table)[hash]);
-		entry = data_new (ldata -> hash_data, ldata -> data_used, value);
-		*ptr = list_append (*ptr, entry);
-		(ldata -> table)[hash] = *ptr;
-	}
+	ludebug ("Lookup coprocessor: setting value %u\n", value);
+	nvmLookupTableValue (ldata -> table, entry)[0] = value;
 
-	return;
+	return (nvmSUCCESS);
 }
 
 
 static void get_value (lookup_data *ldata, uint32_t *value, uint32_t *valid)
 {
-uint32_t hash;
-hash_table_data *entry;
-
-	hash = hsieh_hash ((uint8_t *) &(ldata -> hash_data), ldata -> data_used * 4);
-	hash %= HASH_TABLE_ENTRIES;
+uint8_t *entry;
 
 #ifdef LOOKUP_COPRO_DEBUG
 	ludebug("Data: ");
-	hex_and_ascii_print_with_offset(stdout, "\n", (uint8_t *) &(ldata -> hash_data), ldata -> data_used * 4, 0);
+	hex_and_ascii_print_with_offset(stdout, "\n", (uint8_t *) &(ldata -> hash_data[1]), ldata -> data_used * 4, 0);
 	ludebug("\n");
 #endif
 
-	entry = list_get ((ldata -> table)[hash], ldata -> hash_data, ldata -> data_used);
+	entry = nvmLookupTableLookup (ldata -> table, (uint8_t *) ldata -> hash_data);
 	if (entry) {
-		*value = entry -> value;
+		*value = nvmLookupTableValue (ldata -> table, entry)[0];
 		*valid = 1;
 		ludebug ("Got match!\n");
 	} else {
@@ -256,6 +143,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation)
 {
 	lookup_data *ldata;
 	uint32_t *data, *valid;
+	int32_t RetVal = nvmSUCCESS;
 
 	
 #ifdef RTE_PROFILE_COUNTERS
@@ -298,7 +186,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation)
 			/* Set value to be assigned to hashed data. Also triggers hash computation. */
 			ludebug ("Lookup coprocessor - Insert op, added value: %u\n", *data);
 
-			add_value (ldata, *data);
+			RetVal = add_value (ldata, *data);
 			break;
 		case LOOKUP_OP_READ_VALUE:
 			/* Retrieve value assigned to hashed data. */
@@ -315,7 +203,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation)
 		case LOOKUP_OP_RESET:
 			ludebug ("Lookup coprocessor reset\n");
 			/* Please note that this is NOT meant to reset the whole coprocessor */
-			ldata -> data_used = 0;
+			reset_key (ldata);
 			break;
 		default:
 			/* Unsupported operation. This should throw an exception. */
@@ -332,7 +220,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation)
 		c->ProfCounter[operation]->NumPkts++;
 #endif
 
-	return (nvmSUCCESS);
+	return (RetVal);
 }
 
 
@@ -351,6 +239,7 @@ int32_t nvmCoproLookupCreate(nvmCoprocessorState *lookup)
 {
 	static uint8_t flags[]={COPREG_WRITE | COPREG_READ, COPREG_READ};
 	static uint32_t regs[]={0,0};
+	lookup_data *ldata;
 
 #ifdef RTE_PROFILE_COUNTERS
 	uint32_t i;
@@ -376,12 +265,19 @@ int32_t nvmCoproLookupCreate(nvmCoprocessorState *lookup)
 	lookup->write =nvmCoproStandardRegWrite;
 	lookup->read = nvmCoproStandardRegRead;
 	lookup->invoke = copro_lookup_run;
-	lookup->data =malloc(sizeof(lookup_data));
-	if(lookup->data == NULL)
+	ldata = calloc(1, sizeof(lookup_data));
+	lookup->data = ldata;
+	if(ldata == NULL)
 	{
 		printf("Error in allocating lookup->data\n");
 		return nvmFAILURE;
 	}
+	ldata->table = nvmLookupTableCreate(sizeof(ldata->hash_data), 1, LOOKUP_INITIAL_ENTRIES);
+	if(ldata->table == NULL)
+	{
+		printf("Error in allocating the lookup table\n");
+		return nvmFAILURE;
+	}
 	lookup->xbuf = NULL;
 
 #ifdef RTE_PROFILE_COUNTERS
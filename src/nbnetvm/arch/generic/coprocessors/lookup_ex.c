@@ -17,12 +17,23 @@ INITIALIZATION:
 OTHER OPERATION:
 - R0, W:   -Id of the table to use   
 - R1, W:   -Value of the key/value to set(4B) /Offset to read or write(operations: GetValue and UpdateValue)
+           -Index of the key in the batch (operation: batch select)
 - R2, W:   -Value of the key to set(4B)
 - R3, W:   -Value of the key to set(4B)  
 - R4, W:   -Value of the key to set(4B)
 - R5, W:   -Key/Value size in byte
 - R6, R/W: -Value to read(operation: get value)- Value to write(operation: update value) 
 - R7, R:   -Flag register
+           -Index of the key in the batch (operation: batch add)
+           -Bitmap of the keys found (operation: batch lookup)
+
+BATCHED LOOKUPS:
+Keys loaded with ADD_KEY can be queued with BATCH_ADD (up to LOOKUP_TABLE_BATCH_SIZE keys);
+BATCH_LOOKUP looks for all of them at once, and BATCH_SELECT selects the entry found for one
+of them, so that it can be accessed with GET_VALUE, UPD_VALUE and DELETE.
+
+Tables are kept by the engine in lookup_table.c; the number of entries given at table
+initialization is preallocated, but tables grow beyond that size when needed.
 */
 
 
@@ -31,6 +42,7 @@ OTHER OPERATION:
 #include "nbnetvm.h"
 #include "../../../coprocessor.h"
 #include "../../../../nbee/globals/profiling-functions.h"
+#include "lookup_table.h"
 
 
 /* Coprocessor operations */
@@ -43,271 +55,137 @@ enum {
 	LOOKUP_EX_OP_GET_VALUE = 5,
 	LOOKUP_EX_OP_UPD_VALUE = 6,
 	LOOKUP_EX_OP_DELETE = 7,
-	LOOKUP_EX_OP_RESET = 8
+	LOOKUP_EX_OP_RESET = 8,
+	LOOKUP_EX_OP_BATCH_ADD = 9,
+	LOOKUP_EX_OP_BATCH_LOOKUP = 10,
+	LOOKUP_EX_OP_BATCH_SELECT = 11,
+	LOOKUP_EX_OP_COUNT
 };
 
 //#define LOOKUP_EX_COPRO_DEBUG
 
-typedef struct hash_table_entry_ex_s {
-	uint32_t *key;
-	uint32_t *value;
-	struct hash_table_entry_ex_s *next;
-} hash_table_entry_ex;
+
+typedef struct {
+	nvmLookupTable *table;
+	uint8_t *key;						//!< Key being loaded with ADD_KEY (key_size bytes, zero-padded)
+	uint32_t key_used;
+	uint32_t value_used;
+	uint8_t *selected;					//!< Entry selected by the last ADD_VALUE, SELECT or BATCH_SELECT
+
+	uint8_t *batch_keys;				//!< Keys queued by BATCH_ADD
+	uint32_t batch_used;
+	uint32_t batch_done;				//!< Number of keys looked up by the last BATCH_LOOKUP
+	uint8_t *batch_results[LOOKUP_TABLE_BATCH_SIZE];
+} lookup_ex_table;
 
 
 typedef struct {
 	uint32_t tables;
-
-	uint32_t *entries;
-	uint32_t *key_size;
-	uint32_t *value_size;
-	uint32_t *key_used;
-	uint32_t *value_used;
-	uint8_t  **hash_key;
-	uint32_t  **hash_value;
-
-	hash_table_entry_ex **selected;
-	uint32_t *hash;
-	hash_table_entry_ex ***table;
+	lookup_ex_table *table;
 } lookup_ex_data;
 
 
-static hash_table_entry_ex *list_get (hash_table_entry_ex *head, uint8_t *key, int key_size) {
-	hash_table_entry_ex *cur;
+static void free_tables (lookup_ex_data *ldata) {
+	uint32_t i;
 
-	for (cur = head; cur; cur = cur -> next) {
-		if (memcmp (cur -> key, key, key_size * sizeof(uint8_t)) == 0)
-			break;
+	for (i = 0; i < ldata -> tables; i++)
+	{
+		nvmLookupTableDestroy (ldata -> table[i].table);
+		free (ldata -> table[i].key);
+		free (ldata -> table[i].batch_keys);
 	}
+	free (ldata -> table);
 
-	return (cur);
+	ldata -> table = NULL;
+	ldata -> tables = 0;
 }
 
 
-static hash_table_entry_ex *list_append (hash_table_entry_ex *head, hash_table_entry_ex *element) {
-	hash_table_entry_ex *cur;
+/* Returns the table selected by R0, if it has been initialized */
+static lookup_ex_table *get_table (nvmCoprocessorState *c) {
+	lookup_ex_data *ldata = c->data;
 
-	if (!head) {
-		head = element;
-	} else {
-		for (cur = head; cur -> next; cur = cur -> next)
-			;
-		cur -> next = element;
-	}
+	if (c->registers[0] >= ldata -> tables)
+		return NULL;
+	if (ldata -> table[c->registers[0]].table == NULL)
+		return NULL;
 
-	return (head);
+	return &(ldata -> table[c->registers[0]]);
 }
 
 
-/*
-HASH Function code (C) by Paul Hsieh
-http://www.azillionmonkeys.com/qed/hash.html
-*/
-
-#if !defined (get16bits)
-#define get16bits(d) ((((const uint8_t *)(d))[1] << 8)\
-	+((const uint8_t *)(d))[0])
-#endif
-
-static uint32_t hsieh_hash (uint8_t *data, uint8_t len) {
-	uint32_t hash = len, tmp = 0;
-	int rem = 0;
-
-	if (len <= 0 || data == NULL) return 0;
-
-	rem = len & 3;
-	len >>= 2;
-
-	/* Main loop */
-	for (;len > 0; len--) {
-		hash  += get16bits (data);
-		tmp    = (get16bits (data+2) << 11) ^ hash;
-		hash   = (hash << 16) ^ tmp;
-		data  += 2*sizeof (uint16_t);
-		hash  += hash >> 11;
-	}
-
-	/* Handle end cases */
-	switch (rem) {
-		case 3: hash += get16bits (data);
-			hash ^= hash << 16;
-			hash ^= data[sizeof (uint16_t)] << 18;
-			hash += hash >> 11;
-			break;
-		case 2: hash += get16bits (data);
-			hash ^= hash << 11;
-			hash += hash >> 17;
-			break;
-		case 1: hash += *data;
-			hash ^= hash << 10;
-			hash += hash >> 1;
-	}
-
-	/* Force "avalanching" of final 127 bits */
-	hash ^= hash << 3;
-	hash += hash >> 5;
-	hash ^= hash << 2;
-	hash += hash >> 15;
-	hash ^= hash << 10;
-
-	return hash;
-}
-
 static /*inline*/ int8_t reset_table (nvmCoprocessorState *c) {
-	 lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t = get_table (c);
 
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> key_used == NULL)
-		return nvmFAILURE;
-	if (ldata -> value_used == NULL)
-		return nvmFAILURE;
-	if (ldata -> selected == NULL)
+	if (t == NULL)
 		return nvmFAILURE;
 
-
-	(ldata -> key_used)[c->registers[0]] = 0;
-	(ldata -> value_used)[c->registers[0]] = 0;
-	(ldata -> selected)[c->registers[0]] = NULL;
-	(ldata -> hash)[c->registers[0]] = 0;
+	memset (t -> key, 0, t -> table -> key_size);
+	t -> key_used = 0;
+	t -> value_used = 0;
+	t -> selected = NULL;
 
 	return nvmSUCCESS;
 }
 
 
 static /*inline*/ int8_t init (nvmCoprocessorState *c) {
-    lookup_ex_data *ldata = c->data;
-
-	ldata -> key_size = calloc(c->registers[0], sizeof(uint32_t));
-	if (ldata -> key_size == NULL)
-		return nvmFAILURE;
-
-	ldata -> key_used = calloc(c->registers[0], sizeof(uint32_t));
-	if (ldata -> key_used == NULL)
-		return nvmFAILURE;
-
-	ldata -> value_size = calloc(c->registers[0], sizeof(uint32_t));
-	if (ldata -> value_size == NULL)
-		return nvmFAILURE;
-
-	ldata -> value_used = calloc(c->registers[0], sizeof(uint32_t));
-	if (ldata -> value_used == NULL)
-		return nvmFAILURE;
-
-	ldata -> hash_key = calloc(c->registers[0], sizeof(uint32_t *));
-	if (ldata -> hash_key == NULL)
-		return nvmFAILURE;
-
-	ldata -> hash_value = calloc(c->registers[0], sizeof(uint32_t *));
-	if (ldata -> hash_value == NULL)
-		return nvmFAILURE;
-
-	ldata -> entries = calloc(c->registers[0], sizeof(uint32_t *));
-	if (ldata -> entries == NULL)
-		return nvmFAILURE;
+	lookup_ex_data *ldata = c->data;
 
-	ldata -> hash = calloc(c->registers[0], sizeof(uint32_t *));
-	if (ldata -> hash == NULL)
-		return nvmFAILURE;
+	free_tables (ldata);
 
-	ldata -> table = calloc(c->registers[0], sizeof(hash_table_entry_ex **));
+	ldata -> table = calloc(c->registers[0], sizeof(lookup_ex_table));
 	if (ldata -> table == NULL)
 		return nvmFAILURE;
 
-	ldata -> selected = calloc(c->registers[0], sizeof(hash_table_entry_ex *));
-	if (ldata -> selected == NULL)
-		return nvmFAILURE;
-
 	ldata -> tables = c->registers[0];
 
 	return nvmSUCCESS;
 }
 
 static /*inline*/ int8_t init_table (nvmCoprocessorState *c) {
-    lookup_ex_data *ldata = c->data;
+	lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t;
 
 	if (c->registers[0] >= ldata -> tables)
 		return nvmFAILURE;
-	if (ldata -> entries == NULL)
-		return nvmFAILURE;
-	if (ldata -> key_size == NULL)
-		return nvmFAILURE;
-	if (ldata -> value_size == NULL)
-		return nvmFAILURE;
-
-	(ldata -> entries)[c->registers[0]] = c->registers[1];
-	(ldata -> key_size)[c->registers[0]] = c->registers[2];
-	(ldata -> value_size)[c->registers[0]] = c->registers[3];
-
-	if ((ldata -> entries)[c->registers[0]] > 0)
-	{
-		(ldata -> table)[c->registers[0]] = calloc((ldata -> entries)[c->registers[0]], sizeof(hash_table_entry_ex *));
-		if ((ldata -> table)[c->registers[0]] == NULL)
-			return nvmFAILURE;
-	}
-	if ((ldata -> key_size)[c->registers[0]] > 0)
-	{
-		(ldata -> hash_key)[c->registers[0]] = calloc((ldata -> key_size)[c->registers[0]], sizeof(uint8_t));
-		if ((ldata -> hash_key)[c->registers[0]] == NULL)
-			return nvmFAILURE;
-	}
-	if ((ldata -> value_size)[c->registers[0]] > 0)
-	{
-		(ldata -> hash_value)[c->registers[0]] = calloc((ldata -> value_size)[c->registers[0]], sizeof(uint32_t));
-		if ((ldata -> hash_value)[c->registers[0]] == NULL)
-			return nvmFAILURE;
-	}
-
-	reset_table (c);
-	return nvmSUCCESS;
-}
 
+	t = &(ldata -> table[c->registers[0]]);
+	nvmLookupTableDestroy (t -> table);
+	free (t -> key);
+	free (t -> batch_keys);
+	memset (t, 0, sizeof(lookup_ex_table));
 
+	t -> table = nvmLookupTableCreate(c->registers[2], c->registers[3], c->registers[1]);
+	if (t -> table == NULL)
+		return nvmFAILURE;
 
-static hash_table_entry_ex *key_new (uint8_t *key, uint32_t key_size, uint32_t *value, uint32_t value_size) {
-	hash_table_entry_ex *out;
-
-	out = (hash_table_entry_ex *) malloc (sizeof (hash_table_entry_ex));
-	out -> key = malloc(key_size * sizeof(uint8_t));
-	out -> value = malloc(value_size * sizeof(uint32_t));
+	t -> key = calloc(c->registers[2], sizeof(uint8_t));
+	if (t -> key == NULL)
+		return nvmFAILURE;
 
-	memcpy (out -> key, key, key_size * sizeof(uint8_t));
-	memcpy (out -> value, value, value_size * sizeof(uint32_t));
-	out -> next = NULL;
+	t -> batch_keys = calloc(LOOKUP_TABLE_BATCH_SIZE * c->registers[2], sizeof(uint8_t));
+	if (t -> batch_keys == NULL)
+		return nvmFAILURE;
 
-	return (out);
+	return reset_table (c);
 }
 
+
 static /*inline*/ int8_t add_key (nvmCoprocessorState *c) {
-	lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t = get_table (c);
 
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> key_used == NULL)
-		return nvmFAILURE;
-	if (ldata -> hash_key == NULL || (ldata -> hash_key)[c->registers[0]] == NULL)
+	if (t == NULL)
 		return nvmFAILURE;
 
 	/*control key field in byte*/
 	switch(c->registers[5]){
 		case 2:
-			if (((ldata -> key_used)[c->registers[0]]+ c->registers[5]-1) < (ldata -> key_size)[c->registers[0]])
-			{ 
-				memcpy(&((ldata -> hash_key)[c->registers[0]][(ldata -> key_used)[c->registers[0]]]), &(c->registers[1]), 2*sizeof(uint8_t) );
-				(ldata -> key_used)[c->registers[0]]+= 2;
-			}else
-			{
-		#ifdef LOOKUP_EX_COPRO_DEBUG
-				printf("LookupEx ERROR: You cannot add a key with a size greater than what has been initialized\n");
-		#endif
-				return nvmFAILURE;
-			}
-			break;
 		case 4:
-			if (((ldata -> key_used)[c->registers[0]]+ c->registers[5]-1) < (ldata -> key_size)[c->registers[0]])
+			if ((t -> key_used + c->registers[5]) <= t -> table -> key_size)
 			{ 
-				memcpy(&((ldata -> hash_key)[c->registers[0]][(ldata -> key_used)[c->registers[0]]]),&(c->registers[1]), 4*sizeof(uint8_t));
-				(ldata -> key_used)[c->registers[0]]+= 4;
+				memcpy(&(t -> key[t -> key_used]), &(c->registers[1]), c->registers[5] * sizeof(uint8_t));
+				t -> key_used+= c->registers[5];
 			}else
 			{
 		#ifdef LOOKUP_EX_COPRO_DEBUG
@@ -322,58 +200,23 @@ static /*inline*/ int8_t add_key (nvmCoprocessorState *c) {
 
 
 static /*inline*/ int8_t add_value (nvmCoprocessorState *c) {
-	uint32_t hash;
-	hash_table_entry_ex **ptr, *entry;
-	lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t = get_table (c);
 
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> value_used == NULL)
-		return nvmFAILURE;
-	if (ldata -> hash_value == NULL || (ldata -> hash_value)[c->registers[0]] == NULL)
+	if (t == NULL)
 		return nvmFAILURE;
   
-	if ((ldata -> value_used)[c->registers[0]] == 0)
+	if (t -> value_used == 0)
 	{
-        if (ldata -> key_used == NULL)
-			return nvmFAILURE;
-		if (ldata -> hash_key == NULL || (ldata -> hash_key)[c->registers[0]] == NULL)
+		/* The first value selects the entry of the key, and creates it if it does not exist yet */
+		t -> selected = nvmLookupTableInsert (t -> table, t -> key, NULL);
+		if (t -> selected == NULL)
 			return nvmFAILURE;
-		if (ldata -> table == NULL || (ldata -> table)[c->registers[0]] == NULL)
-			return nvmFAILURE;
-		if (ldata -> hash == NULL)
-			return nvmFAILURE;
-
-		hash = hsieh_hash ((uint8_t *) &(ldata -> hash_key)[c->registers[0]], (ldata -> key_size)[c->registers[0]]);
-		hash %= (ldata -> entries)[c->registers[0]];
-		entry = list_get ((ldata -> table)[c->registers[0]][hash], (ldata -> hash_key)[c->registers[0]], (ldata -> key_used)[c->registers[0]]);
-		if (entry) {
-			/* An entry in the list for the given key already exists, just update it */
-#ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("     - LookupEx: table %u entry to add already existant, update it\n", table_id);
-#endif
-			memcpy (entry -> value, (ldata -> hash_value)[c->registers[0]], (ldata -> value_size)[c->registers[0]] * sizeof(uint32_t));
-		} else {
-			/* Create a new entry in the list */
-#ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("     - LookupEx: table %u entry to add not found, add it\n", table_id);
-#endif
-            ptr = &((ldata -> table)[c->registers[0]][hash]);
-			entry = key_new ((ldata -> hash_key)[c->registers[0]], (ldata -> key_size)[c->registers[0]], (ldata -> hash_value)[c->registers[0]], (ldata -> value_size)[c->registers[0]]);
-			if (entry == NULL)
-				return nvmFAILURE;
-			*ptr = list_append (*ptr, entry);
-			(ldata -> table)[c->registers[0]][hash] = *ptr;
-		}
-
-		(ldata -> selected)[c->registers[0]] = entry;
-		(ldata -> hash)[c->registers[0]] = hash;
 	}
 
-	if ((ldata -> value_used)[c->registers[0]] < (ldata -> value_size)[c->registers[0]])
+	if (t -> selected != NULL && t -> value_used < t -> table -> value_size)
 	{
-		(ldata -> hash_value)[c->registers[0]][(ldata -> value_used)[c->registers[0]]] = c->registers[1];
-		(ldata -> value_used)[c->registers[0]]++;
+		nvmLookupTableValue (t -> table, t -> selected)[t -> value_used] = c->registers[1];
+		t -> value_used++;
 	}
 
 	return nvmSUCCESS;
@@ -381,90 +224,48 @@ static /*inline*/ int8_t add_value (nvmCoprocessorState *c) {
 
 
 static /*inline*/ int8_t delete_selection (nvmCoprocessorState *c) {
-	lookup_ex_data *ldata = c->data;
-	hash_table_entry_ex *cur = NULL;
-	hash_table_entry_ex *prev = NULL;
-	hash_table_entry_ex *to_delete = NULL;
+	lookup_ex_table *t = get_table (c);
+	uint32_t i;
 
-	if (ldata -> table == NULL || (ldata -> table)[c->registers[0]] == NULL)
-		return nvmFAILURE;
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> selected == NULL)
-		return nvmFAILURE;
-	if (ldata -> hash == NULL)
+	if (t == NULL)
 		return nvmFAILURE;
 
-	// entry to delete
-	to_delete = (ldata -> selected)[c->registers[0]];
-
-	if ( (ldata -> selected)[c->registers[0]] != NULL && (ldata -> selected)[c->registers[0]] -> value != NULL)
+	if (t -> selected == NULL)
 	{
-		cur = (ldata -> table)[c->registers[0]][ (ldata -> hash)[c->registers[0]] ];
-		prev = (ldata -> table)[c->registers[0]][ (ldata -> hash)[c->registers[0]] ];
-		while (cur != NULL) {
-			if (cur == to_delete)
-			{
-				if (prev == cur)
-					// remove the head
-					(ldata -> table)[c->registers[0]][ (ldata -> hash)[c->registers[0]] ] = cur -> next;
-				else
-					// replace the 'next' pointer of the previous entry
-					prev -> next = cur -> next;
-
-				break;
-			}
-
-			if (prev != cur)
-				prev = cur;
-			cur = cur -> next;
-		}
-
-		free(to_delete -> key);
-		free(to_delete -> value);
-		free(to_delete);
-
 #ifdef LOOKUP_EX_COPRO_DEBUG
-		printf("LookupEx: selected entry deleted\n");
+		printf("LookupEx ERROR: trying to delete when no entry has been selected\n");
 #endif
+		return nvmFAILURE;
 	}
-	else
+
+	nvmLookupTableDelete (t -> table, t -> selected);
+
+	/* The entry may have been returned by the last batch as well */
+	for (i = 0; i < t -> batch_done; i++)
 	{
+		if (t -> batch_results[i] == t -> selected)
+			t -> batch_results[i] = NULL;
+	}
+	t -> selected = NULL;
+
 #ifdef LOOKUP_EX_COPRO_DEBUG
-		printf("LookupEx ERROR: trying to delete when no entry has been selected\n");
+	printf("LookupEx: selected entry deleted\n");
 #endif
-		return nvmFAILURE;
-	}
 
 	return nvmSUCCESS;
 }
 
 
 static /*inline*/ int8_t select_value (nvmCoprocessorState *c) {
-	uint32_t hash;
-	hash_table_entry_ex *entry;
-	lookup_ex_data *ldata = c->data;
-	
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> key_used == NULL)
-		return nvmFAILURE;
-	if (ldata -> hash_key == NULL || (ldata -> hash_key)[c->registers[0]] == NULL)
-		return nvmFAILURE;
-	if (ldata -> table == NULL || (ldata -> table)[c->registers[0]] == NULL)
-		return nvmFAILURE;
-	if (ldata -> entries == NULL)
-		return nvmFAILURE;
-	if (ldata -> selected == NULL)
-		return nvmFAILURE;
+	lookup_ex_table *t = get_table (c);
+	uint8_t *entry;
 
-	hash = hsieh_hash ((uint8_t *) &(ldata -> hash_key)[c->registers[0]], (ldata -> key_size)[c->registers[0]]);
-	hash %= (ldata -> entries)[c->registers[0]];
-	entry = list_get ((ldata -> table)[c->registers[0]][hash], (ldata -> hash_key)[c->registers[0]], (ldata -> key_used)[c->registers[0]]);
-	(ldata -> hash)[c->registers[0]] = hash;
+	if (t == NULL)
+		return nvmFAILURE;
 
+	entry = nvmLookupTableLookup (t -> table, t -> key);
 	if (entry) {
-		(ldata -> selected)[c->registers[0]] = entry;
+		t -> selected = entry;
 		c->registers[7] = 1;
 	} else {
 		c->registers[7] = 0;
@@ -473,36 +274,30 @@ static /*inline*/ int8_t select_value (nvmCoprocessorState *c) {
 }
 
 static /*inline*/ int8_t get_value (nvmCoprocessorState *c) {
-	lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t = get_table (c);
 
-	if (c->registers[0] >= ldata -> tables)
+	if (t == NULL)
 		return nvmFAILURE;
-	if (ldata -> value_size == NULL)
+	if (c->registers[1] >= t -> table -> value_size)
 		return nvmFAILURE;
-	if (c->registers[1] >= (ldata -> value_size)[c->registers[0]])
-		return nvmFAILURE;
-	if (ldata -> selected == NULL || (ldata -> selected)[c->registers[0]] == NULL)
+	if (t -> selected == NULL)
 		return nvmFAILURE;
 
-	c->registers[6] = (ldata -> hash_value)[c->registers[0]][c->registers[1]];
+	c->registers[6] = nvmLookupTableValue (t -> table, t -> selected)[c->registers[1]];
 
 	return nvmSUCCESS;
 }
 
 static /*inline*/ int8_t upd_value (nvmCoprocessorState *c) {
-	lookup_ex_data *ldata = c->data;
+	lookup_ex_table *t = get_table (c);
 
-	if (c->registers[0] >= ldata -> tables)
-		return nvmFAILURE;
-	if (ldata -> value_size == NULL)
-		return nvmFAILURE;
-	if (c->registers[1] >= (ldata -> value_size)[c->registers[0]])
+	if (t == NULL)
 		return nvmFAILURE;
-	if (ldata -> selected == NULL)
+	if (c->registers[1] >= t -> table -> value_size)
 		return nvmFAILURE;
 
-	if ( (ldata -> selected)[c->registers[0]] != NULL && (ldata -> selected)[c->registers[0]] -> value != NULL)
-		( (ldata -> selected)[c->registers[0]] -> value )[c->registers[1]] = c->registers[6];
+	if (t -> selected != NULL)
+		nvmLookupTableValue (t -> table, t -> selected)[c->registers[1]] = c->registers[6];
 	else
 	{
 #ifdef LOOKUP_EX_COPRO_DEBUG
@@ -514,6 +309,64 @@ static /*inline*/ int8_t upd_value (nvmCoprocessorState *c) {
 	return nvmSUCCESS;
 }
 
+static /*inline*/ int8_t batch_add (nvmCoprocessorState *c) {
+	lookup_ex_table *t = get_table (c);
+
+	if (t == NULL)
+		return nvmFAILURE;
+	if (t -> batch_used >= LOOKUP_TABLE_BATCH_SIZE)
+		return nvmFAILURE;
+
+	memcpy (&(t -> batch_keys[t -> batch_used * t -> table -> key_size]), t -> key, t -> table -> key_size);
+	c->registers[7] = t -> batch_used;
+	t -> batch_used++;
+
+	/* Get ready for the next key */
+	memset (t -> key, 0, t -> table -> key_size);
+	t -> key_used = 0;
+
+	return nvmSUCCESS;
+}
+
+static /*inline*/ int8_t batch_lookup (nvmCoprocessorState *c) {
+	lookup_ex_table *t = get_table (c);
+	uint32_t i;
+
+	if (t == NULL)
+		return nvmFAILURE;
+
+	nvmLookupTableLookupBatch (t -> table, t -> batch_keys, t -> batch_used, t -> batch_results);
+
+	c->registers[7] = 0;
+	for (i = 0; i < t -> batch_used; i++)
+	{
+		if (t -> batch_results[i] != NULL)
+			c->registers[7] |= (1 << i);
+	}
+
+	t -> batch_done = t -> batch_used;
+	t -> batch_used = 0;
+
+	return nvmSUCCESS;
+}
+
+static /*inline*/ int8_t batch_select (nvmCoprocessorState *c) {
+	lookup_ex_table *t = get_table (c);
+
+	if (t == NULL)
+		return nvmFAILURE;
+	if (c->registers[1] >= t -> batch_done)
+		return nvmFAILURE;
+
+	if (t -> batch_results[c->registers[1]] != NULL) {
+		t -> selected = t -> batch_results[c->registers[1]];
+		c->registers[7] = 1;
+	} else {
+		c->registers[7] = 0;
+	}
+	return nvmSUCCESS;
+}
+
 /********* CALLBACKS *********/
 
 static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
@@ -528,7 +381,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_INIT:
 			/* Reset coprocessor state. */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("- LookupEx: reset (tables %u)\n", *table_id);
+			printf ("- LookupEx: reset (tables %u)\n", c->registers[0]);
 #endif
 			result = init (c);
 			break;
@@ -536,7 +389,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_INIT_TABLE:
 			/* Reset table state. */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u reset (entries %u, key size %u, value size %u)\n", *table_id, *reg1, *reg2, *reg3);
+			printf ("  - LookupEx: table %u reset (entries %u, key size %u, value size %u)\n", c->registers[0], c->registers[1], c->registers[2], c->registers[3]);
 #endif
 			result = init_table (c);
 			break;
@@ -544,7 +397,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_ADD_KEY:
 			/* Add a value to compute the hash on. */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("    - LookupEx: table %u add key (%X)\n", *table_id, *reg1);
+			printf ("    - LookupEx: table %u add key (%X)\n", c->registers[0], c->registers[1]);
 #endif
 			result = add_key (c);
 			break;
@@ -552,7 +405,7 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_ADD_VALUE:
 			/* Set value to be assigned to hashed key. Also triggers hash computation. */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("    - LookupEx: table %u add value (%X)\n", *table_id, *reg1);
+			printf ("    - LookupEx: table %u add value (%X)\n", c->registers[0], c->registers[1]);
 #endif
 			result = add_value (c);
 			break;
@@ -560,12 +413,12 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_SELECT:
 			/* Select the entry assigned to hashed key. */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u select entry \n", *table_id);
+			printf ("  - LookupEx: table %u select entry \n", c->registers[0]);
 #endif
 			result = select_value(c);
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			if (*reg1!=0)
-				printf ("  - LookupEx: table %u entry found\n", *table_id);
+			if (c->registers[7]!=0)
+				printf ("  - LookupEx: table %u entry found\n", c->registers[0]);
 #endif
 			break;
 
@@ -573,14 +426,14 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 			/* Retrieve value with the specified offset */
 			result = get_value (c);
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u read %X at offset %u\n", *table_id, *reg2, *reg1);
+			printf ("  - LookupEx: table %u read %X at offset %u\n", c->registers[0], c->registers[6], c->registers[1]);
 #endif
 			break;
 
 		case LOOKUP_EX_OP_UPD_VALUE:
 			/* Update value with the specified offset */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u update value (offset %u, value %u)\n", *table_id, *reg1, *reg2);
+			printf ("  - LookupEx: table %u update value (offset %u, value %u)\n", c->registers[0], c->registers[1], c->registers[6]);
 #endif
 			result = upd_value (c);
 			break;
@@ -588,19 +441,42 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 		case LOOKUP_EX_OP_DELETE:
 			/* Delete the selected entry */
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u delete entry\n", *table_id);
+			printf ("  - LookupEx: table %u delete entry\n", c->registers[0]);
 #endif
-			//result = delete_selection (ldata, *table_id);
 			result = delete_selection (c);
 			break;
 
 		case LOOKUP_EX_OP_RESET:
 #ifdef LOOKUP_EX_COPRO_DEBUG
-			printf ("  - LookupEx: table %u reset\n", *table_id);
+			printf ("  - LookupEx: table %u reset\n", c->registers[0]);
 #endif
 			result = reset_table (c);
 			break;
 
+		case LOOKUP_EX_OP_BATCH_ADD:
+			/* Queue the current key for a batched lookup */
+#ifdef LOOKUP_EX_COPRO_DEBUG
+			printf ("  - LookupEx: table %u queue key for batch\n", c->registers[0]);
+#endif
+			result = batch_add (c);
+			break;
+
+		case LOOKUP_EX_OP_BATCH_LOOKUP:
+			/* Look for all the queued keys */
+			result = batch_lookup (c);
+#ifdef LOOKUP_EX_COPRO_DEBUG
+			printf ("  - LookupEx: table %u batch lookup (found %X)\n", c->registers[0], c->registers[7]);
+#endif
+			break;
+
+		case LOOKUP_EX_OP_BATCH_SELECT:
+			/* Select the entry found for one of the keys of the last batch */
+#ifdef LOOKUP_EX_COPRO_DEBUG
+			printf ("  - LookupEx: table %u select batch entry %u\n", c->registers[0], c->registers[1]);
+#endif
+			result = batch_select (c);
+			break;
+
 		default:
 			/* Unsupported operation. This should throw an exception. */
 			printf ("LookupEx: unsupported operation: %u\n", operation);
@@ -615,7 +491,8 @@ static int32_t copro_lookup_run (nvmCoprocessorState *c, uint32_t operation) {
 #ifdef RTE_PROFILE_COUNTERS
 	c->ProfCounter_tot->TicksEnd= nbProfilerGetTime();
 	c->ProfCounter_tot->NumTicks += c->ProfCounter_tot->TicksEnd - c->ProfCounter_tot->TicksStart - c->ProfCounter_tot->TicksDelta;
-	c->ProfCounter[operation]->NumTicks += c->ProfCounter_tot->TicksEnd - c->ProfCounter_tot->TicksStart - c->ProfCounter_tot->TicksDelta;
+	if (operation < LOOKUP_EX_OP_COUNT)
+		c->ProfCounter[operation]->NumTicks += c->ProfCounter_tot->TicksEnd - c->ProfCounter_tot->TicksStart - c->ProfCounter_tot->TicksDelta;
 #endif
 
 	return result;
@@ -655,7 +532,7 @@ int32_t nvmCoproLookupEx_Create(nvmCoprocessorState *lookup)
 	lookup->write =nvmCoproStandardRegWrite;
 	lookup->read = nvmCoproStandardRegRead;
 	lookup->invoke = copro_lookup_run;
-	lookup->data =malloc(sizeof(lookup_ex_data));
+	lookup->data =calloc(1, sizeof(lookup_ex_data));
 	if(lookup->data == NULL)
 	{
 		printf("Error in allocating lookup->data\n");
@@ -664,8 +541,8 @@ int32_t nvmCoproLookupEx_Create(nvmCoprocessorState *lookup)
 	lookup->xbuf = NULL;
 
 #ifdef RTE_PROFILE_COUNTERS
-		lookup->ProfCounter=calloc (1, 5 * sizeof(nvmCounter *));
-		for (i=0; i<4; i++)
+		lookup->ProfCounter=calloc (1, LOOKUP_EX_OP_COUNT * sizeof(nvmCounter *));
+		for (i=0; i<LOOKUP_EX_OP_COUNT; i++)
 		{
 			lookup->ProfCounter[i]=calloc (1, sizeof(nvmCounter));
 			lookup->ProfCounter[i]->TicksDelta= nbProfilerGetMeasureCost();
@@ -676,5 +553,3 @@ int32_t nvmCoproLookupEx_Create(nvmCoprocessorState *lookup)
 #endif
 	return nvmSUCCESS;
 }
-
-
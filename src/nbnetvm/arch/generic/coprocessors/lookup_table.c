@@ -0,0 +1,528 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file lookup_table.c
+ *	\brief This file contains the hash table engine shared by all the lookup coprocessors.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lookup_table.h"
+
+
+#if defined(__GNUC__)
+#define LOOKUP_PREFETCH(ptr) __builtin_prefetch(ptr)
+#elif defined(WIN32)
+#include <xmmintrin.h>
+#define LOOKUP_PREFETCH(ptr) _mm_prefetch((const char *) (ptr), _MM_HINT_T0)
+#else
+#define LOOKUP_PREFETCH(ptr)
+#endif
+
+//! Size of a cache line; buckets are aligned to this value
+#define LOOKUP_TABLE_CACHE_LINE 64
+
+//! The bucket array is enlarged when it is filled more than LOOKUP_TABLE_MAX_LOAD / 10
+#define LOOKUP_TABLE_MAX_LOAD 9
+
+//! Maximum number of buckets of a table
+#define LOOKUP_TABLE_MAX_BUCKETS 0x80000000
+
+//! Number of times the bucket array can be doubled by a single resize when the entries do not fit
+#define LOOKUP_TABLE_MAX_RESIZES 4
+
+
+/*
+	HASH Function code (C) by Paul Hsieh
+	http://www.azillionmonkeys.com/qed/hash.html
+*/
+
+#if !defined (get16bits)
+#define get16bits(d) ((((const uint8_t *)(d))[1] << 8)\
+                      +((const uint8_t *)(d))[0])
+#endif
+
+static uint32_t hsieh_hash (const uint8_t *data, uint32_t len, uint32_t seed)
+{
+uint32_t hash = len ^ seed, tmp = 0;
+int rem = 0;
+
+	rem = len & 3;
+	len >>= 2;
+
+	/* Main loop */
+	for (;len > 0; len--)
+	{
+		hash  += get16bits (data);
+		tmp    = (get16bits (data+2) << 11) ^ hash;
+		hash   = (hash << 16) ^ tmp;
+		data  += 2*sizeof (uint16_t);
+		hash  += hash >> 11;
+	}
+
+	/* Handle end cases */
+	switch (rem)
+	{
+	case 3: hash += get16bits (data);
+			hash ^= hash << 16;
+			hash ^= data[sizeof (uint16_t)] << 18;
+			hash += hash >> 11;
+			break;
+	case 2: hash += get16bits (data);
+			hash ^= hash << 11;
+			hash += hash >> 17;
+			break;
+	case 1: hash += *data;
+			hash ^= hash << 10;
+			hash += hash >> 1;
+	}
+
+	/* Force "avalanching" of final 127 bits */
+	hash ^= hash << 3;
+	hash += hash >> 5;
+	hash ^= hash << 2;
+	hash += hash >> 15;
+	hash ^= hash << 10;
+
+	/* Tag 0 marks empty slots */
+	return (hash != 0) ? hash : 1;
+}
+
+
+/* Returns a seed for the hash of a new table; every table gets a different one, so that keys
+   that collide in a table (e.g. because they have been chosen on purpose) do not collide in the others. */
+static uint32_t new_seed (nvmLookupTable *table)
+{
+static uint32_t counter = 0;
+uint32_t seed;
+
+	seed = (uint32_t) time (NULL) ^ (uint32_t) (uintptr_t) table ^ (++counter * 0x9e3779b9);
+
+	/* Mix the bits (MurmurHash3 finalizer) */
+	seed ^= seed >> 16;
+	seed *= 0x85ebca6b;
+	seed ^= seed >> 13;
+	seed *= 0xc2b2ae35;
+	seed ^= seed >> 16;
+	return seed;
+}
+
+
+/* Returns the other bucket in which a key can be stored; it can be computed from the tag only,
+   so that entries can be moved (and the table enlarged) without reading their keys. */
+static uint32_t alt_bucket (uint32_t bucket, uint32_t tag, uint32_t mask)
+{
+	return (bucket ^ (((tag >> 16) | (tag << 16)) * 0x5bd1e995)) & mask;
+}
+
+
+static uint8_t *entry_ptr (nvmLookupTable *table, uint32_t index)
+{
+	return table->chunks[index >> LOOKUP_TABLE_CHUNK_ENTRIES_SHIFT] + (index & (LOOKUP_TABLE_CHUNK_ENTRIES - 1)) * table->entry_size;
+}
+
+
+static nvmLookupTableBucket *alloc_buckets (uint32_t n_buckets, void **mem)
+{
+uintptr_t addr;
+
+	*mem = calloc (1, n_buckets * sizeof (nvmLookupTableBucket) + LOOKUP_TABLE_CACHE_LINE);
+	if (*mem == NULL)
+		return NULL;
+
+	addr = ((uintptr_t) *mem + LOOKUP_TABLE_CACHE_LINE - 1) & ~((uintptr_t) LOOKUP_TABLE_CACHE_LINE - 1);
+	return (nvmLookupTableBucket *) addr;
+}
+
+
+static int32_t add_chunk (nvmLookupTable *table)
+{
+uint8_t **chunks;
+
+	if (table->n_chunks == table->max_chunks)
+	{
+		chunks = realloc (table->chunks, (table->max_chunks * 2 + 1) * sizeof (uint8_t *));
+		if (chunks == NULL)
+			return nvmFAILURE;
+		table->chunks = chunks;
+		table->max_chunks = table->max_chunks * 2 + 1;
+	}
+
+	table->chunks[table->n_chunks] = malloc (LOOKUP_TABLE_CHUNK_ENTRIES * table->entry_size);
+	if (table->chunks[table->n_chunks] == NULL)
+		return nvmFAILURE;
+
+	table->n_chunks++;
+	return nvmSUCCESS;
+}
+
+
+static uint32_t alloc_entry (nvmLookupTable *table)
+{
+uint32_t index;
+
+	if (table->free_list != LOOKUP_TABLE_NO_ENTRY)
+	{
+		index = table->free_list;
+		memcpy (&table->free_list, entry_ptr (table, index), sizeof (uint32_t));
+		return index;
+	}
+
+	if (table->arena_used == table->n_chunks * LOOKUP_TABLE_CHUNK_ENTRIES)
+	{
+		if (add_chunk (table) == nvmFAILURE)
+			return LOOKUP_TABLE_NO_ENTRY;
+	}
+
+	return table->arena_used++;
+}
+
+
+static void free_entry (nvmLookupTable *table, uint32_t index)
+{
+	memcpy (entry_ptr (table, index), &table->free_list, sizeof (uint32_t));
+	table->free_list = index;
+}
+
+
+static int place_in_bucket (nvmLookupTableBucket *bucket, uint32_t tag, uint32_t index)
+{
+int i;
+
+	for (i = 0; i < LOOKUP_TABLE_BUCKET_SLOTS; i++)
+	{
+		if (bucket->tag[i] == 0)
+		{
+			bucket->tag[i] = tag;
+			bucket->entry[i] = index;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+/* Swaps the (tag, index) pair with the one stored in a slot */
+static void swap_slot (nvmLookupTableBucket *bucket, uint32_t slot, uint32_t *tag, uint32_t *index)
+{
+uint32_t tmp;
+
+	tmp = bucket->tag[slot];
+	bucket->tag[slot] = *tag;
+	*tag = tmp;
+	tmp = bucket->entry[slot];
+	bucket->entry[slot] = *index;
+	*index = tmp;
+}
+
+
+/* Stores the (tag, index) pair in one of its buckets, displacing other pairs if both are full.
+   If no room can be found, returns 0 and leaves the buckets, 'tag' and 'index' unchanged. */
+static int place (nvmLookupTableBucket *buckets, uint32_t mask, uint32_t *kick_slot, uint32_t *tag, uint32_t *index)
+{
+uint32_t bucket, slot;
+uint32_t path_bucket[LOOKUP_TABLE_MAX_KICKS];
+uint8_t path_slot[LOOKUP_TABLE_MAX_KICKS];
+int kicks;
+
+	bucket = *tag & mask;
+	if (place_in_bucket (&buckets[bucket], *tag, *index))
+		return 1;
+
+	bucket = alt_bucket (bucket, *tag, mask);
+	if (place_in_bucket (&buckets[bucket], *tag, *index))
+		return 1;
+
+	for (kicks = 0; kicks < LOOKUP_TABLE_MAX_KICKS; kicks++)
+	{
+		slot = (*kick_slot)++ % LOOKUP_TABLE_BUCKET_SLOTS;
+
+		path_bucket[kicks] = bucket;
+		path_slot[kicks] = (uint8_t) slot;
+		swap_slot (&buckets[bucket], slot, tag, index);
+
+		bucket = alt_bucket (bucket, *tag, mask);
+		if (place_in_bucket (&buckets[bucket], *tag, *index))
+			return 1;
+	}
+
+	/* Undo the kicks in reverse order, so that no pair is left without a slot */
+	while (kicks-- > 0)
+		swap_slot (&buckets[path_bucket[kicks]], path_slot[kicks], tag, index);
+
+	return 0;
+}
+
+
+/* Moves all the entries in a new bucket array, at least 'n_buckets' large; the (tag, index)
+   pair that could not be placed by the caller, if any, is added as well.
+   Keys with the same hash cannot be separated by a larger array, so the growth is limited;
+   on failure the table is left unchanged. */
+static int32_t resize (nvmLookupTable *table, uint32_t n_buckets, uint32_t tag, uint32_t index)
+{
+nvmLookupTableBucket *buckets;
+void *mem;
+uint32_t b, mask, t, e;
+int i, ok, resizes;
+
+	for (resizes = 0;; resizes++, n_buckets *= 2)
+	{
+		/* n_buckets becomes 0 when doubling 0x80000000 */
+		if (resizes == LOOKUP_TABLE_MAX_RESIZES || n_buckets == 0 || n_buckets > LOOKUP_TABLE_MAX_BUCKETS)
+			return nvmFAILURE;
+
+		buckets = alloc_buckets (n_buckets, &mem);
+		if (buckets == NULL)
+			return nvmFAILURE;
+		mask = n_buckets - 1;
+
+		ok = 1;
+		for (b = 0; ok && b <= table->bucket_mask; b++)
+		{
+			for (i = 0; ok && i < LOOKUP_TABLE_BUCKET_SLOTS; i++)
+			{
+				t = table->buckets[b].tag[i];
+				e = table->buckets[b].entry[i];
+				if (t != 0)
+					ok = place (buckets, mask, &table->kick_slot, &t, &e);
+			}
+		}
+		if (ok && tag != 0)
+			ok = place (buckets, mask, &table->kick_slot, &tag, &index);
+
+		if (ok)
+			break;
+
+		free (mem);
+	}
+
+	free (table->buckets_mem);
+	table->buckets = buckets;
+	table->buckets_mem = mem;
+	table->bucket_mask = mask;
+	return nvmSUCCESS;
+}
+
+
+nvmLookupTable *nvmLookupTableCreate (uint32_t key_size, uint32_t value_size, uint32_t initial_entries)
+{
+nvmLookupTable *table;
+uint64_t wanted;
+uint32_t n_buckets;
+
+	if (key_size == 0)
+		return NULL;
+
+	table = calloc (1, sizeof (nvmLookupTable));
+	if (table == NULL)
+		return NULL;
+
+	table->key_size = key_size;
+	table->value_size = value_size;
+	table->value_offset = (key_size + 3) & ~3;
+	table->entry_size = table->value_offset + value_size * sizeof (uint32_t);
+	table->free_list = LOOKUP_TABLE_NO_ENTRY;
+	table->seed = new_seed (table);
+
+	/* Buckets are sized so that 'initial_entries' do not exceed the maximum load */
+	wanted = ((uint64_t) initial_entries * 10) / (LOOKUP_TABLE_MAX_LOAD * LOOKUP_TABLE_BUCKET_SLOTS) + 1;
+	for (n_buckets = 1; n_buckets < wanted && n_buckets < LOOKUP_TABLE_MAX_BUCKETS; n_buckets *= 2)
+		;
+
+	table->buckets = alloc_buckets (n_buckets, &table->buckets_mem);
+	if (table->buckets == NULL)
+	{
+		free (table);
+		return NULL;
+	}
+	table->bucket_mask = n_buckets - 1;
+
+	/* Preallocate the arena for the expected number of entries */
+	while (table->n_chunks * (uint64_t) LOOKUP_TABLE_CHUNK_ENTRIES < initial_entries)
+	{
+		if (add_chunk (table) == nvmFAILURE)
+		{
+			nvmLookupTableDestroy (table);
+			return NULL;
+		}
+	}
+
+	return table;
+}
+
+
+void nvmLookupTableDestroy (nvmLookupTable *table)
+{
+uint32_t i;
+
+	if (table == NULL)
+		return;
+
+	for (i = 0; i < table->n_chunks; i++)
+		free (table->chunks[i]);
+	free (table->chunks);
+	free (table->buckets_mem);
+	free (table);
+}
+
+
+void nvmLookupTableClear (nvmLookupTable *table)
+{
+	memset (table->buckets, 0, (table->bucket_mask + 1) * sizeof (nvmLookupTableBucket));
+	table->n_entries = 0;
+	table->arena_used = 0;
+	table->free_list = LOOKUP_TABLE_NO_ENTRY;
+}
+
+
+uint32_t nvmLookupTableHash (nvmLookupTable *table, const uint8_t *key)
+{
+	return hsieh_hash (key, table->key_size, table->seed);
+}
+
+
+static uint8_t *lookup_in_bucket (nvmLookupTable *table, nvmLookupTableBucket *bucket, uint32_t tag, const uint8_t *key)
+{
+uint8_t *entry;
+int i;
+
+	for (i = 0; i < LOOKUP_TABLE_BUCKET_SLOTS; i++)
+	{
+		if (bucket->tag[i] == tag)
+		{
+			entry = entry_ptr (table, bucket->entry[i]);
+			if (memcmp (entry, key, table->key_size) == 0)
+				return entry;
+		}
+	}
+	return NULL;
+}
+
+
+static uint8_t *lookup_hashed (nvmLookupTable *table, uint32_t tag, const uint8_t *key)
+{
+uint32_t bucket, alt;
+uint8_t *entry;
+
+	bucket = tag & table->bucket_mask;
+	entry = lookup_in_bucket (table, &table->buckets[bucket], tag, key);
+	if (entry != NULL)
+		return entry;
+
+	alt = alt_bucket (bucket, tag, table->bucket_mask);
+	if (alt == bucket)
+		return NULL;
+	return lookup_in_bucket (table, &table->buckets[alt], tag, key);
+}
+
+
+uint8_t *nvmLookupTableLookup (nvmLookupTable *table, const uint8_t *key)
+{
+	return lookup_hashed (table, hsieh_hash (key, table->key_size, table->seed), key);
+}
+
+
+uint8_t *nvmLookupTableInsert (nvmLookupTable *table, const uint8_t *key, int *created)
+{
+uint32_t tag, index;
+uint8_t *entry;
+
+	tag = hsieh_hash (key, table->key_size, table->seed);
+	entry = lookup_hashed (table, tag, key);
+	if (created != NULL)
+		*created = (entry == NULL);
+	if (entry != NULL)
+		return entry;
+
+	/* Keep the load of the buckets low enough for the cuckoo insertion to succeed quickly */
+	if ((uint64_t) (table->n_entries + 1) * 10 > (uint64_t) (table->bucket_mask + 1) * LOOKUP_TABLE_BUCKET_SLOTS * LOOKUP_TABLE_MAX_LOAD)
+	{
+		if (resize (table, (table->bucket_mask + 1) * 2, 0, 0) == nvmFAILURE)
+			return NULL;
+	}
+
+	index = alloc_entry (table);
+	if (index == LOOKUP_TABLE_NO_ENTRY)
+		return NULL;
+
+	entry = entry_ptr (table, index);
+	memcpy (entry, key, table->key_size);
+	memset (entry + table->value_offset, 0, table->value_size * sizeof (uint32_t));
+
+	if (!place (table->buckets, table->bucket_mask, &table->kick_slot, &tag, &index))
+	{
+		if (resize (table, (table->bucket_mask + 1) * 2, tag, index) == nvmFAILURE)
+		{
+			/* Out of memory, or too many keys with the same hash: the new entry is not inserted */
+			free_entry (table, index);
+			return NULL;
+		}
+	}
+
+	table->n_entries++;
+	return entry;
+}
+
+
+int32_t nvmLookupTableDelete (nvmLookupTable *table, uint8_t *entry)
+{
+uint32_t tag, bucket;
+int i, j;
+
+	tag = hsieh_hash (entry, table->key_size, table->seed);
+	bucket = tag & table->bucket_mask;
+
+	for (j = 0; j < 2; j++)
+	{
+		for (i = 0; i < LOOKUP_TABLE_BUCKET_SLOTS; i++)
+		{
+			if (table->buckets[bucket].tag[i] == tag && entry_ptr (table, table->buckets[bucket].entry[i]) == entry)
+			{
+				free_entry (table, table->buckets[bucket].entry[i]);
+				table->buckets[bucket].tag[i] = 0;
+				table->n_entries--;
+				return nvmSUCCESS;
+			}
+		}
+		bucket = alt_bucket (bucket, tag, table->bucket_mask);
+	}
+
+	return nvmFAILURE;
+}
+
+
+uint32_t nvmLookupTableLookupBatch (nvmLookupTable *table, const uint8_t *keys, uint32_t n, uint8_t **results)
+{
+uint32_t tags[LOOKUP_TABLE_BATCH_SIZE];
+uint32_t i, j, count, found = 0;
+uint32_t bucket;
+
+	for (i = 0; i < n; i += count)
+	{
+		count = (n - i < LOOKUP_TABLE_BATCH_SIZE) ? n - i : LOOKUP_TABLE_BATCH_SIZE;
+
+		/* First pass: hash the keys and start loading their buckets */
+		for (j = 0; j < count; j++)
+		{
+			tags[j] = hsieh_hash (keys + (i + j) * table->key_size, table->key_size, table->seed);
+			bucket = tags[j] & table->bucket_mask;
+			LOOKUP_PREFETCH (&table->buckets[bucket]);
+			LOOKUP_PREFETCH (&table->buckets[alt_bucket (bucket, tags[j], table->bucket_mask)]);
+		}
+
+		/* Second pass: the buckets should be in cache by now */
+		for (j = 0; j < count; j++)
+		{
+			results[i + j] = lookup_hashed (table, tags[j], keys + (i + j) * table->key_size);
+			if (results[i + j] != NULL)
+				found++;
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file lookup_table.h
+ *	\brief This file contains the hash table engine shared by all the lookup coprocessors.
+ *
+ *	Tables use bucketized cuckoo hashing: each key can live in one of two buckets, and each
+ *	bucket keeps LOOKUP_TABLE_BUCKET_SLOTS (hash tag, entry index) pairs in a single cache line,
+ *	so that a lookup touches at most two cache lines before comparing the key.
+ *	Keys and values are kept in a separate entry arena that is allocated in chunks of
+ *	LOOKUP_TABLE_CHUNK_ENTRIES entries; entries never move, hence pointers to entries
+ *	remain valid until the entry is deleted, even when the bucket array is enlarged.
+ */
+
+#pragma once
+
+#include "nbnetvm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Number of slots of each bucket (8 tags plus 8 entry indexes fill a 64-byte cache line)
+#define LOOKUP_TABLE_BUCKET_SLOTS 8
+
+//! Number of entries allocated at once in the entry arena (must be a power of two)
+#define LOOKUP_TABLE_CHUNK_ENTRIES_SHIFT 12
+#define LOOKUP_TABLE_CHUNK_ENTRIES (1 << LOOKUP_TABLE_CHUNK_ENTRIES_SHIFT)
+
+//! Maximum number of entries displaced by an insertion before the bucket array is enlarged
+#define LOOKUP_TABLE_MAX_KICKS 128
+
+//! Maximum number of keys that are looked up at once by nvmLookupTableLookupBatch()
+#define LOOKUP_TABLE_BATCH_SIZE 16
+
+//! Index used to mark the end of the list of free entries
+#define LOOKUP_TABLE_NO_ENTRY 0xFFFFFFFF
+
+
+//! Bucket of the hash table; it is allocated aligned to a cache line.
+typedef struct _LookupTableBucket
+{
+	uint32_t tag[LOOKUP_TABLE_BUCKET_SLOTS];		//!< Hash of the key (0 if the slot is empty).
+	uint32_t entry[LOOKUP_TABLE_BUCKET_SLOTS];		//!< Index of the entry in the arena.
+} nvmLookupTableBucket;
+
+
+//! Hash table with fixed-size keys and values.
+typedef struct _LookupTable
+{
+	uint32_t key_size;					//!< Size of the key (in bytes).
+	uint32_t value_size;				//!< Size of the value (in 32-bit words).
+	uint32_t value_offset;				//!< Offset of the value within an entry (the key rounded to 4 bytes).
+	uint32_t entry_size;				//!< Size of an entry in the arena (in bytes).
+
+	nvmLookupTableBucket *buckets;		//!< Array of buckets (aligned to a cache line).
+	void *buckets_mem;					//!< Memory block that has been allocated for 'buckets'.
+	uint32_t bucket_mask;				//!< Number of buckets minus one (the number of buckets is a power of two).
+	uint32_t n_entries;					//!< Number of entries currently in the table.
+	uint32_t kick_slot;					//!< Slot that will be displaced by the next cuckoo kick.
+	uint32_t seed;						//!< Seed of the hash function (different for each table).
+
+	uint8_t **chunks;					//!< Chunks of the entry arena.
+	uint32_t n_chunks;					//!< Number of chunks that have been allocated.
+	uint32_t max_chunks;				//!< Size of the 'chunks' array.
+	uint32_t arena_used;				//!< Number of entries of the arena that have ever been used.
+	uint32_t free_list;					//!< First entry of the list of deleted entries (LOOKUP_TABLE_NO_ENTRY if empty).
+} nvmLookupTable;
+
+
+/*!
+	\brief Creates a new table.
+
+	\param key_size Size of the keys (in bytes).
+	\param value_size Size of the values (in 32-bit words).
+	\param initial_entries Number of entries for which the arena and the buckets are preallocated;
+	the table grows beyond this size when needed.
+
+	\return The new table, or NULL if there was not enough memory.
+*/
+nvmLookupTable *nvmLookupTableCreate(uint32_t key_size, uint32_t value_size, uint32_t initial_entries);
+
+//! Releases a table and all its entries.
+void nvmLookupTableDestroy(nvmLookupTable *table);
+
+//! Removes all the entries of a table; the memory is kept for reuse.
+void nvmLookupTableClear(nvmLookupTable *table);
+
+//! Returns the hash of a key; keys are hashed on their whole 'key_size' bytes.
+uint32_t nvmLookupTableHash(nvmLookupTable *table, const uint8_t *key);
+
+/*!
+	\brief Looks for the entry associated to a key.
+
+	\return A pointer to the entry (see nvmLookupTableValue()), or NULL if the key is not in the table.
+*/
+uint8_t *nvmLookupTableLookup(nvmLookupTable *table, const uint8_t *key);
+
+/*!
+	\brief Looks for the entry associated to a key, and creates it if it does not exist.
+
+	The value of new entries is set to zero.
+
+	\param created If not NULL, it is set to 1 if the entry has been created, 0 if it already existed.
+
+	\return A pointer to the entry, or NULL if there was not enough memory or the key cannot be
+	placed (too many keys with the same hash); in this case the table is left unchanged.
+*/
+uint8_t *nvmLookupTableInsert(nvmLookupTable *table, const uint8_t *key, int *created);
+
+/*!
+	\brief Removes an entry, previously returned by the lookup or insert functions, from a table.
+
+	\return nvmSUCCESS if the entry has been removed, nvmFAILURE if it was not in the table.
+*/
+int32_t nvmLookupTableDelete(nvmLookupTable *table, uint8_t *entry);
+
+/*!
+	\brief Looks for several keys at once.
+
+	Hashes are computed first, and the buckets of all the keys are prefetched before being
+	examined, so that the cache misses of the different keys overlap.
+
+	\param keys Array of 'n' keys, each one 'key_size' bytes long.
+	\param n Number of keys.
+	\param results Array of 'n' pointers that are filled with the matching entries (NULL if the key is not found).
+
+	\return The number of keys that have been found.
+*/
+uint32_t nvmLookupTableLookupBatch(nvmLookupTable *table, const uint8_t *keys, uint32_t n, uint8_t **results);
+
+//! Returns the value of an entry, i.e. an array of 'value_size' words.
+#define nvmLookupTableValue(table, entry) ((uint32_t *) ((entry) + (table)->value_offset))
+
+
+#ifdef __cplusplus
+}
+#endif
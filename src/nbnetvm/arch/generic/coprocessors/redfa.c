@@ -0,0 +1,1040 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file redfa.c
+ *	\brief This file contains a lazy DFA that scans a buffer once for a whole set of regular expressions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "redfa.h"
+
+
+/* Kinds of NFA nodes */
+enum {
+	REDFA_NODE_CHAR,			/* Consumes a byte of the class 'cls' */
+	REDFA_NODE_SPLIT,			/* Goes on with both 'out' and 'out1' */
+	REDFA_NODE_ASSERT,			/* Goes on with 'out' if 'assertion' holds at the current position */
+	REDFA_NODE_MATCH			/* Pattern 'out1' matches */
+};
+
+/* Conditions checked by the assertion nodes */
+enum {
+	REDFA_ASSERT_BOL_TEXT,		/* \A, or '^' without the 'm' flag */
+	REDFA_ASSERT_BOL_LINE,		/* '^' with the 'm' flag */
+	REDFA_ASSERT_EOL_TEXT,		/* \z, or '$' with the 'E' flag */
+	REDFA_ASSERT_EOL_TEXT_NL,	/* \Z, or '$' without flags: end of the buffer, or before a newline that ends it */
+	REDFA_ASSERT_EOL_LINE		/* '$' with the 'm' flag */
+};
+
+/* Context of a DFA state, needed by the assertions at the beginning of a line */
+#define REDFA_FLAG_START 1			/* No byte has been consumed yet */
+#define REDFA_FLAG_AFTER_NL 2		/* The last byte was a newline */
+
+#define REDFA_HASH_SIZE (2 * REDFA_MAX_STATES)
+#define REDFA_MAX_NESTING 64
+#define REDFA_MAX_REPEAT 1000
+
+
+#define CLASS_SET(cls, c) ((cls)[(c) >> 5] |= (1U << ((c) & 31)))
+#define CLASS_TEST(cls, c) (((cls)[(c) >> 5] >> ((c) & 31)) & 1)
+
+
+/* Abstract syntax tree of a pattern, built by the parser and then translated into NFA nodes */
+enum {
+	AST_EMPTY,
+	AST_CHAR,
+	AST_ASSERT,
+	AST_CAT,
+	AST_ALT,
+	AST_REPEAT					/* 'left' repeated from 'min' to 'max' times ('max' < 0 means no limit) */
+};
+
+typedef struct {
+	uint8_t op;
+	uint8_t assertion;
+	int left, right;
+	int min, max;
+	uint32_t cls[8];
+} redfa_ast;
+
+typedef struct {
+	const unsigned char *p, *end;
+	int caseless, dotall, multiline, dollar_endonly;
+	int depth;
+	redfa_ast *ast;
+	int ast_no, ast_max;
+} redfa_parser;
+
+
+static int new_ast (redfa_parser *ps, uint8_t op)
+{
+redfa_ast *tmp;
+
+	if (ps->ast_no == ps->ast_max)
+	{
+		ps->ast_max = ps->ast_max ? 2 * ps->ast_max : 64;
+		tmp = (redfa_ast *) realloc (ps->ast, ps->ast_max * sizeof (redfa_ast));
+		if (tmp == NULL)
+			return -1;
+		ps->ast = tmp;
+	}
+	memset (&ps->ast[ps->ast_no], 0, sizeof (redfa_ast));
+	ps->ast[ps->ast_no].op = op;
+	return ps->ast_no++;
+}
+
+
+static void class_fold (uint32_t *cls)
+{
+int c;
+
+	for (c = 'a'; c <= 'z'; c++)
+	{
+		if (CLASS_TEST (cls, c) || CLASS_TEST (cls, c - 'a' + 'A'))
+		{
+			CLASS_SET (cls, c);
+			CLASS_SET (cls, c - 'a' + 'A');
+		}
+	}
+}
+
+
+static void class_complement (uint32_t *cls)
+{
+int i;
+
+	for (i = 0; i < 8; i++)
+		cls[i] = ~cls[i];
+}
+
+
+static void class_range (uint32_t *cls, int lo, int hi)
+{
+	for (; lo <= hi; lo++)
+		CLASS_SET (cls, lo);
+}
+
+
+static int hex_value (unsigned char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+
+/* Kinds of escape sequences */
+enum {
+	ESC_UNSUPPORTED = -1,
+	ESC_CHAR,
+	ESC_SET,
+	ESC_ASSERT
+};
+
+/* Parses the escape sequence following a backslash; a single byte is returned in 'ch', a set of
+   bytes is added to 'cls' and an assertion is returned in 'assertion'. */
+static int parse_escape (redfa_parser *ps, uint32_t *cls, int *ch, int *assertion)
+{
+unsigned char c;
+int i, d;
+
+	if (ps->p >= ps->end)
+		return ESC_UNSUPPORTED;
+	c = *ps->p++;
+
+	switch (c)
+	{
+		case 'd':
+		case 'D':
+		{
+			uint32_t set[8] = {0};
+
+			class_range (set, '0', '9');
+			if (c == 'D')
+				class_complement (set);
+			for (i = 0; i < 8; i++)
+				cls[i] |= set[i];
+			return ESC_SET;
+		}
+		case 'w':
+		case 'W':
+		{
+			uint32_t set[8] = {0};
+
+			class_range (set, '0', '9');
+			class_range (set, 'a', 'z');
+			class_range (set, 'A', 'Z');
+			CLASS_SET (set, '_');
+			if (c == 'W')
+				class_complement (set);
+			for (i = 0; i < 8; i++)
+				cls[i] |= set[i];
+			return ESC_SET;
+		}
+		case 's':
+		case 'S':
+		{
+			uint32_t set[8] = {0};
+
+			/* Depending on the version of pcre, VT may or may not be a space: it is accepted by both
+			   \s and \S, so that no match is ever missed */
+			CLASS_SET (set, ' ');
+			class_range (set, '\t', '\r');
+			if (c == 'S')
+			{
+				class_complement (set);
+				CLASS_SET (set, '\v');
+			}
+			for (i = 0; i < 8; i++)
+				cls[i] |= set[i];
+			return ESC_SET;
+		}
+		case 'n': *ch = '\n'; return ESC_CHAR;
+		case 'r': *ch = '\r'; return ESC_CHAR;
+		case 't': *ch = '\t'; return ESC_CHAR;
+		case 'f': *ch = '\f'; return ESC_CHAR;
+		case 'e': *ch = 0x1B; return ESC_CHAR;
+		case 'a': *ch = 0x07; return ESC_CHAR;
+		case 'x':
+			if (ps->p < ps->end && *ps->p == '{')
+				return ESC_UNSUPPORTED;
+			*ch = 0;
+			for (i = 0; i < 2 && ps->p < ps->end && (d = hex_value (*ps->p)) >= 0; i++, ps->p++)
+				*ch = *ch * 16 + d;
+			return ESC_CHAR;
+		case 'A': *assertion = REDFA_ASSERT_BOL_TEXT; return ESC_ASSERT;
+		case 'z': *assertion = REDFA_ASSERT_EOL_TEXT; return ESC_ASSERT;
+		case 'Z': *assertion = REDFA_ASSERT_EOL_TEXT_NL; return ESC_ASSERT;
+		default:
+			/* Any other letter or digit has a special meaning (backreferences, word boundaries, ...) */
+			if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+				return ESC_UNSUPPORTED;
+			*ch = c;
+			return ESC_CHAR;
+	}
+}
+
+
+/* Parses a counted repetition starting at 'q' (which points to a '{'); returns 1 if it is a valid
+   quantifier, 0 if the brace is a literal, -1 if the quantifier is not supported. */
+static int parse_braces (redfa_parser *ps, const unsigned char *q, int *min, int *max, const unsigned char **next)
+{
+const unsigned char *start;
+
+	q++;
+	start = q;
+	*min = 0;
+	while (q < ps->end && *q >= '0' && *q <= '9')
+	{
+		if (*min <= REDFA_MAX_REPEAT)
+			*min = *min * 10 + (*q - '0');
+		q++;
+	}
+	if (q == start)
+		return 0;
+	*max = *min;
+	if (q < ps->end && *q == ',')
+	{
+		q++;
+		*max = -1;
+		if (q < ps->end && *q >= '0' && *q <= '9')
+		{
+			*max = 0;
+			while (q < ps->end && *q >= '0' && *q <= '9')
+			{
+				if (*max <= REDFA_MAX_REPEAT)
+					*max = *max * 10 + (*q - '0');
+				q++;
+			}
+		}
+	}
+	if (q >= ps->end || *q != '}')
+		return 0;
+	*next = q + 1;
+
+	if (*min > REDFA_MAX_REPEAT || *max > REDFA_MAX_REPEAT || (*max >= 0 && *max < *min))
+		return -1;
+	return 1;
+}
+
+
+static int parse_class (redfa_parser *ps, int a)
+{
+uint32_t *cls;
+int negate = 0, first = 1, lo, hi, kind, assertion;
+
+	if (ps->p < ps->end && *ps->p == '^')
+	{
+		negate = 1;
+		ps->p++;
+	}
+
+	while (1)
+	{
+		uint32_t set[8] = {0};
+
+		if (ps->p >= ps->end)
+			return -1;
+		if (*ps->p == ']' && !first)
+		{
+			ps->p++;
+			break;
+		}
+		first = 0;
+		/* POSIX classes and collating elements */
+		if (*ps->p == '[' && ps->p + 1 < ps->end && (ps->p[1] == ':' || ps->p[1] == '.' || ps->p[1] == '='))
+			return -1;
+
+		kind = ESC_CHAR;
+		if (*ps->p == '\\')
+		{
+			ps->p++;
+			if (ps->p < ps->end && *ps->p == 'b')
+			{
+				lo = '\b';
+				ps->p++;
+			}
+			else
+				kind = parse_escape (ps, set, &lo, &assertion);
+		}
+		else
+			lo = *ps->p++;
+
+		if (kind == ESC_UNSUPPORTED || kind == ESC_ASSERT)
+			return -1;
+
+		cls = ps->ast[a].cls;
+		if (kind == ESC_SET)
+		{
+			for (hi = 0; hi < 8; hi++)
+				cls[hi] |= set[hi];
+			continue;
+		}
+
+		if (ps->p + 1 < ps->end && *ps->p == '-' && ps->p[1] != ']')
+		{
+			ps->p++;
+			kind = ESC_CHAR;
+			if (*ps->p == '\\')
+			{
+				ps->p++;
+				if (ps->p < ps->end && *ps->p == 'b')
+				{
+					hi = '\b';
+					ps->p++;
+				}
+				else
+					kind = parse_escape (ps, set, &hi, &assertion);
+			}
+			else
+				hi = *ps->p++;
+
+			if (kind == ESC_UNSUPPORTED || kind == ESC_ASSERT)
+				return -1;
+			if (kind == ESC_SET)
+			{
+				/* Something like [a-\d]: the dash is a literal */
+				CLASS_SET (cls, lo);
+				CLASS_SET (cls, '-');
+				for (hi = 0; hi < 8; hi++)
+					cls[hi] |= set[hi];
+				continue;
+			}
+			if (hi < lo)
+				return -1;
+			class_range (cls, lo, hi);
+		}
+		else
+			CLASS_SET (cls, lo);
+	}
+
+	/* Case folding applies to the listed bytes, before the class is negated */
+	if (ps->caseless)
+		class_fold (ps->ast[a].cls);
+	if (negate)
+		class_complement (ps->ast[a].cls);
+	return a;
+}
+
+
+static int parse_alt (redfa_parser *ps);
+
+
+static int parse_atom (redfa_parser *ps)
+{
+unsigned char c;
+int a, min, max, ch, assertion, kind;
+const unsigned char *next;
+
+	c = *ps->p++;
+	switch (c)
+	{
+		case '(':
+			if (ps->depth >= REDFA_MAX_NESTING)
+				return -1;
+			/* Non-capturing groups only; inline options, lookaround, atomic groups, etc. are left to pcre */
+			if (ps->p < ps->end && *ps->p == '?')
+			{
+				if (ps->p + 1 < ps->end && ps->p[1] == ':')
+					ps->p += 2;
+				else
+					return -1;
+			}
+			ps->depth++;
+			a = parse_alt (ps);
+			ps->depth--;
+			if (a < 0 || ps->p >= ps->end || *ps->p != ')')
+				return -1;
+			ps->p++;
+			return a;
+
+		case '*':
+		case '+':
+		case '?':
+			/* Nothing to repeat */
+			return -1;
+
+		case '[':
+			if ((a = new_ast (ps, AST_CHAR)) < 0)
+				return -1;
+			return parse_class (ps, a);
+
+		case '.':
+			if ((a = new_ast (ps, AST_CHAR)) < 0)
+				return -1;
+			class_range (ps->ast[a].cls, 0, 255);
+			if (!ps->dotall)
+				ps->ast[a].cls['\n' >> 5] &= ~(1U << ('\n' & 31));
+			return a;
+
+		case '^':
+		case '$':
+			if ((a = new_ast (ps, AST_ASSERT)) < 0)
+				return -1;
+			if (c == '^')
+				ps->ast[a].assertion = ps->multiline ? REDFA_ASSERT_BOL_LINE : REDFA_ASSERT_BOL_TEXT;
+			else if (ps->multiline)
+				ps->ast[a].assertion = REDFA_ASSERT_EOL_LINE;
+			else
+				ps->ast[a].assertion = ps->dollar_endonly ? REDFA_ASSERT_EOL_TEXT : REDFA_ASSERT_EOL_TEXT_NL;
+			return a;
+
+		case '\\':
+			if ((a = new_ast (ps, AST_CHAR)) < 0)
+				return -1;
+			kind = parse_escape (ps, ps->ast[a].cls, &ch, &assertion);
+			if (kind == ESC_UNSUPPORTED)
+				return -1;
+			if (kind == ESC_ASSERT)
+			{
+				ps->ast[a].op = AST_ASSERT;
+				ps->ast[a].assertion = assertion;
+				return a;
+			}
+			if (kind == ESC_CHAR)
+				CLASS_SET (ps->ast[a].cls, ch);
+			if (ps->caseless)
+				class_fold (ps->ast[a].cls);
+			return a;
+
+		case '{':
+			/* A brace is a literal, unless it starts a quantifier (which would have nothing to repeat) */
+			if (parse_braces (ps, ps->p - 1, &min, &max, &next) != 0)
+				return -1;
+			/* Fall through */
+		default:
+			if ((a = new_ast (ps, AST_CHAR)) < 0)
+				return -1;
+			CLASS_SET (ps->ast[a].cls, c);
+			if (ps->caseless)
+				class_fold (ps->ast[a].cls);
+			return a;
+	}
+}
+
+
+static int parse_repeat (redfa_parser *ps)
+{
+int a, r, min, max, res;
+const unsigned char *next;
+
+	if ((a = parse_atom (ps)) < 0)
+		return -1;
+
+	while (ps->p < ps->end)
+	{
+		switch (*ps->p)
+		{
+			case '*': min = 0; max = -1; next = ps->p + 1; break;
+			case '+': min = 1; max = -1; next = ps->p + 1; break;
+			case '?': min = 0; max = 1; next = ps->p + 1; break;
+			case '{':
+				res = parse_braces (ps, ps->p, &min, &max, &next);
+				if (res < 0)
+					return -1;
+				if (res == 0)
+					return a;
+				break;
+			default:
+				return a;
+		}
+
+		if (ps->ast[a].op == AST_ASSERT)
+			return -1;
+		ps->p = next;
+
+		/* Lazy quantifiers match the same set of strings; possessive ones do not */
+		if (ps->p < ps->end && *ps->p == '+')
+			return -1;
+		if (ps->p < ps->end && *ps->p == '?')
+			ps->p++;
+
+		if ((r = new_ast (ps, AST_REPEAT)) < 0)
+			return -1;
+		ps->ast[r].left = a;
+		ps->ast[r].min = min;
+		ps->ast[r].max = max;
+		a = r;
+	}
+
+	return a;
+}
+
+
+static int parse_concat (redfa_parser *ps)
+{
+int res, a, c;
+
+	if ((res = new_ast (ps, AST_EMPTY)) < 0)
+		return -1;
+
+	while (ps->p < ps->end && *ps->p != '|' && *ps->p != ')')
+	{
+		if ((a = parse_repeat (ps)) < 0)
+			return -1;
+		if ((c = new_ast (ps, AST_CAT)) < 0)
+			return -1;
+		ps->ast[c].left = res;
+		ps->ast[c].right = a;
+		res = c;
+	}
+
+	return res;
+}
+
+
+static int parse_alt (redfa_parser *ps)
+{
+int left, right, a;
+
+	if ((left = parse_concat (ps)) < 0)
+		return -1;
+
+	while (ps->p < ps->end && *ps->p == '|')
+	{
+		ps->p++;
+		if ((right = parse_concat (ps)) < 0)
+			return -1;
+		if ((a = new_ast (ps, AST_ALT)) < 0)
+			return -1;
+		ps->ast[a].left = left;
+		ps->ast[a].right = right;
+		left = a;
+	}
+
+	return left;
+}
+
+
+static int64_t new_node (REDFA_STRUCT *dfa, uint8_t type, uint32_t out)
+{
+REDFA_NODE *tmp;
+
+	if (dfa->nodes_no == REDFA_MAX_NODES)
+		return -1;
+	if (dfa->nodes_no == dfa->nodes_max)
+	{
+		dfa->nodes_max = dfa->nodes_max ? 2 * dfa->nodes_max : 256;
+		tmp = (REDFA_NODE *) realloc (dfa->nodes, dfa->nodes_max * sizeof (REDFA_NODE));
+		if (tmp == NULL)
+			return -1;
+		dfa->nodes = tmp;
+	}
+	memset (&dfa->nodes[dfa->nodes_no], 0, sizeof (REDFA_NODE));
+	dfa->nodes[dfa->nodes_no].type = type;
+	dfa->nodes[dfa->nodes_no].out = out;
+	return dfa->nodes_no++;
+}
+
+
+static int64_t new_class (REDFA_STRUCT *dfa, uint32_t *cls)
+{
+uint32_t (*tmp)[8];
+
+	if (dfa->classes_no == dfa->classes_max)
+	{
+		dfa->classes_max = dfa->classes_max ? 2 * dfa->classes_max : 64;
+		tmp = (uint32_t (*)[8]) realloc (dfa->classes, dfa->classes_max * sizeof (*tmp));
+		if (tmp == NULL)
+			return -1;
+		dfa->classes = tmp;
+	}
+	memcpy (dfa->classes[dfa->classes_no], cls, sizeof (dfa->classes[0]));
+	return dfa->classes_no++;
+}
+
+
+/* Translates the subtree 'a' into NFA nodes that go on with node 'next'; returns the first of them,
+   or -1 if the NFA is too big. Nodes are created backwards, so that every node knows its successor. */
+static int64_t compile (REDFA_STRUCT *dfa, redfa_ast *ast, int a, uint32_t next)
+{
+int64_t n, l, r, body, cls;
+int k;
+
+	switch (ast[a].op)
+	{
+		case AST_EMPTY:
+			return next;
+
+		case AST_CHAR:
+			if ((cls = new_class (dfa, ast[a].cls)) < 0 || (n = new_node (dfa, REDFA_NODE_CHAR, next)) < 0)
+				return -1;
+			dfa->nodes[n].cls = (uint32_t) cls;
+			return n;
+
+		case AST_ASSERT:
+			if ((n = new_node (dfa, REDFA_NODE_ASSERT, next)) < 0)
+				return -1;
+			dfa->nodes[n].assertion = ast[a].assertion;
+			return n;
+
+		case AST_CAT:
+			if ((r = compile (dfa, ast, ast[a].right, next)) < 0)
+				return -1;
+			return compile (dfa, ast, ast[a].left, (uint32_t) r);
+
+		case AST_ALT:
+			if ((l = compile (dfa, ast, ast[a].left, next)) < 0 || (r = compile (dfa, ast, ast[a].right, next)) < 0)
+				return -1;
+			if ((n = new_node (dfa, REDFA_NODE_SPLIT, (uint32_t) l)) < 0)
+				return -1;
+			dfa->nodes[n].out1 = (uint32_t) r;
+			return n;
+
+		case AST_REPEAT:
+			n = next;
+			if (ast[a].max < 0)
+			{
+				/* Loop: the split node either enters the body (which comes back to it) or leaves */
+				if ((n = new_node (dfa, REDFA_NODE_SPLIT, 0)) < 0)
+					return -1;
+				dfa->nodes[n].out1 = next;
+				if ((body = compile (dfa, ast, ast[a].left, (uint32_t) n)) < 0)
+					return -1;
+				dfa->nodes[n].out = (uint32_t) body;
+			}
+			else
+			{
+				/* Optional copies, each one nested into the previous one */
+				for (k = ast[a].min; k < ast[a].max; k++)
+				{
+					if ((body = compile (dfa, ast, ast[a].left, (uint32_t) n)) < 0)
+						return -1;
+					if ((n = new_node (dfa, REDFA_NODE_SPLIT, (uint32_t) body)) < 0)
+						return -1;
+					dfa->nodes[n].out1 = next;
+				}
+			}
+			/* Mandatory copies */
+			for (k = 0; k < ast[a].min; k++)
+			{
+				if ((n = compile (dfa, ast, ast[a].left, (uint32_t) n)) < 0)
+					return -1;
+			}
+			return n;
+	}
+
+	return -1;
+}
+
+
+static void redfa_flush (REDFA_STRUCT *dfa)
+{
+int32_t i;
+
+	for (i = 0; i < dfa->states_no; i++)
+		free (dfa->states[i]);
+	dfa->states_no = 0;
+	dfa->start = NULL;
+	if (dfa->hash != NULL)
+		memset (dfa->hash, 0xFF, REDFA_HASH_SIZE * sizeof (int32_t));
+}
+
+
+REDFA_STRUCT *redfaNew(void)
+{
+REDFA_STRUCT *dfa;
+
+	dfa = (REDFA_STRUCT *) calloc (1, sizeof (REDFA_STRUCT));
+	if (dfa == NULL)
+		return NULL;
+
+	dfa->states = (REDFA_STATE **) malloc (REDFA_MAX_STATES * sizeof (REDFA_STATE *));
+	dfa->hash = (int32_t *) malloc (REDFA_HASH_SIZE * sizeof (int32_t));
+	if (dfa->states == NULL || dfa->hash == NULL)
+	{
+		redfaFree (dfa);
+		return NULL;
+	}
+	redfa_flush (dfa);
+
+	return dfa;
+}
+
+
+int redfaAddPattern(REDFA_STRUCT *dfa, const char *pattern, int n, const char *flags, uint32_t id)
+{
+redfa_parser ps;
+uint32_t saved_nodes, saved_classes, *tmp;
+int64_t match, start = -1;
+int root, anchored = 0;
+
+	if (n > REDFA_MAX_PATTERN_LEN)
+		return -1;
+
+	memset (&ps, 0, sizeof (ps));
+	for (; *flags; flags++)
+	{
+		switch (*flags)
+		{
+			case 'i': ps.caseless = 1; break;
+			case 's': ps.dotall = 1; break;
+			case 'm': ps.multiline = 1; break;
+			case 'E': ps.dollar_endonly = 1; break;
+			case 'A': anchored = 1; break;
+			case 'x': return -1;
+			/* 'G' (ungreedy) does not change whether a pattern matches; the others are ignored by pcre too */
+			default: break;
+		}
+	}
+
+	ps.p = (const unsigned char *) pattern;
+	ps.end = ps.p + n;
+	root = parse_alt (&ps);
+	if (root < 0 || ps.p != ps.end)
+	{
+		free (ps.ast);
+		return -1;
+	}
+
+	saved_nodes = dfa->nodes_no;
+	saved_classes = dfa->classes_no;
+	if ((match = new_node (dfa, REDFA_NODE_MATCH, 0)) >= 0)
+	{
+		dfa->nodes[match].out1 = id;
+		start = compile (dfa, ps.ast, root, (uint32_t) match);
+		if (start >= 0 && anchored && (start = new_node (dfa, REDFA_NODE_ASSERT, (uint32_t) start)) >= 0)
+			dfa->nodes[start].assertion = REDFA_ASSERT_BOL_TEXT;
+	}
+	free (ps.ast);
+
+	if (start >= 0 && dfa->roots_no == dfa->roots_max)
+	{
+		dfa->roots_max = dfa->roots_max ? 2 * dfa->roots_max : 16;
+		tmp = (uint32_t *) realloc (dfa->roots, dfa->roots_max * sizeof (uint32_t));
+		if (tmp == NULL)
+			start = -1;
+		else
+			dfa->roots = tmp;
+	}
+	if (start < 0)
+	{
+		dfa->nodes_no = saved_nodes;
+		dfa->classes_no = saved_classes;
+		return -1;
+	}
+
+	dfa->roots[dfa->roots_no++] = (uint32_t) start;
+	if (id + 1 > dfa->max_id)
+		dfa->max_id = id + 1;
+
+	/* The states that have been built so far do not know about the new pattern */
+	redfa_flush (dfa);
+	return 0;
+}
+
+
+static int redfa_assert (uint8_t assertion, uint32_t flags, uint32_t sym)
+{
+	switch (assertion)
+	{
+		case REDFA_ASSERT_BOL_TEXT:
+			return (flags & REDFA_FLAG_START) != 0;
+		case REDFA_ASSERT_BOL_LINE:
+			return (flags & (REDFA_FLAG_START | REDFA_FLAG_AFTER_NL)) != 0;
+		case REDFA_ASSERT_EOL_TEXT:
+			return sym == REDFA_SYM_END;
+		case REDFA_ASSERT_EOL_TEXT_NL:
+			return sym == REDFA_SYM_END || sym == REDFA_SYM_LASTNL;
+		case REDFA_ASSERT_EOL_LINE:
+			return sym == REDFA_SYM_END || sym == REDFA_SYM_LASTNL || sym == '\n';
+	}
+	return 0;
+}
+
+
+static int compare_uint32 (const void *a, const void *b)
+{
+uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+
+static uint32_t redfa_hash (const uint32_t *nodes, int nodes_no, const uint32_t *matches, int matches_no, uint32_t flags)
+{
+uint32_t h = 2166136261U ^ flags;
+int i;
+
+	for (i = 0; i < nodes_no; i++)
+		h = (h ^ nodes[i]) * 16777619U;
+	h = (h ^ 0xFFFFFFFF) * 16777619U;
+	for (i = 0; i < matches_no; i++)
+		h = (h ^ matches[i]) * 16777619U;
+	return h ^ (h >> 15);
+}
+
+
+/* Returns the index of the state with the given content, adding it to the cache if needed;
+   'flushed' is set if the cache had to be flushed in order to make room for it. */
+static REDFA_STATE *redfa_intern (REDFA_STRUCT *dfa, const uint32_t *nodes, int nodes_no, const uint32_t *matches, int matches_no,
+							uint32_t flags, int *flushed)
+{
+REDFA_STATE *st;
+uint32_t h, i;
+
+	h = redfa_hash (nodes, nodes_no, matches, matches_no, flags);
+	for (i = h & (REDFA_HASH_SIZE - 1); dfa->hash[i] >= 0; i = (i + 1) & (REDFA_HASH_SIZE - 1))
+	{
+		st = dfa->states[dfa->hash[i]];
+		if (st->hash == h && st->flags == flags && st->nodes_no == nodes_no && st->matches_no == matches_no &&
+			(nodes_no == 0 || memcmp (st->nodes, nodes, nodes_no * sizeof (uint32_t)) == 0) &&
+			(matches_no == 0 || memcmp (st->matches, matches, matches_no * sizeof (uint32_t)) == 0))
+			return st;
+	}
+
+	if (dfa->states_no == REDFA_MAX_STATES)
+	{
+		redfa_flush (dfa);
+		dfa->flushes++;
+		*flushed = 1;
+		i = h & (REDFA_HASH_SIZE - 1);
+	}
+
+	st = (REDFA_STATE *) malloc (sizeof (REDFA_STATE) + (nodes_no + matches_no) * sizeof (uint32_t));
+	if (st == NULL)
+		return NULL;
+	memset (st->next, 0, sizeof (st->next));
+	st->nodes = (uint32_t *) (st + 1);
+	st->nodes_no = nodes_no;
+	st->matches = st->nodes + nodes_no;
+	st->matches_no = matches_no;
+	if (nodes_no > 0)
+		memcpy (st->nodes, nodes, nodes_no * sizeof (uint32_t));
+	if (matches_no > 0)
+		memcpy (st->matches, matches, matches_no * sizeof (uint32_t));
+	st->flags = flags;
+	st->hash = h;
+
+	dfa->states[dfa->states_no] = st;
+	dfa->hash[i] = dfa->states_no++;
+	return st;
+}
+
+
+/* Allocates the scratch space used to build the states, once the size of the NFA is known */
+static int redfa_scratch (REDFA_STRUCT *dfa)
+{
+	free (dfa->stack);
+	free (dfa->dense);
+	free (dfa->sparse);
+	free (dfa->kernel);
+	free (dfa->ksparse);
+	free (dfa->matches);
+	dfa->stack = (uint32_t *) malloc (dfa->nodes_max * sizeof (uint32_t));
+	dfa->dense = (uint32_t *) malloc (dfa->nodes_max * sizeof (uint32_t));
+	dfa->sparse = (uint32_t *) calloc (dfa->nodes_max, sizeof (uint32_t));
+	dfa->kernel = (uint32_t *) malloc (dfa->nodes_max * sizeof (uint32_t));
+	dfa->ksparse = (uint32_t *) calloc (dfa->nodes_max, sizeof (uint32_t));
+	dfa->matches = (uint32_t *) malloc (dfa->nodes_max * sizeof (uint32_t));
+	dfa->scratch_size = dfa->nodes_max;
+
+	if (dfa->stack == NULL || dfa->dense == NULL || dfa->sparse == NULL || dfa->kernel == NULL ||
+		dfa->ksparse == NULL || dfa->matches == NULL)
+	{
+		dfa->scratch_size = 0;
+		return -1;
+	}
+	return 0;
+}
+
+
+#define IN_SET(sparse, dense, dense_no, n) ((sparse)[n] < (dense_no) && (dense)[(sparse)[n]] == (n))
+
+#define PUSH(n)																\
+	do {																	\
+		uint32_t _n = (n);													\
+		if (!IN_SET (dfa->sparse, dfa->dense, dense_no, _n))				\
+		{																	\
+			dfa->sparse[_n] = dense_no;										\
+			dfa->dense[dense_no++] = _n;									\
+			dfa->stack[top++] = _n;											\
+		}																	\
+	} while (0)
+
+
+/* Builds the state that follows state 's' on symbol 'sym' */
+static REDFA_STATE *redfa_build (REDFA_STRUCT *dfa, REDFA_STATE *src, uint32_t sym)
+{
+REDFA_STATE *next;
+REDFA_NODE *node;
+uint32_t dense_no = 0, kernel_no = 0, top = 0, matches_no = 0, i, j, n, flags;
+int flushed = 0;
+
+	if (dfa->scratch_size < dfa->nodes_no && redfa_scratch (dfa) < 0)
+		return NULL;
+
+	/* Epsilon closure of the state, in the context given by the state and by the next symbol */
+	for (i = 0; i < dfa->roots_no; i++)
+		PUSH (dfa->roots[i]);
+	for (i = 0; i < (uint32_t) src->nodes_no; i++)
+		PUSH (src->nodes[i]);
+
+	while (top > 0)
+	{
+		node = &dfa->nodes[dfa->stack[--top]];
+		switch (node->type)
+		{
+			case REDFA_NODE_SPLIT:
+				PUSH (node->out);
+				PUSH (node->out1);
+				break;
+			case REDFA_NODE_ASSERT:
+				if (redfa_assert (node->assertion, src->flags, sym))
+					PUSH (node->out);
+				break;
+			case REDFA_NODE_MATCH:
+				dfa->matches[matches_no++] = node->out1;
+				break;
+		}
+	}
+
+	/* Nodes reached by consuming the symbol */
+	if (sym != REDFA_SYM_END)
+	{
+		n = (sym == REDFA_SYM_LASTNL) ? '\n' : sym;
+		for (i = 0; i < dense_no; i++)
+		{
+			node = &dfa->nodes[dfa->dense[i]];
+			if (node->type == REDFA_NODE_CHAR && CLASS_TEST (dfa->classes[node->cls], n) &&
+				!IN_SET (dfa->ksparse, dfa->kernel, kernel_no, node->out))
+			{
+				dfa->ksparse[node->out] = kernel_no;
+				dfa->kernel[kernel_no++] = node->out;
+			}
+		}
+	}
+
+	qsort (dfa->kernel, kernel_no, sizeof (uint32_t), compare_uint32);
+	if (matches_no > 1)
+	{
+		qsort (dfa->matches, matches_no, sizeof (uint32_t), compare_uint32);
+		for (i = 1, j = 1; i < matches_no; i++)
+		{
+			if (dfa->matches[i] != dfa->matches[j - 1])
+				dfa->matches[j++] = dfa->matches[i];
+		}
+		matches_no = j;
+	}
+
+	flags = (sym == '\n' || sym == REDFA_SYM_LASTNL) ? REDFA_FLAG_AFTER_NL : 0;
+	next = redfa_intern (dfa, dfa->kernel, kernel_no, dfa->matches, matches_no, flags, &flushed);
+
+	/* If the cache has been flushed, the source state does not exist anymore */
+	if (next != NULL && !flushed)
+		src->next[sym] = next;
+	return next;
+}
+
+
+/* Follows the transition on 'sym', building the next state if needed */
+#define STEP(sym)															\
+	do {																	\
+		REDFA_STATE *_next = st->next[sym];									\
+		if (_next == NULL && (_next = redfa_build (dfa, st, (sym))) == NULL)	\
+			return -1;														\
+		st = _next;															\
+		for (k = 0; k < st->matches_no; k++)								\
+		{																	\
+			if (!matched[st->matches[k]])									\
+			{																\
+				matched[st->matches[k]] = 1;								\
+				found++;													\
+			}																\
+		}																	\
+	} while (0)
+
+
+int redfaSearch(REDFA_STRUCT *dfa, const unsigned char *Tx, int n, uint8_t *matched)
+{
+REDFA_STATE *st;
+int i, k, found = 0, flushed = 0;
+
+	memset (matched, 0, dfa->max_id);
+	if (dfa->roots_no == 0)
+		return 0;
+
+	if (dfa->start == NULL && (dfa->start = redfa_intern (dfa, NULL, 0, NULL, 0, REDFA_FLAG_START, &flushed)) == NULL)
+		return -1;
+	st = dfa->start;
+
+	for (i = 0; i < n - 1; i++)
+		STEP (Tx[i]);
+	if (n > 0)
+		STEP ((Tx[n - 1] == '\n') ? REDFA_SYM_LASTNL : Tx[n - 1]);
+	STEP (REDFA_SYM_END);
+
+	return found;
+}
+
+
+void redfaFree(REDFA_STRUCT *dfa)
+{
+	if (dfa == NULL)
+		return;
+
+	if (dfa->states != NULL)
+		redfa_flush (dfa);
+	free (dfa->states);
+	free (dfa->hash);
+	free (dfa->nodes);
+	free (dfa->classes);
+	free (dfa->roots);
+	free (dfa->stack);
+	free (dfa->dense);
+	free (dfa->sparse);
+	free (dfa->kernel);
+	free (dfa->ksparse);
+	free (dfa->matches);
+	free (dfa);
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file redfa.h
+ *	\brief This file contains a lazy DFA that scans a buffer once for a whole set of regular expressions.
+ *
+ *	All the patterns are compiled into a single Thompson NFA; the DFA states are built from it
+ *	on demand while scanning, and they are kept in a cache of at most REDFA_MAX_STATES states,
+ *	which is flushed when it is full. A search tells which patterns match somewhere in the buffer,
+ *	with the semantics of pcre_exec() (it may only report a few spurious matches in corner cases
+ *	of multiline anchors), but not where they match: callers that need the match offsets must
+ *	run pcre on the patterns that have been found.
+ *	Only a subset of the PCRE syntax is supported: redfaAddPattern() rejects patterns with
+ *	backreferences, lookaround, word boundaries, inline options, possessive quantifiers,
+ *	atomic groups, POSIX classes or the 'x' flag, which must be left to pcre.
+ */
+
+#ifndef REDFA_H
+#define REDFA_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Maximum number of DFA states kept in the cache
+#define REDFA_MAX_STATES 2048
+
+//! Maximum number of NFA nodes for the whole set of patterns
+#define REDFA_MAX_NODES 65536
+
+//! Maximum length of a pattern handled by the DFA (longer ones are left to pcre)
+#define REDFA_MAX_PATTERN_LEN 2048
+
+//! Input symbols: the 256 byte values, a newline that is the last byte of the buffer and the end of the buffer
+#define REDFA_SYM_LASTNL 256
+#define REDFA_SYM_END 257
+#define REDFA_SYMBOLS 258
+
+
+typedef struct _REDfaNode
+{
+	uint8_t type;				//!< Kind of node (REDFA_NODE_xxx).
+	uint8_t assertion;			//!< Condition checked by an assertion node (REDFA_ASSERT_xxx).
+	uint32_t out;				//!< Next node.
+	uint32_t out1;				//!< Alternative next node (split nodes) or ID of the pattern (match nodes).
+	uint32_t cls;				//!< Character class accepted by the node (char nodes).
+} REDFA_NODE;
+
+
+typedef struct _REDfaState
+{
+	struct _REDfaState *next[REDFA_SYMBOLS];	//!< Next state for each symbol (NULL if it has not been built yet).
+	uint32_t *nodes;			//!< Sorted NFA nodes reached by the last transition (the pattern roots are implicit).
+	int nodes_no;
+	uint32_t *matches;			//!< Sorted IDs of the patterns whose match ended right before the last transition.
+	int matches_no;
+	uint32_t flags;				//!< Context of the state (REDFA_FLAG_xxx).
+	uint32_t hash;
+} REDFA_STATE;
+
+
+typedef struct _REDfaStruct
+{
+	REDFA_NODE *nodes;			//!< NFA of all the patterns.
+	uint32_t nodes_no;
+	uint32_t nodes_max;
+	uint32_t (*classes)[8];		//!< Character classes (256-bit sets) referenced by the char nodes.
+	uint32_t classes_no;
+	uint32_t classes_max;
+	uint32_t *roots;			//!< First node of each pattern.
+	uint32_t roots_no;
+	uint32_t roots_max;
+	uint32_t max_id;			//!< Highest pattern ID (plus one).
+
+	REDFA_STATE **states;		//!< Cache of the DFA states.
+	int32_t states_no;
+	REDFA_STATE *start;			//!< Initial state (NULL if it has not been built yet).
+	int32_t *hash;				//!< Hash table (open addressing) of the cached states.
+	uint32_t flushes;			//!< Number of times the cache has been flushed.
+
+	uint32_t scratch_size;		//!< Number of entries of each scratch array.
+
+	uint32_t *stack;			//!< Scratch space for building new states (one entry per NFA node each).
+	uint32_t *dense;
+	uint32_t *sparse;
+	uint32_t dense_no;
+	uint32_t *kernel;
+	uint32_t *ksparse;
+	uint32_t *matches;
+} REDFA_STRUCT;
+
+
+REDFA_STRUCT *redfaNew(void);
+
+/*!
+	\brief Adds a pattern to the set.
+
+	\param pattern Pattern, in PCRE syntax.
+	\param n Length of the pattern.
+	\param flags Flags of the pattern, as accepted by the regexp coprocessor ('i', 's', 'm', 'A', 'E', 'G').
+	\param id ID reported by redfaSearch() when the pattern matches.
+
+	\return 0 if the pattern has been added, -1 if it uses constructs that are not supported
+	(in this case the set is left unchanged).
+*/
+int redfaAddPattern(REDFA_STRUCT *dfa, const char *pattern, int n, const char *flags, uint32_t id);
+
+/*!
+	\brief Looks for all the patterns in a buffer, scanning it once.
+
+	\param matched Array of (at least) dfa->max_id bytes; on return, matched[id] is 1 if the pattern
+	with that ID matches somewhere in the buffer, 0 otherwise.
+
+	\return The number of patterns that match, or -1 if there is not enough memory to build the DFA.
+*/
+int redfaSearch(REDFA_STRUCT *dfa, const unsigned char *Tx, int n, uint8_t *matched);
+
+void redfaFree(REDFA_STRUCT *dfa);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
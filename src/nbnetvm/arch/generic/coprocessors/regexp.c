@@ -14,6 +14,7 @@
 #include "nbnetvm.h"
 #include "../../../coprocessor.h"
 #include "../../../../nbee/globals/profiling-functions.h"
+#include "redfa.h"
 #include <pcre.h>
 
 //#define COPRO_REGEXP_DEBUG
@@ -55,9 +56,26 @@ typedef struct {
 	uint32_t patterns_no;
 	nvmRegExpCoproMatchResult match;
 	int matched;				//!< True if we had a match
+
+	REDFA_STRUCT *dfa;			//!< DFA of the patterns it supports (NULL if every pattern is tried by pcre).
+	uint8_t *dfa_pattern;		//!< True for the patterns that are in the DFA.
+	uint8_t *dfa_matched;		//!< True for the patterns found by the last DFA scan.
+	uint8_t *scanned;			//!< Copy of the data of the last DFA scan, so that its result is reused for the same data.
+	uint32_t scanned_len;
+	uint32_t scanned_max;
+	int scan_valid;				//!< True if 'scanned' and 'dfa_matched' are valid.
 } nvmRegExpCoproInternalData;
 
 
+/* Matcher used by the coprocessors that are initialized from now on. */
+static nvmRegExpEngine RegExpEngine = nvmREGEXP_AUTO;
+
+
+void nvmSetRegExpEngine (nvmRegExpEngine Engine) {
+	RegExpEngine = Engine;
+}
+
+
 
 static int nvmRegExpCoproParseFlagsPcre (char *flags) {
 	uint32_t i = 0, out = 0; /* Start with no flags */
@@ -151,6 +169,21 @@ int32_t nvmRegExpCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 	redebug ("* %hd RegExp's\n", redata -> patterns_no);
 	redata -> patterns = (nvmRegExpCoproPattern *) malloc (sizeof (nvmRegExpCoproPattern) * redata -> patterns_no);
 
+	/* The patterns supported by the DFA are scanned at once, the others are left to pcre */
+	if (RegExpEngine == nvmREGEXP_AUTO && redata -> patterns_no > 0) {
+		redata -> dfa = redfaNew ();
+		redata -> dfa_pattern = (uint8_t *) calloc (redata -> patterns_no, sizeof (uint8_t));
+		redata -> dfa_matched = (uint8_t *) calloc (redata -> patterns_no, sizeof (uint8_t));
+		if (redata -> dfa == NULL || redata -> dfa_pattern == NULL || redata -> dfa_matched == NULL) {
+			redfaFree (redata -> dfa);
+			free (redata -> dfa_pattern);
+			free (redata -> dfa_matched);
+			redata -> dfa = NULL;
+			redata -> dfa_pattern = NULL;
+			redata -> dfa_matched = NULL;
+		}
+	}
+
 	for (g = 0; g < redata -> patterns_no; g++) {
 		flags_length = *(uint16_t *) data;
 		data += SIZE_DW;
@@ -170,6 +203,10 @@ int32_t nvmRegExpCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 		
 		if (nvmRegExpCoproNewPattern (&(redata -> patterns[g]), p, pattern_length, flags) == NULL)
 			out= nvmFAILURE;
+		else if (redata -> dfa != NULL && redfaAddPattern (redata -> dfa, p, (int) strlen (p), flags, g) == 0) {
+			redata -> dfa_pattern[g] = 1;
+			redebug ("  - Matched by the DFA\n");
+		}
 
 		free (p);
 
@@ -182,6 +219,33 @@ int32_t nvmRegExpCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 #endif
 
 
+/* Scans the data with the DFA, unless the result of the last scan refers to the same data (as it happens
+ * when several patterns are tried on the same payload); returns 0 if the DFA could not be used. */
+static int nvmRegExpCoproScan (nvmRegExpCoproInternalData *redata, uint8_t *data, uint32_t len) {
+	uint8_t *tmp;
+
+	if (redata -> scan_valid && redata -> scanned_len == len && (len == 0 || memcmp (redata -> scanned, data, len) == 0))
+		return 1;
+
+	redata -> scan_valid = 0;
+	if (redfaSearch (redata -> dfa, data, len, redata -> dfa_matched) < 0)
+		return 0;
+
+	if (len > redata -> scanned_max) {
+		tmp = (uint8_t *) realloc (redata -> scanned, len);
+		if (tmp == NULL)
+			return 1;		/* The result is still valid for this call */
+		redata -> scanned = tmp;
+		redata -> scanned_max = len;
+	}
+	if (len > 0)
+		memcpy (redata -> scanned, data, len);
+	redata -> scanned_len = len;
+	redata -> scan_valid = 1;
+	return 1;
+}
+
+
 #define OVECTSIZE 15		/* Should be a multiple of 3 */
 
 static uint32_t nvmRegExpCoproTestPattern (uint16_t pattern_id, uint8_t *haystack, uint32_t haylen,
@@ -197,6 +261,10 @@ static uint32_t nvmRegExpCoproTestPattern (uint16_t pattern_id, uint8_t *haystac
 	if (pattern_id < redata -> patterns_no) {
 		rcp = &(redata -> patterns[pattern_id]);
 		redebug ("Looking for RegExp: \"%s\"\n", rcp -> pattern);
+		/* The DFA tells whether the pattern matches; pcre is needed only to find where */
+		if (redata -> dfa_pattern != NULL && redata -> dfa_pattern[pattern_id] &&
+			nvmRegExpCoproScan (redata, haystack + start_offset, haylen) && !redata -> dfa_matched[pattern_id])
+			return (redata -> matched);
 		m = pcre_exec (rcp -> re, rcp -> re_extra, (char*) haystack + start_offset, haylen, 0, 0, ovector, OVECTSIZE);
 		if (m > 0) {
 			(redata -> match).rcp = rcp;
@@ -285,7 +353,7 @@ static int32_t nvmRegExpCoproRun (nvmCoprocessorState *c, uint32_t operation)
 int32_t nvmCoproRegexpCreate(nvmCoprocessorState *regexp)
 {
 	static uint8_t flags[]={COPREG_READ | COPREG_WRITE, COPREG_READ | COPREG_WRITE, COPREG_READ | COPREG_WRITE, COPREG_READ};
-	static uint32_t regs[]={0,0};
+	static uint32_t regs[]={0,0,0,0};
 
 #ifdef RTE_PROFILE_COUNTERS
 	uint32_t i;
@@ -304,7 +372,7 @@ int32_t nvmCoproRegexpCreate(nvmCoprocessorState *regexp)
 	regexp->write = nvmCoproStandardRegWrite;
 	regexp->read = nvmCoproStandardRegRead;
 	regexp->invoke = nvmRegExpCoproRun;
-	regexp->data =malloc(sizeof(nvmRegExpCoproInternalData));
+	regexp->data =calloc(1, sizeof(nvmRegExpCoproInternalData));
 	if(regexp->data == NULL)
 	{
 		printf("Error in allocating regexp->data\n");
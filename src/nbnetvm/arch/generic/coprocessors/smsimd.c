@@ -0,0 +1,359 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file smsimd.c
+ *	\brief This file contains a vectorised multi-pattern matcher, alternative to the Aho-Corasick one in acsmx2.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "smsimd.h"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SMSIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/* The AVX2 kernel is compiled for a specific target and selected at run time, so that the
+   library does not require AVX2 to be enabled for the whole build */
+#if defined(SMSIMD_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SMSIMD_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static int smsimd_ctz (unsigned int x)
+{
+unsigned long index;
+
+	_BitScanForward (&index, x);
+	return (int) index;
+}
+#elif defined(__GNUC__)
+#define smsimd_ctz(x) __builtin_ctz(x)
+#endif
+
+
+typedef int (smsimd_found_t) (SMSIMD_PATTERN *p, int index, void *ctx);
+
+
+/* Checks the whole pattern; first and last bytes have already been checked by the prefilter,
+   which is exact for them (the 0x20 bit is ignored only for letters). */
+static int verify (SMSIMD_PATTERN *p, const unsigned char *T)
+{
+int i;
+
+	if (p->n <= 2)
+		return 1;
+
+	if (!p->nocase)
+		return memcmp (T + 1, p->pattern + 1, p->n - 2) == 0;
+
+	for (i = 1; i < p->n - 1; i++)
+	{
+		if (toupper (T[i]) != p->upper[i])
+			return 0;
+	}
+	return 1;
+}
+
+
+static int scan_scalar (SMSIMD_PATTERN *p, const unsigned char *T, int n, int start, smsimd_found_t *found, void *ctx)
+{
+int i;
+
+	for (i = start; i + p->n <= n; i++)
+	{
+		if ((T[i] | p->first_fold) == p->first && (T[i + p->n - 1] | p->last_fold) == p->last && verify (p, T + i))
+		{
+			if (found (p, i, ctx))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+
+#ifdef SMSIMD_SSE2
+static int scan_sse2 (SMSIMD_PATTERN *p, const unsigned char *T, int n, smsimd_found_t *found, void *ctx)
+{
+__m128i first, last, first_fold, last_fold, a, b;
+unsigned int mask;
+int i, bit;
+
+	first = _mm_set1_epi8 ((char) p->first);
+	last = _mm_set1_epi8 ((char) p->last);
+	first_fold = _mm_set1_epi8 ((char) p->first_fold);
+	last_fold = _mm_set1_epi8 ((char) p->last_fold);
+
+	for (i = 0; i + p->n + 15 <= n; i += 16)
+	{
+		a = _mm_or_si128 (_mm_loadu_si128 ((const __m128i *) (T + i)), first_fold);
+		b = _mm_or_si128 (_mm_loadu_si128 ((const __m128i *) (T + i + p->n - 1)), last_fold);
+		mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (a, first), _mm_cmpeq_epi8 (b, last)));
+
+		while (mask)
+		{
+			bit = smsimd_ctz (mask);
+			mask &= mask - 1;
+			if (verify (p, T + i + bit) && found (p, i + bit, ctx))
+				return 1;
+		}
+	}
+
+	return scan_scalar (p, T, n, i, found, ctx);
+}
+#endif
+
+
+#ifdef SMSIMD_AVX2
+__attribute__ ((target ("avx2")))
+static int scan_avx2 (SMSIMD_PATTERN *p, const unsigned char *T, int n, smsimd_found_t *found, void *ctx)
+{
+__m256i first, last, first_fold, last_fold, a, b;
+unsigned int mask;
+int i, bit;
+
+	first = _mm256_set1_epi8 ((char) p->first);
+	last = _mm256_set1_epi8 ((char) p->last);
+	first_fold = _mm256_set1_epi8 ((char) p->first_fold);
+	last_fold = _mm256_set1_epi8 ((char) p->last_fold);
+
+	for (i = 0; i + p->n + 31 <= n; i += 32)
+	{
+		a = _mm256_or_si256 (_mm256_loadu_si256 ((const __m256i *) (T + i)), first_fold);
+		b = _mm256_or_si256 (_mm256_loadu_si256 ((const __m256i *) (T + i + p->n - 1)), last_fold);
+		mask = (unsigned int) _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (a, first), _mm256_cmpeq_epi8 (b, last)));
+
+		while (mask)
+		{
+			bit = smsimd_ctz (mask);
+			mask &= mask - 1;
+			if (verify (p, T + i + bit) && found (p, i + bit, ctx))
+				return 1;
+		}
+	}
+
+	return scan_scalar (p, T, n, i, found, ctx);
+}
+
+
+static int has_avx2 (void)
+{
+static int supported = -1;
+
+	if (supported < 0)
+	{
+		__builtin_cpu_init ();
+		supported = __builtin_cpu_supports ("avx2") ? 1 : 0;
+	}
+	return supported;
+}
+#endif
+
+
+static int scan (SMSIMD_PATTERN *p, const unsigned char *T, int n, smsimd_found_t *found, void *ctx)
+{
+#ifdef SMSIMD_AVX2
+	if (has_avx2 ())
+		return scan_avx2 (p, T, n, found, ctx);
+#endif
+#ifdef SMSIMD_SSE2
+	return scan_sse2 (p, T, n, found, ctx);
+#else
+	return scan_scalar (p, T, n, 0, found, ctx);
+#endif
+}
+
+
+int smsimdIsVectorised (void)
+{
+#ifdef SMSIMD_SSE2
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+
+SMSIMD_STRUCT *smsimdNew (void)
+{
+	return (SMSIMD_STRUCT *) calloc (1, sizeof (SMSIMD_STRUCT));
+}
+
+
+static void set_edge (unsigned char c, int nocase, unsigned char *value, unsigned char *fold)
+{
+	if (nocase && isalpha (c))
+	{
+		*value = (unsigned char) tolower (c);
+		*fold = 0x20;
+	}
+	else
+	{
+		*value = c;
+		*fold = 0;
+	}
+}
+
+
+int smsimdAddPattern (SMSIMD_STRUCT *sm, unsigned char *pat, int n, int nocase, void *id)
+{
+SMSIMD_PATTERN *p;
+int i;
+
+	if (n <= 0)
+		return -1;
+
+	if (sm->patterns_no == sm->patterns_max)
+	{
+		p = (SMSIMD_PATTERN *) realloc (sm->patterns, (sm->patterns_max * 2 + 1) * sizeof (SMSIMD_PATTERN));
+		if (p == NULL)
+			return -1;
+		sm->patterns = p;
+		sm->patterns_max = sm->patterns_max * 2 + 1;
+	}
+
+	p = &sm->patterns[sm->patterns_no];
+	p->pattern = (unsigned char *) malloc (n);
+	p->upper = (unsigned char *) malloc (n);
+	if (p->pattern == NULL || p->upper == NULL)
+	{
+		free (p->pattern);
+		free (p->upper);
+		return -1;
+	}
+
+	memcpy (p->pattern, pat, n);
+	for (i = 0; i < n; i++)
+		p->upper[i] = (unsigned char) toupper (pat[i]);
+	p->n = n;
+	p->nocase = nocase;
+	p->id = id;
+	set_edge (pat[0], nocase, &p->first, &p->first_fold);
+	set_edge (pat[n - 1], nocase, &p->last, &p->last_fold);
+
+	sm->patterns_no++;
+	return 0;
+}
+
+
+/* Context of a search, used by the callbacks that receive the matches from the kernels */
+typedef struct {
+	SMSIMD_STRUCT *sm;
+	int (*Match) (void *id, int index, void *data);
+	void *data;
+	int nfound;
+} smsimd_search_ctx;
+
+
+static int found_report (SMSIMD_PATTERN *p, int index, void *ctx)
+{
+smsimd_search_ctx *search = (smsimd_search_ctx *) ctx;
+
+	search->nfound++;
+	return search->Match (p->id, index, search->data);
+}
+
+
+static int found_collect (SMSIMD_PATTERN *p, int index, void *ctx)
+{
+smsimd_search_ctx *search = (smsimd_search_ctx *) ctx;
+SMSIMD_STRUCT *sm = search->sm;
+SMSIMD_MATCH *m;
+
+	if (sm->matches_no == sm->matches_max)
+	{
+		m = (SMSIMD_MATCH *) realloc (sm->matches, (sm->matches_max * 2 + 64) * sizeof (SMSIMD_MATCH));
+		if (m == NULL)
+		{
+			fprintf (stderr, "smsimd: not enough memory for the match list\n");
+			return 1;
+		}
+		sm->matches = m;
+		sm->matches_max = sm->matches_max * 2 + 64;
+	}
+
+	m = &sm->matches[sm->matches_no++];
+	m->index = index;
+	m->end = index + p->n;
+	m->order = (int) (p - sm->patterns);
+	return 0;
+}
+
+
+static int compare_matches (const void *a, const void *b)
+{
+const SMSIMD_MATCH *ma = (const SMSIMD_MATCH *) a;
+const SMSIMD_MATCH *mb = (const SMSIMD_MATCH *) b;
+
+	if (ma->end != mb->end)
+		return (ma->end < mb->end) ? -1 : 1;
+	return ma->order - mb->order;
+}
+
+
+int smsimdSearch (SMSIMD_STRUCT *sm, unsigned char *Tx, int n,
+			int (*Match) (void *id, int index, void *data), void *data)
+{
+smsimd_search_ctx search;
+int i;
+
+	search.sm = sm;
+	search.Match = Match;
+	search.data = data;
+	search.nfound = 0;
+
+	/* A single pattern finds its matches already sorted by end position */
+	if (sm->patterns_no == 1)
+	{
+		scan (&sm->patterns[0], Tx, n, found_report, &search);
+		return search.nfound;
+	}
+
+	/* Otherwise scan for each pattern, then report all the matches in the order Aho-Corasick would */
+	sm->matches_no = 0;
+	for (i = 0; i < sm->patterns_no; i++)
+	{
+		if (scan (&sm->patterns[i], Tx, n, found_collect, &search))
+			break;
+	}
+
+	if (sm->matches_no > 1)
+		qsort (sm->matches, sm->matches_no, sizeof (SMSIMD_MATCH), compare_matches);
+
+	for (i = 0; i < sm->matches_no; i++)
+	{
+		search.nfound++;
+		if (Match (sm->patterns[sm->matches[i].order].id, sm->matches[i].index, data))
+			break;
+	}
+
+	return search.nfound;
+}
+
+
+void smsimdFree (SMSIMD_STRUCT *sm)
+{
+int i;
+
+	if (sm == NULL)
+		return;
+
+	for (i = 0; i < sm->patterns_no; i++)
+	{
+		free (sm->patterns[i].pattern);
+		free (sm->patterns[i].upper);
+	}
+	free (sm->patterns);
+	free (sm->matches);
+	free (sm);
+}
@@ -0,0 +1,90 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file smsimd.h
+ *	\brief This file contains a vectorised multi-pattern matcher, alternative to the Aho-Corasick one in acsmx2.c.
+ *
+ *	Each pattern is searched with a first-byte/last-byte prefilter that tests 16 (SSE2) or 32 (AVX2)
+ *	candidate positions at once; the (few) candidates that pass it are then verified exactly.
+ *	Matches are reported with the same semantics of acsmSearch2(): every (possibly overlapping)
+ *	occurrence is reported, by increasing end position, with the offset of its first byte;
+ *	'nocase' patterns are matched regardless of the case of ASCII letters.
+ */
+
+#ifndef SMSIMD_H
+#define SMSIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Maximum number of patterns in a group for which this matcher is preferred to Aho-Corasick
+#define SMSIMD_MAX_PATTERNS 8
+
+
+typedef struct _SMSimdPattern
+{
+	unsigned char *pattern;		//!< Pattern, as it has been given.
+	unsigned char *upper;		//!< Pattern with letters converted to uppercase (for 'nocase' patterns).
+	int n;						//!< Length of the pattern.
+	int nocase;					//!< Non-zero if the pattern must be matched regardless of case.
+	void *id;					//!< Pointer returned to the match callback.
+	unsigned char first;		//!< First byte of the pattern (lowercase, if 'first_fold' is set).
+	unsigned char last;			//!< Last byte of the pattern (lowercase, if 'last_fold' is set).
+	unsigned char first_fold;	//!< 0x20 if the first byte is a letter that matches regardless of case, 0 otherwise.
+	unsigned char last_fold;	//!< 0x20 if the last byte is a letter that matches regardless of case, 0 otherwise.
+} SMSIMD_PATTERN;
+
+
+typedef struct _SMSimdMatch
+{
+	int index;					//!< Offset of the first byte of the match.
+	int end;					//!< Offset of the byte following the match.
+	int order;					//!< Position of the pattern in the group.
+} SMSIMD_MATCH;
+
+
+typedef struct _SMSimdStruct
+{
+	SMSIMD_PATTERN *patterns;
+	int patterns_no;
+	int patterns_max;
+
+	SMSIMD_MATCH *matches;		//!< Matches of the current search, sorted before being reported (multi-pattern groups only).
+	int matches_no;
+	int matches_max;
+} SMSIMD_STRUCT;
+
+
+//! Returns non-zero if the matcher has been compiled with vector instructions for the current platform.
+int smsimdIsVectorised(void);
+
+SMSIMD_STRUCT *smsimdNew(void);
+
+//! Adds a pattern to the group; patterns must be at least one byte long.
+int smsimdAddPattern(SMSIMD_STRUCT *sm, unsigned char *pat, int n, int nocase, void *id);
+
+/*!
+	\brief Looks for all the patterns in a buffer.
+
+	\param Match Function called for each match, with the 'id' of the pattern, the offset of the
+	match and 'data'; the search stops if it returns a non-zero value.
+
+	\return The number of matches that have been reported.
+*/
+int smsimdSearch(SMSIMD_STRUCT *sm, unsigned char *Tx, int n,
+			int (*Match) (void *id, int index, void *data), void *data);
+
+void smsimdFree(SMSIMD_STRUCT *sm);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
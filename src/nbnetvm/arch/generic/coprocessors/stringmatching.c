@@ -15,6 +15,7 @@
 #include "../../../coprocessor.h"
 #include "../../../../nbee/globals/profiling-functions.h"
 #include "acsmx2.h"
+#include "smsimd.h"
 
 #ifdef COPRO_STRINGMATCH_DEBUG
 #define smdebug printf
@@ -55,6 +56,7 @@ typedef struct nvmStringMatchCoproMatchResult_s {
 /* This struct contains all data representing the state of the coprocessor. */
 typedef struct {
 	ACSM_STRUCT2 **acsm;
+	SMSIMD_STRUCT **simd;			//!< Vectorised matcher of each group (NULL if the group uses Aho-Corasick).
 	uint32_t graphs_no;
 
 	nvmStringMatchCoproPattern *patterns;
@@ -69,6 +71,14 @@ typedef struct {
 nvmStringMatchCoproInternalData smcdata;
 */
 
+/* Matcher used by the coprocessors that are initialized from now on. */
+static nvmStringMatchEngine StringMatchEngine = nvmSTRINGMATCH_AUTO;
+
+
+void nvmSetStringMatchEngine (nvmStringMatchEngine Engine) {
+	StringMatchEngine = Engine;
+}
+
 
 static void print_pattern (char *pattern, int len) {
 #ifdef COPRO_STRINGMATCH_DEBUG
@@ -91,6 +101,28 @@ static void print_pattern (char *pattern, int len) {
 #define SIZE_DW (sizeof (uint16_t))
 #define SIZE_DD (sizeof (uint32_t))
 
+
+/* Decides whether the vectorised matcher should be used for a group, given the data of its patterns. */
+static int use_simd_matcher (uint8_t *data, uint16_t patterns_no) {
+	uint16_t i, pattern_length;
+
+	if (StringMatchEngine == nvmSTRINGMATCH_AHOCORASICK)
+		return 0;
+	if (StringMatchEngine == nvmSTRINGMATCH_AUTO && (patterns_no > SMSIMD_MAX_PATTERNS || !smsimdIsVectorised ()))
+		return 0;
+
+	/* Empty patterns are supported by Aho-Corasick only */
+	for (i = 0; i < patterns_no; i++) {
+		pattern_length = *(uint16_t *) data;
+		if (pattern_length == 0)
+			return 0;
+		data += 2 * SIZE_DW + SIZE_DD + pattern_length * SIZE_DB;
+	}
+
+	return (patterns_no > 0);
+}
+
+
 int32_t nvmStringMatchCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 	uint32_t /*byte_order,*/ pattern_data;
 	uint16_t g, i, patterns_no, pattern_length, pattern_nocase;
@@ -109,17 +141,24 @@ int32_t nvmStringMatchCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 	smcdata -> graphs_no = *(uint16_t *) data;
 	data += SIZE_DW;
 	smdebug ("* %hd pattern groups\n", smcdata -> graphs_no);
-	smcdata -> acsm = (ACSM_STRUCT2 **) malloc (sizeof (ACSM_STRUCT2 *) * smcdata -> graphs_no);
+	smcdata -> acsm = (ACSM_STRUCT2 **) calloc (smcdata -> graphs_no, sizeof (ACSM_STRUCT2 *));
+	smcdata -> simd = (SMSIMD_STRUCT **) calloc (smcdata -> graphs_no, sizeof (SMSIMD_STRUCT *));
 
 	/* Read data for all graphs */
 	for (g = 0; g < smcdata -> graphs_no; g++) {
-		/* Init Aho-Corasick state machine */
-		smcdata -> acsm[g] = acsmNew2 ();
-		smcdata -> acsm[g] -> acsmFormat = ACF_FULL;		// For the moment...
-
 		patterns_no = *(uint16_t *) data;
 		data += SIZE_DW;
 		smdebug ("* %hd patterns\n", patterns_no);
+
+		if (use_simd_matcher (data, patterns_no)) {
+			/* Init vectorised matcher */
+			smdebug ("* Using the vectorised matcher\n");
+			smcdata -> simd[g] = smsimdNew ();
+		} else {
+			/* Init Aho-Corasick state machine */
+			smcdata -> acsm[g] = acsmNew2 ();
+			smcdata -> acsm[g] -> acsmFormat = ACF_FULL;		// For the moment...
+		}
 		for (i = 0; i < patterns_no; i++) {
 			pattern_length = *(uint16_t *) data;
 			data += SIZE_DW;
@@ -155,14 +194,20 @@ int32_t nvmStringMatchCoproInjectData (nvmCoprocessorState *c, uint8_t *data) {
 				smcdata -> patterns = p;
 			}
 
-			/* Add pattern to Aho-Corasick SM */
-			acsmAddPattern2 (smcdata -> acsm[g], data, pattern_length, pattern_nocase, 0, 0, p, i);
+			/* Add pattern to the matcher */
+			if (smcdata -> simd[g] != NULL)
+				smsimdAddPattern (smcdata -> simd[g], data, pattern_length, pattern_nocase, p);
+			else
+				acsmAddPattern2 (smcdata -> acsm[g], data, pattern_length, pattern_nocase, 0, 0, p, i);
 			smcdata -> patterns_no++;
 
 			/* On with next pattern */
 			data += pattern_length * SIZE_DB;
 		}
 
+		if (smcdata -> acsm[g] == NULL)
+			continue;
+
 		/* All patterns added: compile graph */
 	// 	Print_DFA (smcdata -> acsm);
 		acsmCompile2 (smcdata -> acsm[g]);
@@ -208,7 +253,6 @@ static int nvmStringMatchCoproMatchFoundCallback (void *add_data, int pattern_of
 
 static uint32_t nvmStringMatchCoproTestPatternGroup (uint16_t group_id, uint8_t *haystack, uint32_t haylen,
 							uint32_t start_offset, nvmStringMatchCoproInternalData *smcdata) {
-	ACSM_STRUCT2 *acsm;
 	//nvmStringMatchCoproMatchResult *r = NULL, *next = NULL;
 
 	/* Reset match results data */
@@ -221,8 +265,10 @@ static uint32_t nvmStringMatchCoproTestPatternGroup (uint16_t group_id, uint8_t
 	/* Do the actual search */
 	if (group_id < smcdata -> graphs_no) {
 		smdebug ("Matching pattern group %u\n", group_id);
-		acsm = smcdata -> acsm[group_id];
-		acsmSearch2 (acsm, haystack + start_offset, haylen, nvmStringMatchCoproMatchFoundCallback, smcdata);
+		if (smcdata -> simd[group_id] != NULL)
+			smsimdSearch (smcdata -> simd[group_id], haystack + start_offset, haylen, nvmStringMatchCoproMatchFoundCallback, smcdata);
+		else
+			acsmSearch2 (smcdata -> acsm[group_id], haystack + start_offset, haylen, nvmStringMatchCoproMatchFoundCallback, smcdata);
 	} else {
 		printf ("String-matching coprocessor: tried to use inexistent graph\n");
 	}
@@ -320,8 +366,13 @@ int32_t nvmStringMatchCoproCleanup (nvmCoprocessorState *c, uint8_t *data) {
 	free (smcdata -> matches);
 
 	/* Free graphs data */
-	for (g = 0; g < smcdata -> graphs_no; g++)
-		acsmFree2 (smcdata -> acsm[g]);
+	for (g = 0; g < smcdata -> graphs_no; g++) {
+		if (smcdata -> acsm[g] != NULL)
+			acsmFree2 (smcdata -> acsm[g]);
+		smsimdFree (smcdata -> simd[g]);
+	}
+	free (smcdata -> acsm);
+	free (smcdata -> simd);
 
 	/* Free whole object */
 	free (smcdata);
@@ -14,6 +14,8 @@
  */
 
 #include "generic_interpreter.h"
+#include "generic_threaded.h"
+#include "generic_switch.h"
 #include "../../opcodes.h"
 #include "../../../nbee/globals/debug.h"
 #include "../../../nbee/globals/profiling-functions.h"
@@ -57,22 +59,14 @@ NetVMInstructionsProfiler.n_jump++;
 #define CODE_PROFILING_JUMPCHECK()
 #endif
 
-void CODE_PROFILING_INSTRUCTION_COUNTER()
-{
-#ifdef COUNTERS_PROFILING
+// Expanded in the main loop of the interpreter, so it must not cost anything when profiling is disabled
+#if defined(COUNTERS_PROFILING) || defined(RTE_DYNAMIC_PROFILE)
+#define CODE_PROFILING_INSTRUCTION_COUNTER() \
 NetVMInstructionsProfiler.n_instruction++;
-return;
-#endif
-
-#ifdef RTE_DYNAMIC_PROFILE
-NetVMInstructionsProfiler.n_instruction++;
-return;
+#else
+#define CODE_PROFILING_INSTRUCTION_COUNTER()
 #endif
 
-}
-
-uint32_t pktlen = 0, infolen = 0, codelen = 0;
-
 
 
 #ifdef _WIN32
@@ -150,10 +144,10 @@ uint32_t do_pscandw(uint8_t *pkt, uint32_t offset, uint32_t value, uint32_t p_le
 }
 
 
-// #define USE_EXPERIMENTAL_SWITCH
-
-#ifndef USE_EXPERIMENTAL_SWITCH
-
+/*
+	Linear scan of the cases of a switch; it is used only when the switches of the handler
+	have not been lowered into lookup tables (see genRT_LowerSwitches()).
+*/
 void gen_do_switch(uint8_t  *pr_buf, uint32_t *pc, uint32_t value)
 {
 	uint32_t npairs = 0, key = 0, target = 0;
@@ -185,62 +179,6 @@ void gen_do_switch(uint8_t  *pr_buf, uint32_t *pc, uint32_t value)
 	(*pc) = next_insn + default_displ;
 }
 
-#else
-
-#warning "Using experimental switch implementation"
-
-#include "../../assembler/hashtable.h"
-
-#define SWITCH_CACHE_SIZE 50
-hash_table *htswitches;
-
-void gen_do_switch(uint8_t  *pr_buf, int32_t *pc, uint32_t value) {
-	uint32_t npairs = 0, key = 0, *target = 0;
-	uint32_t i = 0;
-	uint32_t next_insn = 0;
-	int32_t default_displ;
-	hash_table *ht;
-	uint32_t swid[2], *swidcopy;
-
-	default_displ = *(uint32_t *) &pr_buf[*pc];
-	(*pc) += 4;
-	npairs = *(int32_t *) &pr_buf[*pc];
-	(*pc) += 4;
-	next_insn = (*pc) + npairs * 8;
-
-	/* We identify the switch by the bytecode start address and the current PC */
-	swid[0] = (uint32_t) pr_buf;
-	swid[1] = (uint32_t) *pc;
-	if (!hash_table_lookup (htswitches, swid, sizeof (uint32_t) * 2, (void *) &ht)) {
-		printf ("Caching new switch, SWID: %u/%u, npairs: %u\n", swid[0], swid[1], npairs);
-		ht = hash_table_new (npairs > 4096 ? 2048 : npairs / 2);		/* Is this OK? */
-
-		/* Cache switch pairs */
-		for (i = 0; i < npairs; i++) {
-			hash_table_add (ht, &pr_buf[*pc], sizeof (uint32_t), &pr_buf[(*pc) + 4]);
-			(*pc) += 8;
-		}
-
-		/* Add the switch to the cache */
-		swidcopy = (uint32_t *) malloc (sizeof (uint32_t) * 2);
-		memcpy (swidcopy, &swid, sizeof (uint32_t) * 2);
-		hash_table_add (htswitches, swidcopy, sizeof (uint32_t) * 2, ht);
-	}
-
-	/* Do the switch */
-	if (hash_table_lookup (ht, &value, sizeof (uint32_t), (void *) &target)) {
-// 		printf ("- target: %u\n", *target);
-		(*pc) = next_insn + *target;
-	} else {
-// 		printf ("- default: %u\n", default_displ);
-		(*pc) = next_insn + default_displ;
-	}
-
-	return;
-}
-
-#endif
-
 //--------------------------------------------------------------------------------------------
 //					RUN INSTRUCTIONS
 //--------------------------------------------------------------------------------------------
@@ -292,7 +230,7 @@ void gen_do_switch(uint8_t  *pr_buf, int32_t *pc, uint32_t value) {
 
 #define DATAMEM_CHECK(n , b) \
 	CODE_PROFILING_DATACHECK(); \
-	if ((n+b) > HandlerState->PEState->DataMem->Size) { \
+	if (((b) > HandlerState->PEState->DataMem->Size) || ((n) > HandlerState->PEState->DataMem->Size - (b))) { \
 		errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access data memory with an offset too big (%d > %d)\n", n, HandlerState->PEState->DataMem->Size); \
 		return nvmDATAEX; \
 	}
@@ -325,7 +263,7 @@ void gen_do_switch(uint8_t  *pr_buf, int32_t *pc, uint32_t value) {
 
 #define PKTMEM_CHECK(n , b )  \
 	CODE_PROFILING_PKTCHECK(); \
-	if ((n+b) > pktlen) { \
+	if (((b) > pktlen) || ((n) > pktlen - (b))) { \
 		errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access packet memory with an offset too big (from %d to %d > %d)\n", n, n+b-1 , pktlen); \
 		return nvmPKTEX; \
 	}
@@ -334,7 +272,7 @@ void gen_do_switch(uint8_t  *pr_buf, int32_t *pc, uint32_t value) {
 
 #define INFOMEM_CHECK(n , b ) \
 	CODE_PROFILING_INFOCHECK(); \
-	if ((n+b) > infolen) { \
+	if (((b) > infolen) || ((n) > infolen - (b))) { \
 		errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access info memory with an offset too big (from %d to %d > %d)\n", n, n+b-1 , infolen); \
 		return nvmINFOEX ; \
 	}
@@ -391,6 +329,9 @@ uint32_t stacksize = 0;
 
 uint8_t *pr_buf;
 uint32_t pc, sp;
+// Lengths used by the bounds checks; they are local, since several runtimes may execute handlers at the same time
+uint32_t pktlen = 0, infolen = 0, codelen = 0;
+genSwitchTable *switchtable;
 uint32_t ctdPort;
 
 #ifdef RTE_PROFILE_COUNTERS
@@ -418,11 +359,6 @@ uint32_t inithandler=0;
 	logdata(LOG_NETIL_INTERPRETER, "----------------------------");
 #endif
 
-#ifdef USE_EXPERIMENTAL_SWITCH
-	if (!htswitches)
-		htswitches = hash_table_new (SWITCH_CACHE_SIZE);
-#endif
-
 	//entrypoint of the bytecode
 	pr_buf = HandlerState->Handler->ByteCode;
 
@@ -529,6 +465,26 @@ uint32_t inithandler=0;
 	HandlerState->ProfCounters->TicksStart= nbProfilerGetTime();
 #endif
 
+#ifdef GEN_THREADED_INTERPRETER
+	// Push handlers are translated into threaded code the first time they are executed
+	if (PUSH_SEGMENT && (HandlerState->ThreadedCode == NULL) && (!HandlerState->ThreadedFailed))
+	{
+		if (genRT_TranslateHandler(HandlerState) != nvmSUCCESS)
+			HandlerState->ThreadedFailed= 1;
+	}
+
+	if (PUSH_SEGMENT && (HandlerState->ThreadedCode != NULL))
+		return genRT_Execute_Threaded((genThreadedCode *) HandlerState->ThreadedCode, exbuf, HandlerState, stack, sp, locals);
+#endif
+
+	// The cases of the switches are lowered into lookup tables the first time the handler is interpreted
+	if ((HandlerState->Switches == NULL) && (!HandlerState->SwitchesFailed))
+	{
+		HandlerState->Switches= genRT_LowerSwitches(HandlerState);
+		if (HandlerState->Switches == NULL)
+			HandlerState->SwitchesFailed= 1;
+	}
+
 	loop = 1;
 	while (loop)
 	{
@@ -1825,8 +1781,17 @@ uint32_t inithandler=0;
 				logdata(LOG_NETIL_INTERPRETER, "%s; Handler= %d, Pidx= %d, SP= %d, Value= %d",
 					nvmOpCodeTable[pr_buf[pc]].CodeName, HandlerState->Handler->OwnerPE->Name, pidx, sp,stack[sp-1]);
 #endif
-				pc++;
-				gen_do_switch(pr_buf, &pc, stack[sp-1]);
+				switchtable= NULL;
+				if (HandlerState->Switches != NULL)
+					switchtable= genRT_FindSwitch((genSwitchSet *) HandlerState->Switches, pc);
+
+				if (switchtable != NULL)
+					pc= genRT_SwitchLookup(switchtable, stack[sp-1]);
+				else
+				{
+					pc++;
+					gen_do_switch(pr_buf, &pc, stack[sp-1]);
+				}
 				JUMPCHECK(pc);
 				sp--;
 				break;
@@ -28,6 +28,12 @@ uint32_t _gen_rotl(uint32_t value, uint32_t pos );
 
 uint32_t _gen_rotr(uint32_t value, uint32_t pos );
 
+uint32_t do_pscanb(uint8_t *pkt, uint32_t offset, uint8_t value, uint32_t p_len);
+
+uint32_t do_pscanw(uint8_t *pkt, uint32_t offset, uint16_t value, uint32_t p_len);
+
+uint32_t do_pscandw(uint8_t *pkt, uint32_t offset, uint32_t value, uint32_t p_len);
+
 //#endif
 
 
@@ -0,0 +1,342 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file generic_switch.c
+ * \brief This file contains the lowering of the SWITCH instruction used by the interpreters.
+ */
+
+#include "generic_switch.h"
+#include "generic_runtime.h"
+#include "../../opcodes.h"
+#include "codetable.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+//! Case of a switch, used while the table is built
+typedef struct _genSwitchCase
+{
+	uint32_t Key;
+	uint32_t Target;
+	uint32_t Order;		//!< Position of the case in the bytecode
+} genSwitchCase;
+
+
+static int CompareCases(const void *a, const void *b)
+{
+const genSwitchCase *x= (const genSwitchCase *) a;
+const genSwitchCase *y= (const genSwitchCase *) b;
+
+	if (x->Key != y->Key)
+		return (x->Key < y->Key) ? -1 : 1;
+	return (x->Order < y->Order) ? -1 : ((x->Order > y->Order) ? 1 : 0);
+}
+
+
+/*
+	Looks for a multiplier that maps each key to a different bucket. 'Used' must have 'Size' elements.
+	It returns nvmSUCCESS and sets 'Multiplier' if it finds one.
+*/
+static int32_t FindPerfectHash(genSwitchCase *Cases, uint32_t NCases, uint32_t Bits, uint8_t *Used, uint32_t *Multiplier)
+{
+uint32_t Try, i;
+uint32_t Mult= 0x9E3779B1;		// 2^32 divided by the golden ratio
+
+	for (Try= 0; Try < GEN_SWITCH_HASH_TRIES; Try++)
+	{
+		memset(Used, 0, 1 << Bits);
+		for (i= 0; i < NCases; i++)
+		{
+		uint32_t Bucket= (Cases[i].Key * Mult) >> (32 - Bits);
+
+			if (Used[Bucket])
+				break;
+			Used[Bucket]= 1;
+		}
+
+		if (i == NCases)
+		{
+			*Multiplier= Mult;
+			return nvmSUCCESS;
+		}
+
+		// Next candidate: multipliers must be odd
+		Mult= (Mult * 0x2C1B3C6D + 0x297A2D39) | 1;
+	}
+
+	return nvmFAILURE;
+}
+
+
+int32_t genRT_BuildSwitchTable(genSwitchTable *Table, uint32_t NPairs, uint32_t *Keys, uint32_t *Targets, uint32_t Default, nvmRuntimeEnvironment *RTEnv)
+{
+genSwitchCase *Cases;
+uint32_t NCases, i;
+uint64_t Range;
+char errbuf[nvmERRBUF_SIZE];
+int32_t RetVal= nvmFAILURE;
+
+	memset(Table, 0, sizeof(genSwitchTable));
+	Table->Default= Default;
+
+	// A switch without cases is an empty jump table
+	if (NPairs == 0)
+		return nvmSUCCESS;
+
+	Cases= (genSwitchCase *) malloc(NPairs * sizeof(genSwitchCase));
+	if (Cases == NULL)
+		return nvmFAILURE;
+
+	for (i= 0; i < NPairs; i++)
+	{
+		Cases[i].Key= Keys[i];
+		Cases[i].Target= Targets[i];
+		Cases[i].Order= i;
+	}
+
+	// Sort the cases and keep only the first one for each key
+	qsort(Cases, NPairs, sizeof(genSwitchCase), CompareCases);
+	NCases= 1;
+	for (i= 1; i < NPairs; i++)
+	{
+		if (Cases[i].Key != Cases[NCases - 1].Key)
+			Cases[NCases++]= Cases[i];
+	}
+
+	Range= (uint64_t) Cases[NCases - 1].Key - Cases[0].Key + 1;
+
+	if ((Range <= GEN_SWITCH_TABLE_MAX_SIZE) && (NCases * 100 >= Range * GEN_SWITCH_TABLE_MIN_DENSITY))
+	{
+		// Dense keys: jump table; the holes go to the default target
+		Table->Kind= GEN_SWITCH_TABLE;
+		Table->Size= (uint32_t) Range;
+		Table->Min= Cases[0].Key;
+		Table->Targets= (uint32_t *) genRT_AllocRTObject(RTEnv, Table->Size * sizeof(uint32_t), errbuf);
+		if (Table->Targets == NULL)
+			goto Cleanup;
+
+		for (i= 0; i < Table->Size; i++)
+			Table->Targets[i]= Default;
+		for (i= 0; i < NCases; i++)
+			Table->Targets[Cases[i].Key - Table->Min]= Cases[i].Target;
+
+		RetVal= nvmSUCCESS;
+		goto Cleanup;
+	}
+
+	if (NCases > GEN_SWITCH_SEARCH_MAX_CASES)
+	{
+	uint32_t Bits, MaxBits;
+	uint8_t *Used;
+
+		// Sparse keys: try with a perfect hash in a table at least twice as big as the number of keys
+		for (Bits= 1; (1U << Bits) < 2 * NCases; Bits++)
+			;
+		MaxBits= Bits + 2;
+
+		Used= (uint8_t *) malloc(1 << MaxBits);
+		if (Used == NULL)
+			goto Cleanup;
+
+		for ( ; Bits <= MaxBits; Bits++)
+		{
+			if (FindPerfectHash(Cases, NCases, Bits, Used, &Table->Multiplier) == nvmSUCCESS)
+				break;
+		}
+		free(Used);
+
+		if (Bits <= MaxBits)
+		{
+			Table->Kind= GEN_SWITCH_HASH;
+			Table->Size= 1 << Bits;
+			Table->Shift= 32 - Bits;
+			Table->Keys= (uint32_t *) genRT_AllocRTObject(RTEnv, Table->Size * sizeof(uint32_t), errbuf);
+			Table->Targets= (uint32_t *) genRT_AllocRTObject(RTEnv, Table->Size * sizeof(uint32_t), errbuf);
+			if ((Table->Keys == NULL) || (Table->Targets == NULL))
+				goto Cleanup;
+
+			// Empty buckets go to the default target whatever their key is
+			for (i= 0; i < Table->Size; i++)
+				Table->Targets[i]= Default;
+			for (i= 0; i < NCases; i++)
+			{
+			uint32_t Bucket= (Cases[i].Key * Table->Multiplier) >> Table->Shift;
+
+				Table->Keys[Bucket]= Cases[i].Key;
+				Table->Targets[Bucket]= Cases[i].Target;
+			}
+
+			RetVal= nvmSUCCESS;
+			goto Cleanup;
+		}
+	}
+
+	// Few cases, or no perfect hash found: binary search on the sorted keys
+	Table->Kind= GEN_SWITCH_SEARCH;
+	Table->Size= NCases;
+	Table->Keys= (uint32_t *) genRT_AllocRTObject(RTEnv, NCases * sizeof(uint32_t), errbuf);
+	Table->Targets= (uint32_t *) genRT_AllocRTObject(RTEnv, NCases * sizeof(uint32_t), errbuf);
+	if ((Table->Keys == NULL) || (Table->Targets == NULL))
+		goto Cleanup;
+
+	for (i= 0; i < NCases; i++)
+	{
+		Table->Keys[i]= Cases[i].Key;
+		Table->Targets[i]= Cases[i].Target;
+	}
+	RetVal= nvmSUCCESS;
+
+Cleanup:
+	free(Cases);
+	return RetVal;
+}
+
+
+uint32_t genRT_SwitchLookup(genSwitchTable *Table, uint32_t Value)
+{
+	switch (Table->Kind)
+	{
+		case GEN_SWITCH_TABLE:
+		{
+		uint32_t Index= Value - Table->Min;
+
+			// Values below Min wrap around and are caught by the same check
+			if (Index < Table->Size)
+				return Table->Targets[Index];
+			return Table->Default;
+		}
+
+		case GEN_SWITCH_HASH:
+		{
+		uint32_t Bucket= (Value * Table->Multiplier) >> Table->Shift;
+
+			if (Table->Keys[Bucket] == Value)
+				return Table->Targets[Bucket];
+			return Table->Default;
+		}
+
+		default:
+		{
+		uint32_t Low= 0, High= Table->Size;
+
+			while (Low < High)
+			{
+			uint32_t Middle= Low + (High - Low) / 2;
+
+				if (Table->Keys[Middle] < Value)
+					Low= Middle + 1;
+				else
+					High= Middle;
+			}
+
+			if ((Low < Table->Size) && (Table->Keys[Low] == Value))
+				return Table->Targets[Low];
+			return Table->Default;
+		}
+	}
+}
+
+
+genSwitchSet *genRT_LowerSwitches(nvmHandlerState *HandlerState)
+{
+uint8_t *ByteCode= HandlerState->Handler->ByteCode;
+uint32_t CodeSize= HandlerState->Handler->CodeSize;
+nvmRuntimeEnvironment *RTEnv= HandlerState->PEState->RTEnv;
+genSwitchSet *Switches;
+uint32_t Offset, Length, NSwitches= 0;
+uint32_t *Keys= NULL, *Targets= NULL;
+char errbuf[nvmERRBUF_SIZE];
+
+	if (!OpcodeTableInited)
+		nvmInitOpcodeTable();
+
+	Switches= (genSwitchSet *) genRT_AllocRTObject(RTEnv, sizeof(genSwitchSet), errbuf);
+	if (Switches == NULL)
+		return NULL;
+
+	// First pass: count the switches and check that their cases are within the bytecode
+	for (Offset= 0; Offset < CodeSize; Offset+= Length)
+	{
+		if (ByteCode[Offset] == SWITCH)
+		{
+			if ((CodeSize - Offset < 9) || (*(uint32_t *) &ByteCode[Offset + 5] > (CodeSize - Offset - 9) / 8))
+				return NULL;
+			NSwitches++;
+		}
+		Length= GetInstructionLen(&ByteCode[Offset]);
+	}
+
+	Switches->NSwitches= 0;
+	if (NSwitches == 0)
+		return Switches;
+
+	Switches->Offsets= (uint32_t *) genRT_AllocRTObject(RTEnv, NSwitches * sizeof(uint32_t), errbuf);
+	Switches->Tables= (genSwitchTable *) genRT_AllocRTObject(RTEnv, NSwitches * sizeof(genSwitchTable), errbuf);
+	if ((Switches->Offsets == NULL) || (Switches->Tables == NULL))
+		return NULL;
+
+	// Second pass: lower each switch; targets are relative to the next instruction
+	for (Offset= 0; Offset < CodeSize; Offset+= Length)
+	{
+		Length= GetInstructionLen(&ByteCode[Offset]);
+
+		if (ByteCode[Offset] == SWITCH)
+		{
+		uint32_t NPairs= *(uint32_t *) &ByteCode[Offset + 5];
+		uint32_t NextInsn= Offset + Length;
+		uint32_t i;
+
+			Keys= (uint32_t *) malloc((NPairs + 1) * sizeof(uint32_t));
+			Targets= (uint32_t *) malloc((NPairs + 1) * sizeof(uint32_t));
+			if ((Keys == NULL) || (Targets == NULL))
+				goto Fail;
+
+			for (i= 0; i < NPairs; i++)
+			{
+				Keys[i]= *(uint32_t *) &ByteCode[Offset + 9 + i * 8];
+				Targets[i]= NextInsn + *(uint32_t *) &ByteCode[Offset + 13 + i * 8];
+			}
+
+			if (genRT_BuildSwitchTable(&Switches->Tables[Switches->NSwitches], NPairs, Keys, Targets,
+				NextInsn + *(uint32_t *) &ByteCode[Offset + 1], RTEnv) != nvmSUCCESS)
+				goto Fail;
+
+			Switches->Offsets[Switches->NSwitches++]= Offset;
+			free(Keys);
+			free(Targets);
+			Keys= Targets= NULL;
+		}
+	}
+
+	return Switches;
+
+Fail:
+	free(Keys);
+	free(Targets);
+	return NULL;
+}
+
+
+genSwitchTable *genRT_FindSwitch(genSwitchSet *Switches, uint32_t Offset)
+{
+uint32_t Low= 0, High= Switches->NSwitches;
+
+	// Offsets are sorted, since the bytecode is scanned from the beginning
+	while (Low < High)
+	{
+	uint32_t Middle= Low + (High - Low) / 2;
+
+		if (Switches->Offsets[Middle] < Offset)
+			Low= Middle + 1;
+		else
+			High= Middle;
+	}
+
+	if ((Low < Switches->NSwitches) && (Switches->Offsets[Low] == Offset))
+		return &Switches->Tables[Low];
+	return NULL;
+}
@@ -0,0 +1,116 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+/** @file generic_switch.h
+ *	\brief This file contains the lowering of the SWITCH instruction used by the interpreters.
+ *
+ *	The cases of each SWITCH are turned, before the code is executed, into the cheapest lookup
+ *	structure for their keys: a jump table indexed by the key when the keys are dense, a perfect
+ *	hash (one multiplication, one shift and one comparison) when they are sparse, or a sorted
+ *	array searched with a binary search when no perfect hash can be found quickly.
+ */
+
+#ifndef __GENERIC_SWITCH_H__
+#define __GENERIC_SWITCH_H__
+
+#include <nbnetvm.h>
+#include <rt_environment.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Minimum density of the keys (in percent of the range they cover) for using a jump table
+#define GEN_SWITCH_TABLE_MIN_DENSITY 40
+
+//! Maximum number of entries of a jump table
+#define GEN_SWITCH_TABLE_MAX_SIZE 4096
+
+//! Switches with at most this number of cases are looked up with a binary search
+#define GEN_SWITCH_SEARCH_MAX_CASES 4
+
+//! Number of multipliers that are tried before giving up with the perfect hash
+#define GEN_SWITCH_HASH_TRIES 64
+
+
+//! Lookup structures used for the cases of a switch
+enum genSwitchKinds
+{
+	GEN_SWITCH_TABLE,		//!< Jump table indexed by (key - Min)
+	GEN_SWITCH_SEARCH,		//!< Keys sorted in ascending order
+	GEN_SWITCH_HASH			//!< Perfect hash of the keys: bucket = (key * Multiplier) >> Shift
+};
+
+
+//! Cases of a switch, lowered into a lookup structure
+typedef struct _genSwitchTable
+{
+	uint32_t Kind;			//!< Lookup structure (one element of the \ref genSwitchKinds enumeration)
+	uint32_t Default;		//!< Target taken when no case matches
+	uint32_t Size;			//!< Number of entries of Keys and Targets
+	uint32_t Min;			//!< Key of the first entry of the jump table
+	uint32_t Multiplier;	//!< Multiplier of the perfect hash
+	uint32_t Shift;			//!< Shift of the perfect hash
+	uint32_t *Keys;			//!< Key of each entry (not used by jump tables)
+	uint32_t *Targets;		//!< Target of each entry
+} genSwitchTable;
+
+
+//! Switches of a handler, sorted by their position in the bytecode
+typedef struct _genSwitchSet
+{
+	uint32_t NSwitches;		//!< Number of switches
+	uint32_t *Offsets;		//!< Offset of each SWITCH instruction in the bytecode
+	genSwitchTable *Tables;	//!< Cases of each switch
+} genSwitchSet;
+
+
+/*!
+	\brief Lowers the cases of a switch into a lookup structure.
+
+	Targets are opaque values (e.g. bytecode offsets or indexes of instructions); when
+	the same key appears more than once, the first case wins, as in the bytecode.
+
+	\param Table Table to be filled in.
+	\param NPairs Number of cases.
+	\param Keys Key of each case.
+	\param Targets Target of each case.
+	\param Default Target taken when no case matches.
+	\param RTEnv Runtime environment the table is allocated in.
+
+	\return nvmSUCCESS or nvmFAILURE if the memory cannot be allocated.
+*/
+int32_t genRT_BuildSwitchTable(genSwitchTable *Table, uint32_t NPairs, uint32_t *Keys, uint32_t *Targets, uint32_t Default, nvmRuntimeEnvironment *RTEnv);
+
+
+/*!
+	\brief Returns the target corresponding to a value in a lowered switch.
+*/
+uint32_t genRT_SwitchLookup(genSwitchTable *Table, uint32_t Value);
+
+
+/*!
+	\brief Lowers all the switches of the bytecode of a handler; targets are bytecode offsets.
+
+	\return The switches of the handler, or NULL if the memory cannot be allocated
+	or the bytecode is malformed.
+*/
+genSwitchSet *genRT_LowerSwitches(nvmHandlerState *HandlerState);
+
+
+/*!
+	\brief Returns the lowered switch at the given offset of the bytecode, or NULL.
+*/
+genSwitchTable *genRT_FindSwitch(genSwitchSet *Switches, uint32_t Offset);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif		//__GENERIC_SWITCH_H__
@@ -0,0 +1,1477 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+
+
+/** @file generic_threaded.c
+ * \brief This file contains the translation of the bytecode into threaded code and the interpreter of the threaded code.
+ *
+ * The bytecode interpreter (genRT_Execute_Handlers()) decodes each instruction every time it is executed.
+ * Push handlers are instead translated once into an array of pre-decoded instructions, which are executed
+ * jumping directly from the code of an instruction to the code of the next one (through the address stored
+ * in the instruction itself, when the compiler supports it). The translation verifies the depth of the stack
+ * and the branch targets statically, so they are not checked at run time, and fuses the most common sequences
+ * generated by the NetPFL compiler into superinstructions.
+ */
+
+#include "generic_threaded.h"
+#include "generic_switch.h"
+#include "generic_runtime.h"
+#include "../../opcodes.h"
+#include "../../../nbee/globals/debug.h"
+#include <stdlib.h>
+#include <string.h>
+#include "arch.h"
+
+
+#ifdef GEN_THREADED_INTERPRETER
+
+
+/*
+	Comparisons of the conditional branches: the branch is taken if 'second OP top', where 'top' is
+	the value on the top of the stack and 'second' is the one below it.
+*/
+#define TH_COMPARISONS \
+	TH_CMP(EQ,	uint32_t,	==)		\
+	TH_CMP(NEQ,	uint32_t,	!=)		\
+	TH_CMP(G,	uint32_t,	>)		\
+	TH_CMP(G_S,	int32_t,	>)		\
+	TH_CMP(GE,	uint32_t,	>=)		\
+	TH_CMP(GE_S,	int32_t,	>=)		\
+	TH_CMP(L,	uint32_t,	<)		\
+	TH_CMP(L_S,	int32_t,	<)		\
+	TH_CMP(LE,	uint32_t,	<=)		\
+	TH_CMP(LE_S,	int32_t,	<=)
+
+//! Packet loads that can be fused with other instructions
+#define TH_PACKET_LOADS \
+	TH_PLOAD(8)		\
+	TH_PLOAD(16)	\
+	TH_PLOAD(32)
+
+
+/*
+	Instructions of the threaded code. Most of them correspond to a single NetIL instruction;
+	the ones in the second part are superinstructions.
+*/
+#define TH_BASE_OPCODES \
+	TH_OPCODE(PUSH)		TH_OPCODE(POP)		TH_OPCODE(POP_I)	TH_OPCODE(DUP)		\
+	TH_OPCODE(SWAP)		TH_OPCODE(IESWAP)	TH_OPCODE(PBL)		TH_OPCODE(NOP)		\
+	TH_OPCODE(PBLDS)	TH_OPCODE(PBLDU)	TH_OPCODE(PSLDS)	TH_OPCODE(PSLDU)	\
+	TH_OPCODE(PILD)		TH_OPCODE(BPLOAD_IH)										\
+	TH_OPCODE(DBLDS)	TH_OPCODE(DBLDU)	TH_OPCODE(DSLDS)	TH_OPCODE(DSLDU)	\
+	TH_OPCODE(DILD)																	\
+	TH_OPCODE(ISBLD)	TH_OPCODE(ISSLD)	TH_OPCODE(ISSBLD)	TH_OPCODE(ISSSLD)	\
+	TH_OPCODE(ISSILD)																\
+	TH_OPCODE(DBSTR)	TH_OPCODE(DSSTR)	TH_OPCODE(DISTR)							\
+	TH_OPCODE(PBSTR)	TH_OPCODE(PSSTR)	TH_OPCODE(PISTR)							\
+	TH_OPCODE(IBSTR)	TH_OPCODE(ISSTR)	TH_OPCODE(IISTR)							\
+	TH_OPCODE(SHL)		TH_OPCODE(SHR)		TH_OPCODE(USHR)		TH_OPCODE(ROTL)		\
+	TH_OPCODE(ROTR)		TH_OPCODE(OR)		TH_OPCODE(AND)		TH_OPCODE(XOR)		\
+	TH_OPCODE(NOT)		TH_OPCODE(ADD)		TH_OPCODE(SUB)		TH_OPCODE(MOD)		\
+	TH_OPCODE(NEG)		TH_OPCODE(IMUL)		TH_OPCODE(IINC)		TH_OPCODE(IDEC)		\
+	TH_OPCODE(CMP)		TH_OPCODE(CMP_S)	TH_OPCODE(MCMP)								\
+	TH_OPCODE(PSCANB)	TH_OPCODE(PSCANW)	TH_OPCODE(PSCANDW)							\
+	TH_OPCODE(JEQ)		TH_OPCODE(JNE)		TH_OPCODE(JUMP)		TH_OPCODE(SWITCH)	\
+	TH_OPCODE(JFLDEQ)	TH_OPCODE(JFLDNEQ)	TH_OPCODE(JFLDLT)	TH_OPCODE(JFLDGT)	\
+	TH_OPCODE(RET)		TH_OPCODE(SNDPKT)	TH_OPCODE(DSNDPKT)	TH_OPCODE(END)		\
+	TH_OPCODE(LOCLD)	TH_OPCODE(LOCST)	TH_OPCODE(INFOCLR)							\
+	TH_OPCODE(COPIN)	TH_OPCODE(COPOUT)	TH_OPCODE(COPRUN)	TH_OPCODE(COPPKTOUT)	\
+	TH_OPCODE(LOCMOV)	TH_OPCODE(LOCSET)	TH_OPCODE(LOCADDI)
+
+// All the instructions; TH_OPCODE() must be defined before using it
+#define TH_ALL_OPCODES \
+	TH_BASE_OPCODES		\
+	TH_COMPARISONS		\
+	TH_PACKET_LOADS
+
+#define TH_CMP(Name, Type, Op)	TH_OPCODE(JCMP##Name) TH_OPCODE(JCMPI##Name) TH_OPCODE(LOCJCMPI##Name) TH_OPCODE(PBLJCMP##Name)
+#define TH_PLOAD(Size)			TH_OPCODE(PUSHPLOAD##Size) TH_OPCODE(LOCPLOADST##Size) TH_OPCODE(PLOADJCMPIEQ##Size) TH_OPCODE(PLOADJCMPINEQ##Size)
+#define TH_OPCODE(Name)			TH_##Name,
+
+enum
+{
+	TH_ALL_OPCODES
+	TH_NUM_OPCODES
+};
+
+#undef TH_OPCODE
+#undef TH_PLOAD
+#undef TH_CMP
+
+
+//! Flags of a decoded NetIL instruction
+#define DEC_NOFALLTHROUGH	0x01	//!< The execution never continues with the next instruction
+#define DEC_BRANCH			0x02	//!< The instruction has a branch target ('Target')
+#define DEC_SWITCH			0x04	//!< The instruction has the targets of a switch
+
+
+//! NetIL instruction decoded by the first pass of the translation
+typedef struct _genDecodedInsn
+{
+	uint32_t Offset;		//!< Offset of the instruction in the bytecode
+	uint32_t Op;			//!< Instruction of the threaded code it is translated to
+	uint32_t Arg1;			//!< Immediates
+	uint32_t Arg2;
+	int64_t Target;			//!< Offset of the branch target in the bytecode
+	uint32_t Need;			//!< Number of values the instruction takes from the stack
+	int32_t Delta;			//!< Change of the stack depth
+	uint32_t Flags;			//!< DEC_xxx
+	int32_t Depth;			//!< Depth of the stack before the instruction (-1 if it is never reached)
+	int32_t IsTarget;		//!< Set if some branch jumps to the instruction
+	int32_t Emitted;		//!< Index of the threaded instruction starting with this one
+} genDecodedInsn;
+
+
+//! Switch decoded by the first pass of the translation
+typedef struct _genDecodedSwitch
+{
+	uint32_t NPairs;
+	uint32_t *Keys;
+	int64_t *Targets;		//!< Offsets of the targets in the bytecode
+	int64_t Default;
+} genDecodedSwitch;
+
+
+//! Label of each instruction, filled in by genRT_Execute_Threaded() when it is called with a NULL code
+static const void **ThreadedLabels;
+
+
+static uint32_t ReadU32(uint8_t *ByteCode, uint32_t Offset)
+{
+	return *(uint32_t *) &ByteCode[Offset];
+}
+
+
+/*
+	Decodes the instruction at the given offset. It returns the length of the instruction, or
+	0 if it cannot be translated into threaded code.
+*/
+static uint32_t DecodeInsn(nvmHandlerState *HandlerState, uint8_t *ByteCode, uint32_t CodeSize, uint32_t Offset,
+	genDecodedInsn *Insn, genDecodedSwitch *Switch)
+{
+uint32_t Length= 1;
+uint32_t i;
+tmp_nvmPEState *PEState= HandlerState->PEState;
+
+	memset(Insn, 0, sizeof(genDecodedInsn));
+	Insn->Offset= Offset;
+	Insn->Depth= -1;
+	Insn->Emitted= -1;
+
+	// Arguments are read only if they are within the bytecode
+#define NEED_BYTES(n) if (Offset + 1 + (n) > CodeSize) return 0;
+#define SIMPLE(Th, N, D) Insn->Op= TH_##Th; Insn->Need= N; Insn->Delta= D; break;
+#define BRANCH(Th, N, D) NEED_BYTES(4); Length= 5; Insn->Op= TH_##Th; Insn->Need= N; Insn->Delta= D; \
+	Insn->Flags= DEC_BRANCH; Insn->Target= (int64_t) Offset + 5 + (int32_t) ReadU32(ByteCode, Offset + 1); break;
+
+	switch (ByteCode[Offset])
+	{
+		case PUSH:
+			NEED_BYTES(4);
+			Length= 5;
+			Insn->Op= TH_PUSH;
+			Insn->Arg1= ReadU32(ByteCode, Offset + 1);
+			Insn->Delta= 1;
+			break;
+
+		case CONST_0:	Insn->Op= TH_PUSH; Insn->Arg1= 0; Insn->Delta= 1; break;
+		case CONST_1:	Insn->Op= TH_PUSH; Insn->Arg1= 1; Insn->Delta= 1; break;
+		case CONST_2:	Insn->Op= TH_PUSH; Insn->Arg1= 2; Insn->Delta= 1; break;
+		case CONST__1:	Insn->Op= TH_PUSH; Insn->Arg1= (uint32_t) (-1); Insn->Delta= 1; break;
+
+		case POP_I:
+			NEED_BYTES(1);
+			Length= 2;
+			Insn->Op= TH_POP_I;
+			Insn->Arg1= ByteCode[Offset + 1];
+			Insn->Need= Insn->Arg1;
+			Insn->Delta= -(int32_t) Insn->Arg1;
+			break;
+
+		case POP:		SIMPLE(POP, 1, -1)
+		case DUP:		SIMPLE(DUP, 1, 1)
+		case SWAP:		SIMPLE(SWAP, 2, 0)
+		case IESWAP:	SIMPLE(IESWAP, 1, 0)
+		case PBL:		SIMPLE(PBL, 0, 1)
+		case NOP:		SIMPLE(NOP, 0, 0)
+		case BRKPOINT:	SIMPLE(NOP, 0, 0)
+
+		case PBLDS:		SIMPLE(PBLDS, 1, 0)
+		case PBLDU:		SIMPLE(PBLDU, 1, 0)
+		case PSLDS:		SIMPLE(PSLDS, 1, 0)
+		case PSLDU:		SIMPLE(PSLDU, 1, 0)
+		case PILD:		SIMPLE(PILD, 1, 0)
+		case BPLOAD_IH:	SIMPLE(BPLOAD_IH, 1, 0)
+		case DBLDS:		SIMPLE(DBLDS, 1, 0)
+		case DBLDU:		SIMPLE(DBLDU, 1, 0)
+		case DSLDS:		SIMPLE(DSLDS, 1, 0)
+		case DSLDU:		SIMPLE(DSLDU, 1, 0)
+		case DILD:		SIMPLE(DILD, 1, 0)
+		case ISBLD:		SIMPLE(ISBLD, 1, 0)
+		case ISSLD:		SIMPLE(ISSLD, 1, 0)
+		case ISSBLD:	SIMPLE(ISSBLD, 1, 0)
+		case ISSSLD:	SIMPLE(ISSSLD, 1, 0)
+		case ISSILD:	SIMPLE(ISSILD, 1, 0)
+		case DBSTR:		SIMPLE(DBSTR, 2, -2)
+		case DSSTR:		SIMPLE(DSSTR, 2, -2)
+		case DISTR:		SIMPLE(DISTR, 2, -2)
+		case PBSTR:		SIMPLE(PBSTR, 2, -2)
+		case PSSTR:		SIMPLE(PSSTR, 2, -2)
+		case PISTR:		SIMPLE(PISTR, 2, -2)
+		case IBSTR:		SIMPLE(IBSTR, 2, -2)
+		case ISSTR:		SIMPLE(ISSTR, 2, -2)
+		case IISTR:		SIMPLE(IISTR, 2, -2)
+
+		case SHL:		SIMPLE(SHL, 2, -1)
+		case SHR:		SIMPLE(SHR, 2, -1)
+		case USHR:		SIMPLE(USHR, 2, -1)
+		case ROTL:		SIMPLE(ROTL, 2, -1)
+		case ROTR:		SIMPLE(ROTR, 2, -1)
+		case OR:		SIMPLE(OR, 2, -1)
+		case AND:		SIMPLE(AND, 2, -1)
+		case XOR:		SIMPLE(XOR, 2, -1)
+		case NOT:		SIMPLE(NOT, 1, 0)
+		// The overflow flag is not visible to NetIL programs, so these are plain additions, subtractions and multiplications
+		case ADD:
+		case ADDSOV:
+		case ADDUOV:	SIMPLE(ADD, 2, -1)
+		case SUB:
+		case SUBSOV:
+		case SUBUOV:	SIMPLE(SUB, 2, -1)
+		case IMUL:
+		case IMULSOV:	SIMPLE(IMUL, 2, -1)
+		case MOD:		SIMPLE(MOD, 2, -1)
+		case NEG:		SIMPLE(NEG, 1, 0)
+		case IINC_1:	Insn->Arg1= 1; SIMPLE(IINC, 1, 0)
+		case IINC_2:	Insn->Arg1= 2; SIMPLE(IINC, 2, 0)
+		case IINC_3:	Insn->Arg1= 3; SIMPLE(IINC, 3, 0)
+		case IINC_4:	Insn->Arg1= 4; SIMPLE(IINC, 4, 0)
+		case IDEC_1:	Insn->Arg1= 1; SIMPLE(IDEC, 1, 0)
+		case IDEC_2:	Insn->Arg1= 2; SIMPLE(IDEC, 2, 0)
+		case IDEC_3:	Insn->Arg1= 3; SIMPLE(IDEC, 3, 0)
+		case IDEC_4:	Insn->Arg1= 4; SIMPLE(IDEC, 4, 0)
+		case CMP:		SIMPLE(CMP, 2, -1)
+		case CMP_S:		SIMPLE(CMP_S, 2, -1)
+		case MCMP:		SIMPLE(MCMP, 3, -2)
+		case PSCANB:	SIMPLE(PSCANB, 2, -1)
+		case PSCANW:	SIMPLE(PSCANW, 2, -1)
+		case PSCANDW:	SIMPLE(PSCANDW, 2, -1)
+		case INFOCLR:	SIMPLE(INFOCLR, 0, 0)
+
+		case JCMPEQ:	BRANCH(JCMPEQ, 2, -2)
+		case JCMPNEQ:	BRANCH(JCMPNEQ, 2, -2)
+		case JCMPG:		BRANCH(JCMPG, 2, -2)
+		case JCMPG_S:	BRANCH(JCMPG_S, 2, -2)
+		case JCMPGE:	BRANCH(JCMPGE, 2, -2)
+		case JCMPGE_S:	BRANCH(JCMPGE_S, 2, -2)
+		case JCMPL:		BRANCH(JCMPL, 2, -2)
+		case JCMPL_S:	BRANCH(JCMPL_S, 2, -2)
+		case JCMPLE:	BRANCH(JCMPLE, 2, -2)
+		case JCMPLE_S:	BRANCH(JCMPLE_S, 2, -2)
+		case JEQ:		BRANCH(JEQ, 1, -1)
+		case JNE:		BRANCH(JNE, 1, -1)
+		case JFLDEQ:	BRANCH(JFLDEQ, 3, -3)
+		case JFLDNEQ:	BRANCH(JFLDNEQ, 3, -3)
+		case JFLDLT:	BRANCH(JFLDLT, 3, -3)
+		case JFLDGT:	BRANCH(JFLDGT, 3, -3)
+
+		case JUMP:
+			// The displacement of the short jump is unsigned, as in the bytecode interpreter
+			NEED_BYTES(1);
+			Length= 2;
+			Insn->Op= TH_JUMP;
+			Insn->Flags= DEC_BRANCH | DEC_NOFALLTHROUGH;
+			Insn->Target= (int64_t) Offset + 2 + ByteCode[Offset + 1];
+			break;
+
+		case JUMPW:
+			NEED_BYTES(4);
+			Length= 5;
+			Insn->Op= TH_JUMP;
+			Insn->Flags= DEC_BRANCH | DEC_NOFALLTHROUGH;
+			Insn->Target= (int64_t) Offset + 5 + (int32_t) ReadU32(ByteCode, Offset + 1);
+			break;
+
+		case SWITCH:
+		{
+		uint32_t NextInsn;
+
+			NEED_BYTES(8);
+			Switch->NPairs= ReadU32(ByteCode, Offset + 5);
+			if (Switch->NPairs > (CodeSize - Offset - 9) / 8)
+				return 0;
+			Length= 9 + Switch->NPairs * 8;
+			NextInsn= Offset + Length;
+
+			Switch->Keys= (uint32_t *) malloc((Switch->NPairs + 1) * sizeof(uint32_t));
+			Switch->Targets= (int64_t *) malloc((Switch->NPairs + 1) * sizeof(int64_t));
+			if ((Switch->Keys == NULL) || (Switch->Targets == NULL))
+				return 0;
+
+			Switch->Default= (int64_t) NextInsn + (int32_t) ReadU32(ByteCode, Offset + 1);
+			for (i= 0; i < Switch->NPairs; i++)
+			{
+				Switch->Keys[i]= ReadU32(ByteCode, Offset + 9 + i * 8);
+				Switch->Targets[i]= (int64_t) NextInsn + (int32_t) ReadU32(ByteCode, Offset + 13 + i * 8);
+			}
+
+			Insn->Op= TH_SWITCH;
+			Insn->Need= 1;
+			Insn->Delta= -1;
+			Insn->Flags= DEC_SWITCH | DEC_NOFALLTHROUGH;
+			break;
+		}
+
+		case RET:
+			Insn->Op= TH_RET;
+			Insn->Flags= DEC_NOFALLTHROUGH;
+			break;
+
+		case SNDPKT:
+			NEED_BYTES(4);
+			Length= 5;
+			Insn->Op= TH_SNDPKT;
+			Insn->Arg1= ReadU32(ByteCode, Offset + 1);
+			Insn->Flags= DEC_NOFALLTHROUGH;
+			break;
+
+		case DSNDPKT:
+			NEED_BYTES(4);
+			Length= 5;
+			Insn->Op= TH_DSNDPKT;
+			Insn->Arg1= ReadU32(ByteCode, Offset + 1);
+			break;
+
+		case LOCLD:
+		case LOCST:
+			NEED_BYTES(4);
+			Length= 5;
+			Insn->Arg1= ReadU32(ByteCode, Offset + 1);
+			if (Insn->Arg1 >= HandlerState->NLocals)
+				return 0;
+			if (ByteCode[Offset] == LOCLD)
+			{
+				Insn->Op= TH_LOCLD;
+				Insn->Delta= 1;
+			}
+			else
+			{
+				Insn->Op= TH_LOCST;
+				Insn->Need= 1;
+				Insn->Delta= -1;
+			}
+			break;
+
+		case COPIN:
+		case COPOUT:
+		case COPRUN:
+		case COPPKTOUT:
+			NEED_BYTES(8);
+			Length= 9;
+			Insn->Arg1= ReadU32(ByteCode, Offset + 1);
+			Insn->Arg2= ReadU32(ByteCode, Offset + 5);
+
+			// Coprocessors are known when the handler is translated, so they are checked only once
+			if (Insn->Arg1 >= PEState->NCoprocRefs)
+				return 0;
+			if (ByteCode[Offset] == COPIN)
+			{
+				if (Insn->Arg2 > PEState->CoprocTable[Insn->Arg1].n_regs)
+					return 0;
+				Insn->Op= TH_COPIN;
+				Insn->Delta= 1;
+			}
+			else if (ByteCode[Offset] == COPOUT)
+			{
+				if (Insn->Arg2 > PEState->CoprocTable[Insn->Arg1].n_regs)
+					return 0;
+				Insn->Op= TH_COPOUT;
+				Insn->Need= 1;
+				Insn->Delta= -1;
+			}
+			else if (ByteCode[Offset] == COPRUN)
+				Insn->Op= TH_COPRUN;
+			else
+				Insn->Op= TH_COPPKTOUT;
+			break;
+
+		default:
+			// Anything else (e.g. shared memory, exchange buffer management, bit manipulation) is left to the bytecode interpreter
+			return 0;
+	}
+
+#undef NEED_BYTES
+#undef SIMPLE
+#undef BRANCH
+
+	if (Offset + Length > CodeSize)
+		return 0;
+
+	return Length;
+}
+
+
+/*
+	Computes the depth of the stack before each instruction, following all the paths of the code.
+	The translation fails if an instruction can be reached with different depths, or it would
+	raise a stack exception in the bytecode interpreter.
+*/
+static int32_t VerifyStack(genDecodedInsn *Insns, uint32_t NInsns, genDecodedSwitch *Switches, int32_t *OffsetToInsn,
+	uint32_t StackSize)
+{
+uint32_t *WorkList;
+uint32_t NWork= 0;
+uint32_t i, j;
+
+	WorkList= (uint32_t *) malloc((NInsns + 1) * sizeof(uint32_t));
+	if (WorkList == NULL)
+		return nvmFAILURE;
+
+	// The push handler starts with the ID of the calling port on the stack
+	Insns[0].Depth= 1;
+	WorkList[NWork++]= 0;
+
+	while (NWork > 0)
+	{
+	genDecodedInsn *Insn;
+	int32_t Depth, NewDepth;
+	int32_t Succ[2];
+	uint32_t NSucc= 0;
+
+		i= WorkList[--NWork];
+		Insn= &Insns[i];
+		Depth= Insn->Depth;
+
+		// Same conditions of NEED_STACK() in the bytecode interpreter
+		if (((Depth > 0) && ((uint32_t) Depth >= StackSize)) || ((uint32_t) Depth < Insn->Need))
+			goto Fail;
+
+		NewDepth= Depth + Insn->Delta;
+		if ((NewDepth < 0) || ((uint32_t) NewDepth > StackSize))
+			goto Fail;
+
+		if (!(Insn->Flags & DEC_NOFALLTHROUGH))
+			Succ[NSucc++]= i + 1;
+		if (Insn->Flags & DEC_BRANCH)
+			Succ[NSucc++]= OffsetToInsn[Insn->Target];
+
+		for (j= 0; j < NSucc; j++)
+		{
+			// The END instruction does not use the stack
+			if ((uint32_t) Succ[j] == NInsns)
+				continue;
+			if (Insns[Succ[j]].Depth == -1)
+			{
+				Insns[Succ[j]].Depth= NewDepth;
+				WorkList[NWork++]= Succ[j];
+			}
+			else if (Insns[Succ[j]].Depth != NewDepth)
+				goto Fail;
+		}
+
+		if (Insn->Flags & DEC_SWITCH)
+		{
+		genDecodedSwitch *Switch= &Switches[Insn->Arg1];
+
+			for (j= 0; j <= Switch->NPairs; j++)
+			{
+			int32_t Target= OffsetToInsn[(j == Switch->NPairs) ? Switch->Default : Switch->Targets[j]];
+
+				if (Insns[Target].Depth == -1)
+				{
+					Insns[Target].Depth= NewDepth;
+					WorkList[NWork++]= Target;
+				}
+				else if (Insns[Target].Depth != NewDepth)
+					goto Fail;
+			}
+		}
+	}
+
+	free(WorkList);
+	return nvmSUCCESS;
+
+Fail:
+	free(WorkList);
+	return nvmFAILURE;
+}
+
+
+//! Returns true if the 'n' instructions starting from 'i' can be fused (i.e. only the first one is a branch target).
+static int CanFuse(genDecodedInsn *Insns, uint32_t NInsns, uint32_t i, uint32_t n)
+{
+uint32_t j;
+
+	if (i + n > NInsns)
+		return 0;
+	for (j= 1; j < n; j++)
+	{
+		if (Insns[i + j].IsTarget)
+			return 0;
+	}
+	return 1;
+}
+
+
+//! Returns the distance between the variants of the conditional branch 'Op' (JCMPxx) and the ones of JCMPEQ, or -1.
+static int32_t GetComparison(uint32_t Op)
+{
+	switch (Op)
+	{
+#define TH_CMP(Name, Type, Operator) case TH_JCMP##Name: return TH_JCMP##Name - TH_JCMPEQ;
+		TH_COMPARISONS
+#undef TH_CMP
+		default:
+			return -1;
+	}
+}
+
+
+//! Returns the size (8, 16 or 32) of an unsigned packet load, or 0 if 'Op' is not one of them.
+static uint32_t GetPacketLoadSize(uint32_t Op)
+{
+	switch (Op)
+	{
+		case TH_PBLDU: return 8;
+		case TH_PSLDU: return 16;
+		case TH_PILD: return 32;
+		default: return 0;
+	}
+}
+
+
+/*
+	Fuses the instructions starting at 'i' into a superinstruction, if they match one of the
+	common sequences. It returns the number of NetIL instructions consumed (1 if no sequence matches).
+*/
+static uint32_t EmitInsn(genDecodedInsn *Insns, uint32_t NInsns, uint32_t i, genThreadedInsn *Out, int64_t *OutTarget)
+{
+genDecodedInsn *I= &Insns[i];
+int32_t Cmp;
+uint32_t Size;
+
+	memset(Out, 0, sizeof(genThreadedInsn));
+	Out->Op= I->Op;
+	Out->Arg1= I->Arg1;
+	Out->Arg2= I->Arg2;
+	*OutTarget= (I->Flags & DEC_BRANCH) ? I->Target : -1;
+
+	// The variants of a superinstruction for different comparisons (or sizes) are at a fixed distance from each other
+#define CMP_VARIANT(Base, Distance) ((Base) + (Distance))
+#define SIZE_VARIANT(Base, Size) ((Base) + ((Size) == 8 ? 0 : ((Size) == 16 ? 1 : 2)) * (TH_PUSHPLOAD16 - TH_PUSHPLOAD8))
+
+	if (I->Op == TH_PUSH)
+	{
+		// push off; upload.N; push value; jcmpeq/jcmpneq
+		if (CanFuse(Insns, NInsns, i, 4) && ((Size= GetPacketLoadSize(Insns[i + 1].Op)) != 0) && (Insns[i + 2].Op == TH_PUSH) &&
+			((Insns[i + 3].Op == TH_JCMPEQ) || (Insns[i + 3].Op == TH_JCMPNEQ)))
+		{
+			Out->Op= SIZE_VARIANT((Insns[i + 3].Op == TH_JCMPEQ) ? TH_PLOADJCMPIEQ8 : TH_PLOADJCMPINEQ8, Size);
+			Out->Arg2= Insns[i + 2].Arg1;
+			*OutTarget= Insns[i + 3].Target;
+			return 4;
+		}
+
+		// push off; upload.N
+		if (CanFuse(Insns, NInsns, i, 2) && ((Size= GetPacketLoadSize(Insns[i + 1].Op)) != 0))
+		{
+			Out->Op= SIZE_VARIANT(TH_PUSHPLOAD8, Size);
+			return 2;
+		}
+
+		// push value; jcmp
+		if (CanFuse(Insns, NInsns, i, 2) && ((Cmp= GetComparison(Insns[i + 1].Op)) >= 0))
+		{
+			Out->Op= CMP_VARIANT(TH_JCMPIEQ, Cmp);
+			*OutTarget= Insns[i + 1].Target;
+			return 2;
+		}
+
+		// push value; locstore n
+		if (CanFuse(Insns, NInsns, i, 2) && (Insns[i + 1].Op == TH_LOCST))
+		{
+			Out->Op= TH_LOCSET;
+			Out->Arg2= Insns[i + 1].Arg1;
+			return 2;
+		}
+	}
+	else if (I->Op == TH_LOCLD)
+	{
+		// locload a; push value; add; locstore b
+		if (CanFuse(Insns, NInsns, i, 4) && (Insns[i + 1].Op == TH_PUSH) && (Insns[i + 2].Op == TH_ADD) && (Insns[i + 3].Op == TH_LOCST))
+		{
+			Out->Op= TH_LOCADDI;
+			Out->Arg2= Insns[i + 1].Arg1;
+			Out->Arg3= Insns[i + 3].Arg1;
+			return 4;
+		}
+
+		// locload a; push value; jcmp
+		if (CanFuse(Insns, NInsns, i, 3) && (Insns[i + 1].Op == TH_PUSH) && ((Cmp= GetComparison(Insns[i + 2].Op)) >= 0))
+		{
+			Out->Op= CMP_VARIANT(TH_LOCJCMPIEQ, Cmp);
+			Out->Arg2= Insns[i + 1].Arg1;
+			*OutTarget= Insns[i + 2].Target;
+			return 3;
+		}
+
+		// locload a; upload.N; locstore b
+		if (CanFuse(Insns, NInsns, i, 3) && ((Size= GetPacketLoadSize(Insns[i + 1].Op)) != 0) && (Insns[i + 2].Op == TH_LOCST))
+		{
+			Out->Op= SIZE_VARIANT(TH_LOCPLOADST8, Size);
+			Out->Arg2= Insns[i + 2].Arg1;
+			return 3;
+		}
+
+		// locload a; locstore b
+		if (CanFuse(Insns, NInsns, i, 2) && (Insns[i + 1].Op == TH_LOCST))
+		{
+			Out->Op= TH_LOCMOV;
+			Out->Arg2= Insns[i + 1].Arg1;
+			return 2;
+		}
+	}
+	else if (I->Op == TH_PBL)
+	{
+		// pbl; jcmp
+		if (CanFuse(Insns, NInsns, i, 2) && ((Cmp= GetComparison(Insns[i + 1].Op)) >= 0))
+		{
+			Out->Op= CMP_VARIANT(TH_PBLJCMPEQ, Cmp);
+			*OutTarget= Insns[i + 1].Target;
+			return 2;
+		}
+	}
+
+#undef CMP_VARIANT
+#undef SIZE_VARIANT
+
+	return 1;
+}
+
+
+static void FreeDecodedSwitches(genDecodedSwitch *Switches, uint32_t NSwitches)
+{
+uint32_t i;
+
+	for (i= 0; i < NSwitches; i++)
+	{
+		free(Switches[i].Keys);
+		free(Switches[i].Targets);
+	}
+	free(Switches);
+}
+
+
+int32_t genRT_TranslateHandler(nvmHandlerState *HandlerState)
+{
+uint8_t *ByteCode= HandlerState->Handler->ByteCode;
+uint32_t CodeSize= HandlerState->Handler->CodeSize;
+genDecodedInsn *Insns= NULL;
+genDecodedSwitch *Switches= NULL;
+int32_t *OffsetToInsn= NULL;
+int64_t *EmittedTargets= NULL;
+genThreadedCode *Code;
+uint32_t NInsns= 0, NSwitches= 0, NEmitted= 0;
+uint32_t Offset, Length, i, j;
+int32_t RetVal= nvmFAILURE;
+char errbuf[nvmERRBUF_SIZE];
+
+	HandlerState->ThreadedCode= NULL;
+
+	if ((HandlerState->Handler->HandlerType != PUSH_HANDLER) || (ByteCode == NULL) || (CodeSize == 0) || (HandlerState->StackSize == 0))
+		return nvmFAILURE;
+
+	if (ThreadedLabels == NULL)
+		genRT_Execute_Threaded(NULL, NULL, NULL, NULL, 0, NULL);
+
+	// Every instruction is at least one byte long: these are upper bounds
+	Insns= (genDecodedInsn *) calloc(CodeSize + 1, sizeof(genDecodedInsn));
+	Switches= (genDecodedSwitch *) calloc(CodeSize, sizeof(genDecodedSwitch));
+	OffsetToInsn= (int32_t *) malloc((CodeSize + 1) * sizeof(int32_t));
+	if ((Insns == NULL) || (Switches == NULL) || (OffsetToInsn == NULL))
+		goto Cleanup;
+
+	for (Offset= 0; Offset <= CodeSize; Offset++)
+		OffsetToInsn[Offset]= -1;
+
+	// First pass: decode all the instructions
+	for (Offset= 0; Offset < CodeSize; Offset+= Length)
+	{
+		Length= DecodeInsn(HandlerState, ByteCode, CodeSize, Offset, &Insns[NInsns], &Switches[NSwitches]);
+		if (Length == 0)
+		{
+			NSwitches++;		// The switch may have been partially allocated
+			goto Cleanup;
+		}
+		if (Insns[NInsns].Flags & DEC_SWITCH)
+			Insns[NInsns].Arg1= NSwitches++;
+		OffsetToInsn[Offset]= NInsns++;
+	}
+
+	// Running past the last instruction ends the handler, as in the bytecode interpreter
+	OffsetToInsn[CodeSize]= NInsns;
+	Insns[NInsns].Op= TH_END;
+	Insns[NInsns].Offset= CodeSize;
+
+	// Branch targets must be instructions within the code
+	for (i= 0; i < NInsns; i++)
+	{
+		if (Insns[i].Flags & DEC_BRANCH)
+		{
+			if ((Insns[i].Target < 0) || (Insns[i].Target >= CodeSize) || (OffsetToInsn[Insns[i].Target] < 0))
+				goto Cleanup;
+			Insns[OffsetToInsn[Insns[i].Target]].IsTarget= 1;
+		}
+		if (Insns[i].Flags & DEC_SWITCH)
+		{
+		genDecodedSwitch *Switch= &Switches[Insns[i].Arg1];
+
+			for (j= 0; j <= Switch->NPairs; j++)
+			{
+			int64_t Target= (j == Switch->NPairs) ? Switch->Default : Switch->Targets[j];
+
+				if ((Target < 0) || (Target >= CodeSize) || (OffsetToInsn[Target] < 0))
+					goto Cleanup;
+				Insns[OffsetToInsn[Target]].IsTarget= 1;
+			}
+		}
+	}
+
+	if (VerifyStack(Insns, NInsns, Switches, OffsetToInsn, HandlerState->StackSize) != nvmSUCCESS)
+		goto Cleanup;
+
+	// Second pass: emit the threaded code, fusing instructions when possible
+	Code= (genThreadedCode *) genRT_AllocRTObject(HandlerState->PEState->RTEnv, sizeof(genThreadedCode), errbuf);
+	if (Code == NULL)
+		goto Cleanup;
+	Code->Insns= (genThreadedInsn *) genRT_AllocRTObject(HandlerState->PEState->RTEnv, (NInsns + 1) * sizeof(genThreadedInsn), errbuf);
+	Code->Switches= (genSwitchTable *) genRT_AllocRTObject(HandlerState->PEState->RTEnv, (NSwitches + 1) * sizeof(genSwitchTable), errbuf);
+	EmittedTargets= (int64_t *) malloc((NInsns + 1) * sizeof(int64_t));
+	if ((Code->Insns == NULL) || (Code->Switches == NULL) || (EmittedTargets == NULL))
+		goto Cleanup;
+
+	for (i= 0; i <= NInsns; )
+	{
+		Insns[i].Emitted= NEmitted;
+		if (i == NInsns)
+		{
+			memset(&Code->Insns[NEmitted], 0, sizeof(genThreadedInsn));
+			Code->Insns[NEmitted].Op= TH_END;
+			EmittedTargets[NEmitted++]= -1;
+			break;
+		}
+		i+= EmitInsn(Insns, NInsns, i, &Code->Insns[NEmitted], &EmittedTargets[NEmitted]);
+		NEmitted++;
+	}
+
+	// Branch targets and switch cases point directly to the threaded instructions
+	for (i= 0; i < NEmitted; i++)
+	{
+	genThreadedInsn *Insn= &Code->Insns[i];
+
+		if (EmittedTargets[i] >= 0)
+			Insn->Target= &Code->Insns[Insns[OffsetToInsn[EmittedTargets[i]]].Emitted];
+
+		if (Insn->Op == TH_SWITCH)
+		{
+		genDecodedSwitch *Decoded= &Switches[Insn->Arg1];
+		uint32_t *CaseTargets= (uint32_t *) malloc((Decoded->NPairs + 1) * sizeof(uint32_t));
+		int32_t Lowered;
+
+			// The cases are lowered like in the bytecode interpreter, but their targets are indexes of threaded instructions
+			if (CaseTargets == NULL)
+				goto Cleanup;
+			for (j= 0; j < Decoded->NPairs; j++)
+				CaseTargets[j]= Insns[OffsetToInsn[Decoded->Targets[j]]].Emitted;
+
+			Lowered= genRT_BuildSwitchTable(&Code->Switches[Insn->Arg1], Decoded->NPairs, Decoded->Keys, CaseTargets,
+				Insns[OffsetToInsn[Decoded->Default]].Emitted, HandlerState->PEState->RTEnv);
+			free(CaseTargets);
+			if (Lowered != nvmSUCCESS)
+				goto Cleanup;
+		}
+
+#ifdef GEN_THREADED_COMPUTED_GOTO
+		Insn->Label= ThreadedLabels[Insn->Op];
+#endif
+	}
+
+	Code->NInsns= NEmitted;
+	Code->NBytecodeInsns= NInsns;
+	HandlerState->ThreadedCode= Code;
+	RetVal= nvmSUCCESS;
+
+Cleanup:
+	// Objects allocated in the runtime environment are released with it, even if the translation fails
+	free(Insns);
+	if (Switches)
+		FreeDecodedSwitches(Switches, NSwitches);
+	free(OffsetToInsn);
+	free(EmittedTargets);
+	return RetVal;
+}
+
+
+//--------------------------------------------------------------------------------------------
+//					THREADED CODE INTERPRETER
+//--------------------------------------------------------------------------------------------
+
+// Overflow-safe bounds check of a memory access of 'b' bytes at offset 'n' of a buffer of 'len' bytes
+#define OUT_OF_BOUNDS(n, b, len) (((b) > (len)) || ((n) > (len) - (b)))
+
+#define PKTMEM_CHECK(n, b) \
+	if (OUT_OF_BOUNDS(n, b, pktlen)) { ErrOffset= (n); ErrSize= (b); goto PacketError; }
+
+#define INFOMEM_CHECK(n, b) \
+	if (OUT_OF_BOUNDS(n, b, infolen)) { ErrOffset= (n); ErrSize= (b); goto InfoError; }
+
+#define DATAMEM_CHECK(n, b) \
+	if (OUT_OF_BOUNDS(n, b, datamemsize)) { ErrOffset= (n); ErrSize= (b); goto DataError; }
+
+// Unsigned packet loads, used by the superinstructions as well
+#define PLOAD8(n)	((uint32_t) xbuffer[n])
+#define PLOAD16(n)	((uint32_t) (nvm_ntohs(*(uint16_t *) &xbuffer[n])))
+#define PLOAD32(n)	((uint32_t) (nvm_ntohl(*(uint32_t *) &xbuffer[n])))
+
+#ifdef GEN_THREADED_COMPUTED_GOTO
+#define TH_CASE(Name)	L_##Name:
+#define NEXT()			goto *ip->Label
+#else
+#define TH_CASE(Name)	case TH_##Name:
+#define NEXT()			goto Dispatch
+#endif
+
+// Executes the next instruction, or jumps to the branch target if the condition holds
+#define BRANCH_IF(Cond) \
+	if (Cond) ip= ip->Target; else ip++; \
+	NEXT();
+
+
+int32_t genRT_Execute_Threaded(genThreadedCode *Code, nvmExchangeBuffer **exbuf, nvmHandlerState *HandlerState,
+	uint32_t *stack, uint32_t sp, uint32_t *locals)
+{
+genThreadedInsn *ip;
+uint32_t *top;
+uint8_t *xbuffer, *xbufinfo, *datamem;
+uint32_t pktlen, infolen, datamemsize;
+uint32_t utemp1, utemp2;
+uint32_t ErrOffset, ErrSize;
+int32_t ret;
+nvmCoprocessorState *CoprocTable;
+
+#ifdef GEN_THREADED_COMPUTED_GOTO
+#define TH_CMP(Name, Type, Op)	TH_OPCODE(JCMP##Name) TH_OPCODE(JCMPI##Name) TH_OPCODE(LOCJCMPI##Name) TH_OPCODE(PBLJCMP##Name)
+#define TH_PLOAD(Size)			TH_OPCODE(PUSHPLOAD##Size) TH_OPCODE(LOCPLOADST##Size) TH_OPCODE(PLOADJCMPIEQ##Size) TH_OPCODE(PLOADJCMPINEQ##Size)
+#define TH_OPCODE(Name)			&&L_##Name,
+
+	static const void *Labels[TH_NUM_OPCODES]=
+	{
+		TH_ALL_OPCODES
+	};
+
+#undef TH_OPCODE
+#undef TH_PLOAD
+#undef TH_CMP
+
+	if (Code == NULL)
+	{
+		ThreadedLabels= Labels;
+		return nvmSUCCESS;
+	}
+#else
+	if (Code == NULL)
+		return nvmSUCCESS;
+#endif
+
+	ip= Code->Insns;
+	top= stack + sp;		// 'top' points to the first free slot of the stack
+
+	xbuffer= (**exbuf).PacketBuffer;
+	xbufinfo= (**exbuf).InfoData;
+	pktlen= (**exbuf).PacketLen;
+	infolen= (**exbuf).InfoLen;
+
+	if (HandlerState->PEState->DataMem)
+	{
+		datamem= HandlerState->PEState->DataMem->Base;
+		datamemsize= HandlerState->PEState->DataMem->Size;
+	}
+	else
+	{
+		datamem= NULL;
+		datamemsize= 0;
+	}
+
+	CoprocTable= HandlerState->PEState->CoprocTable;
+
+#ifdef GEN_THREADED_COMPUTED_GOTO
+	NEXT();
+#else
+Dispatch:
+	switch (ip->Op)
+	{
+#endif
+
+//-------------------------------STACK MANAGEMENT INSTRUCTIONS---------------------------------------------------------
+
+	TH_CASE(PUSH)
+		*top++= ip->Arg1;
+		ip++;
+		NEXT();
+
+	TH_CASE(POP)
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(POP_I)
+		top-= ip->Arg1;
+		ip++;
+		NEXT();
+
+	TH_CASE(DUP)
+		top[0]= top[-1];
+		top++;
+		ip++;
+		NEXT();
+
+	TH_CASE(SWAP)
+		utemp1= top[-1];
+		top[-1]= top[-2];
+		top[-2]= utemp1;
+		ip++;
+		NEXT();
+
+	TH_CASE(IESWAP)
+		top[-1]= nvm_ntohl(top[-1]);
+		ip++;
+		NEXT();
+
+	TH_CASE(PBL)
+		*top++= pktlen;
+		ip++;
+		NEXT();
+
+	TH_CASE(NOP)
+		ip++;
+		NEXT();
+
+//------------------------------- LOAD AND STORE INSTRUCTIONS:----------------------------------
+
+	TH_CASE(PBLDS)
+		PKTMEM_CHECK(top[-1], 1);
+		top[-1]= (int32_t)xbuffer[top[-1]];
+		ip++;
+		NEXT();
+
+	TH_CASE(PBLDU)
+		PKTMEM_CHECK(top[-1], 1);
+		top[-1]= PLOAD8(top[-1]);
+		ip++;
+		NEXT();
+
+	TH_CASE(PSLDS)
+		PKTMEM_CHECK(top[-1], 2);
+		top[-1]= (int32_t)(nvm_ntohs(*(int16_t *)&xbuffer[top[-1]]));
+		ip++;
+		NEXT();
+
+	TH_CASE(PSLDU)
+		PKTMEM_CHECK(top[-1], 2);
+		top[-1]= PLOAD16(top[-1]);
+		ip++;
+		NEXT();
+
+	TH_CASE(PILD)
+		PKTMEM_CHECK(top[-1], 4);
+		top[-1]= PLOAD32(top[-1]);
+		ip++;
+		NEXT();
+
+	TH_CASE(BPLOAD_IH)
+		PKTMEM_CHECK(top[-1], 1);
+		top[-1]= (uint32_t)(((xbuffer[top[-1]]) & 0x0f) << 2);
+		ip++;
+		NEXT();
+
+	TH_CASE(DBLDS)
+		DATAMEM_CHECK(top[-1], 1);
+		top[-1]= (int32_t)datamem[top[-1]];
+		ip++;
+		NEXT();
+
+	TH_CASE(DBLDU)
+		DATAMEM_CHECK(top[-1], 1);
+		top[-1]= (uint32_t)datamem[top[-1]];
+		ip++;
+		NEXT();
+
+	TH_CASE(DSLDS)
+		DATAMEM_CHECK(top[-1], 2);
+		top[-1]= (int32_t)(*(int16_t *)&datamem[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(DSLDU)
+		DATAMEM_CHECK(top[-1], 2);
+		top[-1]= (uint32_t)(*(uint16_t *)&datamem[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(DILD)
+		DATAMEM_CHECK(top[-1], 4);
+		top[-1]= (uint32_t)(*(uint32_t *)&datamem[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(ISBLD)
+		INFOMEM_CHECK(top[-1], 1);
+		top[-1]= (uint32_t)xbufinfo[top[-1]];
+		ip++;
+		NEXT();
+
+	TH_CASE(ISSLD)
+		INFOMEM_CHECK(top[-1], 2);
+		top[-1]= (uint32_t)(*(uint16_t *)&xbufinfo[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(ISSBLD)
+		INFOMEM_CHECK(top[-1], 1);
+		top[-1]= (int32_t)xbufinfo[top[-1]];
+		ip++;
+		NEXT();
+
+	TH_CASE(ISSSLD)
+		INFOMEM_CHECK(top[-1], 2);
+		top[-1]= (int32_t)(*(int16_t *)&xbufinfo[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(ISSILD)
+		INFOMEM_CHECK(top[-1], 4);
+		top[-1]= (uint32_t)(*(int32_t *)&xbufinfo[top[-1]]);
+		ip++;
+		NEXT();
+
+	TH_CASE(DBSTR)
+		DATAMEM_CHECK(top[-1], 1);
+		datamem[top[-1]]= (int8_t) top[-2];
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(DSSTR)
+		DATAMEM_CHECK(top[-1], 2);
+		*(int16_t *)&datamem[top[-1]]= (top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(DISTR)
+		DATAMEM_CHECK(top[-1], 4);
+		*(int32_t *)&datamem[top[-1]]= (top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(PBSTR)
+		PKTMEM_CHECK(top[-1], 1);
+		if (xbuffer != NULL)
+			xbuffer[top[-1]]= (uint8_t) top[-2];
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(PSSTR)
+		PKTMEM_CHECK(top[-1], 2);
+		*(uint16_t *)&xbuffer[top[-1]]= nvm_ntohs(top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(PISTR)
+		PKTMEM_CHECK(top[-1], 4);
+		*(uint32_t *)&xbuffer[top[-1]]= nvm_ntohl(top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(IBSTR)
+		INFOMEM_CHECK(top[-1], 1);
+		xbufinfo[top[-1]]= (uint8_t) top[-2];
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(ISSTR)
+		INFOMEM_CHECK(top[-1], 2);
+		*(int16_t *)&xbufinfo[top[-1]]= (top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+	TH_CASE(IISTR)
+		INFOMEM_CHECK(top[-1], 4);
+		*(int32_t *)&xbufinfo[top[-1]]= (top[-2]);
+		top-= 2;
+		ip++;
+		NEXT();
+
+//------------------------------- ARITHMETIC AND BIT MANIPULATION INSTRUCTIONS -----------------------------
+
+	TH_CASE(SHL)
+		top[-2]= ((int32_t) top[-2]) << top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(SHR)
+		top[-2]= ((int32_t) top[-2]) >> top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(USHR)
+		top[-2]= top[-2] >> top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(ROTL)
+		top[-2]= _gen_rotl(top[-2], top[-1]);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(ROTR)
+		top[-2]= _gen_rotr(top[-2], top[-1]);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(OR)
+		top[-2]|= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(AND)
+		top[-2]&= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(XOR)
+		top[-2]^= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(NOT)
+		top[-1]= ~(top[-1]);
+		ip++;
+		NEXT();
+
+	TH_CASE(ADD)
+		top[-2]+= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(SUB)
+		top[-2]-= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(MOD)
+		top[-2]%= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(NEG)
+		top[-1]= - (int32_t) top[-1];
+		ip++;
+		NEXT();
+
+	TH_CASE(IMUL)
+		top[-2]*= top[-1];
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(IINC)
+		top[-(int32_t) ip->Arg1]++;
+		ip++;
+		NEXT();
+
+	TH_CASE(IDEC)
+		top[-(int32_t) ip->Arg1]--;
+		ip++;
+		NEXT();
+
+//--------------------------------- COMPARISON INSTRUCTIONS ---------------------------------------------
+
+	TH_CASE(CMP)
+		if (top[-1] == top[-2])
+			top[-2]= 0;
+		else if (top[-1] > top[-2])
+			top[-2]= 1;
+		else
+			top[-2]= (uint32_t) (-1);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(CMP_S)
+		if (((int32_t) top[-1]) == ((int32_t) top[-2]))
+			top[-2]= 0;
+		else if (((int32_t) top[-1]) > ((int32_t) top[-2]))
+			top[-2]= 1;
+		else
+			top[-2]= (uint32_t) (-1);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(MCMP)
+		utemp1= top[-1] & top[-3];
+		utemp2= top[-2] & top[-3];
+		if (utemp1 == utemp2)
+			top[-3]= 0;
+		else if (utemp1 > utemp2)
+			top[-3]= 1;
+		else
+			top[-3]= (uint32_t) (-1);
+		top-= 2;
+		ip++;
+		NEXT();
+
+//--------------------------PACKET SCAN INSTRUCTIONS---------------------------------------------------------------
+
+	TH_CASE(PSCANB)
+		PKTMEM_CHECK(top[-2], 1);
+		top[-2]= do_pscanb(xbuffer, top[-2], (uint8_t) top[-1], pktlen);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(PSCANW)
+		PKTMEM_CHECK(top[-2], 1);
+		top[-2]= do_pscanw(xbuffer, top[-2], (uint16_t) top[-1], pktlen);
+		top--;
+		ip++;
+		NEXT();
+
+	TH_CASE(PSCANDW)
+		PKTMEM_CHECK(top[-2], 1);
+		top[-2]= do_pscandw(xbuffer, top[-2], top[-1], pktlen);
+		top--;
+		ip++;
+		NEXT();
+
+//--------------------------FLOW CONTROL INSTRUCTIONS---------------------------------------------------------------
+
+#define TH_CMP(Name, Type, Op) \
+	TH_CASE(JCMP##Name) \
+		top-= 2; \
+		BRANCH_IF((Type) top[0] Op (Type) top[1]); \
+	TH_CASE(JCMPI##Name) \
+		top--; \
+		BRANCH_IF((Type) top[0] Op (Type) ip->Arg1); \
+	TH_CASE(LOCJCMPI##Name) \
+		BRANCH_IF((Type) locals[ip->Arg1] Op (Type) ip->Arg2); \
+	TH_CASE(PBLJCMP##Name) \
+		top--; \
+		BRANCH_IF((Type) top[0] Op (Type) pktlen);
+
+	TH_COMPARISONS
+#undef TH_CMP
+
+	TH_CASE(JEQ)
+		top--;
+		BRANCH_IF(top[0] == 0);
+
+	TH_CASE(JNE)
+		top--;
+		BRANCH_IF(top[0] != 0);
+
+	TH_CASE(JUMP)
+		ip= ip->Target;
+		NEXT();
+
+	TH_CASE(SWITCH)
+		top--;
+		ip= &Code->Insns[genRT_SwitchLookup(&Code->Switches[ip->Arg1], top[0])];
+		NEXT();
+
+	TH_CASE(JFLDEQ)
+		PKTMEM_CHECK(top[-2], top[-1]);
+		PKTMEM_CHECK(top[-3], top[-1]);
+		top-= 3;
+		BRANCH_IF(memcmp(&xbuffer[top[0]], &xbuffer[top[1]], top[2]) == 0);
+
+	TH_CASE(JFLDNEQ)
+		PKTMEM_CHECK(top[-2], top[-1]);
+		PKTMEM_CHECK(top[-3], top[-1]);
+		top-= 3;
+		BRANCH_IF(memcmp(&xbuffer[top[0]], &xbuffer[top[1]], top[2]) != 0);
+
+	TH_CASE(JFLDLT)
+		PKTMEM_CHECK(top[-2], top[-1]);
+		PKTMEM_CHECK(top[-3], top[-1]);
+		top-= 3;
+		BRANCH_IF(memcmp(&xbuffer[top[0]], &xbuffer[top[1]], top[2]) < 0);
+
+	TH_CASE(JFLDGT)
+		PKTMEM_CHECK(top[-2], top[-1]);
+		PKTMEM_CHECK(top[-3], top[-1]);
+		top-= 3;
+		BRANCH_IF(memcmp(&xbuffer[top[0]], &xbuffer[top[1]], top[2]) > 0);
+
+	TH_CASE(RET)
+		if (top != stack)
+		{
+			errorprintf(__FILE__, __FUNCTION__, __LINE__, "The stack pointer is not zero at return time (sp = %d)\n", (int) (top - stack));
+			ret= nvmFAILURE;
+		}
+		else
+			ret= nvmSUCCESS;
+#ifdef RTE_PROFILE_COUNTERS
+		HandlerState->ProfCounters->TicksEnd= nbProfilerGetTime();
+#endif
+		return ret;
+
+	TH_CASE(END)
+		// The code ended without a ret or a sndpkt
+		return nvmFAILURE;
+
+//--------------------------- DATA TRANSFER INSTRUCTIONS -------------------------------
+
+	TH_CASE(SNDPKT)
+		ret= nvmSUCCESS;
+#ifdef RTE_PROFILE_COUNTERS
+		HandlerState->ProfCounters->TicksEnd= nbProfilerGetTime();
+		HandlerState->ProfCounters->NumFwdPkts++;
+#endif
+#ifndef CODE_PROFILING
+		ret= nvmNetPacket_Send(*exbuf, ip->Arg1, HandlerState);
+#endif
+		return ret;
+
+	TH_CASE(DSNDPKT)
+		nvmNetPacketSendDup(*exbuf, ip->Arg1, HandlerState);
+		ip++;
+		NEXT();
+
+	TH_CASE(INFOCLR)
+		memset(xbufinfo, 0, infolen);
+		ip++;
+		NEXT();
+
+//------------------------------------------- Locals management instructions -------------------------------------------
+
+	TH_CASE(LOCLD)
+		*top++= locals[ip->Arg1];
+		ip++;
+		NEXT();
+
+	TH_CASE(LOCST)
+		locals[ip->Arg1]= *--top;
+		ip++;
+		NEXT();
+
+//------------------------------------ Instructions for interaction with coprocessors ----------------------------------
+
+	TH_CASE(COPIN)
+		CoprocTable[ip->Arg1].read(&CoprocTable[ip->Arg1], ip->Arg2, &utemp1);
+		*top++= utemp1;
+		ip++;
+		NEXT();
+
+	TH_CASE(COPOUT)
+		utemp1= *--top;
+		CoprocTable[ip->Arg1].write(&CoprocTable[ip->Arg1], ip->Arg2, &utemp1);
+		ip++;
+		NEXT();
+
+	TH_CASE(COPRUN)
+		CoprocTable[ip->Arg1].invoke(&CoprocTable[ip->Arg1], ip->Arg2);
+		ip++;
+		NEXT();
+
+	TH_CASE(COPPKTOUT)
+		CoprocTable[ip->Arg1].xbuf= *exbuf;
+		ip++;
+		NEXT();
+
+//------------------------------------------- Superinstructions -------------------------------------------
+
+	// locload a; locstore b
+	TH_CASE(LOCMOV)
+		locals[ip->Arg2]= locals[ip->Arg1];
+		ip++;
+		NEXT();
+
+	// push value; locstore a
+	TH_CASE(LOCSET)
+		locals[ip->Arg2]= ip->Arg1;
+		ip++;
+		NEXT();
+
+	// locload a; push value; add; locstore b
+	TH_CASE(LOCADDI)
+		locals[ip->Arg3]= locals[ip->Arg1] + ip->Arg2;
+		ip++;
+		NEXT();
+
+#define TH_PLOAD(Size) \
+	TH_CASE(PUSHPLOAD##Size) \
+		PKTMEM_CHECK(ip->Arg1, Size / 8); \
+		*top++= PLOAD##Size(ip->Arg1); \
+		ip++; \
+		NEXT(); \
+	TH_CASE(LOCPLOADST##Size) \
+		utemp1= locals[ip->Arg1]; \
+		PKTMEM_CHECK(utemp1, Size / 8); \
+		locals[ip->Arg2]= PLOAD##Size(utemp1); \
+		ip++; \
+		NEXT(); \
+	TH_CASE(PLOADJCMPIEQ##Size) \
+		PKTMEM_CHECK(ip->Arg1, Size / 8); \
+		BRANCH_IF(PLOAD##Size(ip->Arg1) == ip->Arg2); \
+	TH_CASE(PLOADJCMPINEQ##Size) \
+		PKTMEM_CHECK(ip->Arg1, Size / 8); \
+		BRANCH_IF(PLOAD##Size(ip->Arg1) != ip->Arg2);
+
+	TH_PACKET_LOADS
+#undef TH_PLOAD
+
+#ifndef GEN_THREADED_COMPUTED_GOTO
+	}
+	return nvmFAILURE;
+#endif
+
+PacketError:
+	errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access packet memory with an offset too big (from %u to %u > %u)\n", ErrOffset, ErrOffset + ErrSize - 1, pktlen);
+	return nvmPKTEX;
+
+InfoError:
+	errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access info memory with an offset too big (from %u to %u > %u)\n", ErrOffset, ErrOffset + ErrSize - 1, infolen);
+	return nvmINFOEX;
+
+DataError:
+	errorprintf(__FILE__, __FUNCTION__, __LINE__, "Trying to access data memory with an offset too big (%u > %u)\n", ErrOffset, datamemsize);
+	return nvmDATAEX;
+}
+
+
+#endif		// GEN_THREADED_INTERPRETER
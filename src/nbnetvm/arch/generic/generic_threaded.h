@@ -0,0 +1,100 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef __GENERIC_THREADED_H__
+#define __GENERIC_THREADED_H__
+
+/* Include config.h if needed */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <nbnetvm.h>
+#include <rt_environment.h>
+#include <int_structs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+	The threaded code cannot log or profile each NetIL instruction, hence it is not used when
+	these options are turned on (the original bytecode is interpreted instead).
+*/
+#if !defined(ENABLE_NETVM_LOGGING) && !defined(COUNTERS_PROFILING) && !defined(RTE_DYNAMIC_PROFILE)
+#define GEN_THREADED_INTERPRETER
+#endif
+
+// The address of each instruction handler is stored in the threaded code with the GCC 'labels as values' extension
+#if defined(__GNUC__) && !defined(GEN_THREADED_NO_COMPUTED_GOTO)
+#define GEN_THREADED_COMPUTED_GOTO
+#endif
+
+
+/*! \addtogroup GenRTFuncts
+	\{
+*/
+
+//! Instruction of the threaded code
+typedef struct _genThreadedInsn
+{
+#ifdef GEN_THREADED_COMPUTED_GOTO
+	const void *Label;						//!< Address of the code executing the instruction
+#endif
+	uint32_t Op;							//!< Instruction (TH_xxx)
+	uint32_t Arg1;							//!< First immediate (a constant, a local, a coprocessor ID...)
+	uint32_t Arg2;							//!< Second immediate
+	uint32_t Arg3;							//!< Third immediate (used by superinstructions only)
+	struct _genThreadedInsn *Target;		//!< Destination of a branch
+} genThreadedInsn;
+
+
+//! Threaded code of a handler
+typedef struct _genThreadedCode
+{
+	genThreadedInsn *Insns;					//!< Instructions (the first one is the entry point)
+	struct _genSwitchTable *Switches;		//!< Cases of the SWITCH instructions (indexed by their first immediate); targets are indexes of Insns
+	uint32_t NInsns;						//!< Number of instructions
+	uint32_t NBytecodeInsns;				//!< Number of NetIL instructions they have been translated from
+} genThreadedCode;
+
+
+/*!
+	\brief Translates the bytecode of a handler into threaded code.
+
+	The bytecode is decoded once: immediates are unpacked, branch targets are turned into
+	pointers, the depth of the stack is verified for every instruction (so that the threaded
+	code does not need to check it) and the most common sequences of instructions are fused
+	into a single one. The result is stored in HandlerState->ThreadedCode.
+
+	\param HandlerState State of the handler; only push handlers are translated.
+
+	\return nvmSUCCESS if the handler has been translated, nvmFAILURE if it has to be run by
+	the bytecode interpreter (e.g. it contains instructions that are not supported by the
+	threaded code, or the stack cannot be verified).
+*/
+int32_t genRT_TranslateHandler(nvmHandlerState *HandlerState);
+
+
+/*!
+	\brief Executes the threaded code of a handler.
+
+	It is called by genRT_Execute_Handlers() after the stack, the locals and the exchange
+	buffer have been prepared.
+*/
+int32_t genRT_Execute_Threaded(genThreadedCode *Code, nvmExchangeBuffer **exbuf, nvmHandlerState *HandlerState,
+	uint32_t *stack, uint32_t sp, uint32_t *locals);
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif		//__GENERIC_THREADED_H__
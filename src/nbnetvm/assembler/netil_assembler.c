@@ -576,6 +576,79 @@ uint32_t i;
 }
 
 
+nvmByteCode *nvmLoadBytecodeImageFromBuffer(const void *Image, uint32_t ImageSize, char *ErrBuf)
+{
+nvmByteCode *bytecode;
+nvmByteCodeImageHeader *Hdr= (nvmByteCodeImageHeader *) Image;
+uint32_t TableOffset, SectionsOffset;
+uint32_t i;
+
+	NETVM_ASSERT(Image != NULL, "Image cannot be NULL");
+
+	if ((ImageSize < sizeof(nvmByteCodeImageHeader)) || (Hdr->Signature != 0x45444F4C)) //i.e. 'EDOL'
+	{
+		errsnprintf(ErrBuf, nvmERRBUF_SIZE, "The buffer does not appear to contain a valid NetVM bytecode image (bad signature)");
+		return NULL;
+	}
+
+	// The image comes from an untrusted buffer, hence the section table must be checked before using it
+	TableOffset= sizeof(nvmByteCodeImageHeader) + Hdr->FileHeader.SizeOfOptionalHeader - sizeof(nvmByteCodeImageStructOpt);
+	SectionsOffset= TableOffset + Hdr->FileHeader.NumberOfSections * sizeof(nvmByteCodeSectionHeader);
+	if ((Hdr->FileHeader.SizeOfOptionalHeader < sizeof(nvmByteCodeImageStructOpt)) || (SectionsOffset > ImageSize))
+	{
+		errsnprintf(ErrBuf, nvmERRBUF_SIZE, "The NetVM bytecode image is truncated");
+		return NULL;
+	}
+
+	bytecode = calloc(1, sizeof(nvmByteCode));
+	if (bytecode == NULL)
+	{
+		errsnprintf(ErrBuf, nvmERRBUF_SIZE, ALLOC_FAILURE);
+		return NULL;
+	}
+
+	bytecode->Hdr = (nvmByteCodeImageHeader *) malloc(ImageSize);
+	if (bytecode->Hdr == NULL)
+	{
+		free(bytecode);
+		errsnprintf(ErrBuf, nvmERRBUF_SIZE, ALLOC_FAILURE);
+		return NULL;
+	}
+
+	memcpy(bytecode->Hdr, Image, ImageSize);
+
+	bytecode->SectionsTable = (nvmByteCodeSectionHeader*)((uint8_t *)bytecode->Hdr + TableOffset);
+	bytecode->Sections = (char*)bytecode->Hdr + SectionsOffset;
+	bytecode->SizeOfSections = 0;
+
+	for (i=0; i < bytecode->Hdr->FileHeader.NumberOfSections; i++)
+	{
+		if ((bytecode->SectionsTable[i].PointerToRawData > ImageSize) ||
+			(bytecode->SectionsTable[i].SizeOfRawData > ImageSize - bytecode->SectionsTable[i].PointerToRawData))
+		{
+			errsnprintf(ErrBuf, nvmERRBUF_SIZE, "The NetVM bytecode image is truncated");
+			nvmDestroyBytecode(bytecode);
+			free(bytecode);
+			return NULL;
+		}
+
+		bytecode->SizeOfSections += bytecode->SectionsTable[i].SizeOfRawData;
+	}
+
+	return bytecode;
+}
+
+
+const void *nvmGetBytecodeImage(nvmByteCode *bytecode, uint32_t *ImageSize)
+{
+	NETVM_ASSERT(bytecode != NULL, "bytecode cannot be NULL");
+
+	// Both the assembler and the loaders keep the header, the section table and the sections in a single buffer
+	*ImageSize= (uint32_t) ((uint8_t *) bytecode->Sections - (uint8_t *) bytecode->Hdr) + bytecode->SizeOfSections;
+	return bytecode->Hdr;
+}
+
+
 
 int32_t nvmCreateBytecodeFromAsmBuffer(nvmByteCode *bytecode, char *NetVMAsmBuffer)
 {
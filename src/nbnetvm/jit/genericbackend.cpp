@@ -26,5 +26,10 @@ void jit::GenericBackend::emitNativeAssembly(std::ostream &str)
 	return;
 }
 
+bool jit::GenericBackend::getNativeCodeRefs(uint32_t &size, std::vector<NativeCodeRef> &refs)
+{
+	return false;
+}
+
 jit::GenericBackend::~GenericBackend()
 {}
@@ -16,9 +16,51 @@
 #include "cfg.h"
 #include <string>
 #include <iostream>
+#include <vector>
 
 namespace jit {
 
+	//! a field of the emitted native code holding an address, which has to be patched when the code is moved
+	struct NativeCodeRef
+	{
+		enum RefType
+		{
+			ABS64,	//!< 8-byte absolute address
+			REL32,	//!< 4-byte displacement from the end of the field
+			ABS32	//!< 4-byte sign-extended absolute address
+		};
+
+		//! runtime objects an address can refer to
+		enum TargetKind
+		{
+			CODE,			//!< the native code itself
+			PE_MEMORY,		//!< data (0), shared (1) or initialized (2) memory of the PE
+			COPRO_STATE,	//!< state of a coprocessor
+			COPRO_FUNCT,	//!< function of a coprocessor (see Function)
+			CONN_FUNCT,		//!< function of the handler connected to a port
+			CONN_HANDLER	//!< state of the handler connected to a port
+		};
+
+		//! functions of a coprocessor; the operations of the experimental coprocessor model follow COPRO_INVOKE
+		enum CoproFunction
+		{
+			COPRO_INIT,
+			COPRO_WRITE,
+			COPRO_READ,
+			COPRO_INVOKE
+		};
+
+		uint32_t Offset;	//!< offset of the field from the beginning of the code
+		RefType Type;		//!< kind of the field
+		TargetKind Target;	//!< kind of the object the address refers to
+		uint32_t Index;		//!< which object of that kind (memory, coprocessor or port number)
+		uint32_t Function;	//!< for COPRO_FUNCT, which function of the coprocessor
+		int64_t Addend;		//!< offset of the address from the beginning of the object
+
+		NativeCodeRef(uint32_t offset, RefType type, TargetKind target, uint32_t index, uint32_t function, int64_t addend)
+			: Offset(offset), Type(type), Target(target), Index(index), Function(function), Addend(addend) {}
+	};
+
 	//! the class implemented by each backend
 	class GenericBackend {
 		public:
@@ -36,6 +78,17 @@ namespace jit {
 		 * \param  str reference to an output stream
 		 */
 		virtual void emitNativeAssembly(std::ostream &str);
+
+		/*!
+		 * \brief a function implemented by a backend that lists the fields of the native code holding addresses
+		 *
+		 * It is used by the JIT cache to relocate the code emitted by emitNativeFunction().
+		 * \param size returns the size of the native code in bytes
+		 * \param refs returns the fields of the native code holding addresses
+		 * \return false if the backend cannot track all of them, i.e. the code cannot be cached
+		 */
+		virtual bool getNativeCodeRefs(uint32_t &size, std::vector<NativeCodeRef> &refs);
+
 		//! destructor
 		virtual ~GenericBackend();
 	};
@@ -19,13 +19,13 @@ x86SwitchHelper::x86SwitchHelper(BasicBlock<x86Instruction>& bb, SwitchMIRNode&
 void x86SwitchHelper::emit_jcmp_l(uint32_t case_value, uint32_t jt, uint32_t jf)
 {
 	x86_Asm_Op_Imm_To_Reg(bb.getCode(), X86_CMP, case_value, original_reg, x86_DWORD);
-	x86_Asm_J_Label(bb.getCode(), L, jt);
+	x86_Asm_J_Label(bb.getCode(), B, jt);
 }
 
 void x86SwitchHelper::emit_jcmp_g(uint32_t case_value, uint32_t jt, uint32_t jf)
 {
 	x86_Asm_Op_Imm_To_Reg(bb.getCode(), X86_CMP, case_value, original_reg, x86_DWORD);
-	x86_Asm_J_Label(bb.getCode(), G, jt);
+	x86_Asm_J_Label(bb.getCode(), A, jt);
 }
 
 void x86SwitchHelper::emit_jcmp_eq(uint32_t case_value, uint32_t jt, uint32_t jf)
@@ -93,7 +93,7 @@ void x86SwitchHelper::emit_binary_end_jump(uint32_t case_value, uint32_t jt, uin
 void x86SwitchHelper::emit_binary_jump(uint32_t case_value, std::string& my_name, std::string& target_name)
 {
 	x86_Asm_Op_Imm_To_Reg(bb.getCode(), X86_CMP, case_value, original_reg, x86_DWORD);
-	Px86Instruction node = x86_Asm_J_Label(bb.getCode(), GE, 0);
+	Px86Instruction node = x86_Asm_J_Label(bb.getCode(), AE, 0);
 
 	bin_tree[target_name] = node;
 
@@ -0,0 +1,458 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+/*!
+ * \file jit_cache.cpp
+ * \brief this file contains the on-disk cache of the native code emitted by the JIT
+ */
+
+#include "jit_cache.h"
+#include "int_structs.h"
+#include "../coprocessor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef WIN32
+#include <windows.h>
+#define snprintf _snprintf
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace jit;
+using namespace std;
+
+
+//! Version of the format of the cache entries; it must be changed whenever the emitted code changes
+#define JIT_CACHE_VERSION 2
+
+//! Extension of the cache files
+#define JIT_CACHE_EXT ".njc"
+
+//! Number of functions of each coprocessor that can be referenced by the code
+#ifdef _EXP_COPROCESSOR_MODEL
+#define JIT_CACHE_COPRO_FUNCTS (4 + MAX_COPRO_OPS)
+#else
+#define JIT_CACHE_COPRO_FUNCTS 4
+#endif
+
+
+//! Header of a cache file; it is followed by the key, the code and the relocations
+struct JitCacheHeader
+{
+	char Magic[8];			//!< JIT_CACHE_MAGIC
+	uint32_t Version;		//!< JIT_CACHE_VERSION
+	uint32_t KeySize;		//!< Size of the key in bytes
+	uint32_t CodeSize;		//!< Size of the code in bytes
+	uint32_t NRelocs;		//!< Number of relocations
+	uint64_t Checksum;		//!< Hash of what follows the header
+};
+
+static const char JIT_CACHE_MAGIC[8] = {'N', 'B', 'J', 'I', 'T', 'C', 'C', '\0'};
+
+
+//! FNV-1a hash
+static uint64_t fnv64(const void *data, size_t len, uint64_t hash = 14695981039346656037ULL)
+{
+	const uint8_t *p = (const uint8_t *)data;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static void put32(string &s, uint32_t value)
+{
+	s.append((const char *)&value, sizeof(value));
+}
+
+static void put_string(string &s, const char *str, size_t maxlen)
+{
+	size_t len = 0;
+
+	while (len < maxlen && str[len] != '\0')
+		len++;
+	put32(s, len);
+	s.append(str, len);
+}
+
+static uint64_t ptr_value(const void *ptr)
+{
+	return (uint64_t)(size_t)ptr;
+}
+
+static void *copro_funct(nvmCoprocessorState *copro, uint32_t which)
+{
+	switch (which)
+	{
+		case 0:
+			return (void *)copro->init;
+		case 1:
+			return (void *)copro->write;
+		case 2:
+			return (void *)copro->read;
+		case 3:
+			return (void *)copro->invoke;
+	}
+#ifdef _EXP_COPROCESSOR_MODEL
+	return copro->OpFunctions[which - 4];
+#else
+	return NULL;
+#endif
+}
+
+static nvmMemDescriptor *pe_memory(nvmHandlerState *HandlerState, uint32_t index)
+{
+	switch (index)
+	{
+		case 0:
+			return HandlerState->PEState->DataMem;
+		case 1:
+			return HandlerState->PEState->ShdMem;
+		case 2:
+			return HandlerState->PEState->InitedMem;
+	}
+	return NULL;
+}
+
+static uint8_t *alloc_code(uint32_t size)
+{
+#ifdef WIN32
+	return (uint8_t *)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+	void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+#if defined(__APPLE__)
+		MAP_PRIVATE | MAP_ANON,
+#else
+		MAP_PRIVATE | MAP_ANONYMOUS,
+#endif
+		-1, 0);
+	if (addr == MAP_FAILED)
+		return NULL;
+	return (uint8_t *)addr;
+#endif
+}
+
+static void free_code(uint8_t *code, uint32_t size)
+{
+#ifdef WIN32
+	VirtualFree(code, 0, MEM_RELEASE);
+#else
+	munmap(code, size);
+#endif
+}
+
+static bool protect_code(uint8_t *code, uint32_t size)
+{
+#ifdef WIN32
+	// the pages are already allocated with execution privileges
+	return true;
+#else
+	return mprotect(code, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+
+JitCodeCache::JitCodeCache(const char *dir, uint32_t backendID, uint32_t flags, uint32_t optLevel, nvmRuntimeEnvironment *RTObj)
+	: dir(dir), backendID(backendID), flags(flags), optLevel(optLevel), RTObj(RTObj)
+{
+}
+
+string JitCodeCache::makeKey(nvmHandlerState *HandlerState)
+{
+	nvmPEHandler *handler = HandlerState->Handler;
+	tmp_nvmPEState *PEState = HandlerState->PEState;
+	string key;
+
+	// the build of the JIT and the compilation options
+	put32(key, JIT_CACHE_VERSION);
+	put_string(key, __DATE__ " " __TIME__, 64);
+	put32(key, sizeof(void *));
+	put32(key, backendID);
+	put32(key, flags);
+	put32(key, optLevel);
+
+	// the bytecode
+	put32(key, handler->CodeSize);
+	key.append((const char *)handler->ByteCode, handler->CodeSize);
+
+	// the runtime objects the code depends on
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		nvmMemDescriptor *mem = pe_memory(HandlerState, i);
+		put32(key, mem != NULL && mem->Base != NULL);
+		put32(key, mem != NULL ? mem->Size : 0);
+	}
+
+	put32(key, PEState->NCoprocRefs);
+	for (uint32_t i = 0; i < PEState->NCoprocRefs; i++)
+	{
+		nvmCoprocessorState *copro = &PEState->CoprocTable[i];
+		put_string(key, copro->name, MAX_COPRO_NAME);
+		put32(key, copro->n_regs);
+		for (uint32_t j = 0; j < JIT_CACHE_COPRO_FUNCTS; j++)
+			put32(key, copro_funct(copro, j) != NULL);
+	}
+
+	put32(key, PEState->Nports);
+	for (uint32_t i = 0; i < PEState->Nports; i++)
+	{
+		nvmPEPort *port = &handler->OwnerPE->PortTable[i];
+		nvmPortState *conn = &PEState->ConnTable[i];
+		put32(key, port->PortFlags);
+		put32(key, port->CtdPort);
+		put32(key, conn->CtdHandlerType);
+		put32(key, conn->CtdHandlerFunct != NULL);
+		put32(key, conn->CtdHandler != NULL);
+	}
+
+	if (RTObj->ExbufPool != NULL)
+	{
+		put32(key, RTObj->ExbufPool->PacketLen);
+		put32(key, RTObj->ExbufPool->InfoLen);
+	}
+
+	return key;
+}
+
+string JitCodeCache::makePath(const string &key)
+{
+	char name[32];
+
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)fnv64(key.data(), key.size()));
+	return dir + "/" + name + JIT_CACHE_EXT;
+}
+
+bool JitCodeCache::getAnchor(nvmHandlerState *HandlerState, uint8_t *code, uint32_t anchor, uint32_t index, uint64_t &address)
+{
+	tmp_nvmPEState *PEState = HandlerState->PEState;
+	const void *ptr = NULL;
+
+	switch (anchor)
+	{
+		case NativeCodeRef::CODE:
+			ptr = code;
+			break;
+
+		case NativeCodeRef::PE_MEMORY:
+		{
+			nvmMemDescriptor *mem = pe_memory(HandlerState, index);
+			if (mem != NULL)
+				ptr = mem->Base;
+			break;
+		}
+
+		case NativeCodeRef::COPRO_STATE:
+			if (index < PEState->NCoprocRefs)
+				ptr = &PEState->CoprocTable[index];
+			break;
+
+		case NativeCodeRef::COPRO_FUNCT:
+			if (index / JIT_CACHE_COPRO_FUNCTS < PEState->NCoprocRefs)
+				ptr = copro_funct(&PEState->CoprocTable[index / JIT_CACHE_COPRO_FUNCTS], index % JIT_CACHE_COPRO_FUNCTS);
+			break;
+
+		case NativeCodeRef::CONN_FUNCT:
+			if (index < PEState->Nports)
+				ptr = (const void *)PEState->ConnTable[index].CtdHandlerFunct;
+			break;
+
+		case NativeCodeRef::CONN_HANDLER:
+			if (index < PEState->Nports)
+				ptr = PEState->ConnTable[index].CtdHandler;
+			break;
+	}
+
+	if (ptr == NULL)
+		return false;
+
+	address = ptr_value(ptr);
+	return true;
+}
+
+uint8_t *JitCodeCache::load(nvmHandlerState *HandlerState)
+{
+	string key = makeKey(HandlerState);
+	string path = makePath(key);
+	JitCacheHeader header;
+	vector<uint8_t> body;
+
+	FILE *file = fopen(path.c_str(), "rb");
+	if (file == NULL)
+		return NULL;
+
+	bool valid = fread(&header, sizeof(header), 1, file) == 1
+		&& memcmp(header.Magic, JIT_CACHE_MAGIC, sizeof(JIT_CACHE_MAGIC)) == 0
+		&& header.Version == JIT_CACHE_VERSION
+		&& header.KeySize == key.size()
+		&& header.CodeSize > 0
+		&& header.NRelocs <= header.CodeSize;
+
+	if (valid)
+	{
+		body.resize(header.KeySize + header.CodeSize + header.NRelocs * sizeof(Reloc));
+		valid = fread(&body[0], 1, body.size(), file) == body.size()
+			&& fnv64(&body[0], body.size()) == header.Checksum
+			&& memcmp(&body[0], key.data(), key.size()) == 0;
+	}
+	fclose(file);
+
+	if (!valid)
+	{
+		VerbOut(RTObj, 0, ">> ignoring the invalid JIT cache entry %s\n", path.c_str());
+		return NULL;
+	}
+
+	uint8_t *code = alloc_code(header.CodeSize);
+	if (code == NULL)
+		return NULL;
+	memcpy(code, &body[header.KeySize], header.CodeSize);
+
+	for (uint32_t i = 0; i < header.NRelocs; i++)
+	{
+		Reloc reloc;
+		uint64_t address;
+
+		memcpy(&reloc, &body[header.KeySize + header.CodeSize + i * sizeof(Reloc)], sizeof(Reloc));
+
+		uint32_t field_size = (reloc.Type == NativeCodeRef::ABS64) ? 8 : 4;
+		valid = reloc.Offset <= header.CodeSize - field_size
+			&& header.CodeSize >= field_size
+			&& getAnchor(HandlerState, code, reloc.Anchor, reloc.Index, address);
+		if (!valid)
+			break;
+
+		address += reloc.Addend;
+
+		if (reloc.Type == NativeCodeRef::ABS64)
+		{
+			memcpy(code + reloc.Offset, &address, sizeof(address));
+			continue;
+		}
+
+		// 32 bit fields must still be able to hold the new address
+		int64_t value = (int64_t)address;
+		if (reloc.Type == NativeCodeRef::REL32)
+			value -= (int64_t)ptr_value(code + reloc.Offset + 4);
+
+		if (value > INT_MAX || value < INT_MIN || (reloc.Type != NativeCodeRef::REL32 && reloc.Type != NativeCodeRef::ABS32))
+		{
+			valid = false;
+			break;
+		}
+
+		int32_t field = (int32_t)value;
+		memcpy(code + reloc.Offset, &field, sizeof(field));
+	}
+
+	if (!valid || !protect_code(code, header.CodeSize))
+	{
+		VerbOut(RTObj, 0, ">> cannot relocate the JIT cache entry %s\n", path.c_str());
+		free_code(code, header.CodeSize);
+		return NULL;
+	}
+
+	return code;
+}
+
+bool JitCodeCache::store(nvmHandlerState *HandlerState, uint8_t *code, uint32_t size, const vector<NativeCodeRef> &refs)
+{
+	vector<Reloc> relocs;
+
+	for (vector<NativeCodeRef>::const_iterator i = refs.begin(); i != refs.end(); i++)
+	{
+		Reloc reloc;
+		uint64_t value, address;
+		int32_t field;
+
+		reloc.Offset = i->Offset;
+		reloc.Type = i->Type;
+		reloc.Anchor = i->Target;
+		reloc.Index = i->Index;
+		reloc.Addend = i->Addend;
+
+		if (i->Target == NativeCodeRef::COPRO_FUNCT)
+		{
+			if (i->Function >= JIT_CACHE_COPRO_FUNCTS)
+				return false;
+			reloc.Index = i->Index * JIT_CACHE_COPRO_FUNCTS + i->Function;
+		}
+
+		if (i->Type == NativeCodeRef::ABS64)
+		{
+			if (i->Offset + 8 > size)
+				return false;
+			memcpy(&value, code + i->Offset, sizeof(value));
+		}
+		else
+		{
+			if (i->Offset + 4 > size)
+				return false;
+			memcpy(&field, code + i->Offset, sizeof(field));
+			value = (uint64_t)(int64_t)field;
+			if (i->Type == NativeCodeRef::REL32)
+				value += ptr_value(code + i->Offset + 4);
+		}
+
+		// the backend tells what each address refers to; if the field does not hold it, the code cannot be relocated
+		if (!getAnchor(HandlerState, code, reloc.Anchor, reloc.Index, address) || address + reloc.Addend != value)
+		{
+			VerbOut(RTObj, 0, ">> the code of %s cannot be cached: the address at offset %u does not match its object\n",
+				HandlerState->Handler->Name, i->Offset);
+			return false;
+		}
+
+		relocs.push_back(reloc);
+	}
+
+	string key = makeKey(HandlerState);
+	string path = makePath(key);
+	string tmp_path = path + ".tmp";
+
+	string body = key;
+	body.append((const char *)code, size);
+	if (!relocs.empty())
+		body.append((const char *)&relocs[0], relocs.size() * sizeof(Reloc));
+
+	JitCacheHeader header;
+	memcpy(header.Magic, JIT_CACHE_MAGIC, sizeof(JIT_CACHE_MAGIC));
+	header.Version = JIT_CACHE_VERSION;
+	header.KeySize = key.size();
+	header.CodeSize = size;
+	header.NRelocs = relocs.size();
+	header.Checksum = fnv64(body.data(), body.size());
+
+	// the entry is written in a temporary file, so that readers never see it half-written
+	FILE *file = fopen(tmp_path.c_str(), "wb");
+	if (file == NULL)
+	{
+		VerbOut(RTObj, 0, ">> cannot write the JIT cache entry %s\n", tmp_path.c_str());
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(body.data(), 1, body.size(), file) == body.size();
+	written = (fclose(file) == 0) && written;
+
+#ifdef WIN32
+	if (written)
+		remove(path.c_str());
+#endif
+	if (!written || rename(tmp_path.c_str(), path.c_str()) != 0)
+	{
+		remove(tmp_path.c_str());
+		VerbOut(RTObj, 0, ">> cannot write the JIT cache entry %s\n", path.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+#ifndef _JIT_CACHE_H
+#define _JIT_CACHE_H
+
+/** @file jit_cache.h
+ * \brief This file contains the on-disk cache of the native code emitted by the JIT
+ */
+
+#include "nbnetvm.h"
+#include "rt_environment.h"
+#include "genericbackend.h"
+#include <string>
+#include <vector>
+
+namespace jit
+{
+
+	/*!
+	 * \brief on-disk cache of the native code of the push handlers
+	 *
+	 * Each entry is keyed by the bytecode of the handler, by the backend, the flags and the optimization
+	 * level, and by the layout of the runtime objects the code refers to (ports, coprocessors, memories).
+	 * The code is stored together with the position of the addresses it holds, each one expressed as an
+	 * offset from a runtime object (the code itself, a memory, a coprocessor, a connected handler), so
+	 * that it can be patched for the objects of the current runtime environment when it is loaded.
+	 *
+	 * An entry that cannot be read, does not match the handler or cannot be relocated is ignored: the
+	 * handler is compiled as usual and the entry is overwritten.
+	 */
+	class JitCodeCache
+	{
+		public:
+
+		/*!
+		 * \brief constructor
+		 * \param dir folder of the cache files (it must exist)
+		 * \param backendID backend the code is emitted by
+		 * \param flags jit flags
+		 * \param optLevel optimization level
+		 * \param RTObj runtime environment the code is loaded in
+		 */
+		JitCodeCache(const char *dir, uint32_t backendID, uint32_t flags, uint32_t optLevel, nvmRuntimeEnvironment *RTObj);
+
+		/*!
+		 * \brief loads the cached native code of a handler
+		 * \param HandlerState state of the handler
+		 * \return the executable code, relocated for the current runtime objects, or NULL if it is not in the cache
+		 */
+		uint8_t *load(nvmHandlerState *HandlerState);
+
+		/*!
+		 * \brief stores the native code of a handler
+		 * \param HandlerState state of the handler
+		 * \param code native code emitted by the backend
+		 * \param size size of the code in bytes
+		 * \param refs fields of the code holding addresses (see GenericBackend::getNativeCodeRefs())
+		 * \return false if the code cannot be relocated or the entry cannot be written
+		 */
+		bool store(nvmHandlerState *HandlerState, uint8_t *code, uint32_t size, const std::vector<NativeCodeRef> &refs);
+
+		private:
+
+		//!relocation stored in a cache entry
+		struct Reloc
+		{
+			uint32_t Offset;	//!<offset of the field in the code
+			uint32_t Type;		//!<one of the NativeCodeRef::RefType values
+			uint32_t Anchor;	//!<one of the NativeCodeRef::TargetKind values
+			uint32_t Index;		//!<which object of that kind (for coprocessor functions, coprocessor * JIT_CACHE_COPRO_FUNCTS + function)
+			int64_t Addend;		//!<offset of the address from the object
+		};
+
+		//!builds the data an entry is keyed by
+		std::string makeKey(nvmHandlerState *HandlerState);
+
+		//!returns the path of the entry for a key
+		std::string makePath(const std::string &key);
+
+		//!returns the address of a runtime object, or false if it does not exist
+		bool getAnchor(nvmHandlerState *HandlerState, uint8_t *code, uint32_t anchor, uint32_t index, uint64_t &address);
+
+		std::string dir;			//!<folder of the cache files
+		uint32_t backendID;			//!<backend the code is emitted by
+		uint32_t flags;				//!<jit flags
+		uint32_t optLevel;			//!<optimization level
+		nvmRuntimeEnvironment *RTObj;	//!<runtime environment the code is loaded in
+	};
+}
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "jit_interface.h"
 #include "jit_internals.h"
+#include "jit_cache.h"
 
 #include "codetable.h"
 #include "bytecode_segments.h"
@@ -314,7 +315,7 @@ int32_t nvmNetCompileApplication(
 {
 
 	std::stringstream targetCodeStream;
-	TargetOptions options(OptLevel, OutputFilePrefix, JitFlags, targetCodeStream);
+	TargetOptions options(OptLevel, OutputFilePrefix, JitFlags, targetCodeStream, BackendID, RTObj ? RTObj->JitCacheDir : NULL);
 
 	if (BackendID >= TARGETS_NUM)
 	{
@@ -525,6 +526,11 @@ void build_cfg(CFG<MIRNode>& cfg, nvmPEHandler* handler, nvmByteCodeSegment* seg
 
 void TargetDriver::compilePEs(DiGraph<nvmNetPE*>* pe_graph)
 {
+	// only the native code can be cached
+	auto_ptr<JitCodeCache> cache;
+	if (options->CacheDir != NULL && nvmFLAG_ISSET(options->Flags, nvmDO_NATIVE) && !nvmFLAG_ISSET(options->Flags, nvmDO_ASSEMBLY))
+		cache.reset(new JitCodeCache(options->CacheDir, options->BackendID, options->Flags, options->OptLevel, RTObj));
+
 	pe_graph->SortPostorder(**pe_graph->FirstNode());
 	DiGraph<nvmNetPE *>::SortedIterator n = pe_graph->FirstNodeSorted();
 
@@ -545,6 +551,18 @@ void TargetDriver::compilePEs(DiGraph<nvmNetPE*>* pe_graph)
 #endif
 		{
 			nvmHandlerState* push = pe->PushHandler->HandlerState;
+
+			if (cache.get() != NULL)
+			{
+				uint8_t* functPushBuffer = cache->load(push);
+				if (functPushBuffer != NULL)
+				{
+					VerbOut(RTObj, 0, ">> .push segment loaded from the JIT cache\n");
+					connectFunctionToHandler(functPushBuffer, push);
+					continue;
+				}
+			}
+
 			nvmNet_JitFill_Segments_Info(&segmentInfo, push);
 			RegisterModel::reset();
 
@@ -586,6 +604,11 @@ void TargetDriver::compilePEs(DiGraph<nvmNetPE*>* pe_graph)
 				uint8_t* functPushBuffer = backend->emitNativeFunction();
 				VerbOut(RTObj, 0, ">> .push segment compilation succeeded!\n");
 				connectFunctionToHandler(functPushBuffer, push);
+
+				uint32_t size;
+				std::vector<NativeCodeRef> refs;
+				if (cache.get() != NULL && functPushBuffer != NULL && backend->getNativeCodeRefs(size, refs))
+					cache->store(push, functPushBuffer, size, refs);
 			}
 			else
 			{
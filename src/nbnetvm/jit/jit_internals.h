@@ -25,9 +25,11 @@ namespace jit
 		const char *OutputFilePrefix;			//!<prefix for files emitted
 		uint32_t Flags;  		//!<Jit Flags
 		std::ostream &assembly_stream;   //!the stream where the target code is emitted
+		uint32_t BackendID;		//!<backend used for the compilation
+		const char *CacheDir;	//!<folder of the cache of the native code (NULL if the cache is disabled)
 
-		_TargetOptions(uint8_t optLevel, const char *outputFilePrefix, uint32_t fl, std::ostream &targetCode)
-			:OptLevel(optLevel), OutputFilePrefix(outputFilePrefix), Flags(fl), assembly_stream(targetCode){}
+		_TargetOptions(uint8_t optLevel, const char *outputFilePrefix, uint32_t fl, std::ostream &targetCode, uint32_t backendID = 0, const char *cacheDir = NULL)
+			:OptLevel(optLevel), OutputFilePrefix(outputFilePrefix), Flags(fl), assembly_stream(targetCode), BackendID(backendID), CacheDir(cacheDir){}
 	};
 
 	typedef struct _TargetOptions TargetOptions;
@@ -99,13 +99,13 @@ void octeon_Switch_Helper::emit_binary_end_jump(uint32_t case_value, uint32_t jt
 void octeon_SwitchEmitter::run()
 {
 	cases_set c(insn.TargetsBegin(), insn.TargetsEnd());
-	CaseCompLess less;
-	sort(c.begin(), c.end(), less);
+	sort_cases(c);
 
-	uint32_t size = c.size();
-	uint32_t density = size * 100 / (c[size - 1].first - c[0].first);
-
-	if(density >= 40)
+	if(c.empty())
+	{
+		helper.emit_jcmp_eq(0, insn.getDefaultTarget(), insn.getDefaultTarget());
+	}
+	else if(use_jump_table(c))
 	{
 		emit_jump_table(c);
 	}
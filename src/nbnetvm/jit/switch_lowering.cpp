@@ -8,6 +8,7 @@
 #include <iostream>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
 
 using namespace std;
 using namespace jit;
@@ -275,10 +276,11 @@ void SwitchEmitter::emit_jump_table(cases_set& c)
 
 	helper.emit_jmp_to_table_entry(min);
 
+	//the loop counts the entries, since max may be the largest uint32_t
 	uint32_t current = 0;
-	for(uint32_t i = min; i <= max; i++)
+	for(uint32_t i = 0; i <= max - min; i++)
 	{
-		if(c[current].first != i)
+		if(c[current].first != min + i)
 		{
 			helper.emit_jump_table_entry(insn.getDefaultTarget());
 		}
@@ -290,17 +292,41 @@ void SwitchEmitter::emit_jump_table(cases_set& c)
 	}
 }
 
+/*!
+ * The NetIL switch takes the first case matching the value, so the cases with the same
+ * value as a previous one are dropped; the sort is stable in order to keep the first one.
+ */
+void SwitchEmitter::sort_cases(cases_set& c)
+{
+	CaseCompLess less;
+	CaseCompEqual equal;
+
+	stable_sort(c.begin(), c.end(), less);
+	c.erase(unique(c.begin(), c.end(), equal), c.end());
+}
+
+bool SwitchEmitter::use_jump_table(const cases_set& c)
+{
+	if(c.empty())
+		return false;
+
+	//computed on 64 bits, since the range of the cases may span all the uint32_t values
+	uint64_t range = (uint64_t)c.back().first - c.front().first + 1;
+
+	if(range > jump_table_max_size)
+		return false;
+
+	return c.size() * 100 >= range * jump_table_min_density;
+}
+
 void SwitchEmitter::run()
 {
 	cases_set c(insn.TargetsBegin(), insn.TargetsEnd());
-	CaseCompLess less;
-	sort(c.begin(), c.end(), less);
-	
-	
+	sort_cases(c);
+
 	uint32_t size = c.size();
-	uint32_t density = size * 100 / (c[size - 1].first - c[0].first);
 #ifdef _DEBUG_SWITCH_LOWERING
-	cout << "size: " << size << endl << "density: " << density << endl;
+	cout << "size: " << size << endl;
 	cases_set::iterator i = c.begin();
 	cout << "cases: " << endl;
 	for (i; i != c.end(); i++)
@@ -309,7 +335,12 @@ void SwitchEmitter::run()
 	}
 #endif
 
-	if(density >= 40)
+	if(size == 0)
+	{
+		//no cases: always jump to the default target
+		helper.emit_jcmp_eq(0, insn.getDefaultTarget(), insn.getDefaultTarget());
+	}
+	else if(use_jump_table(c))
 	{
 		#ifdef _DEBUG_SWITCH_LOWERING
 		cout << "jump-table" << endl;
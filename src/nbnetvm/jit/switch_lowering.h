@@ -140,6 +140,14 @@ namespace jit {
 			ISwitchHelper& helper; //!<helper used by the algorithm
 			SwitchMIRNode& insn;   //!<instruction to emit
 
+			static const uint32_t jump_table_min_density = 40; //!<minimum density (percent of the covered range) of the cases of a jump table
+			static const uint32_t jump_table_max_size = 4096;  //!<maximum number of entries of a jump table
+
+			//!sort the cases by value, keeping only the first case for each value
+			static void sort_cases(cases_set& c);
+			//!true if the (sorted) cases are dense enough to be lowered as a jump table
+			static bool use_jump_table(const cases_set& c);
+
 			//!launch the algorithm MRST on set P
 			void MRST(cases_set& P);
 			//!launch the algorithm of binary seach tree on set c
@@ -147,15 +155,21 @@ namespace jit {
 			//!emit a jump table for the set c
 			void emit_jump_table(cases_set& c);
 
+			//!orders the cases by value only (the target must not be taken into account, or the order is not strict weak)
 			struct CaseCompLess
 			{
-				bool operator()(const case_pair &x, const case_pair &y)
+				bool operator()(const case_pair &x, const case_pair &y) const
+				{
+					return x.first < y.first;
+				}
+			};
+
+			//!true if two cases have the same value
+			struct CaseCompEqual
+			{
+				bool operator()(const case_pair &x, const case_pair &y) const
 				{
-					if (x.first >= y.first)
-						return false;
-					if (x.second >= y.second)
-						return false;
-					return true;
+					return x.first == y.first;
 				}
 			};
 
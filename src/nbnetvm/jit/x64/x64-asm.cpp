@@ -228,6 +228,29 @@ void jit::x64::x64_Asm_Append_Comment(Px64Instruction insn, const char *comment)
 	_snprintf(insn->Comment, X64_COMMENT_LEN - 1, "%s", comment);
 }
 
+void jit::x64::x64_Asm_Set_Address_Ref(Px64Instruction insn, NativeCodeRef::TargetKind target, uint32_t index, int64_t addend, uint32_t function)
+{
+	int operand = -1;
+
+	if (insn == NULL)
+		return;
+
+	for (uint8_t i = 0; i < insn->NOperands; i++)
+	{
+		if (insn->Operands[i].Type == IMM_OP || (insn->Operands[i].Type == MEM_OP && operand < 0))
+			operand = i;
+	}
+	NETVM_ASSERT(operand >= 0, "The instruction has no operand that can hold an address");
+
+	// an invalid operand tells the emitter that the code cannot be relocated
+	insn->has_address_ref = true;
+	insn->address_ref.Operand = (operand >= 0) ? operand : insn->NOperands;
+	insn->address_ref.Target = target;
+	insn->address_ref.Index = index;
+	insn->address_ref.Function = function;
+	insn->address_ref.Addend = addend;
+}
+
 Px64Instruction jit::x64::x64_Asm_Enqueue_Insn(Px64InsnSequence x64InsnSeq, uint16_t code)
 {
 	Px64Instruction instruction;
@@ -9,6 +9,7 @@
 #include "irnode.h"
 #include "registers.h"
 #include "netvmjitglobals.h"
+#include "genericbackend.h"
 
 #include <cstddef>	// Added for catching an error on missing def for ptrdiff_t on Ubuntu 11.10
 #include <list>
@@ -286,6 +287,16 @@ namespace x64 {
 	extern char *x64RegNames[];
 	extern x64OpDescr x64OpDescriptions[];
 
+	//!Runtime object whose address is held by an immediate or displacement operand (see x64_Asm_Set_Address_Ref())
+	typedef struct _X64_ADDRESS_REF
+	{
+		uint8_t		Operand;	//!<operand holding the address
+		NativeCodeRef::TargetKind	Target;	//!<kind of the object
+		uint32_t	Index;		//!<which object of that kind
+		uint32_t	Function;	//!<which function, for the functions of a coprocessor
+		int64_t		Addend;		//!<offset of the address from the beginning of the object
+	} x64AddressRef;
+
 	//!Generic X64 instruction
 	class _X64_INSTRUCTION : public TableIRNode<x64RegOpnd, uint16_t >
 	{
@@ -301,6 +312,8 @@ namespace x64 {
 			uint32_t		switch_target; //!<label of the target of this case of the switch
 			bool			binary_switch_jump; //!<true if this is an binary switch jump
 			bool			load_current_address; //!<true if this is a mov that load current emission address added in a register (used in switch)
+			bool			has_address_ref; //!<true if an operand holds the address of a runtime object, described by address_ref
+			x64AddressRef	address_ref; //!<runtime object whose address is held by an operand
 
 			std::set<RegType> getUses();
 			std::set<RegType> getDefs();
@@ -313,7 +326,8 @@ namespace x64 {
 			  switch_entry(NULL),
 			  switch_target(0),
 			  binary_switch_jump(false),
-			  load_current_address(false)
+			  load_current_address(false),
+			  has_address_ref(false)
 			  //Removed(false)
 			{
 				Comment[0] = '\0';
@@ -416,6 +430,20 @@ namespace x64 {
 
 	void x64_Asm_Append_Comment(Px64Instruction insn, const char *comment);
 
+	/*!
+	 * \brief marks the operand of an instruction that holds the address of a runtime object
+	 *
+	 * The operand is the immediate one or, if there is none, the memory one with an absolute displacement.
+	 * The emitter turns it into a relocation of the native code (see NativeCodeRef), which is needed
+	 * to reuse the code with other runtime objects; every address that is put in the code must be marked.
+	 * \param insn the instruction (nothing is done if it is NULL)
+	 * \param target kind of the object
+	 * \param index which object of that kind
+	 * \param addend offset of the address from the beginning of the object
+	 * \param function which function, for the functions of a coprocessor (a NativeCodeRef::CoproFunction value)
+	 */
+	void x64_Asm_Set_Address_Ref(Px64Instruction insn, NativeCodeRef::TargetKind target, uint32_t index, int64_t addend, uint32_t function = 0);
+
 } //namespace x64
 } //namespace jit
 
@@ -241,7 +241,7 @@ bool x64Checker::operator()(RegType& a, RegType& b)
  */
 x64Backend::x64Backend(CFG<MIRNode>& cfg)
 : MLcfg(cfg), LLcfg(cfg.getName()),
-  code_created(false), buffer(NULL),
+  code_created(false), buffer(NULL), actual_buff_sz(0), relocatable(false),
   trace_builder(LLcfg) {}
 
 x64Backend::~x64Backend() {
@@ -576,6 +576,8 @@ bool jit::x64::x64Backend::create_code()
 	x64_Emitter emitter(LLcfg, regAlloc, trace_builder);
 	buffer = emitter.emit();
 	actual_buff_sz = emitter.getActualBufferSize();
+	code_refs = emitter.getCodeRefs();
+	relocatable = emitter.isRelocatable();
 	code_created = true;
 	return true;
 }
@@ -678,6 +680,21 @@ uint8_t* x64Backend::emitNativeFunction()
 	return buffer;
 }
 
+bool x64Backend::getNativeCodeRefs(uint32_t &size, std::vector<NativeCodeRef> &refs)
+{
+#if defined(RTE_PROFILE_COUNTERS) || defined(JIT_RTE_PROFILE_COUNTERS) || defined(COUNTERS_PROFILING) || defined(_DEBUG_X64_CODE)
+	// the profiling and debug code holds addresses of counters and strings that are not tracked
+	return false;
+#else
+	if (!code_created || !relocatable)
+		return false;
+
+	size = actual_buff_sz;
+	refs = code_refs;
+	return true;
+#endif
+}
+
 void x64::x64Backend::emitNativeAssembly(std::string prefix)
 {
 	//printf("Emitting native assembly:\n");
@@ -53,6 +53,7 @@ namespace jit {
 				uint8_t *emitNativeFunction();
 				void emitNativeAssembly(std::string filename);
 				void emitNativeAssembly(std::ostream &str);
+				bool getNativeCodeRefs(uint32_t &size, std::vector<NativeCodeRef> &refs);
 				//!destructor
 				~x64Backend();
 
@@ -66,6 +67,8 @@ namespace jit {
 				bool code_created; //!<has the code already been created?
 				uint8_t* buffer;  //!<where the buffer is located in memory
 				uint32_t actual_buff_sz; //!<size of the binary function in bytes
+				std::vector<NativeCodeRef> code_refs; //!<fields of the binary function holding addresses
+				bool relocatable; //!<true if code_refs lists all the addresses in the binary function
 				x64TraceBuilder trace_builder; //!<object with the order of bb emission
 		};
 
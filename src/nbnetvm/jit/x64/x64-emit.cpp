@@ -2076,13 +2076,14 @@ namespace jit{
 
 		x64_Emitter::x64_Emitter(CFG<x64Instruction>& cfg, GCRegAlloc<CFG<x64Instruction> >& regAlloc, TraceBuilder<jit::CFG<x64Instruction> >& trace_builder)
 			: buffer(NULL), current(NULL),
-			cfg(cfg), regAlloc(regAlloc), trace_builder(trace_builder)
+			cfg(cfg), regAlloc(regAlloc), trace_builder(trace_builder), relocatable(true)
 		{
 		}
 
 		void x64_Emitter::patch_entry(patch_info& pinfo)
 		{
 			uint8_t* targetAddr = cfg.getBBById(pinfo.destination_id)->getProperty<uint8_t*>(prop_name);
+			code_refs.push_back(NativeCodeRef(pinfo.emission_address - buffer, NativeCodeRef::ABS64, NativeCodeRef::CODE, 0, 0, targetAddr - buffer));
 			x64_Emit_Imm64((uint64_t)targetAddr, &pinfo.emission_address);
 		}
 
@@ -2216,6 +2217,99 @@ namespace jit{
 			return current-buffer;
 		}
 
+		const std::vector<NativeCodeRef>& x64_Emitter::getCodeRefs(void) const
+		{
+			return code_refs;
+		}
+
+		bool x64_Emitter::isRelocatable(void) const
+		{
+			return relocatable;
+		}
+
+		void x64_Emitter::record_code_refs(x64Instruction* insn, uint8_t* start)
+		{
+			uint16_t opcode = OP_ONLY(insn->getOpcode());
+
+			// the MOV used by the switch tables loads its own address
+			if (insn->load_current_address)
+			{
+				code_refs.push_back(NativeCodeRef((current - 8) - buffer, NativeCodeRef::ABS64, NativeCodeRef::CODE, 0, 0, start - buffer));
+				return;
+			}
+
+			if (!insn->has_address_ref)
+				return;
+
+			x64AddressRef& ref = insn->address_ref;
+			if (ref.Operand >= insn->NOperands)
+			{
+				relocatable = false;
+				return;
+			}
+
+			x64Operand& op = insn->Operands[ref.Operand];
+			NativeCodeRef::RefType type;
+			uint8_t* field;
+			int64_t value;
+
+			if (op.Type == IMM_OP)
+			{
+				value = (int64_t)IMM_OPERAND(op.Op)->Value;
+
+				if (opcode == X64_CALL)
+				{
+					// E8 rel32
+					field = start + 1;
+					type = NativeCodeRef::REL32;
+				}
+				else if (opcode == X64_MOV && Is_Imm_Reg_Op(insn) && insn->Operands[0].Size == x64_QWORD)
+				{
+					// REX.W B8+r imm64
+					field = current - 8;
+					type = NativeCodeRef::ABS64;
+				}
+				else
+				{
+					// the immediate is the last field of the encoding
+					field = current - 4;
+					type = NativeCodeRef::ABS32;
+				}
+			}
+			else if (op.Type == MEM_OP && (insn->NOperands == 1 || insn->Operands[1 - ref.Operand].Type != IMM_OP))
+			{
+				// without an immediate, the displacement is the last field of the encoding
+				value = MEM_OPERAND(op.Op)->Displ;
+				field = current - 4;
+				type = NativeCodeRef::ABS32;
+			}
+			else
+			{
+				relocatable = false;
+				return;
+			}
+
+			// make sure that the instruction has been encoded with the address in that field
+			bool found = false;
+			if (field >= start && field <= current - (type == NativeCodeRef::ABS64 ? 8 : 4))
+			{
+				if (type == NativeCodeRef::ABS64)
+					found = (*(uint64_t*)field == (uint64_t)value);
+				else if (type == NativeCodeRef::REL32)
+					found = (*(int32_t*)field == value - (int64_t)(field + 4));
+				else
+					found = (value <= INT_MAX && value >= INT_MIN && *(int32_t*)field == (int32_t)value);
+			}
+
+			if (!found)
+			{
+				relocatable = false;
+				return;
+			}
+
+			code_refs.push_back(NativeCodeRef(field - buffer, type, ref.Target, ref.Index, ref.Function, ref.Addend));
+		}
+
 		x64_Emitter::patch_info::patch_info(x64OpCodesEnum opcode, uint8_t* emission_address, uint16_t destination_id, bool last)
 			: opcode(opcode), emission_address(emission_address), destination_id(destination_id), last(last)
 		{
@@ -2287,8 +2381,18 @@ namespace jit{
 				add_entry(insn, current);
 			}
 
+			if(opcode == X64_SW_TABLE_ENTRY_START)
+			{
+				//the entry is filled with the address of this instruction
+				uint8_t* entry = insn->switch_entry->emission_address;
+				code_refs.push_back(NativeCodeRef(entry - buffer, NativeCodeRef::ABS64, NativeCodeRef::CODE, 0, 0, current - buffer));
+			}
+
+			uint8_t* start = current;
+
 			insn->emission_address = current;
 			insn->OpDescr->EmitFunct(insn, &current);
+			record_code_refs(insn, start);
 		}
 
 		void x64_Emitter::emitBB(bb_t *bb)
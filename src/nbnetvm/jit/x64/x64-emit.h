@@ -16,6 +16,8 @@
 #include "x64-asm.h"
 #include "tracebuilder.h"
 #include "gc_regalloc.h"
+#include "genericbackend.h"
+#include <vector>
 
 /** @file x64-emit.h
  * \brief This file contains the prototypes of the functions that the Jit uses to emit x64 code in memory
@@ -49,6 +51,12 @@ namespace x64{
 
 		uint32_t getActualBufferSize(void);
 
+		//!returns the fields of the emitted code holding addresses (see GenericBackend::getNativeCodeRefs())
+		const std::vector<NativeCodeRef>& getCodeRefs(void) const;
+
+		//!returns false if the emitted code holds addresses that are not listed by getCodeRefs()
+		bool isRelocatable(void) const;
+
 		private:
 
 		static const std::string prop_name; //!<holds the name of the property in bb of the address of emission in memory
@@ -113,6 +121,13 @@ namespace x64{
 		 */
 		void emit_insn(x64Instruction* insn);
 
+		/*!
+		 * \brief record the field holding the address marked by x64_Asm_Set_Address_Ref() in an emitted instruction
+		 * \param insn pointer to the emitted instruction
+		 * \param start address in the buffer where the instruction has been emitted
+		 */
+		void record_code_refs(x64Instruction* insn, uint8_t* start);
+
 		/*!
 		 * \brief patch a jump instruction
 		 * \param pinfo refence to the information for patching
@@ -134,6 +149,8 @@ namespace x64{
 		TraceBuilder<CFG<x64Instruction> >& trace_builder; //!<traces of the cfg
 		std::list<patch_info> jumps; //!<list of instruction and information for patching them
 		std::list<patch_info> entries; //!<list of switch table entries and information for patching them
+		std::vector<NativeCodeRef> code_refs; //!<fields of the emitted code holding addresses
+		bool relocatable; //!<false if the code holds addresses that are not in code_refs
 
 		public:
 
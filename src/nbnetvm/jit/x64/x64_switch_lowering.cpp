@@ -19,13 +19,13 @@ x64SwitchHelper::x64SwitchHelper(BasicBlock<x64Instruction>& bb, SwitchMIRNode&
 void x64SwitchHelper::emit_jcmp_l(uint32_t case_value, uint32_t jt, uint32_t jf)
 {
 	x64_Asm_Op_Imm_To_Reg(bb.getCode(), X64_CMP, case_value, original_reg, x64_DWORD);
-	x64_Asm_J_Label(bb.getCode(), L, jt);
+	x64_Asm_J_Label(bb.getCode(), B, jt);
 }
 
 void x64SwitchHelper::emit_jcmp_g(uint32_t case_value, uint32_t jt, uint32_t jf)
 {
 	x64_Asm_Op_Imm_To_Reg(bb.getCode(), X64_CMP, case_value, original_reg, x64_DWORD);
-	x64_Asm_J_Label(bb.getCode(), G, jt);
+	x64_Asm_J_Label(bb.getCode(), A, jt);
 }
 
 void x64SwitchHelper::emit_jcmp_eq(uint32_t case_value, uint32_t jt, uint32_t jf)
@@ -41,21 +41,19 @@ void x64SwitchHelper::emit_jcmp_eq(uint32_t case_value, uint32_t jt, uint32_t jf
  */
 void x64SwitchHelper::emit_jmp_to_table_entry(uint32_t min)
 {
-	int32_t displ = -min*8;
+	// the case value is rebased on a copy of the register (a 32 bit operation clears the upper half),
+	// since -min*8 does not fit in the displacement of the lea when min is large
+	x64Instruction::RegType index_reg = X64_NEW_VIRT_REG;
+	x64_Asm_Op_Reg_To_Reg(bb.getCode(), X64_MOV, original_reg, index_reg, x64_DWORD);
+	if (min != 0)
+		x64_Asm_Op_Imm_To_Reg(bb.getCode(), X64_SUB, min, index_reg, x64_DWORD);
+
 	x64_Asm_Load_Current_Memory_Location(bb.getCode(), tmp_reg);
-	x64_Asm_Op_Mem_Index_To_Reg(bb.getCode(), X64_LEA, tmp_reg, original_reg, displ, 3, tmp_reg, x64_QWORD);
+	x64_Asm_Op_Mem_Index_To_Reg(bb.getCode(), X64_LEA, tmp_reg, index_reg, 0, 3, tmp_reg, x64_QWORD);
 	
 	// we need to calcolate offset from loadCurrentMemory instruction to first Table Entry
-	// 10 bytes (mov/loadCurrentAddress) + 4/5/8 bytes (lea, displ = 0, displ is 8bit, displ is 32bit) + 7 byte jmp
-	int32_t offset;
-	if (displ == 0)
-	    offset = 21;
-	else if (displ >= -128 && displ <= 127)
-	    offset = 22;
-	else
-	    offset = 25;
-
-	x64_Asm_JMP_Indirect(bb.getCode(),tmp_reg, offset, x64_QWORD);
+	// 10 bytes (mov/loadCurrentAddress) + 4 bytes (lea, displ = 0) + 7 byte jmp
+	x64_Asm_JMP_Indirect(bb.getCode(),tmp_reg, 21, x64_QWORD);
 }
 
 void x64SwitchHelper::emit_jump_table_entry(uint32_t target)
@@ -115,7 +113,7 @@ void x64SwitchHelper::emit_binary_jump(uint32_t case_value, std::string& my_name
 	cout << "bin jump case " << case_value << "\t jt: -" << "\t jf:" << "\n";
 #endif
 	x64_Asm_Op_Imm_To_Reg(bb.getCode(), X64_CMP, case_value, original_reg, x64_DWORD);
-	Px64Instruction node = x64_Asm_J_Label(bb.getCode(), GE, 0);
+	Px64Instruction node = x64_Asm_J_Label(bb.getCode(), AE, 0);
 
 	bin_tree[target_name] = node;
 
@@ -93,6 +93,7 @@ nvmRuntimeEnvironment *nvmCreateRTEnv(nvmNetVM *netVMApp, uint32_t flags, char *
 	RTObj->VerbosityLevel= 1;
 	RTObj->VerboseOutput= stdout;
 	RTObj->TargetCode= NULL;
+	RTObj->JitCacheDir= NULL;
 
 	//it creates and append to the rigth list the PEState and the HandlerState
 	if (SLLst_Iterate_3Args(netVMApp->NetPEs, (nvmIteratefunct3Args *) nvmCreatePEStates, RTObj, &shd_size, errbuf) == nvmFAILURE)
@@ -768,6 +769,71 @@ int i;
 	return nvmSUCCESS;
 }
 
+
+//use this funct in push mode, when packets are available in batches
+int32_t nvmWriteAppInterfaceBatch(nvmAppInterface *AppInterface, uint8_t **Pkts, uint32_t *PktLens, nvmTStamp *TStamps, uint32_t NumPkts, void **UserData, char * errbuf)
+{
+nvmHandlerFunction *f;
+nvmExchangeBuffer *exbuf;
+nvmHandlerState *handler;
+uint32_t porta;
+uint32_t i;
+
+	if (NumPkts == 0)
+		return nvmSUCCESS;
+
+#if defined(RTE_PROFILE_COUNTERS) || defined(CODE_PROFILING)
+	// Profiling accounts each packet (and its exchange buffer) on its own, so packets go one by one
+	for (i= 0; i < NumPkts; i++)
+	{
+	nvmTStamp ts;
+
+		if (TStamps != NULL)
+			ts= TStamps[i];
+		else
+		{
+			ts.sec = 0;
+			ts.usec = 0;
+		}
+
+		if (nvmWriteAppInterfaceTS(AppInterface, Pkts[i], PktLens[i], &ts, (UserData != NULL) ? UserData[i] : NULL, errbuf) == nvmFAILURE)
+			return nvmFAILURE;
+	}
+
+	return nvmSUCCESS;
+#endif
+
+	exbuf = arch_GetExbuf(AppInterface->RTEnv);
+	if (exbuf == NULL)
+		return nvmFAILURE;
+
+	// The connected handler does not change within the batch, so we look it up only once
+	f=AppInterface->CtdHandler->PEState->ConnTable[AppInterface->CtdPort].CtdHandlerFunct;
+	porta=AppInterface->CtdPort;
+	handler=AppInterface->CtdHandler;
+
+	for (i= 0; i < NumPkts; i++)
+	{
+		exbuf->UserData = (UserData != NULL) ? UserData[i] : NULL;
+#ifdef	ARCH_RUNTIME_OCTEON
+		memcpy(exbuf->PacketBuffer, Pkts[i], PktLens[i]);
+#else
+		exbuf->PacketBuffer = Pkts[i];
+
+		exbuf->TStamp_s = (TStamps != NULL) ? TStamps[i].sec : 0;
+		exbuf->TStamp_us = (TStamps != NULL) ? TStamps[i].usec : 0;
+#endif
+		exbuf->PacketLen = PktLens[i];
+
+		f(&exbuf,porta,handler);
+	}
+
+	arch_ReleaseExbuf(AppInterface->RTEnv, exbuf);
+
+	return nvmSUCCESS;
+}
+
+
 //use this function in pull mode
 int32_t nvmReadAppInterface(nvmAppInterface *AppInterface,nvmExchangeBuffer **exbuf, void *userData, char *errbuf)
 {
@@ -1151,6 +1217,8 @@ void nvmDestroyRTEnv(nvmRuntimeEnvironment *RTObj)
 #endif
 	if (RTObj->TargetCode)
 		free(RTObj->TargetCode);
+	if (RTObj->JitCacheDir)
+		free(RTObj->JitCacheDir);
 	arch_ReleaseRTObject(RTObj);
 }
 
@@ -1180,6 +1248,26 @@ char *nvmGetTargetCode(nvmRuntimeEnvironment *RTObj)
 }
 
 
+int32_t nvmSetJitCacheDir(nvmRuntimeEnvironment *RTObj, const char *Dir, char *ErrBuf)
+{
+	if (RTObj->JitCacheDir)
+		free(RTObj->JitCacheDir);
+	RTObj->JitCacheDir= NULL;
+
+	if (Dir == NULL)
+		return nvmSUCCESS;
+
+	RTObj->JitCacheDir= strdup(Dir);
+	if (RTObj->JitCacheDir == NULL)
+	{
+		errsnprintf(ErrBuf, nvmERRBUF_SIZE, "Not enough memory for the name of the JIT cache folder");
+		return nvmFAILURE;
+	}
+
+	return nvmSUCCESS;
+}
+
+
 uint32_t nvmHash(uint8_t *data, uint8_t len)
 {
 	uint32_t hash = len, tmp = 0;
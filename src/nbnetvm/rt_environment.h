@@ -150,6 +150,10 @@ struct _nvmHandlerState
 	uint32_t	*Stack;				//!< Operands stack
 	uint32_t	StackSize;			//!< Size of the stack
 	tmp_nvmPEState *PEState;			//!< Reference to the PE State
+	void		*ThreadedCode;		//!< Pre-decoded code of the handler, if it can be run by the threaded interpreter
+	uint32_t	ThreadedFailed;		//!< Set if the handler cannot be translated into threaded code
+	void		*Switches;			//!< Cases of the SWITCH instructions of the handler, lowered into lookup tables
+	uint32_t	SwitchesFailed;		//!< Set if the switches of the handler cannot be lowered
 #ifdef RTE_PROFILE_COUNTERS
 	nvmCounter	*ProfCounters;		//!< Profiling counters
 	nvmCounter	*temp;		//!< Profiling counters
@@ -222,6 +226,7 @@ struct _nvmRuntimeEnvironment
 	void				*ArchData;		//!<used for keeping architecture specific information
 	uint32_t			execution_option;
 	char 				*TargetCode;
+	char				*JitCacheDir;	//!<Folder of the cache of the native code (NULL if the cache is disabled)
 #ifdef RTE_PROFILE_COUNTERS
   	nvmCounter			*Tot;		//!< Profiling counters
 #endif
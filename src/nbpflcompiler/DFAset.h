@@ -22,6 +22,9 @@ private:
          * final state, store it in this variable, as the whole DFAset
          * can be compacted into it (and just return it if asked by
          * the outside world).
+         * This does not hold for the states of a filter set (i.e. the
+         * ones with match tags): the other filters of the set may still
+         * accept later on, so those states are never compacted.
          */
         EncapFSA::State* states_acceptingfinal;
 
@@ -122,7 +125,8 @@ public:
 		states.insert(p);
                 if (states_acceptingfinal == NULL &&
                     s->isAccepting() &&
-                    s->isFinal() ){
+                    s->isFinal() &&
+                    s->GetMatchTags().empty() ){
                   states_acceptingfinal = s;
                   }
 	}
@@ -171,6 +175,18 @@ public:
           return (states_acceptingfinal != NULL);
 	}
 
+        // Returns the filters of a filter set that accept in at least one of the states
+        std::set<uint32> GetMatchTags(void)
+        {
+          std::set<uint32> tags;
+          std::map<uint32,EncapFSA::State*> states = this->GetStates();
+          for (std::map<uint32,EncapFSA::State*>::iterator iter = states.begin();
+               iter != states.end();
+               ++iter)
+            tags.insert((*iter).second->GetMatchTags().begin(), (*iter).second->GetMatchTags().end());
+          return tags;
+        }
+
         /*
 	bool IsNotAccepting(void)
 	{
@@ -14,12 +14,15 @@
 #include <iostream>
 #include "pflcfg.h"
 #include "mironode.h"
+#include "pflarena.h"
 #include <list>
 using namespace std;
 
 
 struct CompilationUnit
 {
+	PFLArena	Arena;		//!< Holds the IR of the compilation; it is declared first, so that it is released after the code and the CFGs
+
 	uint32		NumLocals;
 	uint32		MaxStack;
 	uint32		OutPort;
@@ -35,6 +35,14 @@ typedef int				int32;
 #endif
 
 
+//! Storage class of the variables that have a separate instance in each thread
+#ifdef _WIN32
+#define nbTHREAD_LOCAL __declspec(thread)
+#else
+#define nbTHREAD_LOCAL __thread
+#endif
+
+
 //#if 0
 //enum ReturnValues
 //{
@@ -24,6 +24,7 @@
       newfsa_ptr->setFinal(newst_iter);                                 \
     else                                                                \
       newfsa_ptr->resetFinal(newst_iter);                               \
+    (*newst_iter).AddMatchTags((oldst).GetMatchTags());                 \
   }
 
 EncapGraph *EncapFSA::m_ProtocolGraph = NULL;
@@ -43,6 +44,7 @@ void EncapFSA::migrateTransitionsAndStates(EncapFSA *to, EncapFSA *from, StateIt
     to->setAccepting(s);
   else 
     to->resetAccepting(s);
+  (*s).AddMatchTags((*init1).GetMatchTags());
   
   stateMap.insert( std::pair<EncapFSA::State*, EncapFSA::State*>(&(*init1),&(*s)) );
   to->AddEpsilon(init, s, NULL);
@@ -187,6 +189,43 @@ EncapFSA* EncapFSA::BooleanOR(EncapFSA *fsa1, EncapFSA *fsa2, bool fieldExtracti
   return fsa;
 }
 
+/*
+ * Merges the automata of the filters of a filter set into a single DFA.
+ * Before the union, the accepting states of the i-th automaton are tagged
+ * with i; after the determinization, each state carries the union of the
+ * tags of the states it comes from, i.e. the filters that accept in it.
+ */
+EncapFSA* EncapFSA::MergeFilterSet(std::vector<EncapFSA*> &fsaSet)
+{
+  nbASSERT(fsaSet.size() > 0, "the filter set cannot be empty");
+  NodeList_t toExtract;
+  EncapFSA *fsa = new EncapFSA(fsaSet[0]->m_Alphabet);
+  EncapFSA::StateIterator init = fsa->AddState(NULL);
+  fsa->SetInitialState(init);
+
+  for (uint32 i = 0; i < fsaSet.size(); i++)
+  {
+    for (EncapFSA::StateIterator s = fsaSet[i]->FirstState(); s != fsaSet[i]->LastState(); s++)
+    {
+      if ((*s).isAccepting())
+        (*s).AddMatchTag(i);
+    }
+
+    fsa->MergeCode1(fsaSet[i]->m_code1);
+    fsa->MergeCode2(fsaSet[i]->m_code2);
+    migrateTransitionsAndStates(fsa, fsaSet[i], init);
+  }
+
+  PRINT_DOT(fsa, "filter set before determinization", "filterset_nfa");
+
+  fsa->setFinalStates(false, toExtract);
+  fsa = EncapFSA::NFAtoDFA(fsa, false, toExtract);
+
+  PRINT_DOT(fsa, "filter set after determinization", "filterset_dfa");
+
+  return fsa;
+}
+
 EncapFSA::StateIterator EncapFSA::GetStateIterator(EncapFSA::State *state)
 {
 	EncapFSA::StateIterator s = this->FirstState();
@@ -468,6 +507,7 @@ int HandleSingleMovement(EncapFSA *fsa_from, EncapFSA *fsa_to, EncapFSA::State *
         fsa_to->setAccepting(st);
       else
         fsa_to->resetAccepting(st);
+      (*st).AddMatchTags(dfaset_to->GetMatchTags());
       dfa_list->push_front(*dfaset_to);
       stateMap->insert( std::pair<int, EncapFSA::State*>(dfaset_to->GetId(), &(*st)) );
       EncapFSA::StateIterator siter1 = fsa_to->GetStateIterator(state_from);
@@ -513,6 +553,7 @@ EncapFSA* EncapFSA::NFAtoDFA(EncapFSA *orig, bool fieldExtraction, NodeList_t to
 	EncapFSA::StateIterator stateIt = fsa->AddState(dset->GetInfo()); //GetInfo() returns a SymbolProto. In this case returns NULL
 	if(dset->isAccepting())
           fsa->setAccepting(stateIt);
+	(*stateIt).AddMatchTags(dset->GetMatchTags());
 	fsa->SetInitialState(stateIt);
 
 	dlist.push_front(*dset);
@@ -601,6 +642,7 @@ EncapFSA* EncapFSA::NFAtoDFA(EncapFSA *orig, bool fieldExtraction, NodeList_t to
                           fsa->setAccepting(st);
                         else
                           fsa->resetAccepting(st);
+			(*st).AddMatchTags(newds->GetMatchTags());
 			dlist.push_front(*newds);
 			std::pair<int, EncapFSA::State*> p = make_pair<int, EncapFSA::State*>(newds->GetId(), &(*st));
 			stateMap.insert(p);
@@ -731,19 +773,22 @@ void EncapFSA::setFinalStates(bool fieldExtraction, NodeList_t toExtract){
 
 	//we have to compact those final accepting state which are not on paths to protocols related to the field extraction (in case of we are doing field extraction)
 
+  //the final accepting states of a filter set are compacted only if the same filters accept in them
+
   if(final_accepting_states.size() > 1) {
-    State *tmp_s = NULL;
+    map<set<uint32>, State*> tmp_s;
     for(set<State*>::iterator i = final_accepting_states.begin();
         i != final_accepting_states.end();
         ++i) {
       if(fieldExtraction&& (!checkIfInsert(toExtract,(*i)->GetInfo())))
       	continue;
-      if (tmp_s)
+      map<set<uint32>, State*>::iterator same = tmp_s.find((*i)->GetMatchTags());
+      if (same != tmp_s.end())
       {
-      	trasformation_map[*i] = tmp_s;
+      	trasformation_map[*i] = same->second;
       }
       else
-        tmp_s = *i;
+        tmp_s[(*i)->GetMatchTags()] = *i;
     }
   }
 
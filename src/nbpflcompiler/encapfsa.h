@@ -16,6 +16,7 @@
 #include "sft/sft_writer.hpp"
 #include "strutils.h"
 #include <map>
+#include <vector>
 #include "filtersubgraph.h"
 #include "../nbee/globals/globals.h"
 
@@ -210,6 +211,7 @@ public:
 	void BooleanNot();
 	static EncapFSA* BooleanAND(EncapFSA *fsa1, EncapFSA *fsa2, bool fieldExtraction, NodeList_t toExtract);
 	static EncapFSA* BooleanOR(EncapFSA *fsa1, EncapFSA *fsa2, bool fieldExtraction, NodeList_t toExtract);
+	static EncapFSA* MergeFilterSet(std::vector<EncapFSA*> &fsaSet);
 	static EncapFSA* NFAtoDFA(EncapFSA *orig, bool fieldExtraction, NodeList_t toExtract, bool setInfo = true);
     void fixStateProtocols();
     void setFinalStates(bool fieldExtraction, NodeList_t toExtract);
@@ -83,7 +83,12 @@ CodeList *GlobalSymbols::NewCodeList(bool ownsStmts)
 {
 	CodeList *codeList = new CodeList(ownsStmts);
 	CHECK_MEM_ALLOC(codeList);
-	m_MemPool.NewObj(codeList);
+
+	// code lists created during a compilation hold statements of its arena, hence they go away with it
+	if (PFLArena::GetCurrent() != NULL)
+		PFLArena::GetCurrent()->AdoptCodeList(codeList);
+	else
+		m_MemPool.NewObj(codeList);
 	return codeList;
 }
 
@@ -16,7 +16,7 @@ class StmtMIRONode;
 class JumpMIRONode;
 class SwitchMIRONode;
 
-class MIRONode: public jit::TableIRNode<jit::RegisterInstance, uint16_t>
+class MIRONode: public jit::TableIRNode<jit::RegisterInstance, uint16_t>, public PFLArenaObject
 {
 	friend class CodeWriter;
 	private:
@@ -359,6 +359,53 @@ int RetVal;
 		return nbFAILURE;
 	}
 
+	return ExportNetILCode(NetILCode);
+}
+
+int nbNetPFLCompiler::CompileFilterSet(const vector<string> &NetPFLFilterStrings, char **NetILCode, bool optimizationCycles)
+{
+int RetVal;
+
+	if (m_debugLevel > 1)
+		nbPrintDebugLine("Compiling filter set...", DBG_TYPE_INFO, __FILE__, __FUNCTION__, __LINE__, 1);
+
+	ClearMsgList();
+	if (GenCode != NULL)
+	{
+		delete []GenCode;
+		GenCode = NULL;
+	}
+	*NetILCode= NULL;
+
+	if (!(PDLInited && PFLFrontEnd))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "NetPDL Compiler Engine has not been initialized, please use NetPDLInit().");
+		return nbFAILURE;
+	}
+
+	if (NetPFLFilterStrings.size() > nbNETPFLCOMPILER_MAX_FILTERSET_SIZE)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf),
+			"A filter set cannot contain more than %d filters.", nbNETPFLCOMPILER_MAX_FILTERSET_SIZE);
+		return nbFAILURE;
+	}
+
+	RetVal= PFLFrontEnd->CompileFilterSet(NetPFLFilterStrings, optimizationCycles); //RetVal can be: nbSUCCESS, nbFAILURE or nbWARNING
+
+	ErrorRecorder &errRecorder = PFLFrontEnd->GetErrRecorder();
+	FillMsgList(errRecorder);
+
+	if ((errRecorder.NumErrors() > 0) || (RetVal==nbFAILURE))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Failed to compile the NetPFL filter set");
+		return nbFAILURE;
+	}
+
+	return ExportNetILCode(NetILCode);
+}
+
+int nbNetPFLCompiler::ExportNetILCode(char **NetILCode)
+{
 	string &netIL = PFLFrontEnd->GetNetILFilter();
 	unsigned int codeStrLen = netIL.size() + 1;
 	GenCode = new char[codeStrLen];
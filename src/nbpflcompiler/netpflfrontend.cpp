@@ -344,22 +344,97 @@ PFLStatement *NetPFLFrontEnd::ParseFilter(string filter)
 	return parserInfo.Filter;//return the filtering expression
 }
 
-int NetPFLFrontEnd::CompileFilter(string filter, bool optimizationCycles)
+void NetPFLFrontEnd::NewCompilationUnit(string source)
 {
-
-	m_ErrorRecorder.Clear();
+	// the IR of the previous filter is released together with its arena
 	if (m_CompUnit != NULL)
 	{
 		delete m_CompUnit;
 		m_CompUnit = NULL;
 	}
 
+	m_CompUnit = new CompilationUnit(source);
+	CHECK_MEM_ALLOC(m_CompUnit);
+}
+
+int NetPFLFrontEnd::CompileFilter(string filter, bool optimizationCycles)
+{
+
+	m_ErrorRecorder.Clear();
+	NewCompilationUnit(filter);
+
+	//from the parse tree onwards, the IR of the filter is allocated in the arena of the compilation unit
+	PFLArena::Scope arenaScope(m_CompUnit->Arena);
+
 	PFLStatement *filterStmt = ParseFilter(filter);  //now we have the statement related to the filtering expression 
 	if (filterStmt == NULL)
 		//return false;
 		return nbFAILURE;
-	m_CompUnit = new CompilationUnit(filter);
-	CHECK_MEM_ALLOC(m_CompUnit);
+
+	return CompileStatement(filterStmt, filter, optimizationCycles);
+}
+
+int NetPFLFrontEnd::CompileFilterSet(const vector<string> &filters, bool optimizationCycles)
+{
+	string source;
+	int RetVal;
+
+	m_ErrorRecorder.Clear();
+	if (filters.size() == 0)
+	{
+		m_ErrorRecorder.PFLError("A filter set must contain at least one filter");
+		return nbFAILURE;
+	}
+
+	NewCompilationUnit(source);
+	PFLArena::Scope arenaScope(m_CompUnit->Arena);
+
+	for (uint32 i = 0; i < filters.size(); i++)
+	{
+		//an empty filter accepts every packet, hence it cannot be merged with the other ones
+		if (filters[i].size() == 0)
+		{
+			m_ErrorRecorder.PFLError("The filters of a filter set cannot be empty");
+			RetVal = nbFAILURE;
+			goto Cleanup;
+		}
+
+		PFLStatement *filterStmt = ParseFilter(filters[i]);
+		if ((filterStmt == NULL) || (m_ErrorRecorder.NumErrors() > 0))
+		{
+			RetVal = nbFAILURE;
+			goto Cleanup;
+		}
+		m_FilterSet.push_back(filterStmt);
+
+		//the filters of a set share the info partition, which holds the match bitmap
+		if (filterStmt->GetAction()->GetType() != PFL_RETURN_PACKET_ACTION)
+		{
+			m_ErrorRecorder.PFLError("The filters of a filter set cannot have actions other than returnpacket");
+			RetVal = nbFAILURE;
+			goto Cleanup;
+		}
+
+		if (i > 0)
+			source += "; ";
+		source += filters[i];
+	}
+
+	m_CompUnit->PFLSource = source;
+
+	//the statement drives the code generation, while the filters are taken from m_FilterSet
+	RetVal = CompileStatement(new PFLStatement(NULL, new PFLReturnPktAction(1), NULL), source, optimizationCycles);
+
+Cleanup:
+	for (uint32 i = 0; i < m_FilterSet.size(); i++)
+		delete m_FilterSet[i];
+	m_FilterSet.clear();
+	return RetVal;
+}
+
+int NetPFLFrontEnd::CompileStatement(PFLStatement *filterStmt, string filter, bool optimizationCycles)
+{
+	nbASSERT(m_CompUnit != NULL, "The compilation unit must be created before the filter is parsed");
 
 #ifdef ENABLE_PFLFRONTEND_PROFILING
 	int64_t TicksBefore, TicksAfter, TicksTotal, MeasureCost;
@@ -743,6 +818,10 @@ int NetPFLFrontEnd::CompileFilter(string filter, bool optimizationCycles)
 #ifdef ENABLE_PFLFRONTEND_PROFILING
 	TicksAfter= nbProfilerGetTime();
 	printf("\n\n\tNetIL generation required %ld ticks\n\n", TicksAfter - TicksBefore - MeasureCost);
+	printf("\tIR arena: %u objects (%lu bytes) in %u chunks (%lu bytes), %u deleted before the release\n\n",
+		m_CompUnit->Arena.GetNumAllocs(), (unsigned long) m_CompUnit->Arena.GetAllocBytes(),
+		m_CompUnit->Arena.GetNumChunks(), (unsigned long) m_CompUnit->Arena.GetChunkBytes(),
+		m_CompUnit->Arena.GetNumDeletes());
 #endif
 
 	if (m_GlobalInfo.Debugging.DebugLevel > 1)
@@ -823,7 +902,11 @@ int NetPFLFrontEnd::GenCode(PFLStatement *filterExpression)
 		TicksAutomatonBefore = nbProfilerGetTime();
 	#endif
 
-	EncapFSA *fsa = VisitFilterExpression(filterExpression->GetExpression(),fieldExtraction,toExtract);
+	EncapFSA *fsa;
+	if (m_FilterSet.empty())
+		fsa = VisitFilterExpression(filterExpression->GetExpression(),fieldExtraction,toExtract);
+	else
+		fsa = VisitFilterSet();
 	if(fsa==NULL)
 		return nbFAILURE; //an error occurred during the creation of the automaton
 		
@@ -857,6 +940,10 @@ int NetPFLFrontEnd::GenCode(PFLStatement *filterExpression)
     //we have to initialize the variables for the header indexing and the tunneled
 	GenHeaderIndexingCode(fsa);  
 	GenHeaderTunneledCode(fsa); 
+
+	// the match bitmap of a filter set is accumulated along the path, hence it starts empty for each packet
+	if (!m_FilterSet.empty())
+		GenClearMatchBitmapCode();
     
     m_fsa = fsa;
     
@@ -1009,6 +1096,65 @@ void NetPFLFrontEnd::GenFSACode(EncapFSA *fsa, SymbolLabel *trueLabel, SymbolLab
 }
 
 
+EncapFSA *NetPFLFrontEnd::VisitFilterSet(void)
+{
+	vector<EncapFSA*> fsaSet;
+	NodeList_t toExtract;
+
+	for (uint32 i = 0; i < m_FilterSet.size(); i++)
+	{
+		EncapFSA *fsa = VisitFilterExpression(m_FilterSet[i]->GetExpression(), false, toExtract);
+		if(fsa==NULL)
+			return NULL; //an error occurred during the creation of the automaton
+		fsaSet.push_back(fsa);
+	}
+
+	EncapFSA *result = EncapFSA::MergeFilterSet(fsaSet);
+
+	PRINT_DOT(result,"Just before returning from VisitFilterSet","visitfilterset_end");
+	return result;
+}
+
+/*
+ * Clears the match bitmap of a filter set in the info partition, before the packet is parsed.
+ */
+void NetPFLFrontEnd::GenClearMatchBitmapCode()
+{
+	uint32 numWords = (m_FilterSet.size() + 31) / 32;
+
+	m_MIRCodeGen->CommentStatement("clearing the match bitmap of the filter set");
+	for (uint32 word = 0; word < numWords; word++)
+		m_MIRCodeGen->GenStatement(m_MIRCodeGen->BinOp(IISTR, m_MIRCodeGen->TermNode(PUSH, (uint32) 0), m_MIRCodeGen->TermNode(PUSH, (uint32) (word * sizeof(uint32)))));
+}
+
+/*
+ * ORs the match bitmap of a state of a filter set into the info partition:
+ * bit (i % 32) of the word at offset (i / 32) * 4 is set if the i-th filter accepts in the state.
+ * The bits of the states traversed before are kept, so that overlapping filters (e.g. "ip" and "tcp")
+ * are all reported as matched.
+ */
+void NetPFLFrontEnd::GenMatchBitmapCode(EncapFSA::State *state)
+{
+	uint32 numWords = (m_FilterSet.size() + 31) / 32;
+	const std::set<uint32> &tags = state->GetMatchTags();
+
+	m_MIRCodeGen->CommentStatement("adding the filters accepting here to the match bitmap of the filter set");
+	for (uint32 word = 0; word < numWords; word++)
+	{
+		uint32 bitmap = 0;
+		for (std::set<uint32>::const_iterator t = tags.lower_bound(word * 32); (t != tags.end()) && (*t < (word + 1) * 32); t++)
+			bitmap |= 1U << (*t % 32);
+
+		if (bitmap == 0)
+			continue;
+
+		MIRNode *offset = m_MIRCodeGen->TermNode(PUSH, (uint32) (word * sizeof(uint32)));
+		MIRNode *current = m_MIRCodeGen->UnOp(ISSILD, m_MIRCodeGen->TermNode(PUSH, (uint32) (word * sizeof(uint32))));
+		m_MIRCodeGen->GenStatement(m_MIRCodeGen->BinOp(IISTR, m_MIRCodeGen->BinOp(OR, current, m_MIRCodeGen->TermNode(PUSH, bitmap)), offset));
+	}
+}
+
+
 EncapFSA *NetPFLFrontEnd::VisitFilterBinExpr(PFLBinaryExpression *expr, bool fieldExtraction, NodeList_t toExtract)
 {
 	EncapFSA *fsa1 = NULL;
@@ -1594,6 +1740,10 @@ void NetPFLFrontEnd::GenProtoCode(EncapFSA::State *stateFrom, //current state
 
   // 4) emit the middle ("fast") label
   m_MIRCodeGen->LabelStatement(curStateInfo->getLabelFast());
+
+  // if we are compiling a filter set, the headers of this state have been parsed: store the filters accepting here
+  if (!m_FilterSet.empty())
+    GenMatchBitmapCode(stateFrom);
   
   // 5) if we are in a final accepting state, we're done. Emit a jump and return
   if(stateFrom->isFinal())
@@ -89,6 +89,7 @@ private:
 	string              NetIL_FilterCode;
 	FieldsList_t        m_FieldsList;   //!< Fields that will be extracted
 	EncapFSA			*m_fsa;			//!< fsa related to the entire fitlering expression
+	vector<PFLStatement*> m_FilterSet;	//!< Filters compiled together by CompileFilterSet() (empty when compiling a single filter)
 
 #ifdef OPTIMIZE_SIZED_LOOPS
 	FieldsList_t        m_ReferredFieldsInFilter;
@@ -175,6 +176,11 @@ private:
 
 	EncapFSA *VisitFilterExpression(PFLExpression *expr, bool fieldExtraction, NodeList_t toExtract);
 
+	EncapFSA *VisitFilterSet(void);
+
+	void GenClearMatchBitmapCode();
+	void GenMatchBitmapCode(EncapFSA::State *state);
+
 	EncapFSA *VisitFilterBinExpr(PFLBinaryExpression *expr, bool fieldExtraction, NodeList_t toExtract);
 
 	EncapFSA *VisitFilterUnExpr(PFLUnaryExpression *expr, bool fieldExtraction, NodeList_t toExtract);
@@ -201,6 +207,10 @@ private:
 
 	PFLStatement *ParseFilter(string filter);
 
+	void NewCompilationUnit(string source);
+
+	int CompileStatement(PFLStatement *filterStmt, string filter, bool optimizationCycles);
+
 #ifdef OPTIMIZE_SIZED_LOOPS
 	void GetReferredFields(CodeList *code)
 	{
@@ -669,6 +679,8 @@ public:
 
 	int CompileFilter(string filter, bool optimizationCycles = true);//it can return nbSUCCESS, nbFAILURE or nbWARNING
 
+	int CompileFilterSet(const vector<string> &filters, bool optimizationCycles = true);//it can return nbSUCCESS, nbFAILURE or nbWARNING
+
 	ErrorRecorder &GetErrRecorder(void)
 
 	{
@@ -0,0 +1,150 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include "pflarena.h"
+#include "statements.h"
+#include <stdlib.h>
+#include <new>
+
+
+/*
+	Each object is preceded by a header that records the arena it belongs to (NULL for the
+	objects on the heap), so that FreeObject() knows what to do with it.
+*/
+union PFLArenaHeader
+{
+	PFLArena	*Owner;
+	char		Padding[PFL_ARENA_ALIGNMENT];
+};
+
+
+nbTHREAD_LOCAL PFLArena *PFLArena::m_Current = NULL;
+
+
+PFLArena::Scope::Scope(PFLArena &arena)
+	:m_Previous(PFLArena::m_Current)
+{
+	PFLArena::m_Current = &arena;
+}
+
+
+PFLArena::Scope::~Scope()
+{
+	PFLArena::m_Current = m_Previous;
+}
+
+
+PFLArena::PFLArena()
+	:m_Chunks(NULL), m_Free(NULL), m_End(NULL), m_NumAllocs(0), m_NumDeletes(0), m_NumChunks(0),
+	m_AllocBytes(0), m_ChunkBytes(0)
+{
+}
+
+
+PFLArena::~PFLArena()
+{
+	nbASSERT(m_Current != this, "The arena of a compilation unit is destroyed while it is in use");
+
+	// the statements of the code lists are in the arena, hence they must be deleted before the chunks
+	for (list<CodeList*>::iterator i = m_CodeLists.begin(); i != m_CodeLists.end(); i++)
+		delete (*i);
+	m_CodeLists.clear();
+
+	while (m_Chunks != NULL)
+	{
+		Chunk *next = m_Chunks->Next;
+		free(m_Chunks);
+		m_Chunks = next;
+	}
+}
+
+
+void *PFLArena::Alloc(size_t size)
+{
+	// the chunk header is padded as well, so that the objects keep their alignment
+	size_t chunkHeader = (sizeof(Chunk) + PFL_ARENA_ALIGNMENT - 1) & ~((size_t) PFL_ARENA_ALIGNMENT - 1);
+	char *ptr;
+
+	size = (size + PFL_ARENA_ALIGNMENT - 1) & ~((size_t) PFL_ARENA_ALIGNMENT - 1);
+
+	if ((size_t) (m_End - m_Free) < size)
+	{
+		size_t chunkSize = PFL_ARENA_CHUNK_SIZE;
+		Chunk *chunk;
+
+		// big objects get a chunk of their own, which is put behind the current one
+		if (size > PFL_ARENA_CHUNK_SIZE / 4)
+			chunkSize = chunkHeader + size;
+
+		chunk = (Chunk *) malloc(chunkSize);
+		if (chunk == NULL)
+			throw std::bad_alloc();
+
+		chunk->Size = chunkSize;
+		m_NumChunks++;
+		m_ChunkBytes += chunkSize;
+
+		if ((chunkSize != PFL_ARENA_CHUNK_SIZE) && (m_Chunks != NULL))
+		{
+			chunk->Next = m_Chunks->Next;
+			m_Chunks->Next = chunk;
+			m_NumAllocs++;
+			m_AllocBytes += size;
+			return ((char *) chunk) + chunkHeader;
+		}
+
+		chunk->Next = m_Chunks;
+		m_Chunks = chunk;
+		m_Free = ((char *) chunk) + chunkHeader;
+		m_End = ((char *) chunk) + chunkSize;
+	}
+
+	ptr = m_Free;
+	m_Free += size;
+	m_NumAllocs++;
+	m_AllocBytes += size;
+	return ptr;
+}
+
+
+void *PFLArena::AllocObject(size_t size)
+{
+	PFLArenaHeader *header;
+
+	if (m_Current != NULL)
+		header = (PFLArenaHeader *) m_Current->Alloc(sizeof(PFLArenaHeader) + size);
+	else
+		header = (PFLArenaHeader *) malloc(sizeof(PFLArenaHeader) + size);
+
+	if (header == NULL)
+		throw std::bad_alloc();
+
+	header->Owner = m_Current;
+	return header + 1;
+}
+
+
+void PFLArena::FreeObject(void *ptr)
+{
+	PFLArenaHeader *header;
+
+	if (ptr == NULL)
+		return;
+
+	header = ((PFLArenaHeader *) ptr) - 1;
+	if (header->Owner != NULL)
+		header->Owner->m_NumDeletes++;
+	else
+		free(header);
+}
+
+
+void PFLArena::AdoptCodeList(CodeList *codeList)
+{
+	m_CodeLists.push_back(codeList);
+}
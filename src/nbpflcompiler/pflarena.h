@@ -0,0 +1,142 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#pragma once
+
+
+#include "defs.h"
+#include <stddef.h>
+#include <list>
+
+using namespace std;
+
+class CodeList; //forward declaration
+
+
+//! Size of the chunks the arena allocates its objects from
+#define PFL_ARENA_CHUNK_SIZE	(64 * 1024)
+
+//! Alignment of the objects; it is also the size of the header that precedes each of them
+#define PFL_ARENA_ALIGNMENT		16
+
+
+/*!
+	\brief Bump allocator for the intermediate representation of a compilation unit
+
+	The parse tree of the filter, the HIR and MIR trees and statements, the MIRO nodes and the
+	basic blocks created while a filter is compiled are carved out of large chunks, which are
+	released all at once when the arena is destroyed (i.e. together with its compilation unit).
+
+	Objects are placed in the arena by their class operator new (see PFLArenaObject) while
+	the arena is the current one (see PFLArena::Scope); otherwise they are allocated on the heap.
+	The current arena is kept per thread, so that filters can be compiled concurrently by
+	different compilers.
+	Deleting an object of the arena still runs its destructor, but its memory is not reused
+	until the arena is released.
+*/
+class PFLArena
+{
+	struct Chunk
+	{
+		Chunk	*Next;		//!< Next chunk of the arena
+		size_t	Size;		//!< Size of the chunk, header included
+	};
+
+	Chunk				*m_Chunks;			//!< Chunks of the arena (the first one is the one in use)
+	char				*m_Free;			//!< First free byte of the current chunk
+	char				*m_End;				//!< End of the current chunk
+	list<CodeList*>		m_CodeLists;		//!< Code lists that are deleted when the arena is released
+
+	uint32				m_NumAllocs;		//!< Number of objects allocated in the arena
+	uint32				m_NumDeletes;		//!< Number of objects deleted before the arena was released
+	uint32				m_NumChunks;		//!< Number of chunks allocated
+	size_t				m_AllocBytes;		//!< Bytes requested by the objects (headers included)
+	size_t				m_ChunkBytes;		//!< Bytes allocated for the chunks
+
+	static nbTHREAD_LOCAL PFLArena	*m_Current;	//!< Arena in use for the new objects of the calling thread, if any
+
+	void *Alloc(size_t size);
+
+	PFLArena(const PFLArena &);
+	PFLArena &operator=(const PFLArena &);
+
+public:
+
+	/*!
+		\brief Makes an arena the current one of the calling thread for the lifetime of the object, then restores the previous one
+	*/
+	class Scope
+	{
+		PFLArena	*m_Previous;
+
+	public:
+		Scope(PFLArena &arena);
+		~Scope();
+	};
+
+	PFLArena();
+
+	/*!
+		\brief Deletes the code lists handed to the arena and frees all its chunks
+	*/
+	~PFLArena();
+
+	/*!
+		\brief Returns the current arena of the calling thread, or NULL if new objects go to the heap
+	*/
+	static PFLArena *GetCurrent(void)
+	{
+		return m_Current;
+	}
+
+	/*!
+		\brief Allocates an object in the current arena, or on the heap if no arena is in use
+
+		\param size size of the object
+		\return a pointer to the memory; it throws std::bad_alloc if the memory cannot be allocated
+	*/
+	static void *AllocObject(size_t size);
+
+	/*!
+		\brief Frees an object allocated by AllocObject()
+
+		Objects that are in an arena are released together with it.
+	*/
+	static void FreeObject(void *ptr);
+
+	/*!
+		\brief Hands a code list over to the arena, which deletes it when it is released
+
+		This is used for the temporary code lists created during the compilation, whose
+		statements are in the arena.
+	*/
+	void AdoptCodeList(CodeList *codeList);
+
+	uint32 GetNumAllocs(void) { return m_NumAllocs; }		//!< Returns the number of objects allocated in the arena
+	uint32 GetNumDeletes(void) { return m_NumDeletes; }		//!< Returns the number of objects deleted before the arena was released
+	uint32 GetNumChunks(void) { return m_NumChunks; }		//!< Returns the number of chunks allocated
+	size_t GetAllocBytes(void) { return m_AllocBytes; }		//!< Returns the bytes requested by the objects
+	size_t GetChunkBytes(void) { return m_ChunkBytes; }		//!< Returns the bytes allocated for the chunks
+};
+
+
+/*!
+	\brief Base class of the objects that can be allocated in the arena of a compilation unit
+*/
+struct PFLArenaObject
+{
+	static void *operator new(size_t size)
+	{
+		return PFLArena::AllocObject(size);
+	}
+
+	static void operator delete(void *ptr)
+	{
+		PFLArena::FreeObject(ptr);
+	}
+};
@@ -31,7 +31,7 @@ enum BBKind
 };
 
 
-struct PFLBasicBlock: public jit::BasicBlock<MIRONode>
+struct PFLBasicBlock: public jit::BasicBlock<MIRONode>, public PFLArenaObject
 {
 	typedef DiGraph<PFLBasicBlock*>::GraphNode node_t;
 	typedef PFLBasicBlock ThisType;
@@ -82,7 +82,7 @@ class PFLIndex;
 	\brief This class represents a single PFL statement, which is composed of a boolean filtering expression
 			and a corresponding action, like return packet or extract fields
 */
-class PFLStatement
+class PFLStatement: public PFLArenaObject
 {
 	PFLExpression		*m_Exp;		//The filtering expression
 	PFLAction		*m_Action;	//The corresponding action
@@ -118,7 +118,7 @@ public:
 /*!
 	\brief This class represents a generic PFL action
 */
-class PFLAction
+class PFLAction: public PFLArenaObject
 {
 	PFLActionType m_Type;	//!< the kind of action
 
@@ -227,7 +227,7 @@ public:
 	This class is not instantiable directly. You should use the derived
 	classes.
 */
-class PFLExpression
+class PFLExpression: public PFLArenaObject
 {
 private:
 	static uint32		m_Count;
@@ -337,7 +337,7 @@ public:
 };
 
 
-class PFLIndex
+class PFLIndex: public PFLArenaObject
 {
 	uint32 m_Index;
 
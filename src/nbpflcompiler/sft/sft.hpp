@@ -17,6 +17,7 @@
 #include <sstream>
 #include <fstream>
 #include <map>
+#include <set>
 #include <list>
 #include <stack>
 #include <assert.h>
@@ -94,6 +95,7 @@ public:
     bool    final; // no transitions get out from this state
     bool	Initial;//!< Initial flag (true if the state is initial)
     bool   	Visited;//!< Visited flag (true if, during a graph traversal, the node has already been visited)
+    std::set<uint32> MatchTags; //!< Filters of a filter set that accept in this state (empty if the FSA does not come from a filter set)
 
     /*!
       \brief Set the graph node corresponding to this state
@@ -136,7 +138,7 @@ public:
     */
     State(sftFsa *owner, const State &other)
       :Owner(owner), Id(other.Id), Info(other.Info), accept(other.accept),
-       final(other.final),Initial(other.Initial){}
+       final(other.final),Initial(other.Initial), MatchTags(other.MatchTags){}
 
     // Set the accepting status
     void setAccepting(bool accepting_status)
@@ -177,6 +179,30 @@ public:
       Info = i;
     }
 
+    /*!
+      \brief Marks the state as accepting for the filter 'tag' of a filter set
+    */
+    void AddMatchTag(uint32 tag)
+    {
+      MatchTags.insert(tag);
+    }
+
+    /*!
+      \brief Adds the given tags to the ones of this state
+    */
+    void AddMatchTags(const std::set<uint32> &tags)
+    {
+      MatchTags.insert(tags.begin(), tags.end());
+    }
+
+    /*!
+      \brief Returns the filters of a filter set that accept in this state
+    */
+    const std::set<uint32> &GetMatchTags() const
+    {
+      return MatchTags;
+    }
+
     /*!
       \brief Copy Constructor
       \param other another state
@@ -184,7 +210,7 @@ public:
     State(const State &other)
       :Owner(other.Owner), Id(other.Id), Info(other.Info), Node(other.Node),
        accept(other.accept), final(other.final), Initial(other.Initial),
-       Visited(other.Visited){}
+       Visited(other.Visited), MatchTags(other.MatchTags){}
 
 
     /*!
@@ -297,6 +323,7 @@ public:
       accept = other.accept;
       final = other.final;
       Initial = other.Initial;
+      MatchTags = other.MatchTags;
       return *this;
     }
 
@@ -10,6 +10,7 @@
 
 #include "defs.h"
 #include "errors.h"
+#include "pflarena.h"
 #include <string>
 #include <cassert>
 #include <iostream>
@@ -72,7 +73,7 @@ enum StmtFlags
 };
 
 
-struct StmtBase
+struct StmtBase: public PFLArenaObject
 {
 	uint16		Opcode;
 	StmtKind	Kind;
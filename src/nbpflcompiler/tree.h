@@ -10,6 +10,7 @@
 #include "defs.h"
 #include "symbols.h"
 #include "mironode.h"
+#include "pflarena.h"
 #include <stdio.h>
 			   //the last HIR opcode is HIR_LAST_OP and it is defined in irops.h
 
@@ -109,7 +110,7 @@ extern OpDescr OpDescriptions[];
 extern OpDescr NvmOps[];
 extern const char *IRTypeNames[];
 
-struct Node
+struct Node: public PFLArenaObject
 {
 friend struct StmtBase;
 
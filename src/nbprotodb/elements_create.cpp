@@ -25,7 +25,7 @@ struct _nbNetPDLElementBase *CreateElementGeneric(const Attributes& Attributes,
 {
 struct _nbNetPDLElementBase *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementBase *) malloc(sizeof(struct _nbNetPDLElementBase));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementBase);
 
 	if (NetPDLElement == NULL)
 	{
@@ -45,7 +45,7 @@ int VersionMajor, VersionMinor;
 
 	Attribute= GetXMLAttribute(Attributes, NETPDL_DATE_ATTR);
 
-	NetPDLDatabase->CreationDate= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLDatabase->CreationDate= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLDatabase->CreationDate == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -56,7 +56,7 @@ int VersionMajor, VersionMinor;
 
 	Attribute= GetXMLAttribute(Attributes, NETPDL_CREATOR_ATTR);
 
-	NetPDLDatabase->Creator= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLDatabase->Creator= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLDatabase->Creator == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -80,7 +80,7 @@ struct _nbNetPDLElementBase *CreateElementProto(const Attributes& Attributes, ch
 struct _nbNetPDLElementProto *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementProto *) malloc(sizeof(struct _nbNetPDLElementProto));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementProto);
 
 	if (NetPDLElement == NULL)
 	{
@@ -92,7 +92,7 @@ char* Attribute;
 	// Save the protocol name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -104,7 +104,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 	if (Attribute)
 	{
-		NetPDLElement->LongName= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->LongName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -118,7 +118,7 @@ char* Attribute;
 
 	if (Attribute)
 	{
-		NetPDLElement->ShowSumTemplateName= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->ShowSumTemplateName= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->ShowSumTemplateName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -136,7 +136,7 @@ struct _nbNetPDLElementBase *CreateElementExecuteX(const Attributes& Attributes,
 struct _nbNetPDLElementExecuteX *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementExecuteX *) malloc(sizeof(struct _nbNetPDLElementExecuteX));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementExecuteX);
 
 	if (NetPDLElement == NULL)
 	{
@@ -162,7 +162,7 @@ struct _nbNetPDLElementBase *CreateElementVariable(const Attributes& Attributes,
 struct _nbNetPDLElementVariable* NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementVariable *) malloc(sizeof(struct _nbNetPDLElementVariable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementVariable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -175,7 +175,7 @@ char* Attribute;
 	// Let's retrieve the variable name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -245,7 +245,7 @@ struct _nbNetPDLElementBase *CreateElementLookupTable(const Attributes& Attribut
 struct _nbNetPDLElementLookupTable* NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementLookupTable *) malloc(sizeof(struct _nbNetPDLElementLookupTable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementLookupTable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -257,7 +257,7 @@ char* Attribute;
 	// Let's retrieve the variable name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -294,7 +294,7 @@ struct _nbNetPDLElementBase *CreateElementKeyData(const Attributes& Attributes,
 struct _nbNetPDLElementKeyData *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementKeyData *) malloc(sizeof(struct _nbNetPDLElementKeyData));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementKeyData);
 
 	if (NetPDLElement == NULL)
 	{
@@ -318,7 +318,7 @@ char* Attribute;
 	}
 
 	// Let's store the name
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -406,7 +406,7 @@ char *VariableName, *OffsetStartAtPtr, *OffsetSizePtr, *TmpPtr;
 struct _nbNetPDLElementVariable *NetPDLVariableDef;
 unsigned int i;
 
-	NetPDLElement= (struct _nbNetPDLElementAssignVariable *) malloc(sizeof(struct _nbNetPDLElementAssignVariable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementAssignVariable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -439,7 +439,7 @@ unsigned int i;
 		NetPDLElement->OffsetSize= atoi(OffsetSizePtr);
 	}
 
-	NetPDLElement->VariableName= (char *) malloc(strlen(VariableName) + 1);
+	NetPDLElement->VariableName= (char *) ProtoDBAllocRaw(strlen(VariableName) + 1);
 	if (NetPDLElement->VariableName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -515,7 +515,7 @@ struct _nbNetPDLElementBase *CreateElementAlias(const Attributes& Attributes, ch
 struct _nbNetPDLElementAlias *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementAlias *) malloc(sizeof(struct _nbNetPDLElementAlias));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementAlias);
 
 	if (NetPDLElement == NULL)
 	{
@@ -527,7 +527,7 @@ char* Attribute;
 	// Save the alias name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -538,7 +538,7 @@ char* Attribute;
 	// Save the alias value
 	Attribute= GetXMLAttribute(Attributes, NETPDL_ALIAS_ATTR_REPLACEWITH);
 
-	NetPDLElement->ReplaceWith= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->ReplaceWith= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->ReplaceWith == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -557,7 +557,7 @@ char* Attribute;
 int RetVal;
 char *TableName, *FieldName, *OffsetStartAtPtr, *OffsetSizePtr, *TmpPtr;
 
-	NetPDLElement= (struct _nbNetPDLElementAssignLookupTable *) malloc(sizeof(struct _nbNetPDLElementAssignLookupTable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementAssignLookupTable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -598,7 +598,7 @@ char *TableName, *FieldName, *OffsetStartAtPtr, *OffsetSizePtr, *TmpPtr;
 	}
 
 
-	NetPDLElement->TableName= (char *) malloc(strlen(TableName) + 1);
+	NetPDLElement->TableName= (char *) ProtoDBAllocRaw(strlen(TableName) + 1);
 	if (NetPDLElement->TableName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -607,7 +607,7 @@ char *TableName, *FieldName, *OffsetStartAtPtr, *OffsetSizePtr, *TmpPtr;
 
 	memcpy(NetPDLElement->TableName, TableName, strlen(TableName) + 1);
 
-	NetPDLElement->FieldName= (char *) malloc(strlen(FieldName) + 1);
+	NetPDLElement->FieldName= (char *) ProtoDBAllocRaw(strlen(FieldName) + 1);
 	if (NetPDLElement->FieldName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -713,7 +713,7 @@ struct _nbNetPDLElementBase *CreateElementUpdateLookupTable(const Attributes& At
 struct _nbNetPDLElementUpdateLookupTable *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementUpdateLookupTable *) malloc(sizeof(struct _nbNetPDLElementUpdateLookupTable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementUpdateLookupTable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -725,7 +725,7 @@ char* Attribute;
 
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->TableName= (char *) malloc(strlen(Attribute) + 1);
+	NetPDLElement->TableName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 	if (NetPDLElement->TableName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -825,7 +825,7 @@ struct _nbNetPDLElementBase *CreateElementLookupKeyData(const Attributes& Attrib
 struct _nbNetPDLElementLookupKeyData *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementLookupKeyData *) malloc(sizeof(struct _nbNetPDLElementLookupKeyData));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementLookupKeyData);
 
 	if (NetPDLElement == NULL)
 	{
@@ -849,7 +849,7 @@ char* Attribute;
 
 				MaskLen= (int) strlen(&Attribute[2]) / 2;
 
-				NetPDLElement->Mask= (unsigned char *) malloc(MaskLen);
+				NetPDLElement->Mask= (unsigned char *) ProtoDBAllocRaw(MaskLen);
 
 				if (NetPDLElement->Mask == NULL)
 				{
@@ -890,7 +890,7 @@ struct _nbNetPDLElementBase *CreateElementShowTemplate(const Attributes& Attribu
 struct _nbNetPDLElementShowTemplate *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementShowTemplate *) malloc(sizeof(struct _nbNetPDLElementShowTemplate));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementShowTemplate);
 
 	if (NetPDLElement == NULL)
 	{
@@ -902,7 +902,7 @@ char* Attribute;
 	// Let's check the template name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_SHOWTEMPLATE_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -915,7 +915,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_DISPLAY_ATTR_CUSTOMPLUGIN);
 	if (Attribute)
 	{
-		NetPDLElement->PluginName= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->PluginName= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->PluginName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -984,7 +984,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_DISPLAY_ATTR_DISPLAYSEPARATOR);
 	if (Attribute)
 	{
-		NetPDLElement->Separator= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->Separator= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->Separator == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -1004,7 +1004,7 @@ struct _nbNetPDLElementBase *CreateElementShowSumTemplate(const Attributes& Attr
 struct _nbNetPDLElementShowSumTemplate *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementShowSumTemplate *) malloc(sizeof(struct _nbNetPDLElementShowSumTemplate));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementShowSumTemplate);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1016,7 +1016,7 @@ char* Attribute;
 	// Let's check the template name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_SHOWSUMTEMPLATE_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -1034,7 +1034,7 @@ struct _nbNetPDLElementBase *CreateElementSumSection(const Attributes& Attribute
 struct _nbNetPDLElementShowSumStructure *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementShowSumStructure *) malloc(sizeof(struct _nbNetPDLElementShowSumStructure));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementShowSumStructure);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1046,7 +1046,7 @@ char* Attribute;
 	// Save the section name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -1058,7 +1058,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 	if (Attribute)
 	{
-		NetPDLElement->LongName= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->LongName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -1076,7 +1076,7 @@ struct _nbNetPDLElementBase *CreateElementIf(const Attributes& Attributes, char
 struct _nbNetPDLElementIf *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementIf *) malloc(sizeof(struct _nbNetPDLElementIf));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementIf);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1100,7 +1100,7 @@ struct _nbNetPDLElementBase *CreateElementCase(const Attributes& Attributes, cha
 struct _nbNetPDLElementCase *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementCase *) malloc(sizeof(struct _nbNetPDLElementCase));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCase);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1139,7 +1139,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_CASE_ATTR_SHOW);
 	if (Attribute)
 	{
-		NetPDLElement->ShowString= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->ShowString= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 
 		if (NetPDLElement->ShowString == NULL)
 		{
@@ -1158,7 +1158,7 @@ struct _nbNetPDLElementBase *CreateElementDefault(const Attributes& Attributes,
 struct _nbNetPDLElementCase *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementCase *) malloc(sizeof(struct _nbNetPDLElementCase));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCase);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1171,7 +1171,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_CASE_ATTR_SHOW);
 	if (Attribute)
 	{
-		NetPDLElement->ShowString= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->ShowString= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 
 		if (NetPDLElement->ShowString == NULL)
 		{
@@ -1192,7 +1192,7 @@ struct _nbNetPDLElementSwitch *NetPDLElement;
 char* Attribute;
 int RetVal;
 
-	NetPDLElement= (struct _nbNetPDLElementSwitch *) malloc(sizeof(struct _nbNetPDLElementSwitch));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementSwitch);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1231,7 +1231,7 @@ struct _nbNetPDLElementBase *CreateElementLoop(const Attributes& Attributes, cha
 struct _nbNetPDLElementLoop *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementLoop *) malloc(sizeof(struct _nbNetPDLElementLoop));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementLoop);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1268,7 +1268,7 @@ struct _nbNetPDLElementBase *CreateElementLoopCtrl(const Attributes& Attributes,
 struct _nbNetPDLElementLoopCtrl *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementLoopCtrl *) malloc(sizeof(struct _nbNetPDLElementLoopCtrl));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementLoopCtrl);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1294,7 +1294,7 @@ struct _nbNetPDLElementBase *CreateElementIncludeBlk(const Attributes& Attribute
 struct _nbNetPDLElementIncludeBlk *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementIncludeBlk *) malloc(sizeof(struct _nbNetPDLElementIncludeBlk));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementIncludeBlk);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1306,7 +1306,7 @@ char* Attribute;
 	// Let's check the name of the block that has to be included
 	Attribute= GetXMLAttribute(Attributes, NETPDL_FIELD_INCLUDEBLK_NAME);
 
-	NetPDLElement->IncludedBlockName= (char *) malloc(strlen(Attribute) + 1);
+	NetPDLElement->IncludedBlockName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 	if (NetPDLElement->IncludedBlockName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1322,7 +1322,7 @@ struct _nbNetPDLElementBase *CreateElementBlock(const Attributes& Attributes, ch
 struct _nbNetPDLElementBlock *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementBlock *) malloc(sizeof(struct _nbNetPDLElementBlock));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementBlock);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1334,7 +1334,7 @@ char* Attribute;
 	// Let's check the node name
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 
-	NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+	NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 	if (NetPDLElement->Name == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1348,7 +1348,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 	if (Attribute)
 	{
-		NetPDLElement->LongName= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->LongName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1363,7 +1363,7 @@ char* Attribute;
 
 	if (Attribute)
 	{
-		NetPDLElement->ShowSumTemplateName= (char *) malloc(strlen(Attribute) + 1);
+		NetPDLElement->ShowSumTemplateName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 		if (NetPDLElement->ShowSumTemplateName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1385,7 +1385,7 @@ char* Attribute;
 
 	if (Attribute)
 	{
-		NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->Name == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1404,7 +1404,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 	if (Attribute)
 	{
-		NetPDLElement->LongName= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->LongName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1429,7 +1429,7 @@ char* Attribute;
 		Attribute= GetXMLAttribute(Attributes, NETPDL_FIELD_ATTR_SHOWTEMPLATE);
 		if (Attribute)
 		{
-			NetPDLElement->ShowTemplateName= (char *) malloc(strlen(Attribute) + 1);
+			NetPDLElement->ShowTemplateName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 			if (NetPDLElement->ShowTemplateName == NULL)
 			{
 				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1450,7 +1450,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_ADT_ATTR_BASEADT);
 	if (Attribute)
 	{
-		NetPDLElement->ADTRef= (char *) malloc(strlen(Attribute) + 1);
+		NetPDLElement->ADTRef= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 		if (NetPDLElement->ADTRef == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1591,7 +1591,7 @@ struct _nbNetPDLElementBase *CreateElementFieldFixed(const Attributes& Attribute
 struct _nbNetPDLElementFieldFixed *NetPDLElement;
 char *Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldFixed *) malloc(sizeof(struct _nbNetPDLElementFieldFixed));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldFixed);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1619,7 +1619,7 @@ struct _nbNetPDLElementBase *CreateElementFieldVariable(const Attributes& Attrib
 struct _nbNetPDLElementFieldVariable *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldVariable *) malloc(sizeof(struct _nbNetPDLElementFieldVariable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldVariable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1648,7 +1648,7 @@ struct _nbNetPDLElementBase *CreateElementFieldTokenEnded(const Attributes& Attr
 struct _nbNetPDLElementFieldTokenEnded *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldTokenEnded *) malloc(sizeof(struct _nbNetPDLElementFieldTokenEnded));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldTokenEnded);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1681,7 +1681,7 @@ char* Attribute;
 
 		NetPDLElement->EndRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-		NetPDLElement->EndPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+		NetPDLElement->EndPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 		if (NetPDLElement->EndPCRECompiledRegExp == NULL)
 		{
@@ -1718,7 +1718,7 @@ struct _nbNetPDLElementBase *CreateElementFieldTokenWrapped(const Attributes& At
 struct _nbNetPDLElementFieldTokenWrapped *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldTokenWrapped *) malloc(sizeof(struct _nbNetPDLElementFieldTokenWrapped));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldTokenWrapped);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1752,7 +1752,7 @@ char* Attribute;
 
 		NetPDLElement->BeginRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-		NetPDLElement->BeginPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->BeginRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+		NetPDLElement->BeginPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->BeginRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 		if (NetPDLElement->BeginPCRECompiledRegExp == NULL)
 		{
@@ -1786,7 +1786,7 @@ char* Attribute;
 
 		NetPDLElement->EndRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-		NetPDLElement->EndPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+		NetPDLElement->EndPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 		if (NetPDLElement->EndPCRECompiledRegExp == NULL)
 		{
@@ -1829,7 +1829,7 @@ struct _nbNetPDLElementBase *CreateElementFieldLine(const Attributes& Attributes
 {
 struct _nbNetPDLElementFieldLine *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldLine *) malloc(sizeof(struct _nbNetPDLElementFieldLine));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldLine);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1852,7 +1852,7 @@ int PCREFlags= 0;
 int PCREErrorOffset;
 const char *PCREErrorPtr;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldPattern *) malloc(sizeof(struct _nbNetPDLElementFieldPattern));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldPattern);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1870,7 +1870,7 @@ const char *PCREErrorPtr;
 
 	NetPDLElement->PatternRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-	NetPDLElement->PatternPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->PatternRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+	NetPDLElement->PatternPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->PatternRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 	if (NetPDLElement->PatternPCRECompiledRegExp == NULL)
 	{
@@ -1899,7 +1899,7 @@ struct _nbNetPDLElementBase *CreateElementFieldEatall(const Attributes& Attribut
 {
 struct _nbNetPDLElementFieldEatall *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldEatall *) malloc(sizeof(struct _nbNetPDLElementFieldEatall));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldEatall);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1919,7 +1919,7 @@ struct _nbNetPDLElementBase *CreateElementFieldPadding(const Attributes& Attribu
 struct _nbNetPDLElementFieldPadding *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldPadding *) malloc(sizeof(struct _nbNetPDLElementFieldPadding));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldPadding);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1947,7 +1947,7 @@ struct _nbNetPDLElementBase *CreateElementFieldPlugin(const Attributes& Attribut
 struct _nbNetPDLElementFieldPlugin *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldPlugin *) malloc(sizeof(struct _nbNetPDLElementFieldPlugin));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldPlugin);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1963,7 +1963,7 @@ char* Attribute;
 	if (Attribute == NULL)
 		return NULL;
 
-	NetPDLElement->PluginName= (char *) malloc(strlen(Attribute) + 1);
+	NetPDLElement->PluginName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 	if (NetPDLElement->PluginName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -1981,7 +1981,7 @@ char* Attribute;
 char TmpBuf[NETPDL_MAX_STRING + 1];
 struct _nbNetPDLElementFieldBit *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldBit *) malloc(sizeof(struct _nbNetPDLElementFieldBit));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldBit);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2004,7 +2004,7 @@ struct _nbNetPDLElementFieldBit *NetPDLElement;
 	// Convert the mask in hex and store in the appropriate struct member
 	ssnprintf(TmpBuf, sizeof(TmpBuf), "%0*x", MaskLength - 2, NetPDLElement->BitMask);
 
-	NetPDLElement->BitMaskString= (char *) malloc(sizeof(char) * (strlen(TmpBuf) + 1));
+	NetPDLElement->BitMaskString= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(TmpBuf) + 1));
 	if (NetPDLElement->BitMaskString == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2029,7 +2029,7 @@ struct _nbNetPDLElementCfieldTLV *NetPDLElement;
 char* Attribute;
 int RetVal;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldTLV *) malloc(sizeof(struct _nbNetPDLElementCfieldTLV));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldTLV);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2089,7 +2089,7 @@ int PCREFlags= 0;
 int PCREErrorOffset;
 const char *PCREErrorPtr;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldDelimited *) malloc(sizeof(struct _nbNetPDLElementCfieldDelimited));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldDelimited);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2107,7 +2107,7 @@ const char *PCREErrorPtr;
 	{
 		NetPDLElement->BeginRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-		NetPDLElement->BeginPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->BeginRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+		NetPDLElement->BeginPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->BeginRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 		if (NetPDLElement->BeginPCRECompiledRegExp == NULL)
 		{
@@ -2126,7 +2126,7 @@ const char *PCREErrorPtr;
 
 	NetPDLElement->EndRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-	NetPDLElement->EndPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+	NetPDLElement->EndPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->EndRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 	if (NetPDLElement->EndPCRECompiledRegExp == NULL)
 	{
@@ -2166,7 +2166,7 @@ struct _nbNetPDLElementBase *CreateElementCfieldLine(const Attributes& Attribute
 struct _nbNetPDLElementCfieldLine *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldLine *) malloc(sizeof(struct _nbNetPDLElementCfieldLine));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldLine);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2207,7 +2207,7 @@ int PCREFlags= 0;
 int PCREErrorOffset;
 const char *PCREErrorPtr;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldHdrline *) malloc(sizeof(struct _nbNetPDLElementCfieldHdrline));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldHdrline);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2225,7 +2225,7 @@ const char *PCREErrorPtr;
 	
 	NetPDLElement->SeparatorRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-	NetPDLElement->SeparatorPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->SeparatorRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+	NetPDLElement->SeparatorPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->SeparatorRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 	if (NetPDLElement->SeparatorPCRECompiledRegExp == NULL)
 	{
@@ -2268,7 +2268,7 @@ const char *PCREErrorPtr;
 int PCRENameEntrySize;
 char *PCRENameTable;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldDynamic *) malloc(sizeof(struct _nbNetPDLElementCfieldDynamic));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldDynamic);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2286,7 +2286,7 @@ char *PCRENameTable;
 
 	NetPDLElement->PatternRegularExpression= AllocateAsciiString(Attribute, NULL, 1, 1);
 
-	NetPDLElement->PatternPCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->PatternRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+	NetPDLElement->PatternPCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->PatternRegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 	if (NetPDLElement->PatternPCRECompiledRegExp == NULL)
 	{
@@ -2304,7 +2304,7 @@ char *PCRENameTable;
 		pcre_fullinfo((pcre *) NetPDLElement->PatternPCRECompiledRegExp, NULL, PCRE_INFO_NAMETABLE, (void *) &PCRENameTable) != 0)
 		return NULL;
 
-	NetPDLElement->NamesList= (char **) malloc(sizeof(char *) * NetPDLElement->NamesListNItems);
+	NetPDLElement->NamesList= (char **) ProtoDBAllocPointers(NetPDLElement->NamesListNItems);
 
 	if (NetPDLElement->NamesList == NULL)
 		return NULL;
@@ -2333,7 +2333,7 @@ struct _nbNetPDLElementBase *CreateElementCfieldASN1(const Attributes& Attribute
 struct _nbNetPDLElementCfieldASN1 *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldASN1 *) malloc(sizeof(struct _nbNetPDLElementCfieldASN1));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldASN1);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2371,7 +2371,7 @@ struct _nbNetPDLElementBase *CreateElementCfieldXML(const Attributes& Attributes
 struct _nbNetPDLElementCfieldXML *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementCfieldXML *) malloc(sizeof(struct _nbNetPDLElementCfieldXML));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementCfieldXML);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2408,31 +2408,31 @@ char* Attribute;
 	if (strcmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_TLV_TYPE) == 0)
 	{
 		NetPDLElement->Portion= nbNETPDL_ID_SUBFIELD_PORTION_TLV_TYPE;
-		NetPDLElement->PortionName= NETPDL_SUBFIELD_NAME_TLV_TYPE;
+		NetPDLElement->PortionName= ProtoDBStrdup(NETPDL_SUBFIELD_NAME_TLV_TYPE);
 		goto CreateSubfieldBase_EndPortionCheck;
 	}
 	if (strcmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_TLV_LENGTH) == 0)
 	{
 		NetPDLElement->Portion= nbNETPDL_ID_SUBFIELD_PORTION_TLV_LENGTH;
-		NetPDLElement->PortionName= NETPDL_SUBFIELD_NAME_TLV_LENGTH;
+		NetPDLElement->PortionName= ProtoDBStrdup(NETPDL_SUBFIELD_NAME_TLV_LENGTH);
 		goto CreateSubfieldBase_EndPortionCheck;
 	}
 	if (strcmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_TLV_VALUE) == 0)
 	{
 		NetPDLElement->Portion= nbNETPDL_ID_SUBFIELD_PORTION_TLV_VALUE;
-		NetPDLElement->PortionName= NETPDL_SUBFIELD_NAME_TLV_VALUE;
+		NetPDLElement->PortionName= ProtoDBStrdup(NETPDL_SUBFIELD_NAME_TLV_VALUE);
 		goto CreateSubfieldBase_EndPortionCheck;
 	}
 	if (strcmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_HDRLINE_HNAME) == 0)
 	{
 		NetPDLElement->Portion= nbNETPDL_ID_SUBFIELD_PORTION_HDRLINE_HNAME;
-		NetPDLElement->PortionName= NETPDL_SUBFIELD_NAME_HDRLINE_HNAME;
+		NetPDLElement->PortionName= ProtoDBStrdup(NETPDL_SUBFIELD_NAME_HDRLINE_HNAME);
 		goto CreateSubfieldBase_EndPortionCheck;
 	}
 	if (strcmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_HDRLINE_HVALUE) == 0)
 	{
 		NetPDLElement->Portion= nbNETPDL_ID_SUBFIELD_PORTION_HDRLINE_HVALUE;
-		NetPDLElement->PortionName= NETPDL_SUBFIELD_NAME_HDRLINE_HVALUE;
+		NetPDLElement->PortionName= ProtoDBStrdup(NETPDL_SUBFIELD_NAME_HDRLINE_HVALUE);
 		goto CreateSubfieldBase_EndPortionCheck;
 	}
 	if (strncmp(Attribute, NETPDL_SUBFIELD_ATTR_PORTION_DYNAMIC_, strlen(NETPDL_SUBFIELD_ATTR_PORTION_DYNAMIC_)) == 0)
@@ -2455,6 +2455,13 @@ char* Attribute;
 
 CreateSubfieldBase_EndPortionCheck:
 
+	// The name is copied in the database even when it is a constant, so that it can be saved into an image
+	if (NetPDLElement->PortionName == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
+		return nbFAILURE;
+	}
+
 	return GetFieldBaseInfo((struct _nbNetPDLElementFieldBase *) NetPDLElement, true, Attributes, ErrBuf, ErrBufSize);
 }
 
@@ -2464,7 +2471,7 @@ struct _nbNetPDLElementBase *CreateElementSubfield(const Attributes& Attributes,
 struct _nbNetPDLElementSubfield *NetPDLElement;
 char *Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementSubfield *) malloc(sizeof(struct _nbNetPDLElementSubfield));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementSubfield);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2581,7 +2588,7 @@ struct _nbNetPDLElementMapBase *NetPDLElement;
 
 	if (Attribute)
 	{
-		NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->Name == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2594,7 +2601,7 @@ struct _nbNetPDLElementMapBase *NetPDLElement;
 		Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 		if (Attribute)
 		{
-			NetPDLElement->LongName= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+			NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 			if (NetPDLElement->LongName == NULL)
 			{
 				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2617,7 +2624,7 @@ struct _nbNetPDLElementMapBase *NetPDLElement;
 		Attribute= GetXMLAttribute(Attributes, NETPDL_FIELD_ATTR_SHOWTEMPLATE);
 		if (Attribute)
 		{
-			NetPDLElement->ShowTemplateName= (char *) malloc(strlen(Attribute) + 1);
+			NetPDLElement->ShowTemplateName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 			if (NetPDLElement->ShowTemplateName == NULL)
 			{
 				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2636,7 +2643,7 @@ struct _nbNetPDLElementBase *CreateElementMapXMLPI(const Attributes& Attributes,
 struct _nbNetPDLElementMapXMLPI *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementMapXMLPI *) malloc(sizeof(struct _nbNetPDLElementMapXMLPI));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementMapXMLPI);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2660,7 +2667,7 @@ struct _nbNetPDLElementBase *CreateElementMapXMLDoctype(const Attributes& Attrib
 {
 struct _nbNetPDLElementMapXMLDoctype *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementMapXMLDoctype *) malloc(sizeof(struct _nbNetPDLElementMapXMLDoctype));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementMapXMLDoctype);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2680,7 +2687,7 @@ struct _nbNetPDLElementBase *CreateElementMapXMLElement(const Attributes& Attrib
 struct _nbNetPDLElementMapXMLElement *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementMapXMLElement *) malloc(sizeof(struct _nbNetPDLElementMapXMLElement));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementMapXMLElement);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2732,7 +2739,7 @@ struct _nbNetPDLElementFieldmatch *NetPDLElement;
 char* Attribute;
 int RetVal;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldmatch *) malloc(sizeof(struct _nbNetPDLElementFieldmatch));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldmatch);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2774,7 +2781,7 @@ struct _nbNetPDLElementBase *CreateElementAdtfield(const Attributes& Attributes,
 struct _nbNetPDLElementAdtfield *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementAdtfield *) malloc(sizeof(struct _nbNetPDLElementAdtfield));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementAdtfield);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2793,7 +2800,7 @@ char* Attribute;
 		return NULL;
 	}
 
-	NetPDLElement->CalledADTName= (char *) malloc(strlen(Attribute) + 1);
+	NetPDLElement->CalledADTName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 	if (NetPDLElement->CalledADTName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2817,7 +2824,7 @@ struct _nbNetPDLElementReplace *NetPDLElement;
 char* Attribute;
 ////unsigned int FieldToRenameIndex;
 
-	NetPDLElement= (struct _nbNetPDLElementReplace *) malloc(sizeof(struct _nbNetPDLElementReplace));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementReplace);
 
 	if (NetPDLElement == NULL)
 	{
@@ -2836,7 +2843,7 @@ char* Attribute;
 		return NULL;
 	}
 
-	NetPDLElement->FieldToRename= (char *) malloc(strlen(Attribute) + 1);
+	NetPDLElement->FieldToRename= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 	if (NetPDLElement->FieldToRename == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2855,7 +2862,7 @@ char* Attribute;
 	//{
 	//	if ( strncmp(&Attribute[FieldToRenameIndex], NETPDL_COMMON_SYNTAX_SEP_ADTREF, strlen(NETPDL_COMMON_SYNTAX_SEP_ADTREF)) == 0 )
 	//	{
-	//		NetPDLElement->ADTName= (char *) malloc(sizeof(char) * (FieldToRenameIndex + 1));
+	//		NetPDLElement->ADTName= (char *) ProtoDBAllocRaw(sizeof(char) * (FieldToRenameIndex + 1));
 	//		if (NetPDLElement->ADTName == NULL)
 	//		{
 	//			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2866,7 +2873,7 @@ char* Attribute;
 
 	//		FieldToRenameIndex+= strlen(NETPDL_COMMON_SYNTAX_SEP_ADTREF);
 
-	//		NetPDLElement->FieldToRename= (char *) malloc(sizeof(char) * (strlen(&Attribute[FieldToRenameIndex]) + 1));
+	//		NetPDLElement->FieldToRename= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(&Attribute[FieldToRenameIndex]) + 1));
 	//		if (NetPDLElement->FieldToRename == NULL)
 	//		{
 	//			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2892,7 +2899,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_NAME);
 	if (Attribute)
 	{
-		NetPDLElement->Name= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->Name == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2905,7 +2912,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_COMMON_ATTR_LONGNAME);
 	if (Attribute)
 	{
-		NetPDLElement->LongName= (char *) malloc(sizeof(char) * (strlen(Attribute) + 1));
+		NetPDLElement->LongName= (char *) ProtoDBAllocRaw(sizeof(char) * (strlen(Attribute) + 1));
 		if (NetPDLElement->LongName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2918,7 +2925,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_FIELD_ATTR_SHOWTEMPLATE);
 	if (Attribute)
 	{
-		NetPDLElement->ShowTemplateName= (char *) malloc(strlen(Attribute) + 1);
+		NetPDLElement->ShowTemplateName= (char *) ProtoDBAllocRaw(strlen(Attribute) + 1);
 		if (NetPDLElement->ShowTemplateName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating internal structures.");
@@ -2936,7 +2943,7 @@ struct _nbNetPDLElementBase *CreateElementSet(const Attributes& Attributes, char
 char* Attribute;
 struct _nbNetPDLElementSet *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementSet *) malloc(sizeof(struct _nbNetPDLElementSet));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementSet);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3010,7 +3017,7 @@ char* Attribute;
 struct _nbNetPDLElementExitWhen *NetPDLElement;
 int RetVal;
 
-	NetPDLElement= (struct _nbNetPDLElementExitWhen *) malloc(sizeof(struct _nbNetPDLElementExitWhen));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementExitWhen);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3034,7 +3041,7 @@ struct _nbNetPDLElementBase *CreateElementDefaultItem(const Attributes& Attribut
 {
 struct _nbNetPDLElementFieldmatch *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementFieldmatch *) malloc(sizeof(struct _nbNetPDLElementFieldmatch));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementFieldmatch);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3057,7 +3064,7 @@ struct _nbNetPDLElementBase *CreateElementChoice(const Attributes& Attributes, c
 char* Attribute;
 struct _nbNetPDLElementChoice *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLElementChoice *) malloc(sizeof(struct _nbNetPDLElementChoice));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementChoice);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3130,7 +3137,7 @@ struct _nbNetPDLElementBase *CreateElementAdt(const Attributes& Attributes, char
 struct _nbNetPDLElementAdt *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementAdt *) malloc(sizeof(struct _nbNetPDLElementAdt));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementAdt);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3272,7 +3279,7 @@ struct _nbNetPDLElementBase *CreateElementNextProto(const Attributes& Attributes
 struct _nbNetPDLElementNextProto *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementNextProto *) malloc(sizeof(struct _nbNetPDLElementNextProto));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementNextProto);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3296,7 +3303,7 @@ struct _nbNetPDLElementBase *CreateElementShowCodeProtoField(const Attributes& A
 struct _nbNetPDLElementProtoField *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementProtoField *) malloc(sizeof(struct _nbNetPDLElementProtoField));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementProtoField);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3340,7 +3347,7 @@ char* Attribute;
 
 	if (Attribute)
 	{
-		NetPDLElement->FieldName= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->FieldName= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->FieldName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -3358,7 +3365,7 @@ struct _nbNetPDLElementBase *CreateElementShowCodeProtoHdr(const Attributes& Att
 struct _nbNetPDLElementProtoHdr *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementProtoHdr *) malloc(sizeof(struct _nbNetPDLElementProtoHdr));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementProtoHdr);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3406,7 +3413,7 @@ struct _nbNetPDLElementBase *CreateElementShowCodePacketHdr(const Attributes& At
 struct _nbNetPDLElementPacketHdr *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementPacketHdr *) malloc(sizeof(struct _nbNetPDLElementPacketHdr));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementPacketHdr);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3439,7 +3446,7 @@ struct _nbNetPDLElementBase *CreateElementShowCodeText(const Attributes& Attribu
 struct _nbNetPDLElementText *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementText *) malloc(sizeof(struct _nbNetPDLElementText));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementText);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3452,7 +3459,7 @@ char* Attribute;
 	Attribute= GetXMLAttribute(Attributes, NETPDL_SHOW_TEXT_ATTR_VALUE);
 	if (Attribute)
 	{
-		NetPDLElement->Value= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->Value= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->Value == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -3495,7 +3502,7 @@ struct _nbNetPDLElementBase *CreateElementShowCodeSection(const Attributes& Attr
 struct _nbNetPDLElementSection *NetPDLElement;
 char* Attribute;
 
-	NetPDLElement= (struct _nbNetPDLElementSection *) malloc(sizeof(struct _nbNetPDLElementSection));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLElementSection);
 
 	if (NetPDLElement == NULL)
 	{
@@ -3513,7 +3520,7 @@ char* Attribute;
 	}
 	else
 	{
-		NetPDLElement->SectionName= (char *) malloc(sizeof(char) * strlen(Attribute) + 1);
+		NetPDLElement->SectionName= (char *) ProtoDBAllocRaw(sizeof(char) * strlen(Attribute) + 1);
 		if (NetPDLElement->SectionName == NULL)
 		{
 			errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -3587,7 +3594,7 @@ int EventType;
 	}
 
 	// ... and, if everything is fine, let's allocate the struct
-	*CallHandlerInfo= (struct _nbCallHandlerInfo *) malloc(sizeof(struct _nbCallHandlerInfo));
+	*CallHandlerInfo= ProtoDBAllocStruct(_nbCallHandlerInfo);
 	if (*CallHandlerInfo == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -3595,7 +3602,7 @@ int EventType;
 	}
 	memset(*CallHandlerInfo, 0, sizeof(struct _nbCallHandlerInfo));
 
-	(*CallHandlerInfo)->FunctionName= (char *) malloc(sizeof(char) * (Event - CallHandleAttribute));
+	(*CallHandlerInfo)->FunctionName= (char *) ProtoDBAllocRaw(sizeof(char) * (Event - CallHandleAttribute));
 	if ((*CallHandlerInfo)->FunctionName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for building the protocol database.");
@@ -20,6 +20,7 @@
 #include "../nbee/utils/netpdlutils.h"
 #include "expr-grammar.tab.h"
 #include "expressions.h"
+#include "protodb_heap.h"
 
 
 
@@ -62,7 +63,7 @@ int StringLen;
 	}
 
 
-	*AllocatedExprString= (char *) malloc(sizeof(char) * StringLen);
+	*AllocatedExprString= (char *) ProtoDBAllocRaw(sizeof(char) * StringLen);
 
 	if (*AllocatedExprString == NULL)
 	{
@@ -244,7 +245,7 @@ struct _nbNetPDLExprNumber *CreateNumberItem(const char *Token, int Radix)
 {
 struct _nbNetPDLExprNumber *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprNumber *) malloc(sizeof(struct _nbNetPDLExprNumber));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprNumber);
 
 	if (NetPDLElement == NULL)
 	{
@@ -272,7 +273,7 @@ struct _nbNetPDLExprString* CreateStringItem(const char *AsciiString)
 {
 struct _nbNetPDLExprString *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprString *) malloc(sizeof(struct _nbNetPDLExprString));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprString);
 
 	if (NetPDLElement == NULL)
 	{
@@ -300,7 +301,7 @@ struct _nbNetPDLExprString *NetPDLElement;
 
 	// Buffer containing the string has been allocated in the lexical parser
 	// So, let's free it now
-	free((char *) AsciiString);
+	ProtoDBFree((char *) AsciiString);
 
 	if (NetPDLElement->Value == NULL)
 		return NULL;
@@ -314,7 +315,7 @@ struct _nbNetPDLExprProtoRef *CreateProtocolReferenceItem(const char *Token)
 struct _nbNetPDLExprProtoRef *NetPDLElement;
 int StringSize;
 
-	NetPDLElement= (struct _nbNetPDLExprProtoRef *) malloc(sizeof(struct _nbNetPDLExprProtoRef));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprProtoRef);
 
 	if (NetPDLElement == NULL)
 	{
@@ -330,7 +331,7 @@ int StringSize;
 	// Copy variable name into the new structure
 	StringSize= (int) strlen(Token) - 1;
 
-	NetPDLElement->ProtocolName= (char *) malloc(sizeof(char) * StringSize + 1);
+	NetPDLElement->ProtocolName= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 	if (NetPDLElement->ProtocolName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -356,7 +357,7 @@ struct _nbNetPDLExprOperator *CreateOperatorItem(int Token)
 {
 struct _nbNetPDLExprOperator *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprOperator *) malloc(sizeof(struct _nbNetPDLExprOperator));
+	NetPDLElement= (struct _nbNetPDLExprOperator *) ProtoDBAllocRaw(sizeof(struct _nbNetPDLExprOperator));
 
 	if (NetPDLElement == NULL)
 	{
@@ -442,7 +443,7 @@ unsigned int i;
 			struct _nbNetPDLExprVariable *NetPDLElement;
 			int StringSize;
 
-				NetPDLElement= (struct _nbNetPDLExprVariable *) malloc(sizeof(struct _nbNetPDLExprVariable));
+				NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprVariable);
 
 				if (NetPDLElement == NULL)
 				{
@@ -457,7 +458,7 @@ unsigned int i;
 				// Copy variable name in the new structure
 				StringSize= (int) strlen(Token);
 
-				NetPDLElement->Name= (char *) malloc(sizeof(char) * StringSize + 1);
+				NetPDLElement->Name= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 				if (NetPDLElement->Name == NULL)
 				{
 					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -526,7 +527,7 @@ unsigned int i;
 			struct _nbNetPDLExprLookupTable *NetPDLElement;
 			int StringSize;
 
-				NetPDLElement= (struct _nbNetPDLExprLookupTable *) malloc(sizeof(struct _nbNetPDLExprLookupTable));
+				NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprLookupTable);
 
 				if (NetPDLElement == NULL)
 				{
@@ -540,7 +541,7 @@ unsigned int i;
 				// Copy lookup table name in the new structure
 				StringSize= (int) strlen(Token);
 
-				NetPDLElement->TableName= (char *) malloc(sizeof(char) * StringSize + 1);
+				NetPDLElement->TableName= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 				if (NetPDLElement->TableName == NULL)
 				{
 					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -590,7 +591,7 @@ char *FieldNamePtr;
 int StringSize;
 
 
-	NetPDLElement= (struct _nbNetPDLExprLookupTable *) malloc(sizeof(struct _nbNetPDLExprLookupTable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprLookupTable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -608,7 +609,7 @@ int StringSize;
 
 	StringSize= (int) strlen(Token);
 
-	NetPDLElement->TableName= (char *) malloc(sizeof(char) * StringSize + 1);
+	NetPDLElement->TableName= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 	if (NetPDLElement->TableName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -621,7 +622,7 @@ int StringSize;
 	// Let's copy the field name
 	StringSize= (int) strlen(FieldNamePtr);
 
-	NetPDLElement->FieldName= (char *) malloc(sizeof(char) * StringSize + 1);
+	NetPDLElement->FieldName= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 	if (NetPDLElement->FieldName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -749,7 +750,7 @@ struct _nbNetPDLExprFieldRef* CreateProtoFieldItem(const char *Token)
 struct _nbNetPDLExprFieldRef *NetPDLElement;
 int StringSize;
 
-	NetPDLElement= (struct _nbNetPDLExprFieldRef *) malloc(sizeof(struct _nbNetPDLExprFieldRef));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFieldRef);
 
 	if (NetPDLElement == NULL)
 	{
@@ -769,7 +770,7 @@ int StringSize;
 	// Copy fieldref name into the new structure
 	StringSize= (int) strlen(Token);
 
-	NetPDLElement->FieldName= (char *) malloc(sizeof(char) * StringSize + 1);
+	NetPDLElement->FieldName= (char *) ProtoDBAllocRaw(sizeof(char) * StringSize + 1);
 	if (NetPDLElement->FieldName == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -837,7 +838,7 @@ struct _nbNetPDLExpression *NetPDLElement;
 struct _nbNetPDLExprOperator *OperatorElement;
 struct _nbNetPDLExprBase *OperandElement1, *OperandElement2;
 
-	NetPDLElement= (struct _nbNetPDLExpression *) malloc(sizeof(struct _nbNetPDLExpression));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExpression);
 
 	if (NetPDLElement == NULL)
 	{
@@ -934,7 +935,7 @@ char *BufferPtr;
 
 	// The string does not have the \0 at the end (since it may be a binary string),
 	// so let's allocate the 'net' size
-	BufferPtr= (char *) malloc(sizeof(char) * SizeToBeAllocated);
+	BufferPtr= (char *) ProtoDBAllocRaw(sizeof(char) * SizeToBeAllocated);
 	if (BufferPtr == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ParserErrorBuffer, ParserErrorBufferSize, "Not enough memory for building the protocol database.");
@@ -974,7 +975,7 @@ struct _nbNetPDLExprFunctionIsASN1Type* CreateFunctionIsASN1Type(struct _nbNetPD
 {
 struct _nbNetPDLExprFunctionIsASN1Type *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionIsASN1Type *) malloc(sizeof(struct _nbNetPDLExprFunctionIsASN1Type));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionIsASN1Type);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1008,7 +1009,7 @@ int PCREFlags;
 const char *PCREErrorPtr;
 int PCREErrorOffset;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionRegExp *) malloc(sizeof(struct _nbNetPDLExprFunctionRegExp));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionRegExp);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1047,7 +1048,7 @@ int PCREErrorOffset;
 
 	// Buffer containing the regular expression has been allocated in the lexical parser
 	// So, let's free it now
-	free((char *) RegularExpression);
+	ProtoDBFree((char *) RegularExpression);
 
 
 	// Let's compile the regular expression for our convenience
@@ -1061,7 +1062,7 @@ int PCREErrorOffset;
 	FreeOperandItem( (struct _nbNetPDLExprBase* ) CaseSensitive);
 
 
-	NetPDLElement->PCRECompiledRegExp= (void *) pcre_compile(NetPDLElement->RegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset, NULL);
+	NetPDLElement->PCRECompiledRegExp= ProtoDBCompileRegExp(NetPDLElement->RegularExpression, PCREFlags, &PCREErrorPtr, &PCREErrorOffset);
 
 	if (NetPDLElement->PCRECompiledRegExp == NULL)
 	{
@@ -1115,7 +1116,7 @@ struct _nbNetPDLExprFunctionIsPresent* CreateFunctionIsPresentItem(struct _nbNet
 {
 struct _nbNetPDLExprFunctionIsPresent *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionIsPresent *) malloc(sizeof(struct _nbNetPDLExprFunctionIsPresent));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionIsPresent);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1145,7 +1146,7 @@ struct _nbNetPDLExprFunctionBuf2Int* CreateFunctionBuffer2IntItem(struct _nbNetP
 {
 struct _nbNetPDLExprFunctionBuf2Int *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionBuf2Int *) malloc(sizeof(struct _nbNetPDLExprFunctionBuf2Int));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionBuf2Int);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1175,7 +1176,7 @@ struct _nbNetPDLExprFunctionInt2Buf* CreateFunctionInt2BufferItem(struct _nbNetP
 {
 struct _nbNetPDLExprFunctionInt2Buf *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionInt2Buf *) malloc(sizeof(struct _nbNetPDLExprFunctionInt2Buf));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionInt2Buf);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1210,7 +1211,7 @@ struct _nbNetPDLExprFunctionAscii2Int* CreateFunctionAscii2IntItem(struct _nbNet
 {
 struct _nbNetPDLExprFunctionAscii2Int *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionAscii2Int *) malloc(sizeof(struct _nbNetPDLExprFunctionAscii2Int));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionAscii2Int);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1239,7 +1240,7 @@ struct _nbNetPDLExprFunctionChangeByteOrder* CreateFunctionChangeByteOrderItem(s
 {
 struct _nbNetPDLExprFunctionChangeByteOrder *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionChangeByteOrder *) malloc(sizeof(struct _nbNetPDLExprFunctionChangeByteOrder));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionChangeByteOrder);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1268,7 +1269,7 @@ struct _nbNetPDLExprFunctionCheckUpdateLookupTable* CreateFunctionCheckUpdateLoo
 {
 struct _nbNetPDLExprFunctionCheckUpdateLookupTable *NetPDLElement;
 
-	NetPDLElement= (struct _nbNetPDLExprFunctionCheckUpdateLookupTable *) malloc(sizeof(struct _nbNetPDLExprFunctionCheckUpdateLookupTable));
+	NetPDLElement= ProtoDBAllocStruct(_nbNetPDLExprFunctionCheckUpdateLookupTable);
 
 	if (NetPDLElement == NULL)
 	{
@@ -1281,7 +1282,7 @@ struct _nbNetPDLExprFunctionCheckUpdateLookupTable *NetPDLElement;
 //	NetPDLElement->Type= nbNETPDL_ID_EXPR_OPERAND_FUNCTION_CHECKLOOKUPTABLE;
 	NetPDLElement->ReturnType= nbNETPDL_ID_EXPR_RETURNTYPE_NUMBER;
 
-	NetPDLElement->TableName= (char*) malloc(strlen(LookupTable->Name) + 1);
+	NetPDLElement->TableName= (char*) ProtoDBAllocRaw(strlen(LookupTable->Name) + 1);
 
 	if (NetPDLElement->TableName == NULL)
 	{
@@ -1314,7 +1315,7 @@ struct _nbParamsLinkedList* CreateParameterList(struct _nbParamsLinkedList* Prev
 {
 struct _nbParamsLinkedList* AdditionalLinkedExpression;
 
-	AdditionalLinkedExpression= (struct _nbParamsLinkedList *) malloc(sizeof(struct _nbParamsLinkedList));
+	AdditionalLinkedExpression= ProtoDBAllocStruct(_nbParamsLinkedList);
 
 	if (AdditionalLinkedExpression == NULL)
 	{
@@ -1354,7 +1355,7 @@ struct _nbParamsLinkedList* AdditionalLinkedExpression;
 
 void FreeOperatorItem(struct _nbNetPDLExprOperator* OperatorElement)
 {
-	free(OperatorElement);
+	ProtoDBFree(OperatorElement);
 }
 
 void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
@@ -1371,7 +1372,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprString* Element= (struct _nbNetPDLExprString*) GenericOperandElement;
 				
 				if (Element->Value)
-					free(Element->Value);
+					ProtoDBFree(Element->Value);
 
 			}; break;
 
@@ -1380,7 +1381,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprProtoRef* Element= (struct _nbNetPDLExprProtoRef*) GenericOperandElement;
 				
 				if (Element->ProtocolName)
-					free(Element->ProtocolName);
+					ProtoDBFree(Element->ProtocolName);
 
 			}; break;
 
@@ -1389,7 +1390,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprVariable* Element= (struct _nbNetPDLExprVariable*) GenericOperandElement;
 
 				if (Element->Name)
-					free(Element->Name);
+					ProtoDBFree(Element->Name);
 
 				if (Element->OffsetSize)
 					FreeExpression(Element->OffsetSize);
@@ -1403,9 +1404,9 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprLookupTable* Element= (struct _nbNetPDLExprLookupTable*) GenericOperandElement;
 
 				if (Element->TableName)
-					free(Element->TableName);
+					ProtoDBFree(Element->TableName);
 				if (Element->FieldName)
-					free(Element->FieldName);
+					ProtoDBFree(Element->FieldName);
 
 				if (Element->OffsetSize)
 					FreeExpression(Element->OffsetSize);
@@ -1420,9 +1421,9 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprFieldRef* Element= (struct _nbNetPDLExprFieldRef*) GenericOperandElement;
 
 				if (Element->FieldName)
-					free(Element->FieldName);
+					ProtoDBFree(Element->FieldName);
 				if (Element->ProtoName)
-					free(Element->ProtoName);
+					ProtoDBFree(Element->ProtoName);
 
 				if (Element->OffsetSize)
 					FreeExpression(Element->OffsetSize);
@@ -1436,13 +1437,13 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprFunctionIsASN1Type *Element= (struct _nbNetPDLExprFunctionIsASN1Type*) GenericOperandElement;
 
 				if (Element->StringExpression)
-					free(Element->StringExpression);
+					ProtoDBFree(Element->StringExpression);
 	
 				if (Element->ClassNumber)
-					free(Element->ClassNumber);
+					ProtoDBFree(Element->ClassNumber);
 
 				if (Element->TagNumber)
-					free(Element->TagNumber);
+					ProtoDBFree(Element->TagNumber);
 
 			}; break;
 
@@ -1452,13 +1453,13 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbNetPDLExprFunctionRegExp* Element= (struct _nbNetPDLExprFunctionRegExp*) GenericOperandElement;
 
 				if (Element->RegularExpression)
-					free(Element->RegularExpression);
+					ProtoDBFree(Element->RegularExpression);
 
 				if (Element->SearchBuffer)
 					FreeExpression(Element->SearchBuffer);
 
 				if (Element->PCRECompiledRegExp)
-					pcre_free(Element->PCRECompiledRegExp);
+					ProtoDBFree(Element->PCRECompiledRegExp);
 
 			}; break;
 
@@ -1514,7 +1515,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 			struct _nbParamsLinkedList* TempLinkedExpression1, * TempLinkedExpression2;
 
 				if (Element->TableName)
-					free(Element->TableName);
+					ProtoDBFree(Element->TableName);
 
 				TempLinkedExpression1= Element->ParameterList;
 
@@ -1523,7 +1524,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 					FreeExpression( (struct _nbNetPDLExprBase *) TempLinkedExpression1->Expression);
 					TempLinkedExpression2= TempLinkedExpression1->NextParameter;
 
-					free(TempLinkedExpression1);
+					ProtoDBFree(TempLinkedExpression1);
 					TempLinkedExpression1= TempLinkedExpression2;
 				}
 
@@ -1536,7 +1537,7 @@ void FreeOperandItem(struct _nbNetPDLExprBase* GenericOperandElement)
 
 		}
 
-		free(GenericOperandElement);
+		ProtoDBFree(GenericOperandElement);
 	}
 }
 
@@ -1571,7 +1572,7 @@ void FreeExpression(struct _nbNetPDLExprBase* ExpressionElement)
 				FreeOperandItem(Expression->Operand2);
 		}
 
-		free(ExpressionElement);
+		ProtoDBFree(ExpressionElement);
 	}
 	else
 		FreeOperandItem(ExpressionElement);
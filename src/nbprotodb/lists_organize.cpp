@@ -63,7 +63,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementProto **) malloc(sizeof(struct _nbNetPDLElementProto *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementProto **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
@@ -98,7 +98,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementShowSumStructure **) malloc(sizeof(struct _nbNetPDLElementShowSumStructure *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementShowSumStructure **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
@@ -134,7 +134,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementShowSumTemplate **) malloc(sizeof(struct _nbNetPDLElementShowSumTemplate *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementShowSumTemplate **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
@@ -170,7 +170,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementShowTemplate **) malloc(sizeof(struct _nbNetPDLElementShowTemplate *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementShowTemplate **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
@@ -200,7 +200,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementAdt **) malloc(sizeof(struct _nbNetPDLElementAdt *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementAdt **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
@@ -250,7 +250,7 @@ int j= 0;
 		return NULL;
 	}
 
-	NetPDLElementList= (struct _nbNetPDLElementAdt **) malloc(sizeof(struct _nbNetPDLElementAdt *) * NumElementsInList);
+	NetPDLElementList= (struct _nbNetPDLElementAdt **) ProtoDBAllocPointers(NumElementsInList);
 
 	if (NetPDLElementList == NULL)
 	{
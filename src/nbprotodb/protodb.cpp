@@ -9,6 +9,7 @@
 #include "sax_parser.h"
 
 #include "protodb_globals.h"
+#include "protodb_image.h"
 
 #include "../nbee/globals/utils.h"
 #include "../nbee/globals/globals.h"
@@ -53,6 +54,30 @@ struct _ElementList ElementList[]=
 CNetPDLSAXParser *NetPDLDatabaseHandler;
 
 
+// Computes the FNV-1a hash of the content of a file; it returns 0 if the file cannot be read
+static uint64_t GetFileFingerprint(const char *FileName)
+{
+FILE *File;
+unsigned char Buffer[8192];
+size_t Read;
+uint64_t Hash= 0xCBF29CE484222325ULL;
+
+	File= fopen(FileName, "rb");
+	if (File == NULL)
+		return 0;
+
+	while ((Read= fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+	{
+		for (size_t i= 0; i < Read; i++)
+		{
+			Hash^= Buffer[i];
+			Hash*= 0x100000001B3ULL;
+		}
+	}
+
+	fclose(File);
+	return Hash;
+}
 
 
 struct _nbNetPDLDatabase *nbProtoDBXMLLoad(const char *FileName, int Flags, char *ErrBuf, int ErrBufSize)
@@ -79,6 +104,8 @@ struct _nbNetPDLDatabase *nbProtoDBXMLLoad(const char *FileName, int Flags, char
 		return NULL;
 	}
 
+	NetPDLDatabase->Fingerprint= GetFileFingerprint(FileName);
+
 	return NetPDLDatabase;
 }
 
@@ -86,15 +113,10 @@ struct _nbNetPDLDatabase *nbProtoDBXMLLoad(const char *FileName, int Flags, char
 
 void nbProtoDBXMLCleanup()
 {
+	// The database may have been loaded from a binary image, which is simply unmapped
+	if (ProtoDBImageUnload() == nbSUCCESS)
+		return;
+
 	NetPDLDatabaseHandler->Cleanup();
 	delete NetPDLDatabaseHandler;
 }
-
-
-
-//int nbProtoDBXMLSave(const char *FileName, char *ErrBuf, int ErrBufSize)
-//{
-//	// FULVIO nbNetPDLDatabaseSave function not implemented
-//	errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Function not implemented.");
-//	return nbFAILURE;
-//}
@@ -16,6 +16,7 @@
 #include "elements_organize.h"
 #include "elements_delete.h"
 #include "elements_serialize.h"
+#include "protodb_heap.h"
 
 
 
@@ -0,0 +1,215 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <pcre.h>
+#include "protodb_heap.h"
+
+
+//! List of the chunks of the heap (the first one is the chunk currently used for allocations)
+static struct _ProtoDBHeapChunk *HeapChunks;
+
+
+// Allocates a block from the heap; the memory is initialized to zero
+static void *HeapAlloc(size_t Size, unsigned int Layout)
+{
+struct _ProtoDBHeapBlock *Block;
+size_t BlockSize;
+
+	Size= (Size + PROTODB_HEAP_ALIGNMENT - 1) & ~((size_t) PROTODB_HEAP_ALIGNMENT - 1);
+	BlockSize= Size + sizeof(struct _ProtoDBHeapBlock);
+
+	if ((HeapChunks == NULL) || (HeapChunks->Size - HeapChunks->Used < BlockSize))
+	{
+	struct _ProtoDBHeapChunk *Chunk;
+	size_t ChunkSize;
+
+		ChunkSize= (BlockSize > PROTODB_HEAP_CHUNK_SIZE) ? BlockSize : PROTODB_HEAP_CHUNK_SIZE;
+
+		Chunk= (struct _ProtoDBHeapChunk *) malloc(PROTODB_HEAP_CHUNK_HEADER_SIZE + ChunkSize);
+		if (Chunk == NULL)
+			return NULL;
+
+		Chunk->Size= ChunkSize;
+		Chunk->Used= 0;
+
+		// Big blocks do not waste the space left in the current chunk
+		if ((HeapChunks != NULL) && (ChunkSize > PROTODB_HEAP_CHUNK_SIZE))
+		{
+			Chunk->Next= HeapChunks->Next;
+			HeapChunks->Next= Chunk;
+		}
+		else
+		{
+			Chunk->Next= HeapChunks;
+			HeapChunks= Chunk;
+		}
+
+		Block= (struct _ProtoDBHeapBlock *) PROTODB_HEAP_CHUNK_DATA(Chunk);
+		Chunk->Used= BlockSize;
+	}
+	else
+	{
+		Block= (struct _ProtoDBHeapBlock *) (PROTODB_HEAP_CHUNK_DATA(HeapChunks) + HeapChunks->Used);
+		HeapChunks->Used+= BlockSize;
+	}
+
+	Block->Size= (unsigned int) Size;
+	Block->Layout= Layout;
+	memset(Block + 1, 0, Size);
+
+	return Block + 1;
+}
+
+
+/*!
+	\brief Allocates a block with the given layout (see #ProtoDBLayouts).
+
+	Structures of the database should be allocated through ProtoDBAllocStruct(), which chooses their layout.
+*/
+void *ProtoDBAllocLayout(size_t Size, unsigned int Layout)
+{
+	return HeapAlloc(Size, Layout);
+}
+
+
+/*!
+	\brief Allocates an array of pointers to other blocks of the database (e.g. a list of elements).
+*/
+void *ProtoDBAllocPointers(size_t NPointers)
+{
+	return HeapAlloc(NPointers * sizeof(void *), PROTODB_LAYOUT_POINTERS);
+}
+
+
+/*!
+	\brief Allocates a block that contains raw data (e.g. a string), which does not contain any pointer.
+*/
+void *ProtoDBAllocRaw(size_t Size)
+{
+	return HeapAlloc(Size, PROTODB_LAYOUT_RAW);
+}
+
+
+/*!
+	\brief Copies the first 'Size' bytes of a block of the heap into a new block with the same layout.
+*/
+void *ProtoDBDuplicate(const void *Block, size_t Size)
+{
+const struct _ProtoDBHeapBlock *Source= (const struct _ProtoDBHeapBlock *) Block - 1;
+void *Copy;
+
+	Copy= HeapAlloc(Size, Source->Layout);
+	if (Copy)
+		memcpy(Copy, Block, Size);
+
+	return Copy;
+}
+
+
+/*!
+	\brief Duplicates a string into the heap.
+*/
+char *ProtoDBStrdup(const char *String)
+{
+size_t Size= strlen(String) + 1;
+char *Copy;
+
+	Copy= (char *) HeapAlloc(Size, PROTODB_LAYOUT_RAW);
+	if (Copy)
+		memcpy(Copy, String, Size);
+
+	return Copy;
+}
+
+
+/*!
+	\brief Releases a block of memory.
+
+	Blocks of the heap are released all together by ProtoDBHeapRelease(), hence they are left there.
+	Other blocks (e.g. the strings allocated by the expression scanner) are freed immediately.
+*/
+void ProtoDBFree(void *Ptr)
+{
+struct _ProtoDBHeapChunk *Chunk;
+
+	if (Ptr == NULL)
+		return;
+
+	for (Chunk= HeapChunks; Chunk; Chunk= Chunk->Next)
+	{
+		if (((char *) Ptr >= PROTODB_HEAP_CHUNK_DATA(Chunk)) && ((char *) Ptr < PROTODB_HEAP_CHUNK_DATA(Chunk) + Chunk->Used))
+			return;
+	}
+
+	free(Ptr);
+}
+
+
+/*!
+	\brief Compiles a regular expression and moves the compiled code into the heap.
+
+	Compiled PCRE patterns do not contain pointers (the default character tables are used), hence they
+	can be stored as raw blocks and saved in the binary image of the database as they are.
+
+	\return The compiled pattern (to be used as a 'pcre *'), or NULL in case of error; in the latter case
+	the parameters are filled in as in pcre_compile().
+*/
+void *ProtoDBCompileRegExp(const char *Pattern, int Options, const char **ErrorPtr, int *ErrorOffset)
+{
+pcre *CompiledRegExp;
+size_t Size;
+void *Copy;
+
+	CompiledRegExp= pcre_compile(Pattern, Options, ErrorPtr, ErrorOffset, NULL);
+	if (CompiledRegExp == NULL)
+		return NULL;
+
+	*ErrorOffset= 0;
+
+	if (pcre_fullinfo(CompiledRegExp, NULL, PCRE_INFO_SIZE, &Size) != 0)
+	{
+		*ErrorPtr= "cannot get the size of the compiled regular expression";
+		pcre_free(CompiledRegExp);
+		return NULL;
+	}
+
+	Copy= HeapAlloc(Size, PROTODB_LAYOUT_RAW);
+	if (Copy)
+		memcpy(Copy, CompiledRegExp, Size);
+	else
+		*ErrorPtr= "not enough memory for the compiled regular expression";
+
+	pcre_free(CompiledRegExp);
+	return Copy;
+}
+
+
+/*!
+	\brief Returns the list of the chunks of the heap.
+*/
+struct _ProtoDBHeapChunk *ProtoDBHeapGetChunks()
+{
+	return HeapChunks;
+}
+
+
+/*!
+	\brief Releases all the memory allocated in the heap.
+*/
+void ProtoDBHeapRelease()
+{
+	while (HeapChunks)
+	{
+	struct _ProtoDBHeapChunk *Next= HeapChunks->Next;
+
+		free(HeapChunks);
+		HeapChunks= Next;
+	}
+}
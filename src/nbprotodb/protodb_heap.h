@@ -0,0 +1,81 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+// Allow including this file only once
+#pragma once
+
+
+#include <stddef.h>
+#include "protodb_layout.h"
+
+
+/*!
+	\brief Heap that keeps all the memory of the NetPDL protocol database.
+
+	Every structure of the database (elements, expressions, strings, lists, compiled regular
+	expressions) is allocated from a list of large chunks instead of being allocated one by one.
+	This has two purposes:
+	- the database can be released at once, without walking it
+	- the database can be copied into a binary image by copying the chunks and relocating
+	the pointers they contain (see protodb_image.cpp).
+
+	Each block is preceded by a small header that keeps the layout of the block (see protodb_layout.h),
+	i.e. where its pointers are: a structure of the database, a list of pointers, or raw data
+	(e.g. strings or compiled regular expressions), which must not be relocated.
+*/
+
+
+//! Default size of a chunk of the heap (bigger blocks get a chunk of their own)
+#define PROTODB_HEAP_CHUNK_SIZE (256 * 1024)
+
+//! Alignment of the blocks allocated in the heap
+#define PROTODB_HEAP_ALIGNMENT 8
+
+
+//! Header that precedes each block allocated in the heap
+struct _ProtoDBHeapBlock
+{
+	//! Size of the block (header excluded), rounded to PROTODB_HEAP_ALIGNMENT
+	unsigned int Size;
+	//! Layout of the block (#ProtoDBLayouts)
+	unsigned int Layout;
+};
+
+
+//! Chunk of the heap; blocks follow this header
+struct _ProtoDBHeapChunk
+{
+	//! Next chunk (chunks are listed from the newest one)
+	struct _ProtoDBHeapChunk *Next;
+	//! Number of bytes available for blocks
+	size_t Size;
+	//! Number of bytes already used by blocks (headers included)
+	size_t Used;
+};
+
+
+//! Size of the header of a chunk, rounded to PROTODB_HEAP_ALIGNMENT
+#define PROTODB_HEAP_CHUNK_HEADER_SIZE ((sizeof(struct _ProtoDBHeapChunk) + PROTODB_HEAP_ALIGNMENT - 1) & ~((size_t) PROTODB_HEAP_ALIGNMENT - 1))
+
+//! Returns the first byte of the data contained in a chunk
+#define PROTODB_HEAP_CHUNK_DATA(Chunk) ((char *) (Chunk) + PROTODB_HEAP_CHUNK_HEADER_SIZE)
+
+
+//! Allocates a structure of the database, whose layout is known to the heap (see PROTODB_LAYOUT_STRUCTS)
+#define ProtoDBAllocStruct(StructName) ((struct StructName *) ProtoDBAllocLayout(sizeof(struct StructName), PROTODB_LAYOUT##StructName))
+
+void *ProtoDBAllocLayout(size_t Size, unsigned int Layout);
+void *ProtoDBAllocPointers(size_t NPointers);
+void *ProtoDBAllocRaw(size_t Size);
+void *ProtoDBDuplicate(const void *Block, size_t Size);
+char *ProtoDBStrdup(const char *String);
+void ProtoDBFree(void *Ptr);
+void *ProtoDBCompileRegExp(const char *Pattern, int Options, const char **ErrorPtr, int *ErrorOffset);
+
+struct _ProtoDBHeapChunk *ProtoDBHeapGetChunks();
+void ProtoDBHeapRelease();
@@ -0,0 +1,572 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/*
+	Binary image of the NetPDL protocol database.
+
+	The image is a copy of the chunks of the protodb heap (see protodb_heap.h), which contain the
+	database already organized, followed by the list of the locations that contain pointers.
+	These locations are given by the layout of each block (see protodb_layout.h); a pointer that
+	does not refer to the heap cannot be saved, hence the image is not created.
+	Pointers are saved as if the image were mapped at a preferred base address; when the image is
+	mapped there (which is the common case) it can be used as it is, without touching its pages, hence
+	the memory is shared among all the processes that map the same image. Otherwise, pointers are
+	relocated by adding the difference between the actual and the preferred address.
+
+	The image is mapped copy-on-write, since the NetPDL engine stores the address of the call
+	handlers in the database (nbRegisterPacketDecoderCallHandle()).
+
+	The image is specific of the platform that created it (pointer size and byte order are checked
+	at loading time), and it keeps the fingerprint of the NetPDL file, so that data derived from the
+	database (e.g. compiled filters) can be checked against it.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "protodb_globals.h"
+#include "protodb_image.h"
+
+#include "../nbee/globals/globals.h"
+#include "../nbee/globals/utils.h"
+#include "../nbee/globals/debug.h"
+
+
+//! Version of the format of the image; it must be changed whenever the structures of the database change
+#define PROTODB_IMAGE_VERSION 3
+
+//! Offset of the data within the image (the header is padded to this size)
+#define PROTODB_IMAGE_DATA_OFFSET 4096
+
+//! Preferred address of the image on 64-bit platforms
+#define PROTODB_IMAGE_BASE64 0x0000200000000000ULL
+
+//! Preferred address of the image on 32-bit platforms
+#define PROTODB_IMAGE_BASE32 0x50000000ULL
+
+//! Value used to check the byte order of the platform that created the image
+#define PROTODB_IMAGE_BYTEORDER 0x01020304
+
+
+//! Header of the image; it is followed by the data (at PROTODB_IMAGE_DATA_OFFSET) and by the relocations
+struct _ProtoDBImageHeader
+{
+	char Magic[8];				//!< PROTODB_IMAGE_MAGIC
+	uint32_t Version;			//!< PROTODB_IMAGE_VERSION
+	uint32_t PointerSize;		//!< Size of the pointers of the platform that created the image
+	uint32_t ByteOrder;			//!< PROTODB_IMAGE_BYTEORDER, in the byte order of that platform
+	uint32_t Flags;				//!< Flags the database has been loaded with (#nbProtoDBFlags)
+	uint64_t Fingerprint;		//!< Fingerprint of the NetPDL file the database has been loaded from
+	uint64_t PreferredBase;		//!< Address pointers refer to
+	uint64_t DataOffset;		//!< Offset of the data from the beginning of the image
+	uint64_t DataSize;			//!< Size of the data in bytes
+	uint64_t RootOffset;		//!< Offset of the struct _nbNetPDLDatabase within the data
+	uint64_t RelocOffset;		//!< Offset of the relocations from the beginning of the image
+	uint64_t NRelocs;			//!< Number of relocations (offsets of the pointers within the data, as uint32_t)
+};
+
+static const char PROTODB_IMAGE_MAGIC[8]= {'N', 'B', 'P', 'D', 'L', 'I', 'M', 'G'};
+
+
+//! Beginning of the image currently mapped (NULL if the database has not been loaded from an image)
+static char *ImageAddress;
+
+//! Size of the image currently mapped
+static size_t ImageSize;
+
+
+//! Chunk of the heap, as seen while saving the image
+struct _ImageChunk
+{
+	char *Data;					//!< Data of the chunk in memory
+	size_t Used;				//!< Bytes used in the chunk
+	size_t Offset;				//!< Offset of the chunk within the data of the image
+};
+
+
+static int CompareChunks(const void *a, const void *b)
+{
+const struct _ImageChunk *x= (const struct _ImageChunk *) a;
+const struct _ImageChunk *y= (const struct _ImageChunk *) b;
+
+	if (x->Data < y->Data)
+		return -1;
+	return (x->Data > y->Data) ? 1 : 0;
+}
+
+
+// Returns the offset within the data of the image corresponding to an address of the heap, or -1
+static int64_t TranslateAddress(struct _ImageChunk *Chunks, int NChunks, const void *Address)
+{
+int Low= 0, High= NChunks;
+
+	// Chunks are sorted by address
+	while (Low < High)
+	{
+	int Middle= Low + (High - Low) / 2;
+
+		if (Chunks[Middle].Data + Chunks[Middle].Used < (const char *) Address)
+			Low= Middle + 1;
+		else
+			High= Middle;
+	}
+
+	// Pointers to the end of a block are valid as well
+	if ((Low < NChunks) && ((const char *) Address >= Chunks[Low].Data))
+		return (int64_t) (Chunks[Low].Offset + ((const char *) Address - Chunks[Low].Data));
+
+	return -1;
+}
+
+
+static uint64_t GetPreferredBase()
+{
+	return (sizeof(void *) == 8) ? PROTODB_IMAGE_BASE64 : PROTODB_IMAGE_BASE32;
+}
+
+
+int nbProtoDBImageSave(const char *FileName, char *ErrBuf, int ErrBufSize)
+{
+struct _ProtoDBHeapChunk *HeapChunk;
+struct _ProtoDBImageHeader Header;
+struct _ImageChunk *Chunks= NULL;
+uint32_t *Relocs= NULL;
+char *Data= NULL;
+size_t DataSize= 0, NRelocs= 0, MaxRelocs= 0;
+int NChunks= 0, i;
+int64_t Offset;
+FILE *ImageFile= NULL;
+char Padding[PROTODB_IMAGE_DATA_OFFSET - sizeof(struct _ProtoDBImageHeader)];
+int RetVal= nbFAILURE;
+
+	if (NetPDLDatabase == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL protocol database has not been loaded.");
+		return nbFAILURE;
+	}
+
+	if (ImageAddress != NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+			"The NetPDL protocol database has been loaded from an image; please load it from the NetPDL file.");
+		return nbFAILURE;
+	}
+
+	for (HeapChunk= ProtoDBHeapGetChunks(); HeapChunk; HeapChunk= HeapChunk->Next)
+		NChunks++;
+
+	Chunks= (struct _ImageChunk *) malloc(NChunks * sizeof(struct _ImageChunk));
+	if (Chunks == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating the image.");
+		goto Cleanup;
+	}
+
+	i= 0;
+	for (HeapChunk= ProtoDBHeapGetChunks(); HeapChunk; HeapChunk= HeapChunk->Next)
+	{
+		Chunks[i].Data= PROTODB_HEAP_CHUNK_DATA(HeapChunk);
+		Chunks[i].Used= HeapChunk->Used;
+		i++;
+	}
+
+	// Chunks are copied one after the other, in order of address
+	qsort(Chunks, NChunks, sizeof(struct _ImageChunk), CompareChunks);
+	for (i= 0; i < NChunks; i++)
+	{
+		Chunks[i].Offset= DataSize;
+		DataSize+= Chunks[i].Used;
+	}
+
+	if (DataSize > 0xFFFFFFFF)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL protocol database is too big for an image.");
+		goto Cleanup;
+	}
+
+	Data= (char *) malloc(DataSize);
+	if (Data == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating the image.");
+		goto Cleanup;
+	}
+
+	for (i= 0; i < NChunks; i++)
+	{
+	size_t BlockOffset= 0;
+
+		memcpy(Data + Chunks[i].Offset, Chunks[i].Data, Chunks[i].Used);
+
+		// Prelink the pointers of each block, which are listed by its layout
+		while (BlockOffset < Chunks[i].Used)
+		{
+		struct _ProtoDBHeapBlock *Block= (struct _ProtoDBHeapBlock *) (Chunks[i].Data + BlockOffset);
+		size_t PayloadOffset= BlockOffset + sizeof(struct _ProtoDBHeapBlock);
+		const struct _ProtoDBLayout *Layout;
+		size_t NPointers;
+
+			if (Block->Layout >= PROTODB_LAYOUT_COUNT)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The protodb heap contains a block with an unknown layout.");
+				goto Cleanup;
+			}
+
+			Layout= &ProtoDBLayouts[Block->Layout];
+
+			if (Block->Layout == PROTODB_LAYOUT_POINTERS)
+				NPointers= Block->Size / sizeof(void *);
+			else
+				NPointers= Layout->NPointers;
+
+			if (Layout->Size > Block->Size)
+			{
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+					"The protodb heap contains a block that is smaller than its structure (%s).", Layout->Name);
+				goto Cleanup;
+			}
+
+			for (size_t Pointer= 0; Pointer < NPointers; Pointer++)
+			{
+			size_t PointerOffset= (Block->Layout == PROTODB_LAYOUT_POINTERS) ? Pointer * sizeof(void *) : Layout->Pointers[Pointer];
+			void *Address= *(void **) (Chunks[i].Data + PayloadOffset + PointerOffset);
+			size_t ImageOffset= Chunks[i].Offset + PayloadOffset + PointerOffset;
+
+				if (Address == NULL)
+					continue;
+
+				Offset= TranslateAddress(Chunks, NChunks, Address);
+				if (Offset < 0)
+				{
+					errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+						"The NetPDL protocol database cannot be saved: a pointer in a block of type '%s' refers to memory outside the database.", Layout->Name);
+					goto Cleanup;
+				}
+
+				if (NRelocs == MaxRelocs)
+				{
+				uint32_t *NewRelocs;
+
+					MaxRelocs= (MaxRelocs == 0) ? 4096 : MaxRelocs * 2;
+					NewRelocs= (uint32_t *) realloc(Relocs, MaxRelocs * sizeof(uint32_t));
+					if (NewRelocs == NULL)
+					{
+						errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Not enough memory for creating the image.");
+						goto Cleanup;
+					}
+					Relocs= NewRelocs;
+				}
+
+				Relocs[NRelocs++]= (uint32_t) ImageOffset;
+				*(uintptr_t *) (Data + ImageOffset)= (uintptr_t) (GetPreferredBase() + PROTODB_IMAGE_DATA_OFFSET + Offset);
+			}
+
+			BlockOffset= PayloadOffset + Block->Size;
+		}
+	}
+
+	// The call handlers registered by the NetPDL engine belong to this process
+	for (uint32_t Element= 1; Element < NetPDLDatabase->GlobalElementsListNItemsPlusADTCopies; Element++)
+	{
+	struct _nbNetPDLElementBase *NetPDLElement= NetPDLDatabase->GlobalElementsList[Element];
+
+		if ((NetPDLElement == NULL) || (NetPDLElement->CallHandlerInfo == NULL))
+			continue;
+
+		Offset= TranslateAddress(Chunks, NChunks, &NetPDLElement->CallHandlerInfo->CallHandler);
+		if (Offset >= 0)
+			*(void **) (Data + Offset)= NULL;
+	}
+
+	// So does the code the expressions have been compiled into
+	for (struct _nbNetPDLExprBase *Expression= NetPDLDatabase->ExpressionList; Expression != NULL; Expression= Expression->NextExpression)
+	{
+		Offset= TranslateAddress(Chunks, NChunks, &Expression->CompiledCode);
+		if (Offset >= 0)
+			*(void **) (Data + Offset)= NULL;
+	}
+
+	Offset= TranslateAddress(Chunks, NChunks, NetPDLDatabase);
+	if (Offset < 0)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL protocol database has not been allocated in the protodb heap.");
+		goto Cleanup;
+	}
+
+	memset(&Header, 0, sizeof(Header));
+	memcpy(Header.Magic, PROTODB_IMAGE_MAGIC, sizeof(Header.Magic));
+	Header.Version= PROTODB_IMAGE_VERSION;
+	Header.PointerSize= sizeof(void *);
+	Header.ByteOrder= PROTODB_IMAGE_BYTEORDER;
+	Header.Flags= NetPDLDatabase->Flags;
+	Header.Fingerprint= NetPDLDatabase->Fingerprint;
+	Header.PreferredBase= GetPreferredBase();
+	Header.DataOffset= PROTODB_IMAGE_DATA_OFFSET;
+	Header.DataSize= DataSize;
+	Header.RootOffset= Offset;
+	Header.RelocOffset= PROTODB_IMAGE_DATA_OFFSET + DataSize;
+	Header.NRelocs= NRelocs;
+
+	ImageFile= fopen(FileName, "wb");
+	if (ImageFile == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Cannot create file '%s'.", FileName);
+		goto Cleanup;
+	}
+
+	memset(Padding, 0, sizeof(Padding));
+
+	if ((fwrite(&Header, sizeof(Header), 1, ImageFile) != 1) ||
+		(fwrite(Padding, sizeof(Padding), 1, ImageFile) != 1) ||
+		(fwrite(Data, 1, DataSize, ImageFile) != DataSize) ||
+		(fwrite(Relocs, sizeof(uint32_t), NRelocs, ImageFile) != NRelocs))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Cannot write file '%s'.", FileName);
+		goto Cleanup;
+	}
+
+	RetVal= nbSUCCESS;
+
+Cleanup:
+	if (ImageFile && (fclose(ImageFile) != 0) && (RetVal == nbSUCCESS))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Cannot write file '%s'.", FileName);
+		RetVal= nbFAILURE;
+	}
+
+	free(Chunks);
+	free(Relocs);
+	free(Data);
+	return RetVal;
+}
+
+
+// Reads the header of an image and checks that it can be used on this platform
+static int ReadImageHeader(FILE *ImageFile, struct _ProtoDBImageHeader *Header)
+{
+	if (fread(Header, sizeof(struct _ProtoDBImageHeader), 1, ImageFile) != 1)
+		return nbFAILURE;
+
+	if (memcmp(Header->Magic, PROTODB_IMAGE_MAGIC, sizeof(Header->Magic)) != 0)
+		return nbFAILURE;
+
+	return nbSUCCESS;
+}
+
+
+int nbProtoDBIsImage(const char *FileName)
+{
+struct _ProtoDBImageHeader Header;
+FILE *ImageFile;
+int RetVal;
+
+	ImageFile= fopen(FileName, "rb");
+	if (ImageFile == NULL)
+		return nbFAILURE;
+
+	RetVal= ReadImageHeader(ImageFile, &Header);
+
+	fclose(ImageFile);
+	return RetVal;
+}
+
+
+// Maps the whole image copy-on-write, possibly at the given address
+static char *MapImage(const char *FileName, uint64_t PreferredBase, size_t *Size)
+{
+#ifdef WIN32
+HANDLE File, Mapping;
+LARGE_INTEGER FileSize;
+void *Address;
+
+	File= CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (File == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	if (!GetFileSizeEx(File, &FileSize))
+	{
+		CloseHandle(File);
+		return NULL;
+	}
+
+	Mapping= CreateFileMapping(File, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	CloseHandle(File);
+	if (Mapping == NULL)
+		return NULL;
+
+	Address= MapViewOfFileEx(Mapping, FILE_MAP_COPY, 0, 0, 0, (void *) (uintptr_t) PreferredBase);
+	if (Address == NULL)
+		Address= MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0);
+
+	// The view keeps a reference to the mapping
+	CloseHandle(Mapping);
+
+	*Size= (size_t) FileSize.QuadPart;
+	return (char *) Address;
+#else
+int File;
+struct stat FileInfo;
+void *Address;
+
+	File= open(FileName, O_RDONLY);
+	if (File < 0)
+		return NULL;
+
+	if (fstat(File, &FileInfo) != 0)
+	{
+		close(File);
+		return NULL;
+	}
+
+	// The address is just a hint: if it is not available, the system chooses another one
+	Address= mmap((void *) (uintptr_t) PreferredBase, FileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, File, 0);
+	close(File);
+
+	if (Address == MAP_FAILED)
+		return NULL;
+
+	*Size= FileInfo.st_size;
+	return (char *) Address;
+#endif
+}
+
+
+static void UnmapImage(char *Address, size_t Size)
+{
+#ifdef WIN32
+	UnmapViewOfFile(Address);
+#else
+	munmap(Address, Size);
+#endif
+}
+
+
+struct _nbNetPDLDatabase *nbProtoDBImageLoad(const char *FileName, int Flags, char *ErrBuf, int ErrBufSize)
+{
+struct _ProtoDBImageHeader Header;
+FILE *ImageFile;
+char *Address;
+size_t Size;
+uint32_t *Relocs;
+
+	if (FileName == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL protocol database does not exist.");
+		return NULL;
+	}
+
+	if (NetPDLDatabase != NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The NetPDL protocol database has already been loaded.");
+		return NULL;
+	}
+
+	ImageFile= fopen(FileName, "rb");
+	if (ImageFile == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Cannot open file '%s'.", FileName);
+		return NULL;
+	}
+
+	if (ReadImageHeader(ImageFile, &Header) == nbFAILURE)
+	{
+		fclose(ImageFile);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "File '%s' is not an image of the NetPDL protocol database.", FileName);
+		return NULL;
+	}
+	fclose(ImageFile);
+
+	if ((Header.Version != PROTODB_IMAGE_VERSION) || (Header.PointerSize != sizeof(void *)) || (Header.ByteOrder != PROTODB_IMAGE_BYTEORDER))
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+			"The image '%s' has been created by another version of the library or on another platform.", FileName);
+		return NULL;
+	}
+
+	if (Header.Flags != (uint32_t) Flags)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize,
+			"The image '%s' contains a different type of NetPDL protocol database than the requested one.", FileName);
+		return NULL;
+	}
+
+	Address= MapImage(FileName, Header.PreferredBase, &Size);
+	if (Address == NULL)
+	{
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "Cannot map the image '%s' in memory.", FileName);
+		return NULL;
+	}
+
+	// Check that all the pieces of the image are within the file
+	if ((Header.DataOffset < sizeof(Header)) || (Header.DataOffset > Size) || (Header.DataSize > Size - Header.DataOffset) ||
+		(Header.DataSize < sizeof(struct _nbNetPDLDatabase)) || (Header.RootOffset > Header.DataSize - sizeof(struct _nbNetPDLDatabase)) ||
+		(Header.RelocOffset > Size) || (Header.NRelocs > (Size - Header.RelocOffset) / sizeof(uint32_t)) ||
+		(Header.RelocOffset % sizeof(uint32_t) != 0))
+	{
+		UnmapImage(Address, Size);
+		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The image '%s' is corrupted.", FileName);
+		return NULL;
+	}
+
+	// Relocate the pointers only if the image has not been mapped at its preferred address
+	if ((uint64_t) (uintptr_t) Address != Header.PreferredBase)
+	{
+	uintptr_t Delta= (uintptr_t) Address - (uintptr_t) Header.PreferredBase;
+	char *Data= Address + Header.DataOffset;
+
+		Relocs= (uint32_t *) (Address + Header.RelocOffset);
+
+		for (uint64_t i= 0; i < Header.NRelocs; i++)
+		{
+			if ((Relocs[i] > Header.DataSize - sizeof(void *)) || (Relocs[i] % sizeof(void *) != 0))
+			{
+				UnmapImage(Address, Size);
+				errorsnprintf(__FILE__, __FUNCTION__, __LINE__, ErrBuf, ErrBufSize, "The image '%s' is corrupted.", FileName);
+				return NULL;
+			}
+
+			*(uintptr_t *) (Data + Relocs[i])+= Delta;
+		}
+	}
+
+	ImageAddress= Address;
+	ImageSize= Size;
+
+	NetPDLDatabase= (struct _nbNetPDLDatabase *) (Address + Header.DataOffset + Header.RootOffset);
+	return NetPDLDatabase;
+}
+
+
+/*!
+	\brief Unmaps the image of the database, if the database has been loaded from an image.
+
+	\return nbSUCCESS if the database was an image, nbFAILURE otherwise.
+*/
+int ProtoDBImageUnload()
+{
+	if (ImageAddress == NULL)
+		return nbFAILURE;
+
+	UnmapImage(ImageAddress, ImageSize);
+	ImageAddress= NULL;
+	ImageSize= 0;
+	NetPDLDatabase= NULL;
+
+	return nbSUCCESS;
+}
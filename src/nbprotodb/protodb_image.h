@@ -0,0 +1,13 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+// Allow including this file only once
+#pragma once
+
+
+int ProtoDBImageUnload();
@@ -0,0 +1,597 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include "protodb_globals.h"
+#include "protodb_layout.h"
+
+
+//! Offset of a pointer within a structure
+#define PROTODB_POINTER(StructName, Member) offsetof(struct StructName, Member)
+
+//! Pointers of the members shared by all the elements (STRUCT_NBNETPDLELEMENT)
+#define PROTODB_ELEMENT_POINTERS(StructName) \
+	PROTODB_POINTER(StructName, CallHandlerInfo)
+
+//! Pointers of the members shared by all the fields (STRUCT_NBNETPDLFIELDELEMENT)
+#define PROTODB_FIELD_POINTERS(StructName) \
+	PROTODB_ELEMENT_POINTERS(StructName), \
+	PROTODB_POINTER(StructName, Name), \
+	PROTODB_POINTER(StructName, LongName), \
+	PROTODB_POINTER(StructName, ShowTemplateName), \
+	PROTODB_POINTER(StructName, ShowTemplateInfo), \
+	PROTODB_POINTER(StructName, ADTRef)
+
+//! Pointers of the members shared by all the mappings (STRUCT_NBNETPDLMAPELEMENT)
+#define PROTODB_MAP_POINTERS(StructName) \
+	PROTODB_FIELD_POINTERS(StructName), \
+	PROTODB_POINTER(StructName, RefName)
+
+//! Pointers of the members shared by all the expressions (STRUCT_NBNETPDLOPERAND); 'CompiledCode' belongs to the process
+#define PROTODB_OPERAND_POINTERS(StructName) \
+	PROTODB_POINTER(StructName, NextExpression)
+
+
+static const size_t Pointers_nbNetPDLElementBase[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementBase)
+};
+
+static const size_t Pointers_nbNetPDLDatabase[]=
+{
+	PROTODB_POINTER(_nbNetPDLDatabase, CreationDate),
+	PROTODB_POINTER(_nbNetPDLDatabase, Creator),
+	PROTODB_POINTER(_nbNetPDLDatabase, ProtoList),
+	PROTODB_POINTER(_nbNetPDLDatabase, ShowTemplateList),
+	PROTODB_POINTER(_nbNetPDLDatabase, ShowSumTemplateList),
+	PROTODB_POINTER(_nbNetPDLDatabase, ShowSumStructureList),
+	PROTODB_POINTER(_nbNetPDLDatabase, ADTList),
+	PROTODB_POINTER(_nbNetPDLDatabase, LocalADTList),
+	PROTODB_POINTER(_nbNetPDLDatabase, GlobalElementsList),
+	PROTODB_POINTER(_nbNetPDLDatabase, ExpressionList)
+};
+
+static const size_t Pointers_nbCallHandlerInfo[]=
+{
+	PROTODB_POINTER(_nbCallHandlerInfo, FunctionName)
+};
+
+static const size_t Pointers_nbNetPDLElementProto[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementProto),
+	PROTODB_POINTER(_nbNetPDLElementProto, Name),
+	PROTODB_POINTER(_nbNetPDLElementProto, LongName),
+	PROTODB_POINTER(_nbNetPDLElementProto, ShowSumTemplateName),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstExecuteVerify),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstExecuteInit),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstExecuteBefore),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstExecuteAfter),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstField),
+	PROTODB_POINTER(_nbNetPDLElementProto, FirstEncapsulationItem),
+	PROTODB_POINTER(_nbNetPDLElementProto, ShowSumTemplateInfo)
+};
+
+static const size_t Pointers_nbNetPDLElementExecuteX[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementExecuteX),
+	PROTODB_POINTER(_nbNetPDLElementExecuteX, WhenExprString),
+	PROTODB_POINTER(_nbNetPDLElementExecuteX, WhenExprTree),
+	PROTODB_POINTER(_nbNetPDLElementExecuteX, NextExecuteElement)
+};
+
+static const size_t Pointers_nbNetPDLElementVariable[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementVariable),
+	PROTODB_POINTER(_nbNetPDLElementVariable, Name),
+	PROTODB_POINTER(_nbNetPDLElementVariable, InitValueString)
+};
+
+static const size_t Pointers_nbNetPDLElementLookupTable[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementLookupTable),
+	PROTODB_POINTER(_nbNetPDLElementLookupTable, Name),
+	PROTODB_POINTER(_nbNetPDLElementLookupTable, FirstKey),
+	PROTODB_POINTER(_nbNetPDLElementLookupTable, FirstData)
+};
+
+static const size_t Pointers_nbNetPDLElementKeyData[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementKeyData),
+	PROTODB_POINTER(_nbNetPDLElementKeyData, Name),
+	PROTODB_POINTER(_nbNetPDLElementKeyData, NextKeyData)
+};
+
+static const size_t Pointers_nbNetPDLElementAlias[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementAlias),
+	PROTODB_POINTER(_nbNetPDLElementAlias, Name),
+	PROTODB_POINTER(_nbNetPDLElementAlias, ReplaceWith)
+};
+
+static const size_t Pointers_nbNetPDLElementAssignVariable[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementAssignVariable),
+	PROTODB_POINTER(_nbNetPDLElementAssignVariable, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementAssignVariable, ExprTree),
+	PROTODB_POINTER(_nbNetPDLElementAssignVariable, VariableName)
+};
+
+static const size_t Pointers_nbNetPDLElementAssignLookupTable[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementAssignLookupTable),
+	PROTODB_POINTER(_nbNetPDLElementAssignLookupTable, TableName),
+	PROTODB_POINTER(_nbNetPDLElementAssignLookupTable, FieldName),
+	PROTODB_POINTER(_nbNetPDLElementAssignLookupTable, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementAssignLookupTable, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementUpdateLookupTable[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementUpdateLookupTable),
+	PROTODB_POINTER(_nbNetPDLElementUpdateLookupTable, TableName),
+	PROTODB_POINTER(_nbNetPDLElementUpdateLookupTable, FirstKey),
+	PROTODB_POINTER(_nbNetPDLElementUpdateLookupTable, FirstData)
+};
+
+static const size_t Pointers_nbNetPDLElementLookupKeyData[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementLookupKeyData),
+	PROTODB_POINTER(_nbNetPDLElementLookupKeyData, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementLookupKeyData, ExprTree),
+	PROTODB_POINTER(_nbNetPDLElementLookupKeyData, Mask),
+	PROTODB_POINTER(_nbNetPDLElementLookupKeyData, NextKeyData)
+};
+
+static const size_t Pointers_nbNetPDLElementIf[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementIf),
+	PROTODB_POINTER(_nbNetPDLElementIf, FirstValidChildIfTrue),
+	PROTODB_POINTER(_nbNetPDLElementIf, FirstValidChildIfFalse),
+	PROTODB_POINTER(_nbNetPDLElementIf, FirstValidChildIfMissingPacketData),
+	PROTODB_POINTER(_nbNetPDLElementIf, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementIf, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementCase[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementCase),
+	PROTODB_POINTER(_nbNetPDLElementCase, ShowString),
+	PROTODB_POINTER(_nbNetPDLElementCase, ValueString),
+	PROTODB_POINTER(_nbNetPDLElementCase, NextCase)
+};
+
+static const size_t Pointers_nbNetPDLElementSwitch[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementSwitch),
+	PROTODB_POINTER(_nbNetPDLElementSwitch, FirstCase),
+	PROTODB_POINTER(_nbNetPDLElementSwitch, DefaultCase),
+	PROTODB_POINTER(_nbNetPDLElementSwitch, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementSwitch, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementLoop[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementLoop),
+	PROTODB_POINTER(_nbNetPDLElementLoop, FirstValidChildInLoop),
+	PROTODB_POINTER(_nbNetPDLElementLoop, FirstValidChildIfMissingPacketData),
+	PROTODB_POINTER(_nbNetPDLElementLoop, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementLoop, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementLoopCtrl[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementLoopCtrl)
+};
+
+static const size_t Pointers_nbNetPDLElementIncludeBlk[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementIncludeBlk),
+	PROTODB_POINTER(_nbNetPDLElementIncludeBlk, IncludedBlockName),
+	PROTODB_POINTER(_nbNetPDLElementIncludeBlk, IncludedBlock)
+};
+
+static const size_t Pointers_nbNetPDLElementBlock[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementBlock),
+	PROTODB_POINTER(_nbNetPDLElementBlock, Name),
+	PROTODB_POINTER(_nbNetPDLElementBlock, LongName),
+	PROTODB_POINTER(_nbNetPDLElementBlock, ShowSumTemplateName),
+	PROTODB_POINTER(_nbNetPDLElementBlock, ShowSumTemplateInfo)
+};
+
+static const size_t Pointers_nbNetPDLElementSet[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementSet),
+	PROTODB_POINTER(_nbNetPDLElementSet, FieldToDecode),
+	PROTODB_POINTER(_nbNetPDLElementSet, FirstValidChildIfMissingPacketData),
+	PROTODB_POINTER(_nbNetPDLElementSet, ExitWhen),
+	PROTODB_POINTER(_nbNetPDLElementSet, FirstMatchElement)
+};
+
+static const size_t Pointers_nbNetPDLElementExitWhen[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementExitWhen),
+	PROTODB_POINTER(_nbNetPDLElementExitWhen, ExitExprString),
+	PROTODB_POINTER(_nbNetPDLElementExitWhen, ExitExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementChoice[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementChoice),
+	PROTODB_POINTER(_nbNetPDLElementChoice, FieldToDecode),
+	PROTODB_POINTER(_nbNetPDLElementChoice, FirstValidChildIfMissingPacketData),
+	PROTODB_POINTER(_nbNetPDLElementChoice, FirstMatchElement)
+};
+
+static const size_t Pointers_nbNetPDLElementAdt[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementAdt),
+	PROTODB_POINTER(_nbNetPDLElementAdt, ADTName),
+	PROTODB_POINTER(_nbNetPDLElementAdt, ProtoName),
+	PROTODB_POINTER(_nbNetPDLElementAdt, ADTFieldInfo)
+};
+
+static const size_t Pointers_nbNetPDLElementNextProto[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementNextProto),
+	PROTODB_POINTER(_nbNetPDLElementNextProto, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementNextProto, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldFixed[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldFixed)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldBit[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldBit),
+	PROTODB_POINTER(_nbNetPDLElementFieldBit, BitMaskString)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldVariable[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldVariable),
+	PROTODB_POINTER(_nbNetPDLElementFieldVariable, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldVariable, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldTokenEnded[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldTokenEnded),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndTokenString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndOffsetExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndOffsetExprTree),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndDiscardExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenEnded, EndDiscardExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldTokenWrapped[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldTokenWrapped),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, BeginTokenString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndTokenString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, BeginRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, BeginPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, BeginOffsetExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, BeginOffsetExprTree),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndOffsetExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndOffsetExprTree),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndDiscardExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldTokenWrapped, EndDiscardExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldLine[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldLine)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldPattern[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldPattern),
+	PROTODB_POINTER(_nbNetPDLElementFieldPattern, PatternRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementFieldPattern, PatternPCRECompiledRegExp)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldEatall[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldEatall)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldPadding[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldPadding)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldPlugin[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldPlugin),
+	PROTODB_POINTER(_nbNetPDLElementFieldPlugin, PluginName)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldTLV[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldTLV),
+	PROTODB_POINTER(_nbNetPDLElementCfieldTLV, ValueExprString),
+	PROTODB_POINTER(_nbNetPDLElementCfieldTLV, ValueExprTree),
+	PROTODB_POINTER(_nbNetPDLElementCfieldTLV, TypeSubfield),
+	PROTODB_POINTER(_nbNetPDLElementCfieldTLV, LengthSubfield),
+	PROTODB_POINTER(_nbNetPDLElementCfieldTLV, ValueSubfield)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldDelimited[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldDelimited),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDelimited, BeginRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDelimited, BeginPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDelimited, EndRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDelimited, EndPCRECompiledRegExp)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldLine[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldLine)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldHdrline[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldHdrline),
+	PROTODB_POINTER(_nbNetPDLElementCfieldHdrline, SeparatorRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementCfieldHdrline, SeparatorPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementCfieldHdrline, HeaderNameSubfield),
+	PROTODB_POINTER(_nbNetPDLElementCfieldHdrline, HeaderValueSubfield)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldDynamic[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldDynamic),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDynamic, PatternRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDynamic, PatternPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementCfieldDynamic, NamesList)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldASN1[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldASN1)
+};
+
+static const size_t Pointers_nbNetPDLElementCfieldXML[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementCfieldXML),
+	PROTODB_POINTER(_nbNetPDLElementCfieldXML, SizeExprString),
+	PROTODB_POINTER(_nbNetPDLElementCfieldXML, SizeExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementSubfield[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementSubfield),
+	PROTODB_POINTER(_nbNetPDLElementSubfield, PortionName),
+	PROTODB_POINTER(_nbNetPDLElementSubfield, ComplexSubfieldInfo)
+};
+
+static const size_t Pointers_nbNetPDLElementMapXMLPI[]=
+{
+	PROTODB_MAP_POINTERS(_nbNetPDLElementMapXMLPI),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLPI, XMLPIRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLPI, XMLPIPCRECompiledRegExp)
+};
+
+static const size_t Pointers_nbNetPDLElementMapXMLDoctype[]=
+{
+	PROTODB_MAP_POINTERS(_nbNetPDLElementMapXMLDoctype),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLDoctype, XMLDoctypeRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLDoctype, XMLDoctypePCRECompiledRegExp)
+};
+
+static const size_t Pointers_nbNetPDLElementMapXMLElement[]=
+{
+	PROTODB_MAP_POINTERS(_nbNetPDLElementMapXMLElement),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLElement, XMLElementRegularExpression),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLElement, XMLElementPCRECompiledRegExp),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLElement, NamespaceString),
+	PROTODB_POINTER(_nbNetPDLElementMapXMLElement, HierarcyString)
+};
+
+static const size_t Pointers_nbNetPDLElementAdtfield[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementAdtfield),
+	PROTODB_POINTER(_nbNetPDLElementAdtfield, CalledADTName)
+};
+
+static const size_t Pointers_nbNetPDLElementReplace[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementReplace),
+	PROTODB_POINTER(_nbNetPDLElementReplace, FieldToRename),
+	PROTODB_POINTER(_nbNetPDLElementReplace, NextReplace)
+};
+
+static const size_t Pointers_nbNetPDLElementFieldmatch[]=
+{
+	PROTODB_FIELD_POINTERS(_nbNetPDLElementFieldmatch),
+	PROTODB_POINTER(_nbNetPDLElementFieldmatch, MatchExprString),
+	PROTODB_POINTER(_nbNetPDLElementFieldmatch, MatchExprTree),
+	PROTODB_POINTER(_nbNetPDLElementFieldmatch, NextFieldmatch)
+};
+
+static const size_t Pointers_nbNetPDLElementShowTemplate[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementShowTemplate),
+	PROTODB_POINTER(_nbNetPDLElementShowTemplate, Name),
+	PROTODB_POINTER(_nbNetPDLElementShowTemplate, Separator),
+	PROTODB_POINTER(_nbNetPDLElementShowTemplate, PluginName),
+	PROTODB_POINTER(_nbNetPDLElementShowTemplate, MappingTableInfo),
+	PROTODB_POINTER(_nbNetPDLElementShowTemplate, CustomTemplateFirstField)
+};
+
+static const size_t Pointers_nbNetPDLElementShowSumTemplate[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementShowSumTemplate),
+	PROTODB_POINTER(_nbNetPDLElementShowSumTemplate, Name)
+};
+
+static const size_t Pointers_nbNetPDLElementShowSumStructure[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementShowSumStructure),
+	PROTODB_POINTER(_nbNetPDLElementShowSumStructure, Name),
+	PROTODB_POINTER(_nbNetPDLElementShowSumStructure, LongName)
+};
+
+static const size_t Pointers_nbNetPDLElementSection[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementSection),
+	PROTODB_POINTER(_nbNetPDLElementSection, SectionName)
+};
+
+static const size_t Pointers_nbNetPDLElementProtoHdr[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementProtoHdr)
+};
+
+static const size_t Pointers_nbNetPDLElementProtoField[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementProtoField),
+	PROTODB_POINTER(_nbNetPDLElementProtoField, FieldName)
+};
+
+static const size_t Pointers_nbNetPDLElementText[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementText),
+	PROTODB_POINTER(_nbNetPDLElementText, Value),
+	PROTODB_POINTER(_nbNetPDLElementText, ExprString),
+	PROTODB_POINTER(_nbNetPDLElementText, ExprTree)
+};
+
+static const size_t Pointers_nbNetPDLElementPacketHdr[]=
+{
+	PROTODB_ELEMENT_POINTERS(_nbNetPDLElementPacketHdr)
+};
+
+static const size_t Pointers_nbNetPDLExpression[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExpression),
+	PROTODB_POINTER(_nbNetPDLExpression, Operand1),
+	PROTODB_POINTER(_nbNetPDLExpression, Operator),
+	PROTODB_POINTER(_nbNetPDLExpression, Operand2)
+};
+
+static const size_t Pointers_nbNetPDLExprNumber[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprNumber)
+};
+
+static const size_t Pointers_nbNetPDLExprString[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprString),
+	PROTODB_POINTER(_nbNetPDLExprString, Value)
+};
+
+static const size_t Pointers_nbNetPDLExprProtoRef[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprProtoRef),
+	PROTODB_POINTER(_nbNetPDLExprProtoRef, ProtocolName)
+};
+
+static const size_t Pointers_nbNetPDLExprVariable[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprVariable),
+	PROTODB_POINTER(_nbNetPDLExprVariable, Name),
+	PROTODB_POINTER(_nbNetPDLExprVariable, OffsetStartAt),
+	PROTODB_POINTER(_nbNetPDLExprVariable, OffsetSize)
+};
+
+static const size_t Pointers_nbNetPDLExprLookupTable[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprLookupTable),
+	PROTODB_POINTER(_nbNetPDLExprLookupTable, TableName),
+	PROTODB_POINTER(_nbNetPDLExprLookupTable, FieldName),
+	PROTODB_POINTER(_nbNetPDLExprLookupTable, OffsetStartAt),
+	PROTODB_POINTER(_nbNetPDLExprLookupTable, OffsetSize)
+};
+
+static const size_t Pointers_nbNetPDLExprFieldRef[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFieldRef),
+	PROTODB_POINTER(_nbNetPDLExprFieldRef, Value),
+	PROTODB_POINTER(_nbNetPDLExprFieldRef, FieldName),
+	PROTODB_POINTER(_nbNetPDLExprFieldRef, ProtoName),
+	PROTODB_POINTER(_nbNetPDLExprFieldRef, OffsetStartAt),
+	PROTODB_POINTER(_nbNetPDLExprFieldRef, OffsetSize)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionRegExp[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionRegExp),
+	PROTODB_POINTER(_nbNetPDLExprFunctionRegExp, SearchBuffer),
+	PROTODB_POINTER(_nbNetPDLExprFunctionRegExp, RegularExpression),
+	PROTODB_POINTER(_nbNetPDLExprFunctionRegExp, PCRECompiledRegExp)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionIsASN1Type[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionIsASN1Type),
+	PROTODB_POINTER(_nbNetPDLExprFunctionIsASN1Type, StringExpression),
+	PROTODB_POINTER(_nbNetPDLExprFunctionIsASN1Type, ClassNumber),
+	PROTODB_POINTER(_nbNetPDLExprFunctionIsASN1Type, TagNumber)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionBuf2Int[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionBuf2Int),
+	PROTODB_POINTER(_nbNetPDLExprFunctionBuf2Int, StringExpression)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionInt2Buf[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionInt2Buf),
+	PROTODB_POINTER(_nbNetPDLExprFunctionInt2Buf, NumericExpression)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionIsPresent[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionIsPresent),
+	PROTODB_POINTER(_nbNetPDLExprFunctionIsPresent, NetPDLField)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionAscii2Int[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionAscii2Int),
+	PROTODB_POINTER(_nbNetPDLExprFunctionAscii2Int, AsciiStringExpression)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionChangeByteOrder[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionChangeByteOrder),
+	PROTODB_POINTER(_nbNetPDLExprFunctionChangeByteOrder, OriginalStringExpression)
+};
+
+static const size_t Pointers_nbParamsLinkedList[]=
+{
+	PROTODB_POINTER(_nbParamsLinkedList, Expression),
+	PROTODB_POINTER(_nbParamsLinkedList, NextParameter)
+};
+
+static const size_t Pointers_nbNetPDLExprFunctionCheckUpdateLookupTable[]=
+{
+	PROTODB_OPERAND_POINTERS(_nbNetPDLExprFunctionCheckUpdateLookupTable),
+	PROTODB_POINTER(_nbNetPDLExprFunctionCheckUpdateLookupTable, TableName),
+	PROTODB_POINTER(_nbNetPDLExprFunctionCheckUpdateLookupTable, ParameterList)
+};
+
+
+const struct _ProtoDBLayout ProtoDBLayouts[PROTODB_LAYOUT_COUNT]=
+{
+	{"raw data", 0, NULL, 0},
+	{"list of pointers", 0, NULL, 0},
+
+#define PROTODB_LAYOUT_STRUCT(StructName) {#StructName, sizeof(struct StructName), Pointers##StructName, sizeof(Pointers##StructName) / sizeof(size_t)},
+	PROTODB_LAYOUT_STRUCTS
+#undef PROTODB_LAYOUT_STRUCT
+};
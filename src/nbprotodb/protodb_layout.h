@@ -0,0 +1,138 @@
+/*****************************************************************************/
+/*                                                                           */
+/* Copyright notice: please read file license.txt in the NetBee root folder. */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+// Allow including this file only once
+#pragma once
+
+
+#include <stddef.h>
+
+
+/*!
+	\brief Layouts of the blocks of the protodb heap.
+
+	The layout of a block tells where the pointers to other blocks are, so that they can be
+	relocated when the database is saved into a binary image (see protodb_image.cpp).
+	Each structure of the database has its own layout, which lists the offsets of its pointers.
+
+	Members that are declared as pointers but do not refer to the database are not part of the layouts:
+	the IDs stored by the NetPDL engine in the 'CustomData' members, the call handlers and the
+	compiled code of the expressions.
+*/
+
+
+//! Structures allocated in the heap; the layout of each one is PROTODB_LAYOUT followed by the name of the structure
+#define PROTODB_LAYOUT_STRUCTS \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementBase) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLDatabase) \
+	PROTODB_LAYOUT_STRUCT(_nbCallHandlerInfo) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementProto) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementExecuteX) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementVariable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementLookupTable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementKeyData) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementAlias) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementAssignVariable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementAssignLookupTable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementUpdateLookupTable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementLookupKeyData) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementIf) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCase) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementSwitch) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementLoop) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementLoopCtrl) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementIncludeBlk) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementBlock) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementSet) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementExitWhen) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementChoice) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementAdt) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementNextProto) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldFixed) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldBit) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldVariable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldTokenEnded) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldTokenWrapped) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldLine) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldPattern) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldEatall) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldPadding) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldPlugin) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldTLV) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldDelimited) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldLine) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldHdrline) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldDynamic) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldASN1) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementCfieldXML) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementSubfield) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementMapXMLPI) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementMapXMLDoctype) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementMapXMLElement) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementAdtfield) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementReplace) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementFieldmatch) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementShowTemplate) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementShowSumTemplate) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementShowSumStructure) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementSection) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementProtoHdr) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementProtoField) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementText) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLElementPacketHdr) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExpression) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprNumber) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprString) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprProtoRef) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprVariable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprLookupTable) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFieldRef) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionRegExp) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionIsASN1Type) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionBuf2Int) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionInt2Buf) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionIsPresent) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionAscii2Int) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionChangeByteOrder) \
+	PROTODB_LAYOUT_STRUCT(_nbParamsLinkedList) \
+	PROTODB_LAYOUT_STRUCT(_nbNetPDLExprFunctionCheckUpdateLookupTable)
+
+
+//! Layouts of the blocks of the heap
+enum ProtoDBLayouts
+{
+	//! The block contains raw data (e.g. strings or compiled regular expressions), without pointers
+	PROTODB_LAYOUT_RAW= 0,
+	//! The block is an array of pointers (e.g. a list of elements)
+	PROTODB_LAYOUT_POINTERS,
+
+#define PROTODB_LAYOUT_STRUCT(StructName) PROTODB_LAYOUT##StructName,
+	PROTODB_LAYOUT_STRUCTS
+#undef PROTODB_LAYOUT_STRUCT
+
+	//! Number of layouts
+	PROTODB_LAYOUT_COUNT
+};
+
+
+//! Layout of a structure
+struct _ProtoDBLayout
+{
+	//! Name of the structure
+	const char *Name;
+	//! Size of the structure
+	size_t Size;
+	//! Offsets of the pointers within the structure
+	const size_t *Pointers;
+	//! Number of pointers
+	unsigned int NPointers;
+};
+
+
+//! Layouts of the blocks, indexed by #ProtoDBLayouts (the entries of raw data and arrays of pointers are empty)
+extern const struct _ProtoDBLayout ProtoDBLayouts[PROTODB_LAYOUT_COUNT];
@@ -118,7 +118,7 @@ int Result;
  
 
 	// Create main structure in memory
-	NetPDLDatabase= (struct _nbNetPDLDatabase *) malloc(sizeof(struct _nbNetPDLDatabase));
+	NetPDLDatabase= ProtoDBAllocStruct(_nbNetPDLDatabase);
 	if (NetPDLDatabase == NULL)
 	{
 		errorsnprintf(__FILE__, __FUNCTION__, __LINE__, m_errbuf, sizeof(m_errbuf), "Not enough memory for building the protocol database.");
@@ -128,7 +128,7 @@ int Result;
 
 	NetPDLDatabase->Flags= Flags;
 
-	NetPDLDatabase->GlobalElementsList= (struct _nbNetPDLElementBase **) malloc(sizeof(struct _nbNetPDLElementBase *) * NETPDL_MAX_NELEMENTS);
+	NetPDLDatabase->GlobalElementsList= (struct _nbNetPDLElementBase **) ProtoDBAllocPointers(NETPDL_MAX_NELEMENTS);
 
 	if (NetPDLDatabase->GlobalElementsList == NULL)
 	{
@@ -352,7 +352,7 @@ int Result;
 			NetPDLElementAdtfield= NULL;
 
 			// Deallocate data structure related to current 'ADTFIELD' element
-			free(NetPDLDatabase->GlobalElementsList[i]);
+			ProtoDBFree(NetPDLDatabase->GlobalElementsList[i]);
 			NetPDLDatabase->GlobalElementsList[i]= NULL;
 
 			// Assign suited 'FIELD' element whose adt is based on
@@ -401,8 +401,8 @@ int Result;
 				}
 			}
 
-			// Let's allocate new NetPDL field element to replace the 'ADTFIELD' just removed
-			NetPDLDatabase->GlobalElementsList[i]= (struct _nbNetPDLElementBase *) malloc(SizeToDuplicate);
+			// Let's create a copy of the NetPDL field element to replace the 'ADTFIELD' just removed
+			NetPDLDatabase->GlobalElementsList[i]= (struct _nbNetPDLElementBase *) ProtoDBDuplicate(NetPDLElementADTWanted->ADTFieldInfo, SizeToDuplicate);
 
 			if (NetPDLDatabase->GlobalElementsList[i] == NULL)
 			{
@@ -412,9 +412,6 @@ int Result;
 				goto ClearAndExit;
 			}
 
-			// Let's copy all saved information to the new field element
-			memcpy(NetPDLDatabase->GlobalElementsList[i], NetPDLElementADTWanted->ADTFieldInfo, SizeToDuplicate);
-
 			// Let's restore links for the 'ADTFIELD' replacement
 			NetPDLDatabase->GlobalElementsList[i]->Parent= NetPDLElementAdtfieldBuf.Parent;
 			NetPDLDatabase->GlobalElementsList[i]->FirstChild= NetPDLElementAdtfieldBuf.FirstChild;
@@ -424,9 +421,9 @@ int Result;
 			// Let's overwrite name, longname, ..., if needed
 			NetPDLElementField= (struct _nbNetPDLElementFieldBase *) NetPDLDatabase->GlobalElementsList[i];
 			NetPDLElementField->Type= nbNETPDL_IDEL_FIELD;
-			NetPDLElementField->Name= NetPDLElementAdtfieldBuf.Name ? NetPDLElementAdtfieldBuf.Name : strdup(NetPDLElementADTWanted->ADTFieldInfo->Name);
-			NetPDLElementField->LongName= NetPDLElementAdtfieldBuf.LongName ? NetPDLElementAdtfieldBuf.LongName : strdup(NetPDLElementADTWanted->ADTFieldInfo->LongName);
-			NetPDLElementField->ShowTemplateName= NetPDLElementAdtfieldBuf.ShowTemplateName ? NetPDLElementAdtfieldBuf.ShowTemplateName : strdup(NetPDLElementADTWanted->ADTFieldInfo->ShowTemplateName);
+			NetPDLElementField->Name= NetPDLElementAdtfieldBuf.Name ? NetPDLElementAdtfieldBuf.Name : ProtoDBStrdup(NetPDLElementADTWanted->ADTFieldInfo->Name);
+			NetPDLElementField->LongName= NetPDLElementAdtfieldBuf.LongName ? NetPDLElementAdtfieldBuf.LongName : ProtoDBStrdup(NetPDLElementADTWanted->ADTFieldInfo->LongName);
+			NetPDLElementField->ShowTemplateName= NetPDLElementAdtfieldBuf.ShowTemplateName ? NetPDLElementAdtfieldBuf.ShowTemplateName : ProtoDBStrdup(NetPDLElementADTWanted->ADTFieldInfo->ShowTemplateName);
 			NetPDLElementField->ShowTemplateInfo= NetPDLElementAdtfieldBuf.ShowTemplateInfo ? NetPDLElementAdtfieldBuf.ShowTemplateInfo : NetPDLElementADTWanted->ADTFieldInfo->ShowTemplateInfo;
 			NetPDLElementField->ADTRef= NetPDLElementAdtfieldBuf.CalledADTName;
 
@@ -461,8 +458,9 @@ int Result;
 ClearAndExit:
 	if (SAXParser)
 		delete SAXParser;
-	if (NetPDLDatabase)
-		free(NetPDLDatabase);
+	// Release whatever has been allocated so far
+	ProtoDBHeapRelease();
+	NetPDLDatabase= NULL;
 	return NULL;
 }
 
@@ -475,46 +473,13 @@ ClearAndExit:
 */
 void CNetPDLSAXParser::Cleanup()
 {
-	// The expression list must not be deleted here; expressions have the Next member
-	// in the definition of their base structure; therefore the linked list is automatically
-	// cleared when deleting expressions.
+	// The expression list must not be deleted here; expressions are part of the database
 	FirstExpression= NULL;
 
-	// TEMP FABIO 20/05/2008: erase copies of ADT created at NetPDL Database creation time
-	// Scan all ADT duplicated copies in order to delete them (they were been created by dynamic allocation)
-	for (unsigned int i= NetPDLDatabase->GlobalElementsListNItems; i < NetPDLDatabase->GlobalElementsListNItemsPlusADTCopies; i++)
-	{
-		free(NetPDLDatabase->GlobalElementsList[i]);
-	}
-
-	// Scan all the elements in order to delete dynamic allocations in them
-	for (unsigned int i= 1; i < NetPDLDatabase->GlobalElementsListNItems; i++)
-	{
-	struct _nbNetPDLElementBase *NetPDLElement;
-
-		NetPDLElement= NetPDLDatabase->GlobalElementsList[i];
-
-		if (NetPDLElement->CallHandlerInfo)
-		{
-			DELETE_PTR(NetPDLElement->CallHandlerInfo->FunctionName);
-			DELETE_PTR(NetPDLElement->CallHandlerInfo);
-		}
-
-		ElementList[NetPDLElement->Type].NetPDLElementDeleteHandler(NetPDLElement);
-	}
-
-	FREE_PTR(NetPDLDatabase->ProtoList);
-	FREE_PTR(NetPDLDatabase->ShowSumStructureList);
-	FREE_PTR(NetPDLDatabase->ShowSumTemplateList);
-	FREE_PTR(NetPDLDatabase->ShowTemplateList);
-	DELETE_PTR(NetPDLDatabase->ADTList);
-
-	FREE_PTR(NetPDLDatabase->GlobalElementsList);
-
-	FREE_PTR(NetPDLDatabase->Creator);
-	FREE_PTR(NetPDLDatabase->CreationDate);
-
-	FREE_PTR(NetPDLDatabase);
+	// All the structures of the database (elements, ADT copies, expressions, lists) have been
+	// allocated in the protodb heap, hence they are released all together.
+	ProtoDBHeapRelease();
+	NetPDLDatabase= NULL;
 }
 
 
@@ -643,7 +608,7 @@ struct _nbNetPDLElementBase *NetPDLTempElement;
 
 					DuplicateADT(NetPDLFieldElement->ADTRef, NetPDLTempElement, NETPDL_GET_ELEMENT(NetPDLElementADTWanted->FirstChild), (struct _nbNetPDLElementReplace *) NETPDL_GET_ELEMENT(NetPDLTempElement->FirstChild));
 
-					DELETE_PTR(NetPDLFieldElement->ADTRef);
+					ProtoDBFree(NetPDLFieldElement->ADTRef);
 					NetPDLFieldElement->ADTRef= NULL;
 				}
 
@@ -823,7 +788,7 @@ size_t SizeToDuplicate;
 		}
 
 		// Let's create a copy of current element from ADT
-		NetPDLTempElementDup= (struct _nbNetPDLElementBase *) malloc(SizeToDuplicate);
+		NetPDLTempElementDup= (struct _nbNetPDLElementBase *) ProtoDBDuplicate(NetPDLTempElementFromADT, SizeToDuplicate);
 
 		if (NetPDLTempElementDup == NULL)
 		{
@@ -833,8 +798,6 @@ size_t SizeToDuplicate;
 			return nbFAILURE;
 		}
 
-		memcpy(NetPDLTempElementDup, NetPDLTempElementFromADT, SizeToDuplicate);
-
 		// Let's perform replacing, if it is needed
 		if (NetPDLElementField)
 		{
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following condition
+ * is met:
+ *
+ * Neither the name of the Politecnico di Torino nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pcap.h>
+#include <nbee.h>
+#include "configparams.h"
+
+
+// Global variable for configuration
+ConfigParams_t ConfigParams;
+
+
+void Usage()
+{
+	char string0[]=	\
+		"Usage:                                                                         \n"	\
+		"  nbeebench [-netpdl filename] -r filename [-f filename] [-c n_packets]        \n"	\
+		"            [-loops n] [-warmup n] [-engines list] [-noopt] [-csv]             \n"	\
+		"            [-o filename] [-h] [filterstring ...]                              \n"	\
+		"                                                                               \n"	\
+		"                                                                               \n"	\
+		"Options:                                                                       \n"	\
+		" -h                                                                            \n"	\
+		"        Print this help.                                                       \n"	\
+		" -netpdl filename                                                              \n"	\
+		"        Name of the file containing the NetPDL description. In case it is      \n"	\
+		"        omitted, the NetPDL description embedded within the NetBee library will\n"	\
+		"        be used.                                                               \n"	\
+		" -r filename                                                                   \n"	\
+		"        Name of the pcap file containing the packets used for the benchmark.   \n"	\
+		"        Packets are loaded in memory before starting, so that disk access does \n"	\
+		"        not influence the measurements.                                        \n"	\
+		" -f filename                                                                   \n"	\
+		"        Name of a file containing the NetPFL filters to be benchmarked, one per\n"	\
+		"        line. Empty lines and lines starting with '#' are ignored.             \n"	\
+		" -c n_packets                                                                  \n"	\
+		"        Load only the first n_packets packets of the capture file.             \n"	\
+		" -loops n                                                                      \n"	\
+		"        Number of times the whole capture is processed for measuring the       \n"	\
+		"        throughput (default: 10).                                              \n"	\
+		" -warmup n                                                                     \n"	\
+		"        Number of times the whole capture is processed before measuring        \n"	\
+		"        (default: 1).                                                          \n"	\
+		" -engines list                                                                 \n"	\
+		"        Comma-separated list of the engines to be benchmarked, among           \n"	\
+		"        'interpreter', 'jit', 'decoder' and 'hexdump' (default: all of them).  \n"	\
+		"        The decoder and the hexdump (i.e. the conversion of each packet into   \n"	\
+		"        hex text and back) do not depend on the filters, hence they are        \n"	\
+		"        benchmarked only once.                                                 \n"	\
+		" -noopt                                                                        \n"	\
+		"        Do not optimize the intermediate code before producing the NetIL code. \n"	\
+		" -csv                                                                          \n"	\
+		"        Print the results in CSV format (one line per run) instead of JSON.    \n"	\
+		" -o filename                                                                   \n"	\
+		"        Write the results to the given file instead of standard output.        \n"	\
+		" filterstring                                                                  \n"	\
+		"        Filter (in the NetPFL syntax) to be benchmarked; it can be repeated,   \n"	\
+		"        and it can be used together with the '-f' option.                      \n";
+	printf("\n%s", string0);
+
+	char string1[]=	\
+		"                                                                               \n"	\
+		"Description                                                                    \n"	\
+		"===============================================================================\n"	\
+		"This program measures the performance of the whole NetBee pipeline (NetPFL     \n"	\
+		"filters executed by the NetVM, and the NetPDL decoder) on the packets of a     \n"	\
+		"capture file. For each filter and engine it reports the throughput, the        \n"	\
+		"distribution of the CPU ticks spent on each packet, the number of memory       \n"	\
+		"allocations per packet and the peak memory usage of the process, in a          \n"	\
+		"machine-readable format that can be compared among different versions.        \n"	\
+		"                                                                               \n";
+	printf("%s", string1);
+
+	printf("\n");
+}
+
+
+int LoadFilterFile(const char *FileName)
+{
+FILE *FilterFile;
+char Line[4096];
+char *Begin, *End;
+
+	FilterFile= fopen(FileName, "r");
+	if (FilterFile == NULL)
+	{
+		printf("Cannot open the filter file '%s'.\n", FileName);
+		return nbFAILURE;
+	}
+
+	while (fgets(Line, sizeof(Line), FilterFile) != NULL)
+	{
+		// Strip leading and trailing blanks (including the newline)
+		Begin= Line;
+		while ((*Begin == ' ') || (*Begin == '\t'))
+			Begin++;
+		End= Begin + strlen(Begin);
+		while ((End > Begin) && ((End[-1] == '\n') || (End[-1] == '\r') || (End[-1] == ' ') || (End[-1] == '\t')))
+			End--;
+		*End= 0;
+
+		if ((*Begin == 0) || (*Begin == '#'))
+			continue;
+
+		if (ConfigParams.NFilters == MAX_FILTERS)
+		{
+			printf("Too many filters: at most %d filters can be benchmarked at once.\n", MAX_FILTERS);
+			fclose(FilterFile);
+			return nbFAILURE;
+		}
+		ConfigParams.Filters[ConfigParams.NFilters++]= strdup(Begin);
+	}
+
+	fclose(FilterFile);
+	return nbSUCCESS;
+}
+
+
+int ParseCommandLine(int argc, char *argv[])
+{
+int CurrentItem;
+
+	CurrentItem= 1;
+
+	// Default values
+	ConfigParams.NetPDLFileName= NULL;
+	ConfigParams.CaptureFileName= NULL;
+	ConfigParams.FilterFileName= NULL;
+	ConfigParams.OutputFileName= NULL;
+	ConfigParams.NFilters= 0;
+	ConfigParams.Engines= ENGINE_INTERPRETER | ENGINE_JIT | ENGINE_DECODER | ENGINE_HEXDUMP;
+	ConfigParams.NPackets= 0;
+	ConfigParams.Loops= 10;
+	ConfigParams.WarmupLoops= 1;
+	ConfigParams.Optimization= true;
+	ConfigParams.CSVOutput= false;
+	// End defaults
+
+	while (CurrentItem < argc)
+	{
+		if (strcmp(argv[CurrentItem], "-h") == 0)
+		{
+			Usage();
+			return nbFAILURE;
+		}
+
+		if (strcmp(argv[CurrentItem], "-noopt") == 0)
+		{
+			ConfigParams.Optimization= false;
+			CurrentItem+= 1;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-csv") == 0)
+		{
+			ConfigParams.CSVOutput= true;
+			CurrentItem+= 1;
+			continue;
+		}
+
+		// All the other switches need an argument
+		if ((argv[CurrentItem][0] == '-') && (CurrentItem + 1 >= argc))
+		{
+			printf("Option '%s' requires an argument.\n", argv[CurrentItem]);
+			return nbFAILURE;
+		}
+
+		if (strcmp(argv[CurrentItem], "-netpdl") == 0)
+		{
+			ConfigParams.NetPDLFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-r") == 0)
+		{
+			ConfigParams.CaptureFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-f") == 0)
+		{
+			ConfigParams.FilterFileName= argv[CurrentItem+1];
+			if (LoadFilterFile(ConfigParams.FilterFileName) == nbFAILURE)
+				return nbFAILURE;
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-o") == 0)
+		{
+			ConfigParams.OutputFileName= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-c") == 0)
+		{
+			ConfigParams.NPackets= atoi(argv[CurrentItem+1]);
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-loops") == 0)
+		{
+			ConfigParams.Loops= atoi(argv[CurrentItem+1]);
+			if (ConfigParams.Loops < 1)
+			{
+				printf("The number of loops must be at least 1.\n");
+				return nbFAILURE;
+			}
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-warmup") == 0)
+		{
+			ConfigParams.WarmupLoops= atoi(argv[CurrentItem+1]);
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-engines") == 0)
+		{
+		char List[256];
+		char *Engine;
+
+			strncpy(List, argv[CurrentItem+1], sizeof(List));
+			List[sizeof(List) - 1]= 0;
+
+			ConfigParams.Engines= 0;
+			for (Engine= strtok(List, ","); Engine != NULL; Engine= strtok(NULL, ","))
+			{
+				if (strcmp(Engine, "interpreter") == 0)
+					ConfigParams.Engines|= ENGINE_INTERPRETER;
+				else if (strcmp(Engine, "jit") == 0)
+					ConfigParams.Engines|= ENGINE_JIT;
+				else if (strcmp(Engine, "decoder") == 0)
+					ConfigParams.Engines|= ENGINE_DECODER;
+				else if (strcmp(Engine, "hexdump") == 0)
+					ConfigParams.Engines|= ENGINE_HEXDUMP;
+				else
+				{
+					printf("Unknown engine '%s'.\n", Engine);
+					return nbFAILURE;
+				}
+			}
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (argv[CurrentItem][0] == '-')
+		{
+			printf("Unknown option '%s'.\n", argv[CurrentItem]);
+			return nbFAILURE;
+		}
+
+		// Anything else is a filter
+		if (ConfigParams.NFilters == MAX_FILTERS)
+		{
+			printf("Too many filters: at most %d filters can be benchmarked at once.\n", MAX_FILTERS);
+			return nbFAILURE;
+		}
+		ConfigParams.Filters[ConfigParams.NFilters++]= strdup(argv[CurrentItem]);
+		CurrentItem+= 1;
+	}
+
+	if (ConfigParams.CaptureFileName == NULL)
+	{
+		printf("The capture file must be specified through the '-r' option.\n");
+		Usage();
+		return nbFAILURE;
+	}
+
+	if ((ConfigParams.NFilters == 0) && ((ConfigParams.Engines & (ENGINE_INTERPRETER | ENGINE_JIT)) != 0))
+	{
+		printf("At least one filter must be specified for benchmarking the NetVM engines.\n");
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following condition
+ * is met:
+ *
+ * Neither the name of the Politecnico di Torino nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pcap.h>
+
+
+//! Maximum number of filters that can be benchmarked in a single run
+#define MAX_FILTERS 64
+
+
+//! Engines that can be benchmarked (they can be OR-ed together)
+enum
+{
+	ENGINE_INTERPRETER= 1,	//!< NetVM running the NetIL code through the interpreter
+	ENGINE_JIT= 2,			//!< NetVM running the native code generated by the JIT backend of this platform
+	ENGINE_DECODER= 4,		//!< NetPDL packet decoder (PDML and PSML generation); it does not depend on the filter
+	ENGINE_HEXDUMP= 8		//!< Conversion of the packets into hex text and back, as done when the PDML is generated
+};
+
+
+// Global variables for configuration
+
+struct _ConfigParams
+{
+	const char*	NetPDLFileName;
+	const char*	CaptureFileName;
+	const char*	FilterFileName;
+	const char*	OutputFileName;
+	char*		Filters[MAX_FILTERS];
+	int			NFilters;
+	int			Engines;
+	u_long		NPackets;
+	int			Loops;
+	int			WarmupLoops;
+	bool		Optimization;
+	bool		CSVOutput;
+};
+typedef struct _ConfigParams ConfigParams_t;
+
+// Prototypes
+void Usage();
+int ParseCommandLine(int argc, char *argv[]);
+int LoadFilterFile(const char *FileName);
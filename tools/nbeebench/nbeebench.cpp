@@ -0,0 +1,871 @@
+/*
+ * Copyright (c) 2002 - 2011
+ * NetGroup, Politecnico di Torino (Italy)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following condition
+ * is met:
+ *
+ * Neither the name of the Politecnico di Torino nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <pcap.h>
+#include "configparams.h"
+
+#include <nbee.h>
+#include <nbnetvm.h>		// Needed to get the list of the JIT backends
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+  #define snprintf _snprintf
+#endif
+
+
+// Global variable for configuration
+extern ConfigParams_t ConfigParams;
+
+
+/*
+	Memory allocations are counted by replacing the allocation functions of the C library (which
+	are used by the C++ 'new' operator as well). This is possible only with the GNU C library;
+	on the other platforms allocations are not reported.
+*/
+#ifdef __GLIBC__
+#define ALLOCATION_COUNTERS
+
+extern "C" {
+void *__libc_malloc(size_t Size);
+void *__libc_calloc(size_t NMemb, size_t Size);
+void *__libc_realloc(void *Ptr, size_t Size);
+}
+
+static volatile uint64_t AllocationCount;		//!< Number of memory allocations since the program started
+static volatile uint64_t AllocatedBytes;		//!< Number of bytes allocated since the program started
+
+extern "C" void *malloc(size_t Size) __THROW
+{
+	__sync_fetch_and_add(&AllocationCount, 1);
+	__sync_fetch_and_add(&AllocatedBytes, Size);
+	return __libc_malloc(Size);
+}
+
+extern "C" void *calloc(size_t NMemb, size_t Size) __THROW
+{
+	__sync_fetch_and_add(&AllocationCount, 1);
+	__sync_fetch_and_add(&AllocatedBytes, NMemb * Size);
+	return __libc_calloc(NMemb, Size);
+}
+
+extern "C" void *realloc(void *Ptr, size_t Size) __THROW
+{
+	__sync_fetch_and_add(&AllocationCount, 1);
+	__sync_fetch_and_add(&AllocatedBytes, Size);
+	return __libc_realloc(Ptr, Size);
+}
+#endif
+
+
+//! Packets of the capture file, loaded in memory one after the other
+struct _Capture
+{
+	unsigned char *Buffer;			//!< Data of all the packets
+	struct pcap_pkthdr *Headers;	//!< Pcap header of each packet
+	unsigned char **Packets;		//!< Pointer to the data of each packet (within 'Buffer')
+	u_long NPackets;
+	uint64_t NBytes;				//!< Total length of the packets
+	nbNetPDLLinkLayer_t LinkLayer;
+};
+typedef struct _Capture Capture_t;
+
+
+//! Percentiles of the ticks per packet that are reported
+static const double Percentiles[]= {50, 90, 99, 99.9};
+static const char *PercentileNames[]= {"p50", "p90", "p99", "p999"};
+#define NUM_PERCENTILES (sizeof(Percentiles) / sizeof(Percentiles[0]))
+
+//! Columns of the CSV output; the ticks percentiles are printed between the result and the trailing columns
+static const char *CSVSetupColumns[]= {"capture", "packets", "loops", "ticks_per_usec", "engine", "filter", "status"};
+static const char *CSVResultColumns[]= {"setup_ms", "accepted", "seconds", "mpps", "gbps", "ticks_mean"};
+static const char *CSVTrailingColumns[]= {"ticks_max", "allocs_per_pkt", "alloc_bytes_per_pkt", "peak_rss_kb", "error"};
+#define NUM_CSV_SETUP_COLUMNS (sizeof(CSVSetupColumns) / sizeof(CSVSetupColumns[0]))
+#define NUM_CSV_RESULT_COLUMNS (sizeof(CSVResultColumns) / sizeof(CSVResultColumns[0]))
+#define NUM_CSV_TRAILING_COLUMNS (sizeof(CSVTrailingColumns) / sizeof(CSVTrailingColumns[0]))
+
+
+//! Results of the benchmark of an engine on a filter
+struct _BenchResult
+{
+	char Engine[64];
+	const char *Filter;				//!< NULL for the engines that do not depend on the filter
+	bool Failed;
+	char ErrBuf[1024];				//!< Reason of the failure (if 'Failed' is set)
+
+	double SetupMs;					//!< Time needed to compile the filter and start the NetVM
+	uint64_t Packets;				//!< Packets processed in the measured loops
+	uint64_t Accepted;				//!< Packets accepted by the filter (or decoded without errors) in the measured loops
+	double Seconds;					//!< Duration of the measured loops
+	double Mpps;
+	double Gbps;
+	int64_t TicksMean;				//!< Mean of the CPU ticks per packet
+	int64_t TicksPercentiles[NUM_PERCENTILES];
+	int64_t TicksMax;
+	double AllocsPerPacket;			//!< Memory allocations per packet (negative if they cannot be counted)
+	double AllocBytesPerPacket;
+	long PeakRSS;					//!< Peak resident set size of the process so far, in KB (negative if not available)
+};
+typedef struct _BenchResult BenchResult_t;
+
+
+/*!
+	\brief Something whose performance is measured on the packets of the capture.
+*/
+class BenchTarget
+{
+public:
+	virtual ~BenchTarget() {};
+
+	//! Processes the given packet of the capture; returns nbSUCCESS if the packet is accepted, nbFAILURE otherwise.
+	virtual int Process(u_long Index)= 0;
+};
+
+
+//! NetVM running a filter (either with the interpreter or with the JIT).
+class PacketEngineTarget: public BenchTarget
+{
+	nbPacketEngine *m_PacketEngine;
+	Capture_t *m_Capture;
+
+public:
+	PacketEngineTarget(nbPacketEngine *PacketEngine, Capture_t *Capture): m_PacketEngine(PacketEngine), m_Capture(Capture) {};
+
+	int Process(u_long Index)
+	{
+		return m_PacketEngine->ProcessPacket(m_Capture->Packets[Index], m_Capture->Headers[Index].caplen);
+	}
+};
+
+
+//! NetPDL decoder generating the PDML and PSML fragments of each packet.
+class DecoderTarget: public BenchTarget
+{
+	nbPacketDecoder *m_Decoder;
+	Capture_t *m_Capture;
+	int m_PacketCounter;
+
+public:
+	DecoderTarget(nbPacketDecoder *Decoder, Capture_t *Capture): m_Decoder(Decoder), m_Capture(Capture), m_PacketCounter(0) {};
+
+	int Process(u_long Index)
+	{
+		return m_Decoder->DecodePacket(m_Capture->LinkLayer, ++m_PacketCounter, &m_Capture->Headers[Index], m_Capture->Packets[Index]);
+	}
+};
+
+
+//! Conversion of each packet into hex text (as in the PDML 'dump' element) and back.
+class HexDumpTarget: public BenchTarget
+{
+	Capture_t *m_Capture;
+	char *m_HexDump;
+	unsigned char *m_BinDump;
+	int m_BufferSize;
+
+public:
+	HexDumpTarget(Capture_t *Capture): m_Capture(Capture)
+	{
+	u_long i;
+
+		m_BufferSize= 1;
+		for (i= 0; i < Capture->NPackets; i++)
+			m_BufferSize= std::max(m_BufferSize, (int) Capture->Headers[i].caplen * 2 + 1);
+
+		m_HexDump= new char[m_BufferSize];
+		m_BinDump= new unsigned char[m_BufferSize];
+	};
+
+	~HexDumpTarget()
+	{
+		delete[] m_HexDump;
+		delete[] m_BinDump;
+	};
+
+	int Process(u_long Index)
+	{
+		if (nbNetPDLUtils::HexDumpBinToHexDumpAscii((char *) m_Capture->Packets[Index], m_Capture->Headers[Index].caplen,
+				1 /* network byte order */, m_HexDump, m_BufferSize) == nbFAILURE)
+			return nbFAILURE;
+
+		if (nbNetPDLUtils::HexDumpAsciiToHexDumpBin(m_HexDump, m_BinDump, m_BufferSize) == nbFAILURE)
+			return nbFAILURE;
+
+		return nbSUCCESS;
+	}
+};
+
+
+long GetPeakRSS()
+{
+#ifdef WIN32
+PROCESS_MEMORY_COUNTERS Counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)) == 0)
+		return -1;
+	return (long) (Counters.PeakWorkingSetSize / 1024);
+#else
+struct rusage Usage;
+
+	if (getrusage(RUSAGE_SELF, &Usage) != 0)
+		return -1;
+#ifdef __APPLE__
+	return (long) (Usage.ru_maxrss / 1024);
+#else
+	return (long) Usage.ru_maxrss;
+#endif
+#endif
+}
+
+
+/*!
+	\brief Returns how many CPU ticks (as returned by nbProfilerGetTime()) elapse in a microsecond.
+*/
+double GetTicksPerMicrosecond()
+{
+uint64_t StartMicro, StartTicks, EndMicro, EndTicks;
+
+	StartMicro= nbProfilerGetMicro();
+	StartTicks= nbProfilerGetTime();
+	do
+	{
+		EndMicro= nbProfilerGetMicro();
+	} while (EndMicro - StartMicro < 100000);
+	EndTicks= nbProfilerGetTime();
+
+	return (double) (EndTicks - StartTicks) / (double) (EndMicro - StartMicro);
+}
+
+
+int LoadCapture(const char *FileName, u_long MaxPackets, Capture_t *Capture, char *ErrBuf, int ErrBufSize)
+{
+char PcapErrBuf[PCAP_ERRBUF_SIZE];
+pcap_t *PcapHandle;
+struct pcap_pkthdr *PktHeader;
+const unsigned char *PktData;
+uint64_t BufferSize= 0;
+u_long MaxHeaders= 0;
+u_long i;
+uint64_t Offset;
+int RetVal;
+
+	memset(Capture, 0, sizeof(Capture_t));
+
+	PcapHandle= pcap_open_offline(FileName, PcapErrBuf);
+	if (PcapHandle == NULL)
+	{
+		snprintf(ErrBuf, ErrBufSize, "Cannot open the capture file: %s", PcapErrBuf);
+		return nbFAILURE;
+	}
+
+	Capture->LinkLayer= (nbNetPDLLinkLayer_t) pcap_datalink(PcapHandle);
+
+	while ((MaxPackets == 0) || (Capture->NPackets < MaxPackets))
+	{
+		RetVal= pcap_next_ex(PcapHandle, &PktHeader, &PktData);
+		if (RetVal == -2)
+			break;
+		if (RetVal < 0)
+		{
+			snprintf(ErrBuf, ErrBufSize, "Cannot read a packet: %s", pcap_geterr(PcapHandle));
+			pcap_close(PcapHandle);
+			return nbFAILURE;
+		}
+
+		// Both the headers and the packets are kept in arrays that grow when needed
+		if (Capture->NPackets == MaxHeaders)
+		{
+			MaxHeaders= (MaxHeaders == 0) ? 1024 : MaxHeaders * 2;
+			Capture->Headers= (struct pcap_pkthdr *) realloc(Capture->Headers, MaxHeaders * sizeof(struct pcap_pkthdr));
+		}
+		if (Capture->NBytes + PktHeader->caplen > BufferSize)
+		{
+			BufferSize= (BufferSize == 0) ? 1024 * 1024 : BufferSize * 2;
+			while (Capture->NBytes + PktHeader->caplen > BufferSize)
+				BufferSize*= 2;
+			Capture->Buffer= (unsigned char *) realloc(Capture->Buffer, (size_t) BufferSize);
+		}
+		if ((Capture->Headers == NULL) || (Capture->Buffer == NULL))
+		{
+			snprintf(ErrBuf, ErrBufSize, "Not enough memory to load the capture file");
+			pcap_close(PcapHandle);
+			return nbFAILURE;
+		}
+
+		Capture->Headers[Capture->NPackets]= *PktHeader;
+		memcpy(Capture->Buffer + Capture->NBytes, PktData, PktHeader->caplen);
+		Capture->NBytes+= PktHeader->caplen;
+		Capture->NPackets++;
+	}
+
+	pcap_close(PcapHandle);
+
+	if (Capture->NPackets == 0)
+	{
+		snprintf(ErrBuf, ErrBufSize, "The capture file does not contain any packet");
+		return nbFAILURE;
+	}
+
+	// Pointers are set only now, since the buffer may have been moved while loading
+	Capture->Packets= (unsigned char **) malloc(Capture->NPackets * sizeof(unsigned char *));
+	if (Capture->Packets == NULL)
+	{
+		snprintf(ErrBuf, ErrBufSize, "Not enough memory to load the capture file");
+		return nbFAILURE;
+	}
+	for (i= 0, Offset= 0; i < Capture->NPackets; i++)
+	{
+		Capture->Packets[i]= Capture->Buffer + Offset;
+		Offset+= Capture->Headers[i].caplen;
+	}
+
+	return nbSUCCESS;
+}
+
+
+void FreeCapture(Capture_t *Capture)
+{
+	free(Capture->Buffer);
+	free(Capture->Headers);
+	free(Capture->Packets);
+}
+
+
+/*!
+	\brief Measures the performance of the given target.
+
+	The capture is processed 'WarmupLoops' times without measuring anything, then 'Loops' times
+	for measuring the throughput and the memory allocations, and finally once more taking the
+	CPU ticks spent on each packet (this is done separately, so that reading the CPU counter
+	does not affect the throughput).
+*/
+int RunBenchmark(BenchTarget *Target, Capture_t *Capture, BenchResult_t *Result)
+{
+nbProfiler *Profiler;
+int64_t *StartTicks, *EndTicks;
+int64_t MeasureCost, Sum;
+u_long i;
+int Loop;
+uint64_t StartMicro, EndMicro;
+#ifdef ALLOCATION_COUNTERS
+uint64_t StartAllocations, StartBytes;
+#endif
+
+	for (Loop= 0; Loop < ConfigParams.WarmupLoops; Loop++)
+		for (i= 0; i < Capture->NPackets; i++)
+			Target->Process(i);
+
+	// Throughput
+#ifdef ALLOCATION_COUNTERS
+	StartAllocations= AllocationCount;
+	StartBytes= AllocatedBytes;
+#endif
+	StartMicro= nbProfilerGetMicro();
+
+	for (Loop= 0; Loop < ConfigParams.Loops; Loop++)
+	{
+		for (i= 0; i < Capture->NPackets; i++)
+		{
+			if (Target->Process(i) == nbSUCCESS)
+				Result->Accepted++;
+		}
+	}
+
+	EndMicro= nbProfilerGetMicro();
+	Result->Packets= (uint64_t) Capture->NPackets * ConfigParams.Loops;
+	Result->Seconds= (double) (EndMicro - StartMicro) / 1000000.0;
+	if (Result->Seconds > 0)
+	{
+		Result->Mpps= (double) Result->Packets / Result->Seconds / 1000000.0;
+		Result->Gbps= (double) Capture->NBytes * ConfigParams.Loops * 8 / Result->Seconds / 1000000000.0;
+	}
+
+#ifdef ALLOCATION_COUNTERS
+	Result->AllocsPerPacket= (double) (AllocationCount - StartAllocations) / (double) Result->Packets;
+	Result->AllocBytesPerPacket= (double) (AllocatedBytes - StartBytes) / (double) Result->Packets;
+#else
+	Result->AllocsPerPacket= -1;
+	Result->AllocBytesPerPacket= -1;
+#endif
+
+	// Ticks per packet
+	Profiler= nbAllocateProfiler(Result->ErrBuf, sizeof(Result->ErrBuf));
+	if (Profiler == NULL)
+		return nbFAILURE;
+
+	if (Profiler->Initialize((int) Capture->NPackets) == nbFAILURE)
+	{
+		snprintf(Result->ErrBuf, sizeof(Result->ErrBuf), "%s", Profiler->GetLastError());
+		nbDeallocateProfiler(Profiler);
+		return nbFAILURE;
+	}
+
+	for (i= 0; i < Capture->NPackets; i++)
+	{
+	uint64_t Start, End;
+
+		Start= nbProfilerGetTime();
+		Target->Process(i);
+		End= nbProfilerGetTime();
+		Profiler->StoreSample(Start, End);
+	}
+
+	Profiler->GetRawSamples(StartTicks, EndTicks);
+	MeasureCost= nbProfilerGetMeasureCost();
+
+	int64_t *Ticks= new int64_t[Capture->NPackets];
+
+	Sum= 0;
+	for (i= 0; i < Capture->NPackets; i++)
+	{
+		Ticks[i]= EndTicks[i] - StartTicks[i] - MeasureCost;
+		if (Ticks[i] < 0)
+			Ticks[i]= 0;
+		Sum+= Ticks[i];
+	}
+	std::sort(Ticks, Ticks + Capture->NPackets);
+
+	Result->TicksMean= Sum / (int64_t) Capture->NPackets;
+	for (i= 0; i < NUM_PERCENTILES; i++)
+	{
+	u_long Rank;
+
+		// Nearest-rank percentile
+		Rank= (u_long) (Percentiles[i] / 100.0 * Capture->NPackets + 0.999999);
+		if (Rank < 1)
+			Rank= 1;
+		if (Rank > Capture->NPackets)
+			Rank= Capture->NPackets;
+		Result->TicksPercentiles[i]= Ticks[Rank - 1];
+	}
+	Result->TicksMax= Ticks[Capture->NPackets - 1];
+
+	delete[] Ticks;
+	nbDeallocateProfiler(Profiler);
+
+	Result->PeakRSS= GetPeakRSS();
+	return nbSUCCESS;
+}
+
+
+/*!
+	\brief Returns the name of the native backend used by the JIT, or NULL if there is none.
+*/
+const char *GetJitBackendName()
+{
+nvmBackendDescriptor *BackendList;
+uint32_t NBackends, i;
+
+	BackendList= nvmGetBackendList(&NBackends);
+	for (i= 0; i < NBackends; i++)
+	{
+		if ((BackendList[i].Flags & nvmDO_NATIVE) != 0)
+			return BackendList[i].Name;
+	}
+	return NULL;
+}
+
+
+void BenchmarkFilter(const char *Filter, bool UseJit, Capture_t *Capture, BenchResult_t *Result)
+{
+nbPacketEngine *PacketEngine;
+uint64_t StartMicro;
+const char *JitBackend;
+
+	Result->Filter= Filter;
+	if (UseJit)
+	{
+		JitBackend= GetJitBackendName();
+		snprintf(Result->Engine, sizeof(Result->Engine), "jit-%s", JitBackend ? JitBackend : "none");
+		if (JitBackend == NULL)
+		{
+			Result->Failed= true;
+			snprintf(Result->ErrBuf, sizeof(Result->ErrBuf), "No native backend is available on this platform");
+			return;
+		}
+	}
+	else
+		snprintf(Result->Engine, sizeof(Result->Engine), "interpreter");
+
+	PacketEngine= nbAllocatePacketEngine(UseJit, Result->ErrBuf, sizeof(Result->ErrBuf));
+	if (PacketEngine == NULL)
+	{
+		Result->Failed= true;
+		return;
+	}
+
+	StartMicro= nbProfilerGetMicro();
+
+	if (PacketEngine->Compile(Filter, Capture->LinkLayer, ConfigParams.Optimization) == nbFAILURE)
+	{
+	_nbNetPFLCompilerMessages *Message;
+
+		Result->Failed= true;
+		Message= PacketEngine->GetCompMessageList();
+		snprintf(Result->ErrBuf, sizeof(Result->ErrBuf), "Cannot compile the filter: %s",
+			(Message != NULL) ? Message->MessageString : PacketEngine->GetLastError());
+		nbDeallocatePacketEngine(PacketEngine);
+		return;
+	}
+
+	if (PacketEngine->InitNetVM(nbNETVM_CREATION_FLAG_COMPILEANDEXECUTE) == nbFAILURE)
+	{
+		Result->Failed= true;
+		snprintf(Result->ErrBuf, sizeof(Result->ErrBuf), "Cannot initialize the NetVM: %s", PacketEngine->GetLastError());
+		nbDeallocatePacketEngine(PacketEngine);
+		return;
+	}
+
+	Result->SetupMs= (double) (nbProfilerGetMicro() - StartMicro) / 1000.0;
+
+	PacketEngineTarget Target(PacketEngine, Capture);
+	if (RunBenchmark(&Target, Capture, Result) == nbFAILURE)
+		Result->Failed= true;
+
+	nbDeallocatePacketEngine(PacketEngine);
+}
+
+
+void BenchmarkDecoder(Capture_t *Capture, BenchResult_t *Result)
+{
+nbPacketDecoder *Decoder;
+uint64_t StartMicro;
+
+	Result->Filter= NULL;
+	snprintf(Result->Engine, sizeof(Result->Engine), "decoder");
+
+	StartMicro= nbProfilerGetMicro();
+
+	Decoder= nbAllocatePacketDecoder(nbDECODER_GENERATEPDML_COMPLETE | nbDECODER_GENERATEPSML, Result->ErrBuf, sizeof(Result->ErrBuf));
+	if (Decoder == NULL)
+	{
+		Result->Failed= true;
+		return;
+	}
+
+	Result->SetupMs= (double) (nbProfilerGetMicro() - StartMicro) / 1000.0;
+
+	DecoderTarget Target(Decoder, Capture);
+	if (RunBenchmark(&Target, Capture, Result) == nbFAILURE)
+		Result->Failed= true;
+
+	nbDeallocatePacketDecoder(Decoder);
+}
+
+
+void BenchmarkHexDump(Capture_t *Capture, BenchResult_t *Result)
+{
+	Result->Filter= NULL;
+	snprintf(Result->Engine, sizeof(Result->Engine), "hexdump");
+
+	HexDumpTarget Target(Capture);
+	if (RunBenchmark(&Target, Capture, Result) == nbFAILURE)
+		Result->Failed= true;
+}
+
+
+//! Prints a string as a JSON string literal.
+void PrintJSONString(FILE *OutFile, const char *String)
+{
+	if (String == NULL)
+	{
+		fprintf(OutFile, "null");
+		return;
+	}
+
+	fputc('"', OutFile);
+	for (; *String; String++)
+	{
+		if ((*String == '"') || (*String == '\\'))
+			fprintf(OutFile, "\\%c", *String);
+		else if ((unsigned char) *String < 0x20)
+			fprintf(OutFile, "\\u%04x", (unsigned char) *String);
+		else
+			fputc(*String, OutFile);
+	}
+	fputc('"', OutFile);
+}
+
+
+//! Prints a string as a CSV field.
+void PrintCSVString(FILE *OutFile, const char *String)
+{
+	fputc('"', OutFile);
+	for (; String && *String; String++)
+	{
+		if (*String == '"')
+			fputc('"', OutFile);
+		fputc(*String, OutFile);
+	}
+	fputc('"', OutFile);
+}
+
+
+void PrintResultsJSON(FILE *OutFile, Capture_t *Capture, double TicksPerMicro, BenchResult_t *Results, int NResults)
+{
+int i;
+unsigned int j;
+
+	fprintf(OutFile, "{\n");
+	fprintf(OutFile, "  \"capture\": ");
+	PrintJSONString(OutFile, ConfigParams.CaptureFileName);
+	fprintf(OutFile, ",\n");
+	fprintf(OutFile, "  \"packets\": %lu,\n", Capture->NPackets);
+	fprintf(OutFile, "  \"bytes\": %llu,\n", (unsigned long long) Capture->NBytes);
+	fprintf(OutFile, "  \"link_layer\": %d,\n", (int) Capture->LinkLayer);
+	fprintf(OutFile, "  \"loops\": %d,\n", ConfigParams.Loops);
+	fprintf(OutFile, "  \"warmup_loops\": %d,\n", ConfigParams.WarmupLoops);
+	fprintf(OutFile, "  \"optimization\": %s,\n", ConfigParams.Optimization ? "true" : "false");
+	fprintf(OutFile, "  \"ticks_per_usec\": %.3f,\n", TicksPerMicro);
+	fprintf(OutFile, "  \"runs\": [\n");
+
+	for (i= 0; i < NResults; i++)
+	{
+	BenchResult_t *Result= &Results[i];
+
+		fprintf(OutFile, "    {\"engine\": ");
+		PrintJSONString(OutFile, Result->Engine);
+		fprintf(OutFile, ", \"filter\": ");
+		PrintJSONString(OutFile, Result->Filter);
+
+		if (Result->Failed)
+		{
+			fprintf(OutFile, ", \"status\": \"error\", \"error\": ");
+			PrintJSONString(OutFile, Result->ErrBuf);
+		}
+		else
+		{
+			fprintf(OutFile, ", \"status\": \"ok\"");
+			fprintf(OutFile, ", \"setup_ms\": %.3f", Result->SetupMs);
+			fprintf(OutFile, ", \"packets\": %llu", (unsigned long long) Result->Packets);
+			fprintf(OutFile, ", \"accepted\": %llu", (unsigned long long) Result->Accepted);
+			fprintf(OutFile, ", \"seconds\": %.6f", Result->Seconds);
+			fprintf(OutFile, ", \"mpps\": %.4f", Result->Mpps);
+			fprintf(OutFile, ", \"gbps\": %.4f", Result->Gbps);
+			fprintf(OutFile, ", \"ticks_mean\": %lld", (long long) Result->TicksMean);
+			for (j= 0; j < NUM_PERCENTILES; j++)
+				fprintf(OutFile, ", \"ticks_%s\": %lld", PercentileNames[j], (long long) Result->TicksPercentiles[j]);
+			fprintf(OutFile, ", \"ticks_max\": %lld", (long long) Result->TicksMax);
+			if (Result->AllocsPerPacket >= 0)
+			{
+				fprintf(OutFile, ", \"allocs_per_pkt\": %.4f", Result->AllocsPerPacket);
+				fprintf(OutFile, ", \"alloc_bytes_per_pkt\": %.2f", Result->AllocBytesPerPacket);
+			}
+			else
+				fprintf(OutFile, ", \"allocs_per_pkt\": null, \"alloc_bytes_per_pkt\": null");
+			if (Result->PeakRSS >= 0)
+				fprintf(OutFile, ", \"peak_rss_kb\": %ld", Result->PeakRSS);
+			else
+				fprintf(OutFile, ", \"peak_rss_kb\": null");
+		}
+
+		fprintf(OutFile, "}%s\n", (i < NResults - 1) ? "," : "");
+	}
+
+	fprintf(OutFile, "  ]\n");
+	fprintf(OutFile, "}\n");
+}
+
+
+void PrintResultsCSV(FILE *OutFile, Capture_t *Capture, double TicksPerMicro, BenchResult_t *Results, int NResults)
+{
+int i;
+unsigned int j;
+
+	for (j= 0; j < NUM_CSV_SETUP_COLUMNS; j++)
+		fprintf(OutFile, "%s%s", (j > 0) ? "," : "", CSVSetupColumns[j]);
+	for (j= 0; j < NUM_CSV_RESULT_COLUMNS; j++)
+		fprintf(OutFile, ",%s", CSVResultColumns[j]);
+	for (j= 0; j < NUM_PERCENTILES; j++)
+		fprintf(OutFile, ",ticks_%s", PercentileNames[j]);
+	for (j= 0; j < NUM_CSV_TRAILING_COLUMNS; j++)
+		fprintf(OutFile, ",%s", CSVTrailingColumns[j]);
+	fprintf(OutFile, "\n");
+
+	for (i= 0; i < NResults; i++)
+	{
+	BenchResult_t *Result= &Results[i];
+
+		PrintCSVString(OutFile, ConfigParams.CaptureFileName);
+		fprintf(OutFile, ",%lu,%d,%.3f,%s,", Capture->NPackets, ConfigParams.Loops, TicksPerMicro, Result->Engine);
+		PrintCSVString(OutFile, Result->Filter);
+
+		if (Result->Failed)
+		{
+			// All the columns after 'status' are empty, except the last one
+			fprintf(OutFile, ",error");
+			for (j= 0; j < NUM_CSV_RESULT_COLUMNS + NUM_PERCENTILES + NUM_CSV_TRAILING_COLUMNS - 1; j++)
+				fprintf(OutFile, ",");
+			fprintf(OutFile, ",");
+			PrintCSVString(OutFile, Result->ErrBuf);
+			fprintf(OutFile, "\n");
+			continue;
+		}
+
+		fprintf(OutFile, ",ok,%.3f,%llu,%.6f,%.4f,%.4f,%lld", Result->SetupMs, (unsigned long long) Result->Accepted,
+			Result->Seconds, Result->Mpps, Result->Gbps, (long long) Result->TicksMean);
+		for (j= 0; j < NUM_PERCENTILES; j++)
+			fprintf(OutFile, ",%lld", (long long) Result->TicksPercentiles[j]);
+		fprintf(OutFile, ",%lld,", (long long) Result->TicksMax);
+		if (Result->AllocsPerPacket >= 0)
+			fprintf(OutFile, "%.4f,%.2f", Result->AllocsPerPacket, Result->AllocBytesPerPacket);
+		else
+			fprintf(OutFile, ",");
+		fprintf(OutFile, ",");
+		if (Result->PeakRSS >= 0)
+			fprintf(OutFile, "%ld", Result->PeakRSS);
+		fprintf(OutFile, ",\n");
+	}
+}
+
+
+/*!
+\brief The main program
+*/
+int main(int argc, char *argv[])
+{
+char ErrBuf[2048]= "";
+Capture_t Capture;
+BenchResult_t *Results;
+int NResults= 0;
+int i;
+double TicksPerMicro;
+FILE *OutFile= stdout;
+int RetVal= nbSUCCESS;
+
+	if (ParseCommandLine(argc, argv) == nbFAILURE)
+		return nbFAILURE;
+
+	// Progress messages go to stderr, so that stdout contains only the results
+	fprintf(stderr, "Loading NetPDL protocol database...\n");
+
+	if (ConfigParams.NetPDLFileName)
+	{
+		if (nbInitialize(ConfigParams.NetPDLFileName, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			fprintf(stderr, "Trying to use the NetPDL database embedded in the NetBee library instead.\n");
+		}
+	}
+
+	if (nbIsInitialized() == nbFAILURE)
+	{
+		if (nbInitialize(NULL, nbPROTODB_FULL, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+		{
+			fprintf(stderr, "Error initializing the NetBee Library: %s\n", ErrBuf);
+			return nbFAILURE;
+		}
+	}
+
+	fprintf(stderr, "Loading packets from '%s'...\n", ConfigParams.CaptureFileName);
+	if (LoadCapture(ConfigParams.CaptureFileName, ConfigParams.NPackets, &Capture, ErrBuf, sizeof(ErrBuf)) == nbFAILURE)
+	{
+		fprintf(stderr, "%s\n", ErrBuf);
+		nbCleanup();
+		return nbFAILURE;
+	}
+
+	if (ConfigParams.OutputFileName)
+	{
+		OutFile= fopen(ConfigParams.OutputFileName, "w");
+		if (OutFile == NULL)
+		{
+			fprintf(stderr, "Cannot open the output file '%s'.\n", ConfigParams.OutputFileName);
+			FreeCapture(&Capture);
+			nbCleanup();
+			return nbFAILURE;
+		}
+	}
+
+	TicksPerMicro= GetTicksPerMicrosecond();
+
+	Results= (BenchResult_t *) calloc(2 * ConfigParams.NFilters + 2, sizeof(BenchResult_t));
+
+	for (i= 0; i < ConfigParams.NFilters; i++)
+	{
+		if (ConfigParams.Engines & ENGINE_INTERPRETER)
+		{
+			fprintf(stderr, "Benchmarking filter '%s' with the interpreter...\n", ConfigParams.Filters[i]);
+			BenchmarkFilter(ConfigParams.Filters[i], false, &Capture, &Results[NResults++]);
+		}
+
+		if (ConfigParams.Engines & ENGINE_JIT)
+		{
+			fprintf(stderr, "Benchmarking filter '%s' with the JIT...\n", ConfigParams.Filters[i]);
+			BenchmarkFilter(ConfigParams.Filters[i], true, &Capture, &Results[NResults++]);
+		}
+	}
+
+	if (ConfigParams.Engines & ENGINE_DECODER)
+	{
+		fprintf(stderr, "Benchmarking the packet decoder...\n");
+		BenchmarkDecoder(&Capture, &Results[NResults++]);
+	}
+
+	if (ConfigParams.Engines & ENGINE_HEXDUMP)
+	{
+		fprintf(stderr, "Benchmarking the hex dump conversion...\n");
+		BenchmarkHexDump(&Capture, &Results[NResults++]);
+	}
+
+	if (ConfigParams.CSVOutput)
+		PrintResultsCSV(OutFile, &Capture, TicksPerMicro, Results, NResults);
+	else
+		PrintResultsJSON(OutFile, &Capture, TicksPerMicro, Results, NResults);
+
+	// A failed run must be noticed by the scripts that compare the results
+	for (i= 0; i < NResults; i++)
+	{
+		if (Results[i].Failed)
+		{
+			fprintf(stderr, "Benchmark of engine '%s' failed: %s\n", Results[i].Engine, Results[i].ErrBuf);
+			RetVal= nbFAILURE;
+		}
+	}
+
+	if (OutFile != stdout)
+		fclose(OutFile);
+
+	for (i= 0; i < ConfigParams.NFilters; i++)
+		free(ConfigParams.Filters[i]);
+	free(Results);
+	FreeCapture(&Capture);
+	nbCleanup();
+
+	return RetVal;
+}
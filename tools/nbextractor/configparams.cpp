@@ -42,10 +42,10 @@
 " -sqldb databasefilename                                                       \n" \
 "        Name of the database file where the extracted fields will be dumped.   \n" \
 "        This switch the tool to quiet mode (no packets' output on screen).     \n" \
-"        Please note that for performance reasons the sqlite database will have \n" \
-"        both journaling and syncronous writes disabled. So, you may lose some  \n" \
-"        data in case something goes wrong (e.g., disk failure, etc.), but this \n" \
-"        guarantees the best thoughput, which is what matters here.             \n"
+"        Please note that for performance reasons the sqlite database uses the  \n" \
+"        write-ahead log (WAL) and does not sync the disk after each commit.    \n" \
+"        So, you may lose the last transactions in case of a power failure, but \n" \
+"        the database is never corrupted.                                       \n"
 
 #define SQLITE3_RELATED_OPTS \
 " -sqltable tablename                                                           \n" \
@@ -56,9 +56,20 @@
 "        Number of records that have to be aggregated within a single           \n" \
 "        transaction in order to be 'inserted' in the database. Aggregating     \n" \
 "        multiple insertions within a single transaction decreases              \n" \
-"        dramatically the overhead of the database. Default: no transactions    \n" \
-"        are used (each 'insert' is atomic); a reasonable value is about        \n" \
-"        20000 insertions per transaction.                                      \n"
+"        dramatically the overhead of the database. Default: 20000 insertions   \n" \
+"        per transaction; use 0 to make each 'insert' atomic.                   \n" \
+" -sqlindex field1,field2,...                                                   \n" \
+"        List of the columns of the table that have to be indexed, in the       \n" \
+"        'protoname.fieldname' format (use 'tstamp' for the timestamp).         \n" \
+"        Default: no indexes are created.                                       \n" \
+" -sqlbulkload                                                                  \n" \
+"        Bulk-load mode: the indexes listed in -sqlindex are dropped when the   \n" \
+"        database is opened and they are built only after all the rows have     \n" \
+"        been inserted, which is much faster than updating them at each insert. \n" \
+"        The disk is not synced at all while loading the data.                  \n" \
+" -sqlnowal                                                                     \n" \
+"        Use the default SQLite rollback journal instead of the write-ahead log \n" \
+"        (e.g., when the database is on a network filesystem).                 \n"
 
 #define SQLITE3_RELATED_ARGS2 \
 "        This option rotates SQL databases as well, following the same rules.   \n"
@@ -209,7 +220,10 @@ int CurrentItem;
 #ifdef  ENABLE_SQLITE3
 	ConfigParams.SQLDatabaseFileBasename= NULL;
 	ConfigParams.SQLTableName= (char*) "DefaultDump";
-	ConfigParams.SQLTransactionSize= 0;
+	ConfigParams.SQLTransactionSize= 20000;
+	ConfigParams.SQLIndexedColumns= NULL;
+	ConfigParams.SQLBulkLoad= false;
+	ConfigParams.SQLUseWAL= true;
 #endif
 
 // End defaults
@@ -348,6 +362,27 @@ int CurrentItem;
 			CurrentItem+= 2;
 			continue;
 		}
+
+		if (strcmp(argv[CurrentItem], "-sqlindex") == 0)
+		{
+			ConfigParams.SQLIndexedColumns= argv[CurrentItem+1];
+			CurrentItem+= 2;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-sqlbulkload") == 0)
+		{
+			ConfigParams.SQLBulkLoad= true;
+			CurrentItem++;
+			continue;
+		}
+
+		if (strcmp(argv[CurrentItem], "-sqlnowal") == 0)
+		{
+			ConfigParams.SQLUseWAL= false;
+			CurrentItem++;
+			continue;
+		}
 #endif
 
 		if (strcmp(argv[CurrentItem], "-anonip") == 0)
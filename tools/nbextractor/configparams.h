@@ -96,6 +96,9 @@ struct _ConfigParams
         char*		SQLDatabaseFileBasename; // this is only a template, optional chars might be appended by nbextractor, see its code
 	char*		SQLTableName;
 	int			SQLTransactionSize;
+	char*		SQLIndexedColumns;	// comma-separated list of the columns to be indexed ('proto.field' or 'tstamp'), or NULL
+	bool		SQLBulkLoad;		// true if the indexes have to be built only after all the rows have been inserted
+	bool		SQLUseWAL;			// true if the database has to use the write-ahead log instead of the rollback journal
 #endif
 
 };
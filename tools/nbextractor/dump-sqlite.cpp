@@ -36,18 +36,35 @@
 
 
 
-int SQLGetColumnNamesCallbackFunc(void* strBuff /* used to store columnNames*/, int nColumns, char** columnValues, char** columnNames)
+// Called for each column returned by 'PRAGMA table_info'; it appends the definition of the column to strBuff,
+// in the same format used by CreateDBTable() (i.e. 'name type[ NOT NULL],')
+int SQLGetColumnDefinitionsCallbackFunc(void* strBuff /* used to store column definitions*/, int nColumns, char** columnValues, char** columnNames)
 {
+char* Name= NULL;
+char* Type= NULL;
+bool NotNull= false;
+
 	for (int i= 0; i< nColumns ; i ++)
 	{
 		if (!strcmp(columnNames[i], "name"))
-		{
-			sstrncat((char*) strBuff, columnValues[i], SQLCOMMAND_MAX_LEN);
-			sstrncat((char*) strBuff, (char*) ",", SQLCOMMAND_MAX_LEN);
-			break;
-		}
+			Name= columnValues[i];
+		else if (!strcmp(columnNames[i], "type"))
+			Type= columnValues[i];
+		else if (!strcmp(columnNames[i], "notnull"))
+			NotNull= (columnValues[i] != NULL) && (strcmp(columnValues[i], "0") != 0);
 	}
 
+	if (Name == NULL)
+		return 0;
+
+	sstrncat((char*) strBuff, Name, SQLCOMMAND_MAX_LEN);
+	sstrncat((char*) strBuff, (char*) " ", SQLCOMMAND_MAX_LEN);
+	if (Type)
+		sstrncat((char*) strBuff, Type, SQLCOMMAND_MAX_LEN);
+	if (NotNull)
+		sstrncat((char*) strBuff, (char*) " NOT NULL", SQLCOMMAND_MAX_LEN);
+	sstrncat((char*) strBuff, (char*) ",", SQLCOMMAND_MAX_LEN);
+
 	return 0;
 }
 
@@ -67,15 +84,16 @@ int SQLGetRowsCountCallbackFunc(void* rowsCount, int nColumns, char** columnValu
 	return 0;
 }
 
-// Note: column names are separated by the ',' delimiter
-int CreateDBTable(sqlite3* pDB,	const char* TableName, const char* ColumnNames)
+// Returns the columns of an existing table in 'ColumnDefinitions' (which must be SQLCOMMAND_MAX_LEN bytes long),
+// in the format used by CreateDBTable(); the string is empty if the table does not exist
+int GetDBTableColumnDefinitions(sqlite3* pDB, const char* TableName, char* ColumnDefinitions)
 {
 char SQLCmdBuffer[SQLCOMMAND_MAX_LEN] 	= "\0";
-int SQLCmdBufferOccupancy = 0;
-char CurrentColumnNames[SQLCOMMAND_MAX_LEN] 	= "\0";
 char* errMsg 				= NULL;
 int RetVal						= 0;
 
+	ColumnDefinitions[0]= 0;
+
 	// Test if there exists table with same name
 	sprintf(SQLCmdBuffer, "PRAGMA table_info(%s)", TableName);
 
@@ -83,38 +101,36 @@ int RetVal						= 0;
 	fprintf(stderr, "executing sql cmd{%s}...\n", sqlCmdBuffer);
 #endif
 
-	// PRAGMA per performance
-/*	RetVal= sqlite3_exec(pDB, "PRAGMA journal_mode = OFF;", NULL, NULL, &errMsg);
+	// Call the 'SQLGetColumnDefinitionsCallbackFunc' callback function, which will return the columns defined for that table
+	RetVal= sqlite3_exec(pDB, SQLCmdBuffer, SQLGetColumnDefinitionsCallbackFunc, ColumnDefinitions, &errMsg);
 	if (RetVal)
 	{
-		fprintf(stderr, "PRAGMA journaling exec error: %s\n", errMsg);
+		fprintf(stderr, "SQL command {%s} exec error: %s\n", SQLCmdBuffer, errMsg);
 		sqlite3_free(errMsg);
 		return nbFAILURE;
 	}
 
-	RetVal= sqlite3_exec(pDB, "PRAGMA synchronous = OFF;", NULL, NULL, &errMsg);
-	if (RetVal)
-	{
-		fprintf(stderr, "PRAGMA syncronous write exec error: %s\n", errMsg);
-		sqlite3_free(errMsg);
-		return nbFAILURE;
-	}
-*/      
+	return nbSUCCESS;
+}
 
-	// Call the 'SQLGetColumnNamesCallbackFunc' callback function, which will return the column names defined for that table
-	RetVal= sqlite3_exec(pDB, SQLCmdBuffer, SQLGetColumnNamesCallbackFunc, CurrentColumnNames, &errMsg);
-	if (RetVal)
-	{
-		fprintf(stderr, "SQL command {%s} exec error: %s\n", SQLCmdBuffer, errMsg);
-		sqlite3_free(errMsg);
+
+// Note: column definitions ('name type[ NOT NULL]') are separated by the ',' delimiter, and the last one is followed by ',' as well
+int CreateDBTable(sqlite3* pDB,	const char* TableName, const char* ColumnDefinitions)
+{
+char SQLCmdBuffer[SQLCOMMAND_MAX_LEN] 	= "\0";
+int SQLCmdBufferOccupancy = 0;
+char CurrentColumnDefinitions[SQLCOMMAND_MAX_LEN] 	= "\0";
+char* errMsg 				= NULL;
+int RetVal						= 0;
+
+	if (GetDBTableColumnDefinitions(pDB, TableName, CurrentColumnDefinitions) == nbFAILURE)
 		return nbFAILURE;
-	}
 
 	// A table with that name already exist
-	// Column names are stored in 'CurrentColumnNames'
-	if (CurrentColumnNames[0])
+	// Its columns (with their types) are stored in 'CurrentColumnDefinitions'
+	if (CurrentColumnDefinitions[0])
 	{
-		if (_stricmp(CurrentColumnNames, ColumnNames) == 0)
+		if (_stricmp(CurrentColumnDefinitions, ColumnDefinitions) == 0)
 		{
 			fprintf(stderr, "Table %s already exists, with the same schema. Appending new data to that table.\n", TableName);
 			// We do not return any error code here; table creating has failed, but table already
@@ -131,29 +147,21 @@ int RetVal						= 0;
 	}
 	else
 	{
-	char* pColName;
-
 		// Table does not exist; let's create a new one
 		sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, "CREATE TABLE ");
 		sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, TableName);
 		sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, " (");
+		sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, ColumnDefinitions);
 
-		// Copy column names into a private variable, since strtok() rewrites the original buffer
-		strcpy(CurrentColumnNames, ColumnNames);
-
-		pColName= strtok(CurrentColumnNames, ",");
-		while (pColName)
+		// The separator that follows the last column closes the list
+		if ((SQLCmdBufferOccupancy >= (int) sizeof(SQLCmdBuffer) - 1) || (SQLCmdBuffer[SQLCmdBufferOccupancy - 1] != ','))
 		{
-			sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, pColName);
-			sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, " TEXT NOT NULL");
-
-			pColName = strtok(NULL, ",");
-			if (pColName)
-				sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, ",");
-			else
-				sstrncat_ex(SQLCmdBuffer, sizeof(SQLCmdBuffer), &SQLCmdBufferOccupancy, ")");
+			fprintf(stderr, "Internal error: the buffer that contains SQL commands is too small.\n");
+			return nbFAILURE;
 		}
 
+		SQLCmdBuffer[SQLCmdBufferOccupancy - 1]= ')';
+
 #ifdef _DEBUG_LOUD
 		fprintf(stderr, "executing sql cmd{%s}...\n", sqlCmdBuffer);
 #endif
@@ -171,6 +179,61 @@ int RetVal						= 0;
 }
 
 
+// Creates or drops the indexes on the given columns ('protoname.fieldname' or 'tstamp', separated by the ',' delimiter)
+// The name of each index is derived from the names of the table and of the column, so that it can be dropped later
+static int UpdateDBIndexes(sqlite3* pDB, const char* TableName, const char* IndexedColumns, bool Create)
+{
+char SQLCmdBuffer[SQLCOMMAND_MAX_LEN];
+char ColumnNames[SQLCOMMAND_MAX_LEN];
+char* pColName;
+char* pDot;
+char* errMsg;
+
+	if (IndexedColumns == NULL)
+		return nbSUCCESS;
+
+	// Copy column names into a private variable, since strtok() rewrites the original buffer
+	sstrncpy(ColumnNames, (char*) IndexedColumns, sizeof(ColumnNames));
+
+	pColName= strtok(ColumnNames, ",");
+	while (pColName)
+	{
+		// Columns are named 'proto_field', since the '.' is a reserved character in SQLite
+		pDot= strchr(pColName, '.');
+		if (pDot)
+			*pDot= '_';
+
+		if (Create)
+			ssnprintf(SQLCmdBuffer, sizeof(SQLCmdBuffer), "CREATE INDEX IF NOT EXISTS \"%s_%s_idx\" ON %s (\"%s\")", TableName, pColName, TableName, pColName);
+		else
+			ssnprintf(SQLCmdBuffer, sizeof(SQLCmdBuffer), "DROP INDEX IF EXISTS \"%s_%s_idx\"", TableName, pColName);
+
+		if (sqlite3_exec(pDB, SQLCmdBuffer, NULL, NULL, &errMsg))
+		{
+			fprintf(stderr, "SQL command {%s} exec error: %s\n", SQLCmdBuffer, errMsg);
+			sqlite3_free(errMsg);
+			return nbFAILURE;
+		}
+
+		pColName= strtok(NULL, ",");
+	}
+
+	return nbSUCCESS;
+}
+
+
+int CreateDBIndexes(sqlite3* pDB, const char* TableName, const char* IndexedColumns)
+{
+	return UpdateDBIndexes(pDB, TableName, IndexedColumns, true);
+}
+
+
+int DropDBIndexes(sqlite3* pDB, const char* TableName, const char* IndexedColumns)
+{
+	return UpdateDBIndexes(pDB, TableName, IndexedColumns, false);
+}
+
+
 
 // Update two extra tables in the database: tables are created if they do not exist.
 // Schemas of the extra tables are hardcoded and currently keep just some simple info
@@ -186,13 +249,13 @@ FILE*       pFile;
 unsigned long       FileSize;
 
 	// If the tables exists, CreateDBTable will still return SUCCESS as the table schema is currently hard-coded
-	if (CreateDBTable(pDB, "DatabaseFileInfo", "DatabaseFileName,FileSize,LastUpdateTime,") == nbFAILURE)
+	if (CreateDBTable(pDB, "DatabaseFileInfo", "DatabaseFileName TEXT NOT NULL,FileSize TEXT NOT NULL,LastUpdateTime TEXT NOT NULL,") == nbFAILURE)
 	{
 		fprintf(stderr, "Error creating 'DatabaseFileInfo' table.\n");
 		return;
 	}
 
-	if (CreateDBTable(pDB, "TableSummary", "TableName,TotalNumOfRows,NumOfRowsAdded,TimeWhenRowsAdded,RunIdentifier,") == nbFAILURE)
+	if (CreateDBTable(pDB, "TableSummary", "TableName TEXT NOT NULL,TotalNumOfRows TEXT NOT NULL,NumOfRowsAdded TEXT NOT NULL,TimeWhenRowsAdded TEXT NOT NULL,RunIdentifier TEXT NOT NULL,") == nbFAILURE)
 	{
 		fprintf(stderr, "Error creating 'TableSummary' table.\n");
 		return;
@@ -271,38 +334,159 @@ unsigned long       FileSize;
 }
 
 
-// Prepare the string that is needed to insert data into th SQLite3 database; the first portion of that string is always the same, so we can prepare it in advance
-// Return failure in case the buffer is not large enough; in this case, let's trying increase the buffer
-int PrepareAddNewDataRecordSQLCommand(sqlite3* pDB, const char* SQLTableName, _nbExtractedFieldsDescriptorVector *DescriptorVector, char* SQLCommandBuffer, int SQLCommandBufferSize, int& SQLCommandBufferOccupancy)
+// Chooses the type of the column that stores a field (SQLITE_INTEGER or SQLITE_TEXT), according to its NetPDL definition;
+// this is done once per column, before the table is created.
+// Bit fields are integers, as well as the fixed fields that are shown as a single decimal number (e.g. 'ip.ttl'); fields
+// shown as several groups (e.g. the IPv4 addresses), or by a plugin or a native function, are text.
+int GetDataRecordColumnType(nbNetPDLUtils* NetPDLUtils, _nbExtractedFieldsDescriptor &FieldDescriptor)
+{
+struct _nbNetPDLElementFieldBase* NetPDLField;
+struct _nbNetPDLElementShowTemplate* ShowTemplate;
+int Size;
+
+	if (FieldDescriptor.FieldType == PDL_FIELD_TYPE_BIT)
+		return SQLITE_INTEGER;
+
+	// The handle of the field is not available for 'allfields' and for the fields that have not been found
+	if (FieldDescriptor.UserExtension == NULL)
+		return SQLITE_TEXT;
+
+	NetPDLField= NetPDLUtils->GetNetPDLFieldElement((nbNetPDLFieldHandle) FieldDescriptor.UserExtension);
+	ShowTemplate= NetPDLField->ShowTemplateInfo;
+
+	if ((NetPDLField->FieldType != nbNETPDL_ID_FIELD_FIXED) || (ShowTemplate == NULL))
+		return SQLITE_TEXT;
+
+	if ((ShowTemplate->ShowMode != nbNETPDL_ID_TEMPLATE_DIGIT_DEC) || (ShowTemplate->ShowNativeFunction) || (ShowTemplate->PluginName))
+		return SQLITE_TEXT;
+
+	// The NetPDL engine formats decimal numbers up to 4 bytes
+	Size= ((struct _nbNetPDLElementFieldFixed*) NetPDLField)->Size;
+	if ((Size > 4) || ((ShowTemplate->DigitSize != 0) && (ShowTemplate->DigitSize < Size)))
+		return SQLITE_TEXT;
+
+	return SQLITE_INTEGER;
+}
+
+
+// Prepares the statement that inserts data into the SQLite3 database; it is compiled only once, and then the values of
+// each packet are bound to its parameters (the first one is the timestamp, then the fields follow)
+int PrepareAddNewDataRecordStatement(sqlite3* pDB, const char* SQLTableName, _nbExtractedFieldsDescriptorVector *DescriptorVector, sqlite3_stmt** Statement)
 {
+char SQLCommandBuffer[SQLCOMMAND_MAX_LEN];
+int SQLCommandBufferOccupancy= 0;
 int i;
 
-	sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, "INSERT INTO ");
-	sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, SQLTableName);
-	sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, " (\"tstamp\",");
+	sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, "INSERT INTO ");
+	sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, SQLTableName);
+	sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, " (\"tstamp\"");
 
-    for (i= 0; i < DescriptorVector->NumEntries; i++)
-    {
-		sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, "\"");
-		sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, DescriptorVector->FieldDescriptor[i].Proto);
-		sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, "_");
-		sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, DescriptorVector->FieldDescriptor[i].Name);
-		sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, "\"");
+	for (i= 0; i < DescriptorVector->NumEntries; i++)
+	{
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, ",\"");
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, DescriptorVector->FieldDescriptor[i].Proto);
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, "_");
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, DescriptorVector->FieldDescriptor[i].Name);
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, "\"");
+	}
+
+	sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, ") VALUES (?");
 
-		if (i < (DescriptorVector->NumEntries - 1))
-			sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, ",");
-    }
+	for (i= 0; i < DescriptorVector->NumEntries; i++)
+		sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, ",?");
 
-	sstrncat_ex(SQLCommandBuffer, SQLCommandBufferSize, &SQLCommandBufferOccupancy, ") VALUES (");
+	sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferOccupancy, ")");
 
-	if (SQLCommandBufferOccupancy == SQLCommandBufferSize)
+	if (SQLCommandBufferOccupancy >= (int) sizeof(SQLCommandBuffer) - 1)
+	{
+		fprintf(stderr, "Internal error: the buffer that contains SQL commands is too small.\n");
 		return nbFAILURE;
-	else
-		return nbSUCCESS;
+	}
+
+	if (sqlite3_prepare_v2(pDB, SQLCommandBuffer, -1, Statement, NULL) != SQLITE_OK)
+	{
+		fprintf(stderr, "SQL command {%s} prepare error: %s\n", SQLCommandBuffer, sqlite3_errmsg(pDB));
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
+}
+
+
+// Binds the value of the last field formatted by the FieldPrinter to a parameter of the insert statement
+// (parameters are numbered starting from 1); 'ColumnType' is the type returned by GetDataRecordColumnType(),
+// or SQLCOLUMN_LEGACY_TEXT if the table has been created by a previous version
+int BindDataRecordField(sqlite3_stmt* Statement, int Column, int ColumnType, CFieldPrinter &FieldPrinter)
+{
+const unsigned char* RawValue;
+int RawValueLength;
+int RetVal;
+
+	switch (FieldPrinter.GetFieldValueType())
+	{
+		case FIELDVALUE_NULL:
+			// Legacy columns are 'NOT NULL', and previous versions marked missing fields with '-'
+			if (ColumnType == SQLCOLUMN_LEGACY_TEXT)
+				RetVal= sqlite3_bind_text(Statement, Column, "-", -1, SQLITE_STATIC);
+			else
+				RetVal= sqlite3_bind_null(Statement, Column);
+			break;
+
+		case FIELDVALUE_INTEGER:
+			RetVal= sqlite3_bind_int64(Statement, Column, FieldPrinter.GetIntegerValue());
+			break;
+
+		case FIELDVALUE_RAW:
+			// The raw data points into the packet buffer, which is still valid when the statement is executed
+			RawValue= FieldPrinter.GetRawValue(RawValueLength);
+			RetVal= sqlite3_bind_blob(Statement, Column, RawValue, RawValueLength, SQLITE_STATIC);
+			break;
+
+		default:
+			// Fields of integer columns are formatted as a plain decimal number
+			if (ColumnType == SQLITE_INTEGER)
+			{
+				RetVal= sqlite3_bind_int64(Statement, Column, (sqlite3_int64) strtoul(FieldPrinter.GetFormattedField(), NULL, 10));
+				break;
+			}
+
+			// The formatted field is overwritten by the next field, hence SQLite has to copy it
+			RetVal= sqlite3_bind_text(Statement, Column, FieldPrinter.GetFormattedField(), -1, SQLITE_TRANSIENT);
+			break;
+	}
+
+	if (RetVal != SQLITE_OK)
+	{
+		fprintf(stderr, "Binding the value of column %d failed: %s\n", Column, sqlite3_errmsg(sqlite3_db_handle(Statement)));
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
+}
+
+
+// Inserts a new data record into the database, using the values currently bound to the insert statement
+int AddNewDataRecord(sqlite3_stmt* Statement)
+{
+int RetVal;
+
+	RetVal= sqlite3_step(Statement);
+
+	// The statement must be reset in any case, so that it can be executed again with the next packet
+	sqlite3_reset(Statement);
+
+	if (RetVal != SQLITE_DONE)
+	{
+		fprintf(stderr, "Insert row into table failed: %s\n", sqlite3_errmsg(sqlite3_db_handle(Statement)));
+		return nbFAILURE;
+	}
+
+	return nbSUCCESS;
 }
 
 
 // Inserts a new data record into the database (the table name is contained in the SQLCommandBuffer)
+// This is used only for the extra tables, which are updated once per database
 int AddNewDataRecord(sqlite3* pDB, const char* SQLCommandBuffer)
 {
 char* ErrMsg;
@@ -320,34 +504,109 @@ int RetVal;
 }
 
 
-int SQL_open(char *db_filename, ConfigParams_t *cfg, sqlite3** db, _nbExtractedFieldsDescriptorVector* DescriptorVector)
+// 'ColumnTypes' keeps the type of the column of each field, as returned by GetDataRecordColumnType();
+// 'LegacySchema' is set to 'true' if the data are appended to a table created by a previous version,
+// whose columns are all 'TEXT NOT NULL' (hence values have to be bound with SQLCOLUMN_LEGACY_TEXT)
+int SQL_open(char *db_filename, ConfigParams_t *cfg, sqlite3** db, _nbExtractedFieldsDescriptorVector* DescriptorVector, const int* ColumnTypes, bool* LegacySchema)
+{
+char SQLColumnDefinitions[SQLCOMMAND_MAX_LEN]= "\0";
+int SQLColumnDefinitionsOccupancy= 0;
+char SQLLegacyColumnDefinitions[SQLCOMMAND_MAX_LEN]= "\0";
+int SQLLegacyColumnDefinitionsOccupancy= 0;
+char CurrentColumnDefinitions[SQLCOMMAND_MAX_LEN];
+char* errMsg;
+int RetVal;
+
+	*LegacySchema= false;
+
+	RetVal= sqlite3_open(db_filename, db);
+	if (RetVal)
+	{
+		fprintf(stderr, "Failed to open Database: %s\n", sqlite3_errmsg(*db));
+		return nbFAILURE;
+	}
+
+	// PRAGMAs for performance
+	// With the write-ahead log, a commit appends the new pages to the log instead of copying the old ones into the journal,
+	// and the database is never corrupted even if the disk is not synced at each commit.
+	// In bulk-load mode the disk is never synced, since the whole load can be repeated in case of a failure.
+	if (cfg->SQLUseWAL)
+	{
+		RetVal= sqlite3_exec(*db, "PRAGMA journal_mode = WAL;", NULL, NULL, &errMsg);
+		if (RetVal)
+		{
+			fprintf(stderr, "PRAGMA journaling exec error: %s\n", errMsg);
+			sqlite3_free(errMsg);
+			return nbFAILURE;
+		}
+	}
+
+	RetVal= sqlite3_exec(*db, cfg->SQLBulkLoad ? "PRAGMA synchronous = OFF;" : "PRAGMA synchronous = NORMAL;", NULL, NULL, &errMsg);
+	if (RetVal)
+	{
+		fprintf(stderr, "PRAGMA syncronous write exec error: %s\n", errMsg);
+		sqlite3_free(errMsg);
+		return nbFAILURE;
+	}
+
+	// Let's create the list of columns (i.e. the list of fields) we want to store in the database
+	// First column is the timestamp, then the other fields will follow
+	// This field is called "tstamp" because "timestamp" is a SQLite reserved word
+	sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, "tstamp TEXT NOT NULL,");
+	sstrncat_ex(SQLLegacyColumnDefinitions, sizeof(SQLLegacyColumnDefinitions), &SQLLegacyColumnDefinitionsOccupancy, "tstamp TEXT NOT NULL,");
+
+	for (int i= 0; i < DescriptorVector->NumEntries; i++)
+	{
+		sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, DescriptorVector->FieldDescriptor[i].Proto);
+		// We have to use '_', since the '.' is a reserved character in SQLite
+		sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, "_");
+		sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, DescriptorVector->FieldDescriptor[i].Name);
+		// Fields that are not present in the packet are stored as NULL, hence the columns cannot be 'NOT NULL'
+		sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, (ColumnTypes[i] == SQLITE_INTEGER) ? " INTEGER" : " TEXT");
+		// Let's put the separator even if we're the last field name (CreateDBTable() will take care of this)
+		sstrncat_ex(SQLColumnDefinitions, sizeof(SQLColumnDefinitions), &SQLColumnDefinitionsOccupancy, ",");
+
+		sstrncat_ex(SQLLegacyColumnDefinitions, sizeof(SQLLegacyColumnDefinitions), &SQLLegacyColumnDefinitionsOccupancy, DescriptorVector->FieldDescriptor[i].Proto);
+		sstrncat_ex(SQLLegacyColumnDefinitions, sizeof(SQLLegacyColumnDefinitions), &SQLLegacyColumnDefinitionsOccupancy, "_");
+		sstrncat_ex(SQLLegacyColumnDefinitions, sizeof(SQLLegacyColumnDefinitions), &SQLLegacyColumnDefinitionsOccupancy, DescriptorVector->FieldDescriptor[i].Name);
+		sstrncat_ex(SQLLegacyColumnDefinitions, sizeof(SQLLegacyColumnDefinitions), &SQLLegacyColumnDefinitionsOccupancy, " TEXT NOT NULL,");
+	}
+
+	// Tables created by previous versions have the same columns, but all of them are 'TEXT NOT NULL'
+	if (GetDBTableColumnDefinitions(*db, cfg->SQLTableName, CurrentColumnDefinitions) == nbFAILURE)
+		return nbFAILURE;
+
+	if (CurrentColumnDefinitions[0] && (_stricmp(CurrentColumnDefinitions, SQLLegacyColumnDefinitions) == 0))
+	{
+		fprintf(stderr, "Table %s already exists, with the schema of a previous version (all TEXT columns). Appending new data to that table.\n", cfg->SQLTableName);
+		*LegacySchema= true;
+	}
+	else
+	{
+		RetVal= CreateDBTable(*db, cfg->SQLTableName, SQLColumnDefinitions);
+		if (RetVal == nbFAILURE)
+			return nbFAILURE;
+	}
+
+	// In bulk-load mode the indexes are built by SQL_close(), after all the rows have been inserted
+	if (cfg->SQLBulkLoad)
+		return DropDBIndexes(*db, cfg->SQLTableName, cfg->SQLIndexedColumns);
+	else
+		return CreateDBIndexes(*db, cfg->SQLTableName, cfg->SQLIndexedColumns);
+}
+
+
+// Releases the insert statement and closes the database; any pending transaction must have been already committed
+void SQL_close(ConfigParams_t *cfg, sqlite3* db, sqlite3_stmt* Statement)
 {
-  char SQLColumnNames[2048]= "\0";
-  int SQLColumnNamesOccupancy= 0;
-  
-  int RetVal= sqlite3_open(db_filename, db);
-  if (RetVal)
-    {
-      fprintf(stderr, "Failed to open Database: %s\n", sqlite3_errmsg(*db));
-      return nbFAILURE;
-    }
-
-  // Let's create the list of columns (i.e. the list of fields) we want to store in the database
-  // First column is the timestamp, then the other fields will follow
-  // This field is called "tstamp" because "timestamp" is a SQLite reserved word
-  sstrncat_ex(SQLColumnNames, sizeof(SQLColumnNames), &SQLColumnNamesOccupancy, "tstamp,");
-
-  for (int i= 0; i < DescriptorVector->NumEntries; i++)
-    {
-      sstrncat_ex(SQLColumnNames, sizeof(SQLColumnNames), &SQLColumnNamesOccupancy, DescriptorVector->FieldDescriptor[i].Proto);
-      // We have to use '_', since the '.' is a reserved character in SQLite
-      sstrncat_ex(SQLColumnNames, sizeof(SQLColumnNames), &SQLColumnNamesOccupancy, "_");
-      sstrncat_ex(SQLColumnNames, sizeof(SQLColumnNames), &SQLColumnNamesOccupancy, DescriptorVector->FieldDescriptor[i].Name);
-      // Let's put the separator even if we're the last field name (the following code will take care of this)
-      sstrncat_ex(SQLColumnNames, sizeof(SQLColumnNames), &SQLColumnNamesOccupancy, ",");
-    }
-
-  RetVal= CreateDBTable(*db, cfg->SQLTableName, SQLColumnNames);
-
-  return RetVal;
+	// A database cannot be closed while it has statements that have not been finalized
+	sqlite3_finalize(Statement);
+
+	if (cfg->SQLBulkLoad)
+	{
+		if (CreateDBIndexes(db, cfg->SQLTableName, cfg->SQLIndexedColumns) == nbFAILURE)
+			fprintf(stderr, "Error creating the indexes of table %s.\n", cfg->SQLTableName);
+	}
+
+	sqlite3_close(db);
 }
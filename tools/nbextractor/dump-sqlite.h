@@ -33,18 +33,30 @@
 #include <nbee.h>
 #include <sqlite3.h>
 #include "configparams.h"
+#include "fieldprinter.h"
 
 
 #define SQLCOMMAND_MAX_LEN 4096
 
+// Column type used for tables created by previous versions, whose columns are all 'TEXT NOT NULL'
+// (it differs from all the SQLite datatype codes, e.g. SQLITE_INTEGER and SQLITE_TEXT)
+#define SQLCOLUMN_LEGACY_TEXT 0
 
 
-int SQLGetColumnNamesCallbackFunc(void* strBuff, int nColumns, char** columnValues, char** columnNames);
+
+int SQLGetColumnDefinitionsCallbackFunc(void* strBuff, int nColumns, char** columnValues, char** columnNames);
 int SQLGetRowsCountCallbackFunc(void* rowsCount, int nColumns, char** columnValues, char** columnNames);
-int CreateDBTable(sqlite3* pDB, const char* TableName, const char* ColumnNames);
+int GetDBTableColumnDefinitions(sqlite3* pDB, const char* TableName, char* ColumnDefinitions);
+int CreateDBTable(sqlite3* pDB, const char* TableName, const char* ColumnDefinitions);
+int CreateDBIndexes(sqlite3* pDB, const char* TableName, const char* IndexedColumns);
+int DropDBIndexes(sqlite3* pDB, const char* TableName, const char* IndexedColumns);
 void UpdateExtraDBTable(sqlite3* pDB, int nRowsAdded, ConfigParams_t ConfigParams, char* db_current_filename, char* run_identifier);
 
-int PrepareAddNewDataRecordSQLCommand(sqlite3* pDB, const char* SQLTableName, _nbExtractedFieldsDescriptorVector *DescriptorVector, char* SQLCommandBuffer, int SQLCommandBufferSize, int& SQLCommandBufferOccupancy);
+int GetDataRecordColumnType(nbNetPDLUtils* NetPDLUtils, _nbExtractedFieldsDescriptor &FieldDescriptor);
+int PrepareAddNewDataRecordStatement(sqlite3* pDB, const char* SQLTableName, _nbExtractedFieldsDescriptorVector *DescriptorVector, sqlite3_stmt** Statement);
+int BindDataRecordField(sqlite3_stmt* Statement, int Column, int ColumnType, CFieldPrinter &FieldPrinter);
+int AddNewDataRecord(sqlite3_stmt* Statement);
 int AddNewDataRecord(sqlite3* pDB, const char* SQLCommandBuffer);
 
-int SQL_open(char *db_filename, ConfigParams_t *cfg, sqlite3** db, _nbExtractedFieldsDescriptorVector* DescriptorVector);
+int SQL_open(char *db_filename, ConfigParams_t *cfg, sqlite3** db, _nbExtractedFieldsDescriptorVector* DescriptorVector, const int* ColumnTypes, bool* LegacySchema);
+void SQL_close(ConfigParams_t *cfg, sqlite3* db, sqlite3_stmt* Statement);
@@ -42,6 +42,12 @@ void CFieldPrinter::Initialize(nbNetPDLUtils* NetPDLUtils, PrintingMode_t Printi
 	m_AnonymizationIPArgumentList= AnonymizationIPArgumentList;
 	m_AnonymizationIPTable= AnonymizationIPTable;
 	m_FormattedField[0]= 0;
+#ifdef ENABLE_SQLITE3
+	m_FieldValueType= FIELDVALUE_TEXT;
+	m_IntegerValue= 0;
+	m_RawValue= NULL;
+	m_RawValueLength= 0;
+#endif
 }
 
 
@@ -81,7 +87,9 @@ int RetVal;
 
 #ifdef ENABLE_SQLITE3
 					case SQLITE3:
-						ssnprintf(m_FormattedField, sizeof(m_FormattedField), "%u, ", (unsigned int) FieldDescriptor.BitField_Value);
+						ssnprintf(m_FormattedField, sizeof(m_FormattedField), "%u", (unsigned int) FieldDescriptor.BitField_Value);
+						m_FieldValueType= FIELDVALUE_INTEGER;
+						m_IntegerValue= FieldDescriptor.BitField_Value;
 						break;
 #endif
 					default:
@@ -99,7 +107,7 @@ int RetVal;
 
 #ifdef ENABLE_SQLITE3
 					case SQLITE3:
-						ssnprintf(m_FormattedField, sizeof(m_FormattedField), "-");
+						m_FieldValueType= FIELDVALUE_NULL;
 						break;
 #endif
 					default:
@@ -132,10 +140,11 @@ int RetVal;
 
 				StartTime= nbProfilerGetTime();
 #endif
-				// Here we use the 'UserExtension' member in order to store the 'fast printing' function code, if available.
+				// Here we use the 'UserExtension' member in order to store the handle of the field, if available.
+				// Fields that are not in the list set by the user (e.g. the ones listed under 'allfields') do not have it.
 				if (FieldDescriptor.UserExtension)
 				{
-					RetVal= m_NetPDLUtils->FormatNetPDLField((long) FieldDescriptor.UserExtension, PktData + FieldDescriptor.Offset,
+					RetVal= m_NetPDLUtils->FormatNetPDLField((nbNetPDLFieldHandle) FieldDescriptor.UserExtension, PktData + FieldDescriptor.Offset,
 						FieldDescriptor.Length, m_FormattedField, sizeof(m_FormattedField));
 				}
 				else
@@ -172,7 +181,8 @@ int RetVal;
 
 #ifdef ENABLE_SQLITE3
 						case SQLITE3:
-							// Do nothing; the field is already in the m_FormattedField field
+							// The field is already in the m_FormattedField field; the type of its column tells how to store it
+							m_FieldValueType= FIELDVALUE_TEXT;
 							break;
 #endif
 						default:
@@ -180,6 +190,15 @@ int RetVal;
 							break;
 					}
 				}
+#ifdef ENABLE_SQLITE3
+				else if (m_PrintingMode == SQLITE3)
+				{
+					// The field cannot be formatted: let's store its raw content
+					m_FieldValueType= FIELDVALUE_RAW;
+					m_RawValue= PktData + FieldDescriptor.Offset;
+					m_RawValueLength= FieldDescriptor.Length;
+				}
+#endif
 			}
 			else
 			{
@@ -191,7 +210,7 @@ int RetVal;
 
 #ifdef ENABLE_SQLITE3
 					case SQLITE3:
-						ssnprintf(m_FormattedField, sizeof(m_FormattedField), "-");
+						m_FieldValueType= FIELDVALUE_NULL;
 						break;
 #endif
 					default:
@@ -34,6 +34,18 @@
 #include "anonimize-ip.h"
 
 
+#ifdef ENABLE_SQLITE3
+// Type of the value of the last field formatted in SQLITE3 mode, so that it can be stored with its native SQLite type
+enum FieldValueType_t
+{
+	FIELDVALUE_TEXT,		// The value is the string returned by GetFormattedField()
+	FIELDVALUE_INTEGER,		// The value is the number returned by GetIntegerValue()
+	FIELDVALUE_RAW,			// The field has no printable form; the value is its raw content returned by GetRawValue()
+	FIELDVALUE_NULL			// The field is not present in the packet
+};
+#endif
+
+
 class CFieldPrinter
 {
 	PrintingMode_t m_PrintingMode;
@@ -42,10 +54,21 @@ class CFieldPrinter
 	AnonymizationMapTable_t m_AnonymizationIPTable;
 	AnonymizationArgumentList_t m_AnonymizationIPArgumentList;
 	char m_FormattedField[4096];
+#ifdef ENABLE_SQLITE3
+	FieldValueType_t m_FieldValueType;
+	int64_t m_IntegerValue;
+	const unsigned char *m_RawValue;
+	int m_RawValueLength;
+#endif
 
 
 public:
 	void Initialize(nbNetPDLUtils* NetPDLUtils, PrintingMode_t PrintingMode, AnonymizationMapTable_t AnonymizationIPTable, AnonymizationArgumentList_t AnonymizationIPArgumentList, FILE *OutputFile);
 	void PrintField(_nbExtractedFieldsDescriptor &FieldDescriptor, int FieldNumber, const unsigned char *PktData);
 	char* GetFormattedField();
+#ifdef ENABLE_SQLITE3
+	FieldValueType_t GetFieldValueType() { return m_FieldValueType; }
+	int64_t GetIntegerValue() { return m_IntegerValue; }
+	const unsigned char* GetRawValue(int &Length) { Length= m_RawValueLength; return m_RawValue; }
+#endif
 };
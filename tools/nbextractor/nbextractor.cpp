@@ -95,8 +95,9 @@ CFieldPrinter FieldPrinter;
 sqlite3* pSQLite3DB= NULL;
 char *SQLDB_FilenameFormat = NULL; // stores the format of the subsequent SQLDBCurrentFilename afetr the first
 char *SQLDBCurrentFilename = NULL; // this can be NULL or a malloc'd string
-char SQLCommandBuffer[SQLCOMMAND_MAX_LEN];
-int SQLCommandBufferOccupancy= 0;
+sqlite3_stmt* pSQLite3InsertStatement= NULL; // compiled once per database, then executed for each packet
+int* SQLColumnTypes= NULL; // type of the column of each field, chosen once from its NetPDL definition
+bool SQLLegacySchema= false; // 'true' if the current table has been created by a previous version (all TEXT columns)
 #endif
 
 // Defines IP anonymization data structures and generate pseudo-random seed for IP anonymization masks
@@ -278,24 +279,24 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 	// Get the list of fields we need to extract
 	DescriptorVector= FieldReader->GetFields();
 
-	// Loop across the fields that have to be extracted, and check if they are associated to a fast printing code
-	// In that case, store that code for later use
+	// Loop across the fields that have to be extracted, and locate their definition in the NetPDL description
+	// The handle of each field is stored for later use, so that the field can be formatted without looking it up again
 	for (int j= 0; j < DescriptorVector->NumEntries; j++)
 	{
 	int RetVal;
-	int FastPrintingFunctionCode;
+	nbNetPDLFieldHandle FieldHandle;
 
-		RetVal= NetPDLUtils->GetFastPrintingFunctionCode(DescriptorVector->FieldDescriptor[j].Proto, DescriptorVector->FieldDescriptor[j].Name, &FastPrintingFunctionCode);
+		RetVal= NetPDLUtils->GetNetPDLFieldHandle(DescriptorVector->FieldDescriptor[j].Proto, DescriptorVector->FieldDescriptor[j].Name, &FieldHandle);
 
 		switch (RetVal)
 		{
 		case nbSUCCESS:
 			{
-				DescriptorVector->FieldDescriptor[j].UserExtension= (void*) FastPrintingFunctionCode;
+				DescriptorVector->FieldDescriptor[j].UserExtension= (void*) FieldHandle;
 			}; break;
 
 		case nbWARNING:
-			// Do nothing; the field is not associated to any fast printing function
+			// Do nothing; this is the 'allfields' field, which is never formatted
 			break;
 
 		case nbFAILURE:
@@ -305,6 +306,13 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 		}
 	}
 
+#ifdef ENABLE_SQLITE3
+	SQLColumnTypes= new int[DescriptorVector->NumEntries];
+
+	for (int j= 0; j < DescriptorVector->NumEntries; j++)
+		SQLColumnTypes[j]= GetDataRecordColumnType(NetPDLUtils, DescriptorVector->FieldDescriptor[j]);
+#endif
+
 #ifdef PROFILING
 	// We allocate there three profiler instances:
 	// - the first measures processing time
@@ -356,7 +364,7 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
           else
             snprintf(SQLDB_FilenameFormat, format_length, "%s_%%05d", ConfigParams.SQLDatabaseFileBasename);
 
-          RetVal = SQL_open(SQLDBCurrentFilename, &ConfigParams, &pSQLite3DB, DescriptorVector);
+          RetVal = SQL_open(SQLDBCurrentFilename, &ConfigParams, &pSQLite3DB, DescriptorVector, SQLColumnTypes, &SQLLegacySchema);
           if (RetVal == nbFAILURE)
             {
               fprintf(stderr, "Failed to create new table and no existing table (same schema) in database.\n");
@@ -474,17 +482,17 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 	FieldPrinter.Initialize(NetPDLUtils, ConfigParams.PrintingMode, AnonymizationIPTable, AnonymizationIPArgumentList, OutputFile);
 
 #ifdef ENABLE_SQLITE3
-	RetVal= PrepareAddNewDataRecordSQLCommand(pSQLite3DB, ConfigParams.SQLTableName, DescriptorVector, SQLCommandBuffer, sizeof(SQLCommandBuffer), SQLCommandBufferOccupancy);
-	if (RetVal == nbFAILURE)
+	if (SQLDBCurrentFilename)
 	{
-		fprintf(stderr, "Internal error: the buffer that contains SQL commands is too small.\n");
-		goto cleanup;
+		RetVal= PrepareAddNewDataRecordStatement(pSQLite3DB, ConfigParams.SQLTableName, DescriptorVector, &pSQLite3InsertStatement);
+		if (RetVal == nbFAILURE)
+			goto cleanup;
 	}
 #endif
 
 #ifdef ENABLE_SQLITE3
 	// Start first transaction
-	if (ConfigParams.SQLTransactionSize)
+	if ((SQLDBCurrentFilename) && (ConfigParams.SQLTransactionSize))
 		sqlite3_exec(pSQLite3DB, "BEGIN", NULL, NULL, NULL);
 
         // generate an identifier that is unique (... sort of) for this run
@@ -534,37 +542,36 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 #ifdef ENABLE_SQLITE3
 			if (SQLDBCurrentFilename)
 			{
-			int SQLCommandBufferNewOccupancy;
 			char Timestamp[128];
 			int i;
 
-				// Move SQLCommandBufferOccupancy into a new variable, so that the original value won't be changed
-				// and it will be used also in the next rounds
-				SQLCommandBufferNewOccupancy= SQLCommandBufferOccupancy;
-				
-				// Format timestamp
+				// Format timestamp; the buffer is still valid when the statement is executed, so SQLite does not need to copy it
 				ssnprintf(Timestamp, sizeof(Timestamp), "%ld.%ld", PktHeader->ts.tv_sec, PktHeader->ts.tv_usec);
+				if (sqlite3_bind_text(pSQLite3InsertStatement, 1, Timestamp, -1, SQLITE_STATIC) != SQLITE_OK)
+				{
+					fprintf(stderr, "Binding the timestamp failed: %s\n", sqlite3_errmsg(pSQLite3DB));
+					RetVal= nbFAILURE;
+				}
 
-				sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, "\"");
-				sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, Timestamp);
-				sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, "\",");
-
-				for (i= 0; i < DescriptorVector->NumEntries; i++)
+				// Parameters of the statement are numbered starting from 1, and the first one is the timestamp
+				for (i= 0; (RetVal != nbFAILURE) && (i < DescriptorVector->NumEntries); i++)
 				{
 					FieldPrinter.PrintField(DescriptorVector->FieldDescriptor[i], i, PktData);
+					RetVal= BindDataRecordField(pSQLite3InsertStatement, i + 2, SQLLegacySchema ? SQLCOLUMN_LEGACY_TEXT : SQLColumnTypes[i], FieldPrinter);
+				}
 
-					sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, "\"");
-					sstrncatescape_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, '"', '"', FieldPrinter.GetFormattedField() );
-					sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, "\"");
+				if (RetVal != nbFAILURE)
+					RetVal= AddNewDataRecord(pSQLite3InsertStatement);
 
-					if (i < (DescriptorVector->NumEntries - 1))
-						sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, ",");
-					else
-						sstrncat_ex(SQLCommandBuffer, sizeof(SQLCommandBuffer), &SQLCommandBufferNewOccupancy, ")");
+				// Let's stop as if the capture had been interrupted, so that the rows already inserted are committed
+				if (RetVal == nbFAILURE)
+				{
+					fprintf(stderr, "Cannot store packet %d into the database; stopping.\n", PacketCounter);
+					AcceptedPkts--;
+					AbortSignalCaught= true;
+					continue;
 				}
 
-				AddNewDataRecord(pSQLite3DB, SQLCommandBuffer);
-
 				// Check if transaction has to be committed
 				if ((ConfigParams.SQLTransactionSize) && (AcceptedPkts % ConfigParams.SQLTransactionSize == 0))
 				{
@@ -650,7 +657,7 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 
                           // 2) close the old file
                           UpdateExtraDBTable(pSQLite3DB, AcceptedPkts, ConfigParams, SQLDBCurrentFilename, run_id);
-                          sqlite3_close(pSQLite3DB);
+                          SQL_close(&ConfigParams, pSQLite3DB, pSQLite3InsertStatement);
 
                           // 3) generate a new filename
                           free(SQLDBCurrentFilename);
@@ -659,19 +666,16 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
                           snprintf(SQLDBCurrentFilename, len+6+1, SQLDB_FilenameFormat, CurrentFileNumber);
 
                           // 4) open the new file and handle errors
-                          RetVal = SQL_open(SQLDBCurrentFilename, &ConfigParams, &pSQLite3DB, DescriptorVector);
+                          RetVal = SQL_open(SQLDBCurrentFilename, &ConfigParams, &pSQLite3DB, DescriptorVector, SQLColumnTypes, &SQLLegacySchema);
                           if (RetVal == nbFAILURE) {
                             fprintf(stderr, "Failed to create new table and no existing table (same schema) in database.\n");
                             goto cleanup;
                           }
                           
-                          // 5) prepare add
-                          SQLCommandBufferOccupancy = 0;
-                          RetVal= PrepareAddNewDataRecordSQLCommand(pSQLite3DB, ConfigParams.SQLTableName, DescriptorVector, SQLCommandBuffer, sizeof(SQLCommandBuffer), SQLCommandBufferOccupancy);
-                          if (RetVal == nbFAILURE) {
-                            fprintf(stderr, "Internal error: the buffer that contains SQL commands is too small.\n");
+                          // 5) prepare the insert statement on the new database
+                          RetVal= PrepareAddNewDataRecordStatement(pSQLite3DB, ConfigParams.SQLTableName, DescriptorVector, &pSQLite3InsertStatement);
+                          if (RetVal == nbFAILURE)
                             goto cleanup;
-                          }
 
                           // 6) start transaction, if needed
                           if (ConfigParams.SQLTransactionSize)
@@ -687,7 +691,7 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 #endif // ifdef PROFILING
 
 	// Commit last transaction
-	if (ConfigParams.SQLTransactionSize)
+	if ((SQLDBCurrentFilename) && (ConfigParams.SQLTransactionSize))
 		sqlite3_exec(pSQLite3DB, "COMMIT", NULL, NULL, NULL);
 
 #ifdef PROFILING
@@ -780,11 +784,15 @@ AnonymizationArgumentList_t AnonymizationIPArgumentList;
 	if (SQLDBCurrentFilename)
 	{
           UpdateExtraDBTable(pSQLite3DB, AcceptedPkts, ConfigParams, SQLDBCurrentFilename, run_id);
-		sqlite3_close(pSQLite3DB);
+		SQL_close(&ConfigParams, pSQLite3DB, pSQLite3InsertStatement);
 	}
 #endif
 
 cleanup:
+#ifdef ENABLE_SQLITE3
+	delete[] SQLColumnTypes;
+#endif
+
 	nbDeallocatePacketEngine(PacketEngine);
 	nbCleanup();
 